@@ -0,0 +1,93 @@
+/*
+ * ARCHI - Memory-Mapped Assets
+ *
+ * Read-only images served straight from flash. The "assets" partition
+ * (partitions_custom.csv) holds a bundle packed on the host by
+ * tools/asset_pack.py. At boot the used part of the partition is mapped
+ * into the data cache address space with one esp_partition_mmap(), the
+ * index is checked in place, and every entry becomes an lv_img_dsc_t
+ * whose data points into the mapping. LVGL draws those pixels where they
+ * are: no file handle, no VFS read, no RAM copy (the flash cache fetches
+ * what the renderer touches).
+ *
+ * Bundle layout (little endian):
+ *   header  magic u32 | version u16 | count u16 | index_crc u32 | data_end u32
+ *   entry   name char[16] | offset u32 | size u32 | img_header u32 | crc u32
+ *   blobs   pixel data, each starting on ASSET_MAP_ALIGN
+ * index_crc is the CRC-32 of all entries, crc the CRC-32 of one blob;
+ * img_header is LVGL's 4-byte lv_img_header_t, as at the start of a .bin.
+ * Blobs are aligned on the 32-byte cache line: 320 px RGB565 rows (640
+ * bytes) never straddle one.
+ *
+ * A missing, blank or invalid partition is not an error: the finders
+ * return NULL and callers fall back to their file system path.
+ */
+
+#ifndef ASSET_MAP_H
+#define ASSET_MAP_H
+
+#include "lvgl.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#define ASSET_MAP_PARTITION_LABEL   "assets"
+#define ASSET_MAP_PARTITION_SUBTYPE 0x41
+
+#define ASSET_MAP_MAGIC             0x54455341u   // "ASET"
+#define ASSET_MAP_VERSION           1
+#define ASSET_MAP_ALIGN             32
+#define ASSET_MAP_NAME_MAX          16            // NUL included
+#define ASSET_MAP_MAX_ENTRIES       32
+
+typedef struct {
+  bool mapped;
+  uint16_t count;           // Images in the bundle
+  uint32_t mapped_bytes;    // Partition bytes mapped (header to last blob)
+  uint32_t map_us;          // mmap + index check at boot
+} asset_map_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Map the asset partition and index it (boot, before the UI builds).
+ * @return true if a valid bundle is mapped
+ */
+bool asset_map_init(void);
+
+/**
+ * Image descriptor of an asset, by name (file name without extension,
+ * e.g. "bg_1"). Points into mapped flash; valid until reboot.
+ * @return NULL if there is no such asset (or no bundle)
+ */
+const lv_img_dsc_t* asset_map_find(const char* name);
+
+/**
+ * Name of the asset behind an LVGL image source.
+ * @return NULL if `src` is not one of our descriptors
+ */
+const char* asset_map_name(const void* src);
+
+/**
+ * Check one blob against its CRC (reads it all through the cache: slow,
+ * diagnostics only).
+ */
+bool asset_map_verify(const char* name);
+
+void asset_map_get_stats(asset_map_stats_t* out);
+
+/*
+ * Same image through both paths (UI task): copies one mapped wallpaper to
+ * the file system, then compares reading it line by line through the LVGL
+ * file driver with reading it from the mapping (time, heap taken while
+ * the file is open, checksum), and a full-screen redraw from each source.
+ * The temporary file is removed afterwards.
+ */
+void asset_map_run_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ASSET_MAP_H
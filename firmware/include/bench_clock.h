@@ -0,0 +1,30 @@
+/*
+ * ARCHI - Benchmark Clock
+ *
+ * Microseconds for timing CPU-bound code in the *_RUN_BENCHMARK builds:
+ * esp_timer on target, the host clock in the native simulation, where
+ * esp_timer_get_time() / micros() follow virtual time and stand still while
+ * a task computes.
+ */
+
+#ifndef BENCH_CLOCK_H
+#define BENCH_CLOCK_H
+
+#include <stdint.h>
+
+#ifdef ACYD_NATIVE_SIM
+#include "native_sim.h"
+#else
+#include <esp_timer.h>
+#endif
+
+static inline int64_t bench_clock_us(void)
+{
+#ifdef ACYD_NATIVE_SIM
+  return static_cast<int64_t>(sim_host_time_us());
+#else
+  return esp_timer_get_time();
+#endif
+}
+
+#endif // BENCH_CLOCK_H
@@ -35,6 +35,11 @@
   #define MOCK_TFT_ESPI 0
 #endif
 
+// Default to the XPT2046 unless explicitly mocking (native sim: scripted touch)
+#ifndef MOCK_TOUCH
+  #define MOCK_TOUCH 0
+#endif
+
 // Ne redéfinir TOUCH_CS que si la lib TFT_eSPI ne l'a pas déjà fait
 #ifndef TOUCH_CS
   #define TOUCH_CS TOUCH_CS_PIN
@@ -63,6 +68,8 @@
 #define NETSEC_TASK_STACK_SIZE (12 * 1024)    // 12 KB for network task
 #define UI_TASK_PRIORITY       4   // Keep UI ahead of NetSec and most drivers
 #define NETSEC_TASK_PRIORITY   3   // Network task should outrank default tasks
+#define BOOT_TASK_STACK_SIZE  (6 * 1024)      // Deferred init: SPIFFS mount, WiFi bring-up
+#define BOOT_TASK_PRIORITY     2   // Background: never in the way of the first frame
 
 /* LVGL buffer config (will be refined in ARCHI init) */
 #define LVGL_BUFFER_SIZE (320 * 240 / 8)  // Conservative: ~9 KB
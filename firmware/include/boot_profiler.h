@@ -0,0 +1,49 @@
+/*
+ * ARCHI - Boot Profiler
+ *
+ * Microsecond timeline of the init stages (esp_timer clock, i.e. time since
+ * the app started) plus two user-facing milestones: first frame on the
+ * panel (TTFF) and main screen live with touch (TTI). Stages may run on
+ * either core and overlap; the timeline is printed once per boot.
+ */
+
+#ifndef BOOT_PROFILER_H
+#define BOOT_PROFILER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BOOT_PROF_MAX_STAGES 24
+
+typedef enum {
+    BOOT_MILESTONE_FIRST_FRAME = 0,   // Splash flushed to the panel
+    BOOT_MILESTONE_INTERACTIVE,       // Main screen drawn, input live
+    BOOT_MILESTONE_COUNT,
+} boot_milestone_t;
+
+/*
+ * Open a stage; `name` must outlive the boot (string literal).
+ * Returns a handle for boot_prof_end(), or -1 once the table is full.
+ */
+int boot_prof_begin(const char* name);
+
+/* Close a stage opened by boot_prof_begin (ignores -1) */
+void boot_prof_end(int handle);
+
+/* Record a milestone (first call wins) */
+void boot_prof_milestone(boot_milestone_t milestone);
+
+/* Milestone time in microseconds since app start, 0 if not reached yet */
+uint32_t boot_prof_milestone_us(boot_milestone_t milestone);
+
+/* Print the timeline, TTFF and TTI on serial */
+void boot_prof_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BOOT_PROFILER_H
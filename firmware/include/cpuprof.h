@@ -0,0 +1,81 @@
+/*
+ * ARCHI - CPU Profiler
+ *
+ * Per-task CPU share built on FreeRTOS run-time stats (uxTaskGetSystemState).
+ * The counter is the ESP-IDF run-time stats clock (esp_timer, 1 us) when the
+ * sdkconfig enables it. Shares are reported per core over a short and a long
+ * sliding window, together with wake counts for the tasks that call
+ * cpuprof_note_wake() and flags for starvation, CPU hogs and priority
+ * inheritance (a mutex holder boosted by a waiting higher-priority task).
+ *
+ * Sampling is driven by the sysmon task; the report follows the sysmon one.
+ * uxTaskGetSystemState() fills nothing when the system has more tasks than
+ * the status array holds: a sample is then skipped and logged once.
+ */
+
+#ifndef CPUPROF_H
+#define CPUPROF_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CPUPROF_MAX_TASKS        24   // Tasks in a snapshot: the busiest ones
+#define CPUPROF_MAX_SYSTEM_TASKS 48   // Tasks sampled: app + IDF + WiFi / BT + NimBLE host, with room
+#define CPUPROF_TASK_HEADROOM    8    // Warn when fewer free entries than this remain
+#define CPUPROF_NAME_LEN         16
+#define CPUPROF_CORE_COUNT       2
+#define CPUPROF_CORE_ANY         CPUPROF_CORE_COUNT   // Unpinned task
+#define CPUPROF_SHORT_WINDOW     1    // Samples (1 s each)
+#define CPUPROF_LONG_WINDOW      10
+#define CPUPROF_STARVE_SAMPLES   3    // Ready but no CPU for this many samples
+#define CPUPROF_HOG_PCT          90   // Long-window share of a core
+
+#define CPUPROF_FLAG_STARVED      (1u << 0)
+#define CPUPROF_FLAG_HOG          (1u << 1)
+#define CPUPROF_FLAG_PRIO_INHERIT (1u << 2)
+
+typedef struct {
+    char name[CPUPROF_NAME_LEN];
+    uint8_t core;              // 0, 1 or CPUPROF_CORE_ANY
+    uint8_t priority;          // Base priority
+    uint8_t cur_priority;      // Current (possibly inherited) priority
+    uint8_t flags;             // CPUPROF_FLAG_*
+    uint16_t pct_short_x10;    // Share of one core, tenths of a percent
+    uint16_t pct_long_x10;
+    uint32_t wakes_per_s;      // Only for tasks calling cpuprof_note_wake()
+    char starved_by[CPUPROF_NAME_LEN];  // Busiest higher-priority task on the same core
+} cpuprof_task_t;
+
+typedef struct {
+    bool available;            // False when run-time stats are compiled out
+    uint16_t core_load_short_x10[CPUPROF_CORE_COUNT];
+    uint16_t core_load_long_x10[CPUPROF_CORE_COUNT];
+    uint8_t system_tasks;      // Tasks sampled, idle tasks included
+    uint8_t task_count;
+    cpuprof_task_t tasks[CPUPROF_MAX_TASKS];   // Sorted by long-window share
+} cpuprof_snapshot_t;
+
+/* Take one sample (called every SYSMON_SAMPLE_PERIOD_MS by the sysmon task). */
+void cpuprof_sample(void);
+
+/*
+ * Count one wake-up of the calling task. FreeRTOS keeps no per-task
+ * context-switch counter without a custom trace hook, so the loops we own
+ * report their own wake-ups instead.
+ */
+void cpuprof_note_wake(void);
+
+void cpuprof_get_snapshot(cpuprof_snapshot_t* out);
+
+/* Print the per-core / per-task table on serial */
+void cpuprof_print_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CPUPROF_H
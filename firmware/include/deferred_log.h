@@ -0,0 +1,147 @@
+/*
+ * ARCHI - Deferred Logging
+ *
+ * Hot-path replacement for Serial.printf. A log call only captures the
+ * format string pointer (the literal lives in flash, its address is the
+ * message ID), a timestamp and up to DLOG_MAX_ARGS raw 32-bit arguments
+ * into a lock-free per-core ring. Formatting and UART output happen later
+ * on a low-priority drain task. When a ring is full the record is dropped
+ * and counted; callers never block.
+ *
+ * Supported conversions: integer (%d %i %u %x %X %c, any width/flags, length
+ * modifiers are ignored since every argument is 32-bit) and at most one %s,
+ * whose string is copied (truncated to DLOG_STR_MAX - 1 chars). No floats.
+ */
+
+#ifndef DEFERRED_LOG_H
+#define DEFERRED_LOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define DLOG_LEVEL_NONE  0
+#define DLOG_LEVEL_ERROR 1
+#define DLOG_LEVEL_WARN  2
+#define DLOG_LEVEL_INFO  3
+#define DLOG_LEVEL_DEBUG 4
+
+/* Compile-time filter: calls above this level are compiled out */
+#ifndef DLOG_LEVEL
+#define DLOG_LEVEL DLOG_LEVEL_INFO
+#endif
+
+#define DLOG_MAX_ARGS 8
+#define DLOG_STR_MAX  32    // BLE names are up to 31 chars
+
+/* Records per core (power of two) */
+#ifndef DLOG_RING_SIZE
+#define DLOG_RING_SIZE 64
+#endif
+
+#define DLOG_TASK_STACK_SIZE 3072
+#define DLOG_TASK_PRIORITY   1
+#define DLOG_DRAIN_PERIOD_MS 20
+
+typedef struct {
+    const char* fmt;                 // Format literal (message ID)
+    uint32_t timestamp_us;           // micros() at capture, used to merge the per-core rings
+    uint32_t args[DLOG_MAX_ARGS];    // Raw integer arguments in call order
+    char str[DLOG_STR_MAX];          // Copy of the %s argument, if any
+    uint8_t level;
+    uint8_t nargs;
+    uint8_t has_str;
+} dlog_record_t;
+
+typedef struct {
+    uint32_t written;   // Records accepted into a ring
+    uint32_t dropped;   // Records rejected because the ring was full
+    uint32_t printed;   // Records formatted and written by the drain task
+} dlog_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Start the drain task. Records logged before this call are kept in the
+ * rings and printed once the task runs.
+ */
+void dlog_init(void);
+
+/* Push a filled record into the current core's ring (never blocks). */
+bool dlog_commit(const dlog_record_t* rec);
+
+/* Format and print everything pending from the calling context. */
+void dlog_flush(void);
+
+void dlog_get_stats(dlog_stats_t* out);
+
+/* Capture clock shared by all cores (microseconds, wraps after ~71 min) */
+uint32_t dlog_timestamp_us(void);
+
+/**
+ * Measure the caller-side cost of DLOG_I against Serial.printf for the
+ * same message and print the result (blocks for a few hundred ms).
+ */
+void dlog_run_benchmark(void);
+
+#ifdef __cplusplus
+}
+
+#include <type_traits>
+
+/* Argument capture: integers and one string; floating point is rejected at compile time. */
+static inline void dlog_record_add(dlog_record_t* rec, const char* s)
+{
+    if (rec->has_str) return;
+    rec->has_str = 1;
+    if (!s) s = "(null)";
+    strncpy(rec->str, s, sizeof(rec->str) - 1);
+    rec->str[sizeof(rec->str) - 1] = '\0';
+}
+
+static inline void dlog_record_add(dlog_record_t* rec, char* s)
+{
+    dlog_record_add(rec, static_cast<const char*>(s));
+}
+
+template <typename T>
+static inline void dlog_record_add(dlog_record_t* rec, T value)
+{
+    static_assert(std::is_integral<T>::value || std::is_enum<T>::value, "only integer, enum and string log arguments");
+    if (rec->nargs < DLOG_MAX_ARGS) {
+        rec->args[rec->nargs++] = static_cast<uint32_t>(value);
+    }
+}
+
+template <typename... Args>
+static inline void dlog_emit(uint8_t level, const char* fmt, Args... args)
+{
+    static_assert(sizeof...(Args) <= DLOG_MAX_ARGS + 1, "too many log arguments");
+    dlog_record_t rec;
+    rec.fmt = fmt;
+    rec.timestamp_us = dlog_timestamp_us();
+    rec.level = level;
+    rec.nargs = 0;
+    rec.has_str = 0;
+    (dlog_record_add(&rec, args), ...);
+    dlog_commit(&rec);
+}
+
+#define DLOG_AT(level, fmt, ...)                               \
+    do {                                                       \
+        if ((level) <= DLOG_LEVEL) {                           \
+            dlog_emit((level), fmt, ##__VA_ARGS__);            \
+        }                                                      \
+    } while (0)
+
+#define DLOG_E(fmt, ...) DLOG_AT(DLOG_LEVEL_ERROR, fmt, ##__VA_ARGS__)
+#define DLOG_W(fmt, ...) DLOG_AT(DLOG_LEVEL_WARN, fmt, ##__VA_ARGS__)
+#define DLOG_I(fmt, ...) DLOG_AT(DLOG_LEVEL_INFO, fmt, ##__VA_ARGS__)
+#define DLOG_D(fmt, ...) DLOG_AT(DLOG_LEVEL_DEBUG, fmt, ##__VA_ARGS__)
+
+#endif // __cplusplus
+
+#endif // DEFERRED_LOG_H
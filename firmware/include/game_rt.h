@@ -0,0 +1,95 @@
+/*
+ * PIXEL - Mini-Game Runtime
+ *
+ * Games do not use LVGL widgets. While a game runs the UI task calls
+ * game_rt_tick() instead of lv_timer_handler(): LVGL keeps its objects but
+ * renders nothing, and the runtime owns the panel.
+ *
+ * - Logic runs at a fixed GAME_RT_STEP_US (60 Hz), decoupled from render:
+ *   elapsed time is accumulated and consumed in whole steps, at most
+ *   GAME_RT_MAX_STEPS per tick (a longer stall slows the game instead of
+ *   bursting through it).
+ * - A game is a set of sprites (RGB565 bitmaps with a key colour, or solid
+ *   rectangles) over a solid background. Moving, hiding or re-skinning a
+ *   sprite marks its old and new rectangles dirty; overlapping rectangles
+ *   are merged before drawing.
+ * - Each merged rectangle is composed in bands in LVGL's draw buffer (idle
+ *   while a game runs) and sent with display_hw_push_pixels().
+ * - Touch is read straight from the touch driver once per tick.
+ *
+ * Coordinates are display pixels. UI task only; one game at a time.
+ */
+
+#ifndef GAME_RT_H
+#define GAME_RT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GAME_RT_STEP_US       16667   // 60 Hz logic
+#define GAME_RT_MAX_STEPS     4
+#define GAME_RT_MAX_SPRITES   24
+#define GAME_RT_MAX_DIRTY     12
+#define GAME_RT_KEY_COLOR     0xF81F  // Transparent in sprite bitmaps (magenta)
+
+typedef struct {
+  int16_t x;
+  int16_t y;
+  bool pressed;
+  bool just_pressed;      // First step of a touch
+  bool just_released;
+} game_input_t;
+
+typedef struct {
+  const char* name;
+  void (*start)(uint32_t seed);               // Add sprites, set the background
+  bool (*update)(const game_input_t* input);  // One fixed step; false = quit
+  void (*stop)(void);                         // Free game data (sprites are dropped by the runtime)
+} game_def_t;
+
+typedef struct {
+  uint32_t steps;
+  uint32_t dropped_steps;   // Time skipped by the catch-up bound
+  uint32_t frames;          // Ticks that drew something
+  uint32_t rects;           // Merged rectangles pushed
+  uint32_t px;              // Pixels pushed
+  uint32_t render_us_max;   // Compose + push of one frame
+} game_rt_stats_t;
+
+// Take the panel and start `game`; on_exit runs (UI task) once it has quit
+bool game_rt_start(const game_def_t* game, void (*on_exit)(void));
+bool game_rt_active(void);
+
+// Run due logic steps, then draw what changed (replaces lv_timer_handler)
+void game_rt_tick(void);
+
+// Quit now (stop the game, hand the panel back to LVGL)
+void game_rt_stop(void);
+
+// Sprite API for games (ids are valid until the game stops; -1 = table full)
+int game_rt_sprite_add(const uint16_t* pixels, uint16_t color, uint16_t w, uint16_t h);
+void game_rt_sprite_move(int id, int16_t x, int16_t y);
+void game_rt_sprite_show(int id, bool visible);
+void game_rt_sprite_set_pixels(int id, const uint16_t* pixels, uint16_t color);
+void game_rt_set_background(uint16_t color);   // Redraws the whole screen
+
+void game_rt_get_stats(game_rt_stats_t* out);
+
+/*
+ * Measure the panel (display_hw_push_pixels throughput and per-call cost),
+ * then play the sample game headless for 30 simulated seconds with scripted
+ * touches: each frame costs its measured CPU time plus its pushed pixels
+ * at the measured throughput, against the 16.7 ms budget of 60 fps. Draws
+ * on the panel for a moment; the LVGL screen is repainted afterwards.
+ */
+void game_rt_run_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GAME_RT_H
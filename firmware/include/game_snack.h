@@ -0,0 +1,31 @@
+/*
+ * PIXEL - Snack Catch (sample mini-game)
+ *
+ * The pet slides along the bottom of the screen under the finger and
+ * catches falling snacks; a missed snack costs one of three lives and the
+ * fall speeds up with the score. Tap after game over to play again, tap
+ * the cross (top right) to go back to the main screen.
+ *
+ * Runs on the mini-game runtime (game_rt); sprites are 1-bit masks expanded
+ * to RGB565 when the game starts and freed when it stops.
+ */
+
+#ifndef GAME_SNACK_H
+#define GAME_SNACK_H
+
+#include "game_rt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+const game_def_t* game_snack_def(void);
+
+// Best score of the current (or last) run of the game
+uint32_t game_snack_score(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // GAME_SNACK_H
@@ -0,0 +1,72 @@
+/*
+ * ARCHI - LVGL File System Driver ('S:' drive)
+ *
+ * The storage file system (storage_fs.h: SPIFFS or LittleFS) behind
+ * LVGL's lv_fs API without a heap allocation per file:
+ *
+ * - Handles come from a fixed pool of LVGL_FS_MAX_FILES, allocated
+ *   statically; an open with the pool exhausted fails (counted).
+ * - The path is normalised into a stack buffer and opened with POSIX
+ *   open() under STORAGE_FS_MOUNT_POINT (no File object, no std::string).
+ * - Each handle owns an LVGL_FS_READAHEAD buffer holding one aligned
+ *   window of the file (a whole number of 256-byte SPIFFS pages). Small
+ *   reads (image decoders read one row at a time) are served from it;
+ *   reads of a window or more go straight to the caller's buffer.
+ * - Seeks only move the logical position: a seek that lands inside the
+ *   window reuses it, and the backend is repositioned only when a miss
+ *   actually needs data from elsewhere.
+ *
+ * Counters tell opens, bytes delivered to LVGL and backend calls apart, so
+ * read amplification (backend bytes / delivered bytes) is visible.
+ */
+
+#ifndef LVGL_FS_H
+#define LVGL_FS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LVGL_FS_LETTER          'S'
+#define LVGL_FS_MAX_FILES       3
+#define LVGL_FS_READAHEAD       2048        // Per handle, multiple of the 256-byte SPIFFS page
+#define LVGL_FS_PATH_MAX        64          // Normalised path, without the mount point
+
+typedef struct {
+  uint32_t opens;
+  uint32_t open_fails;        // Backend refused (missing file...)
+  uint32_t pool_exhausted;    // No free handle
+  uint32_t path_too_long;
+  uint32_t reads;             // read_cb calls from LVGL
+  uint32_t bytes_read;        // Bytes delivered to LVGL
+  uint32_t window_hits;       // Reads served entirely from the window
+  uint32_t backend_reads;     // read() calls on the file system
+  uint32_t backend_bytes;     // Bytes those calls returned
+  uint32_t backend_seeks;     // lseek() calls on the file system
+  uint8_t open_max;           // Most handles open at once
+} lvgl_fs_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Register the driver with LVGL (after lv_init; files open once storage_fs_mount() has run)
+void lvgl_fs_register(void);
+
+void lvgl_fs_get_stats(lvgl_fs_stats_t* out);
+
+/*
+ * Drives the driver through lv_fs_* against an in-RAM mock file system
+ * that counts backend calls: row-by-row image reads, partial redraws
+ * (seek + short reads), large reads and seeks from the end. Checks every
+ * byte against the source and reports read amplification and backend
+ * calls per image, next to what the old pass-through driver cost. The
+ * real backend is restored afterwards (UI task, no file opened by LVGL
+ * meanwhile).
+ */
+void lvgl_fs_run_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LVGL_FS_H
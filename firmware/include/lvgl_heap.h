@@ -0,0 +1,99 @@
+/*
+ * ARCHI - LVGL Heap
+ *
+ * LVGL memory backend (LV_MEM_CUSTOM, see lv_conf.h) on top of tlsf_heap:
+ * a static primary pool of LV_MEM_SIZE bytes, plus optional extra regions
+ * carved from the ESP32 heap when LVGL starts. Each allocation is charged
+ * to the current tag so screens, styles and list rows can be accounted
+ * separately.
+ *
+ * Included from LVGL's C sources: keep this header plain C.
+ * All functions must be called from the UI task (LVGL is single-threaded).
+ */
+
+#ifndef LVGL_HEAP_H
+#define LVGL_HEAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Extra regions carved from the internal heap at lv_init() (0 = pool only)
+#ifndef LVGL_HEAP_EXTRA_REGIONS
+#define LVGL_HEAP_EXTRA_REGIONS 0
+#endif
+
+#ifndef LVGL_HEAP_EXTRA_REGION_SIZE
+#define LVGL_HEAP_EXTRA_REGION_SIZE (16U * 1024U)
+#endif
+
+typedef enum {
+  LVGL_HEAP_TAG_CORE = 0,      // Untagged: LVGL internals, timers, draw buffers
+  LVGL_HEAP_TAG_STYLE,         // Theme and shared styles
+  LVGL_HEAP_TAG_SPLASH,
+  LVGL_HEAP_TAG_MAIN,
+  LVGL_HEAP_TAG_WIFI,
+  LVGL_HEAP_TAG_BLE,
+  LVGL_HEAP_TAG_SETTINGS,
+  LVGL_HEAP_TAG_LIST_ROW,      // WiFi / BLE result rows, whatever the screen
+  LVGL_HEAP_TAG_COUNT,
+} lvgl_heap_tag_t;
+
+typedef struct {
+  uint32_t total;              // Usable bytes over all regions
+  uint32_t free;
+  uint32_t largest_free;       // Biggest allocation that would succeed now
+  uint32_t used;
+  uint32_t peak_used;
+  uint32_t used_blocks;
+  uint32_t free_blocks;
+  uint32_t allocs;             // malloc/realloc calls since boot
+  uint32_t frees;
+  uint32_t failed;             // Requests that returned NULL
+  uint8_t regions;
+  uint8_t frag_pct;            // 100 - largest_free * 100 / free
+} lvgl_heap_stats_t;
+
+typedef struct {
+  const char* name;
+  uint32_t bytes;
+  uint32_t peak_bytes;
+  uint16_t blocks;
+} lvgl_heap_tag_stats_t;
+
+// LV_MEM_CUSTOM_ALLOC / _FREE / _REALLOC (the heap initializes itself on first use)
+void* lvgl_heap_alloc(size_t size);
+void lvgl_heap_free(void* ptr);
+void* lvgl_heap_realloc(void* ptr, size_t size);
+
+// Charge subsequent allocations to `tag`; returns the tag to restore
+lvgl_heap_tag_t lvgl_heap_push_tag(lvgl_heap_tag_t tag);
+void lvgl_heap_pop_tag(lvgl_heap_tag_t previous);
+
+// Free bytes, O(1) (cheap enough for per-frame checks)
+uint32_t lvgl_heap_free_bytes(void);
+
+// Global counters plus fragmentation (walks one size class for largest_free)
+void lvgl_heap_get_stats(lvgl_heap_stats_t* out);
+
+// Live bytes/blocks charged to one tag (false if tag is out of range)
+bool lvgl_heap_get_tag_stats(lvgl_heap_tag_t tag, lvgl_heap_tag_stats_t* out);
+
+// Full consistency walk of every region; returns the number of errors
+uint32_t lvgl_heap_check(void);
+
+// Serial dump: global line, then one line per non-empty tag
+void lvgl_heap_log_stats(void);
+
+// Raw allocator throughput on a scratch heap, independent of LVGL
+void lvgl_heap_run_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LVGL_HEAP_H
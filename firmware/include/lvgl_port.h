@@ -9,14 +9,33 @@
 #define LVGL_PORT_H
 
 #include "lvgl.h"
+#include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-// Initialize LVGL subsystem: display driver, input device, tick timer
+typedef struct {
+  uint32_t frames;      // Refresh cycles that drew something
+  uint32_t flushes;     // flush_cb calls (areas pushed to the panel)
+  uint32_t px;          // Pixels pushed to the panel
+  uint32_t render_ms;   // Time spent rendering and flushing those frames
+} lvgl_port_render_stats_t;
+
+// Initialize LVGL subsystem: display driver, input device, tick timer.
+// Only what the first frame needs; the steps below are staged after it.
 void lvgl_port_init(void);
 
+// Mount the storage FS behind the 'S:' drive (storage_fs.h; may format on first boot; any task)
+bool lvgl_port_mount_fs(void);
+
+// List / and /img on serial (diagnostics; any task)
+void lvgl_port_log_fs(void);
+
+// Apply the default LVGL theme (UI task, affects objects created afterwards)
+void lvgl_port_apply_theme(void);
+
 // Deinit LVGL and cleanup resources
 void lvgl_port_deinit(void);
 
@@ -26,6 +45,13 @@ lv_disp_t* lvgl_port_get_disp(void);
 // Get the registered input device (touch) object
 lv_indev_t* lvgl_port_get_indev_touch(void);
 
+// Cumulative render counters since lvgl_port_init() (UI task)
+void lvgl_port_get_render_stats(lvgl_port_render_stats_t* out);
+
+// LVGL's draw buffer, for code that draws while LVGL does not render
+// (game runtime). Size in pixels in *px. UI task only.
+lv_color_t* lvgl_port_borrow_draw_buf(uint32_t* px);
+
 #ifdef __cplusplus
 }
 #endif
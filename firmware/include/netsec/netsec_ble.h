@@ -8,21 +8,90 @@
 extern "C" {
 #endif
 
+// Create the ble_scan worker and its timeout timer (static, once at boot)
+void netsec_ble_init(void);
+
 // Start asynchronous BLE scan
 void netsec_ble_start_scan(uint32_t duration_ms);
 
 // Stop BLE scan
 void netsec_ble_stop_scan(void);
 
+// Stack reserved for the ble_scan worker (persistent, parked between scans)
+#define NETSEC_BLE_SCAN_TASK_STACK_SIZE 4096
+
 // Maximum number of cached BLE devices per scan cycle
 #define NETSEC_BLE_DEVICE_BUFFER_SIZE 16
 
 // Post BLE device found to the result queue (reuses an internal circular buffer)
 void netsec_ble_post_device(const char* name, int rssi, const uint8_t* addr, uint32_t flags);
 
-// Check whether a BLE scan task is currently running
+// Check whether a scan is starting, running or being finalized
 bool netsec_ble_is_scanning(void);
 
+// Scan lifecycle counters: every generation is finalized once, so at rest
+// started == completed + canceled == generations since boot, errors == 0
+typedef struct {
+  uint32_t started;           // Generations the worker ran (one STARTED event each)
+  uint32_t completed;
+  uint32_t canceled;
+  uint32_t restarts;          // Finalized straight into the next scan
+  uint32_t errors;            // Finalize found the state word changed under it
+  uint32_t generation;        // Of the current or last scan
+} netsec_ble_lifecycle_stats_t;
+
+void netsec_ble_get_lifecycle_stats(netsec_ble_lifecycle_stats_t* out);
+
+// Shut the BLE controller down when idle (before light sleep); the next scan
+// brings it back up. False if a scan is running or the timeout elapsed.
+bool netsec_ble_power_down(uint32_t timeout_ms);
+
+/*
+ * Adaptive duty cycle. Each scan starts at level 0 (active, window 99 of
+ * 100 ms, as before). A level is one step down after a run of 1 s slices
+ * without a new address, the run doubling at each level; any new address
+ * goes straight back to level 0. Lower levels listen less and scan
+ * passively: names only carried in scan responses are missed there.
+ * Past NETSEC_BLE_SEEN_MAX addresses new ones are still counted, from a
+ * bitmap, so a crowd never looks quiet.
+ * -D NETSEC_BLE_FIXED_DUTY keeps level 0 for the whole scan.
+ */
+#define NETSEC_BLE_POLICY_LEVELS      4
+#define NETSEC_BLE_CURVE_POINTS       64    // Halved (every other point) when full
+#define NETSEC_BLE_SEEN_MAX           128   // Distinct addresses kept per scan
+#define NETSEC_BLE_SEEN_OVERFLOW_BITS 1024  // One bit per hashed address past them
+
+typedef struct {
+  uint32_t t_ms;              // Since scan start, end of the slice
+  uint16_t unique;            // Distinct addresses so far
+  uint8_t level;              // Level the slice ran at
+} netsec_ble_curve_point_t;
+
+typedef struct {
+  bool adaptive;
+  bool scanning;
+  uint8_t level;
+  bool active;
+  uint16_t interval_ms;
+  uint16_t window_ms;
+  uint32_t scan_ms;           // Current or last scan
+  uint32_t radio_ms;          // Receiver on time: slice time x window / interval
+  uint16_t unique;
+  uint8_t curve_len;
+  netsec_ble_curve_point_t curve[NETSEC_BLE_CURVE_POINTS];
+} netsec_ble_policy_t;
+
+// Enable or disable the adaptive policy (applies from the next slice)
+void netsec_ble_set_adaptive(bool adaptive);
+
+// Current policy and the discovery curve of the current or last scan
+void netsec_ble_get_policy(netsec_ble_policy_t* out);
+
+// Built with -D NETSEC_BLE_RUN_DUTY_BENCHMARK: one long scan with the fixed
+// policy, one adaptive, then distinct devices, time to 50 / 90 % of them
+// and receiver on time for both.
+void netsec_ble_run_duty_benchmark(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,167 @@
+/*
+ * NETSEC - BLE scan lifecycle word
+ *
+ * The state word of netsec_ble.cpp and its compare-and-swap transitions,
+ * without the radio or the RTOS: each request returns what the caller has
+ * to do next (wake the worker, abort the radio's scan slice). Header-only so
+ * test_ble_lifecycle drives the same code from host threads.
+ *
+ *   IDLE --start--> STARTING --worker--> SCANNING --timeout/stop--> STOPPING
+ *     ^                 |                                               |
+ *     +-----------------+--stop (worker skips the scan)----> ... -------+
+ *                         worker finalizes: IDLE, or STARTING if RESTART
+ *
+ * Only the worker leaves STARTING for SCANNING and leaves STOPPING, so
+ * each generation is run and finalized exactly once.
+ */
+
+#ifndef NETSEC_BLE_STATE_H
+#define NETSEC_BLE_STATE_H
+
+#include <stdint.h>
+#include <atomic>
+
+enum {
+  BLE_STATE_IDLE = 0,
+  BLE_STATE_STARTING,
+  BLE_STATE_SCANNING,
+  BLE_STATE_STOPPING,
+};
+
+#define BLE_STATE_MASK      0x07u
+#define BLE_FLAG_CANCELED   0x08u     // Stop requested (vs. duration elapsed)
+#define BLE_FLAG_RESTART    0x10u     // Start requested while busy
+#define BLE_GEN_SHIFT       8
+
+// Between reading the word and swapping it. test_ble_lifecycle yields there
+// so its host threads interleave inside the transitions even on one CPU.
+#ifndef BLE_LC_RACE_POINT
+#define BLE_LC_RACE_POINT()
+#endif
+
+// What a request leaves to its caller
+typedef enum {
+  BLE_LC_NOTHING = 0,     // Already requested, or nothing to do
+  BLE_LC_WAS_IDLE,        // Stop with no scan
+  BLE_LC_WAKE_START,      // New generation: wake the worker
+  BLE_LC_WAKE_CANCEL,     // Stopped before it began: wake the worker
+  BLE_LC_ABORT_SCAN,      // Stopped while scanning: abort the radio slice, wake the worker
+} ble_lc_action_t;
+
+static inline uint32_t ble_state(uint32_t w) { return w & BLE_STATE_MASK; }
+static inline uint32_t ble_gen(uint32_t w) { return w >> BLE_GEN_SHIFT; }
+static inline uint32_t ble_word(uint32_t state, uint32_t gen, uint32_t flags) {
+  return (gen << BLE_GEN_SHIFT) | flags | state;
+}
+
+// Move `expected` (STARTING or SCANNING) to STOPPING; false if the word changed
+static inline ble_lc_action_t ble_lc_try_stop(std::atomic<uint32_t>& word, uint32_t expected, uint32_t flags) {
+  const uint32_t next = ble_word(BLE_STATE_STOPPING, ble_gen(expected), flags);
+  BLE_LC_RACE_POINT();
+  if (!word.compare_exchange_strong(expected, next, std::memory_order_acq_rel)) {
+    return BLE_LC_NOTHING;
+  }
+  return ble_state(expected) == BLE_STATE_SCANNING ? BLE_LC_ABORT_SCAN : BLE_LC_WAKE_CANCEL;
+}
+
+// Start: a new generation from IDLE, a restart when busy
+static inline ble_lc_action_t ble_lc_start(std::atomic<uint32_t>& word) {
+  uint32_t w = word.load(std::memory_order_acquire);
+  for (;;) {
+    switch (ble_state(w)) {
+      case BLE_STATE_IDLE:
+        BLE_LC_RACE_POINT();
+        if (word.compare_exchange_weak(w, ble_word(BLE_STATE_STARTING, ble_gen(w) + 1, 0),
+                                       std::memory_order_acq_rel)) {
+          return BLE_LC_WAKE_START;
+        }
+        break;
+      case BLE_STATE_STARTING:
+        return BLE_LC_NOTHING;   // Not begun yet: picks up the new duration
+      case BLE_STATE_SCANNING: {
+        const ble_lc_action_t action = ble_lc_try_stop(word, w, BLE_FLAG_CANCELED | BLE_FLAG_RESTART);
+        if (action != BLE_LC_NOTHING) return action;
+        w = word.load(std::memory_order_acquire);
+        break;
+      }
+      default:   // STOPPING: restart once the worker has finalized
+        BLE_LC_RACE_POINT();
+        if ((w & BLE_FLAG_RESTART) ||
+            word.compare_exchange_weak(w, w | BLE_FLAG_RESTART, std::memory_order_acq_rel)) {
+          return BLE_LC_NOTHING;
+        }
+        break;
+    }
+  }
+}
+
+// Stop: cancels the scan, or the restart pending on the way to STOPPING
+static inline ble_lc_action_t ble_lc_stop(std::atomic<uint32_t>& word) {
+  uint32_t w = word.load(std::memory_order_acquire);
+  for (;;) {
+    switch (ble_state(w)) {
+      case BLE_STATE_IDLE:
+        return BLE_LC_WAS_IDLE;
+      case BLE_STATE_STARTING:
+      case BLE_STATE_SCANNING: {
+        const ble_lc_action_t action = ble_lc_try_stop(word, w, BLE_FLAG_CANCELED);
+        if (action != BLE_LC_NOTHING) return action;
+        w = word.load(std::memory_order_acquire);
+        break;
+      }
+      default:   // STOPPING: only a pending restart is left to cancel
+        BLE_LC_RACE_POINT();
+        if (!(w & BLE_FLAG_RESTART) ||
+            word.compare_exchange_weak(w, (w & ~BLE_FLAG_RESTART) | BLE_FLAG_CANCELED,
+                                       std::memory_order_acq_rel)) {
+          return BLE_LC_NOTHING;
+        }
+        break;
+    }
+  }
+}
+
+// Scan timeout: ends generation `gen` if it is still the one scanning. A late
+// expiry from an earlier scan must not end the current one.
+static inline ble_lc_action_t ble_lc_timeout(std::atomic<uint32_t>& word, uint32_t gen) {
+  const uint32_t w = word.load(std::memory_order_acquire);
+  if (ble_state(w) != BLE_STATE_SCANNING || ble_gen(w) != gen) return BLE_LC_NOTHING;
+  return ble_lc_try_stop(word, w, w & BLE_FLAG_RESTART);
+}
+
+// Worker: STARTING to SCANNING. False if a stop won the race and the
+// generation ends before it began.
+static inline bool ble_lc_begin(std::atomic<uint32_t>& word, uint32_t w) {
+  BLE_LC_RACE_POINT();
+  return ble_state(w) == BLE_STATE_STARTING &&
+         word.compare_exchange_strong(w, ble_word(BLE_STATE_SCANNING, ble_gen(w), w & BLE_FLAG_RESTART),
+                                      std::memory_order_acq_rel);
+}
+
+// Worker: duration reached before the timer fired, complete it ourselves
+static inline void ble_lc_end(std::atomic<uint32_t>& word, uint32_t gen) {
+  uint32_t w = word.load(std::memory_order_acquire);
+  BLE_LC_RACE_POINT();
+  while (ble_state(w) == BLE_STATE_SCANNING &&
+         !word.compare_exchange_weak(w, ble_word(BLE_STATE_STOPPING, gen, w & BLE_FLAG_RESTART),
+                                     std::memory_order_acq_rel)) {
+  }
+}
+
+// Worker: leave STOPPING for IDLE, or straight into the next generation if
+// a restart is pending. `*ended` gets the STOPPING word (its CANCELED and
+// RESTART flags). False if the word is not STOPPING for `gen`: unreachable
+// by construction, counted as an error by the caller.
+static inline bool ble_lc_finalize(std::atomic<uint32_t>& word, uint32_t gen, uint32_t* ended) {
+  uint32_t w = word.load(std::memory_order_acquire);
+  uint32_t next;
+  do {
+    if (ble_state(w) != BLE_STATE_STOPPING || ble_gen(w) != gen) return false;
+    next = (w & BLE_FLAG_RESTART) ? ble_word(BLE_STATE_STARTING, gen + 1, 0) : ble_word(BLE_STATE_IDLE, gen, 0);
+    BLE_LC_RACE_POINT();
+  } while (!word.compare_exchange_weak(w, next, std::memory_order_acq_rel));
+  *ended = w;
+  return true;
+}
+
+#endif // NETSEC_BLE_STATE_H
@@ -0,0 +1,123 @@
+/*
+ * NETSEC - Known devices
+ *
+ * Bloom filter of the WiFi BSSIDs and BLE addresses seen over the last days
+ * of operation, kept in NETSEC_KNOWN_FILE on the storage file system, so a
+ * result can carry a "new" flag (NETSEC_WIFI_FLAG_NEW, NETSEC_BLE_FLAG_NEW)
+ * without storing any address.
+ *
+ * Generational instead of counting: NETSEC_KNOWN_GENERATIONS filters, one
+ * open for inserts. It is closed after NETSEC_KNOWN_GEN_HOURS of uptime or
+ * NETSEC_KNOWN_GEN_CAPACITY inserts, and the oldest one is cleared and
+ * reopened, so the filter forgets after 3-4 generations and its false
+ * positive rate stays bounded. An address found only in a closed generation
+ * is copied into the open one.
+ *
+ * A device stays new for the whole session: the first time it is found
+ * unknown it goes into a RAM-only session filter, checked for the later
+ * reports. BLE addresses that rotate (resolvable / non-resolvable private)
+ * are never new and never stored: they would fill the filter for nothing.
+ *
+ * Checkpoints (NETSEC_KNOWN_CHECKPOINT_S, only when a bit changed) rewrite
+ * the open generation in place, then the header, which holds the CRC of
+ * every generation. A generation that does not match its CRC on load (a
+ * cut between the two writes, worn flash) is cleared: its devices show up
+ * as new once more rather than bits nobody wrote making devices known.
+ */
+
+#ifndef NETSEC_KNOWN_H
+#define NETSEC_KNOWN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define NETSEC_KNOWN_GENERATIONS    4
+#define NETSEC_KNOWN_GEN_BITS       16384   // 2 KB per generation
+#define NETSEC_KNOWN_GEN_BYTES      (NETSEC_KNOWN_GEN_BITS / 8)
+#define NETSEC_KNOWN_HASHES         7       // Optimal near NETSEC_KNOWN_GEN_CAPACITY
+#define NETSEC_KNOWN_GEN_CAPACITY   1500    // 0.5 % false positives per full generation
+#ifndef NETSEC_KNOWN_GEN_HOURS
+#define NETSEC_KNOWN_GEN_HOURS      48
+#endif
+#define NETSEC_KNOWN_SESSION_BITS   8192    // RAM only: new devices of this session
+#define NETSEC_KNOWN_SESSION_HASHES 4
+#ifndef NETSEC_KNOWN_CHECKPOINT_S
+#define NETSEC_KNOWN_CHECKPOINT_S   900
+#endif
+
+#define NETSEC_KNOWN_FILE           "/known.bin"
+#define NETSEC_KNOWN_MAGIC          0x324E4B4Eu   // "NKN2"
+
+typedef enum {
+  NETSEC_KNOWN_WIFI = 0,
+  NETSEC_KNOWN_BLE,
+} netsec_known_kind_t;
+
+typedef struct {
+  bool loaded;                // File read (or started empty)
+  uint8_t current;            // Open generation
+  uint32_t uptime_s;          // Operating time across boots
+  uint32_t gen_inserted[NETSEC_KNOWN_GENERATIONS];
+  uint32_t gen_age_s[NETSEC_KNOWN_GENERATIONS];
+  uint16_t gen_fill_pct[NETSEC_KNOWN_GENERATIONS];  // Bits set
+  uint32_t fp_ppm;            // Estimated false positive rate over all generations
+  uint32_t lookups;
+  uint32_t new_devices;       // Flagged new this session
+  uint32_t skipped;           // Rotating BLE addresses
+  uint32_t rotations;
+  uint32_t checkpoints;
+  uint32_t checkpoint_failed;
+  uint32_t bytes_written;     // Since boot
+  uint32_t checkpoint_us_max;
+} netsec_known_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * True if the address was not seen in the last generations (or already
+ * flagged new this session), and records it. `rotating`: BLE private
+ * address, answered false. False as well until the file is loaded.
+ */
+bool netsec_known_check(netsec_known_kind_t kind, const uint8_t* addr, bool rotating);
+
+/*
+ * Loads the file once the storage is mounted, closes the open generation
+ * when due and checkpoints; from netsec_task, about once a second.
+ */
+void netsec_known_poll(void);
+
+// Checkpoint now if anything changed
+bool netsec_known_flush(void);
+
+void netsec_known_get_stats(netsec_known_stats_t* out);
+
+/*
+ * Measured false positive rate, ppm, of a private filter holding `gens`
+ * generations of `per_gen` addresses, over addresses never inserted.
+ */
+uint32_t netsec_known_fp_ppm(uint32_t per_gen, uint8_t gens);
+
+/*
+ * A private filter through a scratch file, the storage mounted: whole
+ * file and one-generation checkpoints reloaded identical, a generation
+ * written without its header cleared on reload (the others kept), a
+ * damaged header rejected. Returns the failed cases, the cases tried in
+ * *cases (test/test_known).
+ */
+uint32_t netsec_known_check_reload(uint32_t* cases);
+
+/*
+ * Built with -D NETSEC_KNOWN_RUN_BENCHMARK: false positive rate of one
+ * generation at several fill levels and of all generations full against
+ * the theory, lookup throughput, then the checkpoint size and time and the
+ * flash bytes a day of checkpoints costs. Boot task, the storage mounted.
+ */
+void netsec_known_run_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NETSEC_KNOWN_H
@@ -0,0 +1,112 @@
+/*
+ * NETSEC - Device registry
+ *
+ * One record per WiFi BSSID / BLE address across scans: first and last
+ * seen, reports, RSSI last / min / max / mean, the last non-empty SSID or
+ * name. netsec_wifi_post_ap() / netsec_ble_post_device() report into it and
+ * the UI only gets what changed on netsec_result_queue:
+ *
+ * - NETSEC_RES_DEVICE_ADDED: first report, or back after being gone
+ *   (first seen and counts kept).
+ * - NETSEC_RES_DEVICE_CHANGED: RSSI moved by the policy step since the
+ *   last diff, name / channel / flags changed.
+ * - NETSEC_RES_DEVICE_GONE: missed the policy's number of completed scans
+ *   of its kind, or evicted.
+ *
+ * Records are static, NETSEC_REGISTRY_BUDGET bytes. With the table full a
+ * new address takes the gone record seen longest ago, else the present one
+ * seen longest ago (sent as gone). Gone records are kept for their history
+ * until the policy forgets them.
+ *
+ * Any task, under a spinlock; diffs are built under the lock and queued
+ * after it, without waiting. A diff the full queue refuses is not lost: the
+ * record keeps it pending and sends it again on its next report or the next
+ * completed scan of either kind, so the UI catches up once the queue
+ * drains. While a few GONE diffs of evicted records are still waiting, new
+ * addresses that would evict a shown record are refused.
+ */
+
+#ifndef NETSEC_REGISTRY_H
+#define NETSEC_REGISTRY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "netsec_api.h"
+
+#ifndef NETSEC_REGISTRY_BUDGET
+#define NETSEC_REGISTRY_BUDGET        4608  // Bytes of records
+#endif
+#define NETSEC_REGISTRY_RECORD_BYTES  72    // Checked at build time
+#define NETSEC_REGISTRY_CAPACITY      (NETSEC_REGISTRY_BUDGET / NETSEC_REGISTRY_RECORD_BYTES)
+
+// Default policy
+#ifndef NETSEC_REGISTRY_MISSED_SCANS
+#define NETSEC_REGISTRY_MISSED_SCANS  3
+#endif
+#ifndef NETSEC_REGISTRY_GONE_MS
+#define NETSEC_REGISTRY_GONE_MS       60000
+#endif
+#ifndef NETSEC_REGISTRY_FORGET_MS
+#define NETSEC_REGISTRY_FORGET_MS     (60u * 60u * 1000u)
+#endif
+#define NETSEC_REGISTRY_RSSI_STEP     6     // dB
+
+typedef struct {
+  uint8_t missed_scans;       // Completed scans of its kind without a report (0: never gone)
+  uint32_t gone_ms;           // ... and no report for at least this long
+  uint32_t forget_ms;         // Gone records dropped after this long (0: kept until evicted)
+  uint8_t rssi_step;          // dB from the last diff for a CHANGED
+} netsec_registry_policy_t;
+
+typedef struct {
+  uint16_t capacity;
+  uint16_t present[2];        // By netsec_device_kind_t
+  uint16_t gone;              // Kept for their history
+  uint16_t peak;              // Records in use
+  uint32_t reports;
+  uint32_t added;
+  uint32_t changed;
+  uint32_t gone_sent;
+  uint32_t evicted;           // Present records pushed out by a new address
+  uint32_t recycled;          // Gone records reused before being forgotten
+  uint32_t forgotten;
+  uint32_t refused;           // Reports of new addresses with no record to take
+  uint32_t diffs_deferred;    // Result queue full: pending, sent again later
+  uint32_t diffs_lost;        // ... a GONE with nowhere left to wait
+  uint16_t pending;           // Diffs waiting now
+  uint32_t bytes;             // Record table
+} netsec_registry_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Every WiFi AP / BLE device reported; name may be empty, channel 0 for BLE
+void netsec_registry_report(netsec_device_kind_t kind, const uint8_t* addr, int8_t rssi,
+                            const char* name, uint8_t channel, uint32_t flags);
+
+// End of a completed scan of that kind: ages its records, forgets old ones
+void netsec_registry_scan_done(netsec_device_kind_t kind);
+
+void netsec_registry_set_policy(const netsec_registry_policy_t* policy);
+void netsec_registry_get_policy(netsec_registry_policy_t* out);
+
+// Copy of the record, false if the address is not registered
+bool netsec_registry_lookup(netsec_device_kind_t kind, const uint8_t* addr, netsec_device_t* out);
+
+void netsec_registry_get_stats(netsec_registry_stats_t* out);
+
+/*
+ * Built with -D NETSEC_REGISTRY_RUN_BENCHMARK: a private registry fed
+ * NETSEC_REGISTRY_BENCH_SCANS scans of fixed APs and devices plus a stream
+ * of rotating BLE addresses, its diffs applied to a model as the UI does:
+ * diff counts, peaks, evictions and throughput. The budget, the model and
+ * the fixed devices are checked by test/test_registry. Boot task.
+ */
+void netsec_registry_run_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NETSEC_REGISTRY_H
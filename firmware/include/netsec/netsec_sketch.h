@@ -0,0 +1,105 @@
+/*
+ * NETSEC - Streaming sketches
+ *
+ * Aggregate statistics over every WiFi AP and BLE device reported, in a
+ * fixed memory budget whatever the session length (MAC randomisation gives
+ * thousands of BLE addresses an hour; the exact tables hold 16 / 32):
+ *
+ * - HyperLogLog (2^NETSEC_SKETCH_HLL_P registers) per kind: distinct
+ *   addresses since the last reset, and over sliding windows built from
+ *   NETSEC_SKETCH_SLOTS slot sketches of NETSEC_SKETCH_SLOT_S each. A window
+ *   is whole slots, the current (partial) one included. Standard error
+ *   1.04 / sqrt(2^P): 6.5 % at P = 8.
+ * - Count-min sketch (conservative update, both kinds) with the
+ *   NETSEC_SKETCH_TOP addresses reported most often. Estimates never
+ *   undercount; counters are halved when one saturates, the list with them.
+ * - Exponential histogram per kind: reports in the last seconds (up to
+ *   NETSEC_SKETCH_EH_WINDOW_S), within 1 / NETSEC_SKETCH_EH_K. Every report
+ *   counts: a device seen by each scan counts at each scan.
+ *
+ * Fed from netsec_wifi_post_ap() / netsec_ble_post_device(), any task, under
+ * a spinlock; queries copy what they need under the lock.
+ */
+
+#ifndef NETSEC_SKETCH_H
+#define NETSEC_SKETCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define NETSEC_SKETCH_HLL_P         8
+#define NETSEC_SKETCH_HLL_REGS      (1u << NETSEC_SKETCH_HLL_P)
+#define NETSEC_SKETCH_SLOT_S        600   // 10 min
+#define NETSEC_SKETCH_SLOTS         6     // Longest window: 1 h
+#define NETSEC_SKETCH_CM_DEPTH      4
+#define NETSEC_SKETCH_CM_WIDTH      256   // Power of two
+#define NETSEC_SKETCH_TOP           8
+#define NETSEC_SKETCH_EH_K          8     // Relative error 1/K
+#define NETSEC_SKETCH_EH_WINDOW_S   600
+#define NETSEC_SKETCH_EH_BUCKETS    96    // Oldest bucket dropped when full
+#define NETSEC_SKETCH_BUDGET        8192  // Bytes, checked at build time
+
+typedef enum {
+  NETSEC_SKETCH_WIFI = 0,
+  NETSEC_SKETCH_BLE,
+  NETSEC_SKETCH_KINDS,
+} netsec_sketch_kind_t;
+
+typedef struct {
+  uint8_t addr[6];
+  uint8_t kind;               // netsec_sketch_kind_t
+  uint32_t count;             // Count-min estimate (upper bound)
+} netsec_sketch_top_t;
+
+typedef struct {
+  uint32_t reports;           // Since the last reset
+  uint32_t halvings;          // Count-min saturations
+  uint32_t eh_dropped;        // Buckets dropped with the histogram full
+  uint32_t unique[NETSEC_SKETCH_KINDS];          // Since the last reset
+  uint32_t unique_window[NETSEC_SKETCH_KINDS];   // Last NETSEC_SKETCH_SLOTS slots
+  uint32_t per_minute[NETSEC_SKETCH_KINDS];      // Reports in the last 60 s
+  uint8_t top_count;
+  netsec_sketch_top_t top[NETSEC_SKETCH_TOP];    // Most reported first
+  uint32_t bytes;             // Sketch state
+} netsec_sketch_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Called for every WiFi AP / BLE device reported
+void netsec_sketch_observe(netsec_sketch_kind_t kind, const uint8_t* addr);
+
+// Forget everything (new session)
+void netsec_sketch_reset(void);
+
+// Distinct addresses in the last window_s seconds, rounded up to whole
+// slots (0: since the reset)
+uint32_t netsec_sketch_unique(netsec_sketch_kind_t kind, uint32_t window_s);
+
+// Reports in the last window_s seconds (at most NETSEC_SKETCH_EH_WINDOW_S)
+uint32_t netsec_sketch_rate(netsec_sketch_kind_t kind, uint32_t window_s);
+
+// Count-min estimate for one address
+uint32_t netsec_sketch_frequency(netsec_sketch_kind_t kind, const uint8_t* addr);
+
+void netsec_sketch_get_stats(netsec_sketch_stats_t* out);
+
+// One summary line on the log (end of each scan)
+void netsec_sketch_log(void);
+
+/*
+ * Built with -D NETSEC_SKETCH_RUN_BENCHMARK: a synthetic crowded session
+ * (fixed APs and beacons, a few chatty devices, randomised BLE addresses
+ * arriving and leaving) of NETSEC_SKETCH_BENCH_MINUTES fed to a private
+ * sketch with its own clock, compared every slot with exact counts kept
+ * on the heap; then update throughput. The error bounds are checked by
+ * test/test_sketch. Boot task.
+ */
+void netsec_sketch_run_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NETSEC_SKETCH_H
@@ -0,0 +1,133 @@
+/*
+ * NETSEC - Unattended survey
+ *
+ * Survey mode runs without the UI: wake on the sleep timer, sweep WiFi and
+ * BLE together for a few seconds, fold what was seen into a summary kept in
+ * RTC slow memory, switch both radios off and go back to light sleep with
+ * the backlight off and LVGL paused. A touch (XPT2046 IRQ on GPIO 36 wakes
+ * the chip) or netsec_survey_stop() ends it.
+ *
+ * The summary has one entry per distinct WiFi BSSID / BLE address of the
+ * current window: first and last seen, strongest RSSI, sweeps that saw it.
+ * It is RTC_NOINIT and CRC checked, so a watchdog or panic reset keeps it
+ * and resumes the survey; a power-on starts clean. Every
+ * NETSEC_SURVEY_FLUSH_SWEEPS sweeps, or once the table is 3/4 full, the
+ * window is appended to NETSEC_SURVEY_FILE on the storage file system as
+ * one batch and a new window starts, so flash is written a few times a day.
+ *
+ * File: batches back to back, each a netsec_survey_batch_t followed by
+ * `entries` netsec_survey_entry_t (little endian, packed as declared).
+ * Past NETSEC_SURVEY_FILE_MAX bytes it is renamed to NETSEC_SURVEY_FILE_OLD
+ * (replacing the previous one) and a new file starts.
+ */
+
+#ifndef NETSEC_SURVEY_H
+#define NETSEC_SURVEY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Wake period (sweep included)
+#ifndef NETSEC_SURVEY_PERIOD_S
+#define NETSEC_SURVEY_PERIOD_S        300
+#endif
+// BLE part of a sweep; the WiFi scan runs alongside
+#ifndef NETSEC_SURVEY_BLE_MS
+#define NETSEC_SURVEY_BLE_MS          3000
+#endif
+#ifndef NETSEC_SURVEY_FLUSH_SWEEPS
+#define NETSEC_SURVEY_FLUSH_SWEEPS    12
+#endif
+
+#define NETSEC_SURVEY_MAX_ENTRIES     160   // RTC table (window)
+#define NETSEC_SURVEY_SWEEP_MAX       96    // Distinct addresses staged per sweep
+#define NETSEC_SURVEY_RTC_BUDGET      4096  // Of the 8 KB RTC slow memory
+#define NETSEC_SURVEY_SWEEP_TIMEOUT_MS 15000
+#define NETSEC_SURVEY_TASK_STACK_SIZE 4096
+#define NETSEC_SURVEY_UI_POLL_MS      200   // UI task period while surveying
+
+#define NETSEC_SURVEY_FILE            "/survey.bin"
+#define NETSEC_SURVEY_FILE_OLD        "/survey.old"
+#define NETSEC_SURVEY_FILE_MAX        (256 * 1024)
+#define NETSEC_SURVEY_BATCH_MAGIC     0x31565253u   // "SRV1"
+
+typedef enum {
+  NETSEC_SURVEY_WIFI = 1,
+  NETSEC_SURVEY_BLE = 2,
+} netsec_survey_kind_t;
+
+typedef struct {
+  uint8_t addr[6];            // BSSID or BLE address
+  uint8_t kind;               // netsec_survey_kind_t
+  int8_t best_rssi;
+  uint32_t first_s;           // Survey clock: seconds since the survey started
+  uint32_t last_s;
+  uint16_t sweeps;            // Sweeps that saw it
+  uint16_t reserved;
+} netsec_survey_entry_t;
+
+typedef struct {
+  uint32_t magic;             // NETSEC_SURVEY_BATCH_MAGIC
+  uint32_t start_s;           // Window, survey clock
+  uint32_t end_s;
+  uint32_t sweeps;
+  uint16_t entries;
+  uint16_t wifi_unique;
+  uint16_t ble_unique;
+  uint16_t overflow;          // Observations of new addresses with the table full
+} netsec_survey_batch_t;
+
+typedef struct {
+  bool active;
+  uint32_t period_s;
+  uint32_t clock_s;           // Survey clock now
+  uint32_t cycles;            // Wake / sweep / sleep cycles since the start
+  uint32_t awake_ms;          // Sweep, fold and flush time
+  uint32_t awake_max_ms;
+  uint32_t asleep_ms;         // Time spent in light sleep
+  uint16_t entries;           // Current window
+  uint16_t entries_peak;
+  uint16_t wifi_unique;
+  uint16_t ble_unique;
+  uint32_t overflow;          // Since the start
+  uint32_t staged_dropped;    // Sweep staging full
+  uint32_t batches;           // Windows written to the file
+  uint32_t flush_failed;
+  uint32_t file_bytes;        // Written since the start
+  uint32_t resumed;           // Survey picked up again after a reset
+} netsec_survey_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Create the survey task (parked) and resume a survey a reset interrupted
+void netsec_survey_init(void);
+
+// Enter survey mode (period 0: NETSEC_SURVEY_PERIOD_S); any task
+bool netsec_survey_start(uint32_t period_s);
+
+// Leave at the end of the current sweep; the window is flushed
+void netsec_survey_stop(void);
+
+bool netsec_survey_is_active(void);
+
+// Called for every WiFi AP / BLE device reported; staged only during a sweep
+void netsec_survey_observe(netsec_survey_kind_t kind, const uint8_t* addr, int rssi);
+
+void netsec_survey_get_stats(netsec_survey_stats_t* out);
+
+/*
+ * Built with -D NETSEC_SURVEY_RUN_BENCHMARK: runs NETSEC_SURVEY_BENCH_CYCLES
+ * cycles (boot task), then reports the table peak, the bytes written, the
+ * measured duty cycle and the battery life it implies. The file layout and
+ * memory bounds are covered by test/test_survey. In the native sim light
+ * sleep is a delay of the survey task in virtual time.
+ */
+void netsec_survey_run_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NETSEC_SURVEY_H
@@ -14,6 +14,9 @@ void netsec_wifi_start_scan(void);
 // Stop an ongoing WiFi scan (if supported)
 void netsec_wifi_stop_scan(void);
 
+// True from start until the scan-done callback has posted the results
+bool netsec_wifi_is_scanning(void);
+
 // Convert low-level scan result into netsec_result_t and post to queue
 void netsec_wifi_post_ap(const char* ssid, int32_t rssi, uint8_t channel, const uint8_t* bssid);
 
@@ -17,8 +17,11 @@ typedef struct {
     int8_t rssi;                // RSSI signal strength
     uint8_t bssid[6];           // MAC address
     uint8_t channel;            // WiFi channel
+    uint8_t flags;              // NETSEC_WIFI_FLAG_*
 } netsec_wifi_ap_t;
 
+#define NETSEC_WIFI_FLAG_NEW    0x01u       // Not seen in the last days (netsec/netsec_known.h)
+
 /* BLE device result structure */
 typedef struct {
     char name[32];              // Device name (UTF-8, max 31 chars + NUL)
@@ -28,6 +31,30 @@ typedef struct {
     uint32_t flags;             // Bitmask describing advertisement/properties
 } netsec_ble_device_t;
 
+#define NETSEC_BLE_FLAG_ADDR_TYPE 0x03u     // Low bits: esp_ble_addr_type_t of the address
+#define NETSEC_BLE_FLAG_NEW     0x80000000u // Not seen in the last days (netsec/netsec_known.h)
+
+/* Device registry record (netsec/netsec_registry.h), sent as a diff */
+typedef enum {
+    NETSEC_DEVICE_WIFI = 0,
+    NETSEC_DEVICE_BLE,
+} netsec_device_kind_t;
+
+typedef struct {
+    uint8_t kind;               // netsec_device_kind_t
+    uint8_t addr[6];            // BSSID or BLE address
+    uint8_t channel;            // WiFi channel, 0 for BLE
+    int8_t rssi;                // Last report
+    int8_t rssi_min;
+    int8_t rssi_max;
+    int8_t rssi_avg;            // Mean over the reports
+    uint32_t flags;             // NETSEC_WIFI_FLAG_* / NETSEC_BLE_FLAG_*
+    uint32_t first_seen_ms;     // millis()
+    uint32_t last_seen_ms;
+    uint32_t seen_count;        // Reports
+    char name[33];              // SSID or BLE name, last non-empty one
+} netsec_device_t;
+
 /* Scan completion metadata shared across WiFi/BLE */
 typedef struct {
     uint16_t item_count;        // Number of APs/devices reported during the scan
@@ -38,12 +65,15 @@ typedef struct {
 /* NETSEC result types pushed to netsec_result_queue */
 typedef enum {
     NETSEC_RES_NONE = 0,
-    NETSEC_RES_WIFI_AP,          // WiFi AP found
+    NETSEC_RES_WIFI_AP,          // WiFi AP found (serial export only, queued as registry diffs)
     NETSEC_RES_WIFI_SCAN_DONE,   // WiFi scan complete
     NETSEC_RES_BLE_SCAN_STARTED, // BLE scan started
-    NETSEC_RES_BLE_DEVICE_FOUND, // BLE device found
+    NETSEC_RES_BLE_DEVICE_FOUND, // BLE device found (serial export only, queued as registry diffs)
     NETSEC_RES_BLE_SCAN_COMPLETED, // BLE scan complete (duration reached)
     NETSEC_RES_BLE_SCAN_CANCELED,  // BLE scan canceled by user
+    NETSEC_RES_DEVICE_ADDED,     // Registry diffs, data.device
+    NETSEC_RES_DEVICE_CHANGED,
+    NETSEC_RES_DEVICE_GONE,
 } netsec_result_type_t;
 
 /* NETSEC result structure sent via queue */
@@ -52,6 +82,7 @@ typedef struct {
     union {
         netsec_wifi_ap_t wifi_ap;
         netsec_ble_device_t ble_device;
+        netsec_device_t device;             // NETSEC_RES_DEVICE_*
         netsec_scan_summary_t scan_summary; // Populated for BLE/WiFi scan lifecycle events
     } data;
 } netsec_result_t;
@@ -63,6 +94,8 @@ typedef enum {
     NETSEC_CMD_BLE_SCAN_START,
     NETSEC_CMD_BLE_SCAN_STOP,
     NETSEC_CMD_BLE_SCAN_CANCEL = NETSEC_CMD_BLE_SCAN_STOP, // Alias for compatibility
+    NETSEC_CMD_SURVEY_START,     // Unattended survey (netsec/netsec_survey.h)
+    NETSEC_CMD_SURVEY_STOP,
 } netsec_command_type_t;
 
 typedef struct {
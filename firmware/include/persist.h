@@ -0,0 +1,97 @@
+/*
+ * ARCHI - Persistence
+ *
+ * One small state blob (pet + settings) that survives reboots and power
+ * cuts. It lives in its own flash partition ("petstate", partitions_custom.csv),
+ * not in SPIFFS: no file system, no JSON, no rewrite of a whole file.
+ *
+ * The partition is two 4 KB sectors used as alternating banks. Every save
+ * appends a fixed-size record (magic, sequence number, length, CRC32) to the
+ * active bank; when it is full the other bank is erased and becomes active.
+ * The newest record whose CRC checks is the state, so a cut in the middle
+ * of a write or an erase always leaves the previous record readable. At
+ * boot the whole partition is fetched in a single read and scanned in RAM.
+ *
+ * persist_save() only copies the blob under a mutex: the first change arms
+ * a PERSIST_DEBOUNCE_MS deadline and every later change before it is
+ * coalesced into the same write. Flash is programmed by a low-priority task
+ * on core 0, never from the UI task.
+ */
+
+#ifndef PERSIST_H
+#define PERSIST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PERSIST_PARTITION_LABEL   "petstate"
+#define PERSIST_PARTITION_SUBTYPE 0x40
+
+#define PERSIST_SECTOR_SIZE       4096
+#define PERSIST_SLOT_SIZE         128
+#define PERSIST_HEADER_SIZE       16
+#define PERSIST_PAYLOAD_MAX       (PERSIST_SLOT_SIZE - PERSIST_HEADER_SIZE)
+
+// Longest time a change waits in RAM (bounds the loss on power cut)
+#ifndef PERSIST_DEBOUNCE_MS
+#define PERSIST_DEBOUNCE_MS       60000
+#endif
+
+#define PERSIST_TASK_STACK_SIZE   3072
+#define PERSIST_TASK_PRIORITY     1
+
+typedef struct {
+  uint32_t saves;           // persist_save() calls accepted
+  uint32_t coalesced;       // Saves merged into an already pending write
+  uint32_t unchanged;       // Saves identical to the stored blob (dropped)
+  uint32_t written;         // Records programmed and verified
+  uint32_t failed;          // Writes that could not be verified
+  uint32_t erases;          // Bank switches
+  uint32_t seq;             // Sequence number of the newest record
+  uint32_t write_us_last;   // Flash time of the last record (erase included)
+  uint32_t write_us_max;
+  uint32_t save_us_max;     // Caller-side cost of persist_save()
+} persist_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Find the partition, restore the newest valid record and start the
+ * writer task. Without the partition saves stay in RAM (logged once).
+ */
+void persist_init(void);
+
+/* Copy the restored blob; returns its length, 0 when nothing was saved. */
+uint16_t persist_load(void* out, uint16_t max_len);
+
+/* Stage a new blob (any task, never touches flash). False if too large. */
+bool persist_save(const void* data, uint16_t len);
+
+/* Write the pending blob now and wait up to timeout_ms for it. */
+bool persist_flush(uint32_t timeout_ms);
+
+void persist_get_stats(persist_stats_t* out);
+
+/**
+ * Power-cut injection on a RAM copy of the store: every byte offset of a
+ * record write and of a bank switch (erase stepped by 64 bytes), each
+ * followed by a reopen that must find the old or the new blob and a save
+ * that must still work. Returns the failed offsets, the offsets tried in
+ * *cases. Does not touch the partition (test/test_persist).
+ */
+uint32_t persist_check_power_cuts(uint32_t* cases);
+
+/**
+ * Built with -D PERSIST_RUN_BENCHMARK: the power-cut check, boot restore
+ * time, then save() and flash write latency on the real partition (the
+ * stored blob is kept). Call from the UI task.
+ */
+void persist_run_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PERSIST_H
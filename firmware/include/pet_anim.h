@@ -0,0 +1,122 @@
+/*
+ * PIXEL - Pet Animation Engine
+ *
+ * Plays the pet: one timeline of frames per state (idle, eat, sleep, react),
+ * frames are either ASCII art (UNSCII 16 cells) or small 1-bit sprites,
+ * and an interpolated horizontal wander while idle. Time is accounted per
+ * millisecond, so playback is frame-accurate whatever the tick cadence: a
+ * late tick skips the frames it overran instead of slowing the animation.
+ *
+ * Each advance returns the rectangles that actually changed on screen. The
+ * diffs between consecutive frames of a timeline are computed once at init
+ * (per-row runs of changed cells for ASCII, changed-pixel box for sprites).
+ *
+ * No LVGL in here: coordinates are pixels relative to the pet's home box,
+ * the renderer (ui_pet) maps them to the screen.
+ */
+
+#ifndef PET_ANIM_H
+#define PET_ANIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ASCII frames: PET_ASCII_ROWS x PET_ASCII_COLS cells of UNSCII 16
+#define PET_CELL_W        8
+#define PET_CELL_H        16
+#define PET_ASCII_COLS    11
+#define PET_ASCII_ROWS    3
+
+// Sprite frames: 16x16, 1 bit per pixel, drawn at PET_SPRITE_SCALE
+#define PET_SPRITE_SIZE   16
+#define PET_SPRITE_SCALE  3
+
+// Home box (the pet wanders +/- its path around it)
+#define PET_BOX_W         (PET_ASCII_COLS * PET_CELL_W)
+#define PET_BOX_H         (PET_ASCII_ROWS * PET_CELL_H)
+
+#define PET_ANIM_MAX_STEPS 8
+#define PET_ANIM_MAX_RECTS 4
+
+typedef enum {
+  PET_STATE_IDLE = 0,
+  PET_STATE_EAT,
+  PET_STATE_SLEEP,
+  PET_STATE_REACT,
+  PET_STATE_COUNT,
+} pet_state_t;
+
+typedef enum {
+  PET_FRAME_ASCII = 0,
+  PET_FRAME_SPRITE,
+} pet_frame_kind_t;
+
+typedef struct {
+  pet_frame_kind_t kind;
+  const char* ascii;          // PET_ASCII_ROWS * PET_ASCII_COLS chars, row-major
+  const uint16_t* sprite;     // PET_SPRITE_SIZE rows, bit 15 = leftmost pixel
+} pet_frame_t;
+
+typedef struct {
+  int16_t x;
+  int16_t y;
+  int16_t w;
+  int16_t h;
+} pet_rect_t;
+
+typedef struct {
+  uint32_t frames;            // Frame changes shown
+  uint32_t moves;             // Advances that moved the pet
+  uint32_t rects;             // Dirty rectangles returned
+  uint32_t px_dirty;          // Sum of their areas
+} pet_anim_stats_t;
+
+typedef struct {
+  pet_state_t state;
+  uint8_t step;               // Index in the state's timeline
+  uint32_t step_elapsed_ms;
+
+  uint8_t seg;                // Wander path segment (idle only)
+  uint32_t seg_elapsed_ms;
+  int16_t seg_from;
+  int16_t x;                  // Offset from the home box, pixels
+
+  // What the renderer currently shows (dirty rects are relative to it)
+  pet_state_t shown_state;
+  uint8_t shown_step;
+  uint8_t shown_frame;
+  int16_t shown_x;
+
+  pet_anim_stats_t stats;
+} pet_anim_t;
+
+// Reset to idle at home (first call also precomputes the frame diffs)
+void pet_anim_init(pet_anim_t* anim);
+
+// Switch state now; one-shot states (eat, react) fall back to idle at the end
+void pet_anim_set_state(pet_anim_t* anim, pet_state_t state);
+
+// Advance by delta_ms; fills up to PET_ANIM_MAX_RECTS dirty rects, returns count
+uint8_t pet_anim_advance(pet_anim_t* anim, uint32_t delta_ms, pet_rect_t* dirty);
+
+// Frame to draw and its offset from the home box
+const pet_frame_t* pet_anim_frame(const pet_anim_t* anim);
+int16_t pet_anim_x(const pet_anim_t* anim);
+
+// Milliseconds until the next frame change
+uint32_t pet_anim_ms_to_next_frame(const pet_anim_t* anim);
+
+// True while the wander path is moving the pet
+bool pet_anim_is_moving(const pet_anim_t* anim);
+
+const char* pet_anim_state_name(pet_state_t state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PET_ANIM_H
@@ -0,0 +1,92 @@
+/*
+ * PIXEL - Pet Simulation
+ *
+ * The pet's needs (hunger, energy, social, cleanliness, curiosity), its
+ * mood and a small utility AI choosing what to do next. Pure integer code:
+ * the same inputs give bit-identical states on the ESP32 and on the host.
+ *
+ * Levels are satisfaction in Q0.16 (0 = starving / exhausted, 65535 =
+ * fully satisfied), kept in one array per field rather than one struct per
+ * need. Between two decisions the pet is either awake or asleep, and every
+ * need follows a closed-form law for that mode: linear drift, or
+ * exponential recovery towards full (deficit * keep^minutes, power by
+ * squaring). Advancing by hours costs a handful of multiplies, not a loop.
+ *
+ * Time unit is the minute; milliseconds below a minute are carried over.
+ */
+
+#ifndef PET_SIM_H
+#define PET_SIM_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PET_SIM_ONE 65535U
+
+// The pet does not wake up before energy is back to this level
+#define PET_SIM_WAKE_LEVEL ((PET_SIM_ONE * 95U) / 100U)
+
+typedef enum {
+  PET_NEED_HUNGER = 0,
+  PET_NEED_ENERGY,
+  PET_NEED_SOCIAL,
+  PET_NEED_CLEAN,
+  PET_NEED_CURIOSITY,
+  PET_NEED_COUNT,
+} pet_need_t;
+
+typedef enum {
+  PET_ACTION_IDLE = 0,
+  PET_ACTION_EAT,
+  PET_ACTION_SLEEP,
+  PET_ACTION_PLAY,
+  PET_ACTION_CLEAN,
+  PET_ACTION_EXPLORE,
+  PET_ACTION_COUNT,
+} pet_action_t;
+
+typedef struct {
+  uint16_t level[PET_NEED_COUNT];   // Satisfaction, Q0.16
+  uint32_t minutes;                 // Simulated time since birth
+  uint32_t carry_ms;                // Sub-minute remainder of pet_sim_advance()
+  uint8_t asleep;
+  uint8_t action;                   // Last applied pet_action_t
+} pet_sim_t;
+
+// Newborn: all needs at 80 %, awake, idle
+void pet_sim_init(pet_sim_t* sim);
+
+// Advance by any duration in O(log minutes); mode does not change meanwhile
+void pet_sim_advance(pet_sim_t* sim, uint32_t delta_ms);
+void pet_sim_advance_minutes(pet_sim_t* sim, uint32_t minutes);
+
+// Score every action and return the best (scores[PET_ACTION_COUNT] optional)
+pet_action_t pet_sim_decide(const pet_sim_t* sim, int32_t* scores);
+
+// Apply an action's immediate effects; sleep switches mode, anything else wakes
+void pet_sim_apply(pet_sim_t* sim, pet_action_t action);
+
+// Overall mood, Q0.16: mean satisfaction pulled down by the worst need
+uint16_t pet_sim_mood(const pet_sim_t* sim);
+
+// FNV-1a over the state fields, for cross-platform comparisons
+uint32_t pet_sim_hash(const pet_sim_t* sim);
+
+const char* pet_sim_need_name(pet_need_t need);
+const char* pet_sim_action_name(pet_action_t action);
+
+/*
+ * 30 simulated days of decide/apply/advance against a golden hash
+ * (bit-exactness with the reference build), closed-form catch-up vs a
+ * per-minute loop (time and LSB drift). Pure CPU, any task.
+ */
+void pet_sim_run_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PET_SIM_H
@@ -0,0 +1,91 @@
+/*
+ * ARCHI - Static RTOS Objects
+ *
+ * Every task, queue, mutex, timer, event group and ring buffer of the
+ * firmware is created with the FreeRTOS *CreateStatic variants: control
+ * blocks, stacks and queue storage are file-scope buffers in .bss, reserved
+ * at link time, so creating (or re-creating) an object never touches the
+ * heap. The helpers below create the object and record it in a fixed table;
+ * rtos_static_print_map() lists the table at boot with the sizes the linker
+ * reserved.
+ *
+ * Buffers are declared next to the object's handle:
+ *
+ *   static StaticTask_t s_foo_tcb;
+ *   static StackType_t s_foo_stack[FOO_STACK_SIZE / sizeof(StackType_t)];
+ *
+ * (ESP-IDF stack depths are in bytes.) Objects created by the framework
+ * itself (loopTask, Tmr Svc, WiFi/BT stacks, esp_timer) stay on the heap,
+ * as does the boot task: it exits after boot and hands its stack back.
+ */
+
+#ifndef RTOS_STATIC_H
+#define RTOS_STATIC_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <freertos/timers.h>
+#include <freertos/event_groups.h>
+#include <freertos/ringbuf.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RTOS_STATIC_MAX_OBJECTS 24
+
+typedef enum {
+    RTOS_STATIC_TASK = 0,
+    RTOS_STATIC_QUEUE,
+    RTOS_STATIC_MUTEX,
+    RTOS_STATIC_TIMER,
+    RTOS_STATIC_EVENT_GROUP,
+    RTOS_STATIC_RINGBUF,
+    RTOS_STATIC_KIND_COUNT,
+} rtos_static_kind_t;
+
+typedef struct {
+    uint16_t objects;
+    uint32_t control_bytes;           // Control blocks (TCBs, queue/timer structs)
+    uint32_t storage_bytes;           // Stacks, queue items, ring storage
+    uint32_t kind_bytes[RTOS_STATIC_KIND_COUNT];
+} rtos_static_stats_t;
+
+/*
+ * Static counterparts of xTaskCreatePinnedToCore / xQueueCreate / ... that
+ * also record the object. `name` must outlive the program (string literal);
+ * re-creating an object in the same buffer keeps a single entry. Return
+ * NULL on failure (NULL buffer), like the FreeRTOS calls.
+ */
+TaskHandle_t rtos_static_task(TaskFunction_t fn, const char* name, uint32_t stack_size, void* arg,
+                              UBaseType_t priority, StackType_t* stack, StaticTask_t* tcb, BaseType_t core);
+QueueHandle_t rtos_static_queue(const char* name, UBaseType_t length, UBaseType_t item_size,
+                                uint8_t* storage, StaticQueue_t* queue);
+SemaphoreHandle_t rtos_static_mutex(const char* name, StaticSemaphore_t* mutex);
+TimerHandle_t rtos_static_timer(const char* name, TickType_t period, UBaseType_t auto_reload, void* timer_id,
+                                TimerCallbackFunction_t callback, StaticTimer_t* timer);
+EventGroupHandle_t rtos_static_event_group(const char* name, StaticEventGroup_t* group);
+RingbufHandle_t rtos_static_ringbuf(const char* name, size_t size, RingbufferType_t type,
+                                    uint8_t* storage, StaticRingbuffer_t* ring);
+
+void rtos_static_get_stats(rtos_static_stats_t* out);
+
+/* Print every recorded object, the totals per kind and the heap on serial */
+void rtos_static_print_map(void);
+
+/*
+ * Heap stability across scans: runs RTOS_STATIC_BENCH_SCANS BLE scans back
+ * to back (boot task, after the map) and reports free heap and largest
+ * block after the first scan (BLE stack warm-up) and at the end.
+ */
+void rtos_static_run_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // RTOS_STATIC_H
@@ -0,0 +1,104 @@
+/*
+ * ARCHI - Binary Serial Export
+ *
+ * Framed binary telemetry stream for live scan data. Producers encode a
+ * record into a COBS frame (CRC16 + sequence number) and push it into a
+ * byte ring buffer; a dedicated low-priority TX task drains the ring to the
+ * UART. Producers never block: when the ring is full the frame is dropped,
+ * counted, and the host sees a gap in the sequence numbers.
+ *
+ * Host decoder / loopback benchmark: tools/serial_export.py
+ * Frames checked against the host decoder: pio test -e native -f test_serial_export
+ */
+
+#ifndef SERIAL_EXPORT_H
+#define SERIAL_EXPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "netsec_api.h"
+#include "ui_api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Compile-time switch (off by default so the text monitor keeps working) */
+#ifndef SERIAL_EXPORT_ENABLED
+#define SERIAL_EXPORT_ENABLED 0
+#endif
+
+/* UART baud rate used while the binary export is enabled */
+#ifndef SERIAL_EXPORT_BAUD
+#define SERIAL_EXPORT_BAUD 921600
+#endif
+
+/* Ring buffer between producers and the TX task */
+#ifndef SERIAL_EXPORT_RING_SIZE
+#define SERIAL_EXPORT_RING_SIZE (8 * 1024)
+#endif
+
+#define SERIAL_EXPORT_TASK_STACK_SIZE 3072
+#define SERIAL_EXPORT_TASK_PRIORITY   1   // Below NETSEC: export must never starve scanning
+
+/* Wire format version (first byte of every decoded frame) */
+#define SERIAL_EXPORT_PROTOCOL_VERSION 1
+
+/* Largest decoded frame: header (8) + payload (<= 48) + CRC (2) */
+#define SERIAL_EXPORT_MAX_FRAME 64
+
+/* Largest frame on the wire: COBS adds one byte per 254 plus the leading code
+ * byte, between two 0x00 delimiters */
+#define SERIAL_EXPORT_MAX_ENCODED (SERIAL_EXPORT_MAX_FRAME + SERIAL_EXPORT_MAX_FRAME / 254 + 3)
+
+/*
+ * Decoded frame layout (little endian), COBS encoded between two 0x00
+ * delimiters (text logs on the same UART fall between frames):
+ *   u8  version | u8 type | u16 seq | u32 timestamp_ms | payload | u16 crc16
+ * CRC16-CCITT (poly 0x1021, init 0xFFFF) covers everything before it.
+ */
+typedef enum {
+    SERIAL_EXPORT_REC_BLE_DEVICE   = 0x01, // mac[6] rssi:i8 flags:u32 name_len:u8 name[]
+    SERIAL_EXPORT_REC_WIFI_AP      = 0x02, // bssid[6] rssi:i8 channel:u8 ssid_len:u8 ssid[]
+    SERIAL_EXPORT_REC_SCAN_SUMMARY = 0x03, // result_type:u8 item_count:u16 duration_ms:u32 timestamp_ms:u32
+    SERIAL_EXPORT_REC_UI_EVENT     = 0x04, // event:u8
+    SERIAL_EXPORT_REC_STATS        = 0x05, // frames_sent:u32 frames_dropped:u32 bytes_sent:u32
+} serial_export_record_t;
+
+typedef struct {
+    uint32_t frames_queued;   // Frames accepted into the ring
+    uint32_t frames_dropped;  // Frames rejected because the ring was full
+    uint32_t frames_sent;     // Frames written to the UART by the TX task
+    uint32_t bytes_sent;      // Encoded bytes written to the UART
+} serial_export_stats_t;
+
+/**
+ * Create the ring buffer and start the TX task.
+ * Must be called after Serial.begin(). No-op when SERIAL_EXPORT_ENABLED is 0.
+ */
+void serial_export_init(void);
+
+/* Record producers (non-blocking, safe from any task). Return false on drop. */
+bool serial_export_ble_device(const netsec_ble_device_t* device);
+bool serial_export_wifi_ap(const netsec_wifi_ap_t* ap);
+bool serial_export_scan_summary(netsec_result_type_t type, const netsec_scan_summary_t* summary);
+bool serial_export_ui_event(ui_event_t event);
+
+/*
+ * Build one wire frame (delimiters included) into `out`, which holds
+ * SERIAL_EXPORT_MAX_ENCODED bytes. Returns its length, 0 when the payload is
+ * too long. The producers use it; built whatever SERIAL_EXPORT_ENABLED so
+ * test_serial_export can decode it.
+ */
+size_t serial_export_encode(serial_export_record_t type, uint16_t seq, uint32_t timestamp_ms,
+                            const uint8_t* payload, size_t payload_len, uint8_t* out);
+
+/* Snapshot of the export counters */
+void serial_export_get_stats(serial_export_stats_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SERIAL_EXPORT_H
@@ -0,0 +1,95 @@
+/*
+ * ARCHI - Storage File System
+ *
+ * The file system on the "spiffs" partition, behind the 'S:' LVGL drive
+ * (lvgl_fs.h) and the File API users, chosen at build time:
+ *
+ * - SPIFFS (default): flat. Opening a file or listing a directory scans
+ *   the lookup page of every block; a far seek looks up another object
+ *   index page the same way.
+ * - LittleFS (-D STORAGE_FS_LITTLEFS): real directories, files as CTZ
+ *   skip-lists (a seek walks O(log n) block pointers), reads through a
+ *   per-file cache.
+ *
+ * LittleFS geometry (read / prog / cache / lookahead sizes) is compiled
+ * into the framework: esp_littlefs takes it from sdkconfig
+ * (CONFIG_LITTLEFS_*). STORAGE_LFS_* state the expected values (Kconfig
+ * defaults below); on target a mismatch with the framework is a build
+ * error, so a tuned geometry goes into custom_sdkconfig and the -D flags
+ * together. The native sim applies them to its flash model.
+ *
+ * Both formats use the same partition: switching reformats it on first
+ * mount, the image is rebuilt by `pio run -t uploadfs` with
+ * board_build.filesystem set to match.
+ */
+
+#ifndef STORAGE_FS_H
+#define STORAGE_FS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define STORAGE_FS_PARTITION_LABEL  "spiffs"
+#define STORAGE_FS_MAX_OPEN_FILES   10
+
+#ifdef STORAGE_FS_LITTLEFS
+#define STORAGE_FS_NAME             "LittleFS"
+#define STORAGE_FS_MOUNT_POINT      "/littlefs"
+#else
+#define STORAGE_FS_NAME             "SPIFFS"
+#define STORAGE_FS_MOUNT_POINT      "/spiffs"
+#endif
+
+// esp_littlefs Kconfig defaults
+#ifndef STORAGE_LFS_READ_SIZE
+#define STORAGE_LFS_READ_SIZE       128
+#endif
+#ifndef STORAGE_LFS_PROG_SIZE
+#define STORAGE_LFS_PROG_SIZE       128
+#endif
+#ifndef STORAGE_LFS_CACHE_SIZE
+#define STORAGE_LFS_CACHE_SIZE      512
+#endif
+#ifndef STORAGE_LFS_LOOKAHEAD_SIZE
+#define STORAGE_LFS_LOOKAHEAD_SIZE  128
+#endif
+
+typedef struct {
+  bool mounted;
+  uint32_t total_bytes;
+  uint32_t used_bytes;
+  uint32_t mount_us;
+} storage_fs_stats_t;
+
+#ifdef __cplusplus
+#include <FS.h>
+
+// File API of the mounted file system (SPIFFS or LittleFS object)
+fs::FS& storage_fs(void);
+
+extern "C" {
+#endif
+
+/**
+ * Mount the file system (boot task), formatting it if it does not mount.
+ * @return true if mounted
+ */
+bool storage_fs_mount(void);
+
+void storage_fs_get_stats(storage_fs_stats_t* out);
+
+/*
+ * Read throughput on the wallpapers (/img/bg_*.bin; copied from the asset
+ * bundle first when the file system has none, removed afterwards):
+ * directory walk, open, sequential reads in 4 KB chunks and in rows, and
+ * random row reads (seek + 640 bytes). Reports time and, when the
+ * framework counts them, SPI flash operations per phase. In the native sim
+ * times come from the flash model (the host clock would time the simulator).
+ */
+void storage_fs_run_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STORAGE_FS_H
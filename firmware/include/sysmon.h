@@ -0,0 +1,108 @@
+/*
+ * ARCHI - System Monitor
+ *
+ * Telemetry for the FreeRTOS plumbing: per-queue depth high-water marks and
+ * drop counters (producers send through sysmon_queue_send), stack high-water
+ * marks for every registered task, and heap minimums (ESP32 heap + LVGL pool).
+ * A low-priority task prints a periodic report on serial; the settings
+ * screen reads the same snapshot.
+ */
+
+#ifndef SYSMON_H
+#define SYSMON_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SYSMON_MAX_TASKS          10
+#define SYSMON_TASK_NAME_LEN      16
+#define SYSMON_TASK_STACK_SIZE    3072
+#define SYSMON_TASK_PRIORITY      1
+#define SYSMON_REPORT_PERIOD_MS   10000
+#define SYSMON_SAMPLE_PERIOD_MS   1000
+
+/* Inter-task channels declared in tasks.h */
+typedef enum {
+    SYSMON_QUEUE_UI_EVENT = 0,
+    SYSMON_QUEUE_NETSEC_COMMAND,
+    SYSMON_QUEUE_NETSEC_RESULT,
+    SYSMON_QUEUE_COUNT,
+} sysmon_queue_id_t;
+
+typedef struct {
+    const char* name;
+    uint32_t length;        // Queue capacity (items)
+    uint32_t waiting;       // Items currently queued
+    uint32_t high_water;    // Deepest observed fill level
+    uint32_t sent;          // Successful sends
+    uint32_t dropped;       // Failed sends (queue full or not created)
+} sysmon_queue_stats_t;
+
+typedef struct {
+    char name[SYSMON_TASK_NAME_LEN];
+    uint32_t stack_size;      // Bytes reserved at creation
+    uint32_t stack_min_free;  // Lowest free stack ever observed (bytes)
+    bool alive;               // False once the task unregistered (e.g. boot task)
+} sysmon_task_stats_t;
+
+typedef struct {
+    uint32_t free_heap;        // Current free 8-bit heap
+    uint32_t min_free_heap;    // Lowest free heap since boot
+    uint32_t largest_block;    // Largest allocatable block
+    uint32_t lvgl_free;        // LVGL pool free bytes (last sample)
+    uint32_t lvgl_min_free;    // Lowest LVGL pool free bytes seen
+    uint8_t lvgl_frag_pct;     // LVGL pool fragmentation (last sample)
+} sysmon_heap_stats_t;
+
+typedef struct {
+    sysmon_queue_stats_t queues[SYSMON_QUEUE_COUNT];
+    sysmon_task_stats_t tasks[SYSMON_MAX_TASKS];
+    uint8_t task_count;
+    sysmon_heap_stats_t heap;
+    uint32_t uptime_ms;
+} sysmon_snapshot_t;
+
+/**
+ * Start the monitor. Call first in system_init(): registration calls made
+ * before this are ignored.
+ */
+void sysmon_init(void);
+
+/* Attach a queue handle to its channel id (called once the queue exists). */
+void sysmon_register_queue(sysmon_queue_id_t id, QueueHandle_t queue, const char* name, uint32_t length);
+
+/**
+ * Non-blocking-friendly xQueueSend wrapper: records drops and the fill
+ * level after a successful send.
+ */
+BaseType_t sysmon_queue_send(sysmon_queue_id_t id, const void* item, TickType_t ticks_to_wait);
+
+/*
+ * Track a task's stack. A name seen before reuses its slot so the minimum
+ * survives a task that is deleted and created again.
+ */
+void sysmon_register_task(TaskHandle_t task, const char* name, uint32_t stack_size);
+
+/* Take a final stack sample and stop tracking. Must run before the task is deleted. */
+void sysmon_unregister_task(TaskHandle_t task);
+
+/* Sample the LVGL pool. UI task only (LVGL is not thread-safe). */
+void sysmon_sample_lvgl_heap(void);
+
+void sysmon_get_snapshot(sysmon_snapshot_t* out);
+
+/* Print the full report on serial */
+void sysmon_print_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SYSMON_H
@@ -1,8 +1,23 @@
 #pragma once
 
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+
 // System initialization
 // Called early from main.cpp to set up hardware and FreeRTOS infrastructure.
 
+/*
+ * Staged boot: the UI task brings up display + touch and paints a splash
+ * first; a boot task on core 0 does the slow work in the background and
+ * reports progress through these event bits.
+ */
+#define BOOT_EVT_FS_READY      (1 << 0)   // SPIFFS mounted, 'S:' drive usable
+#define BOOT_EVT_NETSEC_READY  (1 << 1)   // WiFi in STA mode, NETSEC task running
+#define BOOT_EVT_FIRST_FRAME   (1 << 2)   // Splash flushed to the panel
+#define BOOT_EVT_INTERACTIVE   (1 << 3)   // Main screen shown, input live
+
+#define BOOT_INTERACTIVE_TIMEOUT_MS 10000  // Boot report is printed anyway after this
+
 /**
  * Initialize the system:
  * - Serial logging
@@ -12,6 +27,11 @@
  */
 void system_init(void);
 
+/**
+ * Boot progress bits (BOOT_EVT_*), valid once system_init() has run.
+ */
+EventGroupHandle_t system_boot_events(void);
+
 /**
  * ARCHI-internal: initialize board-level hardware.
  * Called from system_init().
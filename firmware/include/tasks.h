@@ -11,6 +11,10 @@
 #define NETSEC_COMMAND_QUEUE_LENGTH 12
 #define NETSEC_RESULT_QUEUE_LENGTH  96
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /* UI task: handles LVGL event loop and display updates */
 void ui_task(void* pvParameters);
 
@@ -22,3 +26,7 @@ extern QueueHandle_t ui_event_queue;          // UI posts events from buttons
 extern QueueHandle_t netsec_command_queue;    // UI sends commands to NETSEC
 extern QueueHandle_t netsec_result_queue;     // NETSEC sends scan results back
 
+#ifdef __cplusplus
+}
+#endif
+
@@ -0,0 +1,109 @@
+/*
+ * ARCHI - TLSF Heap
+ *
+ * Two-level segregated-fit allocator over caller-provided regions.
+ * Free blocks are binned by size class (first level: power of two,
+ * second level: 16 linear subdivisions) with a bitmap per level, so
+ * malloc and free are O(1): one bit scan to find a class, constant-time
+ * split and coalesce with the physical neighbours.
+ *
+ * Every block carries an 8-bit tag chosen by the caller at malloc time
+ * (kept across realloc) and the heap keeps byte/block counters per tag.
+ * No locking: a heap instance belongs to one task.
+ */
+
+#ifndef TLSF_HEAP_H
+#define TLSF_HEAP_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TLSF_HEAP_SL_LOG2      4       // 16 second-level classes per power of two
+#define TLSF_HEAP_FL_MAX       20      // Blocks (and regions) stay below 1 MB
+#define TLSF_HEAP_MAX_REGIONS  4
+#define TLSF_HEAP_TAG_COUNT    16
+
+#define TLSF_HEAP_ALIGN        (sizeof(void*))
+#define TLSF_HEAP_ALIGN_LOG2   (sizeof(void*) == 8 ? 3 : 2)
+#define TLSF_HEAP_SL_COUNT     (1U << TLSF_HEAP_SL_LOG2)
+#define TLSF_HEAP_FL_SHIFT     (TLSF_HEAP_SL_LOG2 + TLSF_HEAP_ALIGN_LOG2)
+#define TLSF_HEAP_FL_COUNT     (TLSF_HEAP_FL_MAX - TLSF_HEAP_FL_SHIFT + 1)
+
+// Bookkeeping bytes per region (first header + end sentinel)
+#define TLSF_HEAP_REGION_OVERHEAD (2U * sizeof(size_t))
+
+typedef struct tlsf_block tlsf_block_t;
+struct tlsf_block {
+  tlsf_block_t* prev_phys;     // Only valid while the previous block is free
+  size_t size;                 // Payload bytes | flag bits | tag << 24
+  tlsf_block_t* next_free;     // Free blocks only (overlaps the payload)
+  tlsf_block_t* prev_free;
+};
+
+typedef struct {
+  uint32_t bytes;              // Payload bytes held by live blocks
+  uint32_t peak_bytes;
+  uint16_t blocks;             // Live blocks
+} tlsf_heap_tag_stats_t;
+
+typedef struct {
+  tlsf_block_t null_block;     // Free-list terminator
+  uint32_t fl_bitmap;
+  uint32_t sl_bitmap[TLSF_HEAP_FL_COUNT];
+  tlsf_block_t* blocks[TLSF_HEAP_FL_COUNT][TLSF_HEAP_SL_COUNT];
+
+  tlsf_block_t* regions[TLSF_HEAP_MAX_REGIONS];       // First block of each region
+  tlsf_block_t* region_ends[TLSF_HEAP_MAX_REGIONS];   // End sentinel of each region
+  uint8_t region_count;
+
+  uint32_t total_bytes;        // Usable payload over all regions
+  uint32_t free_bytes;         // Sum of free block payloads
+  uint32_t used_bytes;         // Sum of used block payloads
+  uint32_t peak_used_bytes;
+  uint32_t free_blocks;
+  uint32_t used_blocks;
+  uint32_t alloc_calls;
+  uint32_t free_calls;
+  uint32_t failed_allocs;
+  tlsf_heap_tag_stats_t tags[TLSF_HEAP_TAG_COUNT];
+} tlsf_heap_t;
+
+// Reset the control structure (no region yet)
+void tlsf_heap_init(tlsf_heap_t* heap);
+
+// Hand a memory region to the heap (false if too small, too large or full)
+bool tlsf_heap_add_region(tlsf_heap_t* heap, void* mem, size_t bytes);
+
+// Allocate `size` bytes aligned on TLSF_HEAP_ALIGN, charged to `tag`
+void* tlsf_heap_malloc(tlsf_heap_t* heap, size_t size, uint8_t tag);
+
+// Release a block from this heap (NULL is a no-op)
+void tlsf_heap_free(tlsf_heap_t* heap, void* ptr);
+
+// Grow or shrink in place when a neighbour allows it, else move.
+// Existing blocks keep their tag; `tag` only applies when ptr is NULL.
+void* tlsf_heap_realloc(tlsf_heap_t* heap, void* ptr, size_t size, uint8_t tag);
+
+// Payload size / tag of a live block
+size_t tlsf_heap_block_size(const void* ptr);
+uint8_t tlsf_heap_block_tag(const void* ptr);
+
+// Largest single allocation that would currently succeed
+size_t tlsf_heap_largest_free(const tlsf_heap_t* heap);
+
+// True if `ptr` lies inside one of the heap's regions
+bool tlsf_heap_owns(const tlsf_heap_t* heap, const void* ptr);
+
+// Walk every region and free list; returns the number of inconsistencies
+uint32_t tlsf_heap_check(const tlsf_heap_t* heap);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TLSF_HEAP_H
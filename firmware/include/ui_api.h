@@ -21,6 +21,8 @@ typedef enum {
     UI_EVENT_SELECT_ENTRY,   // Generic list selection
     UI_EVENT_BACK,           // Back or escape navigation
     UI_EVENT_UPDATE_PET,     // Periodic pet refresh
+    UI_EVENT_BUTTON_GAME,    // Top bar mini-game button
+    UI_EVENT_SURVEY_START,   // Settings: enter unattended survey mode
 } ui_event_t;
 
 typedef void (*ui_event_router_t)(ui_event_t event);
@@ -50,6 +52,12 @@ ui_event_router_t ui_get_event_router(void);
  */
 bool ui_post_event(ui_event_t event);
 
+/**
+ * Display the boot splash (first frame, before theme and SPIFFS are ready).
+ * Freed when the main screen is shown for the first time.
+ */
+void ui_show_splash(void);
+
 /**
  * Display the main screen (pet + button bands).
  * Called after ui_init().
@@ -75,7 +83,16 @@ void ui_show_ble_screen(void);
 void ui_show_settings_screen(void);
 
 /**
- * Update the pet animation (called periodically from ui_task).
- * @param delta_ms: milliseconds since last call
+ * Start the mini-game: LVGL stops drawing and the game runtime takes the
+ * panel until the game quits, then the main screen comes back.
+ * Called when user taps Play.
+ */
+void ui_show_game_screen(void);
+
+/**
+ * Advance the pet animation by delta_ms (UI task).
+ * The pet already animates from its own LVGL timer; this is for callers
+ * that drive pet time themselves (game logic, tests).
+ * @param delta_ms: milliseconds to advance
  */
 void ui_update_pet(uint32_t delta_ms);
@@ -0,0 +1,53 @@
+/*
+ * PIXEL - Cell Label
+ *
+ * Fixed-pitch text widget for frequently rewritten text (uptime, scan
+ * countdown, RSSI). Text lives in a cols x rows character grid; setting new
+ * text diffs it against the grid and invalidates only the runs of cells
+ * whose glyph changed, with no re-layout. A seconds tick on "UP: 00:00:00"
+ * repaints one cell instead of the whole label.
+ *
+ * Meant for the monospace UNSCII fonts: the cell is the width of '0' plus
+ * letter spacing, one line high, glyphs are centred in their cell. '\n'
+ * starts a new row, longer rows wrap per character, overflow is dropped.
+ * Font and colour come from the usual text style properties.
+ */
+
+#ifndef UI_CELL_LABEL_H
+#define UI_CELL_LABEL_H
+
+#include "lvgl.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Columns that fit in `px` with the 8 px wide UNSCII fonts of ui_theme
+#define UI_CELL_LABEL_COLS(px) ((uint8_t)((px) / 8))
+
+typedef struct {
+  uint32_t updates;          // set_text calls
+  uint32_t cells_changed;    // Cells whose glyph differed
+  uint32_t px_invalidated;   // Area handed to lv_obj_invalidate_area
+} ui_cell_label_stats_t;
+
+// Create a label with a fixed grid (cols, rows >= 1), initially blank
+lv_obj_t* ui_cell_label_create(lv_obj_t* parent, uint8_t cols, uint8_t rows);
+
+// Replace the text; only changed cells are redrawn
+void ui_cell_label_set_text(lv_obj_t* obj, const char* text);
+void ui_cell_label_set_text_fmt(lv_obj_t* obj, const char* fmt, ...) LV_FORMAT_ATTRIBUTE(2, 3);
+
+// Counters since creation
+void ui_cell_label_get_stats(const lv_obj_t* obj, ui_cell_label_stats_t* out);
+
+// Render the same uptime sequence through lv_label and ui_cell_label and
+// print flushed pixels per update for each (UI task, blocks ~1 s)
+void ui_cell_label_run_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UI_CELL_LABEL_H
@@ -0,0 +1,85 @@
+/*
+ * PIXEL - Day/Night Wallpaper Tint
+ *
+ * Recolours the wallpapers while LVGL decodes them, so one set of bg_*.bin
+ * files serves every time of day and no overlay is blended per frame. A
+ * custom image decoder sits in front of the built-in one for
+ * UI_DAYLIGHT_SRC_PREFIX files and UI_DAYLIGHT_ASSET_PREFIX mapped assets
+ * (asset_map.h): each line read goes through a colour lookup before it is
+ * drawn. Untinted (day), mapped wallpapers are left to the built-in
+ * decoder, which draws them straight from flash.
+ *
+ * The lookup implements a 3x3 colour matrix (tint, dim, desaturate) on
+ * RGB565. A full 65536-entry table would take 128 KB, so the pixel is split
+ * in its two bytes: two 256-entry tables give every output channel with
+ * fractional guard bits, one add and three masks rebuild the pixel (2 KB
+ * per table set, exact to 1 LSB).
+ *
+ * Tables are rebuilt only when the phase changes. A transition walks
+ * UI_DAYLIGHT_STEPS intermediate matrices; each one is built in the back
+ * table set UI_DAYLIGHT_CHUNK entries per timer tick, then swapped in and
+ * the wallpaper invalidated once. UI task only.
+ */
+
+#ifndef UI_DAYLIGHT_H
+#define UI_DAYLIGHT_H
+
+#include "lvgl.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UI_DAYLIGHT_SRC_PREFIX  "S:/img/bg_"
+#define UI_DAYLIGHT_ASSET_PREFIX "bg_"
+
+#define UI_DAYLIGHT_STEPS       8     // Intermediate tables per transition
+#define UI_DAYLIGHT_CHUNK       128   // Table entries rebuilt per tick (512 per set)
+#define UI_DAYLIGHT_TICK_MS     30
+
+typedef enum {
+  UI_DAYLIGHT_NIGHT = 0,
+  UI_DAYLIGHT_DAWN,
+  UI_DAYLIGHT_DAY,
+  UI_DAYLIGHT_DUSK,
+  UI_DAYLIGHT_PHASE_COUNT,
+} ui_daylight_phase_t;
+
+typedef struct {
+  uint32_t tables;      // Table sets built (one per transition step)
+  uint32_t lines;       // Wallpaper lines recoloured
+  uint32_t px;
+} ui_daylight_stats_t;
+
+// Register the decoder (after lv_init, before the first wallpaper is set)
+void ui_daylight_init(void);
+
+// Object invalidated whenever the tint changes (the wallpaper image)
+void ui_daylight_attach(lv_obj_t* img);
+
+ui_daylight_phase_t ui_daylight_phase_at(uint32_t minute_of_day);
+
+// Go to a phase: at once (boot), or through a transition over a few ticks
+void ui_daylight_set_phase(ui_daylight_phase_t phase, bool animate);
+ui_daylight_phase_t ui_daylight_get_phase(void);
+
+// Recolour RGB565 pixels in place with the current tint
+void ui_daylight_apply(uint16_t* px, uint32_t count);
+
+const char* ui_daylight_phase_name(ui_daylight_phase_t phase);
+void ui_daylight_get_stats(ui_daylight_stats_t* out);
+
+/*
+ * Table accuracy against the exact matrix over all 65536 colours, table
+ * build time, then per-pixel cost of the lookup against the overlay blend
+ * it replaces (one screen of lines). Pure CPU, UI task.
+ */
+void ui_daylight_run_benchmark(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UI_DAYLIGHT_H
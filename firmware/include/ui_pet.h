@@ -0,0 +1,61 @@
+/*
+ * PIXEL - Pet Widget
+ *
+ * Draws the pet_anim engine on the main screen. One LVGL timer drives it:
+ * while the pet walks the timer runs at the movement tick, otherwise it
+ * sleeps until the next frame change. The movement tick follows the frame
+ * budget: every second it is set from the average render time of the
+ * display (lvgl_port render stats), so a busy screen gets fewer pet steps
+ * instead of a late UI. Only the engine's dirty rects are invalidated.
+ *
+ * A tap on the pet plays "react"; the other states come from the pet
+ * simulation (see ui_main_screen). One pet per firmware; all calls from
+ * the UI task.
+ */
+
+#ifndef UI_PET_H
+#define UI_PET_H
+
+#include "lvgl.h"
+#include "pet_anim.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Movement tick bounds (ms) and render-time multiple used to pick it
+#define UI_PET_TICK_MIN_MS      40
+#define UI_PET_TICK_MAX_MS      200
+#define UI_PET_BUDGET_FACTOR    4
+
+typedef struct {
+  uint32_t ticks;             // Timer callbacks and manual advances
+  uint32_t frames;            // Frame changes drawn
+  uint32_t rects;             // Areas invalidated
+  uint32_t px_invalidated;
+  uint16_t tick_ms;           // Current movement tick
+} ui_pet_stats_t;
+
+// Create the pet area (size it like any object; the pet is centred in it)
+lv_obj_t* ui_pet_create(lv_obj_t* parent);
+
+// Play a state now (eat and react return to idle on their own)
+void ui_pet_set_state(pet_state_t state);
+pet_state_t ui_pet_get_state(void);
+
+// Advance outside the timer (ui_update_pet): delta_ms replaces the time
+// since the last step, the timer counts from this call on
+void ui_pet_advance(uint32_t delta_ms);
+
+// Pause while the main screen is hidden; pet time freezes meanwhile
+void ui_pet_set_active(bool active);
+
+void ui_pet_get_stats(ui_pet_stats_t* out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UI_PET_H
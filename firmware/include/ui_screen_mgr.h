@@ -0,0 +1,108 @@
+/*
+ * PIXEL - Screen Lifecycle Manager
+ *
+ * Owns the secondary screens (WiFi, BLE, Settings): builds them in short
+ * slices during idle frames before they are needed, records what each build
+ * costs (CPU time, LVGL heap), and tears down the least recently used hidden
+ * screens when the LVGL pool runs low. A torn-down screen is rebuilt from
+ * its module's data the next time it is shown. The main screen is pinned.
+ *
+ * All functions must be called from the UI task.
+ */
+
+#ifndef UI_SCREEN_MGR_H
+#define UI_SCREEN_MGR_H
+
+#include "lvgl.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Evict hidden screens while the LVGL pool has less free than this
+#ifndef UI_SCREEN_EVICT_WATERMARK
+#define UI_SCREEN_EVICT_WATERMARK (10U * 1024U)
+#endif
+
+// Prebuild only if the pool keeps this much above the watermark afterwards
+#ifndef UI_SCREEN_PREBUILD_MARGIN
+#define UI_SCREEN_PREBUILD_MARGIN (4U * 1024U)
+#endif
+
+// CPU budget for one idle frame of prebuild work
+#ifndef UI_SCREEN_PREBUILD_SLICE_US
+#define UI_SCREEN_PREBUILD_SLICE_US 2000
+#endif
+
+// Quiet time after the last input or result before prebuilding starts
+#ifndef UI_SCREEN_PREBUILD_IDLE_MS
+#define UI_SCREEN_PREBUILD_IDLE_MS 300
+#endif
+
+// Footprint assumed for a screen that was never built
+#define UI_SCREEN_DEFAULT_FOOTPRINT (6U * 1024U)
+
+typedef enum {
+  UI_SCREEN_WIFI = 0,
+  UI_SCREEN_BLE,
+  UI_SCREEN_SETTINGS,
+  UI_SCREEN_COUNT,
+} ui_screen_id_t;
+
+typedef struct {
+  const char* name;
+  bool built;                 // Root object exists and all steps ran
+  uint32_t last_build_us;     // CPU time summed over the build steps
+  uint32_t max_build_us;
+  uint32_t footprint;         // LVGL bytes held by the last complete build
+  uint16_t builds;            // Full builds, prebuilt or on demand
+  uint16_t prebuilds;         // Builds completed in idle slices
+  uint16_t evictions;
+  uint16_t shows;
+} ui_screen_stats_t;
+
+/*
+ * Incremental screen builder. Each call performs one bounded chunk of work
+ * and returns true once the screen is complete; the module keeps its own
+ * cursor and the root object stays reachable through get_root.
+ */
+typedef bool (*ui_screen_build_step_fn)(void);
+typedef void (*ui_screen_destroy_fn)(void);
+typedef lv_obj_t* (*ui_screen_root_fn)(void);
+typedef void (*ui_screen_visibility_fn)(bool visible);
+
+// Reset the per-screen slots (called from ui_init, before LVGL is up)
+void ui_screen_mgr_init(void);
+
+// Finish building (synchronously) and return the screen, marking it as used
+lv_obj_t* ui_screen_mgr_acquire(ui_screen_id_t id);
+
+// Called by ui_load_screen(): hide `prev`, then show (reconcile) `next`
+void ui_screen_mgr_screen_changed(lv_obj_t* prev, lv_obj_t* next);
+
+// Note user activity or incoming results: postpones idle prebuilding
+void ui_screen_mgr_note_activity(void);
+
+// Per-frame hook: eviction under pressure, then idle prebuild slices
+void ui_screen_mgr_tick(void);
+
+// Tear down every hidden screen now (e.g. before a large allocation)
+void ui_screen_mgr_evict_hidden(void);
+
+// Copy the stats of one screen (false if id is out of range)
+bool ui_screen_mgr_get_stats(ui_screen_id_t id, ui_screen_stats_t* out);
+
+// One serial line per screen: build cost, footprint, counters
+void ui_screen_mgr_log_stats(void);
+
+// Build then evict every screen `cycles` times and report heap drift,
+// fragmentation and timing (LVGL_HEAP_RUN_BENCHMARK; blocks the UI task)
+void ui_screen_mgr_run_stress(uint32_t cycles);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // UI_SCREEN_MGR_H
@@ -14,19 +14,39 @@
 extern "C" {
 #endif
 
+/*
+ * Secondary screens are built incrementally for the screen manager
+ * (ui_screen_mgr.h): build_step does one bounded chunk and returns true once
+ * the screen is complete, create runs the remaining steps at once. Destroy
+ * deletes the LVGL objects but keeps the module's data (scan results, status
+ * text), so the next build shows the same content. set_visible is called on
+ * every screen switch: hidden screens only update their data and pause their
+ * timers, showing one reconciles its objects with the data in one pass.
+ */
+
 // Create main screen (pet display + button bands)
 lv_obj_t* ui_create_main_screen(void);
+// Advance the pet simulation to now, pick the next action, update pet and status
+void ui_main_screen_pet_step(void);
 
 // Create WiFi scan results screen
 lv_obj_t* ui_create_wifi_screen(void);
-void ui_wifi_handle_ap_found(const netsec_wifi_ap_t* ap);
+bool ui_build_wifi_screen_step(void);
+lv_obj_t* ui_wifi_screen_root(void);
+void ui_destroy_wifi_screen(void);
+void ui_wifi_set_visible(bool visible);
+void ui_wifi_handle_device(netsec_result_type_t type, const netsec_device_t* ap);   // Registry diffs
 void ui_wifi_handle_scan_done(void);
 
 // Create BLE scan results screen
 lv_obj_t* ui_create_ble_screen(void);
+bool ui_build_ble_screen_step(void);
+lv_obj_t* ui_ble_screen_root(void);
+void ui_destroy_ble_screen(void);
+void ui_ble_set_visible(bool visible);
 lv_obj_t* ui_ble_get_scan_button(void);
 void ui_ble_prepare_for_scan(uint32_t duration_ms);
-void ui_ble_handle_device_found(const netsec_ble_device_t* device);
+void ui_ble_handle_device(netsec_result_type_t type, const netsec_device_t* device);  // Registry diffs
 void ui_ble_handle_scan_started(const netsec_scan_summary_t* meta);
 void ui_ble_handle_scan_completed(const netsec_scan_summary_t* meta);
 uint32_t ui_ble_get_last_scan_duration_ms(void);
@@ -35,11 +55,18 @@ void ui_ble_set_state_choosing_duration(void);
 void ui_ble_set_state_scanning(uint32_t duration_ms);
 void ui_ble_show_scan_request(uint32_t duration_ms);
 void ui_ble_cancel_scan(void);
+// Same registry diffs with the BLE screen shown, then hidden with one
+// reconcile on show: UI task CPU and px flushed for each (UI_BLE_RUN_BENCHMARK)
+void ui_ble_run_background_benchmark(void);
 
-// Create settings screen (placeholder)
+// Create settings screen (system monitor panel)
 lv_obj_t* ui_create_settings_screen(void);
+bool ui_build_settings_screen_step(void);
+lv_obj_t* ui_settings_screen_root(void);
+void ui_destroy_settings_screen(void);
+void ui_settings_set_visible(bool visible);
 
-// Load a screen (switch display to given object)
+// Load a screen (switch display to given object, notify visibility changes)
 void ui_load_screen(lv_obj_t* screen);
 
 // Get current active screen
@@ -0,0 +1,82 @@
+/*
+ * NATIVE SIM - Arduino core subset
+ *
+ * The firmware is written against the arduino-esp32 core; this header gives
+ * it the same entry points on the host. Time comes from the simulated
+ * kernel, so millis() only advances when tasks block. C-compatible because
+ * lv_conf.h pulls it into the LVGL sources for LV_TICK_CUSTOM.
+ */
+
+#ifndef NATIVE_SIM_ARDUINO_H
+#define NATIVE_SIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "freertos/timers.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT  0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield(void);
+
+/* GPIO and backlight PWM have no host counterpart */
+static inline void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+static inline void digitalWrite(uint8_t pin, uint8_t val) { (void)pin; (void)val; }
+static inline int digitalRead(uint8_t pin) { (void)pin; return LOW; }
+static inline double ledcSetup(uint8_t ch, double freq, uint8_t bits) { (void)ch; (void)bits; return freq; }
+static inline void ledcAttachPin(uint8_t pin, uint8_t ch) { (void)pin; (void)ch; }
+static inline void ledcWrite(uint8_t ch, uint32_t duty) { (void)ch; (void)duty; }
+
+#ifdef __cplusplus
+}
+
+#include <algorithm>
+#include "WString.h"
+#include "HardwareSerial.h"
+
+using std::min;
+using std::max;
+
+/* Seeded from --seed; overloads POSIX random(void) like the core does */
+long random(long max_val);
+long random(long min_val, long max_val);
+void randomSeed(unsigned long seed);
+
+inline long map(long x, long in_min, long in_max, long out_min, long out_max)
+{
+  return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
+}
+
+template <typename T, typename L, typename H>
+inline T constrain(T x, L low, H high)
+{
+  return x < low ? static_cast<T>(low) : (x > high ? static_cast<T>(high) : x);
+}
+
+void setup(void);
+void loop(void);
+#endif
+
+#endif // NATIVE_SIM_ARDUINO_H
@@ -0,0 +1,34 @@
+/*
+ * NATIVE SIM - BLE device address
+ */
+
+#ifndef NATIVE_SIM_BLE_ADDRESS_H
+#define NATIVE_SIM_BLE_ADDRESS_H
+
+#include <stdint.h>
+#include <string.h>
+#include <string>
+
+typedef uint8_t esp_bd_addr_t[6];
+
+typedef enum {
+  BLE_ADDR_TYPE_PUBLIC = 0x00,
+  BLE_ADDR_TYPE_RANDOM = 0x01,
+  BLE_ADDR_TYPE_RPA_PUBLIC = 0x02,
+  BLE_ADDR_TYPE_RPA_RANDOM = 0x03,
+} esp_ble_addr_type_t;
+
+class BLEAddress {
+public:
+  BLEAddress() { memset(m_address, 0, sizeof(m_address)); }
+  explicit BLEAddress(const esp_bd_addr_t address) { memcpy(m_address, address, sizeof(m_address)); }
+
+  esp_bd_addr_t* getNative(void) { return &m_address; }
+  bool equals(const BLEAddress& other) const { return memcmp(m_address, other.m_address, 6) == 0; }
+  std::string toString(void) const;
+
+private:
+  esp_bd_addr_t m_address;
+};
+
+#endif // NATIVE_SIM_BLE_ADDRESS_H
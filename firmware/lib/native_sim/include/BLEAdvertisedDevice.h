@@ -0,0 +1,31 @@
+/*
+ * NATIVE SIM - BLE advertisement as seen by a scan
+ */
+
+#ifndef NATIVE_SIM_BLE_ADVERTISED_DEVICE_H
+#define NATIVE_SIM_BLE_ADVERTISED_DEVICE_H
+
+#include <string>
+#include "BLEAddress.h"
+
+class BLEAdvertisedDevice {
+public:
+  BLEAdvertisedDevice() = default;
+  BLEAdvertisedDevice(const BLEAddress& address, esp_ble_addr_type_t type, const std::string& name, int rssi)
+      : m_address(address), m_type(type), m_name(name), m_rssi(rssi) {}
+
+  BLEAddress getAddress(void) { return m_address; }
+  esp_ble_addr_type_t getAddressType(void) { return m_type; }
+  bool haveName(void) { return !m_name.empty(); }
+  std::string getName(void) { return m_name; }
+  bool haveRSSI(void) { return true; }
+  int getRSSI(void) { return m_rssi; }
+
+private:
+  BLEAddress m_address;
+  esp_ble_addr_type_t m_type = BLE_ADDR_TYPE_PUBLIC;
+  std::string m_name;
+  int m_rssi = 0;
+};
+
+#endif // NATIVE_SIM_BLE_ADVERTISED_DEVICE_H
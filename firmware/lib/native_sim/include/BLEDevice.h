@@ -0,0 +1,19 @@
+/*
+ * NATIVE SIM - BLE stack entry point
+ */
+
+#ifndef NATIVE_SIM_BLE_DEVICE_H
+#define NATIVE_SIM_BLE_DEVICE_H
+
+#include <string>
+#include "BLEScan.h"
+
+class BLEDevice {
+public:
+  static void init(const std::string& device_name);
+  static void deinit(bool release_memory = false);
+  static BLEScan* getScan(void);
+  static bool getInitialized(void);
+};
+
+#endif // NATIVE_SIM_BLE_DEVICE_H
@@ -0,0 +1,45 @@
+/*
+ * NATIVE SIM - Blocking BLE scan (arduino-esp32 2.x signature)
+ *
+ * start() sleeps for the scan duration in virtual time, then returns the
+ * devices of the simulated environment that advertised meanwhile. stop()
+ * from another task ends a running start() early, like the core's
+ * end-of-scan semaphore.
+ */
+
+#ifndef NATIVE_SIM_BLE_SCAN_H
+#define NATIVE_SIM_BLE_SCAN_H
+
+#include <stdint.h>
+#include <vector>
+#include "BLEAdvertisedDevice.h"
+
+class BLEScanResults {
+public:
+  int getCount(void) { return static_cast<int>(m_devices.size()); }
+  BLEAdvertisedDevice getDevice(uint32_t i) { return i < m_devices.size() ? m_devices[i] : BLEAdvertisedDevice(); }
+
+private:
+  friend class BLEScan;
+  std::vector<BLEAdvertisedDevice> m_devices;
+};
+
+class BLEScan {
+public:
+  void setActiveScan(bool active) { m_active = active; }
+  void setInterval(uint16_t interval_ms) { m_interval_ms = interval_ms; }
+  void setWindow(uint16_t window_ms) { m_window_ms = window_ms; }
+  BLEScanResults start(uint32_t duration_s, bool is_continue = false);
+  void stop(void);
+  // The core deletes every cached device: release the storage the same way
+  void clearResults(void) { std::vector<BLEAdvertisedDevice>().swap(m_results.m_devices); }
+
+private:
+  bool m_active = false;
+  uint16_t m_interval_ms = 100;
+  uint16_t m_window_ms = 100;
+  BLEScanResults m_results;
+  void* m_abort = nullptr;    // Binary semaphore, created by the first start()
+};
+
+#endif // NATIVE_SIM_BLE_SCAN_H
@@ -0,0 +1,95 @@
+/*
+ * NATIVE SIM - Arduino FS File API over a host directory
+ *
+ * Files are shared handles like the core's FileImplPtr: copies refer to
+ * the same open file, which closes when the last copy goes away.
+ *
+ * Accesses through this API also drive a model of the file system on NOR
+ * flash (SPIFFS or LittleFS, see sim_fs.cpp) that feeds the spi_flash
+ * counters. POSIX access to hostPath() is not modelled.
+ */
+
+#ifndef NATIVE_SIM_FS_H
+#define NATIVE_SIM_FS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <memory>
+#include <string>
+
+namespace fs {
+
+enum SeekMode {
+  SeekSet = 0,
+  SeekCur = 1,
+  SeekEnd = 2,
+};
+
+struct FileImpl;
+struct FlashModel;
+
+class File {
+public:
+  File() = default;
+  explicit File(std::shared_ptr<FileImpl> impl) : m_impl(std::move(impl)) {}
+
+  explicit operator bool() const;
+  size_t read(uint8_t* buf, size_t size);
+  int read(void);
+  size_t write(const uint8_t* buf, size_t size);
+  size_t write(uint8_t c) { return write(&c, 1); }
+  bool seek(uint32_t pos, SeekMode mode = SeekSet);
+  size_t position(void) const;
+  size_t size(void) const;
+  int available(void) const;
+  void flush(void);
+  void close(void);
+  const char* name(void) const;
+  const char* path(void) const;
+  bool isDirectory(void) const;
+  File openNextFile(const char* mode = "r");
+
+private:
+  std::shared_ptr<FileImpl> m_impl;
+};
+
+class FS {
+public:
+  enum class Kind { Spiffs, LittleFs };
+
+  FS(const char* label, Kind kind) : m_label(label), m_kind(kind) {}
+
+  /* Directory on the host that plays the partition, set before begin() */
+  void setRoot(const char* host_dir) { m_root = host_dir ? host_dir : ""; }
+
+  File open(const char* path, const char* mode = "r", bool create = false);
+  bool exists(const char* path);
+  bool remove(const char* path);
+  bool rename(const char* from, const char* to);
+  bool mkdir(const char* path);
+
+  /* Host file behind a path (POSIX access like the VFS); empty if not mounted */
+  std::string hostPath(const char* path) const { return m_mounted ? host_path(path) : std::string(); }
+
+protected:
+  std::string host_path(const char* path) const;
+  bool mount(bool format_on_fail);
+  size_t used_bytes(void);
+
+  std::string m_label;
+  Kind m_kind;
+  std::string m_root = "data";
+  bool m_mounted = false;
+  std::shared_ptr<FlashModel> m_model;
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+using fs::SeekMode;
+using fs::SeekSet;
+using fs::SeekCur;
+using fs::SeekEnd;
+
+#endif // NATIVE_SIM_FS_H
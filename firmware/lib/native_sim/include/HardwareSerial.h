@@ -0,0 +1,59 @@
+/*
+ * NATIVE SIM - Serial port on stdout
+ *
+ * TX goes to stdout untouched (binary export frames included, so the host
+ * decoder can read a pipe). RX is fed by the touch script ("serial" lines)
+ * or by stdin when the sim runs with --stdin.
+ */
+
+#ifndef NATIVE_SIM_HARDWARE_SERIAL_H
+#define NATIVE_SIM_HARDWARE_SERIAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "WString.h"
+
+class Print {
+public:
+  virtual ~Print() = default;
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buf, size_t len);
+  size_t write(const char* s);
+
+  size_t print(const char* s);
+  size_t print(const String& s) { return print(s.c_str()); }
+  size_t print(char c);
+  size_t print(int v, int base = 10) { return print(static_cast<long>(v), base); }
+  size_t print(unsigned int v, int base = 10) { return print(static_cast<unsigned long>(v), base); }
+  size_t print(long v, int base = 10);
+  size_t print(unsigned long v, int base = 10);
+  size_t print(long long v, int base = 10) { return print(static_cast<long>(v), base); }
+  size_t print(unsigned long long v, int base = 10) { return print(static_cast<unsigned long>(v), base); }
+  size_t print(double v, int digits = 2);
+
+  size_t println(void) { return print("\r\n"); }
+  template <typename T>
+  size_t println(const T& v) { size_t n = print(v); return n + println(); }
+  template <typename T>
+  size_t println(const T& v, int fmt) { size_t n = print(v, fmt); return n + println(); }
+
+  size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class HardwareSerial : public Print {
+public:
+  void begin(unsigned long baud) { (void)baud; }
+  void end(void) {}
+  int available(void);
+  int read(void);
+  int peek(void);
+  void flush(void);
+  using Print::write;
+  size_t write(uint8_t c) override;
+  size_t write(const uint8_t* buf, size_t len) override;
+  operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif // NATIVE_SIM_HARDWARE_SERIAL_H
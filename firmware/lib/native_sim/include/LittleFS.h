@@ -0,0 +1,31 @@
+/*
+ * NATIVE SIM - LittleFS mounted from a host directory (same --fs as SPIFFS)
+ *
+ * Both file systems format the "spiffs" partition on target; the sim
+ * shares the directory and differs by its flash model.
+ */
+
+#ifndef NATIVE_SIM_LITTLEFS_H
+#define NATIVE_SIM_LITTLEFS_H
+
+#include "FS.h"
+
+namespace fs {
+
+class LittleFSFS : public FS {
+public:
+  LittleFSFS() : FS("spiffs", Kind::LittleFs) {}
+
+  bool begin(bool format_on_fail = false, const char* base_path = "/littlefs",
+             uint8_t max_open_files = 10, const char* partition_label = "spiffs");
+  void end(void) { m_mounted = false; }
+  bool format(void);
+  size_t totalBytes(void);
+  size_t usedBytes(void);
+};
+
+}  // namespace fs
+
+extern fs::LittleFSFS LittleFS;
+
+#endif // NATIVE_SIM_LITTLEFS_H
@@ -0,0 +1,28 @@
+/*
+ * NATIVE SIM - SPIFFS mounted from a host directory (--fs, "data" by default)
+ */
+
+#ifndef NATIVE_SIM_SPIFFS_H
+#define NATIVE_SIM_SPIFFS_H
+
+#include "FS.h"
+
+namespace fs {
+
+class SPIFFSFS : public FS {
+public:
+  SPIFFSFS() : FS("spiffs", Kind::Spiffs) {}
+
+  bool begin(bool format_on_fail = false, const char* base_path = "/spiffs",
+             uint8_t max_open_files = 10, const char* label = nullptr);
+  void end(void) { m_mounted = false; }
+  bool format(void);
+  size_t totalBytes(void);
+  size_t usedBytes(void);
+};
+
+}  // namespace fs
+
+extern fs::SPIFFSFS SPIFFS;
+
+#endif // NATIVE_SIM_SPIFFS_H
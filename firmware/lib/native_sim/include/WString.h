@@ -0,0 +1,48 @@
+/*
+ * NATIVE SIM - Arduino String
+ *
+ * Thin wrapper over std::string covering what the firmware and the radio
+ * stand-ins use.
+ */
+
+#ifndef NATIVE_SIM_WSTRING_H
+#define NATIVE_SIM_WSTRING_H
+
+#include <string>
+
+class String {
+public:
+  String() = default;
+  String(const char* s) : m_str(s ? s : "") {}
+  String(const std::string& s) : m_str(s) {}
+  explicit String(int v) : m_str(std::to_string(v)) {}
+  explicit String(unsigned v) : m_str(std::to_string(v)) {}
+  explicit String(long v) : m_str(std::to_string(v)) {}
+  explicit String(unsigned long v) : m_str(std::to_string(v)) {}
+
+  const char* c_str() const { return m_str.c_str(); }
+  unsigned int length() const { return static_cast<unsigned int>(m_str.size()); }
+  bool isEmpty() const { return m_str.empty(); }
+  char operator[](unsigned int i) const { return i < m_str.size() ? m_str[i] : '\0'; }
+
+  String& operator+=(const String& rhs) { m_str += rhs.m_str; return *this; }
+  String& operator+=(const char* rhs) { m_str += rhs ? rhs : ""; return *this; }
+  String& operator+=(char c) { m_str += c; return *this; }
+  friend String operator+(String lhs, const String& rhs) { lhs += rhs; return lhs; }
+  bool operator==(const String& rhs) const { return m_str == rhs.m_str; }
+  bool operator!=(const String& rhs) const { return m_str != rhs.m_str; }
+
+  void trim()
+  {
+    size_t b = m_str.find_first_not_of(" \t\r\n");
+    size_t e = m_str.find_last_not_of(" \t\r\n");
+    m_str = (b == std::string::npos) ? std::string() : m_str.substr(b, e - b + 1);
+  }
+  bool startsWith(const String& prefix) const { return m_str.compare(0, prefix.m_str.size(), prefix.m_str) == 0; }
+  long toInt() const { return strtol(m_str.c_str(), nullptr, 10); }
+
+private:
+  std::string m_str;
+};
+
+#endif // NATIVE_SIM_WSTRING_H
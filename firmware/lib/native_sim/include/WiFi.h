@@ -0,0 +1,82 @@
+/*
+ * NATIVE SIM - arduino-esp32 2.x WiFi station scan API
+ *
+ * Access points come from the simulated radio environment (sim_radio.cpp).
+ * Async scans finish after a virtual dwell per channel and report through
+ * the "arduino_events" task, like the core's event loop.
+ */
+
+#ifndef NATIVE_SIM_WIFI_H
+#define NATIVE_SIM_WIFI_H
+
+#include <stdint.h>
+#include <functional>
+#include <vector>
+#include "Arduino.h"
+
+typedef enum {
+  WIFI_MODE_NULL = 0,
+  WIFI_MODE_STA,
+  WIFI_MODE_AP,
+  WIFI_MODE_APSTA,
+} wifi_mode_t;
+
+#define WIFI_OFF    WIFI_MODE_NULL
+#define WIFI_STA    WIFI_MODE_STA
+#define WIFI_AP     WIFI_MODE_AP
+#define WIFI_AP_STA WIFI_MODE_APSTA
+
+typedef enum {
+  ARDUINO_EVENT_WIFI_READY = 0,
+  ARDUINO_EVENT_WIFI_SCAN_DONE,
+  ARDUINO_EVENT_WIFI_STA_START,
+  ARDUINO_EVENT_WIFI_STA_STOP,
+  ARDUINO_EVENT_MAX,
+} arduino_event_id_t;
+
+typedef struct {
+  uint32_t status;
+  uint8_t number;
+  uint8_t scan_id;
+} wifi_event_sta_scan_done_t;
+
+typedef union {
+  wifi_event_sta_scan_done_t wifi_scan_done;
+} arduino_event_info_t;
+
+typedef arduino_event_id_t WiFiEvent_t;
+typedef arduino_event_info_t WiFiEventInfo_t;
+typedef void (*WiFiEventSysCb)(arduino_event_id_t event, arduino_event_info_t info);
+typedef std::function<void(arduino_event_id_t event, arduino_event_info_t info)> WiFiEventFuncCb;
+typedef size_t wifi_event_id_t;
+
+#define WIFI_SCAN_RUNNING (-1)
+#define WIFI_SCAN_FAILED  (-2)
+
+class WiFiClass {
+public:
+  bool mode(wifi_mode_t mode) { m_mode = mode; return true; }
+  wifi_mode_t getMode(void) const { return m_mode; }
+  bool disconnect(bool wifioff = false, bool eraseap = false);
+
+  int16_t scanNetworks(bool async = false, bool show_hidden = false, bool passive = false,
+                       uint32_t max_ms_per_chan = 300, uint8_t channel = 0);
+  int16_t scanComplete(void);
+  void scanDelete(void);
+  String SSID(uint8_t i);
+  int32_t RSSI(uint8_t i);
+  int32_t channel(uint8_t i);
+  uint8_t* BSSID(uint8_t i);
+
+  /* Handlers accumulate like the core's event list: no de-duplication */
+  wifi_event_id_t onEvent(WiFiEventSysCb cb, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+  wifi_event_id_t onEvent(WiFiEventFuncCb cb, arduino_event_id_t event = ARDUINO_EVENT_MAX);
+  void removeEvent(wifi_event_id_t id);
+
+private:
+  wifi_mode_t m_mode = WIFI_OFF;
+};
+
+extern WiFiClass WiFi;
+
+#endif // NATIVE_SIM_WIFI_H
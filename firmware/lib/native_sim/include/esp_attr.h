@@ -0,0 +1,16 @@
+/*
+ * NATIVE SIM - Section attributes
+ *
+ * There is no RTC memory on the host: RTC variables are plain statics,
+ * zeroed at start like after a power-on (never kept across a restart).
+ */
+
+#ifndef NATIVE_SIM_ESP_ATTR_H
+#define NATIVE_SIM_ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+
+#endif // NATIVE_SIM_ESP_ATTR_H
@@ -0,0 +1,16 @@
+/*
+ * NATIVE SIM - ESP-IDF version (matches arduino-esp32 2.0.x, IDF 4.4)
+ */
+
+#ifndef NATIVE_SIM_ESP_IDF_VERSION_H
+#define NATIVE_SIM_ESP_IDF_VERSION_H
+
+#define ESP_IDF_VERSION_MAJOR 4
+#define ESP_IDF_VERSION_MINOR 4
+#define ESP_IDF_VERSION_PATCH 6
+
+#define ESP_IDF_VERSION_VAL(major, minor, patch) (((major) << 16) | ((minor) << 8) | (patch))
+#define ESP_IDF_VERSION \
+    ESP_IDF_VERSION_VAL(ESP_IDF_VERSION_MAJOR, ESP_IDF_VERSION_MINOR, ESP_IDF_VERSION_PATCH)
+
+#endif // NATIVE_SIM_ESP_IDF_VERSION_H
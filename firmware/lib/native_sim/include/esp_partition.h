@@ -0,0 +1,58 @@
+/*
+ * NATIVE SIM - ESP-IDF partition API (RAM-backed NOR flash)
+ *
+ * Only the data partitions the firmware opens exist (see sim_partition.cpp).
+ * Flash semantics are kept: erase sets 0xFF per 4 KB sector, writes can
+ * only clear bits. Contents last for one run, unless preloaded from a host
+ * file (sim_partition_load). mmap returns a pointer into the RAM copy.
+ */
+
+#ifndef NATIVE_SIM_ESP_PARTITION_H
+#define NATIVE_SIM_ESP_PARTITION_H
+
+#include "esp_spi_flash.h"
+#include "esp_system.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01,
+} esp_partition_type_t;
+
+typedef enum {
+    ESP_PARTITION_SUBTYPE_DATA_NVS = 0x02,
+    ESP_PARTITION_SUBTYPE_DATA_SPIFFS = 0x82,
+    ESP_PARTITION_SUBTYPE_ANY = 0xff,
+} esp_partition_subtype_t;
+
+typedef struct {
+    void* flash_chip;
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+    bool encrypted;
+} esp_partition_t;
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label);
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t src_offset, void* dst, size_t size);
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t dst_offset, const void* src, size_t size);
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size);
+esp_err_t esp_partition_mmap(const esp_partition_t* partition, size_t offset, size_t size,
+                             spi_flash_mmap_memory_t memory, const void** out_ptr,
+                             spi_flash_mmap_handle_t* out_handle);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NATIVE_SIM_ESP_PARTITION_H
@@ -0,0 +1,43 @@
+/*
+ * NATIVE SIM - Light sleep
+ *
+ * esp_light_sleep_start() blocks the calling task until the timer wakeup
+ * is due in virtual time, or until the scripted pointer is pressed when an
+ * ext0 wakeup is armed (the CYD's touch IRQ). Unlike the chip, other tasks
+ * keep running meanwhile; the time slept is reported at exit.
+ */
+
+#ifndef NATIVE_SIM_ESP_SLEEP_H
+#define NATIVE_SIM_ESP_SLEEP_H
+
+#include <stdint.h>
+#include "esp_system.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int gpio_num_t;
+#define GPIO_NUM_36 36
+
+typedef enum {
+    ESP_SLEEP_WAKEUP_UNDEFINED = 0,
+    ESP_SLEEP_WAKEUP_ALL,
+    ESP_SLEEP_WAKEUP_EXT0,
+    ESP_SLEEP_WAKEUP_EXT1,
+    ESP_SLEEP_WAKEUP_TIMER,
+} esp_sleep_wakeup_cause_t;
+
+typedef esp_sleep_wakeup_cause_t esp_sleep_source_t;
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us);
+esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t gpio_num, int level);
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source);
+esp_err_t esp_light_sleep_start(void);
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NATIVE_SIM_ESP_SLEEP_H
@@ -0,0 +1,55 @@
+/*
+ * NATIVE SIM - SPI flash API: mmap types and operation counters
+ *
+ * Counters are always on here (CONFIG_SPI_FLASH_ENABLE_COUNTERS on target).
+ * Partition accesses and the file systems' simulated block device feed
+ * them; `time` is a flash timing model (40 MHz DIO reads, NOR page
+ * program and sector erase times), since virtual time does not advance
+ * while a task computes.
+ */
+
+#ifndef NATIVE_SIM_ESP_SPI_FLASH_H
+#define NATIVE_SIM_ESP_SPI_FLASH_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SPI_FLASH_SEC_SIZE 4096
+
+#ifndef CONFIG_SPI_FLASH_ENABLE_COUNTERS
+#define CONFIG_SPI_FLASH_ENABLE_COUNTERS 1
+#endif
+
+typedef enum {
+    SPI_FLASH_MMAP_DATA,
+    SPI_FLASH_MMAP_INST,
+} spi_flash_mmap_memory_t;
+
+typedef uint32_t spi_flash_mmap_handle_t;
+
+void spi_flash_munmap(spi_flash_mmap_handle_t handle);
+
+typedef struct {
+    uint32_t count;     // Operations
+    uint32_t time;      // Microseconds
+    uint32_t bytes;
+} spi_flash_counter_t;
+
+typedef struct {
+    spi_flash_counter_t read;
+    spi_flash_counter_t write;
+    spi_flash_counter_t erase;
+} spi_flash_counters_t;
+
+void spi_flash_reset_counters(void);
+void spi_flash_dump_counters(void);
+const spi_flash_counters_t* spi_flash_get_counters(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NATIVE_SIM_ESP_SPI_FLASH_H
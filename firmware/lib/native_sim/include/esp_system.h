@@ -0,0 +1,42 @@
+/*
+ * NATIVE SIM - ESP-IDF system helpers
+ *
+ * Heap figures are a nominal ESP32 heap minus what the firmware allocated
+ * on the host since boot (glibc mallinfo2), so leaks and growth show up in
+ * the sysmon report even though the absolute numbers are not the target's.
+ */
+
+#ifndef NATIVE_SIM_ESP_SYSTEM_H
+#define NATIVE_SIM_ESP_SYSTEM_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int esp_err_t;
+#define ESP_OK   0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_ARG 0x102
+
+#define SIM_NOMINAL_HEAP_BYTES (300u * 1024u)
+
+typedef enum {
+    ESP_MAC_WIFI_STA,
+    ESP_MAC_WIFI_SOFTAP,
+    ESP_MAC_BT,
+    ESP_MAC_ETH,
+} esp_mac_type_t;
+
+uint32_t esp_get_free_heap_size(void);
+uint32_t esp_get_minimum_free_heap_size(void);
+esp_err_t esp_read_mac(uint8_t* mac, esp_mac_type_t type);
+void esp_restart(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NATIVE_SIM_ESP_SYSTEM_H
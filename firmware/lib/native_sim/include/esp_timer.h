@@ -0,0 +1,20 @@
+/*
+ * NATIVE SIM - ESP-IDF high resolution time (virtual clock)
+ */
+
+#ifndef NATIVE_SIM_ESP_TIMER_H
+#define NATIVE_SIM_ESP_TIMER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int64_t esp_timer_get_time(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NATIVE_SIM_ESP_TIMER_H
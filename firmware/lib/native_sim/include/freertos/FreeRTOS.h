@@ -0,0 +1,84 @@
+/*
+ * NATIVE SIM - FreeRTOS subset
+ *
+ * Same names and semantics as the ESP-IDF flavour of FreeRTOS used by the
+ * Arduino core, implemented by a deterministic single-CPU scheduler
+ * (sim_kernel.cpp). Ticks are 1 ms like CONFIG_FREERTOS_HZ=1000.
+ */
+
+#ifndef NATIVE_SIM_FREERTOS_H
+#define NATIVE_SIM_FREERTOS_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t StackType_t;
+typedef void (*TaskFunction_t)(void*);
+
+#define configTICK_RATE_HZ            1000
+#define configMAX_PRIORITIES          25
+#define configMAX_TASK_NAME_LEN       16
+#define configTIMER_TASK_PRIORITY     1
+#define configUSE_MUTEXES             1
+#define configSUPPORT_STATIC_ALLOCATION 1
+#define configUSE_TRACE_FACILITY      0
+#define configGENERATE_RUN_TIME_STATS 0   // Host CPU time is reported by the sim itself
+#define portNUM_PROCESSORS            2
+
+#define pdFALSE  ((BaseType_t)0)
+#define pdTRUE   ((BaseType_t)1)
+#define pdFAIL   pdFALSE
+#define pdPASS   pdTRUE
+#define errQUEUE_FULL ((BaseType_t)0)
+
+#define portMAX_DELAY       ((TickType_t)0xFFFFFFFFu)
+#define portTICK_PERIOD_MS  ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000u))
+#define pdTICKS_TO_MS(t)    ((uint32_t)(((uint64_t)(t) * 1000u) / configTICK_RATE_HZ))
+
+#define tskNO_AFFINITY      ((BaseType_t)0x7FFFFFFF)
+#define tskIDLE_PRIORITY    ((UBaseType_t)0)
+
+/*
+ * Only one simulated task runs at any time, so critical sections have
+ * nothing to exclude. The spinlock type is kept for source compatibility.
+ */
+typedef struct {
+    uint32_t owner;
+    uint32_t count;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED { 0, 0 }
+#define portENTER_CRITICAL(mux)      ((void)(mux))
+#define portEXIT_CRITICAL(mux)       ((void)(mux))
+#define portENTER_CRITICAL_ISR(mux)  ((void)(mux))
+#define portEXIT_CRITICAL_ISR(mux)   ((void)(mux))
+#define taskENTER_CRITICAL(mux)      ((void)(mux))
+#define taskEXIT_CRITICAL(mux)       ((void)(mux))
+#define portYIELD_FROM_ISR(...)      ((void)0)
+
+BaseType_t xPortGetCoreID(void);
+
+/*
+ * Control blocks for the *CreateStatic variants. Opaque like on target, but
+ * sized for the sim's own objects: sizeof() differs from the Xtensa build.
+ */
+typedef struct { uint64_t opaque[36]; } StaticTask_t;
+typedef struct { uint64_t opaque[10]; } StaticQueue_t;
+typedef struct { uint64_t opaque[6]; } StaticSemaphore_t;
+typedef struct { uint64_t opaque[2]; } StaticEventGroup_t;
+typedef struct { uint64_t opaque[9]; } StaticTimer_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NATIVE_SIM_FREERTOS_H
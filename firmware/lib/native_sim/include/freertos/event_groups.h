@@ -0,0 +1,32 @@
+/*
+ * NATIVE SIM - FreeRTOS event groups
+ */
+
+#ifndef NATIVE_SIM_EVENT_GROUPS_H
+#define NATIVE_SIM_EVENT_GROUPS_H
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void* EventGroupHandle_t;
+typedef uint32_t EventBits_t;
+
+EventGroupHandle_t xEventGroupCreate(void);
+EventGroupHandle_t xEventGroupCreateStatic(StaticEventGroup_t* group_buffer);
+void vEventGroupDelete(EventGroupHandle_t group);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t ticks_to_wait);
+
+#define xEventGroupSetBitsFromISR(g, bits, woken) xEventGroupSetBits((g), (bits))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NATIVE_SIM_EVENT_GROUPS_H
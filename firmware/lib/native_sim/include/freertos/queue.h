@@ -0,0 +1,39 @@
+/*
+ * NATIVE SIM - FreeRTOS queue API
+ */
+
+#ifndef NATIVE_SIM_QUEUE_H
+#define NATIVE_SIM_QUEUE_H
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void* QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t item_size, uint8_t* storage,
+                                 StaticQueue_t* queue_buffer);
+void vQueueDelete(QueueHandle_t queue);
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait);
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait);
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item);
+BaseType_t xQueueReceive(QueueHandle_t queue, void* out_item, TickType_t ticks_to_wait);
+BaseType_t xQueuePeek(QueueHandle_t queue, void* out_item, TickType_t ticks_to_wait);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue);
+BaseType_t xQueueReset(QueueHandle_t queue);
+
+#define xQueueSend(q, item, ticks) xQueueSendToBack((q), (item), (ticks))
+#define xQueueSendFromISR(q, item, woken) xQueueSendToBack((q), (item), 0)
+#define xQueueSendToBackFromISR(q, item, woken) xQueueSendToBack((q), (item), 0)
+#define xQueueReceiveFromISR(q, item, woken) xQueueReceive((q), (item), 0)
+#define uxQueueMessagesWaitingFromISR(q) uxQueueMessagesWaiting(q)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NATIVE_SIM_QUEUE_H
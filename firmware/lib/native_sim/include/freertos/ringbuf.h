@@ -0,0 +1,39 @@
+/*
+ * NATIVE SIM - ESP-IDF ring buffer (byte buffer type only)
+ */
+
+#ifndef NATIVE_SIM_RINGBUF_H
+#define NATIVE_SIM_RINGBUF_H
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void* RingbufHandle_t;
+
+typedef enum {
+    RINGBUF_TYPE_NOSPLIT = 0,
+    RINGBUF_TYPE_ALLOWSPLIT,
+    RINGBUF_TYPE_BYTEBUF,
+} RingbufferType_t;
+
+typedef struct { uint64_t opaque[10]; } StaticRingbuffer_t;   // Sim-sized, see FreeRTOS.h
+
+/* Only RINGBUF_TYPE_BYTEBUF is implemented; other types return NULL. */
+RingbufHandle_t xRingbufferCreate(size_t size, RingbufferType_t type);
+RingbufHandle_t xRingbufferCreateStatic(size_t size, RingbufferType_t type, uint8_t* storage,
+                                        StaticRingbuffer_t* ring_buffer);
+void vRingbufferDelete(RingbufHandle_t ring);
+BaseType_t xRingbufferSend(RingbufHandle_t ring, const void* data, size_t size, TickType_t ticks_to_wait);
+void* xRingbufferReceive(RingbufHandle_t ring, size_t* out_size, TickType_t ticks_to_wait);
+void* xRingbufferReceiveUpTo(RingbufHandle_t ring, size_t* out_size, TickType_t ticks_to_wait, size_t max_size);
+void vRingbufferReturnItem(RingbufHandle_t ring, void* item);
+size_t xRingbufferGetCurFreeSize(RingbufHandle_t ring);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NATIVE_SIM_RINGBUF_H
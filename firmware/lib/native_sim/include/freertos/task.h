@@ -0,0 +1,80 @@
+/*
+ * NATIVE SIM - FreeRTOS task API
+ */
+
+#ifndef NATIVE_SIM_TASK_H
+#define NATIVE_SIM_TASK_H
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void* TaskHandle_t;
+
+typedef enum {
+    eRunning = 0,
+    eReady,
+    eBlocked,
+    eSuspended,
+    eDeleted,
+    eInvalid,
+} eTaskState;
+
+typedef enum {
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+    eSetValueWithoutOverwrite,
+} eNotifyAction;
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_depth,
+                                   void* arg, UBaseType_t priority, TaskHandle_t* out_handle,
+                                   BaseType_t core_id);
+#define xTaskCreate(fn, name, depth, arg, prio, handle) \
+    xTaskCreatePinnedToCore((fn), (name), (depth), (arg), (prio), (handle), tskNO_AFFINITY)
+
+/* The stack buffer is not used: host threads get their own stack. */
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_depth,
+                                           void* arg, UBaseType_t priority, StackType_t* stack_buffer,
+                                           StaticTask_t* task_buffer, BaseType_t core_id);
+#define xTaskCreateStatic(fn, name, depth, arg, prio, stack, tcb) \
+    xTaskCreateStaticPinnedToCore((fn), (name), (depth), (arg), (prio), (stack), (tcb), tskNO_AFFINITY)
+
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+BaseType_t xTaskDelayUntil(TickType_t* previous_wake, TickType_t increment);
+#define vTaskDelayUntil(prev, inc) ((void)xTaskDelayUntil((prev), (inc)))
+void vTaskSuspend(TaskHandle_t task);
+void vTaskResume(TaskHandle_t task);
+void taskYIELD(void);
+
+TickType_t xTaskGetTickCount(void);
+#define xTaskGetTickCountFromISR() xTaskGetTickCount()
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+char* pcTaskGetName(TaskHandle_t task);
+#define pcTaskGetTaskName(task) pcTaskGetName(task)
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task);
+void vTaskPrioritySet(TaskHandle_t task, UBaseType_t priority);
+eTaskState eTaskGetState(TaskHandle_t task);
+UBaseType_t uxTaskGetNumberOfTasks(void);
+BaseType_t xTaskGetAffinity(TaskHandle_t task);
+
+/* Host stacks are not comparable to Xtensa ones: returns the configured depth. */
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action);
+#define xTaskNotifyFromISR(task, value, action, woken) xTaskNotify((task), (value), (action))
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit,
+                           uint32_t* out_value, TickType_t ticks_to_wait);
+#define xTaskNotifyGive(task) xTaskNotify((task), 0, eIncrement)
+#define vTaskNotifyGiveFromISR(task, woken) ((void)xTaskNotify((task), 0, eIncrement))
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NATIVE_SIM_TASK_H
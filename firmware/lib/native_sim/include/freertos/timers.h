@@ -0,0 +1,41 @@
+/*
+ * NATIVE SIM - FreeRTOS software timers
+ *
+ * Callbacks run in the "Tmr Svc" task, like on target. Commands take effect
+ * immediately, so the ticks_to_wait arguments are ignored.
+ */
+
+#ifndef NATIVE_SIM_TIMERS_H
+#define NATIVE_SIM_TIMERS_H
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void* TimerHandle_t;
+typedef void (*TimerCallbackFunction_t)(TimerHandle_t timer);
+
+TimerHandle_t xTimerCreate(const char* name, TickType_t period, UBaseType_t auto_reload,
+                           void* timer_id, TimerCallbackFunction_t callback);
+TimerHandle_t xTimerCreateStatic(const char* name, TickType_t period, UBaseType_t auto_reload,
+                                 void* timer_id, TimerCallbackFunction_t callback, StaticTimer_t* timer_buffer);
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticks_to_wait);
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticks_to_wait);
+BaseType_t xTimerReset(TimerHandle_t timer, TickType_t ticks_to_wait);
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t ticks_to_wait);
+BaseType_t xTimerDelete(TimerHandle_t timer, TickType_t ticks_to_wait);
+BaseType_t xTimerIsTimerActive(TimerHandle_t timer);
+void* pvTimerGetTimerID(TimerHandle_t timer);
+TickType_t xTimerGetPeriod(TimerHandle_t timer);
+
+#define xTimerStartFromISR(t, woken) xTimerStart((t), 0)
+#define xTimerStopFromISR(t, woken) xTimerStop((t), 0)
+#define xTimerResetFromISR(t, woken) xTimerReset((t), 0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NATIVE_SIM_TIMERS_H
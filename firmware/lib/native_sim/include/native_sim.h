@@ -0,0 +1,112 @@
+/*
+ * NATIVE SIM - Host-side peripherals for the native build
+ *
+ * The drivers' MOCK_TFT_ESPI / MOCK_TOUCH branches call into this API:
+ * an RGB565 framebuffer replaces the ILI9341 and a scripted pointer
+ * replaces the XPT2046. Everything runs on the simulated virtual clock.
+ */
+
+#ifndef NATIVE_SIM_H
+#define NATIVE_SIM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ---------- Display (memory framebuffer) ---------- */
+
+void sim_display_init(uint16_t width, uint16_t height);
+void sim_display_set_rotation(uint8_t rotation);
+void sim_display_set_backlight(bool on);
+void sim_display_push(int32_t x, int32_t y, uint32_t w, uint32_t h, const uint16_t* pixels);
+
+/* Binary PPM (P6) of the current framebuffer; false when the file can't be written */
+bool sim_display_dump_ppm(const char* path);
+
+typedef struct {
+    uint32_t flushes;
+    uint64_t pixels;
+} sim_display_stats_t;
+
+void sim_display_get_stats(sim_display_stats_t* out);
+
+/* ---------- Touch (scripted pointer) ---------- */
+
+/* Same contract as cyd_touch_read(): coordinates are kept while released */
+bool sim_touch_read(uint16_t* x, uint16_t* y);
+
+/*
+ * Script file, one command per line, '#' for comments:
+ *   <ms> tap <x> <y> [hold_ms]    press then release (default hold 80 ms)
+ *   <ms> press <x> <y>
+ *   <ms> release
+ *   <ms> shot <file.ppm>          framebuffer dump
+ *   <ms> serial <text>            bytes for Serial.read(), newline appended
+ *   <ms> quit                     stop the simulation
+ * <ms> is absolute virtual time since boot, or "+<ms>" after the previous line.
+ */
+bool sim_script_start(const char* path);
+
+/* ---------- Serial RX ---------- */
+
+void sim_serial_inject(const char* data, size_t len);
+
+/* Forward host stdin to Serial RX (polled from a sim task) */
+void sim_serial_attach_stdin(void);
+
+/* ---------- Radio environment ---------- */
+
+typedef struct {
+    uint32_t seed;
+    uint16_t wifi_aps;       // Access points in range
+    uint16_t ble_devices;    // Advertisers in range (about a third come and go)
+} sim_radio_config_t;
+
+void sim_radio_configure(const sim_radio_config_t* config);
+
+/* ---------- Misc ---------- */
+
+/* Seed for random(); the radio environment has its own in sim_radio_config_t */
+void sim_set_seed(uint32_t seed);
+
+/* Host clock for CPU-bound benchmarks: virtual time stands still while a task computes */
+uint64_t sim_host_time_us(void);
+
+/* Host directory mounted as SPIFFS */
+void sim_fs_set_root(const char* host_dir);
+
+/* LittleFS block device geometry the flash model uses (esp_littlefs takes it from sdkconfig) */
+typedef struct {
+    uint32_t read_size;
+    uint32_t prog_size;
+    uint32_t cache_size;
+    uint32_t lookahead_size;
+} sim_littlefs_geometry_t;
+
+void sim_fs_set_littlefs_geometry(const sim_littlefs_geometry_t* geometry);
+
+/* Host path of a file ("/img/bg_1.bin") of the mounted FS, what open() takes under its mount point on target */
+bool sim_fs_host_path(const char* path, char* out, size_t out_len);
+
+/* Preload a data partition ("assets") from a host file; false if missing or too large */
+bool sim_partition_load(const char* label, const char* host_file);
+
+/* ---------- Unit tests (pio test -e native) ---------- */
+
+/*
+ * main() of a test/test_* suite: runs the Unity runner (UNITY_BEGIN ...
+ * return UNITY_END()) in a task on the simulated kernel, seed 1, default
+ * radio environment, empty scratch file system. Exits the process with 0
+ * when every test passed.
+ */
+int sim_test_main(int (*runner)(void));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NATIVE_SIM_H
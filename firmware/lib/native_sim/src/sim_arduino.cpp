@@ -0,0 +1,362 @@
+/*
+ * NATIVE SIM - Arduino core and ESP-IDF system functions
+ */
+
+#include "Arduino.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "native_sim.h"
+#include "sim_internal.h"
+#include "sim_kernel.h"
+
+#include <malloc.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <unistd.h>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <random>
+
+HardwareSerial Serial;
+
+static std::mt19937 s_rng(1);
+static std::mutex s_rx_mutex;
+static std::deque<uint8_t> s_rx;
+static size_t s_heap_baseline = 0;
+static uint32_t s_heap_min_free = SIM_NOMINAL_HEAP_BYTES;
+
+/* ---------- Time ---------- */
+
+unsigned long millis(void)
+{
+  return static_cast<unsigned long>(sim_now_us() / 1000u);
+}
+
+unsigned long micros(void)
+{
+  return static_cast<unsigned long>(sim_now_us());
+}
+
+void delay(uint32_t ms)
+{
+  vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+void delayMicroseconds(uint32_t us)
+{
+  // Busy-waits are sub-tick on target: they cost no virtual time here.
+  (void)us;
+}
+
+void yield(void)
+{
+  taskYIELD();
+}
+
+int64_t esp_timer_get_time(void)
+{
+  return static_cast<int64_t>(sim_now_us());
+}
+
+uint64_t sim_host_time_us(void)
+{
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/* ---------- Random ---------- */
+
+void sim_set_seed(uint32_t seed)
+{
+  s_rng.seed(seed);
+}
+
+void randomSeed(unsigned long seed)
+{
+  if (seed != 0) s_rng.seed(static_cast<uint32_t>(seed));
+}
+
+long random(long max_val)
+{
+  if (max_val <= 0) return 0;
+  return static_cast<long>(static_cast<uint32_t>(s_rng()) % static_cast<uint32_t>(max_val));
+}
+
+long random(long min_val, long max_val)
+{
+  if (min_val >= max_val) return min_val;
+  return min_val + random(max_val - min_val);
+}
+
+/* ---------- Heap ---------- */
+
+static size_t host_heap_in_use(void)
+{
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+void sim_heap_mark_baseline(void)
+{
+  s_heap_baseline = host_heap_in_use();
+}
+
+uint32_t esp_get_free_heap_size(void)
+{
+  size_t used = host_heap_in_use();
+  size_t grown = used > s_heap_baseline ? used - s_heap_baseline : 0;
+  uint32_t free_bytes = grown >= SIM_NOMINAL_HEAP_BYTES ? 0 : static_cast<uint32_t>(SIM_NOMINAL_HEAP_BYTES - grown);
+  if (free_bytes < s_heap_min_free) s_heap_min_free = free_bytes;
+  return free_bytes;
+}
+
+uint32_t esp_get_minimum_free_heap_size(void)
+{
+  esp_get_free_heap_size();
+  return s_heap_min_free;
+}
+
+size_t heap_caps_get_free_size(uint32_t caps)
+{
+  (void)caps;
+  return esp_get_free_heap_size();
+}
+
+size_t heap_caps_get_largest_free_block(uint32_t caps)
+{
+  // No fragmentation model: glibc's arenas say nothing about the target's.
+  return heap_caps_get_free_size(caps);
+}
+
+void* heap_caps_malloc(size_t size, uint32_t caps)
+{
+  (void)caps;
+  return malloc(size);
+}
+
+void heap_caps_free(void* ptr)
+{
+  free(ptr);
+}
+
+/* ---------- System ---------- */
+
+esp_err_t esp_read_mac(uint8_t* mac, esp_mac_type_t type)
+{
+  if (!mac) return ESP_ERR_INVALID_ARG;
+  // Espressif OUI, fixed NIC part; the last byte follows the IDF offsets.
+  static const uint8_t base[6] = {0x24, 0x6F, 0x28, 0x51, 0x1D, 0x00};
+  memcpy(mac, base, sizeof(base));
+  mac[5] = static_cast<uint8_t>(base[5] + type);
+  return ESP_OK;
+}
+
+void esp_restart(void)
+{
+  fprintf(stderr, "[SIM] esp_restart() called\n");
+  sim_kernel_stop(SIM_KERNEL_EXIT_OK);
+}
+
+/* ---------- Sleep ---------- */
+
+#define SIM_SLEEP_POLL_MS 20   // Pointer sampling while an ext0 wakeup is armed
+
+static uint64_t s_sleep_timer_us = 0;
+static bool s_sleep_ext0 = false;
+static esp_sleep_wakeup_cause_t s_wakeup_cause = ESP_SLEEP_WAKEUP_UNDEFINED;
+static uint32_t s_sleep_count = 0;
+static uint64_t s_sleep_total_us = 0;
+
+esp_err_t esp_sleep_enable_timer_wakeup(uint64_t time_in_us)
+{
+  s_sleep_timer_us = time_in_us;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_ext0_wakeup(gpio_num_t gpio_num, int level)
+{
+  (void)gpio_num;
+  (void)level;
+  s_sleep_ext0 = true;
+  return ESP_OK;
+}
+
+esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source)
+{
+  if (source == ESP_SLEEP_WAKEUP_ALL || source == ESP_SLEEP_WAKEUP_TIMER) s_sleep_timer_us = 0;
+  if (source == ESP_SLEEP_WAKEUP_ALL || source == ESP_SLEEP_WAKEUP_EXT0) s_sleep_ext0 = false;
+  return ESP_OK;
+}
+
+esp_err_t esp_light_sleep_start(void)
+{
+  const uint64_t start = sim_now_us();
+  const uint64_t due = s_sleep_timer_us ? start + s_sleep_timer_us : UINT64_MAX;
+  s_wakeup_cause = ESP_SLEEP_WAKEUP_TIMER;
+  for (;;) {
+    if (s_sleep_ext0 && sim_touch_read(NULL, NULL)) {
+      s_wakeup_cause = ESP_SLEEP_WAKEUP_EXT0;
+      break;
+    }
+    const uint64_t now = sim_now_us();
+    if (now >= due) break;
+    uint64_t step_us = due - now;
+    if (s_sleep_ext0 && step_us > SIM_SLEEP_POLL_MS * 1000u) step_us = SIM_SLEEP_POLL_MS * 1000u;
+    vTaskDelay(static_cast<TickType_t>((step_us + 999u) / 1000u));
+  }
+  s_sleep_count++;
+  s_sleep_total_us += sim_now_us() - start;
+  return ESP_OK;
+}
+
+esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause(void)
+{
+  return s_wakeup_cause;
+}
+
+void sim_sleep_print_report(void)
+{
+  if (!s_sleep_count) return;
+  fprintf(stderr, "[SIM] light sleep: %u entries, %.1f s\n", s_sleep_count, s_sleep_total_us / 1e6);
+}
+
+/* ---------- Serial ---------- */
+
+size_t Print::write(const uint8_t* buf, size_t len)
+{
+  size_t n = 0;
+  while (n < len && write(buf[n])) ++n;
+  return n;
+}
+
+size_t Print::write(const char* s)
+{
+  return s ? write(reinterpret_cast<const uint8_t*>(s), strlen(s)) : 0;
+}
+
+size_t Print::print(const char* s)
+{
+  return write(s);
+}
+
+size_t Print::print(char c)
+{
+  return write(static_cast<uint8_t>(c));
+}
+
+size_t Print::print(long v, int base)
+{
+  if (base == 10) {
+    char buf[24];
+    int n = snprintf(buf, sizeof(buf), "%ld", v);
+    return write(reinterpret_cast<const uint8_t*>(buf), static_cast<size_t>(n));
+  }
+  return print(static_cast<unsigned long>(v), base);
+}
+
+size_t Print::print(unsigned long v, int base)
+{
+  if (base < 2 || base > 16) base = 10;
+  char buf[sizeof(unsigned long) * 8 + 1];
+  char* p = &buf[sizeof(buf) - 1];
+  *p = '\0';
+  do {
+    *--p = "0123456789ABCDEF"[v % base];
+    v /= base;
+  } while (v);
+  return write(p);
+}
+
+size_t Print::print(double v, int digits)
+{
+  char buf[48];
+  int n = snprintf(buf, sizeof(buf), "%.*f", digits, v);
+  return write(reinterpret_cast<const uint8_t*>(buf), static_cast<size_t>(n));
+}
+
+size_t Print::printf(const char* fmt, ...)
+{
+  char stack_buf[256];
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(stack_buf, sizeof(stack_buf), fmt, args);
+  va_end(args);
+  if (n < 0) return 0;
+  if (static_cast<size_t>(n) < sizeof(stack_buf)) {
+    return write(reinterpret_cast<const uint8_t*>(stack_buf), static_cast<size_t>(n));
+  }
+
+  std::string big(static_cast<size_t>(n) + 1, '\0');
+  va_start(args, fmt);
+  vsnprintf(&big[0], big.size(), fmt, args);
+  va_end(args);
+  return write(reinterpret_cast<const uint8_t*>(big.data()), static_cast<size_t>(n));
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+  return fwrite(&c, 1, 1, stdout);
+}
+
+size_t HardwareSerial::write(const uint8_t* buf, size_t len)
+{
+  return fwrite(buf, 1, len, stdout);
+}
+
+void HardwareSerial::flush(void)
+{
+  fflush(stdout);
+}
+
+int HardwareSerial::available(void)
+{
+  std::lock_guard<std::mutex> lock(s_rx_mutex);
+  return static_cast<int>(s_rx.size());
+}
+
+int HardwareSerial::read(void)
+{
+  std::lock_guard<std::mutex> lock(s_rx_mutex);
+  if (s_rx.empty()) return -1;
+  int c = s_rx.front();
+  s_rx.pop_front();
+  return c;
+}
+
+int HardwareSerial::peek(void)
+{
+  std::lock_guard<std::mutex> lock(s_rx_mutex);
+  return s_rx.empty() ? -1 : s_rx.front();
+}
+
+void sim_serial_inject(const char* data, size_t len)
+{
+  std::lock_guard<std::mutex> lock(s_rx_mutex);
+  s_rx.insert(s_rx.end(), data, data + len);
+}
+
+// stdin is read without blocking so the virtual clock keeps running.
+static void sim_stdin_task(void* arg)
+{
+  (void)arg;
+  for (;;) {
+    struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+    while (poll(&pfd, 1, 0) > 0) {
+      char buf[128];
+      ssize_t n = ::read(STDIN_FILENO, buf, sizeof(buf));
+      if (n <= 0) vTaskDelete(NULL);   // EOF: nothing more to forward
+      sim_serial_inject(buf, static_cast<size_t>(n));
+    }
+    vTaskDelay(pdMS_TO_TICKS(20));
+  }
+}
+
+void sim_serial_attach_stdin(void)
+{
+  xTaskCreatePinnedToCore(sim_stdin_task, "sim_stdin", 2048, NULL, 1, NULL, 0);
+}
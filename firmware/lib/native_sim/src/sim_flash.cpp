@@ -0,0 +1,65 @@
+/*
+ * NATIVE SIM - SPI flash operation counters and timing model
+ *
+ * One call = one SPI transaction, as the IDF flash driver counts them.
+ * Times are those of the CYD's flash at 40 MHz DIO: a fixed cost per
+ * transaction (command, address, cache disable/enable) plus 10 MB/s on
+ * reads, ~0.5 MB/s page programming, 45 ms per 4 KB sector erase.
+ */
+
+#include "esp_spi_flash.h"
+#include "sim_internal.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <mutex>
+
+#define SIM_FLASH_OP_US             8
+#define SIM_FLASH_READ_NS_PER_BYTE  100
+#define SIM_FLASH_PROG_NS_PER_BYTE  2000
+#define SIM_FLASH_ERASE_US          45000
+
+static std::mutex s_mutex;
+static spi_flash_counters_t s_counters;
+
+static void add(spi_flash_counter_t* c, uint32_t bytes, uint32_t us)
+{
+  std::lock_guard<std::mutex> lock(s_mutex);
+  c->count++;
+  c->bytes += bytes;
+  c->time += us;
+}
+
+void sim_flash_count_read(uint32_t bytes)
+{
+  add(&s_counters.read, bytes, SIM_FLASH_OP_US + bytes * SIM_FLASH_READ_NS_PER_BYTE / 1000u);
+}
+
+void sim_flash_count_write(uint32_t bytes)
+{
+  add(&s_counters.write, bytes, SIM_FLASH_OP_US + bytes * SIM_FLASH_PROG_NS_PER_BYTE / 1000u);
+}
+
+void sim_flash_count_erase(uint32_t bytes)
+{
+  add(&s_counters.erase, bytes, (bytes + SPI_FLASH_SEC_SIZE - 1) / SPI_FLASH_SEC_SIZE * SIM_FLASH_ERASE_US);
+}
+
+void spi_flash_reset_counters(void)
+{
+  std::lock_guard<std::mutex> lock(s_mutex);
+  memset(&s_counters, 0, sizeof(s_counters));
+}
+
+void spi_flash_dump_counters(void)
+{
+  const spi_flash_counters_t* c = spi_flash_get_counters();
+  printf(" read: count=%u, time=%uus, bytes=%u\n", c->read.count, c->read.time, c->read.bytes);
+  printf(" write: count=%u, time=%uus, bytes=%u\n", c->write.count, c->write.time, c->write.bytes);
+  printf(" erase: count=%u, time=%uus, bytes=%u\n", c->erase.count, c->erase.time, c->erase.bytes);
+}
+
+const spi_flash_counters_t* spi_flash_get_counters(void)
+{
+  return &s_counters;
+}
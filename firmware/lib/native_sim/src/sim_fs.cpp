@@ -0,0 +1,567 @@
+/*
+ * NATIVE SIM - FS/SPIFFS/LittleFS backed by a host directory
+ *
+ * SPIFFS is flat on target; the host directory may hold folders, which
+ * list like the core's directory handles.
+ *
+ * The bytes live in the host directory; what the file system would have
+ * done on flash is replayed by a block device model and charged to the
+ * spi_flash counters:
+ * - SPIFFS: 256-byte pages (251 payload bytes) through a 10-page cache.
+ *   Finding a file, and every object index page after the first, means
+ *   scanning the lookup page of the partition's blocks.
+ * - LittleFS: 4 KB blocks; a file is a CTZ skip-list walked back from its
+ *   last block on every block change (one pointer read per hop), data goes
+ *   through a per-file read cache of cache_size bytes filled in read_size
+ *   units, whole-block reads bypass it. Directories are metadata pairs
+ *   read in cache_size chunks.
+ */
+
+#include "FS.h"
+#include "LittleFS.h"
+#include "SPIFFS.h"
+#include "native_sim.h"
+#include "sim_internal.h"
+
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+fs::SPIFFSFS SPIFFS;
+fs::LittleFSFS LittleFS;
+
+#define SIM_SPIFFS_TOTAL_BYTES (0xF0000u)    // spiffs partition of partitions_custom.csv
+
+#define SIM_FS_BLOCK            4096u
+#define SIM_SPIFFS_PAGE         256u
+#define SIM_SPIFFS_PAYLOAD      (SIM_SPIFFS_PAGE - 5u)   // Data page header: object id, span index, flags
+#define SIM_SPIFFS_IX_HEAD      104u        // Data pages listed by the object index header page
+#define SIM_SPIFFS_IX_PAGE      122u        // ... by each further object index page
+#define SIM_SPIFFS_CACHE_PAGES  10u         // esp_spiffs: one cache page per max_open_files
+
+#define SIM_PAGE_LOOKUP         0u
+#define SIM_PAGE_INDEX          1u
+#define SIM_PAGE_DATA           2u
+
+static sim_littlefs_geometry_t s_lfs_geometry = {128, 128, 512, 128};
+
+namespace fs {
+
+struct FlashModel {
+  FS::Kind kind;
+  uint32_t blocks;
+  std::mutex mutex;
+  std::vector<uint64_t> lru;          // SPIFFS cached pages, most recent first
+  sim_littlefs_geometry_t lfs;
+  uint32_t allocated = 0;             // LittleFS blocks allocated since the last lookahead scan
+};
+
+struct FileImpl {
+  std::string vpath;                 // Path as seen by the firmware
+  std::string host;                  // Path on the host
+  FILE* fp = nullptr;
+  bool is_dir = false;
+  std::vector<std::string> entries;  // Directory children, sorted
+  size_t next_entry = 0;
+  std::string base_name;
+
+  std::shared_ptr<FlashModel> model;
+  uint32_t id = 0;                   // Object id for the page cache
+  uint32_t spiffs_ix = UINT32_MAX;   // Object index page the cursor is on
+  uint32_t lfs_block = UINT32_MAX;   // Block the cursor is on
+  uint32_t lfs_cache_start = 0;
+  uint32_t lfs_cache_len = 0;
+  uint32_t lfs_pending = 0;          // Written bytes not programmed yet
+  uint32_t lfs_written = 0;
+
+  ~FileImpl();
+};
+
+/* ---------- Block device model ---------- */
+
+static uint64_t page_key(uint32_t id, uint32_t kind, uint32_t index)
+{
+  return (static_cast<uint64_t>(id) << 32) | (static_cast<uint64_t>(kind) << 28) | index;
+}
+
+static void spiffs_page(FlashModel& m, uint64_t key)
+{
+  auto it = std::find(m.lru.begin(), m.lru.end(), key);
+  if (it != m.lru.end()) {
+    m.lru.erase(it);
+  } else {
+    sim_flash_count_read(SIM_SPIFFS_PAGE);
+    if (m.lru.size() >= SIM_SPIFFS_CACHE_PAGES) m.lru.pop_back();
+  }
+  m.lru.insert(m.lru.begin(), key);
+}
+
+// Object lookup: the lookup page of each block, until the object shows up
+static void spiffs_scan(FlashModel& m, uint32_t blocks)
+{
+  for (uint32_t b = 0; b < blocks; ++b) spiffs_page(m, page_key(0, SIM_PAGE_LOOKUP, b));
+}
+
+static void spiffs_read(FileImpl& f, uint32_t off, uint32_t len)
+{
+  FlashModel& m = *f.model;
+  for (uint32_t k = off / SIM_SPIFFS_PAYLOAD; k <= (off + len - 1) / SIM_SPIFFS_PAYLOAD; ++k) {
+    uint32_t ix = k < SIM_SPIFFS_IX_HEAD ? 0 : 1 + (k - SIM_SPIFFS_IX_HEAD) / SIM_SPIFFS_IX_PAGE;
+    if (ix != f.spiffs_ix) {
+      if (ix != 0) spiffs_scan(m, m.blocks / 2);   // The header page is known from open
+      spiffs_page(m, page_key(f.id, SIM_PAGE_INDEX, ix));
+      f.spiffs_ix = ix;
+    }
+    spiffs_page(m, page_key(f.id, SIM_PAGE_DATA, k));
+  }
+}
+
+static void spiffs_write(FileImpl& f, uint32_t off, uint32_t len)
+{
+  (void)f;
+  for (uint32_t k = off / SIM_SPIFFS_PAYLOAD; k <= (off + len - 1) / SIM_SPIFFS_PAYLOAD; ++k) {
+    sim_flash_count_write(SIM_SPIFFS_PAGE);
+    if (k >= SIM_SPIFFS_IX_HEAD && (k - SIM_SPIFFS_IX_HEAD) % SIM_SPIFFS_IX_PAGE == 0) {
+      sim_flash_count_write(SIM_SPIFFS_PAGE);   // New object index page
+    }
+  }
+}
+
+static uint32_t lfs_npw2(uint32_t a)
+{
+  return a <= 1 ? 0 : 32 - __builtin_clz(a - 1);
+}
+
+// lfs_ctz_find: hops from the last block back to `target`
+static void lfs_find_block(FlashModel& m, uint32_t head, uint32_t target)
+{
+  uint32_t current = head;
+  while (current > target) {
+    uint32_t skip = std::min(lfs_npw2(current - target + 1) - 1, static_cast<uint32_t>(__builtin_ctz(current)));
+    sim_flash_count_read(m.lfs.read_size);
+    current -= 1u << skip;
+  }
+}
+
+static void lfs_read(FileImpl& f, uint32_t off, uint32_t len, uint32_t file_size)
+{
+  FlashModel& m = *f.model;
+  uint32_t head = file_size ? (file_size - 1) / SIM_FS_BLOCK : 0;
+  uint32_t pos = off;
+  uint32_t end = off + len;
+  while (pos < end) {
+    uint32_t block = pos / SIM_FS_BLOCK;
+    if (block != f.lfs_block) {
+      lfs_find_block(m, head, block);
+      f.lfs_block = block;
+      f.lfs_cache_len = 0;
+    }
+    uint32_t block_end = (block + 1) * SIM_FS_BLOCK;
+    uint32_t stop = std::min(end, block_end);
+    if (f.lfs_cache_len && pos >= f.lfs_cache_start && pos < f.lfs_cache_start + f.lfs_cache_len) {
+      pos = std::min(stop, f.lfs_cache_start + f.lfs_cache_len);
+      continue;
+    }
+    if (pos % SIM_FS_BLOCK == 0 && stop - pos == SIM_FS_BLOCK) {
+      sim_flash_count_read(SIM_FS_BLOCK);
+      pos = stop;
+      continue;
+    }
+    uint32_t start = pos - pos % m.lfs.read_size;
+    uint32_t n = std::min(m.lfs.cache_size, block_end - start);
+    sim_flash_count_read(n);
+    f.lfs_cache_start = start;
+    f.lfs_cache_len = n;
+  }
+}
+
+static void lfs_write(FileImpl& f, uint32_t len)
+{
+  FlashModel& m = *f.model;
+  uint32_t blocks_before = (f.lfs_written + SIM_FS_BLOCK - 1) / SIM_FS_BLOCK;
+  f.lfs_written += len;
+  for (uint32_t b = blocks_before; b < (f.lfs_written + SIM_FS_BLOCK - 1) / SIM_FS_BLOCK; ++b) {
+    sim_flash_count_erase(SIM_FS_BLOCK);
+    if (++m.allocated >= m.lfs.lookahead_size * 8u) {
+      sim_flash_count_read(m.lfs.cache_size);   // Lookahead refill: walk the metadata
+      m.allocated = 0;
+    }
+  }
+  f.lfs_pending += len;
+  while (f.lfs_pending >= m.lfs.cache_size) {
+    sim_flash_count_write(m.lfs.cache_size);
+    f.lfs_pending -= m.lfs.cache_size;
+  }
+}
+
+static uint32_t host_entries(const std::string& host_dir)
+{
+  uint32_t n = 0;
+  DIR* dir = opendir(host_dir.c_str());
+  if (!dir) return 0;
+  while (struct dirent* ent = readdir(dir)) {
+    if (strcmp(ent->d_name, ".") != 0 && strcmp(ent->d_name, "..") != 0) n++;
+  }
+  closedir(dir);
+  return n;
+}
+
+// Metadata pair: both revision counts, then the log in cache_size chunks
+static void lfs_fetch_dir(FlashModel& m, const std::string& host_dir)
+{
+  uint32_t used = 64 + 40 * host_entries(host_dir);
+  sim_flash_count_read(m.lfs.read_size);
+  sim_flash_count_read(m.lfs.read_size);
+  for (uint32_t off = 0; off < used; off += m.lfs.cache_size) sim_flash_count_read(m.lfs.cache_size);
+}
+
+// Path resolution (and directory listing): every directory from the root down
+static void lfs_walk(FlashModel& m, const std::string& root, const std::string& vpath, bool is_dir)
+{
+  lfs_fetch_dir(m, root);
+  for (size_t slash = vpath.find('/', 1); slash != std::string::npos; slash = vpath.find('/', slash + 1)) {
+    lfs_fetch_dir(m, root + vpath.substr(0, slash));
+  }
+  if (is_dir && vpath.size() > 1) lfs_fetch_dir(m, root + vpath);
+}
+
+static uint32_t object_id(const std::string& vpath)
+{
+  uint32_t id = static_cast<uint32_t>(std::hash<std::string>()(vpath));
+  return id ? id : 1;
+}
+
+// Finding `vpath` by name (open, exists, remove...)
+static void model_lookup(FlashModel& m, const std::string& root, const std::string& vpath, bool is_dir)
+{
+  if (m.kind == FS::Kind::LittleFs) {
+    lfs_walk(m, root, vpath, is_dir);
+  } else {
+    spiffs_scan(m, m.blocks);
+  }
+}
+
+FileImpl::~FileImpl()
+{
+  if (fp) fclose(fp);
+  if (model && model->kind == FS::Kind::LittleFs && lfs_written) {
+    std::lock_guard<std::mutex> lock(model->mutex);
+    uint32_t prog = model->lfs.prog_size;
+    if (lfs_pending) sim_flash_count_write((lfs_pending + prog - 1) / prog * prog);
+    sim_flash_count_write(prog);   // Metadata commit
+  }
+}
+
+/* ---------- File ---------- */
+
+static std::shared_ptr<FileImpl> open_impl(const std::string& vpath, const std::string& host, const char* mode)
+{
+  auto impl = std::make_shared<FileImpl>();
+  impl->vpath = vpath;
+  impl->host = host;
+  size_t slash = vpath.find_last_of('/');
+  impl->base_name = slash == std::string::npos ? vpath : vpath.substr(slash + 1);
+
+  struct stat st;
+  if (stat(host.c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+    DIR* dir = opendir(host.c_str());
+    if (!dir) return nullptr;
+    while (struct dirent* ent = readdir(dir)) {
+      if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) continue;
+      impl->entries.push_back(ent->d_name);
+    }
+    closedir(dir);
+    std::sort(impl->entries.begin(), impl->entries.end());
+    impl->is_dir = true;
+    return impl;
+  }
+
+  std::string host_mode = mode ? mode : "r";
+  if (host_mode.find('b') == std::string::npos) host_mode += 'b';
+  impl->fp = fopen(host.c_str(), host_mode.c_str());
+  return impl->fp ? impl : nullptr;
+}
+
+File::operator bool() const
+{
+  return m_impl && (m_impl->fp || m_impl->is_dir);
+}
+
+size_t File::read(uint8_t* buf, size_t size)
+{
+  if (!m_impl || !m_impl->fp) return 0;
+  long pos = ftell(m_impl->fp);
+  size_t n = fread(buf, 1, size, m_impl->fp);
+  if (m_impl->model && n && pos >= 0) {
+    std::lock_guard<std::mutex> lock(m_impl->model->mutex);
+    if (m_impl->model->kind == FS::Kind::LittleFs) {
+      struct stat st;
+      uint32_t file_size = fstat(fileno(m_impl->fp), &st) == 0 ? static_cast<uint32_t>(st.st_size) : 0;
+      lfs_read(*m_impl, static_cast<uint32_t>(pos), static_cast<uint32_t>(n), file_size);
+    } else {
+      spiffs_read(*m_impl, static_cast<uint32_t>(pos), static_cast<uint32_t>(n));
+    }
+  }
+  return n;
+}
+
+int File::read(void)
+{
+  uint8_t c;
+  return read(&c, 1) == 1 ? c : -1;
+}
+
+size_t File::write(const uint8_t* buf, size_t size)
+{
+  if (!m_impl || !m_impl->fp) return 0;
+  long pos = ftell(m_impl->fp);
+  size_t n = fwrite(buf, 1, size, m_impl->fp);
+  if (m_impl->model && n && pos >= 0) {
+    std::lock_guard<std::mutex> lock(m_impl->model->mutex);
+    if (m_impl->model->kind == FS::Kind::LittleFs) {
+      lfs_write(*m_impl, static_cast<uint32_t>(n));
+    } else {
+      spiffs_write(*m_impl, static_cast<uint32_t>(pos), static_cast<uint32_t>(n));
+    }
+  }
+  return n;
+}
+
+bool File::seek(uint32_t pos, SeekMode mode)
+{
+  if (!m_impl || !m_impl->fp) return false;
+  int whence = mode == SeekCur ? SEEK_CUR : (mode == SeekEnd ? SEEK_END : SEEK_SET);
+  return fseek(m_impl->fp, static_cast<long>(pos), whence) == 0;
+}
+
+size_t File::position(void) const
+{
+  if (!m_impl || !m_impl->fp) return 0;
+  long pos = ftell(m_impl->fp);
+  return pos < 0 ? 0 : static_cast<size_t>(pos);
+}
+
+size_t File::size(void) const
+{
+  if (!m_impl || !m_impl->fp) return 0;
+  fflush(m_impl->fp);
+  struct stat st;
+  return fstat(fileno(m_impl->fp), &st) == 0 ? static_cast<size_t>(st.st_size) : 0;
+}
+
+int File::available(void) const
+{
+  size_t total = size();
+  size_t pos = position();
+  return pos < total ? static_cast<int>(total - pos) : 0;
+}
+
+void File::flush(void)
+{
+  if (m_impl && m_impl->fp) fflush(m_impl->fp);
+}
+
+void File::close(void)
+{
+  m_impl.reset();
+}
+
+const char* File::name(void) const
+{
+  return m_impl ? m_impl->base_name.c_str() : nullptr;
+}
+
+const char* File::path(void) const
+{
+  return m_impl ? m_impl->vpath.c_str() : nullptr;
+}
+
+bool File::isDirectory(void) const
+{
+  return m_impl && m_impl->is_dir;
+}
+
+File File::openNextFile(const char* mode)
+{
+  if (!m_impl || !m_impl->is_dir) return File();
+  while (m_impl->next_entry < m_impl->entries.size()) {
+    const std::string& entry = m_impl->entries[m_impl->next_entry++];
+    std::string vpath = m_impl->vpath == "/" ? "/" + entry : m_impl->vpath + "/" + entry;
+    auto child = open_impl(vpath, m_impl->host + "/" + entry, mode);
+    if (child) {
+      child->model = m_impl->model;
+      child->id = object_id(vpath);
+      if (child->model && child->model->kind == FS::Kind::Spiffs) {
+        // A listing reads each object's index header (name, size)
+        std::lock_guard<std::mutex> lock(child->model->mutex);
+        spiffs_page(*child->model, page_key(child->id, SIM_PAGE_INDEX, 0));
+      }
+      return File(child);
+    }
+  }
+  return File();
+}
+
+/* ---------- FS ---------- */
+
+std::string FS::host_path(const char* path) const
+{
+  std::string p = path ? path : "/";
+  if (p.empty() || p[0] != '/') p = "/" + p;
+  return m_root + p;
+}
+
+bool FS::mount(bool format_on_fail)
+{
+  struct stat st;
+  if (stat(m_root.c_str(), &st) != 0 || !S_ISDIR(st.st_mode)) {
+    if (!format_on_fail || ::mkdir(m_root.c_str(), 0755) != 0) return false;
+  }
+  if (!m_model) {
+    m_model = std::make_shared<FlashModel>();
+    m_model->kind = m_kind;
+    m_model->blocks = SIM_SPIFFS_TOTAL_BYTES / SIM_FS_BLOCK;
+  }
+  m_model->lfs = s_lfs_geometry;
+  m_mounted = true;
+  return true;
+}
+
+size_t FS::used_bytes(void)
+{
+  size_t used = 0;
+  File root = open("/");
+  for (File f = root.openNextFile(); f; f = root.openNextFile()) {
+    used += f.size();
+  }
+  return used;
+}
+
+File FS::open(const char* path, const char* mode, bool create)
+{
+  (void)create;
+  if (!m_mounted) return File();
+  std::string vpath = path ? path : "/";
+  if (vpath.empty() || vpath[0] != '/') vpath = "/" + vpath;
+  auto impl = open_impl(vpath, host_path(vpath.c_str()), mode);
+  if (!impl) return File();
+
+  std::lock_guard<std::mutex> lock(m_model->mutex);
+  model_lookup(*m_model, m_root, vpath, impl->is_dir);
+  impl->model = m_model;
+  impl->id = object_id(vpath);
+  if (!impl->is_dir && m_kind == Kind::Spiffs) {
+    spiffs_page(*m_model, page_key(impl->id, SIM_PAGE_INDEX, 0));
+    impl->spiffs_ix = 0;
+  }
+  return File(impl);
+}
+
+bool FS::exists(const char* path)
+{
+  struct stat st;
+  if (!m_mounted) return false;
+  std::lock_guard<std::mutex> lock(m_model->mutex);
+  model_lookup(*m_model, m_root, path ? path : "/", false);
+  return stat(host_path(path).c_str(), &st) == 0;
+}
+
+bool FS::remove(const char* path)
+{
+  if (!m_mounted) return false;
+  std::lock_guard<std::mutex> lock(m_model->mutex);
+  model_lookup(*m_model, m_root, path ? path : "/", false);
+  return ::remove(host_path(path).c_str()) == 0;
+}
+
+bool FS::rename(const char* from, const char* to)
+{
+  if (!m_mounted) return false;
+  std::lock_guard<std::mutex> lock(m_model->mutex);
+  model_lookup(*m_model, m_root, from ? from : "/", false);
+  return ::rename(host_path(from).c_str(), host_path(to).c_str()) == 0;
+}
+
+bool FS::mkdir(const char* path)
+{
+  return m_mounted && ::mkdir(host_path(path).c_str(), 0755) == 0;
+}
+
+bool SPIFFSFS::begin(bool format_on_fail, const char* base_path, uint8_t max_open_files, const char* label)
+{
+  (void)base_path;
+  (void)max_open_files;
+  (void)label;
+  return mount(format_on_fail);
+}
+
+bool SPIFFSFS::format(void)
+{
+  // Never wipe a host directory: report failure like a read-only partition.
+  return false;
+}
+
+size_t SPIFFSFS::totalBytes(void)
+{
+  return SIM_SPIFFS_TOTAL_BYTES;
+}
+
+size_t SPIFFSFS::usedBytes(void)
+{
+  return used_bytes();
+}
+
+bool LittleFSFS::begin(bool format_on_fail, const char* base_path, uint8_t max_open_files,
+                       const char* partition_label)
+{
+  (void)base_path;
+  (void)max_open_files;
+  (void)partition_label;
+  return mount(format_on_fail);
+}
+
+bool LittleFSFS::format(void)
+{
+  return false;
+}
+
+size_t LittleFSFS::totalBytes(void)
+{
+  return SIM_SPIFFS_TOTAL_BYTES;
+}
+
+size_t LittleFSFS::usedBytes(void)
+{
+  return used_bytes();
+}
+
+}  // namespace fs
+
+void sim_fs_set_root(const char* host_dir)
+{
+  SPIFFS.setRoot(host_dir);
+  LittleFS.setRoot(host_dir);
+}
+
+void sim_fs_set_littlefs_geometry(const sim_littlefs_geometry_t* geometry)
+{
+  if (geometry && geometry->read_size && geometry->cache_size >= geometry->read_size && geometry->prog_size &&
+      geometry->lookahead_size) {
+    s_lfs_geometry = *geometry;
+  }
+}
+
+bool sim_fs_host_path(const char* path, char* out, size_t out_len)
+{
+  std::string host = SPIFFS.hostPath(path);
+  if (host.empty()) host = LittleFS.hostPath(path);
+  if (host.empty() || host.size() >= out_len) return false;
+  memcpy(out, host.c_str(), host.size() + 1);
+  return true;
+}
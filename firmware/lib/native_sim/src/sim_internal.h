@@ -0,0 +1,21 @@
+/*
+ * NATIVE SIM - Glue between the shim sources (not part of the public API)
+ */
+
+#ifndef NATIVE_SIM_INTERNAL_H
+#define NATIVE_SIM_INTERNAL_H
+
+#include <stdint.h>
+
+/* Take the current host allocation level as "nothing allocated yet" */
+void sim_heap_mark_baseline(void);
+
+/* One SPI flash transaction, into the spi_flash counters (sim_flash.cpp) */
+void sim_flash_count_read(uint32_t bytes);
+void sim_flash_count_write(uint32_t bytes);
+void sim_flash_count_erase(uint32_t bytes);
+
+/* Light sleep entries and time, for the exit report (sim_arduino.cpp) */
+void sim_sleep_print_report(void);
+
+#endif // NATIVE_SIM_INTERNAL_H
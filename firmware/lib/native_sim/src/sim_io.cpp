@@ -0,0 +1,189 @@
+/*
+ * NATIVE SIM - Framebuffer display, scripted touch and the script runner
+ */
+
+#include "Arduino.h"
+#include "native_sim.h"
+#include "sim_kernel.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#define SIM_SCRIPT_DEFAULT_HOLD_MS 80
+
+/* ---------- Display ---------- */
+
+static std::vector<uint16_t> s_fb;
+static uint16_t s_fb_width = 0;
+static uint16_t s_fb_height = 0;
+static bool s_backlight = true;
+static sim_display_stats_t s_display_stats = {0, 0};
+
+void sim_display_init(uint16_t width, uint16_t height)
+{
+  s_fb_width = width;
+  s_fb_height = height;
+  s_fb.assign(static_cast<size_t>(width) * height, 0);
+}
+
+void sim_display_set_rotation(uint8_t rotation)
+{
+  // The framebuffer is allocated in the orientation LVGL draws in.
+  (void)rotation;
+}
+
+void sim_display_set_backlight(bool on)
+{
+  s_backlight = on;
+}
+
+void sim_display_push(int32_t x, int32_t y, uint32_t w, uint32_t h, const uint16_t* pixels)
+{
+  if (!pixels) return;
+  ++s_display_stats.flushes;
+  s_display_stats.pixels += static_cast<uint64_t>(w) * h;
+
+  for (uint32_t row = 0; row < h; ++row) {
+    int32_t dy = y + static_cast<int32_t>(row);
+    if (dy < 0 || dy >= s_fb_height) continue;
+    for (uint32_t col = 0; col < w; ++col) {
+      int32_t dx = x + static_cast<int32_t>(col);
+      if (dx < 0 || dx >= s_fb_width) continue;
+      s_fb[static_cast<size_t>(dy) * s_fb_width + dx] = pixels[row * w + col];
+    }
+  }
+}
+
+bool sim_display_dump_ppm(const char* path)
+{
+  if (!path || s_fb.empty()) return false;
+  FILE* f = fopen(path, "wb");
+  if (!f) return false;
+
+  fprintf(f, "P6\n%u %u\n255\n", s_fb_width, s_fb_height);
+  std::vector<uint8_t> row(static_cast<size_t>(s_fb_width) * 3);
+  for (uint16_t y = 0; y < s_fb_height; ++y) {
+    for (uint16_t x = 0; x < s_fb_width; ++x) {
+      uint16_t c = s_backlight ? s_fb[static_cast<size_t>(y) * s_fb_width + x] : 0;
+      uint8_t r = static_cast<uint8_t>((c >> 11) & 0x1F);
+      uint8_t g = static_cast<uint8_t>((c >> 5) & 0x3F);
+      uint8_t b = static_cast<uint8_t>(c & 0x1F);
+      row[x * 3 + 0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+      row[x * 3 + 1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+      row[x * 3 + 2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+    }
+    fwrite(row.data(), 1, row.size(), f);
+  }
+  return fclose(f) == 0;
+}
+
+void sim_display_get_stats(sim_display_stats_t* out)
+{
+  if (out) *out = s_display_stats;
+}
+
+/* ---------- Touch ---------- */
+
+static uint16_t s_touch_x = 0;
+static uint16_t s_touch_y = 0;
+static bool s_touch_pressed = false;
+
+bool sim_touch_read(uint16_t* x, uint16_t* y)
+{
+  if (x) *x = s_touch_x;
+  if (y) *y = s_touch_y;
+  return s_touch_pressed;
+}
+
+static void touch_set(bool pressed, uint16_t x, uint16_t y)
+{
+  s_touch_x = x;
+  s_touch_y = y;
+  s_touch_pressed = pressed;
+}
+
+/* ---------- Script ---------- */
+
+static FILE* s_script = NULL;
+static std::string s_script_path;
+
+static void script_wait_until(uint64_t target_ms)
+{
+  uint64_t now_ms = millis();
+  if (target_ms > now_ms) vTaskDelay(pdMS_TO_TICKS(target_ms - now_ms));
+}
+
+static void script_task(void* arg)
+{
+  (void)arg;
+  char line[256];
+  unsigned line_no = 0;
+  uint64_t last_ms = 0;
+
+  while (fgets(line, sizeof(line), s_script)) {
+    ++line_no;
+    char* p = line;
+    while (isspace(static_cast<unsigned char>(*p))) ++p;
+    if (*p == '\0' || *p == '#') continue;
+    line[strcspn(line, "\r\n")] = '\0';
+
+    bool relative = (*p == '+');
+    if (relative) ++p;
+    char* end = NULL;
+    unsigned long long at = strtoull(p, &end, 10);
+    if (end == p) {
+      fprintf(stderr, "[SIM] %s:%u: missing time\n", s_script_path.c_str(), line_no);
+      continue;
+    }
+    last_ms = relative ? last_ms + at : at;
+    script_wait_until(last_ms);
+
+    char cmd[16] = {0};
+    int consumed = 0;
+    if (sscanf(end, " %15s %n", cmd, &consumed) < 1) continue;
+    const char* args = end + consumed;
+    unsigned x = 0, y = 0, hold = SIM_SCRIPT_DEFAULT_HOLD_MS;
+
+    if (strcmp(cmd, "tap") == 0 && sscanf(args, "%u %u %u", &x, &y, &hold) >= 2) {
+      touch_set(true, static_cast<uint16_t>(x), static_cast<uint16_t>(y));
+      vTaskDelay(pdMS_TO_TICKS(hold));
+      touch_set(false, static_cast<uint16_t>(x), static_cast<uint16_t>(y));
+    } else if (strcmp(cmd, "press") == 0 && sscanf(args, "%u %u", &x, &y) == 2) {
+      touch_set(true, static_cast<uint16_t>(x), static_cast<uint16_t>(y));
+    } else if (strcmp(cmd, "release") == 0) {
+      touch_set(false, s_touch_x, s_touch_y);
+    } else if (strcmp(cmd, "shot") == 0 && *args) {
+      if (!sim_display_dump_ppm(args)) {
+        fprintf(stderr, "[SIM] %s:%u: cannot write %s\n", s_script_path.c_str(), line_no, args);
+      }
+    } else if (strcmp(cmd, "serial") == 0) {
+      sim_serial_inject(args, strlen(args));
+      sim_serial_inject("\n", 1);
+    } else if (strcmp(cmd, "quit") == 0) {
+      fclose(s_script);
+      s_script = NULL;
+      sim_kernel_stop(SIM_KERNEL_EXIT_OK);
+    } else {
+      fprintf(stderr, "[SIM] %s:%u: cannot parse '%s'\n", s_script_path.c_str(), line_no, p);
+    }
+  }
+
+  fclose(s_script);
+  s_script = NULL;
+  vTaskDelete(NULL);
+}
+
+bool sim_script_start(const char* path)
+{
+  s_script = fopen(path, "r");
+  if (!s_script) {
+    fprintf(stderr, "[SIM] Cannot open script %s\n", path);
+    return false;
+  }
+  s_script_path = path;
+  // Above the UI task so input lands on time, like the touch controller would.
+  return xTaskCreatePinnedToCore(script_task, "sim_script", 4096, NULL, 5, NULL, 1) == pdPASS;
+}
@@ -0,0 +1,1291 @@
+/*
+ * NATIVE SIM - Deterministic FreeRTOS kernel
+ *
+ * Every task is a host thread, but a single baton (g_current) decides which
+ * one may run: the others wait on their condition variable. A task keeps the
+ * CPU until it blocks, yields, or wakes a higher-priority task (the same
+ * preemption points FreeRTOS has outside of tick interrupts). When no task
+ * is ready, virtual time jumps straight to the earliest timeout, so idle
+ * periods cost nothing and runs are reproducible for a given input.
+ *
+ * Both ESP32 cores are folded onto one simulated CPU: core ids are kept for
+ * xPortGetCoreID() and the report, not for parallelism.
+ */
+
+#include "sim_kernel.h"
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/timers.h"
+#include "freertos/event_groups.h"
+#include "freertos/ringbuf.h"
+
+#include <pthread.h>
+#include <time.h>
+#include <string.h>
+#include <stdio.h>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <new>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define SIM_HOST_STACK_BYTES (1024u * 1024u)   // Host frames are far larger than Xtensa ones
+
+namespace {
+
+enum class State { Ready, Running, Blocked, Suspended, Deleted };
+
+struct Task {
+  char name[configMAX_TASK_NAME_LEN];
+  TaskFunction_t fn;
+  void* arg;
+  UBaseType_t priority;
+  BaseType_t core;
+  uint32_t stack_depth;
+  State state;
+  uint64_t seq;               // FIFO order among equal priorities
+  uint64_t wake_at_us;        // UINT64_MAX: no timeout
+  const void* wait_obj;
+  bool timed_out;
+  bool killed;
+  uint32_t notify_value;
+  bool notify_pending;
+  uint64_t dispatches;
+  uint64_t cpu_ns;
+  uint64_t cpu_mark_ns;
+  bool is_static;             // Lives in a StaticTask_t: destroyed, not freed
+  std::condition_variable cv;
+};
+
+struct RetiredStats {
+  uint64_t dispatches;
+  uint64_t cpu_ns;
+  uint32_t instances;
+  UBaseType_t priority;
+  BaseType_t core;
+};
+
+struct Queue {
+  uint32_t item_size;
+  uint32_t length;
+  uint32_t head;
+  uint32_t count;
+  uint8_t* storage;           // heap_storage, or the caller's buffer
+  std::vector<uint8_t> heap_storage;
+  bool is_static;
+  char rx_token;
+  char tx_token;
+};
+
+struct Semaphore {
+  UBaseType_t count;
+  UBaseType_t max_count;
+  bool is_mutex;
+  bool recursive;
+  Task* holder;
+  UBaseType_t depth;
+  bool is_static;
+  char token;
+};
+
+struct EventGroup {
+  EventBits_t bits;
+  bool is_static;
+  char token;
+};
+
+struct Timer {
+  char name[configMAX_TASK_NAME_LEN];
+  TickType_t period;
+  bool auto_reload;
+  void* id;
+  TimerCallbackFunction_t callback;
+  bool active;
+  uint64_t expiry_us;
+  uint64_t seq;
+  bool is_static;
+};
+
+struct Ring {
+  uint8_t* buf;               // heap_buf, or the caller's buffer
+  size_t size;
+  std::vector<uint8_t> heap_buf;
+  bool is_static;
+  size_t read;
+  size_t count;
+  size_t lent;     // Bytes handed out and not yet returned
+  char rx_token;
+  char tx_token;
+};
+
+static_assert(sizeof(Task) <= sizeof(StaticTask_t), "StaticTask_t too small");
+static_assert(sizeof(Queue) <= sizeof(StaticQueue_t), "StaticQueue_t too small");
+static_assert(sizeof(Semaphore) <= sizeof(StaticSemaphore_t), "StaticSemaphore_t too small");
+static_assert(sizeof(EventGroup) <= sizeof(StaticEventGroup_t), "StaticEventGroup_t too small");
+static_assert(sizeof(Timer) <= sizeof(StaticTimer_t), "StaticTimer_t too small");
+static_assert(sizeof(Ring) <= sizeof(StaticRingbuffer_t), "StaticRingbuffer_t too small");
+
+// Objects created from a Static*_t buffer are built in place and never freed.
+template <typename T>
+T* construct(void* static_buffer)
+{
+  if (!static_buffer) return new T();
+  T* obj = new (static_buffer) T();
+  obj->is_static = true;
+  return obj;
+}
+
+template <typename T>
+void destroy(T* obj)
+{
+  if (!obj) return;
+  if (obj->is_static) {
+    obj->~T();
+  } else {
+    delete obj;
+  }
+}
+
+using Lock = std::unique_lock<std::mutex>;
+
+std::mutex g_mtx;
+std::condition_variable g_main_cv;
+std::vector<Task*> g_tasks;
+std::map<std::string, RetiredStats> g_retired;
+std::vector<Timer*> g_timers;
+Task* g_current = nullptr;
+Task* g_timer_task = nullptr;
+uint64_t g_now_us = 0;
+uint64_t g_end_us = UINT64_MAX;
+uint64_t g_seq = 0;
+bool g_stopped = false;
+int g_exit_code = SIM_KERNEL_EXIT_OK;
+double g_speed = 0.0;
+uint64_t g_run_start_us = 0;
+std::chrono::steady_clock::time_point g_real_start;
+double g_real_elapsed_s = 0.0;
+char g_delay_token;
+char g_timer_token;
+
+thread_local Task* t_self = nullptr;
+
+uint64_t thread_cpu_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+uint64_t deadline_for(TickType_t ticks)
+{
+  if (ticks == portMAX_DELAY) return UINT64_MAX;
+  return (g_now_us / 1000u + ticks) * 1000u;
+}
+
+bool can_block(TickType_t ticks)
+{
+  return t_self != nullptr && ticks != 0;
+}
+
+void make_ready(Task* t)
+{
+  t->state = State::Ready;
+  t->wait_obj = nullptr;
+  t->wake_at_us = UINT64_MAX;
+  t->seq = ++g_seq;
+}
+
+[[noreturn]] void park(Lock& lk)
+{
+  lk.unlock();
+  for (;;) {
+    std::this_thread::sleep_for(std::chrono::hours(1));
+  }
+}
+
+void pace_to(uint64_t virtual_us)
+{
+  if (g_speed <= 0.0) return;
+  auto offset = std::chrono::microseconds(static_cast<int64_t>((virtual_us - g_run_start_us) / g_speed));
+  std::this_thread::sleep_until(g_real_start + offset);
+}
+
+void report_deadlock(void)
+{
+  fprintf(stderr, "[SIM] Deadlock at %.3f s: every task is blocked without timeout\n", g_now_us / 1e6);
+  for (Task* t : g_tasks) {
+    if (t->state == State::Blocked || t->state == State::Suspended) {
+      fprintf(stderr, "[SIM]   %-16s prio %u %s\n", t->name, t->priority,
+              t->state == State::Suspended ? "suspended" : "blocked");
+    }
+  }
+}
+
+// Highest-priority ready task; advances virtual time while nothing is ready.
+Task* pick_next(void)
+{
+  for (;;) {
+    if (g_stopped) return nullptr;
+
+    Task* best = nullptr;
+    for (Task* t : g_tasks) {
+      if (t->state != State::Ready) continue;
+      if (!best || t->priority > best->priority || (t->priority == best->priority && t->seq < best->seq)) {
+        best = t;
+      }
+    }
+    if (best) {
+      best->state = State::Running;
+      return best;
+    }
+
+    uint64_t next = UINT64_MAX;
+    for (Task* t : g_tasks) {
+      if (t->state == State::Blocked && t->wake_at_us < next) next = t->wake_at_us;
+    }
+    if (next == UINT64_MAX) {
+      report_deadlock();
+      g_exit_code = SIM_KERNEL_EXIT_DEADLOCK;
+      g_stopped = true;
+      return nullptr;
+    }
+    if (next > g_end_us) {
+      pace_to(g_end_us);
+      g_now_us = g_end_us;
+      g_stopped = true;
+      return nullptr;
+    }
+
+    pace_to(next);
+    if (next > g_now_us) g_now_us = next;
+    for (Task* t : g_tasks) {
+      if (t->state == State::Blocked && t->wake_at_us <= g_now_us) {
+        make_ready(t);
+        t->timed_out = true;
+      }
+    }
+  }
+}
+
+void retire(Task* t)
+{
+  RetiredStats& s = g_retired[t->name];
+  s.dispatches += t->dispatches;
+  s.cpu_ns += t->cpu_ns;
+  s.instances += 1;
+  s.priority = t->priority;
+  s.core = t->core;
+  g_tasks.erase(std::remove(g_tasks.begin(), g_tasks.end(), t), g_tasks.end());
+  destroy(t);
+}
+
+// Wait for the baton. Killed tasks and a stopped simulation never return.
+void wait_turn(Lock& lk, Task* self)
+{
+  self->cv.wait(lk, [self] { return g_current == self || self->killed || g_stopped; });
+  if (self->killed) {
+    retire(self);
+    t_self = nullptr;
+    lk.unlock();
+    pthread_exit(nullptr);
+  }
+  if (g_stopped) park(lk);
+  self->cpu_mark_ns = thread_cpu_ns();
+  ++self->dispatches;
+}
+
+// Hand the CPU to the next ready task and wait until the caller is picked again.
+void switch_away(Lock& lk)
+{
+  Task* self = t_self;
+  self->cpu_ns += thread_cpu_ns() - self->cpu_mark_ns;
+
+  Task* next = pick_next();
+  g_current = next;
+  if (!next) {
+    g_main_cv.notify_all();
+    park(lk);
+  }
+  if (next == self) {
+    self->cpu_mark_ns = thread_cpu_ns();
+    return;
+  }
+  next->cv.notify_one();
+  wait_turn(lk, self);
+}
+
+// Returns false when the wait ended on its timeout.
+bool block_until(Lock& lk, const void* obj, uint64_t wake_at_us)
+{
+  Task* self = t_self;
+  self->state = State::Blocked;
+  self->wait_obj = obj;
+  self->wake_at_us = wake_at_us;
+  self->timed_out = false;
+  self->seq = ++g_seq;
+  switch_away(lk);
+  return !self->timed_out;
+}
+
+Task* wake_one(const void* obj)
+{
+  Task* best = nullptr;
+  for (Task* t : g_tasks) {
+    if (t->state != State::Blocked || t->wait_obj != obj) continue;
+    if (!best || t->priority > best->priority || (t->priority == best->priority && t->seq < best->seq)) {
+      best = t;
+    }
+  }
+  if (best) make_ready(best);
+  return best;
+}
+
+void wake_all(const void* obj)
+{
+  for (Task* t : g_tasks) {
+    if (t->state == State::Blocked && t->wait_obj == obj) make_ready(t);
+  }
+}
+
+// Yield if something more important became ready (FreeRTOS preemption).
+void preempt_check(Lock& lk)
+{
+  if (!t_self || g_current != t_self) return;
+  for (Task* t : g_tasks) {
+    if (t->state == State::Ready && t->priority > t_self->priority) {
+      make_ready(t_self);
+      switch_away(lk);
+      return;
+    }
+  }
+}
+
+void* task_main(void* arg)
+{
+  Task* self = static_cast<Task*>(arg);
+  t_self = self;
+  {
+    Lock lk(g_mtx);
+    wait_turn(lk, self);
+  }
+  self->fn(self->arg);
+  // Returning from a task function is a bug on target; treat it as a self-delete.
+  vTaskDelete(nullptr);
+  return nullptr;
+}
+
+Task* create_task_locked(TaskFunction_t fn, const char* name, uint32_t stack_depth, void* arg,
+                         UBaseType_t priority, BaseType_t core, StaticTask_t* tcb = nullptr)
+{
+  Task* t = construct<Task>(tcb);
+  strncpy(t->name, name ? name : "", sizeof(t->name) - 1);
+  t->fn = fn;
+  t->arg = arg;
+  t->priority = priority < configMAX_PRIORITIES ? priority : configMAX_PRIORITIES - 1;
+  t->core = core;
+  t->stack_depth = stack_depth;
+  t->wake_at_us = UINT64_MAX;
+  make_ready(t);
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  pthread_attr_setstacksize(&attr, SIM_HOST_STACK_BYTES);
+  pthread_t thread;
+  int rc = pthread_create(&thread, &attr, task_main, t);
+  pthread_attr_destroy(&attr);
+  if (rc != 0) {
+    destroy(t);
+    return nullptr;
+  }
+  g_tasks.push_back(t);
+  return t;
+}
+
+void timer_task(void* arg)
+{
+  (void)arg;
+  Lock lk(g_mtx);
+  for (;;) {
+    Timer* due = nullptr;
+    for (Timer* tm : g_timers) {
+      if (!tm->active) continue;
+      if (!due || tm->expiry_us < due->expiry_us || (tm->expiry_us == due->expiry_us && tm->seq < due->seq)) {
+        due = tm;
+      }
+    }
+    if (!due || due->expiry_us > g_now_us) {
+      block_until(lk, &g_timer_token, due ? due->expiry_us : UINT64_MAX);
+      continue;
+    }
+
+    if (due->auto_reload) {
+      due->expiry_us += static_cast<uint64_t>(due->period) * 1000u;
+      if (due->expiry_us <= g_now_us) due->expiry_us = deadline_for(due->period);
+    } else {
+      due->active = false;
+    }
+    TimerCallbackFunction_t callback = due->callback;
+    lk.unlock();
+    callback(due);   // May delete or restart the timer
+    lk.lock();
+  }
+}
+
+void kick_timer_task(Lock& lk)
+{
+  if (g_timer_task && g_timer_task->state == State::Blocked && g_timer_task->wait_obj == &g_timer_token) {
+    make_ready(g_timer_task);
+    preempt_check(lk);
+  }
+}
+
+}  // namespace
+
+/* ---------- Kernel control ---------- */
+
+uint64_t sim_now_us(void)
+{
+  Lock lk(g_mtx);
+  return g_now_us;
+}
+
+void sim_kernel_init(double speed)
+{
+  Lock lk(g_mtx);
+  g_speed = speed;
+}
+
+int sim_kernel_run(uint64_t duration_us)
+{
+  Lock lk(g_mtx);
+  g_run_start_us = g_now_us;
+  g_end_us = duration_us ? g_now_us + duration_us : UINT64_MAX;
+  g_real_start = std::chrono::steady_clock::now();
+
+  Task* first = pick_next();
+  g_current = first;
+  if (first) first->cv.notify_one();
+  g_main_cv.wait(lk, [] { return g_stopped; });
+
+  g_real_elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - g_real_start).count();
+  return g_exit_code;
+}
+
+void sim_kernel_stop(int exit_code)
+{
+  Lock lk(g_mtx);
+  g_exit_code = exit_code;
+  g_stopped = true;
+  g_main_cv.notify_all();
+  if (t_self) park(lk);
+}
+
+void sim_kernel_print_report(void)
+{
+  Lock lk(g_mtx);
+  double virtual_s = (g_now_us - g_run_start_us) / 1e6;
+  fprintf(stderr, "[SIM] %.3f s virtual in %.3f s real (%.1fx)\n", virtual_s, g_real_elapsed_s,
+          g_real_elapsed_s > 0 ? virtual_s / g_real_elapsed_s : 0.0);
+
+  std::map<std::string, RetiredStats> rows = g_retired;
+  for (Task* t : g_tasks) {
+    RetiredStats& s = rows[t->name];
+    s.dispatches += t->dispatches;
+    s.cpu_ns += t->cpu_ns;
+    s.instances += 1;
+    s.priority = t->priority;
+    s.core = t->core;
+  }
+  uint64_t total_ns = 0;
+  for (const auto& row : rows) total_ns += row.second.cpu_ns;
+
+  fprintf(stderr, "[SIM] %-16s %4s %4s %5s %12s %10s %6s\n", "task", "prio", "core", "inst", "dispatches",
+          "cpu ms", "cpu %");
+  for (const auto& row : rows) {
+    const RetiredStats& s = row.second;
+    char core[12];
+    if (s.core == tskNO_AFFINITY) {
+      snprintf(core, sizeof(core), "any");
+    } else {
+      snprintf(core, sizeof(core), "%d", s.core);
+    }
+    fprintf(stderr, "[SIM] %-16s %4u %4s %5u %12llu %10.1f %5.1f%%\n", row.first.c_str(), s.priority, core,
+            s.instances, static_cast<unsigned long long>(s.dispatches), s.cpu_ns / 1e6,
+            total_ns ? 100.0 * s.cpu_ns / total_ns : 0.0);
+  }
+}
+
+/* ---------- Tasks ---------- */
+
+BaseType_t xPortGetCoreID(void)
+{
+  Task* self = t_self;
+  return (self && self->core != tskNO_AFFINITY) ? self->core : 0;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_depth,
+                                   void* arg, UBaseType_t priority, TaskHandle_t* out_handle,
+                                   BaseType_t core_id)
+{
+  Lock lk(g_mtx);
+  Task* t = create_task_locked(fn, name, stack_depth, arg, priority, core_id);
+  if (out_handle) *out_handle = t;
+  if (!t) return pdFAIL;
+  preempt_check(lk);
+  return pdPASS;
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack_depth,
+                                           void* arg, UBaseType_t priority, StackType_t* stack_buffer,
+                                           StaticTask_t* task_buffer, BaseType_t core_id)
+{
+  if (!stack_buffer || !task_buffer) return nullptr;
+  Lock lk(g_mtx);
+  Task* t = create_task_locked(fn, name, stack_depth, arg, priority, core_id, task_buffer);
+  if (t) preempt_check(lk);
+  return t;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+  Lock lk(g_mtx);
+  Task* t = task ? static_cast<Task*>(task) : t_self;
+  if (!t || t->state == State::Deleted) return;
+
+  if (t != t_self) {
+    t->state = State::Deleted;
+    t->killed = true;     // The thread retires itself once it wakes up
+    t->cv.notify_one();
+    return;
+  }
+
+  t->cpu_ns += thread_cpu_ns() - t->cpu_mark_ns;
+  t->state = State::Deleted;
+  Task* next = pick_next();
+  g_current = next;
+  retire(t);
+  t_self = nullptr;
+  if (next) {
+    next->cv.notify_one();
+  } else {
+    g_main_cv.notify_all();
+  }
+  lk.unlock();
+  pthread_exit(nullptr);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+  Lock lk(g_mtx);
+  if (!t_self) return;
+  if (ticks == 0) {
+    make_ready(t_self);
+    switch_away(lk);
+    return;
+  }
+  block_until(lk, &g_delay_token, deadline_for(ticks));
+}
+
+BaseType_t xTaskDelayUntil(TickType_t* previous_wake, TickType_t increment)
+{
+  Lock lk(g_mtx);
+  if (!t_self || !previous_wake) return pdFALSE;
+  TickType_t target = *previous_wake + increment;
+  *previous_wake = target;
+  TickType_t now = static_cast<TickType_t>(g_now_us / 1000u);
+  if (static_cast<int32_t>(target - now) <= 0) return pdFALSE;
+  block_until(lk, &g_delay_token, static_cast<uint64_t>(g_now_us / 1000u + (target - now)) * 1000u);
+  return pdTRUE;
+}
+
+void taskYIELD(void)
+{
+  vTaskDelay(0);
+}
+
+void vTaskSuspend(TaskHandle_t task)
+{
+  Lock lk(g_mtx);
+  Task* t = task ? static_cast<Task*>(task) : t_self;
+  if (!t || t->state == State::Deleted) return;
+  t->state = State::Suspended;
+  t->wait_obj = nullptr;
+  t->wake_at_us = UINT64_MAX;
+  t->timed_out = true;
+  if (t == t_self) switch_away(lk);
+}
+
+void vTaskResume(TaskHandle_t task)
+{
+  Lock lk(g_mtx);
+  Task* t = static_cast<Task*>(task);
+  if (!t || t->state != State::Suspended) return;
+  make_ready(t);
+  preempt_check(lk);
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+  Lock lk(g_mtx);
+  return static_cast<TickType_t>(g_now_us / 1000u);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+  return t_self;
+}
+
+char* pcTaskGetName(TaskHandle_t task)
+{
+  Task* t = task ? static_cast<Task*>(task) : t_self;
+  return t ? t->name : nullptr;
+}
+
+UBaseType_t uxTaskPriorityGet(TaskHandle_t task)
+{
+  Lock lk(g_mtx);
+  Task* t = task ? static_cast<Task*>(task) : t_self;
+  return t ? t->priority : 0;
+}
+
+void vTaskPrioritySet(TaskHandle_t task, UBaseType_t priority)
+{
+  Lock lk(g_mtx);
+  Task* t = task ? static_cast<Task*>(task) : t_self;
+  if (!t) return;
+  t->priority = priority < configMAX_PRIORITIES ? priority : configMAX_PRIORITIES - 1;
+  preempt_check(lk);
+}
+
+eTaskState eTaskGetState(TaskHandle_t task)
+{
+  Lock lk(g_mtx);
+  Task* t = static_cast<Task*>(task);
+  if (!t) return eInvalid;
+  switch (t->state) {
+    case State::Running:   return eRunning;
+    case State::Ready:     return eReady;
+    case State::Blocked:   return eBlocked;
+    case State::Suspended: return eSuspended;
+    case State::Deleted:   return eDeleted;
+  }
+  return eInvalid;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks(void)
+{
+  Lock lk(g_mtx);
+  return static_cast<UBaseType_t>(g_tasks.size());
+}
+
+BaseType_t xTaskGetAffinity(TaskHandle_t task)
+{
+  Task* t = task ? static_cast<Task*>(task) : t_self;
+  return t ? t->core : tskNO_AFFINITY;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task)
+{
+  Task* t = task ? static_cast<Task*>(task) : t_self;
+  return t ? t->stack_depth : 0;
+}
+
+/* ---------- Task notifications ---------- */
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action)
+{
+  Lock lk(g_mtx);
+  Task* t = static_cast<Task*>(task);
+  if (!t || t->state == State::Deleted) return pdFAIL;
+
+  switch (action) {
+    case eSetBits:
+      t->notify_value |= value;
+      break;
+    case eIncrement:
+      ++t->notify_value;
+      break;
+    case eSetValueWithOverwrite:
+      t->notify_value = value;
+      break;
+    case eSetValueWithoutOverwrite:
+      if (t->notify_pending) return pdFAIL;
+      t->notify_value = value;
+      break;
+    case eNoAction:
+    default:
+      break;
+  }
+  t->notify_pending = true;
+  if (t->state == State::Blocked && t->wait_obj == &t->notify_value) make_ready(t);
+  preempt_check(lk);
+  return pdPASS;
+}
+
+BaseType_t xTaskNotifyWait(uint32_t clear_on_entry, uint32_t clear_on_exit,
+                           uint32_t* out_value, TickType_t ticks_to_wait)
+{
+  Lock lk(g_mtx);
+  Task* self = t_self;
+  if (!self) return pdFALSE;
+
+  if (!self->notify_pending) {
+    self->notify_value &= ~clear_on_entry;
+    if (can_block(ticks_to_wait)) {
+      block_until(lk, &self->notify_value, deadline_for(ticks_to_wait));
+    }
+  }
+  if (out_value) *out_value = self->notify_value;
+  if (!self->notify_pending) return pdFALSE;
+  self->notify_value &= ~clear_on_exit;
+  self->notify_pending = false;
+  return pdTRUE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear_on_exit, TickType_t ticks_to_wait)
+{
+  Lock lk(g_mtx);
+  Task* self = t_self;
+  if (!self) return 0;
+
+  if (self->notify_value == 0 && can_block(ticks_to_wait)) {
+    block_until(lk, &self->notify_value, deadline_for(ticks_to_wait));
+  }
+  uint32_t value = self->notify_value;
+  if (value) self->notify_value = clear_on_exit ? 0 : value - 1;
+  self->notify_pending = false;
+  return value;
+}
+
+/* ---------- Queues ---------- */
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size)
+{
+  if (length == 0) return nullptr;
+  Queue* q = construct<Queue>(nullptr);
+  q->item_size = item_size;
+  q->length = length;
+  q->heap_storage.resize(static_cast<size_t>(length) * item_size);
+  q->storage = q->heap_storage.data();
+  return q;
+}
+
+QueueHandle_t xQueueCreateStatic(UBaseType_t length, UBaseType_t item_size, uint8_t* storage,
+                                 StaticQueue_t* queue_buffer)
+{
+  if (length == 0 || !queue_buffer || (item_size && !storage)) return nullptr;
+  Queue* q = construct<Queue>(queue_buffer);
+  q->item_size = item_size;
+  q->length = length;
+  q->storage = storage;
+  return q;
+}
+
+void vQueueDelete(QueueHandle_t queue)
+{
+  destroy(static_cast<Queue*>(queue));
+}
+
+static BaseType_t queue_send(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait, bool front,
+                             bool overwrite)
+{
+  Lock lk(g_mtx);
+  Queue* q = static_cast<Queue*>(queue);
+  if (!q) return pdFAIL;
+  uint64_t deadline = deadline_for(ticks_to_wait);
+
+  for (;;) {
+    if (q->count < q->length || overwrite) {
+      uint32_t slot;
+      if (overwrite && q->count == q->length) {
+        slot = (q->head + q->count - 1) % q->length;
+      } else if (front) {
+        q->head = (q->head + q->length - 1) % q->length;
+        slot = q->head;
+        ++q->count;
+      } else {
+        slot = (q->head + q->count) % q->length;
+        ++q->count;
+      }
+      memcpy(&q->storage[static_cast<size_t>(slot) * q->item_size], item, q->item_size);
+      wake_one(&q->rx_token);
+      preempt_check(lk);
+      return pdTRUE;
+    }
+    if (!can_block(ticks_to_wait) || !block_until(lk, &q->tx_token, deadline)) {
+      if (q->count < q->length) continue;
+      return errQUEUE_FULL;
+    }
+  }
+}
+
+static BaseType_t queue_receive(QueueHandle_t queue, void* out_item, TickType_t ticks_to_wait, bool peek)
+{
+  Lock lk(g_mtx);
+  Queue* q = static_cast<Queue*>(queue);
+  if (!q) return pdFAIL;
+  uint64_t deadline = deadline_for(ticks_to_wait);
+
+  for (;;) {
+    if (q->count > 0) {
+      if (out_item) memcpy(out_item, &q->storage[static_cast<size_t>(q->head) * q->item_size], q->item_size);
+      if (!peek) {
+        q->head = (q->head + 1) % q->length;
+        --q->count;
+        wake_one(&q->tx_token);
+        preempt_check(lk);
+      }
+      return pdTRUE;
+    }
+    if (!can_block(ticks_to_wait) || !block_until(lk, &q->rx_token, deadline)) {
+      if (q->count > 0) continue;
+      return pdFALSE;
+    }
+  }
+}
+
+BaseType_t xQueueSendToBack(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait)
+{
+  return queue_send(queue, item, ticks_to_wait, false, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t queue, const void* item, TickType_t ticks_to_wait)
+{
+  return queue_send(queue, item, ticks_to_wait, true, false);
+}
+
+BaseType_t xQueueOverwrite(QueueHandle_t queue, const void* item)
+{
+  return queue_send(queue, item, 0, false, true);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void* out_item, TickType_t ticks_to_wait)
+{
+  return queue_receive(queue, out_item, ticks_to_wait, false);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t queue, void* out_item, TickType_t ticks_to_wait)
+{
+  return queue_receive(queue, out_item, ticks_to_wait, true);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue)
+{
+  Lock lk(g_mtx);
+  Queue* q = static_cast<Queue*>(queue);
+  return q ? q->count : 0;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t queue)
+{
+  Lock lk(g_mtx);
+  Queue* q = static_cast<Queue*>(queue);
+  return q ? q->length - q->count : 0;
+}
+
+BaseType_t xQueueReset(QueueHandle_t queue)
+{
+  Lock lk(g_mtx);
+  Queue* q = static_cast<Queue*>(queue);
+  if (!q) return pdFAIL;
+  q->head = 0;
+  q->count = 0;
+  wake_all(&q->tx_token);
+  preempt_check(lk);
+  return pdPASS;
+}
+
+/* ---------- Semaphores ---------- */
+
+static SemaphoreHandle_t semaphore_create(UBaseType_t max_count, UBaseType_t initial, bool is_mutex, bool recursive,
+                                          StaticSemaphore_t* buffer = nullptr)
+{
+  Semaphore* s = construct<Semaphore>(buffer);
+  s->count = initial;
+  s->max_count = max_count;
+  s->is_mutex = is_mutex;
+  s->recursive = recursive;
+  return s;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void)
+{
+  return semaphore_create(1, 0, false, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max_count, UBaseType_t initial_count)
+{
+  return semaphore_create(max_count, initial_count, false, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+  return semaphore_create(1, 1, true, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void)
+{
+  return semaphore_create(1, 1, true, true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t* sem_buffer)
+{
+  return sem_buffer ? semaphore_create(1, 0, false, false, sem_buffer) : nullptr;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic(StaticSemaphore_t* sem_buffer)
+{
+  return sem_buffer ? semaphore_create(1, 1, true, false, sem_buffer) : nullptr;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+  destroy(static_cast<Semaphore*>(sem));
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks_to_wait)
+{
+  Lock lk(g_mtx);
+  Semaphore* s = static_cast<Semaphore*>(sem);
+  if (!s) return pdFAIL;
+  uint64_t deadline = deadline_for(ticks_to_wait);
+
+  for (;;) {
+    if (s->recursive && s->holder && s->holder == t_self) {
+      ++s->depth;
+      return pdTRUE;
+    }
+    if (s->count > 0) {
+      --s->count;
+      if (s->is_mutex) {
+        s->holder = t_self;
+        s->depth = 1;
+      }
+      return pdTRUE;
+    }
+    if (!can_block(ticks_to_wait) || !block_until(lk, &s->token, deadline)) {
+      if (s->count > 0) continue;
+      return pdFALSE;
+    }
+  }
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+  Lock lk(g_mtx);
+  Semaphore* s = static_cast<Semaphore*>(sem);
+  if (!s) return pdFAIL;
+
+  if (s->is_mutex) {
+    if (s->holder != t_self) return pdFAIL;
+    if (s->recursive && --s->depth > 0) return pdTRUE;
+    s->holder = nullptr;
+    s->depth = 0;
+  }
+  if (s->count >= s->max_count) return pdFAIL;
+  ++s->count;
+  wake_one(&s->token);
+  preempt_check(lk);
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks_to_wait)
+{
+  return xSemaphoreTake(sem, ticks_to_wait);
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem)
+{
+  return xSemaphoreGive(sem);
+}
+
+UBaseType_t uxSemaphoreGetCount(SemaphoreHandle_t sem)
+{
+  Lock lk(g_mtx);
+  Semaphore* s = static_cast<Semaphore*>(sem);
+  return s ? s->count : 0;
+}
+
+/* ---------- Event groups ---------- */
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+  return construct<EventGroup>(nullptr);
+}
+
+EventGroupHandle_t xEventGroupCreateStatic(StaticEventGroup_t* group_buffer)
+{
+  return group_buffer ? construct<EventGroup>(group_buffer) : nullptr;
+}
+
+void vEventGroupDelete(EventGroupHandle_t group)
+{
+  destroy(static_cast<EventGroup*>(group));
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+  Lock lk(g_mtx);
+  EventGroup* g = static_cast<EventGroup*>(group);
+  if (!g) return 0;
+  g->bits |= bits;
+  wake_all(&g->token);   // Waiters re-evaluate their own condition
+  EventBits_t result = g->bits;
+  preempt_check(lk);
+  return result;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+  Lock lk(g_mtx);
+  EventGroup* g = static_cast<EventGroup*>(group);
+  if (!g) return 0;
+  EventBits_t previous = g->bits;
+  g->bits &= ~bits;
+  return previous;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group)
+{
+  Lock lk(g_mtx);
+  EventGroup* g = static_cast<EventGroup*>(group);
+  return g ? g->bits : 0;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear_on_exit,
+                                BaseType_t wait_for_all, TickType_t ticks_to_wait)
+{
+  Lock lk(g_mtx);
+  EventGroup* g = static_cast<EventGroup*>(group);
+  if (!g) return 0;
+  uint64_t deadline = deadline_for(ticks_to_wait);
+
+  for (;;) {
+    bool satisfied = wait_for_all ? ((g->bits & bits) == bits) : ((g->bits & bits) != 0);
+    if (satisfied) {
+      EventBits_t result = g->bits;
+      if (clear_on_exit) g->bits &= ~bits;
+      return result;
+    }
+    if (!can_block(ticks_to_wait) || g_now_us >= deadline || !block_until(lk, &g->token, deadline)) {
+      satisfied = wait_for_all ? ((g->bits & bits) == bits) : ((g->bits & bits) != 0);
+      if (satisfied) continue;
+      return g->bits;
+    }
+  }
+}
+
+/* ---------- Software timers ---------- */
+
+static TimerHandle_t timer_create(const char* name, TickType_t period, UBaseType_t auto_reload,
+                                  void* timer_id, TimerCallbackFunction_t callback, StaticTimer_t* buffer)
+{
+  Lock lk(g_mtx);
+  if (!callback) return nullptr;
+  if (!g_timer_task) {
+    g_timer_task = create_task_locked(timer_task, "Tmr Svc", 4096, nullptr, configTIMER_TASK_PRIORITY, 0);
+    if (!g_timer_task) return nullptr;
+  }
+
+  Timer* tm = construct<Timer>(buffer);
+  strncpy(tm->name, name ? name : "", sizeof(tm->name) - 1);
+  tm->period = period ? period : 1;
+  tm->auto_reload = auto_reload != 0;
+  tm->id = timer_id;
+  tm->callback = callback;
+  g_timers.push_back(tm);
+  return tm;
+}
+
+TimerHandle_t xTimerCreate(const char* name, TickType_t period, UBaseType_t auto_reload,
+                           void* timer_id, TimerCallbackFunction_t callback)
+{
+  return timer_create(name, period, auto_reload, timer_id, callback, nullptr);
+}
+
+TimerHandle_t xTimerCreateStatic(const char* name, TickType_t period, UBaseType_t auto_reload,
+                                 void* timer_id, TimerCallbackFunction_t callback, StaticTimer_t* timer_buffer)
+{
+  if (!timer_buffer) return nullptr;
+  return timer_create(name, period, auto_reload, timer_id, callback, timer_buffer);
+}
+
+BaseType_t xTimerStart(TimerHandle_t timer, TickType_t ticks_to_wait)
+{
+  (void)ticks_to_wait;
+  Lock lk(g_mtx);
+  Timer* tm = static_cast<Timer*>(timer);
+  if (!tm) return pdFAIL;
+  tm->active = true;
+  tm->expiry_us = deadline_for(tm->period);
+  tm->seq = ++g_seq;
+  kick_timer_task(lk);
+  return pdPASS;
+}
+
+BaseType_t xTimerReset(TimerHandle_t timer, TickType_t ticks_to_wait)
+{
+  return xTimerStart(timer, ticks_to_wait);
+}
+
+BaseType_t xTimerStop(TimerHandle_t timer, TickType_t ticks_to_wait)
+{
+  (void)ticks_to_wait;
+  Lock lk(g_mtx);
+  Timer* tm = static_cast<Timer*>(timer);
+  if (!tm) return pdFAIL;
+  tm->active = false;
+  kick_timer_task(lk);
+  return pdPASS;
+}
+
+BaseType_t xTimerChangePeriod(TimerHandle_t timer, TickType_t period, TickType_t ticks_to_wait)
+{
+  {
+    Lock lk(g_mtx);
+    Timer* tm = static_cast<Timer*>(timer);
+    if (!tm) return pdFAIL;
+    tm->period = period ? period : 1;
+  }
+  return xTimerStart(timer, ticks_to_wait);
+}
+
+BaseType_t xTimerDelete(TimerHandle_t timer, TickType_t ticks_to_wait)
+{
+  (void)ticks_to_wait;
+  Lock lk(g_mtx);
+  Timer* tm = static_cast<Timer*>(timer);
+  if (!tm) return pdFAIL;
+  g_timers.erase(std::remove(g_timers.begin(), g_timers.end(), tm), g_timers.end());
+  destroy(tm);
+  kick_timer_task(lk);
+  return pdPASS;
+}
+
+BaseType_t xTimerIsTimerActive(TimerHandle_t timer)
+{
+  Lock lk(g_mtx);
+  Timer* tm = static_cast<Timer*>(timer);
+  return (tm && tm->active) ? pdTRUE : pdFALSE;
+}
+
+void* pvTimerGetTimerID(TimerHandle_t timer)
+{
+  Timer* tm = static_cast<Timer*>(timer);
+  return tm ? tm->id : nullptr;
+}
+
+TickType_t xTimerGetPeriod(TimerHandle_t timer)
+{
+  Timer* tm = static_cast<Timer*>(timer);
+  return tm ? tm->period : 0;
+}
+
+/* ---------- Ring buffers (byte buffer) ---------- */
+
+RingbufHandle_t xRingbufferCreate(size_t size, RingbufferType_t type)
+{
+  if (type != RINGBUF_TYPE_BYTEBUF || size == 0) return nullptr;
+  Ring* r = construct<Ring>(nullptr);
+  r->heap_buf.resize(size);
+  r->buf = r->heap_buf.data();
+  r->size = size;
+  return r;
+}
+
+RingbufHandle_t xRingbufferCreateStatic(size_t size, RingbufferType_t type, uint8_t* storage,
+                                        StaticRingbuffer_t* ring_buffer)
+{
+  if (type != RINGBUF_TYPE_BYTEBUF || size == 0 || !storage || !ring_buffer) return nullptr;
+  Ring* r = construct<Ring>(ring_buffer);
+  r->buf = storage;
+  r->size = size;
+  return r;
+}
+
+void vRingbufferDelete(RingbufHandle_t ring)
+{
+  destroy(static_cast<Ring*>(ring));
+}
+
+BaseType_t xRingbufferSend(RingbufHandle_t ring, const void* data, size_t size, TickType_t ticks_to_wait)
+{
+  Lock lk(g_mtx);
+  Ring* r = static_cast<Ring*>(ring);
+  if (!r || size > r->size) return pdFALSE;
+  uint64_t deadline = deadline_for(ticks_to_wait);
+
+  for (;;) {
+    if (r->size - r->count >= size) {
+      const uint8_t* src = static_cast<const uint8_t*>(data);
+      size_t write = (r->read + r->count) % r->size;
+      size_t first = std::min(size, r->size - write);
+      memcpy(&r->buf[write], src, first);
+      memcpy(&r->buf[0], src + first, size - first);
+      r->count += size;
+      wake_one(&r->rx_token);
+      preempt_check(lk);
+      return pdTRUE;
+    }
+    if (!can_block(ticks_to_wait) || !block_until(lk, &r->tx_token, deadline)) {
+      if (r->size - r->count >= size) continue;
+      return pdFALSE;
+    }
+  }
+}
+
+void* xRingbufferReceiveUpTo(RingbufHandle_t ring, size_t* out_size, TickType_t ticks_to_wait, size_t max_size)
+{
+  Lock lk(g_mtx);
+  Ring* r = static_cast<Ring*>(ring);
+  if (!r || max_size == 0) return nullptr;
+  uint64_t deadline = deadline_for(ticks_to_wait);
+
+  for (;;) {
+    // Byte buffers hand out one contiguous chunk at a time.
+    if (r->lent == 0 && r->count > 0) {
+      size_t n = std::min({r->count, r->size - r->read, max_size});
+      r->lent = n;
+      if (out_size) *out_size = n;
+      return &r->buf[r->read];
+    }
+    if (!can_block(ticks_to_wait) || !block_until(lk, &r->rx_token, deadline)) {
+      if (r->lent == 0 && r->count > 0) continue;
+      return nullptr;
+    }
+  }
+}
+
+void* xRingbufferReceive(RingbufHandle_t ring, size_t* out_size, TickType_t ticks_to_wait)
+{
+  return xRingbufferReceiveUpTo(ring, out_size, ticks_to_wait, SIZE_MAX);
+}
+
+void vRingbufferReturnItem(RingbufHandle_t ring, void* item)
+{
+  (void)item;
+  Lock lk(g_mtx);
+  Ring* r = static_cast<Ring*>(ring);
+  if (!r || r->lent == 0) return;
+  r->read = (r->read + r->lent) % r->size;
+  r->count -= r->lent;
+  r->lent = 0;
+  wake_all(&r->tx_token);   // Senders need different amounts of space
+  wake_one(&r->rx_token);
+  preempt_check(lk);
+}
+
+size_t xRingbufferGetCurFreeSize(RingbufHandle_t ring)
+{
+  Lock lk(g_mtx);
+  Ring* r = static_cast<Ring*>(ring);
+  return r ? r->size - r->count : 0;
+}
@@ -0,0 +1,32 @@
+/*
+ * NATIVE SIM - Kernel internals shared by the shim sources
+ */
+
+#ifndef NATIVE_SIM_KERNEL_H
+#define NATIVE_SIM_KERNEL_H
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+
+#define SIM_KERNEL_EXIT_OK       0
+#define SIM_KERNEL_EXIT_DEADLOCK 2
+
+/* Virtual time since boot, microseconds */
+uint64_t sim_now_us(void);
+
+/* speed: 0 runs unthrottled, N paces virtual time at N x real time */
+void sim_kernel_init(double speed);
+
+/*
+ * Dispatch the created tasks and block the calling (non-task) thread until
+ * the virtual deadline, sim_kernel_stop() or a deadlock. Returns the exit code.
+ */
+int sim_kernel_run(uint64_t duration_us);
+
+/* End the simulation at the current virtual time (callable from a task) */
+void sim_kernel_stop(int exit_code);
+
+/* Per-task dispatch counts and host CPU time, on stderr */
+void sim_kernel_print_report(void);
+
+#endif // NATIVE_SIM_KERNEL_H
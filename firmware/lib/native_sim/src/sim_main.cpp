@@ -0,0 +1,144 @@
+/*
+ * NATIVE SIM - Host entry point
+ *
+ * Plays the arduino-esp32 startup: setup() then loop() in "loopTask", on
+ * the simulated kernel. Usage:
+ *   program [--duration 10m] [--speed 0] [--seed N] [--script file]
+ *           [--fs dir] [--assets bundle.bin] [--fb-out file.ppm] [--aps N]
+ *           [--ble N] [--stdin]
+ * --duration takes ms/s/m/h suffixes (0 = until the script quits);
+ * --speed 0 runs as fast as possible, N paces virtual time at N x real time.
+ * Unit test builds (PIO_UNIT_TESTING) use sim_test_main() instead.
+ */
+
+#include "Arduino.h"
+#include "native_sim.h"
+#include "sim_internal.h"
+#include "sim_kernel.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#ifndef PIO_UNIT_TESTING
+
+static void loop_task(void* arg)
+{
+  (void)arg;
+  setup();
+  for (;;) {
+    loop();
+  }
+}
+
+static bool parse_duration_us(const char* text, uint64_t* out)
+{
+  char* end = NULL;
+  double value = strtod(text, &end);
+  if (end == text || value < 0) return false;
+
+  double scale = 1e6;   // Plain numbers are seconds
+  if (strcmp(end, "ms") == 0) {
+    scale = 1e3;
+  } else if (strcmp(end, "m") == 0) {
+    scale = 60e6;
+  } else if (strcmp(end, "h") == 0) {
+    scale = 3600e6;
+  } else if (*end != '\0' && strcmp(end, "s") != 0) {
+    return false;
+  }
+  *out = static_cast<uint64_t>(value * scale);
+  return true;
+}
+
+static void usage(const char* prog)
+{
+  fprintf(stderr,
+          "usage: %s [--duration T] [--speed X] [--seed N] [--script FILE] [--fs DIR]\n"
+          "          [--assets BUNDLE] [--fb-out FILE.ppm] [--aps N] [--ble N] [--stdin]\n",
+          prog);
+}
+
+int main(int argc, char** argv)
+{
+  uint64_t duration_us = 60ull * 1000000ull;
+  double speed = 0.0;
+  uint32_t seed = 1;
+  const char* script = NULL;
+  const char* fb_out = NULL;
+  bool use_stdin = false;
+  sim_radio_config_t radio = {0, 24, 40};
+
+  for (int i = 1; i < argc; ++i) {
+    const char* opt = argv[i];
+    const char* val = (i + 1 < argc) ? argv[i + 1] : NULL;
+    bool needs_value = true;
+
+    if (strcmp(opt, "--stdin") == 0) {
+      use_stdin = true;
+      needs_value = false;
+    } else if (!val) {
+      usage(argv[0]);
+      return 1;
+    } else if (strcmp(opt, "--duration") == 0) {
+      if (!parse_duration_us(val, &duration_us)) {
+        usage(argv[0]);
+        return 1;
+      }
+    } else if (strcmp(opt, "--speed") == 0) {
+      speed = atof(val);
+    } else if (strcmp(opt, "--seed") == 0) {
+      seed = static_cast<uint32_t>(strtoul(val, NULL, 0));
+    } else if (strcmp(opt, "--script") == 0) {
+      script = val;
+    } else if (strcmp(opt, "--fs") == 0) {
+      sim_fs_set_root(val);
+    } else if (strcmp(opt, "--assets") == 0) {
+      if (!sim_partition_load("assets", val)) {
+        fprintf(stderr, "[SIM] Cannot load %s into the assets partition\n", val);
+        return 1;
+      }
+    } else if (strcmp(opt, "--fb-out") == 0) {
+      fb_out = val;
+    } else if (strcmp(opt, "--aps") == 0) {
+      radio.wifi_aps = static_cast<uint16_t>(atoi(val));
+    } else if (strcmp(opt, "--ble") == 0) {
+      radio.ble_devices = static_cast<uint16_t>(atoi(val));
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+    if (needs_value) ++i;
+  }
+
+  sim_set_seed(seed);
+  radio.seed = seed;
+  sim_radio_configure(&radio);
+  sim_kernel_init(speed);
+
+  // Same slot as the core's loopTask: 8 KB, priority 1, ARDUINO_RUNNING_CORE.
+  xTaskCreatePinnedToCore(loop_task, "loopTask", 8192, NULL, 1, NULL, 1);
+  if (script && !sim_script_start(script)) return 1;
+  if (use_stdin) sim_serial_attach_stdin();
+
+  sim_heap_mark_baseline();
+  int rc = sim_kernel_run(duration_us);
+
+  fflush(stdout);
+  if (fb_out && !sim_display_dump_ppm(fb_out)) {
+    fprintf(stderr, "[SIM] Cannot write %s\n", fb_out);
+  }
+  sim_display_stats_t stats;
+  sim_display_get_stats(&stats);
+  fprintf(stderr, "[SIM] display: %u flushes, %llu pixels\n", stats.flushes,
+          static_cast<unsigned long long>(stats.pixels));
+  sim_sleep_print_report();
+  sim_kernel_print_report();
+
+  // Task threads are parked mid-call: skip static destructors they may still reference.
+  fflush(stderr);
+  _exit(rc);
+}
+
+#endif // PIO_UNIT_TESTING
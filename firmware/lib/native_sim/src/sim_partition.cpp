@@ -0,0 +1,140 @@
+/*
+ * NATIVE SIM - Data partitions in RAM
+ *
+ * Mirrors the data partitions of partitions_custom.csv that the firmware
+ * opens itself (SPIFFS goes through sim_fs). Programming ANDs into the
+ * erased state like NOR flash, so a missing erase shows up as corruption.
+ * "assets" can be preloaded with a bundle from tools/asset_pack.py.
+ */
+
+#include "esp_partition.h"
+#include "native_sim.h"
+#include "sim_internal.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <mutex>
+#include <vector>
+
+typedef struct {
+  esp_partition_t part;
+  std::vector<uint8_t> data;
+} sim_partition_t;
+
+static std::mutex s_mutex;
+static std::vector<sim_partition_t>* s_parts = nullptr;
+
+static void add_part(uint8_t subtype, uint32_t address, uint32_t size, const char* label)
+{
+  sim_partition_t p;
+  memset(&p.part, 0, sizeof(p.part));
+  p.part.type = ESP_PARTITION_TYPE_DATA;
+  p.part.subtype = static_cast<esp_partition_subtype_t>(subtype);
+  p.part.address = address;
+  p.part.size = size;
+  strcpy(p.part.label, label);
+  p.data.assign(size, 0xFF);
+  s_parts->push_back(p);
+}
+
+static std::vector<sim_partition_t>& parts(void)
+{
+  if (!s_parts) {
+    // Never resized afterwards: mmap pointers into the data stay valid
+    s_parts = new std::vector<sim_partition_t>();
+    s_parts->reserve(2);
+    add_part(0x41, 0x300000u, 0xFE000u, "assets");
+    add_part(0x40, 0x3FE000u, 0x2000u, "petstate");
+  }
+  return *s_parts;
+}
+
+static sim_partition_t* lookup(const esp_partition_t* partition)
+{
+  for (sim_partition_t& p : parts()) {
+    if (&p.part == partition) return &p;
+  }
+  return nullptr;
+}
+
+const esp_partition_t* esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char* label)
+{
+  std::lock_guard<std::mutex> lock(s_mutex);
+  for (sim_partition_t& p : parts()) {
+    if (p.part.type != type) continue;
+    if (subtype != ESP_PARTITION_SUBTYPE_ANY && p.part.subtype != subtype) continue;
+    if (label && strcmp(label, p.part.label) != 0) continue;
+    return &p.part;
+  }
+  return nullptr;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t* partition, size_t src_offset, void* dst, size_t size)
+{
+  std::lock_guard<std::mutex> lock(s_mutex);
+  sim_partition_t* p = lookup(partition);
+  if (!p || !dst || src_offset + size > p->data.size()) return ESP_ERR_INVALID_ARG;
+  memcpy(dst, &p->data[src_offset], size);
+  sim_flash_count_read(static_cast<uint32_t>(size));
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t* partition, size_t dst_offset, const void* src, size_t size)
+{
+  std::lock_guard<std::mutex> lock(s_mutex);
+  sim_partition_t* p = lookup(partition);
+  if (!p || !src || dst_offset + size > p->data.size()) return ESP_ERR_INVALID_ARG;
+  const uint8_t* in = static_cast<const uint8_t*>(src);
+  for (size_t i = 0; i < size; ++i) p->data[dst_offset + i] &= in[i];
+  sim_flash_count_write(static_cast<uint32_t>(size));
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t* partition, size_t offset, size_t size)
+{
+  std::lock_guard<std::mutex> lock(s_mutex);
+  sim_partition_t* p = lookup(partition);
+  if (!p || offset % SPI_FLASH_SEC_SIZE || size % SPI_FLASH_SEC_SIZE || offset + size > p->data.size()) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  memset(&p->data[offset], 0xFF, size);
+  sim_flash_count_erase(static_cast<uint32_t>(size));
+  return ESP_OK;
+}
+
+esp_err_t esp_partition_mmap(const esp_partition_t* partition, size_t offset, size_t size,
+                             spi_flash_mmap_memory_t memory, const void** out_ptr,
+                             spi_flash_mmap_handle_t* out_handle)
+{
+  (void)memory;
+  std::lock_guard<std::mutex> lock(s_mutex);
+  sim_partition_t* p = lookup(partition);
+  if (!p || !out_ptr || !out_handle || offset + size > p->data.size()) return ESP_ERR_INVALID_ARG;
+  *out_ptr = &p->data[offset];
+  *out_handle = 1;
+  return ESP_OK;
+}
+
+void spi_flash_munmap(spi_flash_mmap_handle_t handle)
+{
+  (void)handle;
+}
+
+bool sim_partition_load(const char* label, const char* host_file)
+{
+  FILE* fp = fopen(host_file, "rb");
+  if (!fp) return false;
+
+  std::lock_guard<std::mutex> lock(s_mutex);
+  bool ok = false;
+  for (sim_partition_t& p : parts()) {
+    if (strcmp(p.part.label, label) != 0) continue;
+    size_t n = fread(p.data.data(), 1, p.data.size(), fp);
+    ok = n > 0 && fgetc(fp) == EOF;   // Larger than the partition: refuse
+    if (!ok) memset(p.data.data(), 0xFF, p.data.size());
+    break;
+  }
+  fclose(fp);
+  return ok;
+}
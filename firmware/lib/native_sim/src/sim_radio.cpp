@@ -0,0 +1,430 @@
+/*
+ * NATIVE SIM - Simulated WiFi/BLE surroundings
+ *
+ * The population is generated once from the seed. Each scan samples it
+ * with RSSI jitter and per-scan detection odds, so repeated scans differ
+ * the way real ones do while staying reproducible run to run. Part of the
+ * BLE population comes and goes on its own period, and random-address
+ * advertisers rotate their address every 15 minutes like resolvable
+ * private addresses.
+ *
+ * Each advertiser has its own advertising interval (100 ms phones and
+ * earbuds to 10 s sensors, plus the 0-10 ms advDelay). A scan hears an
+ * advertising event when its window is open, so detection over a start()
+ * call depends on the call's length, window / interval and RSSI; names
+ * not carried in the advertisement need an active scan (scan response).
+ */
+
+#include "WiFi.h"
+#include "BLEDevice.h"
+#include "native_sim.h"
+#include "freertos/semphr.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <random>
+#include <string>
+#include <vector>
+
+#define SIM_BLE_RPA_ROTATE_MS (15u * 60u * 1000u)
+#define SIM_WIFI_CHANNELS     13
+
+WiFiClass WiFi;
+
+namespace {
+
+struct SimAp {
+  std::string ssid;
+  uint8_t bssid[6];
+  uint8_t channel;
+  int base_rssi;
+};
+
+struct SimBle {
+  uint8_t address[6];
+  esp_ble_addr_type_t type;
+  std::string name;
+  int base_rssi;
+  uint32_t period_ms;   // 0: always present
+  uint32_t present_ms;  // Present during [phase, phase + present_ms) of each period
+  uint32_t phase_ms;
+  uint32_t adv_interval_ms;
+  bool name_in_adv;     // Else only in the scan response
+};
+
+struct ScanResult {
+  std::string ssid;
+  uint8_t bssid[6];
+  uint8_t channel;
+  int32_t rssi;
+};
+
+struct EventHandler {
+  wifi_event_id_t id;
+  arduino_event_id_t event;
+  WiFiEventFuncCb cb;
+};
+
+struct PendingEvent {
+  arduino_event_id_t event;
+  arduino_event_info_t info;
+};
+
+const char* const kSsidStems[] = {
+  "Livebox", "Freebox", "SFR_", "Bbox-", "CoffeeShop", "eduroam", "HP-Print-", "DIRECT-",
+  "Guest", "TP-Link_", "NETGEAR", "iPhone de ", "Galaxy", "Office", "FreeWifi", "AndroidAP",
+};
+
+const char* const kBleNames[] = {
+  "Mi Band", "JBL Flip", "Galaxy Buds", "Tile", "AirPods", "Fitbit", "LE-Bose", "Garmin",
+  "Apple Watch", "Pixel", "MX Master", "[TV] Samsung", "Polar H10", "Nuki", "Govee", "Xbox Controller",
+};
+
+std::mt19937 g_rng(0xC0FFEE);
+bool g_populated = false;
+sim_radio_config_t g_config = {0xC0FFEE, 24, 40};
+std::vector<SimAp> g_aps;
+std::vector<SimBle> g_ble;
+
+// WiFi scan state, guarded by the scheduler (one task runs at a time)
+std::vector<ScanResult> g_scan;
+int16_t g_scan_status = WIFI_SCAN_FAILED;
+bool g_scan_show_hidden = false;
+TimerHandle_t g_scan_timer = nullptr;
+
+std::vector<EventHandler> g_handlers;
+wifi_event_id_t g_next_handler_id = 1;
+QueueHandle_t g_event_queue = nullptr;
+
+int rand_range(int lo, int hi)
+{
+  return std::uniform_int_distribution<int>(lo, hi)(g_rng);
+}
+
+bool chance(double p)
+{
+  return std::uniform_real_distribution<double>(0.0, 1.0)(g_rng) < p;
+}
+
+void random_mac(uint8_t* mac, bool local)
+{
+  for (int i = 0; i < 6; ++i) mac[i] = static_cast<uint8_t>(rand_range(0, 255));
+  mac[0] &= 0xFE;
+  if (local) mac[0] |= 0x02;
+}
+
+void populate(void)
+{
+  if (g_populated) return;
+  g_populated = true;
+  g_rng.seed(g_config.seed);
+
+  for (uint16_t i = 0; i < g_config.wifi_aps; ++i) {
+    SimAp ap;
+    size_t stem = static_cast<size_t>(rand_range(0, sizeof(kSsidStems) / sizeof(kSsidStems[0]) - 1));
+    char ssid[33];
+    snprintf(ssid, sizeof(ssid), "%s%04X", kSsidStems[stem], rand_range(0, 0xFFFF));
+    ap.ssid = chance(0.1) ? std::string() : std::string(ssid);   // Some hidden networks
+    random_mac(ap.bssid, false);
+    static const uint8_t kCommonChannels[] = {1, 6, 11};
+    ap.channel = chance(0.7) ? kCommonChannels[rand_range(0, 2)] : static_cast<uint8_t>(rand_range(1, SIM_WIFI_CHANNELS));
+    ap.base_rssi = rand_range(-92, -35);
+    g_aps.push_back(ap);
+  }
+
+  for (uint16_t i = 0; i < g_config.ble_devices; ++i) {
+    SimBle dev;
+    dev.type = chance(0.6) ? BLE_ADDR_TYPE_RANDOM : BLE_ADDR_TYPE_PUBLIC;
+    random_mac(dev.address, dev.type == BLE_ADDR_TYPE_RANDOM);
+    if (dev.type == BLE_ADDR_TYPE_RANDOM) {
+      // Two top bits: 11 random static (a quarter of them), 01 resolvable private
+      dev.address[0] = static_cast<uint8_t>((dev.address[0] & 0x3F) | ((dev.address[1] & 3) == 0 ? 0xC0 : 0x40));
+    }
+    if (chance(0.5)) {
+      dev.name = kBleNames[rand_range(0, sizeof(kBleNames) / sizeof(kBleNames[0]) - 1)];
+    }
+    dev.name_in_adv = chance(0.5);
+    dev.base_rssi = rand_range(-98, -40);
+    // Phones / earbuds, continuity-style beacons, iBeacon / Eddystone, trackers and sensors
+    int bucket = rand_range(0, 99);
+    if (bucket < 25) {
+      dev.adv_interval_ms = 100;
+    } else if (bucket < 55) {
+      dev.adv_interval_ms = static_cast<uint32_t>(rand_range(150, 500));
+    } else if (bucket < 85) {
+      dev.adv_interval_ms = static_cast<uint32_t>(rand_range(1000, 1285));
+    } else {
+      dev.adv_interval_ms = static_cast<uint32_t>(rand_range(2000, 10240));
+    }
+    if (chance(0.33)) {
+      dev.period_ms = static_cast<uint32_t>(rand_range(30, 600)) * 1000u;
+      dev.present_ms = dev.period_ms * static_cast<uint32_t>(rand_range(20, 80)) / 100u;
+      dev.phase_ms = static_cast<uint32_t>(rand_range(0, static_cast<int>(dev.period_ms - 1)));
+    } else {
+      dev.period_ms = 0;
+      dev.present_ms = 0;
+      dev.phase_ms = 0;
+    }
+    g_ble.push_back(dev);
+  }
+}
+
+bool ble_present(const SimBle& dev, uint32_t from_ms, uint32_t to_ms)
+{
+  if (dev.period_ms == 0) return true;
+  // Present at any point of [from, to]: check both ends and any window start in between.
+  for (uint32_t t = from_ms; ; t += 1000u) {
+    if (t > to_ms) t = to_ms;
+    uint32_t pos = (t + dev.period_ms - dev.phase_ms) % dev.period_ms;
+    if (pos < dev.present_ms) return true;
+    if (t == to_ms) return false;
+  }
+}
+
+void ble_current_address(const SimBle& dev, uint32_t now_ms, uint8_t* out)
+{
+  memcpy(out, dev.address, 6);
+  if (dev.type != BLE_ADDR_TYPE_RANDOM || (dev.address[0] & 0xC0) == 0xC0) return;
+  uint32_t epoch = now_ms / SIM_BLE_RPA_ROTATE_MS;
+  // Cheap deterministic mix so each epoch gets a fresh-looking address.
+  uint32_t h = epoch * 2654435761u ^ (static_cast<uint32_t>(dev.address[2]) << 16 | dev.address[3] << 8 | dev.address[4]);
+  out[3] ^= static_cast<uint8_t>(h >> 24);
+  out[4] ^= static_cast<uint8_t>(h >> 16);
+  out[5] ^= static_cast<uint8_t>(h >> 8);
+}
+
+int jitter(int base, int amount)
+{
+  int rssi = base + rand_range(-amount, amount);
+  return rssi > -20 ? -20 : rssi;
+}
+
+void fill_wifi_results(uint8_t only_channel)
+{
+  g_scan.clear();
+  for (const SimAp& ap : g_aps) {
+    if (only_channel && ap.channel != only_channel) continue;
+    if (ap.ssid.empty() && !g_scan_show_hidden) continue;
+    // Weak beacons get lost now and then.
+    double miss = ap.base_rssi < -85 ? 0.4 : (ap.base_rssi < -75 ? 0.1 : 0.02);
+    if (chance(miss)) continue;
+    ScanResult r;
+    r.ssid = ap.ssid;
+    memcpy(r.bssid, ap.bssid, 6);
+    r.channel = ap.channel;
+    r.rssi = jitter(ap.base_rssi, 4);
+    g_scan.push_back(r);
+  }
+  // The IDF sorts scan results by RSSI.
+  std::stable_sort(g_scan.begin(), g_scan.end(),
+                   [](const ScanResult& a, const ScanResult& b) { return a.rssi > b.rssi; });
+}
+
+void event_task(void* arg)
+{
+  (void)arg;
+  PendingEvent evt;
+  for (;;) {
+    if (xQueueReceive(g_event_queue, &evt, portMAX_DELAY) != pdTRUE) continue;
+    std::vector<EventHandler> handlers = g_handlers;   // Handlers may (un)register
+    for (const EventHandler& h : handlers) {
+      if (h.event == ARDUINO_EVENT_MAX || h.event == evt.event) h.cb(evt.event, evt.info);
+    }
+  }
+}
+
+void ensure_event_task(void)
+{
+  if (g_event_queue) return;
+  g_event_queue = xQueueCreate(32, sizeof(PendingEvent));
+  // Same slot as the core's event loop: ESP_TASKD_EVENT_PRIO - 1, event core 1.
+  xTaskCreatePinnedToCore(event_task, "arduino_events", 4096, nullptr, 19, nullptr, 1);
+}
+
+void scan_done_cb(TimerHandle_t timer)
+{
+  uint8_t only_channel = static_cast<uint8_t>(reinterpret_cast<uintptr_t>(pvTimerGetTimerID(timer)));
+  fill_wifi_results(only_channel);
+  g_scan_status = static_cast<int16_t>(g_scan.size());
+
+  PendingEvent evt;
+  memset(&evt, 0, sizeof(evt));
+  evt.event = ARDUINO_EVENT_WIFI_SCAN_DONE;
+  evt.info.wifi_scan_done.status = 0;
+  evt.info.wifi_scan_done.number = static_cast<uint8_t>(g_scan.size());
+  xQueueSend(g_event_queue, &evt, 0);
+}
+
+}  // namespace
+
+void sim_radio_configure(const sim_radio_config_t* config)
+{
+  if (!config) return;
+  g_config = *config;
+  g_aps.clear();
+  g_ble.clear();
+  g_populated = false;
+  populate();
+}
+
+/* ---------- WiFi ---------- */
+
+bool WiFiClass::disconnect(bool wifioff, bool eraseap)
+{
+  (void)eraseap;
+  if (wifioff) m_mode = WIFI_OFF;
+  return true;
+}
+
+int16_t WiFiClass::scanNetworks(bool async, bool show_hidden, bool passive, uint32_t max_ms_per_chan, uint8_t channel)
+{
+  if (g_scan_status == WIFI_SCAN_RUNNING) return WIFI_SCAN_RUNNING;
+  populate();
+  if (m_mode == WIFI_OFF) m_mode = WIFI_STA;   // The core switches to STA for a scan
+
+  g_scan_show_hidden = show_hidden;
+  uint32_t dwell_ms = passive ? 360u : max_ms_per_chan;
+  uint32_t duration_ms = dwell_ms * (channel ? 1u : SIM_WIFI_CHANNELS);
+
+  if (!async) {
+    g_scan_status = WIFI_SCAN_RUNNING;
+    vTaskDelay(pdMS_TO_TICKS(duration_ms));
+    fill_wifi_results(channel);
+    g_scan_status = static_cast<int16_t>(g_scan.size());
+    return g_scan_status;
+  }
+
+  ensure_event_task();
+  if (g_scan_timer) xTimerDelete(g_scan_timer, 0);
+  g_scan_timer = xTimerCreate("wifi_scan", pdMS_TO_TICKS(duration_ms), pdFALSE,
+                              reinterpret_cast<void*>(static_cast<uintptr_t>(channel)), scan_done_cb);
+  if (!g_scan_timer) return WIFI_SCAN_FAILED;
+  g_scan_status = WIFI_SCAN_RUNNING;
+  xTimerStart(g_scan_timer, 0);
+  return WIFI_SCAN_RUNNING;
+}
+
+int16_t WiFiClass::scanComplete(void)
+{
+  return g_scan_status;
+}
+
+void WiFiClass::scanDelete(void)
+{
+  g_scan.clear();
+  if (g_scan_status != WIFI_SCAN_RUNNING) g_scan_status = WIFI_SCAN_FAILED;
+}
+
+String WiFiClass::SSID(uint8_t i)
+{
+  return i < g_scan.size() ? String(g_scan[i].ssid) : String();
+}
+
+int32_t WiFiClass::RSSI(uint8_t i)
+{
+  return i < g_scan.size() ? g_scan[i].rssi : 0;
+}
+
+int32_t WiFiClass::channel(uint8_t i)
+{
+  return i < g_scan.size() ? g_scan[i].channel : 0;
+}
+
+uint8_t* WiFiClass::BSSID(uint8_t i)
+{
+  return i < g_scan.size() ? g_scan[i].bssid : nullptr;
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventSysCb cb, arduino_event_id_t event)
+{
+  return onEvent(WiFiEventFuncCb(cb), event);
+}
+
+wifi_event_id_t WiFiClass::onEvent(WiFiEventFuncCb cb, arduino_event_id_t event)
+{
+  if (!cb) return 0;
+  ensure_event_task();
+  g_handlers.push_back({g_next_handler_id, event, cb});
+  return g_next_handler_id++;
+}
+
+void WiFiClass::removeEvent(wifi_event_id_t id)
+{
+  for (auto it = g_handlers.begin(); it != g_handlers.end(); ++it) {
+    if (it->id == id) {
+      g_handlers.erase(it);
+      return;
+    }
+  }
+}
+
+/* ---------- BLE ---------- */
+
+static bool s_ble_initialized = false;
+static BLEScan s_ble_scan;
+
+std::string BLEAddress::toString(void) const
+{
+  char buf[18];
+  snprintf(buf, sizeof(buf), "%02x:%02x:%02x:%02x:%02x:%02x",
+           m_address[0], m_address[1], m_address[2], m_address[3], m_address[4], m_address[5]);
+  return buf;
+}
+
+void BLEDevice::init(const std::string& device_name)
+{
+  (void)device_name;
+  populate();
+  s_ble_initialized = true;
+}
+
+void BLEDevice::deinit(bool release_memory)
+{
+  (void)release_memory;
+  s_ble_initialized = false;
+}
+
+BLEScan* BLEDevice::getScan(void)
+{
+  return &s_ble_scan;
+}
+
+bool BLEDevice::getInitialized(void)
+{
+  return s_ble_initialized;
+}
+
+void BLEScan::stop(void)
+{
+  if (m_abort) xSemaphoreGive(m_abort);
+}
+
+BLEScanResults BLEScan::start(uint32_t duration_s, bool is_continue)
+{
+  if (!is_continue) m_results.m_devices.clear();
+  if (!m_abort) m_abort = xSemaphoreCreateBinary();
+  xSemaphoreTake(m_abort, 0);   // Drop a stop() issued between scans
+  uint32_t from_ms = millis();
+  xSemaphoreTake(m_abort, pdMS_TO_TICKS(duration_s * 1000u));
+  uint32_t to_ms = millis();
+
+  // Share of advertising events that fall in a scan window
+  double duty = m_interval_ms ? static_cast<double>(m_window_ms) / m_interval_ms : 1.0;
+  if (duty > 1.0) duty = 1.0;
+  const double span_ms = static_cast<double>(to_ms - from_ms);
+
+  for (const SimBle& dev : g_ble) {
+    if (!ble_present(dev, from_ms, to_ms)) continue;
+    const double rx = dev.base_rssi < -90 ? 0.4 : (dev.base_rssi < -80 ? 0.75 : 0.95);
+    const double events = span_ms / (dev.adv_interval_ms + 5.0);
+    if (!chance(1.0 - pow(1.0 - duty * rx, events))) continue;
+
+    uint8_t addr[6];
+    ble_current_address(dev, to_ms, addr);
+    // The scan response follows the heard advertisement, when it gets through too.
+    std::string name = (dev.name_in_adv || (m_active && chance(rx))) ? dev.name : std::string();
+    m_results.m_devices.emplace_back(BLEAddress(addr), dev.type, name, jitter(dev.base_rssi, 6));
+  }
+  return m_results;
+}
@@ -0,0 +1,64 @@
+/*
+ * NATIVE SIM - Unit test entry
+ *
+ * `pio test -e native` builds each test/test_* suite with PIO_UNIT_TESTING,
+ * which leaves out sim_main.cpp's main(). The suite's main() hands its Unity
+ * runner to sim_test_main(): the runner executes in a task on the simulated
+ * kernel, so FreeRTOS calls, virtual time, the radios and the file system
+ * behave as in the program. The file system is an empty scratch directory,
+ * removed afterwards.
+ */
+
+#include "Arduino.h"
+#include "native_sim.h"
+#include "sim_internal.h"
+#include "sim_kernel.h"
+
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static int (*s_runner)(void) = NULL;
+
+static void test_task(void* arg)
+{
+  (void)arg;
+  int failures = s_runner();
+  sim_kernel_stop(failures ? 1 : SIM_KERNEL_EXIT_OK);
+}
+
+static int remove_entry(const char* path, const struct stat* st, int flag, struct FTW* ftw)
+{
+  (void)st;
+  (void)flag;
+  (void)ftw;
+  return remove(path);
+}
+
+int sim_test_main(int (*runner)(void))
+{
+  char fs_root[] = "/tmp/acyd_test_XXXXXX";
+  if (!mkdtemp(fs_root)) {
+    fprintf(stderr, "[SIM] Cannot create a scratch file system\n");
+    return 1;
+  }
+  sim_fs_set_root(fs_root);
+
+  sim_set_seed(1);
+  sim_radio_config_t radio = {1, 24, 40};
+  sim_radio_configure(&radio);
+  sim_kernel_init(0.0);
+
+  // The loopTask slot: suites start the firmware's own tasks around it
+  s_runner = runner;
+  xTaskCreatePinnedToCore(test_task, "unity", 8192, NULL, 1, NULL, 1);
+  sim_heap_mark_baseline();
+  int rc = sim_kernel_run(0);
+
+  nftw(fs_root, remove_entry, 16, FTW_DEPTH | FTW_PHYS);
+  fflush(stdout);
+  fflush(stderr);
+  // Task threads are parked mid-call, as in sim_main.cpp
+  _exit(rc);
+}
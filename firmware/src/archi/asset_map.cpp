@@ -0,0 +1,301 @@
+/*
+ * ARCHI - Memory-Mapped Assets Implementation
+ *
+ * Only the 16-byte header is read with esp_partition_read(): it gives the
+ * extent to map. The index is then checked through the mapping itself, so
+ * nothing of the bundle is ever copied to RAM.
+ */
+
+#include "asset_map.h"
+#include "storage_fs.h"
+#include "bench_clock.h"
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <esp_partition.h>
+#include <esp_timer.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ASSET_BENCH_FILE    "/asset_bench.bin"
+#define ASSET_BENCH_PASSES  3
+#define ASSET_BENCH_CHUNK   4096
+
+typedef struct {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t count;
+  uint32_t index_crc;
+  uint32_t data_end;        // End of the last blob (bytes to map)
+} asset_bundle_header_t;
+
+typedef struct {
+  char name[ASSET_MAP_NAME_MAX];
+  uint32_t offset;
+  uint32_t size;
+  uint32_t img_header;
+  uint32_t crc;
+} asset_bundle_entry_t;
+
+static_assert(sizeof(asset_bundle_header_t) == 16, "bundle header is 16 bytes on flash");
+static_assert(sizeof(asset_bundle_entry_t) == 32, "bundle entry is 32 bytes on flash");
+static_assert(sizeof(lv_img_header_t) == 4, "img_header holds lv_img_header_t");
+
+static const esp_partition_t* s_part = NULL;
+static spi_flash_mmap_handle_t s_handle = 0;
+static const uint8_t* s_base = NULL;
+static const asset_bundle_entry_t* s_entries = NULL;
+static lv_img_dsc_t s_dscs[ASSET_MAP_MAX_ENTRIES];
+static asset_map_stats_t s_stats;
+
+// CRC-32 (IEEE, reflected), one nibble at a time: same as tools/asset_pack.py (zlib)
+static const uint32_t k_crc_nibble[16] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+static uint32_t crc32(const uint8_t* data, uint32_t len)
+{
+  uint32_t crc = 0xFFFFFFFFu;
+  for (uint32_t i = 0; i < len; ++i) {
+    crc ^= data[i];
+    crc = (crc >> 4) ^ k_crc_nibble[crc & 0x0F];
+    crc = (crc >> 4) ^ k_crc_nibble[crc & 0x0F];
+  }
+  return ~crc;
+}
+
+static bool entry_valid(const asset_bundle_entry_t* e, uint32_t index_end, uint32_t data_end)
+{
+  if (memchr(e->name, '\0', sizeof(e->name)) == NULL || e->name[0] == '\0') return false;
+  if (e->offset % ASSET_MAP_ALIGN || e->offset < index_end) return false;
+  if (e->size == 0 || e->size > data_end - e->offset) return false;
+
+  lv_img_header_t hdr;
+  memcpy(&hdr, &e->img_header, sizeof(hdr));
+  if (hdr.cf == LV_IMG_CF_TRUE_COLOR && e->size < static_cast<uint32_t>(hdr.w) * hdr.h * sizeof(lv_color_t)) {
+    return false;
+  }
+  return true;
+}
+
+static void unmap(void)
+{
+  if (s_base) spi_flash_munmap(s_handle);
+  s_base = NULL;
+  s_entries = NULL;
+}
+
+bool asset_map_init(void)
+{
+  if (s_base) return true;
+
+  s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                    static_cast<esp_partition_subtype_t>(ASSET_MAP_PARTITION_SUBTYPE),
+                                    ASSET_MAP_PARTITION_LABEL);
+  if (!s_part) {
+    Serial.println("ARCHI: No '" ASSET_MAP_PARTITION_LABEL "' partition: images from " STORAGE_FS_NAME);
+    return false;
+  }
+
+  int64_t start = esp_timer_get_time();
+  asset_bundle_header_t hdr;
+  if (esp_partition_read(s_part, 0, &hdr, sizeof(hdr)) != ESP_OK || hdr.magic != ASSET_MAP_MAGIC) {
+    Serial.println("ARCHI: Asset bundle not flashed: images from " STORAGE_FS_NAME);
+    return false;
+  }
+
+  uint32_t index_end = sizeof(hdr) + static_cast<uint32_t>(hdr.count) * sizeof(asset_bundle_entry_t);
+  if (hdr.version != ASSET_MAP_VERSION || hdr.count == 0 || hdr.count > ASSET_MAP_MAX_ENTRIES ||
+      hdr.data_end < index_end || hdr.data_end > s_part->size) {
+    Serial.println("[ERROR] Asset bundle header invalid: images from " STORAGE_FS_NAME);
+    return false;
+  }
+
+  const void* ptr = NULL;
+  if (esp_partition_mmap(s_part, 0, hdr.data_end, SPI_FLASH_MMAP_DATA, &ptr, &s_handle) != ESP_OK) {
+    Serial.println("[ERROR] Cannot map the asset partition: images from " STORAGE_FS_NAME);
+    return false;
+  }
+  s_base = static_cast<const uint8_t*>(ptr);
+  s_entries = reinterpret_cast<const asset_bundle_entry_t*>(s_base + sizeof(hdr));
+
+  if (crc32(reinterpret_cast<const uint8_t*>(s_entries), index_end - sizeof(hdr)) != hdr.index_crc) {
+    Serial.println("[ERROR] Asset bundle index corrupt: images from " STORAGE_FS_NAME);
+    unmap();
+    return false;
+  }
+  for (uint16_t i = 0; i < hdr.count; ++i) {
+    const asset_bundle_entry_t* e = &s_entries[i];
+    if (!entry_valid(e, index_end, hdr.data_end)) {
+      Serial.printf("[ERROR] Asset entry %u invalid: images from " STORAGE_FS_NAME "\n", i);
+      unmap();
+      return false;
+    }
+    memcpy(&s_dscs[i].header, &e->img_header, sizeof(lv_img_header_t));
+    s_dscs[i].data_size = e->size;
+    s_dscs[i].data = s_base + e->offset;
+  }
+
+  s_stats.mapped = true;
+  s_stats.count = hdr.count;
+  s_stats.mapped_bytes = hdr.data_end;
+  s_stats.map_us = static_cast<uint32_t>(esp_timer_get_time() - start);
+  Serial.printf("ARCHI: Assets mapped: %u images, %lu KB (%lu us)\n", hdr.count,
+                static_cast<unsigned long>(hdr.data_end / 1024), static_cast<unsigned long>(s_stats.map_us));
+  return true;
+}
+
+static int find_index(const char* name)
+{
+  if (!s_base || !name) return -1;
+  for (uint16_t i = 0; i < s_stats.count; ++i) {
+    if (strncmp(s_entries[i].name, name, ASSET_MAP_NAME_MAX) == 0) return i;
+  }
+  return -1;
+}
+
+const lv_img_dsc_t* asset_map_find(const char* name)
+{
+  int i = find_index(name);
+  return i < 0 ? NULL : &s_dscs[i];
+}
+
+const char* asset_map_name(const void* src)
+{
+  const lv_img_dsc_t* dsc = static_cast<const lv_img_dsc_t*>(src);
+  if (!s_base || dsc < s_dscs || dsc >= s_dscs + s_stats.count) return NULL;
+  return s_entries[dsc - s_dscs].name;
+}
+
+bool asset_map_verify(const char* name)
+{
+  int i = find_index(name);
+  if (i < 0) return false;
+  return crc32(s_base + s_entries[i].offset, s_entries[i].size) == s_entries[i].crc;
+}
+
+void asset_map_get_stats(asset_map_stats_t* out)
+{
+  if (out) *out = s_stats;
+}
+
+// ---------------------------------------------------------------------------
+// Benchmark
+// ---------------------------------------------------------------------------
+
+static uint32_t checksum(uint32_t sum, const uint8_t* row, uint32_t len)
+{
+  const uint32_t* w = reinterpret_cast<const uint32_t*>(row);
+  for (uint32_t i = 0; i < len / 4; ++i) sum = ((sum << 5) | (sum >> 27)) ^ w[i];
+  return sum;
+}
+
+static bool write_bench_file(const lv_img_dsc_t* dsc)
+{
+  File f = storage_fs().open(ASSET_BENCH_FILE, "w");
+  if (!f) return false;
+
+  uint32_t hdr;
+  memcpy(&hdr, &dsc->header, sizeof(hdr));
+  bool ok = f.write(reinterpret_cast<const uint8_t*>(&hdr), sizeof(hdr)) == sizeof(hdr);
+  for (uint32_t off = 0; ok && off < dsc->data_size; off += ASSET_BENCH_CHUNK) {
+    uint32_t n = dsc->data_size - off < ASSET_BENCH_CHUNK ? dsc->data_size - off : ASSET_BENCH_CHUNK;
+    ok = f.write(dsc->data + off, n) == n;
+  }
+  f.close();
+  return ok;
+}
+
+static uint32_t redraw_us(lv_obj_t* img)
+{
+  int64_t start = bench_clock_us();
+  for (uint32_t i = 0; i < ASSET_BENCH_PASSES; ++i) {
+    lv_obj_invalidate(img);
+    lv_refr_now(NULL);
+  }
+  return static_cast<uint32_t>((bench_clock_us() - start) / ASSET_BENCH_PASSES);
+}
+
+void asset_map_run_benchmark(void)
+{
+  int index = -1;
+  for (uint16_t i = 0; i < s_stats.count && index < 0; ++i) {
+    if (s_dscs[i].header.cf == LV_IMG_CF_TRUE_COLOR) index = i;
+  }
+  if (index < 0) {
+    Serial.println("[ASSETS] Benchmark: no mapped image (pack and flash the assets partition)");
+    return;
+  }
+  const lv_img_dsc_t* dsc = &s_dscs[index];
+  const char* name = s_entries[index].name;
+  const uint32_t h = dsc->header.h;
+  const uint32_t row = dsc->header.w * sizeof(lv_color_t);
+
+  int64_t start = bench_clock_us();
+  bool crc_ok = asset_map_verify(name);
+  uint32_t crc_us = static_cast<uint32_t>(bench_clock_us() - start);
+
+  uint8_t* line = static_cast<uint8_t*>(malloc(row));
+  if (!line || !write_bench_file(dsc)) {
+    Serial.println("[ASSETS] Benchmark: cannot copy the image to " STORAGE_FS_NAME " (full?)");
+    free(line);
+    storage_fs().remove(ASSET_BENCH_FILE);
+    return;
+  }
+
+  // Line by line, as the image decoder reads: file driver vs mapping
+  uint64_t fs_us = 0, map_us = 0;
+  uint32_t fs_sum = 0, map_sum = 0;
+  int32_t open_heap = 0;
+  bool fs_ok = true;
+  for (uint32_t pass = 0; pass < ASSET_BENCH_PASSES && fs_ok; ++pass) {
+    fs_sum = 0;
+    start = bench_clock_us();
+    size_t heap_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    lv_fs_file_t file;
+    fs_ok = lv_fs_open(&file, "S:" ASSET_BENCH_FILE, LV_FS_MODE_RD) == LV_FS_RES_OK;
+    if (!fs_ok) break;
+    open_heap = static_cast<int32_t>(heap_before - heap_caps_get_free_size(MALLOC_CAP_8BIT));
+    lv_fs_seek(&file, sizeof(lv_img_header_t), LV_FS_SEEK_SET);
+    for (uint32_t y = 0; y < h; ++y) {
+      uint32_t br = 0;
+      lv_fs_read(&file, line, row, &br);
+      fs_sum = checksum(fs_sum, line, row);
+    }
+    lv_fs_close(&file);
+    fs_us += static_cast<uint64_t>(bench_clock_us() - start);
+
+    map_sum = 0;
+    start = bench_clock_us();
+    for (uint32_t y = 0; y < h; ++y) map_sum = checksum(map_sum, dsc->data + y * row, row);
+    map_us += static_cast<uint64_t>(bench_clock_us() - start);
+  }
+  free(line);
+
+  // Whole-screen redraw from each source (daylight tint off: plain copy of the descriptor)
+  uint32_t fs_draw_us = 0, map_draw_us = 0;
+  if (fs_ok) {
+    lv_img_dsc_t plain = *dsc;
+    lv_obj_t* img = lv_img_create(lv_layer_top());
+    lv_img_set_src(img, "S:" ASSET_BENCH_FILE);
+    fs_draw_us = redraw_us(img);
+    lv_img_set_src(img, &plain);
+    map_draw_us = redraw_us(img);
+    lv_obj_del(img);
+  }
+  storage_fs().remove(ASSET_BENCH_FILE);
+
+  if (!fs_ok) {
+    Serial.println("[ASSETS] Benchmark: LVGL cannot open the " STORAGE_FS_NAME " copy");
+    return;
+  }
+  Serial.printf("[ASSETS] %s %lux%lu, CRC %s (%lu us through the cache)\n", name,
+                static_cast<unsigned long>(dsc->header.w), static_cast<unsigned long>(h),
+                crc_ok ? "OK" : "BAD", static_cast<unsigned long>(crc_us));
+  Serial.printf("[ASSETS] Read: " STORAGE_FS_NAME " %lu us/image (%ld B heap while open) | mapped %lu us/image, 0 B | checksum %s\n",
+                static_cast<unsigned long>(fs_us / ASSET_BENCH_PASSES), static_cast<long>(open_heap),
+                static_cast<unsigned long>(map_us / ASSET_BENCH_PASSES), fs_sum == map_sum ? "match" : "MISMATCH");
+  Serial.printf("[ASSETS] Full-screen redraw: " STORAGE_FS_NAME " %lu us | mapped %lu us\n",
+                static_cast<unsigned long>(fs_draw_us), static_cast<unsigned long>(map_draw_us));
+}
@@ -0,0 +1,144 @@
+/*
+ * ARCHI - Boot Profiler
+ *
+ * Fixed table filled under a spinlock: stages are opened from setup(), the
+ * UI task and the boot task concurrently. Printing happens once, from the
+ * boot task, after the interactive milestone.
+ */
+
+#include "boot_profiler.h"
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+  const char* name;
+  int64_t start_us;
+  int64_t end_us;
+  uint8_t core;
+  bool done;
+} boot_stage_t;
+
+static const char* const k_milestone_names[BOOT_MILESTONE_COUNT] = {
+  "first frame",
+  "interactive",
+};
+
+static portMUX_TYPE s_boot_lock = portMUX_INITIALIZER_UNLOCKED;
+static boot_stage_t s_stages[BOOT_PROF_MAX_STAGES];
+static uint8_t s_stage_count = 0;
+static int64_t s_milestones[BOOT_MILESTONE_COUNT] = {0};
+
+static void format_ms(char* out, size_t len, int64_t us)
+{
+  if (us <= 0) {
+    snprintf(out, len, "n/a");
+    return;
+  }
+  snprintf(out, len, "%lu.%lu ms", static_cast<unsigned long>(us / 1000),
+           static_cast<unsigned long>((us % 1000) / 100));
+}
+
+int boot_prof_begin(const char* name)
+{
+  int64_t now = esp_timer_get_time();
+  int handle = -1;
+
+  portENTER_CRITICAL(&s_boot_lock);
+  if (s_stage_count < BOOT_PROF_MAX_STAGES) {
+    handle = s_stage_count++;
+    s_stages[handle].name = name;
+    s_stages[handle].start_us = now;
+    s_stages[handle].end_us = 0;
+    s_stages[handle].done = false;
+    s_stages[handle].core = static_cast<uint8_t>(xPortGetCoreID());
+  }
+  portEXIT_CRITICAL(&s_boot_lock);
+  return handle;
+}
+
+void boot_prof_end(int handle)
+{
+  if (handle < 0 || handle >= BOOT_PROF_MAX_STAGES) return;
+  int64_t now = esp_timer_get_time();
+
+  portENTER_CRITICAL(&s_boot_lock);
+  if (handle < s_stage_count && !s_stages[handle].done) {
+    s_stages[handle].end_us = now;
+    s_stages[handle].done = true;
+  }
+  portEXIT_CRITICAL(&s_boot_lock);
+}
+
+void boot_prof_milestone(boot_milestone_t milestone)
+{
+  if (milestone >= BOOT_MILESTONE_COUNT) return;
+  int64_t now = esp_timer_get_time();
+
+  portENTER_CRITICAL(&s_boot_lock);
+  if (s_milestones[milestone] == 0) {
+    s_milestones[milestone] = now;
+  }
+  portEXIT_CRITICAL(&s_boot_lock);
+}
+
+uint32_t boot_prof_milestone_us(boot_milestone_t milestone)
+{
+  if (milestone >= BOOT_MILESTONE_COUNT) return 0;
+  portENTER_CRITICAL(&s_boot_lock);
+  int64_t t = s_milestones[milestone];
+  portEXIT_CRITICAL(&s_boot_lock);
+  return static_cast<uint32_t>(t);
+}
+
+void boot_prof_dump(void)
+{
+  boot_stage_t stages[BOOT_PROF_MAX_STAGES];
+  int64_t milestones[BOOT_MILESTONE_COUNT];
+  uint8_t count;
+
+  portENTER_CRITICAL(&s_boot_lock);
+  count = s_stage_count;
+  memcpy(stages, s_stages, sizeof(stages[0]) * count);
+  memcpy(milestones, s_milestones, sizeof(milestones));
+  portEXIT_CRITICAL(&s_boot_lock);
+
+  // Stages are opened in roughly chronological order; sort what raced.
+  for (uint8_t i = 1; i < count; ++i) {
+    boot_stage_t key = stages[i];
+    int j = i - 1;
+    while (j >= 0 && stages[j].start_us > key.start_us) {
+      stages[j + 1] = stages[j];
+      --j;
+    }
+    stages[j + 1] = key;
+  }
+
+  Serial.println("[BOOT] Timeline (us since app start)");
+  for (uint8_t i = 0; i < count; ++i) {
+    const boot_stage_t& s = stages[i];
+    if (s.done) {
+      Serial.printf("[BOOT]   %9lld  core %u  %-16s %9lld us\n",
+                    static_cast<long long>(s.start_us), s.core, s.name,
+                    static_cast<long long>(s.end_us - s.start_us));
+    } else {
+      Serial.printf("[BOOT]   %9lld  core %u  %-16s   running\n",
+                    static_cast<long long>(s.start_us), s.core, s.name);
+    }
+  }
+  for (int m = 0; m < BOOT_MILESTONE_COUNT; ++m) {
+    if (milestones[m]) {
+      Serial.printf("[BOOT]   %9lld  %s\n", static_cast<long long>(milestones[m]), k_milestone_names[m]);
+    }
+  }
+
+  char ttff[16];
+  char tti[16];
+  format_ms(ttff, sizeof(ttff), milestones[BOOT_MILESTONE_FIRST_FRAME]);
+  format_ms(tti, sizeof(tti), milestones[BOOT_MILESTONE_INTERACTIVE]);
+  Serial.printf("[BOOT] TTFF %s | TTI %s\n", ttff, tti);
+}
@@ -0,0 +1,388 @@
+/*
+ * ARCHI - CPU Profiler Implementation
+ *
+ * Each sample stores the cumulative run-time counter of every task in a
+ * small history ring, so any window up to CPUPROF_LONG_WINDOW samples is a
+ * difference of two entries. All buffers are static: sampling runs on the
+ * sysmon task stack and never allocates.
+ */
+
+#include "cpuprof.h"
+#include "sysmon.h"
+
+#include <Arduino.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_idf_version.h>
+#endif
+
+#if configGENERATE_RUN_TIME_STATS && configUSE_TRACE_FACILITY
+#define CPUPROF_AVAILABLE 1
+#else
+#define CPUPROF_AVAILABLE 0
+#endif
+
+#define CPUPROF_HISTORY (CPUPROF_LONG_WINDOW + 1)
+
+// IDF 5.1 renamed the per-core idle handle and affinity getters.
+#if defined(ESP_IDF_VERSION_VAL)
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 1, 0)
+#define CPUPROF_IDF_CORE_API 1
+#endif
+#endif
+
+typedef struct {
+  TaskHandle_t handle;
+  uint32_t count;
+} cpuprof_wake_slot_t;
+
+static cpuprof_wake_slot_t s_wakes[CPUPROF_MAX_TASKS];
+static portMUX_TYPE s_wake_mux = portMUX_INITIALIZER_UNLOCKED;
+static portMUX_TYPE s_snapshot_mux = portMUX_INITIALIZER_UNLOCKED;
+static cpuprof_snapshot_t s_snapshot;
+
+void cpuprof_note_wake(void)
+{
+  TaskHandle_t self = xTaskGetCurrentTaskHandle();
+
+  portENTER_CRITICAL(&s_wake_mux);
+  for (uint8_t i = 0; i < CPUPROF_MAX_TASKS; ++i) {
+    if (s_wakes[i].handle == self) {
+      ++s_wakes[i].count;
+      break;
+    }
+    if (!s_wakes[i].handle) {
+      s_wakes[i].handle = self;
+      s_wakes[i].count = 1;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&s_wake_mux);
+}
+
+void cpuprof_get_snapshot(cpuprof_snapshot_t* out)
+{
+  if (!out) return;
+  portENTER_CRITICAL(&s_snapshot_mux);
+  *out = s_snapshot;
+  portEXIT_CRITICAL(&s_snapshot_mux);
+}
+
+#if CPUPROF_AVAILABLE
+
+typedef struct {
+  TaskHandle_t handle;
+  uint32_t runtime[CPUPROF_HISTORY];   // Cumulative counter, indexed like s_total
+  uint8_t samples;                     // Valid history entries for this task
+  uint8_t ready_no_cpu;                // Consecutive samples Ready without running
+  uint32_t last_wakes;
+  bool seen;
+} cpuprof_track_t;
+
+static TaskStatus_t s_status[CPUPROF_MAX_SYSTEM_TASKS];
+static cpuprof_track_t s_track[CPUPROF_MAX_SYSTEM_TASKS];
+static uint8_t s_status_track[CPUPROF_MAX_SYSTEM_TASKS];   // s_status index -> s_track index
+static uint32_t s_total[CPUPROF_HISTORY];
+static uint8_t s_head = 0;
+static uint8_t s_total_samples = 0;
+static cpuprof_snapshot_t s_work;
+static bool s_overflow_reported = false;
+static bool s_headroom_reported = false;
+
+static TaskHandle_t idle_task_for_core(BaseType_t core)
+{
+#ifdef CPUPROF_IDF_CORE_API
+  return xTaskGetIdleTaskHandleForCore(core);
+#else
+  return xTaskGetIdleTaskHandleForCPU(core);
+#endif
+}
+
+static uint8_t task_core(TaskHandle_t task)
+{
+#ifdef CPUPROF_IDF_CORE_API
+  BaseType_t core = xTaskGetCoreID(task);
+#else
+  BaseType_t core = xTaskGetAffinity(task);
+#endif
+  return (core >= 0 && core < CPUPROF_CORE_COUNT) ? static_cast<uint8_t>(core) : CPUPROF_CORE_ANY;
+}
+
+static inline uint8_t history_index(uint8_t back)
+{
+  return static_cast<uint8_t>((s_head + CPUPROF_HISTORY - back) % CPUPROF_HISTORY);
+}
+
+// Share of one core over the last `window` samples, in tenths of a percent.
+static uint16_t track_share_x10(const cpuprof_track_t* t, uint8_t window)
+{
+  uint8_t avail = (t->samples < s_total_samples) ? t->samples : s_total_samples;
+  if (avail < 2) return 0;
+  if (window > avail - 1) window = avail - 1;
+
+  uint8_t then = history_index(window);
+  uint32_t total = s_total[s_head] - s_total[then];
+  if (total == 0) return 0;
+  uint64_t busy = t->runtime[s_head] - t->runtime[then];
+  uint64_t share = busy * 1000u / total;
+  return static_cast<uint16_t>(share > 1000u ? 1000u : share);
+}
+
+static cpuprof_track_t* track_for(TaskHandle_t handle)
+{
+  cpuprof_track_t* free_slot = NULL;
+  for (uint8_t i = 0; i < CPUPROF_MAX_SYSTEM_TASKS; ++i) {
+    if (s_track[i].handle == handle) return &s_track[i];
+    if (!s_track[i].handle && !free_slot) free_slot = &s_track[i];
+  }
+  if (free_slot) {
+    memset(free_slot, 0, sizeof(*free_slot));
+    free_slot->handle = handle;
+  }
+  return free_slot;
+}
+
+// Free the wake counters of tasks that no longer exist.
+static void collect_wakes(void)
+{
+  portENTER_CRITICAL(&s_wake_mux);
+  for (uint8_t i = 0; i < CPUPROF_MAX_TASKS; ++i) {
+    if (!s_wakes[i].handle) continue;
+    bool live = false;
+    for (uint8_t j = 0; j < CPUPROF_MAX_SYSTEM_TASKS; ++j) {
+      if (s_track[j].handle == s_wakes[i].handle && s_track[j].seen) {
+        live = true;
+        break;
+      }
+    }
+    if (!live) {
+      s_wakes[i].handle = NULL;
+      s_wakes[i].count = 0;
+    }
+  }
+  portEXIT_CRITICAL(&s_wake_mux);
+}
+
+static uint32_t wake_count_for(TaskHandle_t handle, bool* found)
+{
+  uint32_t count = 0;
+  *found = false;
+  portENTER_CRITICAL(&s_wake_mux);
+  for (uint8_t i = 0; i < CPUPROF_MAX_TASKS; ++i) {
+    if (s_wakes[i].handle == handle) {
+      count = s_wakes[i].count;
+      *found = true;
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&s_wake_mux);
+  return count;
+}
+
+void cpuprof_sample(void)
+{
+  uint32_t total_runtime = 0;
+  UBaseType_t tasks = uxTaskGetNumberOfTasks();
+  UBaseType_t count = 0;
+  if (tasks <= CPUPROF_MAX_SYSTEM_TASKS) {
+    // Tasks created since uxTaskGetNumberOfTasks() can still overflow it: 0 then too
+    count = uxTaskGetSystemState(s_status, CPUPROF_MAX_SYSTEM_TASKS, &total_runtime);
+  }
+  if (count == 0) {
+    if (!s_overflow_reported) {
+      Serial.printf("[CPUPROF] %u tasks, more than the %u sampled: samples skipped until some exit\n",
+                    static_cast<unsigned>(tasks), static_cast<unsigned>(CPUPROF_MAX_SYSTEM_TASKS));
+      s_overflow_reported = true;
+    }
+    return;
+  }
+  s_overflow_reported = false;
+  if (!s_headroom_reported && count > CPUPROF_MAX_SYSTEM_TASKS - CPUPROF_TASK_HEADROOM) {
+    Serial.printf("[CPUPROF] WARN %u tasks, room for %u: raise CPUPROF_MAX_SYSTEM_TASKS\n",
+                  static_cast<unsigned>(count), static_cast<unsigned>(CPUPROF_MAX_SYSTEM_TASKS));
+    s_headroom_reported = true;
+  }
+
+  s_head = static_cast<uint8_t>((s_head + 1) % CPUPROF_HISTORY);
+  s_total[s_head] = total_runtime;
+  if (s_total_samples < CPUPROF_HISTORY) ++s_total_samples;
+
+  for (uint8_t i = 0; i < CPUPROF_MAX_SYSTEM_TASKS; ++i) {
+    s_track[i].seen = false;
+  }
+
+  for (UBaseType_t i = 0; i < count; ++i) {
+    cpuprof_track_t* t = track_for(s_status[i].xHandle);
+    s_status_track[i] = t ? static_cast<uint8_t>(t - s_track) : UINT8_MAX;
+    if (!t) continue;
+
+    uint32_t previous = t->runtime[history_index(1)];
+    if (t->samples > 0 && s_status[i].ulRunTimeCounter < previous) {
+      t->samples = 0;   // Handle reused by a new task between two samples
+      t->last_wakes = 0;
+    }
+    t->runtime[s_head] = s_status[i].ulRunTimeCounter;
+    if (t->samples < CPUPROF_HISTORY) ++t->samples;
+    t->seen = true;
+
+    bool ran = (t->samples >= 2) && (t->runtime[s_head] != previous);
+    if (s_status[i].eCurrentState == eReady && t->samples >= 2 && !ran) {
+      if (t->ready_no_cpu < UINT8_MAX) ++t->ready_no_cpu;
+    } else {
+      t->ready_no_cpu = 0;
+    }
+  }
+
+  for (uint8_t i = 0; i < CPUPROF_MAX_SYSTEM_TASKS; ++i) {
+    if (s_track[i].handle && !s_track[i].seen) s_track[i].handle = NULL;
+  }
+  collect_wakes();
+
+  // Build the snapshot
+  memset(&s_work, 0, sizeof(s_work));
+  s_work.available = true;
+  s_work.system_tasks = static_cast<uint8_t>(count);
+
+  TaskHandle_t idle[CPUPROF_CORE_COUNT];
+  for (BaseType_t c = 0; c < CPUPROF_CORE_COUNT; ++c) {
+    idle[c] = idle_task_for_core(c);
+  }
+
+  for (UBaseType_t i = 0; i < count; ++i) {
+    if (s_status_track[i] == UINT8_MAX) continue;
+    cpuprof_track_t* t = &s_track[s_status_track[i]];
+    uint16_t share_short = track_share_x10(t, CPUPROF_SHORT_WINDOW);
+    uint16_t share_long = track_share_x10(t, CPUPROF_LONG_WINDOW);
+
+    bool is_idle = false;
+    for (uint8_t c = 0; c < CPUPROF_CORE_COUNT; ++c) {
+      if (s_status[i].xHandle == idle[c]) {
+        s_work.core_load_short_x10[c] = static_cast<uint16_t>(1000 - share_short);
+        s_work.core_load_long_x10[c] = static_cast<uint16_t>(1000 - share_long);
+        is_idle = true;
+      }
+    }
+    if (is_idle) continue;
+
+    // Wake counts advance whether or not the task makes the snapshot
+    bool has_wakes = false;
+    uint32_t wakes = wake_count_for(s_status[i].xHandle, &has_wakes);
+    uint32_t wakes_per_s = 0;
+    if (has_wakes) {
+      uint32_t since = (t->samples >= 2) ? wakes - t->last_wakes : 0;
+      wakes_per_s = since * 1000u / SYSMON_SAMPLE_PERIOD_MS;
+      t->last_wakes = wakes;
+    }
+
+    // Snapshot full: the task takes the place of the least busy one, if busier
+    cpuprof_task_t* out;
+    if (s_work.task_count < CPUPROF_MAX_TASKS) {
+      out = &s_work.tasks[s_work.task_count++];
+    } else {
+      out = &s_work.tasks[0];
+      for (uint8_t j = 1; j < CPUPROF_MAX_TASKS; ++j) {
+        if (s_work.tasks[j].pct_long_x10 < out->pct_long_x10) out = &s_work.tasks[j];
+      }
+      if (out->pct_long_x10 >= share_long) continue;
+      memset(out, 0, sizeof(*out));
+    }
+    strncpy(out->name, s_status[i].pcTaskName, CPUPROF_NAME_LEN - 1);
+    out->core = task_core(s_status[i].xHandle);
+    out->cur_priority = static_cast<uint8_t>(s_status[i].uxCurrentPriority);
+#if configUSE_MUTEXES
+    out->priority = static_cast<uint8_t>(s_status[i].uxBasePriority);
+    if (s_status[i].uxCurrentPriority > s_status[i].uxBasePriority) {
+      out->flags |= CPUPROF_FLAG_PRIO_INHERIT;
+    }
+#else
+    out->priority = out->cur_priority;
+#endif
+    out->pct_short_x10 = share_short;
+    out->pct_long_x10 = share_long;
+    if (t->samples > CPUPROF_LONG_WINDOW && share_long >= CPUPROF_HOG_PCT * 10) {
+      out->flags |= CPUPROF_FLAG_HOG;
+    }
+    if (t->ready_no_cpu >= CPUPROF_STARVE_SAMPLES) {
+      out->flags |= CPUPROF_FLAG_STARVED;
+    }
+    out->wakes_per_s = wakes_per_s;
+  }
+
+  // Name the busiest task that can preempt each starved one on its core.
+  for (uint8_t i = 0; i < s_work.task_count; ++i) {
+    cpuprof_task_t* victim = &s_work.tasks[i];
+    if (!(victim->flags & CPUPROF_FLAG_STARVED)) continue;
+    const cpuprof_task_t* hog = NULL;
+    for (uint8_t j = 0; j < s_work.task_count; ++j) {
+      const cpuprof_task_t* other = &s_work.tasks[j];
+      if (j == i || other->cur_priority < victim->cur_priority) continue;
+      if (victim->core != CPUPROF_CORE_ANY && other->core != CPUPROF_CORE_ANY && other->core != victim->core) continue;
+      if (!hog || other->pct_short_x10 > hog->pct_short_x10) hog = other;
+    }
+    if (hog) strncpy(victim->starved_by, hog->name, CPUPROF_NAME_LEN - 1);
+  }
+
+  // Busiest first (insertion sort: a couple of dozen entries)
+  for (uint8_t i = 1; i < s_work.task_count; ++i) {
+    cpuprof_task_t key = s_work.tasks[i];
+    int8_t j = static_cast<int8_t>(i - 1);
+    while (j >= 0 && s_work.tasks[j].pct_long_x10 < key.pct_long_x10) {
+      s_work.tasks[j + 1] = s_work.tasks[j];
+      --j;
+    }
+    s_work.tasks[j + 1] = key;
+  }
+
+  portENTER_CRITICAL(&s_snapshot_mux);
+  s_snapshot = s_work;
+  portEXIT_CRITICAL(&s_snapshot_mux);
+}
+
+#else // !CPUPROF_AVAILABLE
+
+void cpuprof_sample(void) {}
+
+#endif // CPUPROF_AVAILABLE
+
+void cpuprof_print_report(void)
+{
+  static cpuprof_snapshot_t snap;  // ~1 KB: keep it off the caller's stack
+  cpuprof_get_snapshot(&snap);
+
+  if (!snap.available) {
+    Serial.println("[CPUPROF] FreeRTOS run-time stats disabled in sdkconfig");
+    return;
+  }
+
+  Serial.printf("[CPUPROF] core0 %u.%u%% (10s %u.%u%%) | core1 %u.%u%% (10s %u.%u%%)\n",
+                snap.core_load_short_x10[0] / 10, snap.core_load_short_x10[0] % 10,
+                snap.core_load_long_x10[0] / 10, snap.core_load_long_x10[0] % 10,
+                snap.core_load_short_x10[1] / 10, snap.core_load_short_x10[1] % 10,
+                snap.core_load_long_x10[1] / 10, snap.core_load_long_x10[1] % 10);
+  if (snap.system_tasks > snap.task_count + CPUPROF_CORE_COUNT) {
+    Serial.printf("[CPUPROF] %u tasks, the %u busiest below\n", snap.system_tasks, snap.task_count);
+  }
+
+  for (uint8_t i = 0; i < snap.task_count; ++i) {
+    const cpuprof_task_t* t = &snap.tasks[i];
+    char core = (t->core == CPUPROF_CORE_ANY) ? '*' : static_cast<char>('0' + t->core);
+    Serial.printf("[CPUPROF] %-12s c%c p%-2u %3u.%u%% %3u.%u%% %5lu wake/s%s%s\n",
+                  t->name, core, t->priority,
+                  t->pct_short_x10 / 10, t->pct_short_x10 % 10,
+                  t->pct_long_x10 / 10, t->pct_long_x10 % 10,
+                  static_cast<unsigned long>(t->wakes_per_s),
+                  (t->flags & CPUPROF_FLAG_HOG) ? " HOG" : "",
+                  (t->flags & CPUPROF_FLAG_STARVED) ? " STARVED" : "");
+
+    if (t->flags & CPUPROF_FLAG_STARVED) {
+      Serial.printf("[CPUPROF] WARN %s ready but not running on core %c (busiest preempting task: %s)\n",
+                    t->name, core, t->starved_by[0] ? t->starved_by : "?");
+    }
+    if (t->flags & CPUPROF_FLAG_PRIO_INHERIT) {
+      Serial.printf("[CPUPROF] WARN %s boosted %u -> %u: holds a mutex a higher-priority task waits on\n",
+                    t->name, t->priority, t->cur_priority);
+    }
+  }
+}
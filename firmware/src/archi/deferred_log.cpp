@@ -0,0 +1,278 @@
+/*
+ * ARCHI - Deferred Logging Implementation
+ *
+ * One bounded MPSC ring per core (Vyukov-style cells with a sequence word):
+ * producers reserve a slot with a CAS on the enqueue index, the single drain
+ * task consumes in order and merges both rings by capture timestamp.
+ */
+
+#include "deferred_log.h"
+#include "sysmon.h"
+#include "rtos_static.h"
+#include "bench_clock.h"
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdio.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+static_assert((DLOG_RING_SIZE & (DLOG_RING_SIZE - 1)) == 0, "DLOG_RING_SIZE must be a power of two");
+
+#define DLOG_CORE_COUNT 2
+#define DLOG_LINE_MAX   160
+
+// Cell sequence words are stored relative to the cell index so that the
+// zero-initialised static storage is already a valid empty ring: logging
+// works before dlog_init() and from any core without a setup race.
+typedef struct {
+  std::atomic<uint32_t> seq_rel;
+  dlog_record_t rec;
+} dlog_cell_t;
+
+typedef struct {
+  dlog_cell_t cells[DLOG_RING_SIZE];
+  std::atomic<uint32_t> enqueue_pos;
+  uint32_t dequeue_pos;   // Drain side only
+} dlog_ring_t;
+
+static dlog_ring_t s_rings[DLOG_CORE_COUNT];
+static std::atomic<uint32_t> s_written(0);
+static std::atomic<uint32_t> s_dropped(0);
+static std::atomic<uint32_t> s_printed(0);
+static uint32_t s_dropped_reported = 0;
+static std::atomic<bool> s_draining(false);  // Single-consumer guard (drain task vs dlog_flush)
+static TaskHandle_t s_dlog_task = NULL;
+static StaticTask_t s_dlog_tcb;
+static StackType_t s_dlog_stack[DLOG_TASK_STACK_SIZE / sizeof(StackType_t)];
+
+static inline uint32_t cell_load_seq(dlog_cell_t* cell, uint32_t index)
+{
+  return cell->seq_rel.load(std::memory_order_acquire) + index;
+}
+
+static inline void cell_store_seq(dlog_cell_t* cell, uint32_t index, uint32_t seq)
+{
+  cell->seq_rel.store(seq - index, std::memory_order_release);
+}
+
+uint32_t dlog_timestamp_us(void)
+{
+  return micros();
+}
+
+bool dlog_commit(const dlog_record_t* rec)
+{
+  if (!rec) return false;
+  dlog_ring_t& ring = s_rings[xPortGetCoreID() % DLOG_CORE_COUNT];
+  uint32_t pos = ring.enqueue_pos.load(std::memory_order_relaxed);
+  dlog_cell_t* cell;
+  uint32_t index;
+
+  for (;;) {
+    index = pos & (DLOG_RING_SIZE - 1);
+    cell = &ring.cells[index];
+    uint32_t seq = cell_load_seq(cell, index);
+    int32_t diff = static_cast<int32_t>(seq - pos);
+    if (diff == 0) {
+      if (ring.enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      s_dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      pos = ring.enqueue_pos.load(std::memory_order_relaxed);
+    }
+  }
+
+  cell->rec = *rec;
+  cell_store_seq(cell, index, pos + 1);
+  s_written.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+static dlog_record_t* ring_peek(dlog_ring_t& ring)
+{
+  uint32_t index = ring.dequeue_pos & (DLOG_RING_SIZE - 1);
+  uint32_t seq = cell_load_seq(&ring.cells[index], index);
+  return (seq == ring.dequeue_pos + 1) ? &ring.cells[index].rec : NULL;
+}
+
+static void ring_pop(dlog_ring_t& ring)
+{
+  uint32_t index = ring.dequeue_pos & (DLOG_RING_SIZE - 1);
+  cell_store_seq(&ring.cells[index], index, ring.dequeue_pos + DLOG_RING_SIZE);
+  ++ring.dequeue_pos;
+}
+
+// Expand the record one conversion at a time so each argument can be passed
+// with its real width, whatever length modifier the format uses.
+static size_t dlog_format(const dlog_record_t* rec, char* out, size_t out_size)
+{
+  const char* p = rec->fmt;
+  size_t len = 0;
+  uint8_t arg_idx = 0;
+  bool str_used = false;
+
+  while (*p && len + 1 < out_size) {
+    if (*p != '%') {
+      out[len++] = *p++;
+      continue;
+    }
+    if (p[1] == '%') {
+      out[len++] = '%';
+      p += 2;
+      continue;
+    }
+
+    // Copy "%[flags][width][.prec]" and skip length modifiers.
+    char spec[16];
+    size_t spec_len = 0;
+    spec[spec_len++] = *p++;
+    while (*p && strchr("-+ #0123456789.", *p) && spec_len < sizeof(spec) - 3) {
+      spec[spec_len++] = *p++;
+    }
+    while (*p && strchr("hlzjt", *p)) {
+      ++p;
+    }
+    if (!*p) break;
+    char conv = *p++;
+    spec[spec_len++] = conv;
+    spec[spec_len] = '\0';
+
+    int written = 0;
+    if (conv == 's') {
+      written = snprintf(out + len, out_size - len, spec, (rec->has_str && !str_used) ? rec->str : "?");
+      str_used = true;
+    } else {
+      uint32_t value = (arg_idx < rec->nargs) ? rec->args[arg_idx] : 0;
+      ++arg_idx;
+      if (conv == 'd' || conv == 'i') {
+        written = snprintf(out + len, out_size - len, spec, static_cast<int>(static_cast<int32_t>(value)));
+      } else {
+        written = snprintf(out + len, out_size - len, spec, static_cast<unsigned>(value));
+      }
+    }
+    if (written > 0) {
+      len += static_cast<size_t>(written);
+      if (len >= out_size) len = out_size - 1;
+    }
+  }
+
+  out[len] = '\0';
+  return len;
+}
+
+// Print pending records from both rings in capture order.
+static uint32_t dlog_drain(void)
+{
+  bool idle = false;
+  if (!s_draining.compare_exchange_strong(idle, true, std::memory_order_acquire)) {
+    return 0;
+  }
+
+  char line[DLOG_LINE_MAX];
+  uint32_t count = 0;
+
+  for (;;) {
+    dlog_ring_t* next = NULL;
+    dlog_record_t* next_rec = NULL;
+    for (dlog_ring_t& ring : s_rings) {
+      dlog_record_t* rec = ring_peek(ring);
+      if (!rec) continue;
+      if (!next_rec || static_cast<int32_t>(rec->timestamp_us - next_rec->timestamp_us) < 0) {
+        next = &ring;
+        next_rec = rec;
+      }
+    }
+    if (!next) break;
+
+    dlog_format(next_rec, line, sizeof(line));
+    ring_pop(*next);
+    Serial.println(line);
+    ++count;
+  }
+
+  uint32_t dropped = s_dropped.load(std::memory_order_relaxed);
+  if (dropped != s_dropped_reported) {
+    Serial.printf("[LOG] %lu records dropped (ring full)\n",
+                  static_cast<unsigned long>(dropped - s_dropped_reported));
+    s_dropped_reported = dropped;
+  }
+
+  s_printed.fetch_add(count, std::memory_order_relaxed);
+  s_draining.store(false, std::memory_order_release);
+  return count;
+}
+
+static void dlog_task(void* pvParameters)
+{
+  (void)pvParameters;
+  for (;;) {
+    dlog_drain();
+    vTaskDelay(pdMS_TO_TICKS(DLOG_DRAIN_PERIOD_MS));
+  }
+}
+
+void dlog_init(void)
+{
+  if (s_dlog_task) return;
+
+  s_dlog_task = rtos_static_task(
+      dlog_task,
+      "dlog",
+      DLOG_TASK_STACK_SIZE,
+      NULL,
+      DLOG_TASK_PRIORITY,
+      s_dlog_stack,
+      &s_dlog_tcb,
+      0);
+
+  if (!s_dlog_task) {
+    Serial.println("[ERROR] Failed to create log drain task!");
+    return;
+  }
+  sysmon_register_task(s_dlog_task, "dlog", DLOG_TASK_STACK_SIZE);
+}
+
+void dlog_flush(void)
+{
+  dlog_drain();
+}
+
+void dlog_get_stats(dlog_stats_t* out)
+{
+  if (!out) return;
+  out->written = s_written.load(std::memory_order_relaxed);
+  out->dropped = s_dropped.load(std::memory_order_relaxed);
+  out->printed = s_printed.load(std::memory_order_relaxed);
+}
+
+void dlog_run_benchmark(void)
+{
+  const uint32_t iterations = DLOG_RING_SIZE / 2;  // Stay below capacity: measure the accepted path
+  const uint8_t mac[6] = {0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
+
+  dlog_flush();
+
+  int64_t start = bench_clock_us();
+  for (uint32_t i = 0; i < iterations; ++i) {
+    DLOG_I("[BENCH] Device: %02X:%02X:%02X:%02X:%02X:%02X | RSSI %d | name '%s'",
+           mac[0], mac[1], mac[2], mac[3], mac[4], mac[5], -42, "bench");
+  }
+  uint32_t deferred_us = static_cast<uint32_t>(bench_clock_us() - start);
+  dlog_flush();  // Keep the printf run below from competing with pending records
+
+  start = bench_clock_us();
+  for (uint32_t i = 0; i < iterations; ++i) {
+    Serial.printf("[BENCH] Device: %02X:%02X:%02X:%02X:%02X:%02X | RSSI %d | name '%s'\n",
+                  mac[0], mac[1], mac[2], mac[3], mac[4], mac[5], -42, "bench");
+  }
+  uint32_t printf_us = static_cast<uint32_t>(bench_clock_us() - start);
+
+  Serial.printf("[LOG] Benchmark (%lu calls): DLOG_I %lu ns/call, Serial.printf %lu ns/call\n",
+                static_cast<unsigned long>(iterations),
+                static_cast<unsigned long>(deferred_us * 1000UL / iterations),
+                static_cast<unsigned long>(printf_us * 1000UL / iterations));
+}
@@ -0,0 +1,229 @@
+/*
+ * ARCHI - LVGL Heap Implementation
+ *
+ * The heap sets itself up on the first allocation, which is lv_init()
+ * running in the UI task: the primary pool is static (.bss), the optional
+ * extra regions come from the internal heap at that point and are never
+ * returned. LVGL runs in one task, so there is no lock.
+ */
+
+#include "lvgl_heap.h"
+#include "tlsf_heap.h"
+#include "deferred_log.h"
+#include "bench_clock.h"
+
+#include "lvgl.h"
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+
+static_assert(LVGL_HEAP_TAG_COUNT <= TLSF_HEAP_TAG_COUNT, "too many LVGL heap tags");
+static_assert(LVGL_HEAP_EXTRA_REGIONS < TLSF_HEAP_MAX_REGIONS, "extra regions exceed TLSF_HEAP_MAX_REGIONS");
+
+// Scratch heap and workload of lvgl_heap_run_benchmark()
+#define LVGL_HEAP_BENCH_HEAP_SIZE  (16U * 1024U)
+#define LVGL_HEAP_BENCH_SLOTS      64
+#define LVGL_HEAP_BENCH_ROUNDS     200
+
+static const char* const k_tag_names[LVGL_HEAP_TAG_COUNT] = {
+  "core",
+  "style",
+  "splash",
+  "main",
+  "wifi",
+  "ble",
+  "settings",
+  "list_row",
+};
+
+static tlsf_heap_t s_heap;
+static bool s_ready = false;
+static lvgl_heap_tag_t s_tag = LVGL_HEAP_TAG_CORE;
+static uint8_t s_pool[LV_MEM_SIZE] __attribute__((aligned(8)));
+
+static void heap_setup(void)
+{
+  tlsf_heap_init(&s_heap);
+  tlsf_heap_add_region(&s_heap, s_pool, sizeof(s_pool));
+
+#if LVGL_HEAP_EXTRA_REGIONS > 0
+  for (uint8_t i = 0; i < LVGL_HEAP_EXTRA_REGIONS; ++i) {
+    void* region = heap_caps_malloc(LVGL_HEAP_EXTRA_REGION_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!region || !tlsf_heap_add_region(&s_heap, region, LVGL_HEAP_EXTRA_REGION_SIZE)) {
+      if (region) heap_caps_free(region);
+      DLOG_W("ARCHI: LVGL heap extra region %u not available", i);
+      break;
+    }
+  }
+#endif
+  s_ready = true;
+
+  DLOG_I("ARCHI: LVGL heap %lu B in %u region(s)",
+         static_cast<unsigned long>(s_heap.total_bytes), s_heap.region_count);
+}
+
+static void note_failure(size_t size)
+{
+  DLOG_W("ARCHI: LVGL alloc of %lu B failed (tag %s, free %lu B, largest %lu B)",
+         static_cast<unsigned long>(size), k_tag_names[s_tag],
+         static_cast<unsigned long>(s_heap.free_bytes),
+         static_cast<unsigned long>(tlsf_heap_largest_free(&s_heap)));
+}
+
+void* lvgl_heap_alloc(size_t size)
+{
+  if (!s_ready) heap_setup();
+
+  void* ptr = tlsf_heap_malloc(&s_heap, size, static_cast<uint8_t>(s_tag));
+  if (!ptr) note_failure(size);
+  return ptr;
+}
+
+void lvgl_heap_free(void* ptr)
+{
+  if (!ptr) return;
+  tlsf_heap_free(&s_heap, ptr);
+}
+
+void* lvgl_heap_realloc(void* ptr, size_t size)
+{
+  if (!s_ready) heap_setup();
+
+  // The block keeps the tag of whoever allocated it (label text, arrays...)
+  void* moved = tlsf_heap_realloc(&s_heap, ptr, size, static_cast<uint8_t>(s_tag));
+  if (!moved && size) note_failure(size);
+  return moved;
+}
+
+lvgl_heap_tag_t lvgl_heap_push_tag(lvgl_heap_tag_t tag)
+{
+  lvgl_heap_tag_t previous = s_tag;
+  if (tag < LVGL_HEAP_TAG_COUNT) s_tag = tag;
+  return previous;
+}
+
+void lvgl_heap_pop_tag(lvgl_heap_tag_t previous)
+{
+  s_tag = previous < LVGL_HEAP_TAG_COUNT ? previous : LVGL_HEAP_TAG_CORE;
+}
+
+uint32_t lvgl_heap_free_bytes(void)
+{
+  return s_heap.free_bytes;
+}
+
+void lvgl_heap_get_stats(lvgl_heap_stats_t* out)
+{
+  if (!out) return;
+
+  uint32_t largest = static_cast<uint32_t>(tlsf_heap_largest_free(&s_heap));
+  out->total = s_heap.total_bytes;
+  out->free = s_heap.free_bytes;
+  out->largest_free = largest;
+  out->used = s_heap.used_bytes;
+  out->peak_used = s_heap.peak_used_bytes;
+  out->used_blocks = s_heap.used_blocks;
+  out->free_blocks = s_heap.free_blocks;
+  out->allocs = s_heap.alloc_calls;
+  out->frees = s_heap.free_calls;
+  out->failed = s_heap.failed_allocs;
+  out->regions = s_heap.region_count;
+  out->frag_pct = s_heap.free_bytes
+      ? static_cast<uint8_t>(100U - (static_cast<uint64_t>(largest) * 100U) / s_heap.free_bytes)
+      : 0;
+}
+
+bool lvgl_heap_get_tag_stats(lvgl_heap_tag_t tag, lvgl_heap_tag_stats_t* out)
+{
+  if (tag >= LVGL_HEAP_TAG_COUNT || !out) return false;
+
+  const tlsf_heap_tag_stats_t* st = &s_heap.tags[tag];
+  out->name = k_tag_names[tag];
+  out->bytes = st->bytes;
+  out->peak_bytes = st->peak_bytes;
+  out->blocks = st->blocks;
+  return true;
+}
+
+uint32_t lvgl_heap_check(void)
+{
+  return tlsf_heap_check(&s_heap);
+}
+
+void lvgl_heap_log_stats(void)
+{
+  lvgl_heap_stats_t st;
+  lvgl_heap_get_stats(&st);
+
+  DLOG_I("ARCHI: LVGL heap used %lu/%lu B (peak %lu), largest free %lu B, frag %u%%, %lu free blocks, %lu failed",
+         static_cast<unsigned long>(st.used), static_cast<unsigned long>(st.total),
+         static_cast<unsigned long>(st.peak_used), static_cast<unsigned long>(st.largest_free),
+         st.frag_pct, static_cast<unsigned long>(st.free_blocks),
+         static_cast<unsigned long>(st.failed));
+
+  for (uint8_t i = 0; i < LVGL_HEAP_TAG_COUNT; ++i) {
+    const tlsf_heap_tag_stats_t* tag = &s_heap.tags[i];
+    if (!tag->peak_bytes) continue;
+    DLOG_I("ARCHI:   %-8s %lu B in %u blocks (peak %lu B)", k_tag_names[i],
+           static_cast<unsigned long>(tag->bytes), tag->blocks,
+           static_cast<unsigned long>(tag->peak_bytes));
+  }
+}
+
+void lvgl_heap_run_benchmark(void)
+{
+  void* region = heap_caps_malloc(LVGL_HEAP_BENCH_HEAP_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (!region) {
+    Serial.println("[HEAP] Benchmark skipped: no scratch region");
+    return;
+  }
+
+  static tlsf_heap_t bench;
+  void* slots[LVGL_HEAP_BENCH_SLOTS] = {};
+  uint32_t seed = 0x2545F491U;
+  uint32_t mallocs = 0;
+  uint32_t frees = 0;
+  int64_t malloc_us = 0;
+  int64_t free_us = 0;
+
+  tlsf_heap_init(&bench);
+  tlsf_heap_add_region(&bench, region, LVGL_HEAP_BENCH_HEAP_SIZE);
+
+  // LVGL-like mix: mostly small objects and styles, a few label texts
+  for (uint32_t round = 0; round < LVGL_HEAP_BENCH_ROUNDS; ++round) {
+    int64_t t0 = bench_clock_us();
+    for (uint32_t i = 0; i < LVGL_HEAP_BENCH_SLOTS; ++i) {
+      if (slots[i]) continue;
+      seed = seed * 1664525U + 1013904223U;
+      size_t size = (seed >> 28) == 0 ? 256U + ((seed >> 8) & 0xFFU) : 8U + ((seed >> 8) & 0x7FU);
+      slots[i] = tlsf_heap_malloc(&bench, size, 0);
+      mallocs++;
+    }
+    int64_t t1 = bench_clock_us();
+    for (uint32_t i = 0; i < LVGL_HEAP_BENCH_SLOTS; ++i) {
+      seed = seed * 1664525U + 1013904223U;
+      if ((seed >> 31) && slots[i]) {
+        tlsf_heap_free(&bench, slots[i]);
+        slots[i] = NULL;
+        frees++;
+      }
+    }
+    malloc_us += t1 - t0;
+    free_us += bench_clock_us() - t1;
+  }
+
+  uint32_t largest = static_cast<uint32_t>(tlsf_heap_largest_free(&bench));
+  uint32_t free_bytes = bench.free_bytes;
+  uint32_t errors = tlsf_heap_check(&bench);
+  Serial.printf("[HEAP] Benchmark: malloc %lu ns/op (%lu ops, %lu failed), free %lu ns/op (%lu ops), "
+                "frag %lu%% over %lu free blocks, %lu check errors\n",
+                static_cast<unsigned long>(mallocs ? malloc_us * 1000 / mallocs : 0),
+                static_cast<unsigned long>(mallocs),
+                static_cast<unsigned long>(bench.failed_allocs),
+                static_cast<unsigned long>(frees ? free_us * 1000 / frees : 0),
+                static_cast<unsigned long>(frees),
+                static_cast<unsigned long>(free_bytes ? 100U - (static_cast<uint64_t>(largest) * 100U) / free_bytes : 0),
+                static_cast<unsigned long>(bench.free_blocks),
+                static_cast<unsigned long>(errors));
+
+  heap_caps_free(region);
+}
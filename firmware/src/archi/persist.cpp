@@ -0,0 +1,695 @@
+/*
+ * ARCHI - Persistence Implementation
+ *
+ * The record store works on a small flash interface (read / program / erase)
+ * so the benchmark can run it on a RAM image that loses power at a chosen
+ * byte. The live store sits on the "petstate" partition.
+ *
+ * Record (one PERSIST_SLOT_SIZE slot, little-endian):
+ *   magic u32 | seq u32 | len u16 | ~len u16 | crc32 u32 | payload[len]
+ * The CRC covers seq, both lengths and the payload. Only header + payload
+ * are programmed; the rest of the slot stays erased.
+ */
+
+#include "persist.h"
+#include "bench_clock.h"
+#include "sysmon.h"
+#include "rtos_static.h"
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PERSIST_MAGIC          0x31545350u   // "PST1"
+#define PERSIST_BANKS          2
+#define PERSIST_SLOTS_PER_BANK (PERSIST_SECTOR_SIZE / PERSIST_SLOT_SIZE)
+#define PERSIST_SLOTS          (PERSIST_BANKS * PERSIST_SLOTS_PER_BANK)
+#define PERSIST_REGION_SIZE    (PERSIST_BANKS * PERSIST_SECTOR_SIZE)
+#define PERSIST_NO_SLOT        0xFFFFu
+
+typedef struct {
+  uint32_t magic;
+  uint32_t seq;
+  uint16_t len;
+  uint16_t len_inv;
+  uint32_t crc;
+} persist_header_t;
+
+static_assert(sizeof(persist_header_t) == PERSIST_HEADER_SIZE, "record header layout");
+static_assert(PERSIST_SECTOR_SIZE % PERSIST_SLOT_SIZE == 0, "slots must tile a sector");
+
+typedef struct {
+  bool (*read)(void* ctx, uint32_t offset, void* dst, uint32_t len);
+  bool (*write)(void* ctx, uint32_t offset, const void* src, uint32_t len);
+  bool (*erase)(void* ctx, uint32_t offset, uint32_t len);
+  void* ctx;
+} persist_flash_t;
+
+typedef struct {
+  persist_flash_t flash;
+  uint32_t seq;            // Sequence of the newest valid record
+  uint16_t newest_slot;    // PERSIST_NO_SLOT while the store is empty
+  uint16_t next_slot;
+  bool erase_next;         // next_slot opens a bank that must be erased first
+  uint16_t len;
+  uint8_t payload[PERSIST_PAYLOAD_MAX];
+} persist_store_t;
+
+// CRC-32 (IEEE, reflected), one nibble at a time: 64-byte table
+static const uint32_t k_crc_nibble[16] = {
+  0x00000000u, 0x1DB71064u, 0x3B6E20C8u, 0x26D930ACu, 0x76DC4190u, 0x6B6B51F4u, 0x4DB26158u, 0x5005713Cu,
+  0xEDB88320u, 0xF00F9344u, 0xD6D6A3E8u, 0xCB61B38Cu, 0x9B64C2B0u, 0x86D3D2D4u, 0xA00AE278u, 0xBDBDF21Cu,
+};
+
+static uint32_t crc32_update(uint32_t crc, const uint8_t* data, uint32_t len)
+{
+  for (uint32_t i = 0; i < len; ++i) {
+    crc ^= data[i];
+    crc = (crc >> 4) ^ k_crc_nibble[crc & 0x0F];
+    crc = (crc >> 4) ^ k_crc_nibble[crc & 0x0F];
+  }
+  return crc;
+}
+
+static uint32_t record_crc(const persist_header_t* hdr, const uint8_t* payload)
+{
+  uint32_t crc = crc32_update(0xFFFFFFFFu, reinterpret_cast<const uint8_t*>(&hdr->seq), 8);
+  return ~crc32_update(crc, payload, hdr->len);
+}
+
+static bool slot_is_blank(const uint8_t* slot)
+{
+  for (uint32_t i = 0; i < PERSIST_SLOT_SIZE; ++i) {
+    if (slot[i] != 0xFF) return false;
+  }
+  return true;
+}
+
+static bool slot_is_valid(const uint8_t* slot, persist_header_t* hdr)
+{
+  memcpy(hdr, slot, sizeof(*hdr));
+  if (hdr->magic != PERSIST_MAGIC) return false;
+  if (hdr->len == 0 || hdr->len > PERSIST_PAYLOAD_MAX) return false;
+  if (static_cast<uint16_t>(~hdr->len) != hdr->len_inv) return false;
+  return record_crc(hdr, slot + PERSIST_HEADER_SIZE) == hdr->crc;
+}
+
+// Slot i from the boot image, or read on its own when there is no image
+static const uint8_t* store_slot(const persist_store_t* s, const uint8_t* image, uint16_t i, uint8_t* tmp)
+{
+  if (image) return image + static_cast<uint32_t>(i) * PERSIST_SLOT_SIZE;
+  if (!s->flash.read(s->flash.ctx, static_cast<uint32_t>(i) * PERSIST_SLOT_SIZE, tmp, PERSIST_SLOT_SIZE)) {
+    memset(tmp, 0, PERSIST_SLOT_SIZE);   // Unreadable: neither valid nor blank
+  }
+  return tmp;
+}
+
+/*
+ * Find the newest valid record and where the next one goes. image is the
+ * whole region (one flash read); NULL falls back to one read per slot.
+ */
+static void store_open(persist_store_t* s, const persist_flash_t* flash, const uint8_t* image)
+{
+  uint8_t tmp[PERSIST_SLOT_SIZE];
+  persist_header_t hdr;
+
+  s->flash = *flash;
+  s->newest_slot = PERSIST_NO_SLOT;
+  s->seq = 0;
+  s->len = 0;
+
+  for (uint16_t i = 0; i < PERSIST_SLOTS; ++i) {
+    const uint8_t* slot = store_slot(s, image, i, tmp);
+    if (!slot_is_valid(slot, &hdr)) continue;
+    // Serial comparison: the sequence may wrap
+    if (s->newest_slot == PERSIST_NO_SLOT || static_cast<int32_t>(hdr.seq - s->seq) > 0) {
+      s->newest_slot = i;
+      s->seq = hdr.seq;
+      s->len = hdr.len;
+      memcpy(s->payload, slot + PERSIST_HEADER_SIZE, hdr.len);
+    }
+  }
+
+  if (s->newest_slot == PERSIST_NO_SLOT) {
+    // Empty or foreign content: start at bank 0, erased unless already blank
+    s->next_slot = 0;
+    s->erase_next = false;
+    for (uint16_t i = 0; i < PERSIST_SLOTS_PER_BANK; ++i) {
+      if (!slot_is_blank(store_slot(s, image, i, tmp))) {
+        s->erase_next = true;
+        break;
+      }
+    }
+    return;
+  }
+
+  // Append after the last programmed slot of the active bank (torn writes
+  // behind the newest record are skipped, never reused without an erase)
+  uint16_t bank_start = (s->newest_slot / PERSIST_SLOTS_PER_BANK) * PERSIST_SLOTS_PER_BANK;
+  uint16_t next = bank_start + PERSIST_SLOTS_PER_BANK;
+  while (next - 1 > s->newest_slot && slot_is_blank(store_slot(s, image, next - 1, tmp))) {
+    --next;
+  }
+  s->erase_next = (next == bank_start + PERSIST_SLOTS_PER_BANK);
+  s->next_slot = s->erase_next ? (next % PERSIST_SLOTS) : next;
+}
+
+/*
+ * Program one record and read it back. A slot that does not verify is
+ * skipped; the bank holding the newest valid record is never erased.
+ */
+static bool store_append(persist_store_t* s, const void* data, uint16_t len, uint32_t* erases)
+{
+  uint8_t rec[PERSIST_SLOT_SIZE];
+  uint8_t check[PERSIST_SLOT_SIZE];
+  persist_header_t hdr;
+
+  hdr.magic = PERSIST_MAGIC;
+  hdr.seq = (s->newest_slot == PERSIST_NO_SLOT) ? 1 : s->seq + 1;
+  hdr.len = len;
+  hdr.len_inv = static_cast<uint16_t>(~len);
+  memcpy(rec + PERSIST_HEADER_SIZE, data, len);
+  hdr.crc = record_crc(&hdr, rec + PERSIST_HEADER_SIZE);
+  memcpy(rec, &hdr, sizeof(hdr));
+  uint32_t rec_len = PERSIST_HEADER_SIZE + len;
+
+  for (uint16_t attempt = 0; attempt < PERSIST_SLOTS_PER_BANK; ++attempt) {
+    if (s->erase_next) {
+      uint16_t bank = s->next_slot / PERSIST_SLOTS_PER_BANK;
+      if (s->newest_slot != PERSIST_NO_SLOT && s->newest_slot / PERSIST_SLOTS_PER_BANK == bank) return false;
+      if (!s->flash.erase(s->flash.ctx, static_cast<uint32_t>(bank) * PERSIST_SECTOR_SIZE, PERSIST_SECTOR_SIZE)) {
+        return false;
+      }
+      s->erase_next = false;
+      if (erases) ++*erases;
+    }
+
+    uint16_t slot = s->next_slot++;
+    if (s->next_slot % PERSIST_SLOTS_PER_BANK == 0) {
+      s->next_slot %= PERSIST_SLOTS;
+      s->erase_next = true;
+    }
+
+    uint32_t offset = static_cast<uint32_t>(slot) * PERSIST_SLOT_SIZE;
+    if (s->flash.write(s->flash.ctx, offset, rec, rec_len) &&
+        s->flash.read(s->flash.ctx, offset, check, rec_len) &&
+        memcmp(rec, check, rec_len) == 0) {
+      s->newest_slot = slot;
+      s->seq = hdr.seq;
+      s->len = len;
+      memcpy(s->payload, data, len);
+      return true;
+    }
+  }
+  return false;
+}
+
+// ---------------------------------------------------------------------------
+// Live store on the partition
+// ---------------------------------------------------------------------------
+
+static const esp_partition_t* s_part = NULL;
+static persist_store_t s_store;                 // Under s_flash_lock
+static SemaphoreHandle_t s_flash_lock = NULL;
+static SemaphoreHandle_t s_lock = NULL;         // Staging area and stats
+static TaskHandle_t s_task = NULL;
+static StaticSemaphore_t s_flash_lock_cb;
+static StaticSemaphore_t s_lock_cb;
+static StaticTask_t s_task_tcb;
+static StackType_t s_task_stack[PERSIST_TASK_STACK_SIZE / sizeof(StackType_t)];
+
+static uint8_t s_stage[PERSIST_PAYLOAD_MAX];    // Pending blob
+static uint16_t s_stage_len = 0;
+static bool s_dirty = false;
+static uint32_t s_deadline_ms = 0;
+static uint8_t s_last[PERSIST_PAYLOAD_MAX];     // Last blob handed to flash
+static uint16_t s_last_len = 0;
+static uint8_t s_restored[PERSIST_PAYLOAD_MAX]; // Boot state for persist_load()
+static uint16_t s_restored_len = 0;
+static persist_stats_t s_stats;
+
+static bool part_read(void* ctx, uint32_t offset, void* dst, uint32_t len)
+{
+  return esp_partition_read(static_cast<const esp_partition_t*>(ctx), offset, dst, len) == ESP_OK;
+}
+
+static bool part_write(void* ctx, uint32_t offset, const void* src, uint32_t len)
+{
+  return esp_partition_write(static_cast<const esp_partition_t*>(ctx), offset, src, len) == ESP_OK;
+}
+
+static bool part_erase(void* ctx, uint32_t offset, uint32_t len)
+{
+  return esp_partition_erase_range(static_cast<const esp_partition_t*>(ctx), offset, len) == ESP_OK;
+}
+
+static void write_pending(const uint8_t* data, uint16_t len)
+{
+  uint32_t erases = 0;
+  xSemaphoreTake(s_flash_lock, portMAX_DELAY);
+  uint32_t start = micros();
+  bool ok = store_append(&s_store, data, len, &erases);
+  uint32_t elapsed = micros() - start;
+  uint32_t seq = s_store.seq;
+  xSemaphoreGive(s_flash_lock);
+
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  s_stats.erases += erases;
+  s_stats.write_us_last = elapsed;
+  if (elapsed > s_stats.write_us_max) s_stats.write_us_max = elapsed;
+  if (ok) {
+    s_stats.written++;
+    s_stats.seq = seq;
+  } else {
+    s_stats.failed++;
+    s_last_len = 0;
+    if (!s_dirty) {
+      // Retry one debounce window later unless a newer blob is already pending
+      memcpy(s_stage, data, len);
+      s_stage_len = len;
+      s_dirty = true;
+      s_deadline_ms = millis() + PERSIST_DEBOUNCE_MS;
+    }
+  }
+  xSemaphoreGive(s_lock);
+
+  if (!ok) Serial.println("[PERSIST] Record write failed, will retry");
+}
+
+static void persist_task(void* pvParameters)
+{
+  (void)pvParameters;
+  uint8_t buf[PERSIST_PAYLOAD_MAX];
+
+  for (;;) {
+    TickType_t wait = portMAX_DELAY;
+    uint16_t len = 0;
+
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    if (s_dirty) {
+      int32_t left = static_cast<int32_t>(s_deadline_ms - millis());
+      if (left <= 0) {
+        len = s_stage_len;
+        memcpy(buf, s_stage, len);
+        memcpy(s_last, s_stage, len);
+        s_last_len = len;
+        s_dirty = false;
+      } else {
+        wait = pdMS_TO_TICKS(left) + 1;
+      }
+    }
+    xSemaphoreGive(s_lock);
+
+    if (len) {
+      write_pending(buf, len);
+    } else {
+      ulTaskNotifyTake(pdTRUE, wait);
+    }
+  }
+}
+
+void persist_init(void)
+{
+  if (s_lock) return;
+
+  s_lock = rtos_static_mutex("persist", &s_lock_cb);
+  s_flash_lock = rtos_static_mutex("persist_flash", &s_flash_lock_cb);
+  if (!s_lock || !s_flash_lock) {
+    Serial.println("[ERROR] Failed to create persistence mutexes!");
+    return;
+  }
+
+  s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                    static_cast<esp_partition_subtype_t>(PERSIST_PARTITION_SUBTYPE),
+                                    PERSIST_PARTITION_LABEL);
+  if (!s_part || s_part->size < PERSIST_REGION_SIZE) {
+    Serial.println("[ERROR] No '" PERSIST_PARTITION_LABEL "' partition: state will not survive a reboot");
+    s_part = NULL;
+    return;
+  }
+
+  const persist_flash_t flash = {part_read, part_write, part_erase, const_cast<esp_partition_t*>(s_part)};
+  uint8_t* image = static_cast<uint8_t*>(malloc(PERSIST_REGION_SIZE));
+  if (image && !part_read(flash.ctx, 0, image, PERSIST_REGION_SIZE)) {
+    free(image);
+    image = NULL;
+  }
+  store_open(&s_store, &flash, image);
+  free(image);
+
+  memcpy(s_restored, s_store.payload, s_store.len);
+  s_restored_len = s_store.len;
+  memcpy(s_last, s_store.payload, s_store.len);
+  s_last_len = s_store.len;
+  s_stats.seq = s_store.seq;
+
+  if (s_store.newest_slot == PERSIST_NO_SLOT) {
+    Serial.println("ARCHI: Persist store empty");
+  } else {
+    Serial.printf("ARCHI: Persist restored seq %lu (%u bytes, slot %u)\n",
+                  static_cast<unsigned long>(s_store.seq), s_store.len, s_store.newest_slot);
+  }
+
+  s_task = rtos_static_task(
+      persist_task,
+      "persist",
+      PERSIST_TASK_STACK_SIZE,
+      NULL,
+      PERSIST_TASK_PRIORITY,
+      s_task_stack,
+      &s_task_tcb,
+      0);
+
+  if (!s_task) {
+    Serial.println("[ERROR] Failed to create persistence task!");
+    return;
+  }
+  sysmon_register_task(s_task, "persist", PERSIST_TASK_STACK_SIZE);
+}
+
+uint16_t persist_load(void* out, uint16_t max_len)
+{
+  if (!out || s_restored_len == 0 || s_restored_len > max_len) return 0;
+  memcpy(out, s_restored, s_restored_len);
+  return s_restored_len;
+}
+
+bool persist_save(const void* data, uint16_t len)
+{
+  if (!s_lock || !data || len == 0 || len > PERSIST_PAYLOAD_MAX) return false;
+
+  uint32_t start = micros();
+  bool arm = false;
+
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  const uint8_t* ref = s_dirty ? s_stage : s_last;
+  uint16_t ref_len = s_dirty ? s_stage_len : s_last_len;
+  s_stats.saves++;
+  if (ref_len == len && memcmp(ref, data, len) == 0) {
+    s_stats.unchanged++;
+  } else {
+    memcpy(s_stage, data, len);
+    s_stage_len = len;
+    if (s_dirty) {
+      s_stats.coalesced++;
+    } else {
+      s_dirty = true;
+      s_deadline_ms = millis() + PERSIST_DEBOUNCE_MS;
+      arm = true;
+    }
+  }
+  uint32_t elapsed = micros() - start;
+  if (elapsed > s_stats.save_us_max) s_stats.save_us_max = elapsed;
+  xSemaphoreGive(s_lock);
+
+  if (arm && s_task) xTaskNotifyGive(s_task);
+  return true;
+}
+
+bool persist_flush(uint32_t timeout_ms)
+{
+  if (!s_lock || !s_task) return false;
+
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  bool pending = s_dirty;
+  uint32_t written_before = s_stats.written;
+  uint32_t failed_before = s_stats.failed;
+  s_deadline_ms = millis();
+  xSemaphoreGive(s_lock);
+  if (!pending) return true;
+
+  xTaskNotifyGive(s_task);
+  uint32_t start = millis();
+  for (;;) {
+    xSemaphoreTake(s_lock, portMAX_DELAY);
+    bool failed = s_stats.failed != failed_before;
+    bool done = !s_dirty && s_stats.written != written_before;
+    xSemaphoreGive(s_lock);
+    if (failed) return false;
+    if (done) return true;
+    if (millis() - start >= timeout_ms) return false;
+    vTaskDelay(pdMS_TO_TICKS(2));
+  }
+}
+
+void persist_get_stats(persist_stats_t* out)
+{
+  if (!out) return;
+  if (!s_lock) {
+    memset(out, 0, sizeof(*out));
+    return;
+  }
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  *out = s_stats;
+  xSemaphoreGive(s_lock);
+}
+
+// ---------------------------------------------------------------------------
+// Benchmark: RAM flash that loses power after a byte budget
+// ---------------------------------------------------------------------------
+
+typedef struct {
+  uint8_t* mem;
+  int32_t budget;     // Bytes programmed or erased before the cut, < 0 = no cut
+  uint32_t used;
+  bool off;
+} persist_fault_flash_t;
+
+static bool fault_read(void* ctx, uint32_t offset, void* dst, uint32_t len)
+{
+  persist_fault_flash_t* f = static_cast<persist_fault_flash_t*>(ctx);
+  if (f->off) return false;
+  memcpy(dst, f->mem + offset, len);
+  return true;
+}
+
+static bool fault_write(void* ctx, uint32_t offset, const void* src, uint32_t len)
+{
+  persist_fault_flash_t* f = static_cast<persist_fault_flash_t*>(ctx);
+  const uint8_t* in = static_cast<const uint8_t*>(src);
+  if (f->off) return false;
+  for (uint32_t i = 0; i < len; ++i) {
+    if (f->budget == 0) {
+      f->mem[offset + i] &= static_cast<uint8_t>(in[i] | 0xA5);   // Half-programmed byte
+      f->off = true;
+      return false;
+    }
+    f->mem[offset + i] &= in[i];
+    if (f->budget > 0) f->budget--;
+    f->used++;
+  }
+  return true;
+}
+
+static bool fault_erase(void* ctx, uint32_t offset, uint32_t len)
+{
+  persist_fault_flash_t* f = static_cast<persist_fault_flash_t*>(ctx);
+  if (f->off) return false;
+  for (uint32_t i = 0; i < len; ++i) {
+    if (f->budget == 0) {
+      f->off = true;   // Rest of the sector keeps its old content
+      return false;
+    }
+    f->mem[offset + i] = 0xFF;
+    if (f->budget > 0) f->budget--;
+    f->used++;
+  }
+  return true;
+}
+
+// Deterministic blob of varying length for record n
+static uint16_t bench_payload(uint32_t n, uint8_t* out)
+{
+  uint16_t len = static_cast<uint16_t>(8 + (n * 37u) % (PERSIST_PAYLOAD_MAX - 7));
+  for (uint16_t i = 0; i < len; ++i) out[i] = static_cast<uint8_t>(n * 131u + i * 7u);
+  return len;
+}
+
+static bool bench_holds(const persist_store_t* s, uint32_t n)
+{
+  uint8_t expect[PERSIST_PAYLOAD_MAX];
+  uint16_t len = bench_payload(n, expect);
+  return s->newest_slot != PERSIST_NO_SLOT && s->len == len && memcmp(s->payload, expect, len) == 0;
+}
+
+/*
+ * Fill a fresh image with `records` saves, then cut power at every offset
+ * of the next save. Returns the number of offsets where recovery failed.
+ */
+static uint32_t bench_power_cuts(const char* name, uint32_t records, uint8_t* base, uint8_t* mem, uint32_t* cases)
+{
+  uint8_t blob[PERSIST_PAYLOAD_MAX];
+  persist_fault_flash_t fault = {mem, -1, 0, false};
+  const persist_flash_t flash = {fault_read, fault_write, fault_erase, &fault};
+  persist_store_t store;
+
+  memset(mem, 0xFF, PERSIST_REGION_SIZE);
+  store_open(&store, &flash, mem);
+  for (uint32_t n = 1; n <= records; ++n) {
+    uint16_t len = bench_payload(n, blob);
+    store_append(&store, blob, len, NULL);
+  }
+  memcpy(base, mem, PERSIST_REGION_SIZE);
+
+  // Size of the save under test (record, plus an erase on a bank switch)
+  uint16_t len = bench_payload(records + 1, blob);
+  fault.used = 0;
+  store_append(&store, blob, len, NULL);
+  uint32_t total = fault.used;
+  uint32_t erase_bytes = (total > PERSIST_SLOT_SIZE) ? PERSIST_SECTOR_SIZE : 0;
+
+  uint32_t failures = 0;
+  uint32_t count = 0;
+  int64_t start = bench_clock_us();
+  for (uint32_t cut = 0; cut <= total; cut += (cut < erase_bytes) ? 64 : 1) {
+    memcpy(mem, base, PERSIST_REGION_SIZE);
+    fault.budget = -1;
+    fault.off = false;
+    store_open(&store, &flash, mem);
+
+    fault.budget = static_cast<int32_t>(cut);
+    bool saved = store_append(&store, blob, len, NULL);
+
+    // Power back: the image must hold the old or the new blob
+    fault.budget = -1;
+    fault.off = false;
+    store_open(&store, &flash, mem);
+    bool is_new = bench_holds(&store, records + 1);
+    bool ok = is_new || (!saved && cut < total && bench_holds(&store, records));
+
+    // ...and accept the next save
+    uint16_t next_len = bench_payload(records + 2, blob);
+    ok = ok && store_append(&store, blob, next_len, NULL);
+    store_open(&store, &flash, mem);
+    ok = ok && bench_holds(&store, records + 2);
+    bench_payload(records + 1, blob);
+
+    if (!ok) {
+      if (failures == 0) {
+        Serial.printf("[PERSIST] %s: recovery failed at cut %lu/%lu\n", name,
+                      static_cast<unsigned long>(cut), static_cast<unsigned long>(total));
+      }
+      failures++;
+    }
+    count++;
+    if ((count & 63) == 0) vTaskDelay(1);   // Long run on target: let the idle task feed the watchdog
+  }
+
+  Serial.printf("[PERSIST] Power cut %s: %lu offsets over %lu bytes, %lu failures (%lu ms)\n", name,
+                static_cast<unsigned long>(count), static_cast<unsigned long>(total),
+                static_cast<unsigned long>(failures), static_cast<unsigned long>((bench_clock_us() - start) / 1000));
+  *cases += count;
+  return failures;
+}
+
+uint32_t persist_check_power_cuts(uint32_t* cases)
+{
+  uint8_t* base = static_cast<uint8_t*>(malloc(PERSIST_REGION_SIZE));
+  uint8_t* mem = static_cast<uint8_t*>(malloc(PERSIST_REGION_SIZE));
+  uint32_t count = 0;
+  uint32_t failures = 1;
+  if (base && mem) {
+    failures = bench_power_cuts("append", 5, base, mem, &count);
+    failures += bench_power_cuts("bank switch", 2 * PERSIST_SLOTS_PER_BANK, base, mem, &count);
+  } else {
+    Serial.println("[PERSIST] Power cut check: not enough heap");
+  }
+  free(base);
+  free(mem);
+  if (cases) *cases = count;
+  return failures;
+}
+
+void persist_run_benchmark(void)
+{
+  uint32_t cases = 0;
+  uint32_t failures = persist_check_power_cuts(&cases);
+
+  uint8_t* base = static_cast<uint8_t*>(malloc(PERSIST_REGION_SIZE));
+  uint8_t* mem = static_cast<uint8_t*>(malloc(PERSIST_REGION_SIZE));
+  if (!base || !mem) {
+    Serial.println("[PERSIST] Benchmark: not enough heap");
+    free(base);
+    free(mem);
+    return;
+  }
+
+  // Boot restore cost: single image read vs one read per slot
+  memset(mem, 0xFF, PERSIST_REGION_SIZE);
+  persist_fault_flash_t fault = {mem, -1, 0, false};
+  const persist_flash_t flash = {fault_read, fault_write, fault_erase, &fault};
+  persist_store_t store;
+  store_open(&store, &flash, mem);
+  for (uint32_t n = 1; n <= PERSIST_SLOTS_PER_BANK + 3; ++n) {
+    uint8_t blob[PERSIST_PAYLOAD_MAX];
+    uint16_t len = bench_payload(n, blob);
+    store_append(&store, blob, len, NULL);
+  }
+  int64_t start = bench_clock_us();
+  fault_read(&fault, 0, base, PERSIST_REGION_SIZE);
+  store_open(&store, &flash, base);
+  uint32_t open_image_us = static_cast<uint32_t>(bench_clock_us() - start);
+  start = bench_clock_us();
+  store_open(&store, &flash, NULL);
+  uint32_t open_slots_us = static_cast<uint32_t>(bench_clock_us() - start);
+  free(base);
+  free(mem);
+
+  Serial.printf("[PERSIST] Power cut total: %lu cases, %lu failures | open (RAM) %lu us image, %lu us per slot\n",
+                static_cast<unsigned long>(cases), static_cast<unsigned long>(failures),
+                static_cast<unsigned long>(open_image_us), static_cast<unsigned long>(open_slots_us));
+
+  // Live path: the current blob is written back last, so nothing is lost
+  uint8_t current[PERSIST_PAYLOAD_MAX];
+  uint8_t blob[PERSIST_PAYLOAD_MAX];
+  if (!s_task) {
+    Serial.println("[PERSIST] No writer task: live latency skipped");
+    return;
+  }
+  xSemaphoreTake(s_lock, portMAX_DELAY);
+  uint16_t len = s_dirty ? s_stage_len : s_last_len;
+  memcpy(current, s_dirty ? s_stage : s_last, len);
+  xSemaphoreGive(s_lock);
+  if (len == 0) {
+    Serial.println("[PERSIST] Nothing saved yet: live latency skipped");
+    return;
+  }
+
+  const uint32_t saves = 256;
+  memcpy(blob, current, len);
+  start = bench_clock_us();
+  for (uint32_t i = 0; i < saves; ++i) {
+    blob[0] = static_cast<uint8_t>(current[0] ^ (1 + (i & 0x7F)));
+    persist_save(blob, len);
+  }
+  uint32_t save_avg_us = static_cast<uint32_t>((bench_clock_us() - start) / saves);
+
+  const uint32_t writes = 8;
+  uint32_t write_min = UINT32_MAX;
+  uint32_t write_max = 0;
+  uint32_t write_sum = 0;
+  persist_stats_t stats;
+  for (uint32_t i = 0; i <= writes; ++i) {
+    blob[0] = static_cast<uint8_t>(current[0] ^ (0x80 | i));
+    persist_save((i == writes) ? current : blob, len);
+    if (!persist_flush(2000)) {
+      Serial.println("[PERSIST] Live write failed");
+      return;
+    }
+    persist_get_stats(&stats);
+    if (i == writes) break;
+    write_sum += stats.write_us_last;
+    if (stats.write_us_last < write_min) write_min = stats.write_us_last;
+    if (stats.write_us_last > write_max) write_max = stats.write_us_last;
+  }
+
+  Serial.printf("[PERSIST] save() avg %lu us max %lu us | flash write min %lu avg %lu max %lu us (seq %lu, %lu bank switches)\n",
+                static_cast<unsigned long>(save_avg_us), static_cast<unsigned long>(stats.save_us_max),
+                static_cast<unsigned long>(write_min), static_cast<unsigned long>(write_sum / writes),
+                static_cast<unsigned long>(write_max), static_cast<unsigned long>(stats.seq),
+                static_cast<unsigned long>(stats.erases));
+}
@@ -0,0 +1,259 @@
+/*
+ * ARCHI - Static RTOS Objects Implementation
+ *
+ * The table is keyed by control block address: an object deleted and
+ * created again in the same buffer (touch mutex across deinit/init) keeps
+ * one entry. Entries are added under a spinlock, from any task.
+ */
+
+#include "rtos_static.h"
+#include "netsec/netsec_ble.h"
+
+#include <Arduino.h>
+#include <string.h>
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_system.h>
+#include <esp_heap_caps.h>
+#endif
+
+#ifndef RTOS_STATIC_BENCH_SCANS
+#define RTOS_STATIC_BENCH_SCANS 500
+#endif
+#define RTOS_STATIC_BENCH_SCAN_MS   1000
+#define RTOS_STATIC_BENCH_POLL_MS   20
+
+typedef struct {
+  const char* name;
+  const void* control;        // Key: the Static*_t buffer
+  rtos_static_kind_t kind;
+  uint32_t control_bytes;
+  uint32_t length;            // Stack bytes, queue items or ring bytes
+  uint32_t item_size;         // Queues only
+} rtos_static_entry_t;
+
+static const char* const k_kind_names[RTOS_STATIC_KIND_COUNT] = {
+  "task", "queue", "mutex", "timer", "events", "ringbuf",
+};
+
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static rtos_static_entry_t s_entries[RTOS_STATIC_MAX_OBJECTS];
+static uint8_t s_count = 0;
+static bool s_overflow_reported = false;
+
+static uint32_t storage_bytes(const rtos_static_entry_t* e)
+{
+  return e->kind == RTOS_STATIC_QUEUE ? e->length * e->item_size : e->length;
+}
+
+static void record(const char* name, const void* control, rtos_static_kind_t kind, uint32_t control_bytes,
+                   uint32_t length, uint32_t item_size)
+{
+  bool full = false;
+
+  portENTER_CRITICAL(&s_lock);
+  rtos_static_entry_t* e = NULL;
+  for (uint8_t i = 0; i < s_count; ++i) {
+    if (s_entries[i].control == control) {
+      e = &s_entries[i];
+      break;
+    }
+  }
+  if (!e && s_count < RTOS_STATIC_MAX_OBJECTS) {
+    e = &s_entries[s_count++];
+  }
+  if (e) {
+    e->name = name ? name : "?";
+    e->control = control;
+    e->kind = kind;
+    e->control_bytes = control_bytes;
+    e->length = length;
+    e->item_size = item_size;
+  } else {
+    full = !s_overflow_reported;
+    s_overflow_reported = true;
+  }
+  portEXIT_CRITICAL(&s_lock);
+
+  if (full) {
+    Serial.println("[ERROR] Static RTOS table full: raise RTOS_STATIC_MAX_OBJECTS");
+  }
+}
+
+TaskHandle_t rtos_static_task(TaskFunction_t fn, const char* name, uint32_t stack_size, void* arg,
+                              UBaseType_t priority, StackType_t* stack, StaticTask_t* tcb, BaseType_t core)
+{
+  TaskHandle_t task = xTaskCreateStaticPinnedToCore(fn, name, stack_size, arg, priority, stack, tcb, core);
+  if (task) record(name, tcb, RTOS_STATIC_TASK, sizeof(StaticTask_t), stack_size, 0);
+  return task;
+}
+
+QueueHandle_t rtos_static_queue(const char* name, UBaseType_t length, UBaseType_t item_size,
+                                uint8_t* storage, StaticQueue_t* queue)
+{
+  QueueHandle_t handle = xQueueCreateStatic(length, item_size, storage, queue);
+  if (handle) record(name, queue, RTOS_STATIC_QUEUE, sizeof(StaticQueue_t), length, item_size);
+  return handle;
+}
+
+SemaphoreHandle_t rtos_static_mutex(const char* name, StaticSemaphore_t* mutex)
+{
+  SemaphoreHandle_t handle = xSemaphoreCreateMutexStatic(mutex);
+  if (handle) record(name, mutex, RTOS_STATIC_MUTEX, sizeof(StaticSemaphore_t), 0, 0);
+  return handle;
+}
+
+TimerHandle_t rtos_static_timer(const char* name, TickType_t period, UBaseType_t auto_reload, void* timer_id,
+                                TimerCallbackFunction_t callback, StaticTimer_t* timer)
+{
+  TimerHandle_t handle = xTimerCreateStatic(name, period, auto_reload, timer_id, callback, timer);
+  if (handle) record(name, timer, RTOS_STATIC_TIMER, sizeof(StaticTimer_t), 0, 0);
+  return handle;
+}
+
+EventGroupHandle_t rtos_static_event_group(const char* name, StaticEventGroup_t* group)
+{
+  EventGroupHandle_t handle = xEventGroupCreateStatic(group);
+  if (handle) record(name, group, RTOS_STATIC_EVENT_GROUP, sizeof(StaticEventGroup_t), 0, 0);
+  return handle;
+}
+
+RingbufHandle_t rtos_static_ringbuf(const char* name, size_t size, RingbufferType_t type,
+                                    uint8_t* storage, StaticRingbuffer_t* ring)
+{
+  RingbufHandle_t handle = xRingbufferCreateStatic(size, type, storage, ring);
+  if (handle) record(name, ring, RTOS_STATIC_RINGBUF, sizeof(StaticRingbuffer_t), static_cast<uint32_t>(size), 0);
+  return handle;
+}
+
+void rtos_static_get_stats(rtos_static_stats_t* out)
+{
+  if (!out) return;
+  memset(out, 0, sizeof(*out));
+
+  portENTER_CRITICAL(&s_lock);
+  out->objects = s_count;
+  for (uint8_t i = 0; i < s_count; ++i) {
+    const rtos_static_entry_t* e = &s_entries[i];
+    uint32_t storage = storage_bytes(e);
+    out->control_bytes += e->control_bytes;
+    out->storage_bytes += storage;
+    out->kind_bytes[e->kind] += e->control_bytes + storage;
+  }
+  portEXIT_CRITICAL(&s_lock);
+}
+
+static void heap_now(uint32_t* free_bytes, uint32_t* largest)
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  *free_bytes = esp_get_free_heap_size();
+  *largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+#else
+  *free_bytes = 0;
+  *largest = 0;
+#endif
+}
+
+void rtos_static_print_map(void)
+{
+  static rtos_static_entry_t entries[RTOS_STATIC_MAX_OBJECTS];  // Off the caller's stack
+  uint8_t count;
+
+  portENTER_CRITICAL(&s_lock);
+  count = s_count;
+  memcpy(entries, s_entries, count * sizeof(entries[0]));
+  portEXIT_CRITICAL(&s_lock);
+
+  Serial.printf("ARCHI: Static RTOS objects (%u):\n", count);
+  for (uint8_t i = 0; i < count; ++i) {
+    const rtos_static_entry_t* e = &entries[i];
+    switch (e->kind) {
+      case RTOS_STATIC_TASK:
+        Serial.printf("ARCHI:   %-7s %-16s ctl %4lu  stack %lu\n", k_kind_names[e->kind], e->name,
+                      static_cast<unsigned long>(e->control_bytes), static_cast<unsigned long>(e->length));
+        break;
+      case RTOS_STATIC_QUEUE:
+        Serial.printf("ARCHI:   %-7s %-16s ctl %4lu  items %lu x %lu = %lu\n", k_kind_names[e->kind], e->name,
+                      static_cast<unsigned long>(e->control_bytes), static_cast<unsigned long>(e->length),
+                      static_cast<unsigned long>(e->item_size), static_cast<unsigned long>(storage_bytes(e)));
+        break;
+      case RTOS_STATIC_RINGBUF:
+        Serial.printf("ARCHI:   %-7s %-16s ctl %4lu  storage %lu\n", k_kind_names[e->kind], e->name,
+                      static_cast<unsigned long>(e->control_bytes), static_cast<unsigned long>(e->length));
+        break;
+      default:
+        Serial.printf("ARCHI:   %-7s %-16s ctl %4lu\n", k_kind_names[e->kind], e->name,
+                      static_cast<unsigned long>(e->control_bytes));
+        break;
+    }
+  }
+
+  rtos_static_stats_t stats;
+  rtos_static_get_stats(&stats);
+  Serial.printf("ARCHI:   total %lu B in .bss (control %lu, storage %lu):",
+                static_cast<unsigned long>(stats.control_bytes + stats.storage_bytes),
+                static_cast<unsigned long>(stats.control_bytes),
+                static_cast<unsigned long>(stats.storage_bytes));
+  for (uint8_t k = 0; k < RTOS_STATIC_KIND_COUNT; ++k) {
+    if (stats.kind_bytes[k]) {
+      Serial.printf(" %s %lu", k_kind_names[k], static_cast<unsigned long>(stats.kind_bytes[k]));
+    }
+  }
+  Serial.println();
+
+  uint32_t free_bytes, largest;
+  heap_now(&free_bytes, &largest);
+  Serial.printf("ARCHI: Heap after boot: %lu B free, largest block %lu B\n",
+                static_cast<unsigned long>(free_bytes), static_cast<unsigned long>(largest));
+}
+
+static void bench_scan(void)
+{
+  netsec_ble_start_scan(RTOS_STATIC_BENCH_SCAN_MS);
+  while (netsec_ble_is_scanning()) {
+    vTaskDelay(pdMS_TO_TICKS(RTOS_STATIC_BENCH_POLL_MS));
+  }
+}
+
+void rtos_static_run_benchmark(void)
+{
+  const uint32_t scans = RTOS_STATIC_BENCH_SCANS < 2 ? 2 : RTOS_STATIC_BENCH_SCANS;
+  rtos_static_stats_t before;
+  rtos_static_get_stats(&before);
+
+  Serial.printf("ARCHI: Heap benchmark: %lu BLE scans of %u ms\n",
+                static_cast<unsigned long>(scans), RTOS_STATIC_BENCH_SCAN_MS);
+
+  // First scan brings up the BLE stack: its allocations are not steady state
+  bench_scan();
+  uint32_t free_first, largest_first;
+  heap_now(&free_first, &largest_first);
+  uint32_t free_lo = free_first;
+  uint32_t free_hi = free_first;
+
+  for (uint32_t i = 2; i <= scans; ++i) {
+    bench_scan();
+    uint32_t free_bytes, largest;
+    heap_now(&free_bytes, &largest);
+    if (free_bytes < free_lo) free_lo = free_bytes;
+    if (free_bytes > free_hi) free_hi = free_bytes;
+    if (i % (scans / 10 ? scans / 10 : 1) == 0) {
+      Serial.printf("ARCHI:   scan %5lu: %lu B free, largest block %lu B\n", static_cast<unsigned long>(i),
+                    static_cast<unsigned long>(free_bytes), static_cast<unsigned long>(largest));
+    }
+  }
+
+  uint32_t free_last, largest_last;
+  heap_now(&free_last, &largest_last);
+  rtos_static_stats_t after;
+  rtos_static_get_stats(&after);
+
+  const long drift = static_cast<long>(free_last) - static_cast<long>(free_first);
+  Serial.printf("ARCHI: Heap after scan 1: %lu B (largest %lu), after scan %lu: %lu B (largest %lu)\n",
+                static_cast<unsigned long>(free_first), static_cast<unsigned long>(largest_first),
+                static_cast<unsigned long>(scans), static_cast<unsigned long>(free_last),
+                static_cast<unsigned long>(largest_last));
+  const bool flat = drift >= 0 && largest_last >= largest_first && after.objects == before.objects;
+  Serial.printf("ARCHI: Heap drift %ld B, range %lu B; static objects %u -> %u: %s\n", drift,
+                static_cast<unsigned long>(free_hi - free_lo), before.objects, after.objects,
+                flat ? "flat" : "NOT FLAT");
+}
@@ -0,0 +1,301 @@
+/*
+ * ARCHI - Binary Serial Export Implementation
+ *
+ * Encoding happens in the producer context (a few dozen bytes, no heap),
+ * UART writes happen only in the export TX task. The ring is an ESP-IDF
+ * byte ring buffer: a frame is either queued whole or dropped whole.
+ */
+
+#include "serial_export.h"
+#include "sysmon.h"
+#include "rtos_static.h"
+
+#include <Arduino.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#define SERIAL_EXPORT_HEADER_SIZE 8
+#define SERIAL_EXPORT_CRC_SIZE    2
+
+// CRC16-CCITT, nibble table: small enough for DRAM, fast enough for ~60 B frames.
+static const uint16_t s_crc16_nibble[16] = {
+  0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+  0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+};
+
+static uint16_t crc16_ccitt(const uint8_t* data, size_t len)
+{
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; ++i) {
+    crc = (uint16_t)((crc << 4) ^ s_crc16_nibble[((crc >> 12) ^ (data[i] >> 4)) & 0x0F]);
+    crc = (uint16_t)((crc << 4) ^ s_crc16_nibble[((crc >> 12) ^ (data[i] & 0x0F)) & 0x0F]);
+  }
+  return crc;
+}
+
+// Consistent Overhead Byte Stuffing between two 0x00 delimiters. The leading
+// one ends whatever text the UART carried before (logs share the port), so a
+// line without a trailing newline never runs into the frame.
+static size_t cobs_encode(const uint8_t* in, size_t len, uint8_t* out)
+{
+  out[0] = 0x00;
+  size_t code_idx = 1;
+  size_t out_idx = 2;
+  uint8_t code = 1;
+
+  for (size_t i = 0; i < len; ++i) {
+    if (in[i] == 0) {
+      out[code_idx] = code;
+      code_idx = out_idx++;
+      code = 1;
+    } else {
+      out[out_idx++] = in[i];
+      if (++code == 0xFF) {
+        out[code_idx] = code;
+        code_idx = out_idx++;
+        code = 1;
+      }
+    }
+  }
+  out[code_idx] = code;
+  out[out_idx++] = 0x00;
+  return out_idx;
+}
+
+static inline void put_u16(uint8_t* p, uint16_t v)
+{
+  p[0] = (uint8_t)(v & 0xFF);
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put_u32(uint8_t* p, uint32_t v)
+{
+  p[0] = (uint8_t)(v & 0xFF);
+  p[1] = (uint8_t)((v >> 8) & 0xFF);
+  p[2] = (uint8_t)((v >> 16) & 0xFF);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+size_t serial_export_encode(serial_export_record_t type, uint16_t seq, uint32_t timestamp_ms,
+                            const uint8_t* payload, size_t payload_len, uint8_t* out)
+{
+  if (payload_len > SERIAL_EXPORT_MAX_FRAME - SERIAL_EXPORT_HEADER_SIZE - SERIAL_EXPORT_CRC_SIZE) {
+    return 0;
+  }
+
+  uint8_t frame[SERIAL_EXPORT_MAX_FRAME];
+  frame[0] = SERIAL_EXPORT_PROTOCOL_VERSION;
+  frame[1] = (uint8_t)type;
+  put_u16(&frame[2], seq);
+  put_u32(&frame[4], timestamp_ms);
+  memcpy(&frame[SERIAL_EXPORT_HEADER_SIZE], payload, payload_len);
+  size_t frame_len = SERIAL_EXPORT_HEADER_SIZE + payload_len;
+  put_u16(&frame[frame_len], crc16_ccitt(frame, frame_len));
+  frame_len += SERIAL_EXPORT_CRC_SIZE;
+  return cobs_encode(frame, frame_len, out);
+}
+
+#if SERIAL_EXPORT_ENABLED
+#include <freertos/ringbuf.h>
+
+#define SERIAL_EXPORT_TX_CHUNK    256
+#define SERIAL_EXPORT_STATS_PERIOD_MS 1000
+
+static RingbufHandle_t s_export_ring = NULL;
+static TaskHandle_t s_export_task = NULL;
+static StaticRingbuffer_t s_export_ring_cb;
+static uint8_t s_export_ring_storage[SERIAL_EXPORT_RING_SIZE];
+static StaticTask_t s_export_tcb;
+static StackType_t s_export_stack[SERIAL_EXPORT_TASK_STACK_SIZE / sizeof(StackType_t)];
+static SemaphoreHandle_t s_export_lock = NULL;   // Sequence order = ring order
+static StaticSemaphore_t s_export_lock_cb;
+static portMUX_TYPE s_export_mux = portMUX_INITIALIZER_UNLOCKED;
+static uint16_t s_export_seq = 0;
+static serial_export_stats_t s_export_stats = {0, 0, 0, 0};
+static uint32_t s_export_delimiters = 0;   // TX task only
+
+// Wrap a payload into a frame and queue it. The sequence number is consumed
+// even when the frame is dropped so the host can detect the gap. Numbering
+// and queuing happen under one lock (a few µs of encoding): frames reach the
+// ring in sequence order whichever producers race, and the host counts every
+// gap as a loss.
+static bool export_submit(serial_export_record_t type, const uint8_t* payload, size_t payload_len)
+{
+  if (!s_export_ring) return false;
+
+  uint8_t encoded[SERIAL_EXPORT_MAX_ENCODED];
+  xSemaphoreTake(s_export_lock, portMAX_DELAY);
+  size_t encoded_len = serial_export_encode(type, s_export_seq, millis(), payload, payload_len, encoded);
+  if (encoded_len == 0) {
+    xSemaphoreGive(s_export_lock);
+    return false;
+  }
+  s_export_seq++;
+  bool queued = xRingbufferSend(s_export_ring, encoded, encoded_len, 0) == pdTRUE;
+  xSemaphoreGive(s_export_lock);
+
+  portENTER_CRITICAL(&s_export_mux);
+  if (queued) {
+    ++s_export_stats.frames_queued;
+  } else {
+    ++s_export_stats.frames_dropped;
+  }
+  portEXIT_CRITICAL(&s_export_mux);
+
+  return queued;
+}
+
+static void export_submit_stats(void)
+{
+  serial_export_stats_t stats;
+  serial_export_get_stats(&stats);
+
+  uint8_t payload[12];
+  put_u32(&payload[0], stats.frames_sent);
+  put_u32(&payload[4], stats.frames_dropped);
+  put_u32(&payload[8], stats.bytes_sent);
+  export_submit(SERIAL_EXPORT_REC_STATS, payload, sizeof(payload));
+}
+
+static void serial_export_task(void* pvParameters)
+{
+  (void)pvParameters;
+  TickType_t last_stats = xTaskGetTickCount();
+
+  for (;;) {
+    size_t item_size = 0;
+    uint8_t* chunk = static_cast<uint8_t*>(xRingbufferReceiveUpTo(
+        s_export_ring, &item_size, pdMS_TO_TICKS(SERIAL_EXPORT_STATS_PERIOD_MS), SERIAL_EXPORT_TX_CHUNK));
+
+    if (chunk) {
+      Serial.write(chunk, item_size);
+      vRingbufferReturnItem(s_export_ring, chunk);
+
+      // Two 0x00 per frame: count delimiters to track whole frames across chunks.
+      for (size_t i = 0; i < item_size; ++i) {
+        if (chunk[i] == 0x00) ++s_export_delimiters;
+      }
+      portENTER_CRITICAL(&s_export_mux);
+      s_export_stats.frames_sent = s_export_delimiters / 2;
+      s_export_stats.bytes_sent += item_size;
+      portEXIT_CRITICAL(&s_export_mux);
+    }
+
+    if ((xTaskGetTickCount() - last_stats) >= pdMS_TO_TICKS(SERIAL_EXPORT_STATS_PERIOD_MS)) {
+      last_stats = xTaskGetTickCount();
+      export_submit_stats();
+    }
+  }
+}
+
+void serial_export_init(void)
+{
+  if (s_export_ring) return;
+
+  s_export_lock = rtos_static_mutex("export", &s_export_lock_cb);
+  s_export_ring = rtos_static_ringbuf("export_ring", SERIAL_EXPORT_RING_SIZE, RINGBUF_TYPE_BYTEBUF,
+                                      s_export_ring_storage, &s_export_ring_cb);
+  if (!s_export_ring) {
+    Serial.println("[ERROR] Failed to create serial export ring");
+    return;
+  }
+
+  s_export_task = rtos_static_task(
+      serial_export_task,
+      "export_tx",
+      SERIAL_EXPORT_TASK_STACK_SIZE,
+      NULL,
+      SERIAL_EXPORT_TASK_PRIORITY,
+      s_export_stack,
+      &s_export_tcb,
+      0);
+
+  if (!s_export_task) {
+    Serial.println("[ERROR] Failed to create serial export task!");
+    vRingbufferDelete(s_export_ring);
+    s_export_ring = NULL;
+    return;
+  }
+  sysmon_register_task(s_export_task, "export_tx", SERIAL_EXPORT_TASK_STACK_SIZE);
+
+  Serial.printf("ARCHI: Binary serial export running at %lu baud (ring %u bytes)\n",
+                static_cast<unsigned long>(SERIAL_EXPORT_BAUD),
+                static_cast<unsigned>(SERIAL_EXPORT_RING_SIZE));
+}
+
+bool serial_export_ble_device(const netsec_ble_device_t* device)
+{
+  if (!device) return false;
+
+  uint8_t payload[6 + 1 + 4 + 1 + sizeof(device->name)];
+  size_t name_len = strnlen(device->name, sizeof(device->name) - 1);
+
+  memcpy(&payload[0], device->mac_bytes, 6);
+  payload[6] = (uint8_t)device->rssi;
+  put_u32(&payload[7], device->flags);
+  payload[11] = (uint8_t)name_len;
+  memcpy(&payload[12], device->name, name_len);
+  return export_submit(SERIAL_EXPORT_REC_BLE_DEVICE, payload, 12 + name_len);
+}
+
+bool serial_export_wifi_ap(const netsec_wifi_ap_t* ap)
+{
+  if (!ap) return false;
+
+  uint8_t payload[6 + 1 + 1 + 1 + sizeof(ap->ssid)];
+  size_t ssid_len = strnlen(ap->ssid, sizeof(ap->ssid) - 1);
+
+  memcpy(&payload[0], ap->bssid, 6);
+  payload[6] = (uint8_t)ap->rssi;
+  payload[7] = ap->channel;
+  payload[8] = (uint8_t)ssid_len;
+  memcpy(&payload[9], ap->ssid, ssid_len);
+  return export_submit(SERIAL_EXPORT_REC_WIFI_AP, payload, 9 + ssid_len);
+}
+
+bool serial_export_scan_summary(netsec_result_type_t type, const netsec_scan_summary_t* summary)
+{
+  if (!summary) return false;
+
+  uint8_t payload[11];
+  payload[0] = (uint8_t)type;
+  put_u16(&payload[1], summary->item_count);
+  put_u32(&payload[3], summary->duration_ms);
+  put_u32(&payload[7], summary->timestamp_ms);
+  return export_submit(SERIAL_EXPORT_REC_SCAN_SUMMARY, payload, sizeof(payload));
+}
+
+bool serial_export_ui_event(ui_event_t event)
+{
+  uint8_t payload[1] = { (uint8_t)event };
+  return export_submit(SERIAL_EXPORT_REC_UI_EVENT, payload, sizeof(payload));
+}
+
+void serial_export_get_stats(serial_export_stats_t* out)
+{
+  if (!out) return;
+  portENTER_CRITICAL(&s_export_mux);
+  *out = s_export_stats;
+  portEXIT_CRITICAL(&s_export_mux);
+}
+
+#else // !SERIAL_EXPORT_ENABLED
+
+void serial_export_init(void) {}
+bool serial_export_ble_device(const netsec_ble_device_t* device) { (void)device; return false; }
+bool serial_export_wifi_ap(const netsec_wifi_ap_t* ap) { (void)ap; return false; }
+bool serial_export_scan_summary(netsec_result_type_t type, const netsec_scan_summary_t* summary)
+{
+  (void)type;
+  (void)summary;
+  return false;
+}
+bool serial_export_ui_event(ui_event_t event) { (void)event; return false; }
+
+void serial_export_get_stats(serial_export_stats_t* out)
+{
+  if (out) memset(out, 0, sizeof(*out));
+}
+
+#endif // SERIAL_EXPORT_ENABLED
@@ -0,0 +1,306 @@
+/*
+ * ARCHI - Storage File System Implementation
+ *
+ * Mounting and the read benchmark. Everything else goes through
+ * storage_fs() (File API) or POSIX calls under STORAGE_FS_MOUNT_POINT
+ * (lvgl_fs.cpp), which both reach whichever file system is mounted.
+ */
+
+#include "storage_fs.h"
+#include "asset_map.h"
+#include "bench_clock.h"
+
+#include <Arduino.h>
+#include <esp_spi_flash.h>
+#include <esp_timer.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef STORAGE_FS_LITTLEFS
+#include <LittleFS.h>
+#define STORAGE_FS_OBJ LittleFS
+#else
+#include <SPIFFS.h>
+#define STORAGE_FS_OBJ SPIFFS
+#endif
+
+#ifdef ACYD_NATIVE_SIM
+#include "native_sim.h"
+#endif
+
+// esp_littlefs is prebuilt: the geometry the firmware expects must be the one it was built with
+#if defined(STORAGE_FS_LITTLEFS) && defined(CONFIG_LITTLEFS_READ_SIZE) && \
+    (STORAGE_LFS_READ_SIZE != CONFIG_LITTLEFS_READ_SIZE || STORAGE_LFS_PROG_SIZE != CONFIG_LITTLEFS_WRITE_SIZE)
+#error "STORAGE_LFS_READ_SIZE / PROG_SIZE differ from the framework's CONFIG_LITTLEFS_*: set both in custom_sdkconfig"
+#endif
+#if defined(STORAGE_FS_LITTLEFS) && defined(CONFIG_LITTLEFS_CACHE_SIZE) && \
+    STORAGE_LFS_CACHE_SIZE != CONFIG_LITTLEFS_CACHE_SIZE
+#error "STORAGE_LFS_CACHE_SIZE differs from the framework's CONFIG_LITTLEFS_CACHE_SIZE"
+#endif
+#if defined(STORAGE_FS_LITTLEFS) && defined(CONFIG_LITTLEFS_LOOKAHEAD_SIZE) && \
+    STORAGE_LFS_LOOKAHEAD_SIZE != CONFIG_LITTLEFS_LOOKAHEAD_SIZE
+#error "STORAGE_LFS_LOOKAHEAD_SIZE differs from the framework's CONFIG_LITTLEFS_LOOKAHEAD_SIZE"
+#endif
+
+static_assert(STORAGE_LFS_CACHE_SIZE % STORAGE_LFS_READ_SIZE == 0, "LittleFS cache is a multiple of read_size");
+static_assert(STORAGE_LFS_CACHE_SIZE % STORAGE_LFS_PROG_SIZE == 0, "LittleFS cache is a multiple of prog_size");
+static_assert(STORAGE_LFS_LOOKAHEAD_SIZE % 8 == 0, "LittleFS lookahead is a multiple of 8 bytes");
+
+#define STORAGE_BENCH_FILES     6           // bg_1 .. bg_6
+#define STORAGE_BENCH_CHUNK     4096
+#define STORAGE_BENCH_ROW       640         // 320 px RGB565
+#define STORAGE_BENCH_RANDOM    200
+
+static storage_fs_stats_t s_stats;
+
+fs::FS& storage_fs(void)
+{
+  return STORAGE_FS_OBJ;
+}
+
+bool storage_fs_mount(void)
+{
+#if defined(ACYD_NATIVE_SIM) && defined(STORAGE_FS_LITTLEFS)
+  const sim_littlefs_geometry_t geometry = {
+    STORAGE_LFS_READ_SIZE, STORAGE_LFS_PROG_SIZE, STORAGE_LFS_CACHE_SIZE, STORAGE_LFS_LOOKAHEAD_SIZE,
+  };
+  sim_fs_set_littlefs_geometry(&geometry);
+#endif
+
+  int64_t start = esp_timer_get_time();
+  bool ok = STORAGE_FS_OBJ.begin(true, STORAGE_FS_MOUNT_POINT, STORAGE_FS_MAX_OPEN_FILES, STORAGE_FS_PARTITION_LABEL);
+  s_stats.mount_us = static_cast<uint32_t>(esp_timer_get_time() - start);
+  s_stats.mounted = ok;
+  if (ok) {
+    s_stats.total_bytes = static_cast<uint32_t>(STORAGE_FS_OBJ.totalBytes());
+    s_stats.used_bytes = static_cast<uint32_t>(STORAGE_FS_OBJ.usedBytes());
+    Serial.printf("ARCHI: " STORAGE_FS_NAME " mounted on " STORAGE_FS_MOUNT_POINT ": %lu/%lu KB used (%lu ms)\n",
+                  static_cast<unsigned long>(s_stats.used_bytes / 1024),
+                  static_cast<unsigned long>(s_stats.total_bytes / 1024),
+                  static_cast<unsigned long>(s_stats.mount_us / 1000));
+  } else {
+    Serial.println("[ERROR] " STORAGE_FS_NAME " mount failed");
+  }
+  return ok;
+}
+
+void storage_fs_get_stats(storage_fs_stats_t* out)
+{
+  if (out) *out = s_stats;
+}
+
+/* ---------- Benchmark ---------- */
+
+typedef struct {
+  char path[20];
+  uint32_t size;
+  uint32_t sum;             // Checksum of the 4 KB pass
+  bool copied;              // Written from the asset bundle, removed afterwards
+  const lv_img_dsc_t* ref;  // Mapped original, to check random reads against
+} bench_file_t;
+
+typedef struct {
+  int64_t start_us;
+#if CONFIG_SPI_FLASH_ENABLE_COUNTERS
+  spi_flash_counters_t flash;
+#endif
+} bench_mark_t;
+
+static uint32_t checksum(uint32_t sum, const uint8_t* data, uint32_t len)
+{
+  for (uint32_t i = 0; i < len; ++i) sum = (sum << 5) + sum + data[i];
+  return sum;
+}
+
+static void bench_start(bench_mark_t* m)
+{
+#if CONFIG_SPI_FLASH_ENABLE_COUNTERS
+  m->flash = *spi_flash_get_counters();
+#endif
+  m->start_us = bench_clock_us();
+}
+
+static void bench_report(const char* phase, const bench_mark_t* m, uint32_t bytes, uint32_t ops)
+{
+  uint32_t us = static_cast<uint32_t>(bench_clock_us() - m->start_us);
+  uint32_t flash_reads = 0, flash_bytes = 0, flash_us = 0;
+#if CONFIG_SPI_FLASH_ENABLE_COUNTERS
+  const spi_flash_counters_t* now = spi_flash_get_counters();
+  flash_reads = now->read.count - m->flash.read.count;
+  flash_bytes = now->read.bytes - m->flash.read.bytes;
+  flash_us = now->read.time - m->flash.read.time;
+#endif
+  // Native sim: the host clock times the simulator's file I/O, the flash
+  // model gives what the target would spend
+#ifdef ACYD_NATIVE_SIM
+  bool modelled = flash_us > 0;
+#else
+  bool modelled = false;
+#endif
+  if (modelled) us = flash_us;
+
+  uint32_t kbps = us ? static_cast<uint32_t>(static_cast<uint64_t>(bytes) * 1000000u / 1024u / us) : 0;
+  Serial.printf("[STORAGE] %-9s %7lu B in %4lu ops: %7lu us%s, %5lu KB/s, %5lu us/op",
+                phase, static_cast<unsigned long>(bytes), static_cast<unsigned long>(ops),
+                static_cast<unsigned long>(us), modelled ? " (flash model)" : "",
+                static_cast<unsigned long>(kbps), static_cast<unsigned long>(ops ? us / ops : 0));
+#if CONFIG_SPI_FLASH_ENABLE_COUNTERS
+  Serial.printf(" | flash %lu reads, %lu B", static_cast<unsigned long>(flash_reads),
+                static_cast<unsigned long>(flash_bytes));
+  if (bytes) {
+    uint32_t amp_x100 = static_cast<uint32_t>(100ull * flash_bytes / bytes);
+    Serial.printf(" (x%lu.%02lu)", static_cast<unsigned long>(amp_x100 / 100), static_cast<unsigned long>(amp_x100 % 100));
+  }
+#else
+  (void)flash_reads;
+  (void)flash_bytes;
+#endif
+  Serial.println();
+}
+
+static bool copy_from_bundle(bench_file_t* f, const lv_img_dsc_t* dsc)
+{
+  File out = STORAGE_FS_OBJ.open(f->path, "w");
+  if (!out) return false;
+  bool ok = out.write(reinterpret_cast<const uint8_t*>(&dsc->header), sizeof(dsc->header)) == sizeof(dsc->header);
+  for (uint32_t off = 0; ok && off < dsc->data_size; off += STORAGE_BENCH_CHUNK) {
+    uint32_t n = dsc->data_size - off < STORAGE_BENCH_CHUNK ? dsc->data_size - off : STORAGE_BENCH_CHUNK;
+    ok = out.write(dsc->data + off, n) == n;
+  }
+  out.close();
+  f->size = sizeof(dsc->header) + dsc->data_size;
+  f->copied = true;
+  return ok;
+}
+
+void storage_fs_run_benchmark(void)
+{
+  if (!s_stats.mounted) {
+    Serial.println("[STORAGE] Benchmark: " STORAGE_FS_NAME " not mounted");
+    return;
+  }
+
+  bench_file_t files[STORAGE_BENCH_FILES];
+  uint32_t count = 0;
+  STORAGE_FS_OBJ.mkdir("/img");   // LittleFS needs it; SPIFFS names are flat paths
+  for (uint32_t i = 1; i <= STORAGE_BENCH_FILES; ++i) {
+    bench_file_t* f = &files[count];
+    memset(f, 0, sizeof(*f));
+    snprintf(f->path, sizeof(f->path), "/img/bg_%lu.bin", static_cast<unsigned long>(i));
+    char name[ASSET_MAP_NAME_MAX];
+    snprintf(name, sizeof(name), "bg_%lu", static_cast<unsigned long>(i));
+    f->ref = asset_map_find(name);
+
+    File in = STORAGE_FS_OBJ.open(f->path, "r");
+    if (in) {
+      f->size = static_cast<uint32_t>(in.size());
+      in.close();
+      count++;
+    } else if (f->ref && copy_from_bundle(f, f->ref)) {
+      count++;
+    } else if (f->copied) {
+      STORAGE_FS_OBJ.remove(f->path);
+      Serial.printf("[STORAGE] Benchmark: cannot copy %s (file system full?)\n", f->path);
+    }
+  }
+  uint32_t copied = 0;
+  for (uint32_t i = 0; i < count; ++i) copied += files[i].copied ? 1 : 0;
+  if (count == 0) {
+    Serial.println("[STORAGE] Benchmark: no /img/bg_*.bin and no mapped wallpaper to copy");
+    return;
+  }
+
+  uint8_t* buf = static_cast<uint8_t*>(malloc(STORAGE_BENCH_CHUNK));
+  if (!buf) {
+    Serial.println("[ERROR] Storage benchmark: no buffer");
+    return;
+  }
+  bool ok = true;
+  bench_mark_t mark;
+
+  // Directory walk (what lvgl_port_log_fs does at boot)
+  bench_start(&mark);
+  uint32_t entries = 0;
+  File dir = STORAGE_FS_OBJ.open("/img");
+  for (File e = dir ? dir.openNextFile() : File(); e; e = dir.openNextFile()) entries++;
+  dir.close();
+  bench_report("dir walk", &mark, 0, entries);
+
+  bench_start(&mark);
+  for (uint32_t i = 0; i < count; ++i) {
+    File in = STORAGE_FS_OBJ.open(files[i].path, "r");
+    ok = ok && in;
+    in.close();
+  }
+  bench_report("open", &mark, 0, count);
+
+  // Sequential: whole files in 4 KB chunks, then in rows like the image decoder
+  uint32_t bytes = 0, ops = 0;
+  bench_start(&mark);
+  for (uint32_t i = 0; i < count; ++i) {
+    File in = STORAGE_FS_OBJ.open(files[i].path, "r");
+    for (size_t n; (n = in.read(buf, STORAGE_BENCH_CHUNK)) > 0; ops++) {
+      files[i].sum = checksum(files[i].sum, buf, static_cast<uint32_t>(n));
+      bytes += static_cast<uint32_t>(n);
+    }
+    in.close();
+  }
+  bench_report("seq 4K", &mark, bytes, ops);
+
+  bytes = 0;
+  ops = 0;
+  bench_start(&mark);
+  for (uint32_t i = 0; i < count; ++i) {
+    File in = STORAGE_FS_OBJ.open(files[i].path, "r");
+    uint32_t sum = 0;
+    size_t n = in.read(buf, sizeof(lv_img_header_t));
+    sum = checksum(sum, buf, static_cast<uint32_t>(n));
+    bytes += static_cast<uint32_t>(n);
+    for (ops++; (n = in.read(buf, STORAGE_BENCH_ROW)) > 0; ops++) {
+      sum = checksum(sum, buf, static_cast<uint32_t>(n));
+      bytes += static_cast<uint32_t>(n);
+    }
+    in.close();
+    ok = ok && sum == files[i].sum;
+  }
+  bench_report("seq row", &mark, bytes, ops);
+
+  // Random rows: partial redraws of whichever wallpaper is shown
+  File handles[STORAGE_BENCH_FILES];
+  for (uint32_t i = 0; i < count; ++i) handles[i] = STORAGE_FS_OBJ.open(files[i].path, "r");
+  uint32_t seed = 0x5EEDu, mismatches = 0;
+  bytes = 0;
+  bench_start(&mark);
+  for (uint32_t k = 0; k < STORAGE_BENCH_RANDOM; ++k) {
+    seed = seed * 1103515245u + 12345u;
+    uint32_t i = (seed >> 16) % count;
+    uint32_t rows = (files[i].size - sizeof(lv_img_header_t)) / STORAGE_BENCH_ROW;
+    if (rows == 0) continue;
+    seed = seed * 1103515245u + 12345u;
+    uint32_t off = (seed >> 8) % rows * STORAGE_BENCH_ROW;
+    handles[i].seek(sizeof(lv_img_header_t) + off, SeekSet);
+    size_t n = handles[i].read(buf, STORAGE_BENCH_ROW);
+    bytes += static_cast<uint32_t>(n);
+    if (n != STORAGE_BENCH_ROW || (files[i].ref && files[i].ref->data_size == files[i].size - sizeof(lv_img_header_t) &&
+                                   memcmp(buf, files[i].ref->data + off, STORAGE_BENCH_ROW) != 0)) {
+      mismatches++;
+    }
+  }
+  bench_report("random", &mark, bytes, STORAGE_BENCH_RANDOM);
+  for (uint32_t i = 0; i < count; ++i) handles[i].close();
+  free(buf);
+  ok = ok && mismatches == 0;
+
+  for (uint32_t i = 0; i < count; ++i) {
+    if (files[i].copied) STORAGE_FS_OBJ.remove(files[i].path);
+  }
+
+#ifdef STORAGE_FS_LITTLEFS
+  Serial.printf("[STORAGE] LittleFS read %u, prog %u, cache %u, lookahead %u B\n",
+                STORAGE_LFS_READ_SIZE, STORAGE_LFS_PROG_SIZE, STORAGE_LFS_CACHE_SIZE, STORAGE_LFS_LOOKAHEAD_SIZE);
+#endif
+  Serial.printf("[STORAGE] " STORAGE_FS_NAME ", %lu wallpapers (%lu copied from the bundle): %s\n",
+                static_cast<unsigned long>(count), static_cast<unsigned long>(copied),
+                ok ? "data OK" : "DATA MISMATCH");
+}
@@ -0,0 +1,265 @@
+/*
+ * ARCHI - System Monitor Implementation
+ *
+ * Queue counters are updated under a spinlock from the producer context
+ * (a handful of instructions). Task stack sampling happens in the monitor
+ * task under a mutex shared with sysmon_unregister_task, so a task can never
+ * be sampled after it has been deleted.
+ */
+
+#include "sysmon.h"
+#include "cpuprof.h"
+#include "rtos_static.h"
+
+#include <Arduino.h>
+#include <string.h>
+#include <freertos/semphr.h>
+#if defined(ARDUINO_ARCH_ESP32)
+#include <esp_system.h>
+#include <esp_heap_caps.h>
+#endif
+
+#include "lvgl_heap.h"
+
+typedef struct {
+  QueueHandle_t handle;
+  sysmon_queue_stats_t stats;
+} sysmon_queue_slot_t;
+
+typedef struct {
+  TaskHandle_t handle;
+  sysmon_task_stats_t stats;
+} sysmon_task_slot_t;
+
+static sysmon_queue_slot_t s_queues[SYSMON_QUEUE_COUNT];
+static sysmon_task_slot_t s_tasks[SYSMON_MAX_TASKS];
+static uint8_t s_task_count = 0;
+static sysmon_heap_stats_t s_heap = {0, 0, 0, 0, UINT32_MAX, 0};
+static portMUX_TYPE s_queue_mux = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t s_task_mutex = NULL;
+static TaskHandle_t s_sysmon_task = NULL;
+static StaticSemaphore_t s_task_mutex_cb;
+static StaticTask_t s_sysmon_tcb;
+static StackType_t s_sysmon_stack[SYSMON_TASK_STACK_SIZE / sizeof(StackType_t)];
+
+static void sample_task_locked(sysmon_task_slot_t* slot)
+{
+  if (!slot->handle) return;
+  uint32_t free_bytes = static_cast<uint32_t>(uxTaskGetStackHighWaterMark(slot->handle));
+  if (free_bytes < slot->stats.stack_min_free) {
+    slot->stats.stack_min_free = free_bytes;
+  }
+}
+
+static void sample_heap(void)
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  s_heap.free_heap = esp_get_free_heap_size();
+  s_heap.min_free_heap = esp_get_minimum_free_heap_size();
+  s_heap.largest_block = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+#endif
+}
+
+static void sysmon_task(void* pvParameters)
+{
+  (void)pvParameters;
+  TickType_t last_report = xTaskGetTickCount();
+
+  for (;;) {
+    vTaskDelay(pdMS_TO_TICKS(SYSMON_SAMPLE_PERIOD_MS));
+
+    if (xSemaphoreTake(s_task_mutex, portMAX_DELAY) == pdTRUE) {
+      for (uint8_t i = 0; i < s_task_count; ++i) {
+        sample_task_locked(&s_tasks[i]);
+      }
+      xSemaphoreGive(s_task_mutex);
+    }
+    sample_heap();
+    cpuprof_sample();
+
+    if ((xTaskGetTickCount() - last_report) >= pdMS_TO_TICKS(SYSMON_REPORT_PERIOD_MS)) {
+      last_report = xTaskGetTickCount();
+      sysmon_print_report();
+      cpuprof_print_report();
+    }
+  }
+}
+
+void sysmon_init(void)
+{
+  if (s_task_mutex) return;
+
+  s_task_mutex = rtos_static_mutex("sysmon", &s_task_mutex_cb);
+  if (!s_task_mutex) {
+    Serial.println("[ERROR] Failed to create sysmon mutex");
+    return;
+  }
+  sample_heap();
+
+  s_sysmon_task = rtos_static_task(
+      sysmon_task,
+      "sysmon",
+      SYSMON_TASK_STACK_SIZE,
+      NULL,
+      SYSMON_TASK_PRIORITY,
+      s_sysmon_stack,
+      &s_sysmon_tcb,
+      0);
+
+  if (!s_sysmon_task) {
+    Serial.println("[ERROR] Failed to create sysmon task!");
+    return;
+  }
+  sysmon_register_task(s_sysmon_task, "sysmon", SYSMON_TASK_STACK_SIZE);
+}
+
+void sysmon_register_queue(sysmon_queue_id_t id, QueueHandle_t queue, const char* name, uint32_t length)
+{
+  if (id >= SYSMON_QUEUE_COUNT) return;
+
+  portENTER_CRITICAL(&s_queue_mux);
+  s_queues[id].handle = queue;
+  s_queues[id].stats.name = name;
+  s_queues[id].stats.length = length;
+  portEXIT_CRITICAL(&s_queue_mux);
+}
+
+BaseType_t sysmon_queue_send(sysmon_queue_id_t id, const void* item, TickType_t ticks_to_wait)
+{
+  if (id >= SYSMON_QUEUE_COUNT) return pdFAIL;
+
+  sysmon_queue_slot_t* slot = &s_queues[id];
+  BaseType_t result = slot->handle ? xQueueSend(slot->handle, item, ticks_to_wait) : pdFAIL;
+  uint32_t depth = (result == pdTRUE) ? static_cast<uint32_t>(uxQueueMessagesWaiting(slot->handle)) : 0;
+
+  portENTER_CRITICAL(&s_queue_mux);
+  if (result == pdTRUE) {
+    ++slot->stats.sent;
+    if (depth > slot->stats.high_water) {
+      slot->stats.high_water = depth;
+    }
+  } else {
+    ++slot->stats.dropped;
+  }
+  portEXIT_CRITICAL(&s_queue_mux);
+
+  return result;
+}
+
+void sysmon_register_task(TaskHandle_t task, const char* name, uint32_t stack_size)
+{
+  if (!s_task_mutex || !task || !name) return;
+  if (xSemaphoreTake(s_task_mutex, portMAX_DELAY) != pdTRUE) return;
+
+  sysmon_task_slot_t* slot = NULL;
+  for (uint8_t i = 0; i < s_task_count; ++i) {
+    if (strncmp(s_tasks[i].stats.name, name, SYSMON_TASK_NAME_LEN) == 0) {
+      slot = &s_tasks[i];
+      break;
+    }
+  }
+  if (!slot && s_task_count < SYSMON_MAX_TASKS) {
+    slot = &s_tasks[s_task_count++];
+    memset(slot, 0, sizeof(*slot));
+    strncpy(slot->stats.name, name, SYSMON_TASK_NAME_LEN - 1);
+    slot->stats.stack_min_free = UINT32_MAX;
+  }
+
+  if (slot) {
+    slot->handle = task;
+    slot->stats.stack_size = stack_size;
+    slot->stats.alive = true;
+    sample_task_locked(slot);
+  }
+  xSemaphoreGive(s_task_mutex);
+}
+
+void sysmon_unregister_task(TaskHandle_t task)
+{
+  if (!s_task_mutex || !task) return;
+  if (xSemaphoreTake(s_task_mutex, portMAX_DELAY) != pdTRUE) return;
+
+  for (uint8_t i = 0; i < s_task_count; ++i) {
+    if (s_tasks[i].handle == task) {
+      sample_task_locked(&s_tasks[i]);
+      s_tasks[i].handle = NULL;
+      s_tasks[i].stats.alive = false;
+      break;
+    }
+  }
+  xSemaphoreGive(s_task_mutex);
+}
+
+void sysmon_sample_lvgl_heap(void)
+{
+  lvgl_heap_stats_t mon;
+  lvgl_heap_get_stats(&mon);
+
+  s_heap.lvgl_free = mon.free;
+  s_heap.lvgl_frag_pct = mon.frag_pct;
+  if (mon.free < s_heap.lvgl_min_free) {
+    s_heap.lvgl_min_free = mon.free;
+  }
+}
+
+void sysmon_get_snapshot(sysmon_snapshot_t* out)
+{
+  if (!out) return;
+  memset(out, 0, sizeof(*out));
+
+  portENTER_CRITICAL(&s_queue_mux);
+  for (uint8_t i = 0; i < SYSMON_QUEUE_COUNT; ++i) {
+    out->queues[i] = s_queues[i].stats;
+  }
+  portEXIT_CRITICAL(&s_queue_mux);
+  for (uint8_t i = 0; i < SYSMON_QUEUE_COUNT; ++i) {
+    out->queues[i].waiting = s_queues[i].handle ? static_cast<uint32_t>(uxQueueMessagesWaiting(s_queues[i].handle)) : 0;
+  }
+
+  if (s_task_mutex && xSemaphoreTake(s_task_mutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+    out->task_count = s_task_count;
+    for (uint8_t i = 0; i < s_task_count; ++i) {
+      out->tasks[i] = s_tasks[i].stats;
+    }
+    xSemaphoreGive(s_task_mutex);
+  }
+
+  out->heap = s_heap;
+  if (out->heap.lvgl_min_free == UINT32_MAX) {
+    out->heap.lvgl_min_free = 0;
+  }
+  out->uptime_ms = millis();
+}
+
+void sysmon_print_report(void)
+{
+  static sysmon_snapshot_t snap;  // ~0.5 KB: keep it off the monitor task stack
+  sysmon_get_snapshot(&snap);
+
+  Serial.printf("[SYSMON] uptime %lu s\n", static_cast<unsigned long>(snap.uptime_ms / 1000));
+  for (uint8_t i = 0; i < SYSMON_QUEUE_COUNT; ++i) {
+    const sysmon_queue_stats_t* q = &snap.queues[i];
+    Serial.printf("[SYSMON] queue %-8s %3lu/%-3lu hw %3lu sent %lu drop %lu\n",
+                  q->name ? q->name : "?",
+                  static_cast<unsigned long>(q->waiting),
+                  static_cast<unsigned long>(q->length),
+                  static_cast<unsigned long>(q->high_water),
+                  static_cast<unsigned long>(q->sent),
+                  static_cast<unsigned long>(q->dropped));
+  }
+  for (uint8_t i = 0; i < snap.task_count; ++i) {
+    const sysmon_task_stats_t* t = &snap.tasks[i];
+    Serial.printf("[SYSMON] task  %-10s stack %5lu B, min free %5lu B%s\n",
+                  t->name,
+                  static_cast<unsigned long>(t->stack_size),
+                  static_cast<unsigned long>(t->stack_min_free == UINT32_MAX ? 0 : t->stack_min_free),
+                  t->alive ? "" : " (exited)");
+  }
+  Serial.printf("[SYSMON] heap free %lu B, min %lu B, largest %lu B | lvgl free %lu B, min %lu B, frag %u%%\n",
+                static_cast<unsigned long>(snap.heap.free_heap),
+                static_cast<unsigned long>(snap.heap.min_free_heap),
+                static_cast<unsigned long>(snap.heap.largest_block),
+                static_cast<unsigned long>(snap.heap.lvgl_free),
+                static_cast<unsigned long>(snap.heap.lvgl_min_free),
+                static_cast<unsigned>(snap.heap.lvgl_frag_pct));
+}
@@ -0,0 +1,567 @@
+/*
+ * ARCHI - TLSF Heap Implementation
+ *
+ * Block layout follows the classic TLSF scheme: a used block costs one
+ * size_t of header; the prev_phys pointer of a block lives in the last word
+ * of the previous block's payload and is only written while that block is
+ * free. The size word packs the payload size (bits 2..23), the free and
+ * prev-free flags (bits 0..1) and the tag (bits 24..31).
+ *
+ * Plain C++ with no platform dependency: the same file runs on the target
+ * and in the native build.
+ */
+
+#include "tlsf_heap.h"
+
+#include <string.h>
+
+#define BLOCK_FREE_BIT       ((size_t)1U)
+#define BLOCK_PREV_FREE_BIT  ((size_t)2U)
+#define BLOCK_TAG_SHIFT      24U
+#define BLOCK_SIZE_MASK      ((((size_t)1U) << BLOCK_TAG_SHIFT) - 1U - BLOCK_FREE_BIT - BLOCK_PREV_FREE_BIT)
+
+#define BLOCK_OVERHEAD       (sizeof(size_t))
+#define BLOCK_PTR_OFFSET     (offsetof(tlsf_block_t, next_free))
+#define BLOCK_SIZE_MIN       (sizeof(tlsf_block_t) - sizeof(tlsf_block_t*))
+#define BLOCK_SIZE_MAX       (((size_t)1U) << TLSF_HEAP_FL_MAX)
+#define SMALL_BLOCK_SIZE     (((size_t)1U) << TLSF_HEAP_FL_SHIFT)
+
+static_assert(TLSF_HEAP_FL_MAX < BLOCK_TAG_SHIFT, "size bits overlap the tag");
+static_assert(TLSF_HEAP_FL_COUNT <= 32, "first-level bitmap is 32 bits");
+static_assert(TLSF_HEAP_TAG_COUNT <= 256, "tags are stored on 8 bits");
+
+// ---------------------------------------------------------------------------
+// Bit helpers
+// ---------------------------------------------------------------------------
+
+static inline int ffs_u32(uint32_t word)
+{
+  return word ? __builtin_ctz(word) : -1;
+}
+
+static inline int fls_size(size_t size)
+{
+  return size ? static_cast<int>(sizeof(unsigned long) * 8U) - 1 -
+                    __builtin_clzl(static_cast<unsigned long>(size))
+              : -1;
+}
+
+static inline size_t align_up(size_t x, size_t align)
+{
+  return (x + (align - 1)) & ~(align - 1);
+}
+
+static inline size_t align_down(size_t x, size_t align)
+{
+  return x - (x & (align - 1));
+}
+
+// ---------------------------------------------------------------------------
+// Block header accessors
+// ---------------------------------------------------------------------------
+
+static inline size_t block_size(const tlsf_block_t* block)
+{
+  return block->size & BLOCK_SIZE_MASK;
+}
+
+static inline void block_set_size(tlsf_block_t* block, size_t size)
+{
+  block->size = size | (block->size & ~BLOCK_SIZE_MASK);
+}
+
+static inline bool block_is_last(const tlsf_block_t* block)
+{
+  return block_size(block) == 0;
+}
+
+static inline bool block_is_free(const tlsf_block_t* block)
+{
+  return (block->size & BLOCK_FREE_BIT) != 0;
+}
+
+static inline void block_set_free(tlsf_block_t* block, bool free)
+{
+  block->size = free ? (block->size | BLOCK_FREE_BIT) : (block->size & ~BLOCK_FREE_BIT);
+}
+
+static inline bool block_is_prev_free(const tlsf_block_t* block)
+{
+  return (block->size & BLOCK_PREV_FREE_BIT) != 0;
+}
+
+static inline void block_set_prev_free(tlsf_block_t* block, bool free)
+{
+  block->size = free ? (block->size | BLOCK_PREV_FREE_BIT) : (block->size & ~BLOCK_PREV_FREE_BIT);
+}
+
+static inline uint8_t block_tag(const tlsf_block_t* block)
+{
+  return static_cast<uint8_t>(block->size >> BLOCK_TAG_SHIFT);
+}
+
+static inline void block_set_tag(tlsf_block_t* block, uint8_t tag)
+{
+  block->size = (block->size & ((((size_t)1U) << BLOCK_TAG_SHIFT) - 1U)) |
+                (static_cast<size_t>(tag) << BLOCK_TAG_SHIFT);
+}
+
+static inline tlsf_block_t* block_from_ptr(const void* ptr)
+{
+  return reinterpret_cast<tlsf_block_t*>(const_cast<uint8_t*>(static_cast<const uint8_t*>(ptr)) - BLOCK_PTR_OFFSET);
+}
+
+static inline void* block_to_ptr(const tlsf_block_t* block)
+{
+  return const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(block)) + BLOCK_PTR_OFFSET;
+}
+
+static inline tlsf_block_t* offset_to_block(const void* ptr, size_t offset)
+{
+  return reinterpret_cast<tlsf_block_t*>(const_cast<uint8_t*>(static_cast<const uint8_t*>(ptr)) + offset);
+}
+
+// Physical successor: its header starts over the last word of our payload
+static inline tlsf_block_t* block_next(const tlsf_block_t* block)
+{
+  return offset_to_block(block_to_ptr(block), block_size(block) - BLOCK_OVERHEAD);
+}
+
+static inline tlsf_block_t* block_link_next(tlsf_block_t* block)
+{
+  tlsf_block_t* next = block_next(block);
+  next->prev_phys = block;
+  return next;
+}
+
+static inline void block_mark_as_free(tlsf_block_t* block)
+{
+  tlsf_block_t* next = block_link_next(block);
+  block_set_prev_free(next, true);
+  block_set_free(block, true);
+}
+
+static inline void block_mark_as_used(tlsf_block_t* block)
+{
+  tlsf_block_t* next = block_next(block);
+  block_set_prev_free(next, false);
+  block_set_free(block, false);
+}
+
+// ---------------------------------------------------------------------------
+// Size classes
+// ---------------------------------------------------------------------------
+
+static void mapping_insert(size_t size, int* fl, int* sl)
+{
+  if (size < SMALL_BLOCK_SIZE) {
+    *fl = 0;
+    *sl = static_cast<int>(size / (SMALL_BLOCK_SIZE / TLSF_HEAP_SL_COUNT));
+  } else {
+    int f = fls_size(size);
+    *sl = static_cast<int>(size >> (f - TLSF_HEAP_SL_LOG2)) ^ static_cast<int>(TLSF_HEAP_SL_COUNT);
+    *fl = f - (TLSF_HEAP_FL_SHIFT - 1);
+  }
+}
+
+// Round up to the next class boundary so any block in the class fits
+static void mapping_search(size_t size, int* fl, int* sl)
+{
+  if (size >= SMALL_BLOCK_SIZE) {
+    size += (((size_t)1U) << (fls_size(size) - TLSF_HEAP_SL_LOG2)) - 1;
+  }
+  mapping_insert(size, fl, sl);
+}
+
+static size_t adjust_request_size(size_t size)
+{
+  if (size == 0 || size >= BLOCK_SIZE_MAX) return 0;
+  size_t aligned = align_up(size, TLSF_HEAP_ALIGN);
+  if (aligned >= BLOCK_SIZE_MAX) return 0;
+  return aligned < BLOCK_SIZE_MIN ? BLOCK_SIZE_MIN : aligned;
+}
+
+// ---------------------------------------------------------------------------
+// Free lists
+// ---------------------------------------------------------------------------
+
+static void remove_free_block(tlsf_heap_t* heap, tlsf_block_t* block, int fl, int sl)
+{
+  tlsf_block_t* prev = block->prev_free;
+  tlsf_block_t* next = block->next_free;
+  next->prev_free = prev;
+  prev->next_free = next;
+
+  if (heap->blocks[fl][sl] == block) {
+    heap->blocks[fl][sl] = next;
+    if (next == &heap->null_block) {
+      heap->sl_bitmap[fl] &= ~(1U << sl);
+      if (!heap->sl_bitmap[fl]) {
+        heap->fl_bitmap &= ~(1U << fl);
+      }
+    }
+  }
+
+  heap->free_bytes -= static_cast<uint32_t>(block_size(block));
+  heap->free_blocks--;
+}
+
+static void insert_free_block(tlsf_heap_t* heap, tlsf_block_t* block, int fl, int sl)
+{
+  tlsf_block_t* current = heap->blocks[fl][sl];
+  block->next_free = current;
+  block->prev_free = &heap->null_block;
+  current->prev_free = block;
+
+  heap->blocks[fl][sl] = block;
+  heap->fl_bitmap |= (1U << fl);
+  heap->sl_bitmap[fl] |= (1U << sl);
+
+  heap->free_bytes += static_cast<uint32_t>(block_size(block));
+  heap->free_blocks++;
+}
+
+static void block_remove(tlsf_heap_t* heap, tlsf_block_t* block)
+{
+  int fl, sl;
+  mapping_insert(block_size(block), &fl, &sl);
+  remove_free_block(heap, block, fl, sl);
+}
+
+static void block_insert(tlsf_heap_t* heap, tlsf_block_t* block)
+{
+  int fl, sl;
+  mapping_insert(block_size(block), &fl, &sl);
+  insert_free_block(heap, block, fl, sl);
+}
+
+static tlsf_block_t* search_suitable_block(tlsf_heap_t* heap, int* fli, int* sli)
+{
+  int fl = *fli;
+  int sl = *sli;
+  if (fl >= static_cast<int>(TLSF_HEAP_FL_COUNT)) return NULL;
+
+  uint32_t sl_map = heap->sl_bitmap[fl] & (~0U << sl);
+  if (!sl_map) {
+    uint32_t fl_map = (fl + 1 < 32) ? (heap->fl_bitmap & (~0U << (fl + 1))) : 0;
+    if (!fl_map) return NULL;
+    fl = ffs_u32(fl_map);
+    sl_map = heap->sl_bitmap[fl];
+  }
+  sl = ffs_u32(sl_map);
+
+  *fli = fl;
+  *sli = sl;
+  return heap->blocks[fl][sl];
+}
+
+// ---------------------------------------------------------------------------
+// Split / coalesce
+// ---------------------------------------------------------------------------
+
+static bool block_can_split(const tlsf_block_t* block, size_t size)
+{
+  return block_size(block) >= sizeof(tlsf_block_t) + size;
+}
+
+static tlsf_block_t* block_split(tlsf_block_t* block, size_t size)
+{
+  tlsf_block_t* remaining = offset_to_block(block_to_ptr(block), size - BLOCK_OVERHEAD);
+  remaining->size = block_size(block) - (size + BLOCK_OVERHEAD);
+  block_set_size(block, size);
+  block_mark_as_free(remaining);
+  return remaining;
+}
+
+static tlsf_block_t* block_absorb(tlsf_block_t* prev, tlsf_block_t* block)
+{
+  block_set_size(prev, block_size(prev) + block_size(block) + BLOCK_OVERHEAD);
+  block_link_next(prev);
+  return prev;
+}
+
+static tlsf_block_t* block_merge_prev(tlsf_heap_t* heap, tlsf_block_t* block)
+{
+  if (block_is_prev_free(block)) {
+    tlsf_block_t* prev = block->prev_phys;
+    block_remove(heap, prev);
+    block = block_absorb(prev, block);
+  }
+  return block;
+}
+
+static tlsf_block_t* block_merge_next(tlsf_heap_t* heap, tlsf_block_t* block)
+{
+  tlsf_block_t* next = block_next(block);
+  if (block_is_free(next)) {
+    block_remove(heap, next);
+    block = block_absorb(block, next);
+  }
+  return block;
+}
+
+// Free block, already off its list: give the tail back if it is worth it
+static void block_trim_free(tlsf_heap_t* heap, tlsf_block_t* block, size_t size)
+{
+  if (block_can_split(block, size)) {
+    tlsf_block_t* remaining = block_split(block, size);
+    block_link_next(block);
+    block_set_prev_free(remaining, true);
+    block_insert(heap, remaining);
+  }
+}
+
+// Used block shrinking in place: the tail may coalesce with a free neighbour
+static void block_trim_used(tlsf_heap_t* heap, tlsf_block_t* block, size_t size)
+{
+  if (block_can_split(block, size)) {
+    tlsf_block_t* remaining = block_split(block, size);
+    block_set_prev_free(remaining, false);
+    remaining = block_merge_next(heap, remaining);
+    block_insert(heap, remaining);
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Accounting
+// ---------------------------------------------------------------------------
+
+static void account_used(tlsf_heap_t* heap, const tlsf_block_t* block)
+{
+  uint32_t size = static_cast<uint32_t>(block_size(block));
+  heap->used_bytes += size;
+  heap->used_blocks++;
+  if (heap->used_bytes > heap->peak_used_bytes) heap->peak_used_bytes = heap->used_bytes;
+
+  tlsf_heap_tag_stats_t* tag = &heap->tags[block_tag(block) % TLSF_HEAP_TAG_COUNT];
+  tag->bytes += size;
+  tag->blocks++;
+  if (tag->bytes > tag->peak_bytes) tag->peak_bytes = tag->bytes;
+}
+
+static void account_released(tlsf_heap_t* heap, const tlsf_block_t* block)
+{
+  uint32_t size = static_cast<uint32_t>(block_size(block));
+  heap->used_bytes -= size;
+  heap->used_blocks--;
+
+  tlsf_heap_tag_stats_t* tag = &heap->tags[block_tag(block) % TLSF_HEAP_TAG_COUNT];
+  tag->bytes -= size;
+  tag->blocks--;
+}
+
+// ---------------------------------------------------------------------------
+// Public API
+// ---------------------------------------------------------------------------
+
+void tlsf_heap_init(tlsf_heap_t* heap)
+{
+  memset(heap, 0, sizeof(*heap));
+  heap->null_block.next_free = &heap->null_block;
+  heap->null_block.prev_free = &heap->null_block;
+  for (uint32_t i = 0; i < TLSF_HEAP_FL_COUNT; ++i) {
+    for (uint32_t j = 0; j < TLSF_HEAP_SL_COUNT; ++j) {
+      heap->blocks[i][j] = &heap->null_block;
+    }
+  }
+}
+
+bool tlsf_heap_add_region(tlsf_heap_t* heap, void* mem, size_t bytes)
+{
+  if (!heap || !mem || heap->region_count >= TLSF_HEAP_MAX_REGIONS) return false;
+
+  uintptr_t start = reinterpret_cast<uintptr_t>(mem);
+  uintptr_t aligned = align_up(start, TLSF_HEAP_ALIGN);
+  if (bytes <= (aligned - start) + TLSF_HEAP_REGION_OVERHEAD) return false;
+
+  size_t region_bytes = align_down(bytes - (aligned - start) - TLSF_HEAP_REGION_OVERHEAD, TLSF_HEAP_ALIGN);
+  if (region_bytes < BLOCK_SIZE_MIN || region_bytes >= BLOCK_SIZE_MAX) return false;
+
+  // The first header starts one pointer early: its prev_phys is never used
+  tlsf_block_t* block = reinterpret_cast<tlsf_block_t*>(aligned - sizeof(tlsf_block_t*));
+  block->size = region_bytes;
+  block_set_free(block, true);
+  block_set_prev_free(block, false);
+  block_insert(heap, block);
+
+  // Zero-sized, used sentinel stops coalescing at the end of the region
+  tlsf_block_t* sentinel = block_link_next(block);
+  sentinel->size = 0;
+  block_set_free(sentinel, false);
+  block_set_prev_free(sentinel, true);
+
+  heap->regions[heap->region_count] = block;
+  heap->region_ends[heap->region_count] = sentinel;
+  heap->region_count++;
+  heap->total_bytes += static_cast<uint32_t>(region_bytes);
+  return true;
+}
+
+void* tlsf_heap_malloc(tlsf_heap_t* heap, size_t size, uint8_t tag)
+{
+  size_t adjusted = adjust_request_size(size);
+  heap->alloc_calls++;
+  if (!adjusted) {
+    heap->failed_allocs++;
+    return NULL;
+  }
+
+  int fl, sl;
+  mapping_search(adjusted, &fl, &sl);
+  tlsf_block_t* block = search_suitable_block(heap, &fl, &sl);
+  if (!block || block == &heap->null_block) {
+    heap->failed_allocs++;
+    return NULL;
+  }
+
+  remove_free_block(heap, block, fl, sl);
+  block_trim_free(heap, block, adjusted);
+  block_mark_as_used(block);
+  block_set_tag(block, tag);
+  account_used(heap, block);
+  return block_to_ptr(block);
+}
+
+void tlsf_heap_free(tlsf_heap_t* heap, void* ptr)
+{
+  if (!ptr) return;
+
+  tlsf_block_t* block = block_from_ptr(ptr);
+  heap->free_calls++;
+  account_released(heap, block);
+
+  block_set_tag(block, 0);
+  block_mark_as_free(block);
+  block = block_merge_prev(heap, block);
+  block = block_merge_next(heap, block);
+  block_insert(heap, block);
+}
+
+void* tlsf_heap_realloc(tlsf_heap_t* heap, void* ptr, size_t size, uint8_t tag)
+{
+  if (ptr && size == 0) {
+    tlsf_heap_free(heap, ptr);
+    return NULL;
+  }
+  if (!ptr) {
+    return tlsf_heap_malloc(heap, size, tag);
+  }
+
+  tlsf_block_t* block = block_from_ptr(ptr);
+  tlsf_block_t* next = block_next(block);
+  size_t current = block_size(block);
+  size_t combined = current + block_size(next) + BLOCK_OVERHEAD;
+  size_t adjusted = adjust_request_size(size);
+  if (!adjusted) {
+    heap->failed_allocs++;
+    return NULL;
+  }
+
+  if (adjusted > current && (!block_is_free(next) || adjusted > combined)) {
+    void* moved = tlsf_heap_malloc(heap, size, block_tag(block));
+    if (moved) {
+      memcpy(moved, ptr, current < size ? current : size);
+      tlsf_heap_free(heap, ptr);
+    }
+    return moved;
+  }
+
+  account_released(heap, block);
+  if (adjusted > current) {
+    block_merge_next(heap, block);
+    block_mark_as_used(block);
+  }
+  block_trim_used(heap, block, adjusted);
+  account_used(heap, block);
+  return ptr;
+}
+
+size_t tlsf_heap_block_size(const void* ptr)
+{
+  return ptr ? block_size(block_from_ptr(ptr)) : 0;
+}
+
+uint8_t tlsf_heap_block_tag(const void* ptr)
+{
+  return ptr ? block_tag(block_from_ptr(ptr)) : 0;
+}
+
+size_t tlsf_heap_largest_free(const tlsf_heap_t* heap)
+{
+  if (!heap->fl_bitmap) return 0;
+
+  // Every block of the highest non-empty class beats every lower class
+  int fl = fls_size(heap->fl_bitmap);
+  int sl = fls_size(heap->sl_bitmap[fl]);
+  size_t largest = 0;
+  for (const tlsf_block_t* block = heap->blocks[fl][sl];
+       block != &heap->null_block; block = block->next_free) {
+    if (block_size(block) > largest) largest = block_size(block);
+  }
+  return largest;
+}
+
+bool tlsf_heap_owns(const tlsf_heap_t* heap, const void* ptr)
+{
+  uintptr_t p = reinterpret_cast<uintptr_t>(ptr);
+  for (uint8_t i = 0; i < heap->region_count; ++i) {
+    if (p >= reinterpret_cast<uintptr_t>(heap->regions[i]) &&
+        p < reinterpret_cast<uintptr_t>(heap->region_ends[i])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint32_t tlsf_heap_check(const tlsf_heap_t* heap)
+{
+  uint32_t errors = 0;
+  uint32_t free_bytes = 0;
+  uint32_t free_blocks = 0;
+  uint32_t used_bytes = 0;
+  uint32_t used_blocks = 0;
+
+  // Physical walk: flags agree with neighbours, no two adjacent free blocks
+  for (uint8_t i = 0; i < heap->region_count; ++i) {
+    const tlsf_block_t* block = heap->regions[i];
+    bool prev_free = false;
+    while (!block_is_last(block)) {
+      if (block_is_prev_free(block) != prev_free) errors++;
+      if (block_is_free(block)) {
+        if (prev_free) errors++;
+        if (block_next(block)->prev_phys != block) errors++;
+        free_bytes += static_cast<uint32_t>(block_size(block));
+        free_blocks++;
+      } else {
+        used_bytes += static_cast<uint32_t>(block_size(block));
+        used_blocks++;
+      }
+      prev_free = block_is_free(block);
+      block = block_next(block);
+    }
+    if (block_is_prev_free(block) != prev_free) errors++;
+  }
+
+  // Free lists: every listed block is free, sits in the right class and
+  // its bitmap bits are set
+  uint32_t listed = 0;
+  for (uint32_t fl = 0; fl < TLSF_HEAP_FL_COUNT; ++fl) {
+    for (uint32_t sl = 0; sl < TLSF_HEAP_SL_COUNT; ++sl) {
+      const tlsf_block_t* block = heap->blocks[fl][sl];
+      bool bit = (heap->sl_bitmap[fl] & (1U << sl)) != 0;
+      if (bit != (block != &heap->null_block)) errors++;
+      for (; block != &heap->null_block; block = block->next_free) {
+        int bfl, bsl;
+        mapping_insert(block_size(block), &bfl, &bsl);
+        if (!block_is_free(block) || bfl != static_cast<int>(fl) || bsl != static_cast<int>(sl)) errors++;
+        listed++;
+      }
+    }
+    if (((heap->fl_bitmap >> fl) & 1U) != (heap->sl_bitmap[fl] ? 1U : 0U)) errors++;
+  }
+
+  if (listed != free_blocks || free_blocks != heap->free_blocks) errors++;
+  if (free_bytes != heap->free_bytes || used_bytes != heap->used_bytes) errors++;
+  if (used_blocks != heap->used_blocks) errors++;
+  return errors;
+}
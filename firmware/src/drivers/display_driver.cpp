@@ -2,9 +2,15 @@
 #include "board_config.h" // Assure-toi que BACKLIGHT_PIN y est défini (21)
 
 #include <Arduino.h>
+
+#if MOCK_TFT_ESPI
+// Build natif : framebuffer mémoire (lib/native_sim) à la place de l'ILI9341
+#include "native_sim.h"
+#else
 #include <TFT_eSPI.h>
 
 static TFT_eSPI tft = TFT_eSPI();
+#endif
 
 // --- CONFIGURATION PWM ---
 // Si BACKLIGHT_PIN n'est pas défini, on force la 21
@@ -21,6 +27,10 @@ static TFT_eSPI tft = TFT_eSPI();
 
 void display_hw_init(void)
 {
+#if MOCK_TFT_ESPI
+    Serial.println("ARCHI: Display init (mock framebuffer)");
+    sim_display_init(DISP_HOR_RES, DISP_VER_RES);
+#else
     Serial.println("ARCHI: Display init (TFT_eSPI + LEDC Low)");
     tft.init();
     tft.setRotation(1);
@@ -36,29 +46,46 @@ void display_hw_init(void)
     
     // 3. Écriture de la valeur (40/255)
     ledcWrite(BL_CHANNEL, BL_VAL); 
+#endif
 }
 
 void display_hw_deinit(void)
 {
+#if MOCK_TFT_ESPI
+    sim_display_set_backlight(false);
+#else
     ledcWrite(BL_CHANNEL, 0);
+#endif
 }
 
 void display_hw_set_rotation(uint8_t rotation)
 {
+#if MOCK_TFT_ESPI
+    sim_display_set_rotation(rotation);
+#else
     tft.setRotation(rotation);
+#endif
 }
 
 void display_hw_set_backlight(bool on)
 {
+#if MOCK_TFT_ESPI
+    sim_display_set_backlight(on);
+#else
     // On/Off via PWM
     ledcWrite(BL_CHANNEL, on ? BL_VAL : 0);
+#endif
 }
 
 void display_hw_push_pixels(int32_t x1, int32_t y1, uint32_t w, uint32_t h, const uint16_t* color_p)
 {
+#if MOCK_TFT_ESPI
+    sim_display_push(x1, y1, w, h, color_p);
+#else
     tft.startWrite();
     tft.setAddrWindow(x1, y1, w, h);
     // Swap activé pour corriger les couleurs
     tft.pushColors(const_cast<uint16_t*>(color_p), w * h, true);
     tft.endWrite();
+#endif
 }
\ No newline at end of file
@@ -7,14 +7,19 @@
 
 #include "touch_driver.h"
 #include "board_config.h"
+#include "rtos_static.h"
 
 #include <Arduino.h>
 #include <stdio.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 
+#if MOCK_TOUCH
+#include "native_sim.h"
+#else
 #include <SPI.h>
 #include <XPT2046_Touchscreen.h>
+#endif
 
 #define XPT2046_IRQ 36
 #define XPT2046_MOSI 32
@@ -32,11 +37,14 @@ typedef struct {
 
 static touch_state_t g_touch_state = {0, 0, false};
 static SemaphoreHandle_t g_touch_mutex = NULL;
+static StaticSemaphore_t g_touch_mutex_cb;
+#if !MOCK_TOUCH
 static SPIClass touchscreenSPI = SPIClass(VSPI);
 static XPT2046_Touchscreen ts(XPT2046_CS, XPT2046_IRQ);
 
 // Utility: map function (Arduino-style) with clamping
 static uint16_t map_value(uint16_t x, uint16_t in_min, uint16_t in_max, uint16_t out_min, uint16_t out_max);
+#endif
 
 void cyd_touch_init(void)
 {
@@ -44,13 +52,16 @@ void cyd_touch_init(void)
   
   // Create touch mutex
   if (!g_touch_mutex) {
-    g_touch_mutex = xSemaphoreCreateMutex();
+    g_touch_mutex = rtos_static_mutex("touch", &g_touch_mutex_cb);
     if (!g_touch_mutex) {
       Serial.println("ERROR: Failed to create touch mutex");
       return;
     }
   }
   
+#if MOCK_TOUCH
+  Serial.println("ARCHI: Touch mock (scripted input)");
+#else
   // *** IMPORTANT *** : initialiser le SPI du touch sur les bons pins
   touchscreenSPI.begin(XPT2046_CLK, XPT2046_MISO, XPT2046_MOSI, XPT2046_CS);
 
@@ -60,12 +71,18 @@ void cyd_touch_init(void)
     return;
   }
   Serial.println("ARCHI: XPT2046 touchscreen initialized");
+#endif
 }
 
 bool cyd_touch_read(uint16_t * x, uint16_t * y)
 {
   bool pressed = false;
   
+#if MOCK_TOUCH
+  // Script coordinates are already in display space
+  uint16_t tx = 0, ty = 0;
+  if (sim_touch_read(&tx, &ty)) {
+#else
   if (ts.touched()) {
     TS_Point p = ts.getPoint();
 
@@ -73,6 +90,7 @@ bool cyd_touch_read(uint16_t * x, uint16_t * y)
     // These values depend on your display rotation and calibration
     uint16_t tx = map_value(p.x, TS_MINX, TS_MAXX, 0, DISP_HOR_RES - 1);
     uint16_t ty = map_value(p.y, TS_MINY, TS_MAXY, 0, DISP_VER_RES - 1);
+#endif
     
     if (xSemaphoreTake(g_touch_mutex, pdMS_TO_TICKS(10))) {
       g_touch_state.x = tx;
@@ -108,6 +126,7 @@ void cyd_touch_deinit(void)
   }
 }
 
+#if !MOCK_TOUCH
 // Utility: map function (Arduino-style)
 static uint16_t map_value(uint16_t x, uint16_t in_min, uint16_t in_max, uint16_t out_min, uint16_t out_max)
 {
@@ -115,4 +134,5 @@ static uint16_t map_value(uint16_t x, uint16_t in_min, uint16_t in_max, uint16_t
   if (x > in_max) x = in_max;
   return (uint16_t)((uint32_t)(x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min);
 }
+#endif
 
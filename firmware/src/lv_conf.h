@@ -23,14 +23,22 @@
 /* ==========================================
    MÉMOIRE
    ========================================== */
-/* 0: Utiliser l'allocateur interne de LVGL (plus simple pour débuter)
- * 1: Utiliser malloc/free de l'ESP32 */
-#define LV_MEM_CUSTOM 0
-
-/* Taille du tas (heap) interne à LVGL en Kilooctets.
- * 48Ko est confortable pour un ESP32 sans PSRAM. */
-#if LV_MEM_CUSTOM == 0
-    #define LV_MEM_SIZE (48U * 1024U)
+/* 0: Utiliser l'allocateur interne de LVGL
+ * 1: Allocateur TLSF du projet (include/lvgl_heap.h) : même pool statique,
+ *    plus la fragmentation et la consommation par écran / style / ligne. */
+#define LV_MEM_CUSTOM 1
+
+/* Taille du tas (heap) LVGL en Kilooctets (pool principal de lvgl_heap).
+ * 48Ko est confortable pour un ESP32 sans PSRAM.
+ * Régions supplémentaires prises sur le tas ESP32 au démarrage :
+ * -D LVGL_HEAP_EXTRA_REGIONS=1 (voir platformio.ini). */
+#define LV_MEM_SIZE (48U * 1024U)
+
+#if LV_MEM_CUSTOM
+    #define LV_MEM_CUSTOM_INCLUDE "lvgl_heap.h"
+    #define LV_MEM_CUSTOM_ALLOC   lvgl_heap_alloc
+    #define LV_MEM_CUSTOM_FREE    lvgl_heap_free
+    #define LV_MEM_CUSTOM_REALLOC lvgl_heap_realloc
 #endif
 
 /* ==========================================
@@ -1,11 +1,15 @@
 #include <Arduino.h>
 #include "system_init.h"
 #include "board_config.h"
+#include "serial_export.h"
 
 void setup() {
     // Initialize serial logging
+#if SERIAL_EXPORT_ENABLED
+    Serial.begin(SERIAL_EXPORT_BAUD);
+#else
     Serial.begin(115200);
-    delay(500);
+#endif
     
     Serial.println("\n\n=== Acyd-Gotchi Boot ===");
     Serial.println("Initializing system...");
@@ -1,6 +1,35 @@
+/*
+ * NETSEC - BLE scan
+ *
+ * Scan lifecycle is one atomic word: state, two request flags and a scan
+ * generation, changed only by compare-and-swap (netsec_ble_state.h).
+ *
+ * Callers (netsec task, UI, timer callback) only request transitions and
+ * never wait: a start while busy sets RESTART on the way to STOPPING, a stop
+ * during a pending restart drops the restart. Only the ble_scan worker
+ * leaves STOPPING, so each generation is finalized exactly once, with one
+ * STARTED and one COMPLETED/CANCELED event. A stop also aborts the radio's
+ * blocking scan call, so the worker sees it within the BLE stop latency.
+ *
+ * Within a scan the worker also runs the duty-cycle policy (netsec_ble.h):
+ * the radio is set up for one level per 1 s slice, from the number of
+ * addresses the previous slice saw for the first time.
+ */
+
 #include "netsec_ble.h"
+#include "netsec_ble_state.h"
 #include "netsec_api.h"
+#include "netsec_survey.h"
+#include "netsec_sketch.h"
+#include "netsec_known.h"
+#include "netsec_registry.h"
+#include "serial_export.h"
+#include "deferred_log.h"
+#include "sysmon.h"
+#include "cpuprof.h"
+#include "rtos_static.h"
 #include <Arduino.h>
+#include <atomic>
 #include <string>
 #include <stdio.h>
 #include <freertos/FreeRTOS.h>
@@ -12,11 +41,52 @@
 #include <BLEScan.h>
 #endif
 
-static BLEScan* s_ble_scan = nullptr;
-static bool s_ble_scan_running = false;
-static bool s_ble_cancel_requested = false;
+static std::atomic<uint32_t> s_ble_state(BLE_STATE_IDLE);
+static std::atomic<uint32_t> s_ble_next_duration_ms(0);   // Read by the worker when it leaves STARTING
+static std::atomic<uint32_t> s_ble_timer_gen(0);          // Scan the armed timeout belongs to
+static std::atomic<BLEScan*> s_ble_scan(nullptr);         // Published before SCANNING
+static netsec_ble_lifecycle_stats_t s_ble_stats;           // Written by the worker only
+
+#ifndef NETSEC_BLE_ADAPT_QUIET_SLICES
+#define NETSEC_BLE_ADAPT_QUIET_SLICES 3     // Slices without a new address to leave level 0
+#endif
+
+typedef struct {
+  bool active;
+  uint16_t interval_ms;
+  uint16_t window_ms;
+} netsec_ble_level_t;
+
+static const netsec_ble_level_t k_ble_levels[NETSEC_BLE_POLICY_LEVELS] = {
+  {true, 100, 99},      // Fixed setting up to now
+  {true, 100, 60},
+  {false, 100, 30},
+  {false, 200, 30},
+};
+
+#ifdef NETSEC_BLE_FIXED_DUTY
+static std::atomic<bool> s_ble_adaptive(false);
+#else
+static std::atomic<bool> s_ble_adaptive(true);
+#endif
+
+// Policy state, written by the worker; readers copy s_ble_policy under the lock
+static uint8_t s_ble_seen[NETSEC_BLE_SEEN_MAX][6];
+static uint32_t s_ble_seen_used[(NETSEC_BLE_SEEN_MAX + 31) / 32];
+static uint32_t s_ble_seen_overflow[NETSEC_BLE_SEEN_OVERFLOW_BITS / 32];
+static uint32_t s_ble_slices = 0;
+static uint16_t s_ble_quiet_slices = 0;
+static uint16_t s_ble_curve_stride = 1;    // Slices per curve point
+static portMUX_TYPE s_ble_policy_lock = portMUX_INITIALIZER_UNLOCKED;
+static netsec_ble_policy_t s_ble_policy = {false, false, 0, true, 100, 99, 0, 0, 0, 0, {}};
+
 static TaskHandle_t s_ble_scan_task = nullptr;
 static TimerHandle_t s_ble_scan_timer = nullptr;
+static StaticTask_t s_ble_scan_tcb;
+static StackType_t s_ble_scan_stack[NETSEC_BLE_SCAN_TASK_STACK_SIZE / sizeof(StackType_t)];
+static StaticTimer_t s_ble_scan_timer_cb;
+
+// Per-scan data, owned by the worker
 static netsec_ble_device_t s_ble_devices[NETSEC_BLE_DEVICE_BUFFER_SIZE];
 static size_t s_ble_device_write_idx = 0;
 static uint32_t s_ble_scan_start_ms = 0;
@@ -24,6 +94,8 @@ static uint16_t s_ble_devices_reported = 0;
 
 enum {
   NETSEC_BLE_NOTIFY_CANCEL = 1 << 0,
+  NETSEC_BLE_NOTIFY_START = 1 << 1,
+  NETSEC_BLE_NOTIFY_POWER_DOWN = 1 << 2,
 };
 
 static void netsec_ble_post_scan_event(netsec_result_type_t type, uint16_t device_count, uint32_t duration_ms) {
@@ -36,102 +108,361 @@ static void netsec_ble_post_scan_event(netsec_result_type_t type, uint16_t devic
   res.data.scan_summary.item_count = device_count;
   res.data.scan_summary.duration_ms = duration_ms;
   res.data.scan_summary.timestamp_ms = millis();
-  xQueueSend(netsec_result_queue, &res, 0);
+  serial_export_scan_summary(type, &res.data.scan_summary);
+  sysmon_queue_send(SYSMON_QUEUE_NETSEC_RESULT, &res, 0);
 }
 
-static void netsec_ble_finalize_scan(bool canceled) {
 #if defined(ARDUINO_ARCH_ESP32)
-  if (s_ble_scan) {
-    s_ble_scan->stop();
-    s_ble_scan->clearResults();
+// True the first time an address shows up in this scan (open addressing, FNV-1a)
+static bool netsec_ble_seen_add(const uint8_t* addr) {
+  uint32_t h = 2166136261u;
+  for (int i = 0; i < 6; ++i) {
+    h = (h ^ addr[i]) * 16777619u;
   }
-#endif
+  for (uint16_t n = 0; n < NETSEC_BLE_SEEN_MAX; ++n) {
+    const uint16_t i = (h + n) % NETSEC_BLE_SEEN_MAX;
+    uint32_t* used = &s_ble_seen_used[i / 32];
+    if (!(*used & (1u << (i % 32)))) {
+      *used |= 1u << (i % 32);
+      memcpy(s_ble_seen[i], addr, 6);
+      return true;
+    }
+    if (memcmp(s_ble_seen[i], addr, 6) == 0) return false;
+  }
+  // Table full: one bit per address from here, so a crowd still reads as
+  // new devices (a collision only undercounts) instead of as a quiet scan
+  const uint32_t bit = (h * 2654435761u) % NETSEC_BLE_SEEN_OVERFLOW_BITS;
+  uint32_t* word = &s_ble_seen_overflow[bit / 32];
+  if (*word & (1u << (bit % 32))) return false;
+  *word |= 1u << (bit % 32);
+  return true;
+}
 
-  uint32_t elapsed_ms = s_ble_scan_start_ms ? (millis() - s_ble_scan_start_ms) : 0;
-  netsec_result_type_t evt_type = canceled ? NETSEC_RES_BLE_SCAN_CANCELED : NETSEC_RES_BLE_SCAN_COMPLETED;
-  netsec_ble_post_scan_event(evt_type, s_ble_devices_reported, elapsed_ms);
-  Serial.printf("[NETSEC:BLE] Scan %s: %u devices in %lu ms\n",
-                canceled ? "canceled" : "completed",
-                static_cast<unsigned>(s_ble_devices_reported),
-                static_cast<unsigned long>(elapsed_ms));
-
-  s_ble_scan_running = false;
-  s_ble_cancel_requested = false;
-  s_ble_scan_task = nullptr;
-  s_ble_scan_start_ms = 0;
-  s_ble_device_write_idx = 0;
+static void netsec_ble_apply_level(BLEScan* scan, uint8_t level) {
+  const netsec_ble_level_t* l = &k_ble_levels[level];
+  scan->setActiveScan(l->active);
+  scan->setInterval(l->interval_ms);
+  scan->setWindow(l->window_ms);
+}
 
-  if (s_ble_scan_timer) {
-    xTimerStop(s_ble_scan_timer, 0);
-    xTimerDelete(s_ble_scan_timer, 0);
-    s_ble_scan_timer = nullptr;
+static void netsec_ble_set_level_locked(uint8_t level) {
+  s_ble_policy.level = level;
+  s_ble_policy.active = k_ble_levels[level].active;
+  s_ble_policy.interval_ms = k_ble_levels[level].interval_ms;
+  s_ble_policy.window_ms = k_ble_levels[level].window_ms;
+}
+
+// Every scan starts at level 0 with an empty curve
+static void netsec_ble_policy_begin(BLEScan* scan) {
+  memset(s_ble_seen_used, 0, sizeof(s_ble_seen_used));
+  memset(s_ble_seen_overflow, 0, sizeof(s_ble_seen_overflow));
+  s_ble_slices = 0;
+  s_ble_quiet_slices = 0;
+  s_ble_curve_stride = 1;
+  netsec_ble_apply_level(scan, 0);
+
+  portENTER_CRITICAL(&s_ble_policy_lock);
+  memset(&s_ble_policy, 0, sizeof(s_ble_policy));
+  s_ble_policy.scanning = true;
+  netsec_ble_set_level_locked(0);
+  portEXIT_CRITICAL(&s_ble_policy_lock);
+}
+
+// Account a finished slice, then set the radio up for the next one
+static void netsec_ble_policy_slice(BLEScan* scan, uint32_t slice_ms, uint16_t new_devices) {
+  const uint8_t level = s_ble_policy.level;   // Only this task writes it
+  const netsec_ble_level_t* l = &k_ble_levels[level];
+  uint8_t next = level;
+  if (!s_ble_adaptive.load(std::memory_order_relaxed) || new_devices) {
+    next = 0;
+    s_ble_quiet_slices = 0;
+  } else if (level + 1 < NETSEC_BLE_POLICY_LEVELS &&
+             ++s_ble_quiet_slices >= (NETSEC_BLE_ADAPT_QUIET_SLICES << level)) {
+    next = level + 1;
+    s_ble_quiet_slices = 0;
+  }
+  s_ble_slices++;
+
+  portENTER_CRITICAL(&s_ble_policy_lock);
+  netsec_ble_policy_t* p = &s_ble_policy;
+  p->scan_ms += slice_ms;
+  p->radio_ms += slice_ms * l->window_ms / l->interval_ms;
+  p->unique += new_devices;
+  if (s_ble_slices % s_ble_curve_stride == 0) {
+    if (p->curve_len == NETSEC_BLE_CURVE_POINTS) {
+      for (uint8_t i = 0; i < NETSEC_BLE_CURVE_POINTS / 2; ++i) {
+        p->curve[i] = p->curve[2 * i + 1];
+      }
+      p->curve_len = NETSEC_BLE_CURVE_POINTS / 2;
+      s_ble_curve_stride *= 2;
+    }
+    if (s_ble_slices % s_ble_curve_stride == 0) {
+      netsec_ble_curve_point_t* pt = &p->curve[p->curve_len++];
+      pt->t_ms = p->scan_ms;
+      pt->unique = p->unique;
+      pt->level = level;
+    }
+  }
+  netsec_ble_set_level_locked(next);
+  const uint32_t scan_ms = p->scan_ms;
+  portEXIT_CRITICAL(&s_ble_policy_lock);
+
+  if (next != level) {
+    netsec_ble_apply_level(scan, next);
+    DLOG_I("[NETSEC:BLE] Duty level %u (%s, %u/%u ms) at %lu ms",
+           next, k_ble_levels[next].active ? "active" : "passive",
+           k_ble_levels[next].window_ms, k_ble_levels[next].interval_ms, scan_ms);
+  }
+}
+
+// Carry out what a lifecycle request left to its caller; true if it stopped the scan.
+static bool netsec_ble_act(ble_lc_action_t action) {
+  switch (action) {
+    case BLE_LC_ABORT_SCAN: {
+      BLEScan* scan = s_ble_scan.load(std::memory_order_acquire);
+      if (scan) scan->stop();   // Returns the worker from its blocking scan slice
+      xTaskNotify(s_ble_scan_task, NETSEC_BLE_NOTIFY_CANCEL, eSetBits);
+      return true;
+    }
+    case BLE_LC_WAKE_CANCEL:
+      xTaskNotify(s_ble_scan_task, NETSEC_BLE_NOTIFY_CANCEL, eSetBits);
+      return true;
+    case BLE_LC_WAKE_START:
+      xTaskNotify(s_ble_scan_task, NETSEC_BLE_NOTIFY_START, eSetBits);
+      return false;
+    default:
+      return false;
   }
 }
 
-#if defined(ARDUINO_ARCH_ESP32)
 static void netsec_ble_timeout_cb(TimerHandle_t xTimer) {
   (void)xTimer;
-  if (s_ble_scan_task) {
-    s_ble_scan_running = false;
-    xTaskNotify(s_ble_scan_task, NETSEC_BLE_NOTIFY_CANCEL, eSetBits);
+  netsec_ble_act(ble_lc_timeout(s_ble_state, s_ble_timer_gen.load(std::memory_order_relaxed)));
+}
+
+// Leave STOPPING: to IDLE, or straight into the next scan if a restart is pending.
+static void netsec_ble_finalize_scan(uint32_t started_gen) {
+  BLEScan* scan = s_ble_scan.load(std::memory_order_relaxed);
+  if (scan) {
+    scan->stop();
+    scan->clearResults();
+  }
+  if (s_ble_scan_timer) {
+    xTimerStop(s_ble_scan_timer, 0);
+  }
+
+  uint32_t w;
+  if (!ble_lc_finalize(s_ble_state, started_gen, &w)) {
+    s_ble_stats.errors++;   // Unreachable by construction: only this task leaves STOPPING
+    return;
+  }
+
+  const bool canceled = (w & BLE_FLAG_CANCELED) != 0;
+
+  portENTER_CRITICAL(&s_ble_policy_lock);
+  s_ble_policy.scanning = false;
+  const uint32_t radio_ms = s_ble_policy.radio_ms;
+  const uint32_t scan_ms = s_ble_policy.scan_ms;
+  const uint16_t unique = s_ble_policy.unique;
+  portEXIT_CRITICAL(&s_ble_policy_lock);
+
+  uint32_t elapsed_ms = s_ble_scan_start_ms ? (millis() - s_ble_scan_start_ms) : 0;
+  netsec_result_type_t evt_type = canceled ? NETSEC_RES_BLE_SCAN_CANCELED : NETSEC_RES_BLE_SCAN_COMPLETED;
+  // A canceled scan says nothing about the devices it did not get to
+  if (!canceled) {
+    netsec_registry_scan_done(NETSEC_DEVICE_BLE);
+  }
+  netsec_ble_post_scan_event(evt_type, s_ble_devices_reported, elapsed_ms);
+  DLOG_I("[NETSEC:BLE] Scan %s: %u devices in %lu ms",
+         canceled ? "canceled" : "completed",
+         s_ble_devices_reported,
+         elapsed_ms);
+  if (s_ble_slices) {
+    DLOG_I("[NETSEC:BLE] %u distinct, radio on %lu of %lu ms", unique, radio_ms, scan_ms);
+  }
+  netsec_sketch_log();
+
+  if (canceled) {
+    s_ble_stats.canceled++;
+  } else {
+    s_ble_stats.completed++;
+  }
+  if (w & BLE_FLAG_RESTART) {
+    s_ble_stats.restarts++;
   }
+  s_ble_scan_start_ms = 0;
+  s_ble_device_write_idx = 0;
 }
 
-static void netsec_ble_scan_task(void* pvParameters) {
-  uint32_t duration_ms = reinterpret_cast<uint32_t>(pvParameters);
-  const TickType_t stop_tick = xTaskGetTickCount() + pdMS_TO_TICKS(duration_ms);
-  bool canceled = false;
-
-  s_ble_scan_running = true;
-  Serial.printf("[NETSEC:BLE] Starting BLE scan for %lu ms\n", static_cast<unsigned long>(duration_ms));
-
-  while (s_ble_scan_running && xTaskGetTickCount() < stop_tick) {
-    // Slice the scan to allow cancellation checks without long blocking calls.
-    TickType_t remaining_ticks = stop_tick - xTaskGetTickCount();
-    uint32_t slice_ms = pdTICKS_TO_MS(remaining_ticks);
-    if (slice_ms > 500) {
-      slice_ms = 500;
-    }
-    uint32_t slice_s = (slice_ms + 999) / 1000;
-    if (slice_s == 0) {
-      slice_s = 1;
+// One generation, from STARTING to finalized. Stops may land at any point.
+static void netsec_ble_run_scan(uint32_t w) {
+  const uint32_t gen = ble_gen(w);
+  const uint32_t duration_ms = s_ble_next_duration_ms.load(std::memory_order_relaxed);
+
+  BLEScan* scan = s_ble_scan.load(std::memory_order_relaxed);
+  if (!scan) {
+    BLEDevice::init("");
+    scan = BLEDevice::getScan();
+    s_ble_scan.store(scan, std::memory_order_release);
+  }
+  netsec_ble_policy_begin(scan);
+  s_ble_device_write_idx = 0;
+  s_ble_devices_reported = 0;
+  s_ble_scan_start_ms = millis();
+  s_ble_stats.started++;
+  netsec_ble_post_scan_event(NETSEC_RES_BLE_SCAN_STARTED, 0, duration_ms);
+
+  // Fails only if a stop won the race: the scan ends before it began
+  if (ble_lc_begin(s_ble_state, w)) {
+    s_ble_timer_gen.store(gen, std::memory_order_relaxed);
+    if (s_ble_scan_timer) {
+      xTimerChangePeriod(s_ble_scan_timer, pdMS_TO_TICKS(duration_ms ? duration_ms : 1), 0);  // Also starts it
     }
+    DLOG_I("[NETSEC:BLE] Starting BLE scan for %lu ms", duration_ms);
+
+    const TickType_t stop_tick = xTaskGetTickCount() + pdMS_TO_TICKS(duration_ms);
+    while (ble_state(s_ble_state.load(std::memory_order_acquire)) == BLE_STATE_SCANNING &&
+           xTaskGetTickCount() < stop_tick) {
+      cpuprof_note_wake();
+      // Slice the scan to allow cancellation checks without long blocking calls.
+      TickType_t remaining_ticks = stop_tick - xTaskGetTickCount();
+      uint32_t slice_ms = pdTICKS_TO_MS(remaining_ticks);
+      if (slice_ms > 500) {
+        slice_ms = 500;
+      }
+      uint32_t slice_s = (slice_ms + 999) / 1000;
+      if (slice_s == 0) {
+        slice_s = 1;
+      }
 
-    BLEScanResults results = s_ble_scan->start(slice_s, false);
-    const int found = results.getCount();
-    for (int i = 0; i < found; ++i) {
-      BLEAdvertisedDevice dev = results.getDevice(i);
-      std::string name = dev.haveName() ? dev.getName() : std::string("");
-      uint32_t flags = static_cast<uint32_t>(dev.getAddressType());
-      netsec_ble_post_device(
-          name.c_str(),
-          dev.getRSSI(),
-          reinterpret_cast<const uint8_t*>(dev.getAddress().getNative()),
-          flags);
+      const uint32_t slice_start_ms = millis();
+      BLEScanResults results = scan->start(slice_s, false);
+      const uint32_t slice_elapsed_ms = millis() - slice_start_ms;
+      const int found = results.getCount();
+      uint16_t new_devices = 0;
+      for (int i = 0; i < found; ++i) {
+        BLEAdvertisedDevice dev = results.getDevice(i);
+        std::string name = dev.haveName() ? dev.getName() : std::string("");
+        uint32_t flags = static_cast<uint32_t>(dev.getAddressType());
+        BLEAddress address = dev.getAddress();
+        const uint8_t* addr = reinterpret_cast<const uint8_t*>(address.getNative());
+        if (netsec_ble_seen_add(addr)) {
+          new_devices++;
+        }
+        netsec_ble_post_device(name.c_str(), dev.getRSSI(), addr, flags);
+      }
+      scan->clearResults();
+      netsec_ble_policy_slice(scan, slice_elapsed_ms, new_devices);
     }
-    s_ble_scan->clearResults();
 
+    // Duration reached before the timer fired: complete it ourselves
+    ble_lc_end(s_ble_state, gen);
+  }
+
+  netsec_ble_finalize_scan(gen);
+}
+
+// Controller off until the next scan, which initializes it again. Only this
+// task touches the BLE stack, and SCANNING (the only state in which other
+// tasks use the scan object) is entered by this task alone.
+static void netsec_ble_release_radio(void) {
+  BLEScan* scan = s_ble_scan.load(std::memory_order_relaxed);
+  if (!scan || ble_state(s_ble_state.load(std::memory_order_acquire)) != BLE_STATE_IDLE) return;
+  s_ble_scan.store(nullptr, std::memory_order_release);
+  BLEDevice::deinit(false);
+}
+
+// Persistent worker: parks on its notification value between scans.
+static void netsec_ble_scan_task(void* pvParameters) {
+  (void)pvParameters;
+  for (;;) {
     uint32_t notify_value = 0;
-    if (xTaskNotifyWait(0, NETSEC_BLE_NOTIFY_CANCEL, &notify_value, 0) == pdTRUE) {
-      if (notify_value & NETSEC_BLE_NOTIFY_CANCEL) {
-        canceled = s_ble_cancel_requested;
-        break;
-      }
+    // Clearing both bits drops a cancel that arrived while parked
+    xTaskNotifyWait(0, NETSEC_BLE_NOTIFY_START | NETSEC_BLE_NOTIFY_CANCEL | NETSEC_BLE_NOTIFY_POWER_DOWN,
+                    &notify_value, portMAX_DELAY);
+    if (notify_value & NETSEC_BLE_NOTIFY_POWER_DOWN) {
+      netsec_ble_release_radio();
+    }
+    // STOPPING here means stopped before it began: still STARTED + CANCELED
+    uint32_t w;
+    while (ble_state(w = s_ble_state.load(std::memory_order_acquire)) == BLE_STATE_STARTING ||
+           ble_state(w) == BLE_STATE_STOPPING) {
+      netsec_ble_run_scan(w);
     }
   }
+}
+#endif
+
+void netsec_ble_init(void)
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  if (s_ble_scan_task) return;
 
-  if (!canceled && s_ble_cancel_requested) {
-    canceled = true;
+  s_ble_scan_timer = rtos_static_timer("ble_scan_timeout", 1, pdFALSE, nullptr,
+                                       netsec_ble_timeout_cb, &s_ble_scan_timer_cb);
+  s_ble_scan_task = rtos_static_task(netsec_ble_scan_task, "ble_scan", NETSEC_BLE_SCAN_TASK_STACK_SIZE,
+                                     nullptr, 1, s_ble_scan_stack, &s_ble_scan_tcb, 0);
+  if (!s_ble_scan_timer || !s_ble_scan_task) {
+    Serial.println("[ERROR] Failed to create BLE scan worker!");
+    return;
   }
+  sysmon_register_task(s_ble_scan_task, "ble_scan", NETSEC_BLE_SCAN_TASK_STACK_SIZE);
+#endif
+}
+
+void netsec_ble_set_adaptive(bool adaptive)
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  s_ble_adaptive.store(adaptive, std::memory_order_relaxed);
+#else
+  (void)adaptive;
+#endif
+}
+
+void netsec_ble_get_policy(netsec_ble_policy_t* out)
+{
+  if (!out) return;
+#if defined(ARDUINO_ARCH_ESP32)
+  portENTER_CRITICAL(&s_ble_policy_lock);
+  *out = s_ble_policy;
+  portEXIT_CRITICAL(&s_ble_policy_lock);
+  out->adaptive = s_ble_adaptive.load(std::memory_order_relaxed);
+#else
+  memset(out, 0, sizeof(*out));
+#endif
+}
 
-  netsec_ble_finalize_scan(canceled);
-  vTaskDelete(NULL);
+bool netsec_ble_power_down(uint32_t timeout_ms)
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  if (!s_ble_scan_task) return false;
+  xTaskNotify(s_ble_scan_task, NETSEC_BLE_NOTIFY_POWER_DOWN, eSetBits);
+  const TickType_t give_up = xTaskGetTickCount() + pdMS_TO_TICKS(timeout_ms);
+  while (s_ble_scan.load(std::memory_order_acquire)) {
+    if (netsec_ble_is_scanning() || xTaskGetTickCount() >= give_up) return false;
+    vTaskDelay(pdMS_TO_TICKS(10));
+  }
+  return true;
+#else
+  (void)timeout_ms;
+  return true;
+#endif
 }
+
+void netsec_ble_get_lifecycle_stats(netsec_ble_lifecycle_stats_t* out)
+{
+  if (!out) return;
+#if defined(ARDUINO_ARCH_ESP32)
+  *out = s_ble_stats;
+  out->generation = ble_gen(s_ble_state.load(std::memory_order_acquire));
+#else
+  memset(out, 0, sizeof(*out));
 #endif
+}
 
 bool netsec_ble_is_scanning(void) {
 #if defined(ARDUINO_ARCH_ESP32)
-  return s_ble_scan_running || (s_ble_scan_task != nullptr);
+  return ble_state(s_ble_state.load(std::memory_order_acquire)) != BLE_STATE_IDLE;
 #else
   return false;
 #endif
@@ -140,46 +471,15 @@ bool netsec_ble_is_scanning(void) {
 void netsec_ble_start_scan(uint32_t duration_ms)
 {
 #if defined(ARDUINO_ARCH_ESP32)
-  if (s_ble_scan_running) {
-    Serial.println("[NETSEC:BLE] Scan already running, restarting");
-    netsec_ble_stop_scan();
+  if (!s_ble_scan_task) {
+    Serial.println("[ERROR] BLE scan worker not started");
+    return;
   }
+  s_ble_next_duration_ms.store(duration_ms, std::memory_order_relaxed);
 
-  if (!s_ble_scan) {
-    BLEDevice::init("");
-    s_ble_scan = BLEDevice::getScan();
-    s_ble_scan->setActiveScan(true);
-    s_ble_scan->setInterval(100);
-    s_ble_scan->setWindow(99);
+  if (netsec_ble_act(ble_lc_start(s_ble_state))) {
+    DLOG_I("[NETSEC:BLE] Scan already running, restarting");
   }
-  s_ble_device_write_idx = 0;
-  s_ble_devices_reported = 0;
-  s_ble_scan_start_ms = millis();
-  s_ble_scan_running = true;
-  s_ble_cancel_requested = false;
-  netsec_ble_post_scan_event(NETSEC_RES_BLE_SCAN_STARTED, 0, duration_ms);
-
-  if (s_ble_scan_timer) {
-    xTimerStop(s_ble_scan_timer, 0);
-    xTimerDelete(s_ble_scan_timer, 0);
-  }
-  s_ble_scan_timer = xTimerCreate("ble_scan_timeout",
-                                  pdMS_TO_TICKS(duration_ms),
-                                  pdFALSE,
-                                  nullptr,
-                                  netsec_ble_timeout_cb);
-  if (s_ble_scan_timer) {
-    xTimerStart(s_ble_scan_timer, 0);
-  }
-
-  xTaskCreatePinnedToCore(
-      netsec_ble_scan_task,
-      "ble_scan",
-      4096,
-      reinterpret_cast<void*>(duration_ms),
-      1,
-      &s_ble_scan_task,
-      0);
 #else
   Serial.println("[NETSEC:BLE] BLE not supported on this platform (mock)");
 #endif
@@ -188,21 +488,83 @@ void netsec_ble_start_scan(uint32_t duration_ms)
 void netsec_ble_stop_scan(void)
 {
 #if defined(ARDUINO_ARCH_ESP32)
-  if (!s_ble_scan_running && !s_ble_scan_task) {
-    Serial.println("[NETSEC:BLE] Stop requested but no scan running");
-    return;
+  const ble_lc_action_t action = ble_lc_stop(s_ble_state);
+  if (action == BLE_LC_WAS_IDLE) {
+    DLOG_I("[NETSEC:BLE] Stop requested but no scan running");
+  } else if (netsec_ble_act(action)) {
+    DLOG_I("[NETSEC:BLE] Stop BLE scan");
   }
-  Serial.println("[NETSEC:BLE] Stop BLE scan");
-  if (s_ble_scan_timer) {
-    xTimerStop(s_ble_scan_timer, 0);
+#endif
+}
+
+#if defined(ARDUINO_ARCH_ESP32) && defined(NETSEC_BLE_RUN_DUTY_BENCHMARK)
+#ifndef NETSEC_BLE_DUTY_BENCH_SCAN_MS
+#define NETSEC_BLE_DUTY_BENCH_SCAN_MS 60000
+#endif
+
+static netsec_ble_policy_t s_duty_runs[2];   // Fixed, adaptive (off the boot task stack)
+
+// End of the first curve slice with at least `target` distinct addresses
+static uint32_t netsec_ble_time_to(const netsec_ble_policy_t* p, uint16_t target) {
+  for (uint8_t i = 0; i < p->curve_len; ++i) {
+    if (p->curve[i].unique >= target) return p->curve[i].t_ms;
   }
-  s_ble_scan_running = false;
-  s_ble_cancel_requested = true;
-  if (s_ble_scan_task) {
-    xTaskNotify(s_ble_scan_task, NETSEC_BLE_NOTIFY_CANCEL, eSetBits);
+  return 0;
+}
+
+void netsec_ble_run_duty_benchmark(void)
+{
+  static const char* const k_run_names[2] = {"fixed", "adaptive"};
+  if (!s_ble_scan_task) return;
+  const bool adaptive = s_ble_adaptive.load(std::memory_order_relaxed);
+
+  Serial.printf("[NETSEC:BLE] Duty benchmark: fixed then adaptive scan of %lu ms\n",
+                static_cast<unsigned long>(NETSEC_BLE_DUTY_BENCH_SCAN_MS));
+  for (uint8_t run = 0; run < 2; ++run) {
+    netsec_ble_stop_scan();
+    while (netsec_ble_is_scanning()) {
+      vTaskDelay(pdMS_TO_TICKS(50));
+    }
+    netsec_ble_set_adaptive(run == 1);
+    netsec_ble_start_scan(NETSEC_BLE_DUTY_BENCH_SCAN_MS);
+    while (netsec_ble_is_scanning()) {
+      vTaskDelay(pdMS_TO_TICKS(250));
+    }
+    netsec_ble_get_policy(&s_duty_runs[run]);
   }
-  // Cleanup will be performed by the scan task to avoid race conditions.
+  netsec_ble_set_adaptive(adaptive);
+
+  // Same targets for both runs: shares of the larger device count
+  const uint16_t total = s_duty_runs[0].unique > s_duty_runs[1].unique ? s_duty_runs[0].unique
+                                                                        : s_duty_runs[1].unique;
+  const uint16_t half = (total + 1) / 2;
+  const uint16_t most = (total * 9 + 9) / 10;
+  for (uint8_t run = 0; run < 2; ++run) {
+    const netsec_ble_policy_t* p = &s_duty_runs[run];
+    Serial.printf("[NETSEC:BLE] %-8s %3u devices, %u at %6lu ms, %u at %6lu ms, radio on %6lu of %lu ms (%lu%%)\n",
+                  k_run_names[run], p->unique,
+                  half, static_cast<unsigned long>(netsec_ble_time_to(p, half)),
+                  most, static_cast<unsigned long>(netsec_ble_time_to(p, most)),
+                  static_cast<unsigned long>(p->radio_ms), static_cast<unsigned long>(p->scan_ms),
+                  static_cast<unsigned long>(p->scan_ms ? p->radio_ms * 100 / p->scan_ms : 0));
+    Serial.printf("[NETSEC:BLE]   curve (s:devices/level):");
+    for (uint8_t i = 0; i < p->curve_len; ++i) {
+      Serial.printf(" %lu:%u/%u", static_cast<unsigned long>(p->curve[i].t_ms / 1000),
+                    p->curve[i].unique, p->curve[i].level);
+    }
+    Serial.println();
+  }
+}
 #endif
+
+// Resolvable / non-resolvable private address: changes every few minutes.
+// Random static addresses (two top bits set) last until the next power cycle.
+static bool netsec_ble_addr_rotates(const uint8_t* addr, uint32_t flags)
+{
+  const uint32_t type = flags & NETSEC_BLE_FLAG_ADDR_TYPE;
+  if (type == BLE_ADDR_TYPE_PUBLIC) return false;
+  if (type == BLE_ADDR_TYPE_RANDOM) return (addr[0] & 0xC0) != 0xC0;
+  return true;
 }
 
 void netsec_ble_post_device(const char* name, int rssi, const uint8_t* addr, uint32_t flags)
@@ -223,21 +585,30 @@ void netsec_ble_post_device(const char* name, int rssi, const uint8_t* addr, uin
   }
   device_slot->rssi = static_cast<int8_t>(rssi);
   device_slot->flags = flags;
+  netsec_survey_observe(NETSEC_SURVEY_BLE, addr, rssi);
+  netsec_sketch_observe(NETSEC_SKETCH_BLE, addr);
+  if (addr && netsec_known_check(NETSEC_KNOWN_BLE, addr, netsec_ble_addr_rotates(addr, flags))) {
+    device_slot->flags |= NETSEC_BLE_FLAG_NEW;
+  }
 
-  Serial.printf("[NETSEC:BLE] Device: %s | RSSI %d | name '%s'\n",
-                strlen(device_slot->mac_str) ? device_slot->mac_str : "<unknown>",
-                device_slot->rssi,
-                strlen(device_slot->name) ? device_slot->name : "");
-
-  netsec_result_t res;
-  memset(&res, 0, sizeof(res));
-  res.type = NETSEC_RES_BLE_DEVICE_FOUND;
-  res.data.ble_device = *device_slot;
+#if SERIAL_EXPORT_ENABLED
+  // Binary export replaces the per-device text line (UART is the bottleneck).
+  serial_export_ble_device(device_slot);
+#else
+  DLOG_I("[NETSEC:BLE] Device: %02X:%02X:%02X:%02X:%02X:%02X | RSSI %d | name '%s'",
+         device_slot->mac_bytes[0], device_slot->mac_bytes[1], device_slot->mac_bytes[2],
+         device_slot->mac_bytes[3], device_slot->mac_bytes[4], device_slot->mac_bytes[5],
+         device_slot->rssi,
+         device_slot->name);
+#endif
 
   if (s_ble_devices_reported < UINT16_MAX) {
     ++s_ble_devices_reported;
   }
 
-  xQueueSend(netsec_result_queue, &res, 0);
+  // The UI gets what changed (netsec_registry.h), not every report
+  if (addr) {
+    netsec_registry_report(NETSEC_DEVICE_BLE, addr, device_slot->rssi, device_slot->name, 0, device_slot->flags);
+  }
 }
 
@@ -0,0 +1,702 @@
+/*
+ * NETSEC - Known devices implementation
+ *
+ * File: known_header_t, then the NETSEC_KNOWN_GENERATIONS bit arrays at
+ * fixed offsets. The header (CRC checked) says which generation is open,
+ * when each was opened and the CRC of its bits; a bad header starts an
+ * empty filter, a generation that fails its CRC is cleared. Lookups run
+ * under a spinlock from the WiFi event and BLE scan tasks; the file is only
+ * touched from netsec_task, one generation copied out at a time.
+ */
+
+#include "netsec_known.h"
+#include "bench_clock.h"
+#include "storage_fs.h"
+#include "deferred_log.h"
+#include <Arduino.h>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#define NETSEC_KNOWN_GEOMETRY \
+  (static_cast<uint32_t>(NETSEC_KNOWN_GEN_BITS) | (static_cast<uint32_t>(NETSEC_KNOWN_GENERATIONS) << 24) | \
+   (static_cast<uint32_t>(NETSEC_KNOWN_HASHES) << 28))
+#define NETSEC_KNOWN_ALL_GENS       ((1u << NETSEC_KNOWN_GENERATIONS) - 1u)
+
+typedef struct {
+  uint32_t seq;               // 0: never opened
+  uint32_t start_s;           // Uptime when opened
+  uint32_t inserted;
+  uint32_t crc;               // Of its bits as last written
+} known_gen_t;
+
+typedef struct {
+  uint32_t magic;
+  uint32_t geometry;          // NETSEC_KNOWN_GEOMETRY: a resized filter starts empty
+  uint32_t crc;               // Over the bytes after this field
+  uint32_t uptime_s;
+  uint32_t current;
+  known_gen_t gens[NETSEC_KNOWN_GENERATIONS];
+} known_header_t;
+
+typedef struct {
+  known_header_t hdr;
+  uint8_t bits[NETSEC_KNOWN_GENERATIONS][NETSEC_KNOWN_GEN_BYTES];
+  uint8_t session[NETSEC_KNOWN_SESSION_BITS / 8];
+  bool loaded;
+  uint8_t dirty;              // Generations to write back (bit per generation)
+  bool header_dirty;
+  uint32_t uptime_base_s;     // Header uptime at load
+  uint32_t load_ms;
+  uint32_t checkpoint_ms;
+  uint32_t lookups;
+  uint32_t new_devices;
+  uint32_t skipped;
+  uint32_t rotations;
+  uint32_t checkpoints;
+  uint32_t checkpoint_failed;
+  uint32_t bytes_written;
+  uint32_t checkpoint_us_max;
+} known_filter_t;
+
+static_assert((NETSEC_KNOWN_GEN_BITS & (NETSEC_KNOWN_GEN_BITS - 1)) == 0, "Generation size must be a power of two");
+static_assert((NETSEC_KNOWN_SESSION_BITS & (NETSEC_KNOWN_SESSION_BITS - 1)) == 0, "Session size must be a power of two");
+static_assert(NETSEC_KNOWN_GENERATIONS <= 8, "Dirty mask is 8 bits");
+
+static portMUX_TYPE s_known_lock = portMUX_INITIALIZER_UNLOCKED;
+static known_filter_t s_known;
+static uint8_t s_known_scratch[NETSEC_KNOWN_GEN_BYTES];   // One generation on its way to flash
+
+static const uint32_t k_crc_nibble[16] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+static uint32_t crc32_bytes(const uint8_t* data, uint32_t len)
+{
+  uint32_t crc = 0xFFFFFFFFu;
+  for (uint32_t i = 0; i < len; ++i) {
+    crc ^= data[i];
+    crc = (crc >> 4) ^ k_crc_nibble[crc & 0x0F];
+    crc = (crc >> 4) ^ k_crc_nibble[crc & 0x0F];
+  }
+  return ~crc;
+}
+
+static uint32_t known_crc(const known_header_t* hdr)
+{
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(&hdr->crc) + sizeof(hdr->crc);
+  return crc32_bytes(data, sizeof(*hdr) - offsetof(known_header_t, crc) - sizeof(hdr->crc));
+}
+
+// ============================================================
+// Bits
+// ============================================================
+
+typedef struct {
+  uint32_t h1;
+  uint32_t h2;                // Odd: double hashing h1 + i * h2 over 32 bits
+} known_hash_t;
+
+static uint32_t known_mix(uint32_t h)
+{
+  h ^= h >> 16;
+  h *= 0x85EBCA6Bu;
+  h ^= h >> 13;
+  h *= 0xC2B2AE35u;
+  h ^= h >> 16;
+  return h;
+}
+
+static known_hash_t known_hash(netsec_known_kind_t kind, const uint8_t* addr)
+{
+  uint32_t h = (2166136261u ^ static_cast<uint32_t>(kind)) * 16777619u;
+  for (uint8_t i = 0; i < 6; ++i) {
+    h = (h ^ addr[i]) * 16777619u;
+  }
+  known_hash_t out;
+  out.h1 = known_mix(h);
+  out.h2 = known_mix(out.h1 ^ 0x5BD1E995u) | 1u;
+  return out;
+}
+
+static bool bits_test(const uint8_t* bits, uint32_t size_bits, uint8_t hashes, known_hash_t h)
+{
+  for (uint8_t i = 0; i < hashes; ++i) {
+    const uint32_t bit = (h.h1 + i * h.h2) & (size_bits - 1);
+    if (!(bits[bit >> 3] & (1u << (bit & 7)))) return false;
+  }
+  return true;
+}
+
+// True if a bit changed
+static bool bits_set(uint8_t* bits, uint32_t size_bits, uint8_t hashes, known_hash_t h)
+{
+  bool changed = false;
+  for (uint8_t i = 0; i < hashes; ++i) {
+    const uint32_t bit = (h.h1 + i * h.h2) & (size_bits - 1);
+    const uint8_t mask = static_cast<uint8_t>(1u << (bit & 7));
+    if (!(bits[bit >> 3] & mask)) {
+      bits[bit >> 3] |= mask;
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+static bool gen_test(const known_filter_t* f, uint8_t gen, known_hash_t h)
+{
+  return bits_test(f->bits[gen], NETSEC_KNOWN_GEN_BITS, NETSEC_KNOWN_HASHES, h);
+}
+
+static void gen_insert(known_filter_t* f, known_hash_t h)
+{
+  const uint8_t cur = static_cast<uint8_t>(f->hdr.current);
+  if (bits_set(f->bits[cur], NETSEC_KNOWN_GEN_BITS, NETSEC_KNOWN_HASHES, h)) {
+    f->dirty |= static_cast<uint8_t>(1u << cur);
+  }
+  f->hdr.gens[cur].inserted++;
+  f->header_dirty = true;
+}
+
+static uint32_t popcount_bytes(const uint8_t* bits, uint32_t len)
+{
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < len; ++i) n += static_cast<uint32_t>(__builtin_popcount(bits[i]));
+  return n;
+}
+
+// ============================================================
+// Filter
+// ============================================================
+
+static uint32_t known_uptime_s(const known_filter_t* f)
+{
+  return f->uptime_base_s + (millis() - f->load_ms) / 1000u;
+}
+
+static void known_reset(known_filter_t* f, uint32_t uptime_s)
+{
+  memset(&f->hdr, 0, sizeof(f->hdr));
+  memset(f->bits, 0, sizeof(f->bits));
+  f->hdr.magic = NETSEC_KNOWN_MAGIC;
+  f->hdr.geometry = NETSEC_KNOWN_GEOMETRY;
+  f->hdr.uptime_s = uptime_s;
+  f->hdr.gens[0].seq = 1;
+  f->hdr.gens[0].start_s = uptime_s;
+  f->dirty = NETSEC_KNOWN_ALL_GENS;
+  f->header_dirty = true;
+}
+
+static bool known_lookup(known_filter_t* f, netsec_known_kind_t kind, const uint8_t* addr)
+{
+  const known_hash_t h = known_hash(kind, addr);
+  const uint8_t cur = static_cast<uint8_t>(f->hdr.current);
+  f->lookups++;
+
+  bool known = gen_test(f, cur, h);
+  if (!known) {
+    for (uint8_t g = 0; g < NETSEC_KNOWN_GENERATIONS && !known; ++g) {
+      known = g != cur && f->hdr.gens[g].seq && gen_test(f, g, h);
+    }
+    // Closed generations only: copied forward, or it is forgotten with them
+    gen_insert(f, h);
+  }
+  if (!known) {
+    bits_set(f->session, NETSEC_KNOWN_SESSION_BITS, NETSEC_KNOWN_SESSION_HASHES, h);
+    f->new_devices++;
+    return true;
+  }
+  return bits_test(f->session, NETSEC_KNOWN_SESSION_BITS, NETSEC_KNOWN_SESSION_HASHES, h);
+}
+
+// Close the open generation and reuse the oldest; true if it did
+static bool known_rotate(known_filter_t* f, uint32_t uptime_s)
+{
+  const known_gen_t* open = &f->hdr.gens[f->hdr.current];
+  if (uptime_s - open->start_s < NETSEC_KNOWN_GEN_HOURS * 3600u &&
+      open->inserted < NETSEC_KNOWN_GEN_CAPACITY) {
+    return false;
+  }
+  const uint32_t next = (f->hdr.current + 1) % NETSEC_KNOWN_GENERATIONS;
+  memset(f->bits[next], 0, NETSEC_KNOWN_GEN_BYTES);
+  f->hdr.gens[next].seq = open->seq + 1;
+  f->hdr.gens[next].start_s = uptime_s;
+  f->hdr.gens[next].inserted = 0;
+  f->hdr.current = next;
+  f->dirty |= static_cast<uint8_t>(1u << next);
+  f->header_dirty = true;
+  f->rotations++;
+  return true;
+}
+
+static bool known_read(known_filter_t* f, const char* path)
+{
+  fs::FS& vol = storage_fs();
+  if (!vol.exists(path)) return false;
+  File file = vol.open(path, "r");
+  if (!file) return false;
+
+  known_header_t hdr;
+  bool ok = file.read(reinterpret_cast<uint8_t*>(&hdr), sizeof(hdr)) == sizeof(hdr) &&
+            hdr.magic == NETSEC_KNOWN_MAGIC && hdr.geometry == NETSEC_KNOWN_GEOMETRY &&
+            hdr.current < NETSEC_KNOWN_GENERATIONS && hdr.crc == known_crc(&hdr) &&
+            file.read(&f->bits[0][0], sizeof(f->bits)) == sizeof(f->bits);
+  file.close();
+  if (!ok) return false;
+  f->hdr = hdr;
+  f->dirty = 0;
+  f->header_dirty = false;
+  // Cut between a generation and the header, or bad flash: forget it rather
+  // than answer from bits that cannot be trusted (left dirty for the caller)
+  for (uint8_t g = 0; g < NETSEC_KNOWN_GENERATIONS; ++g) {
+    if (crc32_bytes(f->bits[g], NETSEC_KNOWN_GEN_BYTES) == hdr.gens[g].crc) continue;
+    memset(f->bits[g], 0, NETSEC_KNOWN_GEN_BYTES);
+    f->hdr.gens[g].inserted = 0;
+    f->dirty |= static_cast<uint8_t>(1u << g);
+    f->header_dirty = true;
+  }
+  return true;
+}
+
+/*
+ * Dirty generations then the header, which holds their CRCs. A missing or
+ * short file is written whole. The lock is only held for the copies.
+ */
+static bool known_write(known_filter_t* f, portMUX_TYPE* lock, const char* path, uint8_t* scratch)
+{
+  const int64_t t0 = esp_timer_get_time();
+  const uint32_t file_size = sizeof(known_header_t) + sizeof(f->bits);
+  fs::FS& vol = storage_fs();
+  File file;
+  if (vol.exists(path)) {
+    file = vol.open(path, "r+");
+    if (file && file.size() != file_size) {
+      file.close();
+      file = File();
+    }
+  }
+  if (!file) {
+    if (lock) portENTER_CRITICAL(lock);
+    f->dirty = NETSEC_KNOWN_ALL_GENS;
+    if (lock) portEXIT_CRITICAL(lock);
+    file = vol.open(path, "w");
+  }
+  if (!file) return false;
+
+  bool ok = true;
+  uint32_t written = 0;
+  for (uint8_t g = 0; g < NETSEC_KNOWN_GENERATIONS && ok; ++g) {
+    if (lock) portENTER_CRITICAL(lock);
+    const bool dirty = (f->dirty & (1u << g)) != 0;
+    if (dirty) {
+      memcpy(scratch, f->bits[g], NETSEC_KNOWN_GEN_BYTES);
+      f->dirty &= static_cast<uint8_t>(~(1u << g));
+    }
+    if (lock) portEXIT_CRITICAL(lock);
+    if (!dirty) continue;
+    const uint32_t crc = crc32_bytes(scratch, NETSEC_KNOWN_GEN_BYTES);
+    ok = file.seek(sizeof(known_header_t) + g * NETSEC_KNOWN_GEN_BYTES) &&
+         file.write(scratch, NETSEC_KNOWN_GEN_BYTES) == NETSEC_KNOWN_GEN_BYTES;
+    if (lock) portENTER_CRITICAL(lock);
+    if (ok) {
+      f->hdr.gens[g].crc = crc;
+    } else {
+      f->dirty |= static_cast<uint8_t>(1u << g);
+    }
+    if (lock) portEXIT_CRITICAL(lock);
+    written += NETSEC_KNOWN_GEN_BYTES;
+  }
+
+  known_header_t hdr;
+  if (lock) portENTER_CRITICAL(lock);
+  f->hdr.uptime_s = known_uptime_s(f);
+  hdr = f->hdr;
+  f->header_dirty = false;
+  if (lock) portEXIT_CRITICAL(lock);
+  hdr.crc = known_crc(&hdr);
+  ok = ok && file.seek(0) && file.write(reinterpret_cast<const uint8_t*>(&hdr), sizeof(hdr)) == sizeof(hdr);
+  written += sizeof(hdr);
+  file.close();
+
+  const uint32_t us = static_cast<uint32_t>(esp_timer_get_time() - t0);
+  f->checkpoints++;
+  f->bytes_written += written;
+  if (us > f->checkpoint_us_max) f->checkpoint_us_max = us;
+  if (!ok) {
+    f->header_dirty = true;
+    f->checkpoint_failed++;
+  }
+  return ok;
+}
+
+// ============================================================
+// Public API
+// ============================================================
+
+bool netsec_known_check(netsec_known_kind_t kind, const uint8_t* addr, bool rotating)
+{
+  if (!addr) return false;
+  portENTER_CRITICAL(&s_known_lock);
+  bool fresh = false;
+  if (!s_known.loaded) {
+    // Nothing to compare with yet
+  } else if (rotating) {
+    s_known.skipped++;
+  } else {
+    fresh = known_lookup(&s_known, kind, addr);
+  }
+  portEXIT_CRITICAL(&s_known_lock);
+  return fresh;
+}
+
+static void known_load(void)
+{
+  known_filter_t* f = &s_known;
+  const bool read = known_read(f, NETSEC_KNOWN_FILE);
+  const uint8_t cleared = read ? f->dirty : 0;
+  if (!read) known_reset(f, 0);
+
+  uint32_t addresses = 0;
+  uint8_t gens = 0;
+  for (uint8_t g = 0; g < NETSEC_KNOWN_GENERATIONS; ++g) {
+    if (!f->hdr.gens[g].seq) continue;
+    addresses += f->hdr.gens[g].inserted;
+    gens++;
+  }
+  portENTER_CRITICAL(&s_known_lock);
+  f->uptime_base_s = f->hdr.uptime_s;
+  f->load_ms = millis();
+  f->checkpoint_ms = f->load_ms;
+  f->loaded = true;
+  portEXIT_CRITICAL(&s_known_lock);
+
+  if (read) {
+    Serial.printf("[NETSEC:KNOWN] %u generations, %lu insertions, %lu h of uptime\n", gens,
+                  static_cast<unsigned long>(addresses), static_cast<unsigned long>(f->hdr.uptime_s / 3600u));
+    if (cleared) {
+      Serial.printf("[NETSEC:KNOWN] %u generations failed their CRC, cleared\n",
+                    static_cast<unsigned>(__builtin_popcount(cleared)));
+    }
+  } else {
+    Serial.println("[NETSEC:KNOWN] No valid " NETSEC_KNOWN_FILE ", every device starts new");
+  }
+}
+
+void netsec_known_poll(void)
+{
+  if (!s_known.loaded) {
+    storage_fs_stats_t fs;
+    storage_fs_get_stats(&fs);
+    if (!fs.mounted) return;
+    known_load();
+  }
+
+  portENTER_CRITICAL(&s_known_lock);
+  const uint32_t closed = s_known.hdr.gens[s_known.hdr.current].inserted;
+  const bool rotated = known_rotate(&s_known, known_uptime_s(&s_known));
+  const uint32_t seq = s_known.hdr.gens[s_known.hdr.current].seq;
+  const bool due = (s_known.dirty || s_known.header_dirty) &&
+                   millis() - s_known.checkpoint_ms >= NETSEC_KNOWN_CHECKPOINT_S * 1000u;
+  portEXIT_CRITICAL(&s_known_lock);
+
+  if (rotated) {
+    DLOG_I("[NETSEC:KNOWN] Generation %lu opened, the last one took %lu insertions", seq, closed);
+  }
+  if (due || rotated) netsec_known_flush();
+}
+
+bool netsec_known_flush(void)
+{
+  if (!s_known.loaded) return false;
+  s_known.checkpoint_ms = millis();
+  if (!s_known.dirty && !s_known.header_dirty) return true;
+  if (!known_write(&s_known, &s_known_lock, NETSEC_KNOWN_FILE, s_known_scratch)) {
+    Serial.println("[ERROR] Known devices: cannot write " NETSEC_KNOWN_FILE);
+    return false;
+  }
+  return true;
+}
+
+static void known_stats(known_filter_t* f, portMUX_TYPE* lock, netsec_known_stats_t* out)
+{
+  memset(out, 0, sizeof(*out));
+  if (lock) portENTER_CRITICAL(lock);
+  const known_header_t hdr = f->hdr;
+  out->loaded = f->loaded;
+  out->lookups = f->lookups;
+  out->new_devices = f->new_devices;
+  out->skipped = f->skipped;
+  out->rotations = f->rotations;
+  out->checkpoints = f->checkpoints;
+  out->checkpoint_failed = f->checkpoint_failed;
+  out->bytes_written = f->bytes_written;
+  out->checkpoint_us_max = f->checkpoint_us_max;
+  if (lock) portEXIT_CRITICAL(lock);
+
+  out->current = static_cast<uint8_t>(hdr.current);
+  out->uptime_s = f->loaded ? known_uptime_s(f) : hdr.uptime_s;
+  // Bits are read without the lock: a bit set meanwhile only moves the estimate
+  float pass = 1.0f;
+  for (uint8_t g = 0; g < NETSEC_KNOWN_GENERATIONS; ++g) {
+    if (!hdr.gens[g].seq) continue;
+    const float fill = static_cast<float>(popcount_bytes(f->bits[g], NETSEC_KNOWN_GEN_BYTES)) / NETSEC_KNOWN_GEN_BITS;
+    out->gen_inserted[g] = hdr.gens[g].inserted;
+    out->gen_age_s[g] = out->uptime_s - hdr.gens[g].start_s;
+    out->gen_fill_pct[g] = static_cast<uint16_t>(fill * 100.0f + 0.5f);
+    pass *= 1.0f - powf(fill, NETSEC_KNOWN_HASHES);
+  }
+  out->fp_ppm = static_cast<uint32_t>((1.0f - pass) * 1000000.0f + 0.5f);
+}
+
+void netsec_known_get_stats(netsec_known_stats_t* out)
+{
+  if (!out) return;
+  known_stats(&s_known, &s_known_lock, out);
+}
+
+// ============================================================
+// Checks and benchmark
+// ============================================================
+
+#define NETSEC_KNOWN_BENCH_QUERIES  20000
+#define NETSEC_KNOWN_BENCH_LOOKUPS  200000
+#define NETSEC_KNOWN_BENCH_NEW      500     // Distinct new devices among the lookups
+#define NETSEC_KNOWN_BENCH_FILE     "/known_bench.bin"
+
+static known_filter_t s_bench;
+static uint8_t s_bench_scratch[NETSEC_KNOWN_GEN_BYTES];
+
+// Distinct address per id; ids from 0x80000000 are never inserted
+static void bench_addr(uint32_t id, uint8_t* addr)
+{
+  addr[0] = 0x3C;
+  addr[1] = 0x71;
+  addr[2] = static_cast<uint8_t>(id >> 24);
+  addr[3] = static_cast<uint8_t>(id >> 16);
+  addr[4] = static_cast<uint8_t>(id >> 8);
+  addr[5] = static_cast<uint8_t>(id);
+}
+
+static void bench_fill(uint8_t gen, uint32_t first_id, uint32_t count)
+{
+  uint8_t addr[6];
+  for (uint32_t i = 0; i < count; ++i) {
+    bench_addr(first_id + i, addr);
+    bits_set(s_bench.bits[gen], NETSEC_KNOWN_GEN_BITS, NETSEC_KNOWN_HASHES,
+             known_hash(NETSEC_KNOWN_BLE, addr));
+  }
+  s_bench.hdr.gens[gen].inserted += count;
+}
+
+// Private filter, `gens` generations of `per_gen` addresses, the last open
+static void bench_build(uint32_t per_gen, uint8_t gens)
+{
+  memset(&s_bench, 0, sizeof(s_bench));
+  known_reset(&s_bench, 0);
+  for (uint8_t g = 0; g < gens; ++g) {
+    s_bench.hdr.gens[g].seq = g + 1u;
+    bench_fill(g, g * per_gen, per_gen);
+  }
+  s_bench.hdr.current = gens - 1u;
+}
+
+uint32_t netsec_known_fp_ppm(uint32_t per_gen, uint8_t gens)
+{
+  if (!gens || gens > NETSEC_KNOWN_GENERATIONS) return 0;
+  bench_build(per_gen, gens);
+
+  uint8_t addr[6];
+  uint32_t hits = 0;
+  for (uint32_t i = 0; i < NETSEC_KNOWN_BENCH_QUERIES; ++i) {
+    bench_addr(0x80000000u + i, addr);
+    const known_hash_t h = known_hash(NETSEC_KNOWN_BLE, addr);
+    for (uint8_t g = 0; g < gens; ++g) {
+      if (gen_test(&s_bench, g, h)) {
+        hits++;
+        break;
+      }
+    }
+  }
+  return static_cast<uint32_t>(static_cast<uint64_t>(hits) * 1000000u / NETSEC_KNOWN_BENCH_QUERIES);
+}
+
+// New address for the open generation that sets at least one bit
+static void bench_insert_new(uint32_t* next_id)
+{
+  uint8_t addr[6];
+  const uint8_t cur = static_cast<uint8_t>(s_bench.hdr.current);
+  do {
+    bench_addr((*next_id)++, addr);
+    known_lookup(&s_bench, NETSEC_KNOWN_BLE, addr);
+  } while (!(s_bench.dirty & (1u << cur)));
+}
+
+// Reloaded from the file, compared with the CRCs of the filter written
+static bool bench_reload_same(uint32_t hdr_crc, uint32_t bits_crc)
+{
+  memset(&s_bench.hdr, 0, sizeof(s_bench.hdr));
+  memset(s_bench.bits, 0, sizeof(s_bench.bits));
+  return known_read(&s_bench, NETSEC_KNOWN_BENCH_FILE) && !s_bench.dirty && known_crc(&s_bench.hdr) == hdr_crc &&
+         crc32_bytes(&s_bench.bits[0][0], sizeof(s_bench.bits)) == bits_crc;
+}
+
+uint32_t netsec_known_check_reload(uint32_t* cases)
+{
+  if (cases) *cases = 0;
+  storage_fs_stats_t fs;
+  storage_fs_get_stats(&fs);
+  if (!fs.mounted) return 1;
+
+  fs::FS& vol = storage_fs();
+  uint32_t tried = 0;
+  uint32_t failed = 0;
+  uint32_t next_id = 0x10000000u;
+  bench_build(NETSEC_KNOWN_GEN_CAPACITY / 2, NETSEC_KNOWN_GENERATIONS);
+  s_bench.load_ms = millis();
+  s_bench.uptime_base_s = 3600;
+  vol.remove(NETSEC_KNOWN_BENCH_FILE);
+
+  // 1. Whole file
+  tried++;
+  bool ok = known_write(&s_bench, NULL, NETSEC_KNOWN_BENCH_FILE, s_bench_scratch) &&
+            bench_reload_same(known_crc(&s_bench.hdr), crc32_bytes(&s_bench.bits[0][0], sizeof(s_bench.bits)));
+  if (!ok) failed++;
+
+  // 2. One new address: the open generation and the header only
+  tried++;
+  bench_insert_new(&next_id);
+  const uint32_t written_before = s_bench.bytes_written;
+  ok = known_write(&s_bench, NULL, NETSEC_KNOWN_BENCH_FILE, s_bench_scratch) &&
+       s_bench.bytes_written - written_before == NETSEC_KNOWN_GEN_BYTES + sizeof(known_header_t) &&
+       bench_reload_same(known_crc(&s_bench.hdr), crc32_bytes(&s_bench.bits[0][0], sizeof(s_bench.bits)));
+  if (!ok) failed++;
+
+  // 3. Cut after the open generation, before the header: that generation
+  // fails its CRC and is cleared, the others are kept
+  tried++;
+  const uint8_t cur = static_cast<uint8_t>(s_bench.hdr.current);
+  uint32_t gen_crc[NETSEC_KNOWN_GENERATIONS];
+  for (uint8_t g = 0; g < NETSEC_KNOWN_GENERATIONS; ++g) {
+    gen_crc[g] = crc32_bytes(s_bench.bits[g], NETSEC_KNOWN_GEN_BYTES);
+  }
+  bench_insert_new(&next_id);
+  File file = vol.open(NETSEC_KNOWN_BENCH_FILE, "r+");
+  ok = file && file.seek(sizeof(known_header_t) + cur * NETSEC_KNOWN_GEN_BYTES) &&
+       file.write(s_bench.bits[cur], NETSEC_KNOWN_GEN_BYTES) == NETSEC_KNOWN_GEN_BYTES;
+  file.close();
+  ok = ok && known_read(&s_bench, NETSEC_KNOWN_BENCH_FILE) && s_bench.dirty == (1u << cur) &&
+       s_bench.hdr.gens[cur].inserted == 0 && popcount_bytes(s_bench.bits[cur], NETSEC_KNOWN_GEN_BYTES) == 0;
+  for (uint8_t g = 0; g < NETSEC_KNOWN_GENERATIONS && ok; ++g) {
+    ok = g == cur || crc32_bytes(s_bench.bits[g], NETSEC_KNOWN_GEN_BYTES) == gen_crc[g];
+  }
+  if (!ok) failed++;
+
+  // 4. Damaged header: not loaded
+  tried++;
+  uint8_t byte = 0;
+  file = vol.open(NETSEC_KNOWN_BENCH_FILE, "r+");
+  ok = file && file.seek(offsetof(known_header_t, uptime_s)) && file.read(&byte, 1) == 1;
+  byte ^= 0x01;
+  ok = ok && file.seek(offsetof(known_header_t, uptime_s)) && file.write(&byte, 1) == 1;
+  file.close();
+  ok = ok && !known_read(&s_bench, NETSEC_KNOWN_BENCH_FILE);
+  if (!ok) failed++;
+
+  vol.remove(NETSEC_KNOWN_BENCH_FILE);
+  if (cases) *cases = tried;
+  return failed;
+}
+
+static uint32_t bench_theory_ppm(uint32_t inserted, uint8_t gens)
+{
+  const float one = powf(1.0f - expf(-static_cast<float>(NETSEC_KNOWN_HASHES) * inserted / NETSEC_KNOWN_GEN_BITS),
+                         NETSEC_KNOWN_HASHES);
+  return static_cast<uint32_t>((1.0f - powf(1.0f - one, gens)) * 1000000.0f + 0.5f);
+}
+
+static void bench_print_fp(const char* what, uint32_t inserted, uint32_t measured, uint32_t theory, uint32_t fill_bits)
+{
+  Serial.printf("[NETSEC:KNOWN]   %-18s %5lu addresses, %2lu %% bits set: %lu.%02lu %% false positives (theory %lu.%02lu %%)\n",
+                what, static_cast<unsigned long>(inserted),
+                static_cast<unsigned long>(fill_bits * 100u / NETSEC_KNOWN_GEN_BITS),
+                static_cast<unsigned long>(measured / 10000u), static_cast<unsigned long>(measured / 100u % 100u),
+                static_cast<unsigned long>(theory / 10000u), static_cast<unsigned long>(theory / 100u % 100u));
+}
+
+void netsec_known_run_benchmark(void)
+{
+  static const uint8_t k_fill_pct[] = { 10, 25, 50, 75, 100, 150 };
+
+  Serial.printf("[NETSEC:KNOWN] Benchmark: %u generations of %u bits, %u hashes, capacity %u, RAM %u B\n",
+                NETSEC_KNOWN_GENERATIONS, NETSEC_KNOWN_GEN_BITS, NETSEC_KNOWN_HASHES, NETSEC_KNOWN_GEN_CAPACITY,
+                static_cast<unsigned>(sizeof(known_filter_t) + sizeof(s_known_scratch)));
+
+  // 1. One generation filling up
+  for (uint8_t i = 0; i < sizeof(k_fill_pct); ++i) {
+    const uint32_t inserted = NETSEC_KNOWN_GEN_CAPACITY * k_fill_pct[i] / 100u;
+    const uint32_t measured = netsec_known_fp_ppm(inserted, 1);
+    char what[24];
+    snprintf(what, sizeof(what), "1 gen at %u %%:", k_fill_pct[i]);
+    bench_print_fp(what, inserted, measured, bench_theory_ppm(inserted, 1),
+                   popcount_bytes(s_bench.bits[0], NETSEC_KNOWN_GEN_BYTES));
+  }
+
+  // 2. Every generation at capacity (the worst steady state)
+  {
+    const uint32_t measured = netsec_known_fp_ppm(NETSEC_KNOWN_GEN_CAPACITY, NETSEC_KNOWN_GENERATIONS);
+    bench_print_fp("all gens full:", NETSEC_KNOWN_GEN_CAPACITY * NETSEC_KNOWN_GENERATIONS, measured,
+                   bench_theory_ppm(NETSEC_KNOWN_GEN_CAPACITY, NETSEC_KNOWN_GENERATIONS),
+                   popcount_bytes(s_bench.bits[0], NETSEC_KNOWN_GEN_BYTES));
+  }
+
+  // 3. Lookups on the full filter, the real path: half known (oldest
+  // generation, copied forward), half new devices reported scan after scan
+  uint8_t addr[6];
+  uint32_t fresh = 0;
+  const int64_t start = bench_clock_us();
+  for (uint32_t i = 0; i < NETSEC_KNOWN_BENCH_LOOKUPS; ++i) {
+    const uint32_t n = (i >> 1) % NETSEC_KNOWN_BENCH_NEW;
+    bench_addr((i & 1) ? n : 0x90000000u + n, addr);
+    if (known_lookup(&s_bench, NETSEC_KNOWN_BLE, addr)) fresh++;
+  }
+  const uint32_t lookup_us = static_cast<uint32_t>(bench_clock_us() - start);
+  Serial.printf("[NETSEC:KNOWN]   %lu lookups in %lu us: %lu lookups/s, %lu reports of %u new devices flagged\n",
+                static_cast<unsigned long>(NETSEC_KNOWN_BENCH_LOOKUPS), static_cast<unsigned long>(lookup_us),
+                static_cast<unsigned long>(lookup_us ? static_cast<uint64_t>(NETSEC_KNOWN_BENCH_LOOKUPS) * 1000000u / lookup_us : 0),
+                static_cast<unsigned long>(fresh), NETSEC_KNOWN_BENCH_NEW);
+
+  // Over capacity now: open a fresh generation, as netsec_known_poll() would
+  known_rotate(&s_bench, 0);
+
+  // 4. Checkpoint cost: whole file, then one generation as in use
+  storage_fs_stats_t fs;
+  storage_fs_get_stats(&fs);
+  if (!fs.mounted) {
+    Serial.println("[ERROR] Known devices benchmark: storage not mounted, checkpoint skipped");
+    return;
+  }
+  storage_fs().remove(NETSEC_KNOWN_BENCH_FILE);
+  s_bench.load_ms = millis();
+  s_bench.uptime_base_s = 3600;
+  known_write(&s_bench, NULL, NETSEC_KNOWN_BENCH_FILE, s_bench_scratch);
+  const uint32_t full_bytes = s_bench.bytes_written;
+
+  // One new address: only the open generation and the header are due
+  bench_addr(0xA0000000u, addr);
+  known_lookup(&s_bench, NETSEC_KNOWN_BLE, addr);
+  const uint32_t written_before = s_bench.bytes_written;
+  const int64_t t0 = bench_clock_us();
+  known_write(&s_bench, NULL, NETSEC_KNOWN_BENCH_FILE, s_bench_scratch);
+  const uint32_t step_us = static_cast<uint32_t>(bench_clock_us() - t0);
+  const uint32_t step_bytes = s_bench.bytes_written - written_before;
+  storage_fs().remove(NETSEC_KNOWN_BENCH_FILE);
+
+  const uint32_t per_day = 86400u / NETSEC_KNOWN_CHECKPOINT_S * step_bytes;
+  Serial.printf("[NETSEC:KNOWN]   file %lu B, checkpoint %lu B in %lu us, at most %lu KB/day\n",
+                static_cast<unsigned long>(full_bytes), static_cast<unsigned long>(step_bytes),
+                static_cast<unsigned long>(step_us), static_cast<unsigned long>(per_day / 1024u));
+}
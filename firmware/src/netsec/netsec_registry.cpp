@@ -0,0 +1,626 @@
+/*
+ * NETSEC - Device registry
+ *
+ * Flat record table searched linearly (64 records by default, one compare of
+ * kind + address each), free slots marked by state. A report returns at most
+ * two diffs: the record it pushed out, then its own. The scan number of each
+ * kind counts completed scans; a record remembers the one it was last
+ * reported in, so aging is a subtraction.
+ *
+ * A record also remembers what the UI was told: whether it has a row
+ * (shown) and a change not sent yet. Diffs are marked sent when built; one
+ * the result queue refuses is marked back on its record, and the next report
+ * or aging pass builds it again. The GONE of an evicted record has no record
+ * left to wait on: it waits on a short list, and while that list is full no
+ * shown record is evicted.
+ */
+
+#include "netsec_registry.h"
+#include "bench_clock.h"
+#include "deferred_log.h"
+#include "sysmon.h"
+#include <Arduino.h>
+#include <string.h>
+#include <esp_system.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#define NETSEC_REGISTRY_KINDS   2
+#define NETSEC_REGISTRY_AVG_N   64    // Running mean over about the last 64 reports
+#define NETSEC_REGISTRY_EVICTED 4     // GONE diffs of evicted records not sent yet
+
+typedef enum {
+  REG_FREE = 0,
+  REG_PRESENT,
+  REG_GONE,
+} reg_state_t;
+
+typedef struct {
+  netsec_device_t dev;
+  int16_t rssi_avg_q4;        // Running mean, 1/16 dB
+  uint16_t last_scan;         // Scan number of its kind at the last report
+  uint8_t state;              // reg_state_t
+  int8_t rssi_sent;           // RSSI in the last diff
+  uint8_t shown;              // The UI has its row: ADDED sent, GONE not yet
+  uint8_t changed;            // Since the last diff
+} reg_record_t;
+
+typedef struct {
+  netsec_result_type_t type;
+  netsec_device_t dev;
+} reg_diff_t;
+
+typedef struct {
+  reg_record_t rec[NETSEC_REGISTRY_CAPACITY];
+  reg_diff_t evicted_gone[NETSEC_REGISTRY_EVICTED];
+  netsec_registry_policy_t policy;
+  uint16_t scan[NETSEC_REGISTRY_KINDS];
+  uint16_t used;
+  uint16_t peak;
+  uint8_t evicted_count;
+  uint32_t reports;
+  uint32_t added;
+  uint32_t changed;
+  uint32_t gone_sent;
+  uint32_t evicted;
+  uint32_t recycled;
+  uint32_t forgotten;
+  uint32_t refused;
+  uint32_t diffs_deferred;
+  uint32_t diffs_lost;
+} registry_t;
+
+static_assert(sizeof(reg_record_t) == NETSEC_REGISTRY_RECORD_BYTES, "Record size changed: update NETSEC_REGISTRY_RECORD_BYTES");
+static_assert(sizeof(reg_record_t) * NETSEC_REGISTRY_CAPACITY <= NETSEC_REGISTRY_BUDGET, "Records over NETSEC_REGISTRY_BUDGET");
+static_assert(NETSEC_REGISTRY_CAPACITY >= 8, "NETSEC_REGISTRY_BUDGET too small");
+
+static const netsec_registry_policy_t k_default_policy = {
+  NETSEC_REGISTRY_MISSED_SCANS, NETSEC_REGISTRY_GONE_MS, NETSEC_REGISTRY_FORGET_MS, NETSEC_REGISTRY_RSSI_STEP,
+};
+
+static portMUX_TYPE s_registry_lock = portMUX_INITIALIZER_UNLOCKED;
+static registry_t s_registry = { {}, {}, k_default_policy, {0, 0}, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+static const char* const k_kind_names[NETSEC_REGISTRY_KINDS] = { "WiFi", "BLE" };
+
+// ============================================================
+// Records
+// ============================================================
+
+static reg_record_t* reg_find(registry_t* r, netsec_device_kind_t kind, const uint8_t* addr)
+{
+  for (uint16_t i = 0; i < NETSEC_REGISTRY_CAPACITY; ++i) {
+    reg_record_t* rec = &r->rec[i];
+    if (rec->state != REG_FREE && rec->dev.kind == kind && memcmp(rec->dev.addr, addr, 6) == 0) {
+      return rec;
+    }
+  }
+  return NULL;
+}
+
+static void reg_diff(reg_diff_t* out, netsec_result_type_t type, reg_record_t* rec)
+{
+  out->type = type;
+  out->dev = rec->dev;
+  out->dev.rssi_avg = static_cast<int8_t>(rec->rssi_avg_q4 / 16);
+}
+
+// The diff the UI is missing for this record, if any, marked sent
+static bool reg_pending(registry_t* r, reg_record_t* rec, reg_diff_t* out)
+{
+  netsec_result_type_t type;
+  if (rec->state == REG_PRESENT && !rec->shown) {
+    type = NETSEC_RES_DEVICE_ADDED;
+    r->added++;
+  } else if (rec->state == REG_PRESENT && rec->changed) {
+    type = NETSEC_RES_DEVICE_CHANGED;
+    r->changed++;
+  } else if (rec->state == REG_GONE && rec->shown) {
+    type = NETSEC_RES_DEVICE_GONE;
+    r->gone_sent++;
+  } else {
+    return false;
+  }
+  rec->shown = type != NETSEC_RES_DEVICE_GONE;
+  rec->changed = 0;
+  rec->rssi_sent = rec->dev.rssi;
+  reg_diff(out, type, rec);
+  return true;
+}
+
+// A diff the result queue refused: pending again on its record, else (a
+// GONE whose record was reused meanwhile) back on the evicted list
+static void reg_unsent(registry_t* r, const reg_diff_t* d)
+{
+  reg_record_t* rec = reg_find(r, static_cast<netsec_device_kind_t>(d->dev.kind), d->dev.addr);
+  if (rec) {
+    if (d->type == NETSEC_RES_DEVICE_ADDED) {
+      rec->shown = 0;
+    } else if (d->type == NETSEC_RES_DEVICE_CHANGED) {
+      rec->changed = 1;
+    } else if (rec->state != REG_PRESENT) {
+      rec->shown = 1;
+    }
+    // GONE with the address back since: its ADDED went after it, the UI has the row
+  } else if (d->type == NETSEC_RES_DEVICE_GONE && r->evicted_count < NETSEC_REGISTRY_EVICTED) {
+    r->evicted_gone[r->evicted_count++] = *d;
+  } else if (d->type == NETSEC_RES_DEVICE_GONE) {
+    r->diffs_lost++;
+    return;
+  }
+  r->diffs_deferred++;
+}
+
+// A slot for a new address: free, else the gone record seen longest ago
+// whose GONE was sent, else the record seen longest ago, its GONE onto the
+// evicted list. NULL while that list is full.
+static reg_record_t* reg_take(registry_t* r, uint32_t now_ms)
+{
+  reg_record_t* oldest_gone = NULL;
+  reg_record_t* oldest_shown = NULL;
+  for (uint16_t i = 0; i < NETSEC_REGISTRY_CAPACITY; ++i) {
+    reg_record_t* rec = &r->rec[i];
+    if (rec->state == REG_FREE) {
+      r->used++;
+      if (r->used > r->peak) r->peak = r->used;
+      return rec;
+    }
+    reg_record_t** oldest = rec->state == REG_GONE && !rec->shown ? &oldest_gone : &oldest_shown;
+    if (!*oldest || now_ms - rec->dev.last_seen_ms > now_ms - (*oldest)->dev.last_seen_ms) {
+      *oldest = rec;
+    }
+  }
+  if (oldest_gone) {
+    r->recycled++;
+    return oldest_gone;
+  }
+  if (oldest_shown->shown && r->evicted_count >= NETSEC_REGISTRY_EVICTED) {
+    r->refused++;
+    return NULL;
+  }
+  if (oldest_shown->state == REG_PRESENT) {
+    oldest_shown->state = REG_GONE;
+    r->evicted++;
+  } else {
+    r->recycled++;
+  }
+  if (oldest_shown->shown) reg_pending(r, oldest_shown, &r->evicted_gone[r->evicted_count++]);
+  return oldest_shown;
+}
+
+// The record's own diff in *out, false if none (or the report refused);
+// the GONE of a record it pushed out goes onto the evicted list
+static bool reg_report(registry_t* r, netsec_device_kind_t kind, const uint8_t* addr, int8_t rssi,
+                       const char* name, uint8_t channel, uint32_t flags, uint32_t now_ms, reg_diff_t* out)
+{
+  r->reports++;
+  reg_record_t* rec = reg_find(r, kind, addr);
+  if (!rec) {
+    rec = reg_take(r, now_ms);
+    if (!rec) return false;
+    memset(rec, 0, sizeof(*rec));
+    rec->dev.kind = static_cast<uint8_t>(kind);
+    memcpy(rec->dev.addr, addr, 6);
+    rec->dev.first_seen_ms = now_ms;
+    rec->dev.rssi_min = rssi;
+    rec->dev.rssi_max = rssi;
+    rec->rssi_avg_q4 = static_cast<int16_t>(rssi * 16);
+    // Back before its GONE went out: the UI still has the row
+    for (uint8_t i = 0; i < r->evicted_count; ++i) {
+      if (r->evicted_gone[i].dev.kind == kind && memcmp(r->evicted_gone[i].dev.addr, addr, 6) == 0) {
+        r->evicted_gone[i] = r->evicted_gone[--r->evicted_count];
+        rec->shown = 1;
+        rec->changed = 1;
+        break;
+      }
+    }
+  }
+
+  netsec_device_t* dev = &rec->dev;
+  bool changed = false;
+  if (name && name[0] && strncmp(dev->name, name, sizeof(dev->name)) != 0) {
+    strncpy(dev->name, name, sizeof(dev->name) - 1);
+    dev->name[sizeof(dev->name) - 1] = '\0';
+    changed = true;
+  }
+  if (channel && channel != dev->channel) {
+    dev->channel = channel;
+    changed = true;
+  }
+  if (flags != dev->flags) {
+    dev->flags = flags;
+    changed = true;
+  }
+  const int delta = rssi - rec->rssi_sent;
+  if (delta >= r->policy.rssi_step || -delta >= r->policy.rssi_step) changed = true;
+
+  dev->rssi = rssi;
+  if (rssi < dev->rssi_min) dev->rssi_min = rssi;
+  if (rssi > dev->rssi_max) dev->rssi_max = rssi;
+  dev->seen_count++;
+  const int32_t avg_n = dev->seen_count < NETSEC_REGISTRY_AVG_N ? static_cast<int32_t>(dev->seen_count) : NETSEC_REGISTRY_AVG_N;
+  rec->rssi_avg_q4 = static_cast<int16_t>(rec->rssi_avg_q4 + (rssi * 16 - rec->rssi_avg_q4) / avg_n);
+  dev->last_seen_ms = now_ms;
+  rec->last_scan = r->scan[kind];
+
+  // Back after being gone: ADDED, or CHANGED if its GONE never went out
+  rec->state = REG_PRESENT;
+  if (changed) rec->changed = 1;
+  return reg_pending(r, rec, out);
+}
+
+// Aging of one slot after a completed scan of `kind`, then the diff it still
+// owes the UI (GONE, or one the queue refused before); true with it in *out
+static bool reg_age(registry_t* r, uint16_t i, netsec_device_kind_t kind, uint32_t now_ms, reg_diff_t* out)
+{
+  reg_record_t* rec = &r->rec[i];
+  const netsec_registry_policy_t* p = &r->policy;
+  const uint32_t idle_ms = now_ms - rec->dev.last_seen_ms;
+  if (rec->state == REG_PRESENT && rec->dev.kind == kind && p->missed_scans) {
+    const uint16_t missed = static_cast<uint16_t>(r->scan[kind] - rec->last_scan - 1u);
+    if (missed >= p->missed_scans && idle_ms >= p->gone_ms) rec->state = REG_GONE;
+  } else if (rec->state == REG_GONE && !rec->shown && p->forget_ms && idle_ms >= p->forget_ms) {
+    rec->state = REG_FREE;
+    r->used--;
+    r->forgotten++;
+    return false;
+  }
+  return rec->state != REG_FREE && reg_pending(r, rec, out);
+}
+
+static void reg_stats(registry_t* r, portMUX_TYPE* lock, netsec_registry_stats_t* out)
+{
+  memset(out, 0, sizeof(*out));
+  if (lock) portENTER_CRITICAL(lock);
+  for (uint16_t i = 0; i < NETSEC_REGISTRY_CAPACITY; ++i) {
+    const reg_record_t* rec = &r->rec[i];
+    if (rec->state == REG_PRESENT && rec->dev.kind < NETSEC_REGISTRY_KINDS) {
+      out->present[rec->dev.kind]++;
+    } else if (rec->state == REG_GONE) {
+      out->gone++;
+    }
+    if ((rec->state == REG_PRESENT && (!rec->shown || rec->changed)) || (rec->state == REG_GONE && rec->shown)) {
+      out->pending++;
+    }
+  }
+  out->pending = static_cast<uint16_t>(out->pending + r->evicted_count);
+  out->peak = r->peak;
+  out->reports = r->reports;
+  out->added = r->added;
+  out->changed = r->changed;
+  out->gone_sent = r->gone_sent;
+  out->evicted = r->evicted;
+  out->recycled = r->recycled;
+  out->forgotten = r->forgotten;
+  out->refused = r->refused;
+  out->diffs_deferred = r->diffs_deferred;
+  out->diffs_lost = r->diffs_lost;
+  if (lock) portEXIT_CRITICAL(lock);
+  out->capacity = NETSEC_REGISTRY_CAPACITY;
+  out->bytes = sizeof(r->rec);
+}
+
+// ============================================================
+// Public API
+// ============================================================
+
+// False if the result queue is full: the diff is pending again
+static bool registry_send(const reg_diff_t* diff)
+{
+  netsec_result_t res;
+  memset(&res, 0, sizeof(res));
+  res.type = diff->type;
+  res.data.device = diff->dev;
+  if (sysmon_queue_send(SYSMON_QUEUE_NETSEC_RESULT, &res, 0) == pdTRUE) return true;
+  portENTER_CRITICAL(&s_registry_lock);
+  reg_unsent(&s_registry, diff);
+  portEXIT_CRITICAL(&s_registry_lock);
+  return false;
+}
+
+// GONE diffs of evicted records, until the queue refuses one
+static void registry_send_evicted(void)
+{
+  for (;;) {
+    reg_diff_t diff;
+    portENTER_CRITICAL(&s_registry_lock);
+    const bool any = s_registry.evicted_count > 0;
+    if (any) diff = s_registry.evicted_gone[--s_registry.evicted_count];
+    portEXIT_CRITICAL(&s_registry_lock);
+    if (!any || !registry_send(&diff)) return;
+  }
+}
+
+void netsec_registry_report(netsec_device_kind_t kind, const uint8_t* addr, int8_t rssi,
+                            const char* name, uint8_t channel, uint32_t flags)
+{
+  if (!addr || kind >= NETSEC_REGISTRY_KINDS) return;
+
+  reg_diff_t diff;
+  const uint32_t now_ms = millis();
+  portENTER_CRITICAL(&s_registry_lock);
+  const bool has_diff = reg_report(&s_registry, kind, addr, rssi, name, channel, flags, now_ms, &diff);
+  const bool has_evicted = s_registry.evicted_count > 0;
+  portEXIT_CRITICAL(&s_registry_lock);
+  if (has_evicted) registry_send_evicted();   // First: the UI never holds more rows than records
+  if (has_diff) registry_send(&diff);
+}
+
+void netsec_registry_scan_done(netsec_device_kind_t kind)
+{
+  if (kind >= NETSEC_REGISTRY_KINDS) return;
+
+  const uint32_t now_ms = millis();
+  portENTER_CRITICAL(&s_registry_lock);
+  s_registry.scan[kind]++;
+  portEXIT_CRITICAL(&s_registry_lock);
+
+  // One slot per critical section: the diffs are queued outside it. Every
+  // slot is visited, so what the queue refused before goes out again here.
+  registry_send_evicted();
+  for (uint16_t i = 0; i < NETSEC_REGISTRY_CAPACITY; ++i) {
+    reg_diff_t diff;
+    portENTER_CRITICAL(&s_registry_lock);
+    const bool has_diff = reg_age(&s_registry, i, kind, now_ms, &diff);
+    portEXIT_CRITICAL(&s_registry_lock);
+    if (has_diff) registry_send(&diff);
+  }
+
+  netsec_registry_stats_t st;
+  reg_stats(&s_registry, &s_registry_lock, &st);
+  DLOG_I("[NETSEC:REGISTRY] %s scan: %u WiFi + %u BLE present, %u gone kept, diffs +%lu ~%lu -%lu, %u pending, %lu lost",
+         k_kind_names[kind], st.present[NETSEC_DEVICE_WIFI], st.present[NETSEC_DEVICE_BLE], st.gone,
+         static_cast<unsigned long>(st.added), static_cast<unsigned long>(st.changed),
+         static_cast<unsigned long>(st.gone_sent), st.pending, static_cast<unsigned long>(st.diffs_lost));
+}
+
+void netsec_registry_set_policy(const netsec_registry_policy_t* policy)
+{
+  if (!policy) return;
+  portENTER_CRITICAL(&s_registry_lock);
+  s_registry.policy = *policy;
+  portEXIT_CRITICAL(&s_registry_lock);
+}
+
+void netsec_registry_get_policy(netsec_registry_policy_t* out)
+{
+  if (!out) return;
+  portENTER_CRITICAL(&s_registry_lock);
+  *out = s_registry.policy;
+  portEXIT_CRITICAL(&s_registry_lock);
+}
+
+bool netsec_registry_lookup(netsec_device_kind_t kind, const uint8_t* addr, netsec_device_t* out)
+{
+  if (!addr || !out || kind >= NETSEC_REGISTRY_KINDS) return false;
+
+  portENTER_CRITICAL(&s_registry_lock);
+  const reg_record_t* rec = reg_find(&s_registry, kind, addr);
+  if (rec) {
+    *out = rec->dev;
+    out->rssi_avg = static_cast<int8_t>(rec->rssi_avg_q4 / 16);
+  }
+  portEXIT_CRITICAL(&s_registry_lock);
+  return rec != NULL;
+}
+
+void netsec_registry_get_stats(netsec_registry_stats_t* out)
+{
+  if (!out) return;
+  reg_stats(&s_registry, &s_registry_lock, out);
+}
+
+// ============================================================
+// Benchmark
+// ============================================================
+
+#ifdef NETSEC_REGISTRY_RUN_BENCHMARK
+
+#ifndef NETSEC_REGISTRY_BENCH_SCANS
+#define NETSEC_REGISTRY_BENCH_SCANS   2000  // Of each kind
+#endif
+#define NETSEC_REGISTRY_BENCH_APS     12
+#define NETSEC_REGISTRY_BENCH_FIXED   10    // BLE devices with a public address
+#define NETSEC_REGISTRY_BENCH_PHONES  16    // Address rotating every NETSEC_REGISTRY_BENCH_ROTATE scans
+#define NETSEC_REGISTRY_BENCH_ROTATE  20
+#define NETSEC_REGISTRY_BENCH_ONESHOT 8     // Addresses seen in a single BLE scan
+#define NETSEC_REGISTRY_BENCH_WIFI_MS 5000
+#define NETSEC_REGISTRY_BENCH_BLE_MS  15000
+#define NETSEC_REGISTRY_BENCH_MODEL   (NETSEC_REGISTRY_CAPACITY + 8)
+
+// The UI side: what the diffs alone say is present
+typedef struct {
+  uint8_t kind[NETSEC_REGISTRY_BENCH_MODEL];
+  uint8_t addr[NETSEC_REGISTRY_BENCH_MODEL][6];
+  uint16_t count;
+  uint16_t peak;
+  uint32_t errors;
+  uint32_t fixed_evicted;
+  uint32_t diffs;
+} bench_model_t;
+
+static registry_t s_bench;
+static bench_model_t s_bench_model;
+static uint32_t s_bench_rng;
+
+static uint32_t bench_rand(void)
+{
+  s_bench_rng ^= s_bench_rng << 13;
+  s_bench_rng ^= s_bench_rng >> 17;
+  s_bench_rng ^= s_bench_rng << 5;
+  return s_bench_rng;
+}
+
+// Fixed APs and devices: 0x24 / 0x3C prefixes; rotating and one-shot: 0x4x
+static void bench_addr(uint8_t prefix, uint32_t id, uint8_t* addr)
+{
+  addr[0] = prefix;
+  addr[1] = 0x5A;
+  addr[2] = static_cast<uint8_t>(id >> 24);
+  addr[3] = static_cast<uint8_t>(id >> 16);
+  addr[4] = static_cast<uint8_t>(id >> 8);
+  addr[5] = static_cast<uint8_t>(id);
+}
+
+static int16_t bench_model_find(const bench_model_t* m, uint8_t kind, const uint8_t* addr)
+{
+  for (uint16_t i = 0; i < m->count; ++i) {
+    if (m->kind[i] == kind && memcmp(m->addr[i], addr, 6) == 0) return static_cast<int16_t>(i);
+  }
+  return -1;
+}
+
+static void bench_apply(const reg_diff_t* d, uint32_t now_ms)
+{
+  bench_model_t* m = &s_bench_model;
+  const int16_t at = bench_model_find(m, d->dev.kind, d->dev.addr);
+  m->diffs++;
+  switch (d->type) {
+    case NETSEC_RES_DEVICE_ADDED:
+      if (at >= 0 || m->count >= NETSEC_REGISTRY_BENCH_MODEL) {
+        m->errors++;
+        return;
+      }
+      m->kind[m->count] = d->dev.kind;
+      memcpy(m->addr[m->count], d->dev.addr, 6);
+      if (++m->count > m->peak) m->peak = m->count;
+      break;
+    case NETSEC_RES_DEVICE_CHANGED:
+      if (at < 0) m->errors++;
+      break;
+    case NETSEC_RES_DEVICE_GONE:
+      if (at < 0) {
+        m->errors++;
+        return;
+      }
+      // A fixed device pushed out while still reported
+      if (d->dev.addr[0] < 0x40 && now_ms - d->dev.last_seen_ms < s_bench.policy.gone_ms) m->fixed_evicted++;
+      m->count--;
+      m->kind[at] = m->kind[m->count];
+      memcpy(m->addr[at], m->addr[m->count], 6);
+      break;
+    default:
+      m->errors++;
+      break;
+  }
+}
+
+static void bench_report(netsec_device_kind_t kind, const uint8_t* addr, int8_t rssi, uint32_t now_ms)
+{
+  reg_diff_t diff;
+  const bool has_diff = reg_report(&s_bench, kind, addr, rssi, "", kind == NETSEC_DEVICE_WIFI ? 6 : 0, 0, now_ms, &diff);
+  while (s_bench.evicted_count) bench_apply(&s_bench.evicted_gone[--s_bench.evicted_count], now_ms);
+  if (has_diff) bench_apply(&diff, now_ms);
+}
+
+static void bench_scan_done(netsec_device_kind_t kind, uint32_t now_ms)
+{
+  s_bench.scan[kind]++;
+  for (uint16_t i = 0; i < NETSEC_REGISTRY_CAPACITY; ++i) {
+    reg_diff_t diff;
+    if (reg_age(&s_bench, i, kind, now_ms, &diff)) bench_apply(&diff, now_ms);
+  }
+}
+
+// The model holds exactly the present records
+static bool bench_consistent(void)
+{
+  uint16_t present = 0;
+  for (uint16_t i = 0; i < NETSEC_REGISTRY_CAPACITY; ++i) {
+    const reg_record_t* rec = &s_bench.rec[i];
+    if (rec->state != REG_PRESENT) continue;
+    present++;
+    if (bench_model_find(&s_bench_model, rec->dev.kind, rec->dev.addr) < 0) return false;
+  }
+  return present == s_bench_model.count && s_bench.used <= NETSEC_REGISTRY_CAPACITY;
+}
+
+static int8_t bench_rssi(uint32_t id)
+{
+  return static_cast<int8_t>(-45 - static_cast<int>(id % 40) + static_cast<int>(bench_rand() % 7) - 3);
+}
+
+void netsec_registry_run_benchmark(void)
+{
+  Serial.printf("[NETSEC:REGISTRY] Benchmark: %u scans of each kind, %u records of %u B (budget %u B)\n",
+                NETSEC_REGISTRY_BENCH_SCANS, NETSEC_REGISTRY_CAPACITY, NETSEC_REGISTRY_RECORD_BYTES,
+                NETSEC_REGISTRY_BUDGET);
+
+  const uint32_t heap_before = esp_get_free_heap_size();
+  memset(&s_bench, 0, sizeof(s_bench));
+  memset(&s_bench_model, 0, sizeof(s_bench_model));
+  s_bench.policy = k_default_policy;
+  s_bench_rng = 0x2545F491u;
+
+  uint32_t now_ms = 0;
+  uint32_t addresses = NETSEC_REGISTRY_BENCH_APS + NETSEC_REGISTRY_BENCH_FIXED;
+  uint32_t oneshot_id = 0;
+  uint32_t inconsistent = 0;
+  uint8_t addr[6];
+  const int64_t start = bench_clock_us();
+  for (uint32_t scan = 0; scan < NETSEC_REGISTRY_BENCH_SCANS; ++scan) {
+    // WiFi: fixed APs, 90 % of them each scan
+    for (uint32_t ap = 0; ap < NETSEC_REGISTRY_BENCH_APS; ++ap) {
+      if (bench_rand() % 100u < 90u) {
+        bench_addr(0x24, ap, addr);
+        bench_report(NETSEC_DEVICE_WIFI, addr, bench_rssi(ap), now_ms + ap * 100u);
+      }
+    }
+    now_ms += NETSEC_REGISTRY_BENCH_WIFI_MS;
+    bench_scan_done(NETSEC_DEVICE_WIFI, now_ms);
+
+    // BLE: fixed devices at 85 %, rotating phones, one-shot addresses, each
+    // reported one to three times in the scan
+    for (uint32_t slice = 0; slice < 3; ++slice) {
+      const uint32_t t = now_ms + slice * (NETSEC_REGISTRY_BENCH_BLE_MS / 3u);
+      for (uint32_t dev = 0; dev < NETSEC_REGISTRY_BENCH_FIXED; ++dev) {
+        if (bench_rand() % 100u < 85u) {
+          bench_addr(0x3C, dev, addr);
+          bench_report(NETSEC_DEVICE_BLE, addr, bench_rssi(dev), t);
+        }
+      }
+      for (uint32_t phone = 0; phone < NETSEC_REGISTRY_BENCH_PHONES; ++phone) {
+        if (bench_rand() % 100u < 60u) {
+          bench_addr(0x40, (phone << 16) | ((scan + phone) / NETSEC_REGISTRY_BENCH_ROTATE), addr);
+          bench_report(NETSEC_DEVICE_BLE, addr, bench_rssi(phone), t);
+        }
+      }
+      for (uint32_t i = 0; i < NETSEC_REGISTRY_BENCH_ONESHOT; ++i) {
+        if (slice == 0 || bench_rand() % 100u < 50u) {
+          bench_addr(0x48, oneshot_id + i, addr);
+          bench_report(NETSEC_DEVICE_BLE, addr, bench_rssi(i), t);
+        }
+      }
+    }
+    oneshot_id += NETSEC_REGISTRY_BENCH_ONESHOT;
+    addresses += NETSEC_REGISTRY_BENCH_ONESHOT;
+    now_ms += NETSEC_REGISTRY_BENCH_BLE_MS;
+    bench_scan_done(NETSEC_DEVICE_BLE, now_ms);
+
+    if (!bench_consistent()) inconsistent++;
+  }
+  const uint32_t elapsed_us = static_cast<uint32_t>(bench_clock_us() - start);
+  for (uint32_t phone = 0; phone < NETSEC_REGISTRY_BENCH_PHONES; ++phone) {
+    addresses += (NETSEC_REGISTRY_BENCH_SCANS - 1u + phone) / NETSEC_REGISTRY_BENCH_ROTATE -
+                 phone / NETSEC_REGISTRY_BENCH_ROTATE + 1u;
+  }
+  const uint32_t heap_after = esp_get_free_heap_size();
+
+  const bench_model_t* m = &s_bench_model;
+  Serial.printf("[NETSEC:REGISTRY]   %lu reports, %lu addresses: diffs +%lu ~%lu -%lu (%lu %% of the reports)\n",
+                static_cast<unsigned long>(s_bench.reports), static_cast<unsigned long>(addresses),
+                static_cast<unsigned long>(s_bench.added), static_cast<unsigned long>(s_bench.changed),
+                static_cast<unsigned long>(s_bench.gone_sent),
+                static_cast<unsigned long>(s_bench.reports ? static_cast<uint64_t>(m->diffs) * 100u / s_bench.reports : 0));
+  Serial.printf("[NETSEC:REGISTRY]   records peak %u/%u, model peak %u, %lu evicted, %lu recycled, %lu forgotten\n",
+                s_bench.peak, NETSEC_REGISTRY_CAPACITY, m->peak, static_cast<unsigned long>(s_bench.evicted),
+                static_cast<unsigned long>(s_bench.recycled), static_cast<unsigned long>(s_bench.forgotten));
+  Serial.printf("[NETSEC:REGISTRY]   %lu diff errors, %lu scans out of step, %lu fixed devices evicted, heap %ld B\n",
+                static_cast<unsigned long>(m->errors), static_cast<unsigned long>(inconsistent),
+                static_cast<unsigned long>(m->fixed_evicted),
+                static_cast<long>(heap_before) - static_cast<long>(heap_after));
+  Serial.printf("[NETSEC:REGISTRY]   %lu us: %lu reports/s\n", static_cast<unsigned long>(elapsed_us),
+                static_cast<unsigned long>(elapsed_us ? static_cast<uint64_t>(s_bench.reports) * 1000000u / elapsed_us : 0));
+}
+
+#endif // NETSEC_REGISTRY_RUN_BENCHMARK
@@ -0,0 +1,730 @@
+/*
+ * NETSEC - Streaming sketches
+ *
+ * One 32-bit hash per report (kind + address) drives everything: the top
+ * bits pick the HyperLogLog register, the rest gives its rank; each
+ * count-min row remixes it. Slot sketches are cleared as the clock
+ * moves into them, so a window query is a register-wise max over slots.
+ */
+
+#include "netsec_sketch.h"
+#include "bench_clock.h"
+#include "deferred_log.h"
+#include <Arduino.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#define NETSEC_SKETCH_SLOT_MS       (NETSEC_SKETCH_SLOT_S * 1000u)
+#define NETSEC_SKETCH_EH_WINDOW_MS  (NETSEC_SKETCH_EH_WINDOW_S * 1000u)
+#define NETSEC_SKETCH_EH_PER_SIZE   (NETSEC_SKETCH_EH_K / 2 + 1)
+
+typedef struct {
+  uint8_t slot[NETSEC_SKETCH_SLOTS][NETSEC_SKETCH_HLL_REGS];
+  uint8_t session[NETSEC_SKETCH_HLL_REGS];
+} sketch_hll_t;
+
+// Buckets oldest first; sizes 2^exp never grow from older to newer
+typedef struct {
+  uint32_t ts_ms[NETSEC_SKETCH_EH_BUCKETS];   // Newest report in the bucket
+  uint8_t exp[NETSEC_SKETCH_EH_BUCKETS];
+  uint8_t count;
+  uint32_t total;
+} sketch_eh_t;
+
+typedef struct {
+  sketch_hll_t hll[NETSEC_SKETCH_KINDS];
+  sketch_eh_t eh[NETSEC_SKETCH_KINDS];
+  uint16_t cm[NETSEC_SKETCH_CM_DEPTH][NETSEC_SKETCH_CM_WIDTH];
+  netsec_sketch_top_t top[NETSEC_SKETCH_TOP];
+  uint8_t top_count;
+  bool started;
+  uint32_t epoch;             // Slot number (clock / slot length) of the current slot
+  uint32_t reports;
+  uint32_t halvings;
+  uint32_t eh_dropped;
+} sketch_t;
+
+static_assert(sizeof(sketch_t) <= NETSEC_SKETCH_BUDGET, "Sketch state over NETSEC_SKETCH_BUDGET");
+static_assert((NETSEC_SKETCH_CM_WIDTH & (NETSEC_SKETCH_CM_WIDTH - 1)) == 0, "Count-min width must be a power of two");
+
+static portMUX_TYPE s_sketch_lock = portMUX_INITIALIZER_UNLOCKED;
+static sketch_t s_sketch;
+
+static const char* const k_kind_names[NETSEC_SKETCH_KINDS] = { "WiFi", "BLE" };
+
+// ============================================================
+// Hashing
+// ============================================================
+
+static uint32_t sketch_mix(uint32_t h)
+{
+  h ^= h >> 16;
+  h *= 0x85EBCA6Bu;
+  h ^= h >> 13;
+  h *= 0xC2B2AE35u;
+  h ^= h >> 16;
+  return h;
+}
+
+static uint32_t sketch_hash(netsec_sketch_kind_t kind, const uint8_t* addr)
+{
+  uint32_t h = (2166136261u ^ static_cast<uint32_t>(kind)) * 16777619u;
+  for (uint8_t i = 0; i < 6; ++i) {
+    h = (h ^ addr[i]) * 16777619u;
+  }
+  return sketch_mix(h);
+}
+
+// Remixed per row: double hashing (h + row * h2) shares its low bits across
+// rows, and one key in 65536 then lands on a heavy hitter in every row
+static uint32_t cm_column(uint32_t h, uint8_t row)
+{
+  return sketch_mix(h ^ (row * 0x9E3779B9u)) & (NETSEC_SKETCH_CM_WIDTH - 1);
+}
+
+// ============================================================
+// HyperLogLog
+// ============================================================
+
+// Moves the slot ring to the clock; slots skipped over are cleared
+static void hll_advance(sketch_t* s, uint32_t now_ms)
+{
+  const uint32_t epoch = now_ms / NETSEC_SKETCH_SLOT_MS;
+  if (!s->started) {
+    s->started = true;
+    s->epoch = epoch;
+    return;
+  }
+  uint32_t gap = epoch - s->epoch;    // Huge (clears all) if millis() wrapped
+  if (!gap) return;
+  if (gap > NETSEC_SKETCH_SLOTS) gap = NETSEC_SKETCH_SLOTS;
+  for (uint32_t i = 1; i <= gap; ++i) {
+    for (uint8_t k = 0; k < NETSEC_SKETCH_KINDS; ++k) {
+      memset(s->hll[k].slot[(s->epoch + i) % NETSEC_SKETCH_SLOTS], 0, NETSEC_SKETCH_HLL_REGS);
+    }
+  }
+  s->epoch = epoch;
+}
+
+static void hll_add(sketch_hll_t* hll, uint32_t slot, uint32_t h)
+{
+  const uint32_t reg = h >> (32 - NETSEC_SKETCH_HLL_P);
+  const uint8_t rank = static_cast<uint8_t>(
+      __builtin_clz((h << NETSEC_SKETCH_HLL_P) | (1u << (NETSEC_SKETCH_HLL_P - 1))) + 1);
+  if (hll->slot[slot][reg] < rank) hll->slot[slot][reg] = rank;
+  if (hll->session[reg] < rank) hll->session[reg] = rank;
+}
+
+// Registers of the last `slots` slots, max-merged (0: the session sketch)
+static void hll_collect(const sketch_t* s, netsec_sketch_kind_t kind, uint32_t slots, uint8_t* out)
+{
+  const sketch_hll_t* hll = &s->hll[kind];
+  if (!slots) {
+    memcpy(out, hll->session, NETSEC_SKETCH_HLL_REGS);
+    return;
+  }
+  memset(out, 0, NETSEC_SKETCH_HLL_REGS);
+  const uint32_t current = s->epoch % NETSEC_SKETCH_SLOTS;
+  for (uint32_t i = 0; i < slots; ++i) {
+    const uint8_t* regs = hll->slot[(current + NETSEC_SKETCH_SLOTS - i) % NETSEC_SKETCH_SLOTS];
+    for (uint32_t r = 0; r < NETSEC_SKETCH_HLL_REGS; ++r) {
+      if (out[r] < regs[r]) out[r] = regs[r];
+    }
+  }
+}
+
+// Raw estimate, linear counting while registers are still empty
+static uint32_t hll_estimate(const uint8_t* regs)
+{
+  const float m = static_cast<float>(NETSEC_SKETCH_HLL_REGS);
+  float sum = 0.0f;
+  uint32_t zeros = 0;
+  for (uint32_t r = 0; r < NETSEC_SKETCH_HLL_REGS; ++r) {
+    sum += 1.0f / static_cast<float>(1u << regs[r]);
+    if (!regs[r]) zeros++;
+  }
+  float e = 0.7213f / (1.0f + 1.079f / m) * m * m / sum;
+  if (e <= 2.5f * m && zeros) {
+    e = m * logf(m / static_cast<float>(zeros));
+  }
+  return static_cast<uint32_t>(e + 0.5f);
+}
+
+static uint32_t window_slots(uint32_t window_s)
+{
+  if (!window_s) return 0;
+  uint32_t slots = (window_s + NETSEC_SKETCH_SLOT_S - 1) / NETSEC_SKETCH_SLOT_S;
+  return slots > NETSEC_SKETCH_SLOTS ? NETSEC_SKETCH_SLOTS : slots;
+}
+
+// ============================================================
+// Count-min and top list
+// ============================================================
+
+static void cm_halve(sketch_t* s)
+{
+  for (uint8_t row = 0; row < NETSEC_SKETCH_CM_DEPTH; ++row) {
+    for (uint32_t col = 0; col < NETSEC_SKETCH_CM_WIDTH; ++col) {
+      s->cm[row][col] >>= 1;
+    }
+  }
+  for (uint8_t i = 0; i < s->top_count; ++i) {
+    s->top[i].count >>= 1;
+  }
+  s->halvings++;
+}
+
+// Keeps the list sorted, most reported first
+static void top_offer(sketch_t* s, netsec_sketch_kind_t kind, const uint8_t* addr, uint32_t count)
+{
+  uint8_t i = 0;
+  while (i < s->top_count && !(s->top[i].kind == kind && memcmp(s->top[i].addr, addr, 6) == 0)) {
+    ++i;
+  }
+  if (i == s->top_count) {
+    if (s->top_count < NETSEC_SKETCH_TOP) {
+      s->top_count++;
+    } else if (count > s->top[NETSEC_SKETCH_TOP - 1].count) {
+      i = NETSEC_SKETCH_TOP - 1;
+    } else {
+      return;
+    }
+    memcpy(s->top[i].addr, addr, 6);
+    s->top[i].kind = static_cast<uint8_t>(kind);
+  }
+  s->top[i].count = count;
+  while (i > 0 && s->top[i - 1].count < s->top[i].count) {
+    netsec_sketch_top_t tmp = s->top[i - 1];
+    s->top[i - 1] = s->top[i];
+    s->top[i] = tmp;
+    --i;
+  }
+}
+
+// Conservative update: only the counters at the minimum move
+static void cm_add(sketch_t* s, netsec_sketch_kind_t kind, const uint8_t* addr, uint32_t h)
+{
+  uint32_t col[NETSEC_SKETCH_CM_DEPTH];
+  uint16_t low = UINT16_MAX;
+  for (uint8_t row = 0; row < NETSEC_SKETCH_CM_DEPTH; ++row) {
+    col[row] = cm_column(h, row);
+    uint16_t c = s->cm[row][col[row]];
+    if (c < low) low = c;
+  }
+  if (low == UINT16_MAX) {
+    cm_halve(s);
+    low >>= 1;
+  }
+  const uint16_t next = static_cast<uint16_t>(low + 1);
+  for (uint8_t row = 0; row < NETSEC_SKETCH_CM_DEPTH; ++row) {
+    uint16_t* c = &s->cm[row][col[row]];
+    if (*c < next) *c = next;
+  }
+  top_offer(s, kind, addr, next);
+}
+
+static uint32_t cm_estimate(const sketch_t* s, uint32_t h)
+{
+  uint16_t low = UINT16_MAX;
+  for (uint8_t row = 0; row < NETSEC_SKETCH_CM_DEPTH; ++row) {
+    uint16_t c = s->cm[row][cm_column(h, row)];
+    if (c < low) low = c;
+  }
+  return low;
+}
+
+// ============================================================
+// Exponential histogram
+// ============================================================
+
+static void eh_remove(sketch_eh_t* eh, uint8_t first, uint8_t n)
+{
+  const uint8_t rest = static_cast<uint8_t>(eh->count - first - n);
+  memmove(&eh->ts_ms[first], &eh->ts_ms[first + n], rest * sizeof(eh->ts_ms[0]));
+  memmove(&eh->exp[first], &eh->exp[first + n], rest);
+  eh->count = static_cast<uint8_t>(eh->count - n);
+}
+
+static void eh_expire(sketch_eh_t* eh, uint32_t now_ms)
+{
+  uint8_t n = 0;
+  while (n < eh->count && now_ms - eh->ts_ms[n] >= NETSEC_SKETCH_EH_WINDOW_MS) {
+    eh->total -= 1u << eh->exp[n];
+    ++n;
+  }
+  if (n) eh_remove(eh, 0, n);
+}
+
+static void eh_add(sketch_t* s, sketch_eh_t* eh, uint32_t now_ms)
+{
+  eh_expire(eh, now_ms);
+  if (eh->count == NETSEC_SKETCH_EH_BUCKETS) {
+    eh->total -= 1u << eh->exp[0];
+    eh_remove(eh, 0, 1);
+    s->eh_dropped++;
+  }
+  eh->ts_ms[eh->count] = now_ms;
+  eh->exp[eh->count] = 0;
+  eh->count++;
+  eh->total++;
+
+  // Too many buckets of one size: the two oldest become one of twice the size
+  uint8_t end = eh->count;
+  for (uint8_t e = 0;; ++e) {
+    uint8_t first = end;
+    while (first > 0 && eh->exp[first - 1] == e) --first;
+    if (end - first <= NETSEC_SKETCH_EH_PER_SIZE) break;
+    eh->exp[first] = static_cast<uint8_t>(e + 1);
+    eh->ts_ms[first] = eh->ts_ms[first + 1];
+    eh_remove(eh, static_cast<uint8_t>(first + 1), 1);
+    end = static_cast<uint8_t>(first + 1);
+  }
+}
+
+// The oldest bucket straddles the window edge: count half of it
+static uint32_t eh_count(const sketch_eh_t* eh, uint32_t now_ms, uint32_t window_ms)
+{
+  uint32_t sum = 0;
+  uint32_t oldest = 0;
+  for (int i = eh->count - 1; i >= 0; --i) {
+    if (now_ms - eh->ts_ms[i] >= window_ms) break;
+    oldest = 1u << eh->exp[i];
+    sum += oldest;
+  }
+  return sum - oldest / 2;
+}
+
+// ============================================================
+// Sketch
+// ============================================================
+
+static void sketch_add(sketch_t* s, netsec_sketch_kind_t kind, const uint8_t* addr, uint32_t now_ms)
+{
+  const uint32_t h = sketch_hash(kind, addr);
+  hll_advance(s, now_ms);
+  hll_add(&s->hll[kind], s->epoch % NETSEC_SKETCH_SLOTS, h);
+  cm_add(s, kind, addr, h);
+  eh_add(s, &s->eh[kind], now_ms);
+  s->reports++;
+}
+
+static uint32_t sketch_unique(sketch_t* s, portMUX_TYPE* lock, netsec_sketch_kind_t kind, uint32_t window_s,
+                              uint32_t now_ms)
+{
+  uint8_t regs[NETSEC_SKETCH_HLL_REGS];
+  if (lock) portENTER_CRITICAL(lock);
+  hll_advance(s, now_ms);
+  hll_collect(s, kind, window_slots(window_s), regs);
+  if (lock) portEXIT_CRITICAL(lock);
+  return hll_estimate(regs);
+}
+
+static uint32_t sketch_rate(sketch_t* s, netsec_sketch_kind_t kind, uint32_t window_s, uint32_t now_ms)
+{
+  if (window_s > NETSEC_SKETCH_EH_WINDOW_S) window_s = NETSEC_SKETCH_EH_WINDOW_S;
+  eh_expire(&s->eh[kind], now_ms);
+  return eh_count(&s->eh[kind], now_ms, window_s * 1000u);
+}
+
+void netsec_sketch_observe(netsec_sketch_kind_t kind, const uint8_t* addr)
+{
+  if (!addr || kind >= NETSEC_SKETCH_KINDS) return;
+  const uint32_t now_ms = millis();
+  portENTER_CRITICAL(&s_sketch_lock);
+  sketch_add(&s_sketch, kind, addr, now_ms);
+  portEXIT_CRITICAL(&s_sketch_lock);
+}
+
+void netsec_sketch_reset(void)
+{
+  portENTER_CRITICAL(&s_sketch_lock);
+  memset(&s_sketch, 0, sizeof(s_sketch));
+  portEXIT_CRITICAL(&s_sketch_lock);
+}
+
+uint32_t netsec_sketch_unique(netsec_sketch_kind_t kind, uint32_t window_s)
+{
+  if (kind >= NETSEC_SKETCH_KINDS) return 0;
+  return sketch_unique(&s_sketch, &s_sketch_lock, kind, window_s, millis());
+}
+
+uint32_t netsec_sketch_rate(netsec_sketch_kind_t kind, uint32_t window_s)
+{
+  if (kind >= NETSEC_SKETCH_KINDS) return 0;
+  const uint32_t now_ms = millis();
+  portENTER_CRITICAL(&s_sketch_lock);
+  uint32_t n = sketch_rate(&s_sketch, kind, window_s, now_ms);
+  portEXIT_CRITICAL(&s_sketch_lock);
+  return n;
+}
+
+uint32_t netsec_sketch_frequency(netsec_sketch_kind_t kind, const uint8_t* addr)
+{
+  if (!addr || kind >= NETSEC_SKETCH_KINDS) return 0;
+  const uint32_t h = sketch_hash(kind, addr);
+  portENTER_CRITICAL(&s_sketch_lock);
+  uint32_t n = cm_estimate(&s_sketch, h);
+  portEXIT_CRITICAL(&s_sketch_lock);
+  return n;
+}
+
+static void sketch_stats(sketch_t* s, portMUX_TYPE* lock, uint32_t now_ms, netsec_sketch_stats_t* out)
+{
+  memset(out, 0, sizeof(*out));
+  for (uint8_t k = 0; k < NETSEC_SKETCH_KINDS; ++k) {
+    const netsec_sketch_kind_t kind = static_cast<netsec_sketch_kind_t>(k);
+    out->unique[k] = sketch_unique(s, lock, kind, 0, now_ms);
+    out->unique_window[k] = sketch_unique(s, lock, kind, NETSEC_SKETCH_SLOTS * NETSEC_SKETCH_SLOT_S, now_ms);
+  }
+  if (lock) portENTER_CRITICAL(lock);
+  for (uint8_t k = 0; k < NETSEC_SKETCH_KINDS; ++k) {
+    out->per_minute[k] = sketch_rate(s, static_cast<netsec_sketch_kind_t>(k), 60, now_ms);
+  }
+  out->reports = s->reports;
+  out->halvings = s->halvings;
+  out->eh_dropped = s->eh_dropped;
+  out->top_count = s->top_count;
+  memcpy(out->top, s->top, sizeof(out->top));
+  if (lock) portEXIT_CRITICAL(lock);
+  out->bytes = sizeof(sketch_t);
+}
+
+void netsec_sketch_get_stats(netsec_sketch_stats_t* out)
+{
+  if (!out) return;
+  sketch_stats(&s_sketch, &s_sketch_lock, millis(), out);
+}
+
+void netsec_sketch_log(void)
+{
+  netsec_sketch_stats_t st;
+  netsec_sketch_get_stats(&st);
+  DLOG_I("[NETSEC:SKETCH] WiFi %lu distinct (1 h: %lu), %lu/min | BLE %lu distinct (1 h: %lu), %lu/min",
+         st.unique[NETSEC_SKETCH_WIFI], st.unique_window[NETSEC_SKETCH_WIFI], st.per_minute[NETSEC_SKETCH_WIFI],
+         st.unique[NETSEC_SKETCH_BLE], st.unique_window[NETSEC_SKETCH_BLE], st.per_minute[NETSEC_SKETCH_BLE]);
+  if (st.top_count) {
+    const netsec_sketch_top_t* t = &st.top[0];
+    DLOG_I("[NETSEC:SKETCH] Most reported: %02X:%02X:%02X:%02X:%02X:%02X x%lu (%s)",
+           t->addr[0], t->addr[1], t->addr[2], t->addr[3], t->addr[4], t->addr[5], t->count,
+           k_kind_names[t->kind]);
+  }
+}
+
+// ============================================================
+// Benchmark
+// ============================================================
+
+#ifndef NETSEC_SKETCH_BENCH_MINUTES
+#define NETSEC_SKETCH_BENCH_MINUTES     120
+#endif
+#ifndef NETSEC_SKETCH_BENCH_ARRIVALS_PER_MIN
+#define NETSEC_SKETCH_BENCH_ARRIVALS_PER_MIN 60    // New BLE addresses
+#endif
+#define NETSEC_SKETCH_BENCH_APS         40    // WiFi, one scan every 10 s
+#define NETSEC_SKETCH_BENCH_BEACONS     24    // BLE, fixed address
+#define NETSEC_SKETCH_BENCH_CHATTY      4     // BLE, 6 reports a second
+#define NETSEC_SKETCH_BENCH_ACTIVE      1024  // Randomised devices in range at once
+#define NETSEC_SKETCH_BENCH_ROTATE_S    900   // Address rotation of devices that stay
+#define NETSEC_SKETCH_BENCH_HEAVY_PCT   2     // Heavy hitter: this share of the reports
+#define NETSEC_SKETCH_BENCH_UPDATES     200000
+
+#define NETSEC_SKETCH_BENCH_FIXED (NETSEC_SKETCH_BENCH_APS + NETSEC_SKETCH_BENCH_BEACONS + NETSEC_SKETCH_BENCH_CHATTY)
+
+typedef struct {
+  uint32_t id;
+  uint32_t leave_s;
+  uint32_t rotate_s;
+} bench_device_t;
+
+typedef struct {
+  uint32_t max_ids;
+  uint32_t next_id;
+  uint32_t* count;            // Exact reports per address
+  uint8_t* last_slot;         // Slot of the last report + 1 (0: never)
+  uint16_t* per_second[NETSEC_SKETCH_KINDS];  // Ring, NETSEC_SKETCH_EH_WINDOW_S seconds
+  uint32_t unique[NETSEC_SKETCH_KINDS];
+  uint32_t reports;
+  bench_device_t* active;
+  uint32_t active_count;
+  uint32_t rng;
+} bench_truth_t;
+
+typedef struct {
+  uint32_t samples;
+  uint32_t max_x10;           // Relative error, 0.1 % units
+  uint64_t sum_x10;
+} bench_error_t;
+
+static sketch_t s_bench;
+
+static uint32_t bench_rand(bench_truth_t* t)
+{
+  uint32_t x = t->rng;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  t->rng = x;
+  return x;
+}
+
+static bool bench_chance(bench_truth_t* t, uint32_t percent)
+{
+  return bench_rand(t) % 100u < percent;
+}
+
+static netsec_sketch_kind_t bench_kind(uint32_t id)
+{
+  return id < NETSEC_SKETCH_BENCH_APS ? NETSEC_SKETCH_WIFI : NETSEC_SKETCH_BLE;
+}
+
+static void bench_addr(uint32_t id, uint8_t* addr)
+{
+  addr[0] = bench_kind(id) == NETSEC_SKETCH_WIFI ? 0x24 : 0xC2;
+  addr[1] = 0x5A;
+  addr[2] = static_cast<uint8_t>(id >> 24);
+  addr[3] = static_cast<uint8_t>(id >> 16);
+  addr[4] = static_cast<uint8_t>(id >> 8);
+  addr[5] = static_cast<uint8_t>(id);
+}
+
+static void bench_report(bench_truth_t* t, uint32_t id, uint32_t now_s)
+{
+  uint8_t addr[6];
+  const netsec_sketch_kind_t kind = bench_kind(id);
+  bench_addr(id, addr);
+  sketch_add(&s_bench, kind, addr, now_s * 1000u);
+
+  if (!t->last_slot[id]) t->unique[kind]++;
+  t->last_slot[id] = static_cast<uint8_t>(now_s / NETSEC_SKETCH_SLOT_S + 1);
+  t->count[id]++;
+  t->per_second[kind][now_s % NETSEC_SKETCH_EH_WINDOW_S]++;
+  t->reports++;
+}
+
+static void bench_spawn(bench_truth_t* t, uint32_t now_s)
+{
+  if (t->active_count == NETSEC_SKETCH_BENCH_ACTIVE || t->next_id == t->max_ids) return;
+  bench_device_t* d = &t->active[t->active_count++];
+  d->id = t->next_id++;
+  // Most walk past, one in ten stays (and rotates its address)
+  if (bench_chance(t, 90)) {
+    d->leave_s = now_s + 20 + bench_rand(t) % 281;
+  } else {
+    d->leave_s = now_s + 1200 + bench_rand(t) % 2401;
+  }
+  d->rotate_s = now_s + NETSEC_SKETCH_BENCH_ROTATE_S;
+}
+
+// One second of the synthetic session
+static void bench_second(bench_truth_t* t, uint32_t now_s, uint32_t* arrivals_acc)
+{
+  for (uint8_t k = 0; k < NETSEC_SKETCH_KINDS; ++k) {
+    t->per_second[k][now_s % NETSEC_SKETCH_EH_WINDOW_S] = 0;
+  }
+  if (now_s % 10 == 0) {
+    for (uint32_t id = 0; id < NETSEC_SKETCH_BENCH_APS; ++id) {
+      if (bench_chance(t, 90)) bench_report(t, id, now_s);
+    }
+  }
+  for (uint32_t id = NETSEC_SKETCH_BENCH_APS; id < NETSEC_SKETCH_BENCH_APS + NETSEC_SKETCH_BENCH_BEACONS; ++id) {
+    if (bench_chance(t, 80)) bench_report(t, id, now_s);
+  }
+  for (uint32_t id = NETSEC_SKETCH_BENCH_APS + NETSEC_SKETCH_BENCH_BEACONS; id < NETSEC_SKETCH_BENCH_FIXED; ++id) {
+    for (uint8_t r = 0; r < 6; ++r) bench_report(t, id, now_s);
+  }
+
+  *arrivals_acc += NETSEC_SKETCH_BENCH_ARRIVALS_PER_MIN;
+  while (*arrivals_acc >= 60) {
+    *arrivals_acc -= 60;
+    bench_spawn(t, now_s);
+  }
+
+  for (uint32_t i = 0; i < t->active_count;) {
+    bench_device_t* d = &t->active[i];
+    if (now_s >= d->leave_s) {
+      *d = t->active[--t->active_count];
+      continue;
+    }
+    if (now_s >= d->rotate_s && t->next_id < t->max_ids) {
+      d->id = t->next_id++;
+      d->rotate_s += NETSEC_SKETCH_BENCH_ROTATE_S;
+    }
+    if (bench_chance(t, 30)) bench_report(t, d->id, now_s);
+    ++i;
+  }
+}
+
+static void bench_error(bench_error_t* e, uint32_t estimate, uint32_t exact)
+{
+  if (!exact) return;
+  const uint32_t diff = estimate > exact ? estimate - exact : exact - estimate;
+  const uint32_t x10 = static_cast<uint32_t>(static_cast<uint64_t>(diff) * 1000u / exact);
+  e->samples++;
+  e->sum_x10 += x10;
+  if (x10 > e->max_x10) e->max_x10 = x10;
+}
+
+static void bench_print_error(const char* what, const bench_error_t* e)
+{
+  const uint32_t mean = e->samples ? static_cast<uint32_t>(e->sum_x10 / e->samples) : 0;
+  Serial.printf("[NETSEC:SKETCH]   %-22s %3lu checks, error mean %2lu.%lu %%, max %2lu.%lu %%\n", what,
+                static_cast<unsigned long>(e->samples), static_cast<unsigned long>(mean / 10),
+                static_cast<unsigned long>(mean % 10), static_cast<unsigned long>(e->max_x10 / 10),
+                static_cast<unsigned long>(e->max_x10 % 10));
+}
+
+// Distinct addresses of one kind reported in the last `slots` slots
+static uint32_t bench_exact_window(const bench_truth_t* t, netsec_sketch_kind_t kind, uint32_t slot, uint32_t slots)
+{
+  const uint32_t oldest = slot + 1 >= slots ? slot + 1 - slots : 0;
+  uint32_t n = 0;
+  for (uint32_t id = 0; id < t->next_id; ++id) {
+    if (bench_kind(id) == kind && t->last_slot[id] && t->last_slot[id] - 1u >= oldest) n++;
+  }
+  return n;
+}
+
+static uint32_t bench_exact_rate(const bench_truth_t* t, netsec_sketch_kind_t kind, uint32_t now_s, uint32_t window_s)
+{
+  uint32_t n = 0;
+  for (uint32_t i = 0; i < window_s && i <= now_s; ++i) {
+    n += t->per_second[kind][(now_s - i) % NETSEC_SKETCH_EH_WINDOW_S];
+  }
+  return n;
+}
+
+void netsec_sketch_run_benchmark(void)
+{
+  const uint32_t seconds = NETSEC_SKETCH_BENCH_MINUTES * 60u;
+  bench_truth_t t;
+  memset(&t, 0, sizeof(t));
+  t.rng = 1;
+  t.max_ids = NETSEC_SKETCH_BENCH_FIXED + NETSEC_SKETCH_BENCH_MINUTES * NETSEC_SKETCH_BENCH_ARRIVALS_PER_MIN * 2u;
+  t.next_id = NETSEC_SKETCH_BENCH_FIXED;
+  t.count = static_cast<uint32_t*>(calloc(t.max_ids, sizeof(uint32_t)));
+  t.last_slot = static_cast<uint8_t*>(calloc(t.max_ids, 1));
+  t.active = static_cast<bench_device_t*>(calloc(NETSEC_SKETCH_BENCH_ACTIVE, sizeof(bench_device_t)));
+  for (uint8_t k = 0; k < NETSEC_SKETCH_KINDS; ++k) {
+    t.per_second[k] = static_cast<uint16_t*>(calloc(NETSEC_SKETCH_EH_WINDOW_S, sizeof(uint16_t)));
+  }
+
+  if (!t.count || !t.last_slot || !t.active || !t.per_second[0] || !t.per_second[1] ||
+      seconds / NETSEC_SKETCH_SLOT_S >= UINT8_MAX) {
+    Serial.println("[ERROR] Sketch benchmark: ground truth allocation failed (lower NETSEC_SKETCH_BENCH_MINUTES)");
+  } else {
+    Serial.printf("[NETSEC:SKETCH] Benchmark: %u min, %u new BLE addresses/min, sketch %u B\n",
+                  NETSEC_SKETCH_BENCH_MINUTES, NETSEC_SKETCH_BENCH_ARRIVALS_PER_MIN,
+                  static_cast<unsigned>(sizeof(sketch_t)));
+    memset(&s_bench, 0, sizeof(s_bench));
+
+    bench_error_t session = {}, hour = {}, slot = {}, minute_rate = {}, window_rate = {};
+    uint32_t arrivals_acc = 0;
+    for (uint32_t now_s = 0; now_s < seconds; ++now_s) {
+      bench_second(&t, now_s, &arrivals_acc);
+      if (now_s % 60 == 59) vTaskDelay(1);    // Idle task and its watchdog
+      if (now_s % NETSEC_SKETCH_SLOT_S != NETSEC_SKETCH_SLOT_S - 1) continue;
+
+      const uint32_t now_ms = now_s * 1000u;
+      const uint32_t cur = now_s / NETSEC_SKETCH_SLOT_S;
+      for (uint8_t k = 0; k < NETSEC_SKETCH_KINDS; ++k) {
+        const netsec_sketch_kind_t kind = static_cast<netsec_sketch_kind_t>(k);
+        bench_error(&session, sketch_unique(&s_bench, NULL, kind, 0, now_ms), t.unique[k]);
+        bench_error(&hour, sketch_unique(&s_bench, NULL, kind, NETSEC_SKETCH_SLOTS * NETSEC_SKETCH_SLOT_S, now_ms),
+                    bench_exact_window(&t, kind, cur, NETSEC_SKETCH_SLOTS));
+        bench_error(&slot, sketch_unique(&s_bench, NULL, kind, NETSEC_SKETCH_SLOT_S, now_ms),
+                    bench_exact_window(&t, kind, cur, 1));
+        bench_error(&minute_rate, sketch_rate(&s_bench, kind, 60, now_ms), bench_exact_rate(&t, kind, now_s, 60));
+        bench_error(&window_rate, sketch_rate(&s_bench, kind, NETSEC_SKETCH_EH_WINDOW_S, now_ms),
+                    bench_exact_rate(&t, kind, now_s, NETSEC_SKETCH_EH_WINDOW_S));
+      }
+      Serial.printf("[NETSEC:SKETCH]   %4lu min: BLE %lu distinct (sketch %lu), last hour %lu (%lu), %lu/min (%lu)\n",
+                    static_cast<unsigned long>((now_s + 1) / 60), static_cast<unsigned long>(t.unique[1]),
+                    static_cast<unsigned long>(sketch_unique(&s_bench, NULL, NETSEC_SKETCH_BLE, 0, now_ms)),
+                    static_cast<unsigned long>(bench_exact_window(&t, NETSEC_SKETCH_BLE, cur, NETSEC_SKETCH_SLOTS)),
+                    static_cast<unsigned long>(sketch_unique(&s_bench, NULL, NETSEC_SKETCH_BLE,
+                                                             NETSEC_SKETCH_SLOTS * NETSEC_SKETCH_SLOT_S, now_ms)),
+                    static_cast<unsigned long>(bench_exact_rate(&t, NETSEC_SKETCH_BLE, now_s, 60)),
+                    static_cast<unsigned long>(sketch_rate(&s_bench, NETSEC_SKETCH_BLE, 60, now_ms)));
+    }
+
+    Serial.printf("[NETSEC:SKETCH] %lu reports, %lu WiFi + %lu BLE distinct; accuracy against exact counts:\n",
+                  static_cast<unsigned long>(t.reports), static_cast<unsigned long>(t.unique[0]),
+                  static_cast<unsigned long>(t.unique[1]));
+    bench_print_error("distinct, session", &session);
+    bench_print_error("distinct, last hour", &hour);
+    bench_print_error("distinct, current slot", &slot);
+    bench_print_error("reports, last minute", &minute_rate);
+    bench_print_error("reports, last 10 min", &window_rate);
+
+    // Heavy hitters: every address above the threshold must be listed; none
+    // listed may be below it by more than the count-min bound (e / width)
+    const uint32_t heavy = t.reports / 100u * NETSEC_SKETCH_BENCH_HEAVY_PCT;
+    const uint32_t slack = static_cast<uint32_t>(static_cast<uint64_t>(t.reports) * 2718u / 1000u /
+                                                 NETSEC_SKETCH_CM_WIDTH);
+    uint32_t heavy_total = 0, heavy_listed = 0, false_listed = 0, worst_over = 0;
+    for (uint32_t id = 0; id < t.next_id; ++id) {
+      uint8_t addr[6];
+      bench_addr(id, addr);
+      const uint32_t est = cm_estimate(&s_bench, sketch_hash(bench_kind(id), addr));
+      if (est >= t.count[id] && est - t.count[id] > worst_over) worst_over = est - t.count[id];
+      if (t.count[id] < heavy) continue;
+      heavy_total++;
+      for (uint8_t i = 0; i < s_bench.top_count; ++i) {
+        if (memcmp(s_bench.top[i].addr, addr, 6) == 0) {
+          heavy_listed++;
+          break;
+        }
+      }
+    }
+    uint32_t undercount = 0;
+    for (uint32_t id = 0; id < t.next_id; ++id) {
+      uint8_t addr[6];
+      bench_addr(id, addr);
+      if (cm_estimate(&s_bench, sketch_hash(bench_kind(id), addr)) < t.count[id]) undercount++;
+    }
+    for (uint8_t i = 0; i < s_bench.top_count; ++i) {
+      const uint8_t* a = s_bench.top[i].addr;
+      const uint32_t id = (static_cast<uint32_t>(a[2]) << 24) | (static_cast<uint32_t>(a[3]) << 16) |
+                          (static_cast<uint32_t>(a[4]) << 8) | a[5];
+      if (id < t.next_id && t.count[id] + slack < heavy && s_bench.top[i].count >= heavy) false_listed++;
+    }
+    Serial.printf("[NETSEC:SKETCH]   heavy hitters (>= %u %%): %lu of %lu listed, %lu false; count-min over by %lu at most (bound %lu), %lu under, %lu halvings, %lu histogram drops\n",
+                  NETSEC_SKETCH_BENCH_HEAVY_PCT, static_cast<unsigned long>(heavy_listed),
+                  static_cast<unsigned long>(heavy_total), static_cast<unsigned long>(false_listed),
+                  static_cast<unsigned long>(worst_over), static_cast<unsigned long>(slack),
+                  static_cast<unsigned long>(undercount), static_cast<unsigned long>(s_bench.halvings),
+                  static_cast<unsigned long>(s_bench.eh_dropped));
+
+    // Throughput: random addresses, clock moving 1 ms every 8 reports
+    memset(&s_bench, 0, sizeof(s_bench));
+    uint8_t addr[6] = { 0xC2, 0x5A, 0, 0, 0, 0 };
+    int64_t start = bench_clock_us();
+    for (uint32_t i = 0; i < NETSEC_SKETCH_BENCH_UPDATES; ++i) {
+      const uint32_t r = bench_rand(&t);
+      memcpy(&addr[2], &r, 4);
+      sketch_add(&s_bench, static_cast<netsec_sketch_kind_t>(i & 1), addr, i / 8);
+    }
+    const uint32_t update_us = static_cast<uint32_t>(bench_clock_us() - start);
+    start = bench_clock_us();
+    uint32_t sink = 0;
+    for (uint32_t i = 0; i < 1000; ++i) {
+      sink += sketch_unique(&s_bench, NULL, NETSEC_SKETCH_BLE, NETSEC_SKETCH_SLOTS * NETSEC_SKETCH_SLOT_S,
+                            NETSEC_SKETCH_BENCH_UPDATES / 8);
+    }
+    const uint32_t query_us = static_cast<uint32_t>(bench_clock_us() - start);
+    Serial.printf("[NETSEC:SKETCH]   %lu updates in %lu us: %lu updates/s; 1 h distinct query %lu.%02lu us (%lu)\n",
+                  static_cast<unsigned long>(NETSEC_SKETCH_BENCH_UPDATES), static_cast<unsigned long>(update_us),
+                  static_cast<unsigned long>(update_us ? static_cast<uint64_t>(NETSEC_SKETCH_BENCH_UPDATES) * 1000000u / update_us : 0),
+                  static_cast<unsigned long>(query_us / 1000), static_cast<unsigned long>(query_us / 10 % 100),
+                  static_cast<unsigned long>(sink / 1000));
+  }
+
+  free(t.count);
+  free(t.last_slot);
+  free(t.active);
+  free(t.per_second[0]);
+  free(t.per_second[1]);
+}
@@ -0,0 +1,535 @@
+/*
+ * NETSEC - Unattended survey
+ *
+ * Observations from the WiFi and BLE result paths are staged in RAM during
+ * a sweep (deduplicated, spinlock) and folded into the RTC table by the
+ * survey task once the sweep is over: the RTC copy and its CRC only change
+ * between sweeps, so a reset mid-sweep loses that sweep and nothing else.
+ */
+
+#include "netsec_survey.h"
+#include "netsec_ble.h"
+#include "netsec_wifi.h"
+#include "display_driver.h"
+#include "storage_fs.h"
+#include "system_init.h"
+#include "deferred_log.h"
+#include "sysmon.h"
+#include "cpuprof.h"
+#include "rtos_static.h"
+#include <Arduino.h>
+#include <atomic>
+#include <stddef.h>
+#include <string.h>
+#include <esp_attr.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#if defined(ARDUINO_ARCH_ESP32)
+#include <WiFi.h>
+#include <esp_sleep.h>
+#endif
+
+#define NETSEC_SURVEY_RTC_MAGIC     (0x53525643u ^ static_cast<uint32_t>(sizeof(netsec_survey_rtc_t)))
+#define NETSEC_SURVEY_TOUCH_IRQ_PIN GPIO_NUM_36
+#define NETSEC_SURVEY_SWEEP_POLL_MS 100
+
+// Everything a reset must not lose. Counters are since the survey started.
+typedef struct {
+  uint32_t magic;
+  uint32_t crc;               // Over the bytes after this field
+  uint32_t active;
+  uint32_t period_s;
+  uint32_t clock_s;           // Survey clock at the last commit
+  uint32_t window_start_s;
+  uint32_t window_sweeps;
+  uint32_t cycles;
+  uint32_t awake_ms;
+  uint32_t awake_max_ms;
+  uint32_t asleep_ms;
+  uint32_t overflow;
+  uint32_t window_overflow;
+  uint32_t staged_dropped;
+  uint32_t batches;
+  uint32_t flush_failed;
+  uint32_t file_bytes;
+  uint32_t resumed;
+  uint16_t entries_peak;
+  uint16_t count;
+  netsec_survey_entry_t entries[NETSEC_SURVEY_MAX_ENTRIES];
+} netsec_survey_rtc_t;
+
+static_assert(sizeof(netsec_survey_rtc_t) <= NETSEC_SURVEY_RTC_BUDGET, "survey summary exceeds its RTC budget");
+static_assert(sizeof(netsec_survey_entry_t) == 20, "survey file format changed");
+static_assert(sizeof(netsec_survey_batch_t) == 24, "survey file format changed");
+
+typedef struct {
+  uint8_t addr[6];
+  uint8_t kind;
+  int8_t best_rssi;
+} netsec_survey_obs_t;
+
+static RTC_NOINIT_ATTR netsec_survey_rtc_t s_rtc;
+
+// Sweep staging, filled from the WiFi event task and the BLE worker
+static portMUX_TYPE s_stage_lock = portMUX_INITIALIZER_UNLOCKED;
+static netsec_survey_obs_t s_stage[NETSEC_SURVEY_SWEEP_MAX];
+static uint16_t s_stage_count = 0;
+static uint32_t s_stage_dropped = 0;
+static std::atomic<bool> s_sweeping(false);
+
+static std::atomic<bool> s_active(false);
+static std::atomic<bool> s_stop_requested(false);
+static std::atomic<uint32_t> s_cycle_limit(0);   // 0: until stopped (benchmark only)
+static uint32_t s_clock_base_s = 0;               // Survey clock at s_clock_ref_us
+static int64_t s_clock_ref_us = 0;
+
+static TaskHandle_t s_survey_task = nullptr;
+static StaticTask_t s_survey_tcb;
+static StackType_t s_survey_stack[NETSEC_SURVEY_TASK_STACK_SIZE / sizeof(StackType_t)];
+
+// CRC-32 (IEEE, reflected), one nibble at a time: 64-byte table
+static const uint32_t k_crc_nibble[16] = {
+  0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+  0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+static uint32_t survey_crc(void)
+{
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(&s_rtc.crc) + sizeof(s_rtc.crc);
+  const uint32_t len = sizeof(s_rtc) - offsetof(netsec_survey_rtc_t, crc) - sizeof(s_rtc.crc);
+  uint32_t crc = 0xFFFFFFFFu;
+  for (uint32_t i = 0; i < len; ++i) {
+    crc ^= data[i];
+    crc = (crc >> 4) ^ k_crc_nibble[crc & 0x0F];
+    crc = (crc >> 4) ^ k_crc_nibble[crc & 0x0F];
+  }
+  return ~crc;
+}
+
+static bool survey_rtc_valid(void)
+{
+  return s_rtc.magic == NETSEC_SURVEY_RTC_MAGIC && s_rtc.count <= NETSEC_SURVEY_MAX_ENTRIES &&
+         s_rtc.crc == survey_crc();
+}
+
+static uint32_t survey_clock_s(void)
+{
+  return s_clock_base_s + static_cast<uint32_t>((esp_timer_get_time() - s_clock_ref_us) / 1000000);
+}
+
+static void survey_commit(void)
+{
+  s_rtc.clock_s = survey_clock_s();
+  s_rtc.magic = NETSEC_SURVEY_RTC_MAGIC;
+  s_rtc.crc = survey_crc();
+}
+
+static void survey_count_kinds(uint16_t* wifi, uint16_t* ble)
+{
+  *wifi = 0;
+  *ble = 0;
+  for (uint16_t i = 0; i < s_rtc.count; ++i) {
+    if (s_rtc.entries[i].kind == NETSEC_SURVEY_WIFI) {
+      (*wifi)++;
+    } else {
+      (*ble)++;
+    }
+  }
+}
+
+void netsec_survey_observe(netsec_survey_kind_t kind, const uint8_t* addr, int rssi)
+{
+  if (!addr || !s_sweeping.load(std::memory_order_relaxed)) return;
+  const int8_t r = static_cast<int8_t>(rssi < -128 ? -128 : (rssi > 127 ? 127 : rssi));
+
+  portENTER_CRITICAL(&s_stage_lock);
+  uint16_t i = 0;
+  for (; i < s_stage_count; ++i) {
+    netsec_survey_obs_t* o = &s_stage[i];
+    if (o->kind == kind && memcmp(o->addr, addr, 6) == 0) {
+      if (r > o->best_rssi) o->best_rssi = r;
+      break;
+    }
+  }
+  if (i == s_stage_count) {
+    if (s_stage_count < NETSEC_SURVEY_SWEEP_MAX) {
+      netsec_survey_obs_t* o = &s_stage[s_stage_count++];
+      memcpy(o->addr, addr, 6);
+      o->kind = static_cast<uint8_t>(kind);
+      o->best_rssi = r;
+    } else {
+      s_stage_dropped++;
+    }
+  }
+  portEXIT_CRITICAL(&s_stage_lock);
+}
+
+#if defined(ARDUINO_ARCH_ESP32)
+// Both scans together; results come back through netsec_survey_observe()
+static void survey_sweep(void)
+{
+  portENTER_CRITICAL(&s_stage_lock);
+  s_stage_count = 0;
+  s_stage_dropped = 0;
+  portEXIT_CRITICAL(&s_stage_lock);
+  s_sweeping.store(true, std::memory_order_relaxed);
+
+  netsec_wifi_start_scan();
+  netsec_ble_start_scan(NETSEC_SURVEY_BLE_MS);
+  const uint32_t start_ms = millis();
+  while ((netsec_wifi_is_scanning() || netsec_ble_is_scanning()) &&
+         millis() - start_ms < NETSEC_SURVEY_SWEEP_TIMEOUT_MS) {
+    cpuprof_note_wake();
+    vTaskDelay(pdMS_TO_TICKS(NETSEC_SURVEY_SWEEP_POLL_MS));
+  }
+  if (netsec_ble_is_scanning()) {
+    netsec_ble_stop_scan();
+  }
+  s_sweeping.store(false, std::memory_order_relaxed);
+}
+
+static void survey_fold(void)
+{
+  const uint32_t now_s = survey_clock_s();
+  uint32_t new_overflow = 0;
+
+  // The sweep is over: a late report can only touch entries past `staged`
+  portENTER_CRITICAL(&s_stage_lock);
+  const uint16_t staged = s_stage_count;
+  const uint32_t dropped = s_stage_dropped;
+  portEXIT_CRITICAL(&s_stage_lock);
+
+  for (uint16_t i = 0; i < staged; ++i) {
+    const netsec_survey_obs_t* o = &s_stage[i];
+    netsec_survey_entry_t* e = nullptr;
+    for (uint16_t j = 0; j < s_rtc.count; ++j) {
+      if (s_rtc.entries[j].kind == o->kind && memcmp(s_rtc.entries[j].addr, o->addr, 6) == 0) {
+        e = &s_rtc.entries[j];
+        break;
+      }
+    }
+    if (e) {
+      e->last_s = now_s;
+      if (o->best_rssi > e->best_rssi) e->best_rssi = o->best_rssi;
+      if (e->sweeps < UINT16_MAX) e->sweeps++;
+    } else if (s_rtc.count < NETSEC_SURVEY_MAX_ENTRIES) {
+      e = &s_rtc.entries[s_rtc.count++];
+      memcpy(e->addr, o->addr, 6);
+      e->kind = o->kind;
+      e->best_rssi = o->best_rssi;
+      e->first_s = now_s;
+      e->last_s = now_s;
+      e->sweeps = 1;
+      e->reserved = 0;
+    } else {
+      new_overflow++;
+    }
+  }
+  s_rtc.overflow += new_overflow;
+  s_rtc.window_overflow += new_overflow;
+  s_rtc.staged_dropped += dropped;
+  s_rtc.window_sweeps++;
+  if (s_rtc.count > s_rtc.entries_peak) s_rtc.entries_peak = s_rtc.count;
+}
+
+// Append the window as one batch and start a new one (kept if the write fails)
+static void survey_flush(void)
+{
+  if (s_rtc.window_sweeps == 0) return;
+
+  netsec_survey_batch_t batch;
+  batch.magic = NETSEC_SURVEY_BATCH_MAGIC;
+  batch.start_s = s_rtc.window_start_s;
+  batch.end_s = survey_clock_s();
+  batch.sweeps = s_rtc.window_sweeps;
+  batch.entries = s_rtc.count;
+  survey_count_kinds(&batch.wifi_unique, &batch.ble_unique);
+  batch.overflow = static_cast<uint16_t>(s_rtc.window_overflow > UINT16_MAX ? UINT16_MAX : s_rtc.window_overflow);
+  const size_t entries_bytes = s_rtc.count * sizeof(netsec_survey_entry_t);
+
+  storage_fs_stats_t fs;
+  storage_fs_get_stats(&fs);
+  bool ok = false;
+  if (fs.mounted) {
+    fs::FS& vol = storage_fs();
+    File f = vol.open(NETSEC_SURVEY_FILE, "a");
+    if (f) {
+      ok = f.write(reinterpret_cast<const uint8_t*>(&batch), sizeof(batch)) == sizeof(batch) &&
+           f.write(reinterpret_cast<const uint8_t*>(s_rtc.entries), entries_bytes) == entries_bytes;
+      const size_t size = f.size();
+      f.close();
+      if (ok && size >= NETSEC_SURVEY_FILE_MAX) {
+        vol.remove(NETSEC_SURVEY_FILE_OLD);
+        vol.rename(NETSEC_SURVEY_FILE, NETSEC_SURVEY_FILE_OLD);
+      }
+    }
+  }
+  if (!ok) {
+    s_rtc.flush_failed++;
+    Serial.println("[ERROR] Survey: cannot append " NETSEC_SURVEY_FILE);
+    return;
+  }
+
+  s_rtc.batches++;
+  s_rtc.file_bytes += sizeof(batch) + entries_bytes;
+  DLOG_I("[NETSEC:SURVEY] Batch %lu: %u entries (%u WiFi, %u BLE) over %lu sweeps",
+         s_rtc.batches, batch.entries, batch.wifi_unique, batch.ble_unique, batch.sweeps);
+  s_rtc.count = 0;
+  s_rtc.window_sweeps = 0;
+  s_rtc.window_overflow = 0;
+  s_rtc.window_start_s = batch.end_s;
+}
+
+static void survey_radios_off(void)
+{
+  WiFi.mode(WIFI_OFF);
+  if (!netsec_ble_power_down(1000)) {
+    Serial.println("[ERROR] Survey: BLE controller still up");
+  }
+}
+
+// Light sleep until the next period or a touch; returns true on touch
+static bool survey_sleep(uint32_t sleep_ms)
+{
+  dlog_flush();
+  Serial.flush();   // The UART stops with the clocks
+  esp_sleep_enable_timer_wakeup(static_cast<uint64_t>(sleep_ms) * 1000u);
+  esp_sleep_enable_ext0_wakeup(NETSEC_SURVEY_TOUCH_IRQ_PIN, 0);
+  const int64_t t0 = esp_timer_get_time();
+  esp_light_sleep_start();
+  s_rtc.asleep_ms += static_cast<uint32_t>((esp_timer_get_time() - t0) / 1000);
+  return esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_EXT0;
+}
+
+static void survey_enter(void)
+{
+  display_hw_set_backlight(false);
+  uint16_t wifi, ble;
+  survey_count_kinds(&wifi, &ble);
+  DLOG_I("[NETSEC:SURVEY] Survey every %lu s, window %u WiFi + %u BLE, %lu cycles so far",
+         s_rtc.period_s, wifi, ble, s_rtc.cycles);
+}
+
+static void survey_leave(bool touched)
+{
+  survey_flush();
+  s_rtc.active = 0;
+  survey_commit();
+  s_active.store(false, std::memory_order_release);
+  WiFi.mode(WIFI_STA);
+  display_hw_set_backlight(true);
+  DLOG_I("[NETSEC:SURVEY] Survey stopped (%s) after %lu cycles, %lu batches",
+         touched ? "touch" : "request", s_rtc.cycles, s_rtc.batches);
+}
+
+static void survey_task(void* pvParameters)
+{
+  (void)pvParameters;
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    // Resumed at boot: let the UI come up first, it is paused right after
+    xEventGroupWaitBits(system_boot_events(), BOOT_EVT_INTERACTIVE, pdFALSE, pdTRUE,
+                        pdMS_TO_TICKS(BOOT_INTERACTIVE_TIMEOUT_MS));
+    survey_enter();
+
+    bool touched = false;
+    uint32_t cycles_run = 0;
+    while (!s_stop_requested.load(std::memory_order_acquire)) {
+      const int64_t wake_us = esp_timer_get_time();
+      cpuprof_note_wake();
+      survey_sweep();
+      survey_fold();
+      if (s_rtc.window_sweeps >= NETSEC_SURVEY_FLUSH_SWEEPS ||
+          s_rtc.count >= NETSEC_SURVEY_MAX_ENTRIES * 3 / 4) {
+        survey_flush();
+      }
+      survey_radios_off();
+
+      const uint32_t awake_ms = static_cast<uint32_t>((esp_timer_get_time() - wake_us) / 1000);
+      s_rtc.cycles++;
+      s_rtc.awake_ms += awake_ms;
+      if (awake_ms > s_rtc.awake_max_ms) s_rtc.awake_max_ms = awake_ms;
+      survey_commit();
+
+      const uint32_t limit = s_cycle_limit.load(std::memory_order_relaxed);
+      if ((limit && ++cycles_run >= limit) || s_stop_requested.load(std::memory_order_acquire)) break;
+
+      const uint32_t period_ms = s_rtc.period_s * 1000u;
+      if (survey_sleep(period_ms > awake_ms ? period_ms - awake_ms : 1)) {
+        touched = true;
+        break;
+      }
+      survey_commit();
+    }
+    survey_leave(touched);
+  }
+}
+#endif
+
+void netsec_survey_init(void)
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  if (s_survey_task) return;
+  s_survey_task = rtos_static_task(survey_task, "survey", NETSEC_SURVEY_TASK_STACK_SIZE, nullptr, 1,
+                                   s_survey_stack, &s_survey_tcb, 0);
+  if (!s_survey_task) {
+    Serial.println("[ERROR] Failed to create survey task!");
+    return;
+  }
+  sysmon_register_task(s_survey_task, "survey", NETSEC_SURVEY_TASK_STACK_SIZE);
+
+  s_clock_ref_us = esp_timer_get_time();
+  if (!survey_rtc_valid()) {
+    memset(&s_rtc, 0, sizeof(s_rtc));   // Power-on: RTC memory holds noise
+    return;
+  }
+  s_clock_base_s = s_rtc.clock_s;
+  if (s_rtc.active) {
+    s_rtc.resumed++;
+    survey_commit();
+    Serial.printf("[NETSEC:SURVEY] Resuming survey: %u entries, %lu cycles\n", s_rtc.count,
+                  static_cast<unsigned long>(s_rtc.cycles));
+    s_active.store(true, std::memory_order_release);
+    xTaskNotifyGive(s_survey_task);
+  }
+#endif
+}
+
+bool netsec_survey_start(uint32_t period_s)
+{
+#if defined(ARDUINO_ARCH_ESP32)
+  if (!s_survey_task) {
+    Serial.println("[ERROR] Survey task not started");
+    return false;
+  }
+  bool expected = false;
+  if (!s_active.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+    return false;   // Already surveying
+  }
+  s_stop_requested.store(false, std::memory_order_release);
+
+  // New survey: clock, window and counters from zero
+  memset(&s_rtc, 0, sizeof(s_rtc));
+  s_clock_base_s = 0;
+  s_clock_ref_us = esp_timer_get_time();
+  s_rtc.active = 1;
+  s_rtc.period_s = period_s ? period_s : NETSEC_SURVEY_PERIOD_S;
+  survey_commit();
+  xTaskNotifyGive(s_survey_task);
+  return true;
+#else
+  (void)period_s;
+  Serial.println("[NETSEC:SURVEY] Survey not supported on this platform (mock)");
+  return false;
+#endif
+}
+
+void netsec_survey_stop(void)
+{
+  if (s_active.load(std::memory_order_acquire)) {
+    s_stop_requested.store(true, std::memory_order_release);
+  }
+}
+
+bool netsec_survey_is_active(void)
+{
+  return s_active.load(std::memory_order_acquire);
+}
+
+void netsec_survey_get_stats(netsec_survey_stats_t* out)
+{
+  if (!out) return;
+  memset(out, 0, sizeof(*out));
+  // Counters move between sweeps only: a torn read is off by one sweep at worst
+  out->active = s_active.load(std::memory_order_acquire);
+  out->period_s = s_rtc.period_s;
+  out->clock_s = out->active ? survey_clock_s() : s_rtc.clock_s;
+  out->cycles = s_rtc.cycles;
+  out->awake_ms = s_rtc.awake_ms;
+  out->awake_max_ms = s_rtc.awake_max_ms;
+  out->asleep_ms = s_rtc.asleep_ms;
+  out->entries = s_rtc.count;
+  out->entries_peak = s_rtc.entries_peak;
+  survey_count_kinds(&out->wifi_unique, &out->ble_unique);
+  out->overflow = s_rtc.overflow;
+  out->staged_dropped = s_rtc.staged_dropped;
+  out->batches = s_rtc.batches;
+  out->flush_failed = s_rtc.flush_failed;
+  out->file_bytes = s_rtc.file_bytes;
+  out->resumed = s_rtc.resumed;
+}
+
+#if defined(ARDUINO_ARCH_ESP32) && defined(NETSEC_SURVEY_RUN_BENCHMARK)
+#ifndef NETSEC_SURVEY_BENCH_CYCLES
+#define NETSEC_SURVEY_BENCH_CYCLES  288     // One day at the default period
+#endif
+// Board draw for the battery estimate: radios on, and light sleep with the
+// backlight off (LDO, USB-UART and LED quiescent current included)
+#ifndef NETSEC_SURVEY_AWAKE_MA
+#define NETSEC_SURVEY_AWAKE_MA      130
+#endif
+#ifndef NETSEC_SURVEY_SLEEP_MA
+#define NETSEC_SURVEY_SLEEP_MA      4
+#endif
+#ifndef NETSEC_SURVEY_BATTERY_MAH
+#define NETSEC_SURVEY_BATTERY_MAH   2000
+#endif
+
+static uint32_t survey_file_size(const char* path)
+{
+  fs::FS& vol = storage_fs();
+  if (!vol.exists(path)) return 0;
+  File f = vol.open(path, "r");
+  const uint32_t size = f ? static_cast<uint32_t>(f.size()) : 0;
+  f.close();
+  return size;
+}
+
+void netsec_survey_run_benchmark(void)
+{
+  if (!s_survey_task) return;
+  const uint32_t file_before = survey_file_size(NETSEC_SURVEY_FILE) + survey_file_size(NETSEC_SURVEY_FILE_OLD);
+
+  Serial.printf("[NETSEC:SURVEY] Benchmark: %u cycles of %u s, RTC summary %u B of %u\n",
+                NETSEC_SURVEY_BENCH_CYCLES, NETSEC_SURVEY_PERIOD_S,
+                static_cast<unsigned>(sizeof(netsec_survey_rtc_t)), NETSEC_SURVEY_RTC_BUDGET);
+  s_cycle_limit.store(NETSEC_SURVEY_BENCH_CYCLES, std::memory_order_relaxed);
+  if (!netsec_survey_start(NETSEC_SURVEY_PERIOD_S)) {
+    Serial.println("[ERROR] Survey benchmark: survey already running");
+    return;
+  }
+  while (netsec_survey_is_active()) {
+    vTaskDelay(pdMS_TO_TICKS(1000));
+  }
+  s_cycle_limit.store(0, std::memory_order_relaxed);
+
+  netsec_survey_stats_t st;
+  netsec_survey_get_stats(&st);
+  const uint32_t file_after = survey_file_size(NETSEC_SURVEY_FILE) + survey_file_size(NETSEC_SURVEY_FILE_OLD);
+  const uint32_t cycles = st.cycles ? st.cycles : 1;
+  const uint32_t total_ms = st.awake_ms + st.asleep_ms;
+  const uint32_t duty_x10 = total_ms ? static_cast<uint32_t>(static_cast<uint64_t>(st.awake_ms) * 1000 / total_ms) : 0;
+  // Average current in uA, then hours on the battery
+  const uint32_t avg_ua = total_ms ? static_cast<uint32_t>(
+      (static_cast<uint64_t>(st.awake_ms) * NETSEC_SURVEY_AWAKE_MA +
+       static_cast<uint64_t>(st.asleep_ms) * NETSEC_SURVEY_SLEEP_MA) * 1000 / total_ms) : 0;
+  const uint32_t hours = avg_ua ? static_cast<uint32_t>(static_cast<uint64_t>(NETSEC_SURVEY_BATTERY_MAH) * 1000 / avg_ua) : 0;
+
+  Serial.printf("[NETSEC:SURVEY] %lu cycles: awake avg %lu ms max %lu ms, asleep %lu s, duty %lu.%lu%%\n",
+                static_cast<unsigned long>(st.cycles), static_cast<unsigned long>(st.awake_ms / cycles),
+                static_cast<unsigned long>(st.awake_max_ms), static_cast<unsigned long>(st.asleep_ms / 1000),
+                static_cast<unsigned long>(duty_x10 / 10), static_cast<unsigned long>(duty_x10 % 10));
+  Serial.printf("[NETSEC:SURVEY] Table peak %u/%u, overflow %lu, staging drops %lu; %lu batches, %lu B to flash (file grew %ld B), %lu failed\n",
+                st.entries_peak, NETSEC_SURVEY_MAX_ENTRIES, static_cast<unsigned long>(st.overflow),
+                static_cast<unsigned long>(st.staged_dropped), static_cast<unsigned long>(st.batches),
+                static_cast<unsigned long>(st.file_bytes),
+                static_cast<long>(file_after) - static_cast<long>(file_before),
+                static_cast<unsigned long>(st.flush_failed));
+  Serial.printf("[NETSEC:SURVEY] At %u mA awake / %u mA asleep: %lu.%02lu mA average, %lu h (%lu days) on %u mAh\n",
+                NETSEC_SURVEY_AWAKE_MA, NETSEC_SURVEY_SLEEP_MA,
+                static_cast<unsigned long>(avg_ua / 1000), static_cast<unsigned long>(avg_ua % 1000 / 10),
+                static_cast<unsigned long>(hours), static_cast<unsigned long>(hours / 24), NETSEC_SURVEY_BATTERY_MAH);
+}
+#endif
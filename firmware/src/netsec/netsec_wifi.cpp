@@ -1,5 +1,12 @@
 #include "netsec_wifi.h"
 #include "netsec_api.h"
+#include "netsec_survey.h"
+#include "netsec_sketch.h"
+#include "netsec_known.h"
+#include "netsec_registry.h"
+#include "serial_export.h"
+#include "deferred_log.h"
+#include "sysmon.h"
 #include <Arduino.h>
 
 #ifdef ESP8266
@@ -18,6 +25,7 @@ static void on_wifi_scan_done(WiFiEvent_t event, WiFiEventInfo_t info);
 static volatile bool wifi_scan_in_progress = false;
 static uint32_t s_wifi_scan_start_ms = 0;
 static uint16_t s_wifi_result_count = 0;
+static bool s_wifi_handler_registered = false;
 
 void netsec_wifi_start_scan(void)
 {
@@ -30,7 +38,11 @@ void netsec_wifi_start_scan(void)
   s_wifi_result_count = 0;
   s_wifi_scan_start_ms = millis();
 #if defined(ARDUINO_ARCH_ESP32)
-  WiFi.onEvent(on_wifi_scan_done, ARDUINO_EVENT_WIFI_SCAN_DONE);
+  // Once: every onEvent() adds a handler, a survey scans a few hundred times a day
+  if (!s_wifi_handler_registered) {
+    WiFi.onEvent(on_wifi_scan_done, ARDUINO_EVENT_WIFI_SCAN_DONE);
+    s_wifi_handler_registered = true;
+  }
   WiFi.scanNetworks(true, true);
 #else
   WiFi.scanNetworks();
@@ -44,24 +56,37 @@ void netsec_wifi_stop_scan(void)
   // ESP32 does not provide a direct stop for async scan; rely on scan completion
 }
 
+bool netsec_wifi_is_scanning(void)
+{
+  return wifi_scan_in_progress;
+}
+
 void netsec_wifi_post_ap(const char* ssid, int32_t rssi, uint8_t channel, const uint8_t* bssid)
 {
   extern QueueHandle_t netsec_result_queue;
   if (!netsec_result_queue) return;
 
-  netsec_result_t res;
-  memset(&res, 0, sizeof(res));
-  res.type = NETSEC_RES_WIFI_AP;
-  strncpy(res.data.wifi_ap.ssid, ssid, sizeof(res.data.wifi_ap.ssid)-1);
-  res.data.wifi_ap.rssi = rssi;
-  res.data.wifi_ap.channel = channel;
-  if (bssid) memcpy(res.data.wifi_ap.bssid, bssid, 6);
+  netsec_wifi_ap_t ap;
+  memset(&ap, 0, sizeof(ap));
+  strncpy(ap.ssid, ssid, sizeof(ap.ssid)-1);
+  ap.rssi = rssi;
+  ap.channel = channel;
+  if (bssid) memcpy(ap.bssid, bssid, 6);
+  netsec_survey_observe(NETSEC_SURVEY_WIFI, bssid, rssi);
+  netsec_sketch_observe(NETSEC_SKETCH_WIFI, bssid);
+  if (bssid && netsec_known_check(NETSEC_KNOWN_WIFI, bssid, false)) {
+    ap.flags |= NETSEC_WIFI_FLAG_NEW;
+  }
 
   if (s_wifi_result_count < UINT16_MAX) {
     ++s_wifi_result_count;
   }
 
-  xQueueSend(netsec_result_queue, &res, 0);
+  serial_export_wifi_ap(&ap);
+  // The UI gets what changed (netsec_registry.h), not every report
+  if (bssid) {
+    netsec_registry_report(NETSEC_DEVICE_WIFI, bssid, ap.rssi, ap.ssid, ap.channel, ap.flags);
+  }
 }
 
 // Callback: called when scan is done
@@ -69,7 +94,7 @@ void netsec_wifi_post_ap(const char* ssid, int32_t rssi, uint8_t channel, const
 static void on_wifi_scan_done(WiFiEvent_t event, WiFiEventInfo_t info)
 {
   uint32_t elapsed_ms = s_wifi_scan_start_ms ? (millis() - s_wifi_scan_start_ms) : 0;
-  Serial.printf("[NETSEC:WIFI] Scan done in %lu ms, posting results\n", static_cast<unsigned long>(elapsed_ms));
+  DLOG_I("[NETSEC:WIFI] Scan done in %lu ms, posting results", elapsed_ms);
   int n = WiFi.scanComplete();
   for (int i = 0; i < n; ++i) {
     netsec_wifi_post_ap(
@@ -79,6 +104,8 @@ static void on_wifi_scan_done(WiFiEvent_t event, WiFiEventInfo_t info)
       WiFi.BSSID(i)
     );
   }
+  netsec_sketch_log();
+  netsec_registry_scan_done(NETSEC_DEVICE_WIFI);
   // Post scan done event
   extern QueueHandle_t netsec_result_queue;
   if (netsec_result_queue) {
@@ -86,7 +113,8 @@ static void on_wifi_scan_done(WiFiEvent_t event, WiFiEventInfo_t info)
     done_evt.data.scan_summary.item_count = static_cast<uint16_t>(n);
     done_evt.data.scan_summary.duration_ms = elapsed_ms;
     done_evt.data.scan_summary.timestamp_ms = millis();
-    xQueueSend(netsec_result_queue, &done_evt, 0);
+    serial_export_scan_summary(NETSEC_RES_WIFI_SCAN_DONE, &done_evt.data.scan_summary);
+    sysmon_queue_send(SYSMON_QUEUE_NETSEC_RESULT, &done_evt, 0);
   }
   WiFi.scanDelete();
   wifi_scan_in_progress = false;
@@ -10,13 +10,18 @@
 #include "netsec_api.h"
 #include "netsec_wifi.h"
 #include "netsec_ble.h"
+#include "netsec_survey.h"
+#include "netsec_known.h"
 #include "board_config.h"
+#include "cpuprof.h"
 
 static QueueHandle_t local_result_queue = NULL;
 
 void netsec_init(QueueHandle_t result_queue) {
     Serial.println("[NETSEC] Network security module initialized");
     local_result_queue = result_queue;
+    netsec_ble_init();
+    netsec_survey_init();
     // Early init for WiFi stack if needed
 #if defined(ARDUINO_ARCH_ESP32)
     // Ensure WiFi is in STA mode for scanning
@@ -66,6 +71,7 @@ void netsec_task(void* pvParameters) {
     Serial.println("[NETSEC] Task started");
     netsec_command_t cmd;
     for (;;) {
+        cpuprof_note_wake();
         if (xQueueReceive(netsec_command_queue, &cmd, pdMS_TO_TICKS(1000)) == pdTRUE) {
             switch (cmd.type) {
                 case NETSEC_CMD_WIFI_SCAN_START:
@@ -88,11 +94,21 @@ void netsec_task(void* pvParameters) {
                         Serial.println("[NETSEC] BLE scan stop requested but no scan active");
                     }
                     break;
+                case NETSEC_CMD_SURVEY_START:
+                    if (!netsec_survey_start(0)) {
+                        Serial.println("[NETSEC] Survey already running");
+                    }
+                    break;
+                case NETSEC_CMD_SURVEY_STOP:
+                    netsec_survey_stop();
+                    break;
                 default:
                     Serial.printf("[NETSEC] Unknown command %u\n", cmd.type);
                     break;
             }
         }
+        // Known devices file: load once mounted, rotate, checkpoint
+        netsec_known_poll();
         // Periodically could check scan results and post to local_result_queue
         vTaskDelay(pdMS_TO_TICKS(50));
     }
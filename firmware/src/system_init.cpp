@@ -8,12 +8,41 @@
 #include "board_config.h"
 #include "ui_api.h"
 #include "netsec_api.h"
+#include "netsec/netsec_ble.h"
+#include "netsec/netsec_survey.h"
+#include "netsec/netsec_sketch.h"
+#include "netsec/netsec_known.h"
+#include "netsec/netsec_registry.h"
+#include "serial_export.h"
+#include "deferred_log.h"
+#include "persist.h"
+#include "asset_map.h"
+#include "sysmon.h"
+#include "boot_profiler.h"
+#include "lvgl_port.h"
+#include "rtos_static.h"
 
 // Global queue handles for inter-task communication
 QueueHandle_t ui_event_queue = NULL;
 QueueHandle_t netsec_command_queue = NULL;
 QueueHandle_t netsec_result_queue = NULL;
 
+static EventGroupHandle_t s_boot_events = NULL;
+
+// Backing store of the objects above and of the long-lived system tasks
+static StaticQueue_t s_ui_event_queue_cb;
+static StaticQueue_t s_netsec_command_queue_cb;
+static StaticQueue_t s_netsec_result_queue_cb;
+static uint8_t s_ui_event_items[UI_EVENT_QUEUE_LENGTH * sizeof(ui_event_t)];
+static uint8_t s_netsec_command_items[NETSEC_COMMAND_QUEUE_LENGTH * sizeof(netsec_command_t)];
+static uint8_t s_netsec_result_items[NETSEC_RESULT_QUEUE_LENGTH * sizeof(netsec_result_t)];
+static StaticEventGroup_t s_boot_events_cb;
+
+static StaticTask_t s_netsec_tcb;
+static StackType_t s_netsec_stack[NETSEC_TASK_STACK_SIZE / sizeof(StackType_t)];
+static StaticTask_t s_ui_tcb;
+static StackType_t s_ui_stack[UI_TASK_STACK_SIZE / sizeof(StackType_t)];
+
 // Forward declarations of task implementations (will be filled in later)
 // These are weak symbols to allow PIXEL and NETSEC to override if not yet implemented.
 extern void ui_task(void* pvParameters);
@@ -29,71 +58,172 @@ void archi_init_board(void) {
     Serial.println("[ARCHI] Board hardware OK");
 }
 
+EventGroupHandle_t system_boot_events(void) {
+    return s_boot_events;
+}
+
+static void start_netsec_task(void) {
+    Serial.println("[SYSTEM] Creating NETSEC task...");
+    TaskHandle_t netsec_handle = rtos_static_task(
+        netsec_task,
+        "NETSEC",
+        NETSEC_TASK_STACK_SIZE,
+        NULL,
+        NETSEC_TASK_PRIORITY,
+        s_netsec_stack,
+        &s_netsec_tcb,
+        0  // Core 0
+    );
+    
+    if (!netsec_handle) {
+        Serial.println("[ERROR] Failed to create NETSEC task!");
+        return;
+    }
+    sysmon_register_task(netsec_handle, "NETSEC", NETSEC_TASK_STACK_SIZE);
+}
+
+/**
+ * Deferred init on core 0, while the UI task paints the splash on core 1.
+ * Order matters: the main screen waits for SPIFFS (wallpapers), scans wait
+ * for NETSEC, and the directory listing is diagnostics only.
+ */
+static void boot_task(void* pvParameters) {
+    (void)pvParameters;
+    sysmon_register_task(xTaskGetCurrentTaskHandle(), "boot", BOOT_TASK_STACK_SIZE);
+
+    int stage = boot_prof_begin("spiffs_mount");
+    lvgl_port_mount_fs();
+    boot_prof_end(stage);
+    xEventGroupSetBits(s_boot_events, BOOT_EVT_FS_READY);
+
+    // WiFi.mode() brings up the whole WiFi stack: the slowest step of boot
+    stage = boot_prof_begin("netsec_init");
+    netsec_init(netsec_result_queue);
+    start_netsec_task();
+    boot_prof_end(stage);
+    xEventGroupSetBits(s_boot_events, BOOT_EVT_NETSEC_READY);
+
+    stage = boot_prof_begin("spiffs_walk");
+    lvgl_port_log_fs();
+    boot_prof_end(stage);
+
+    xEventGroupWaitBits(s_boot_events, BOOT_EVT_INTERACTIVE, pdFALSE, pdTRUE,
+                        pdMS_TO_TICKS(BOOT_INTERACTIVE_TIMEOUT_MS));
+    boot_prof_dump();
+    rtos_static_print_map();
+
+#ifdef DLOG_RUN_BENCHMARK
+    dlog_run_benchmark();
+#endif
+#ifdef RTOS_STATIC_RUN_BENCHMARK
+    rtos_static_run_benchmark();
+#endif
+#ifdef NETSEC_BLE_RUN_DUTY_BENCHMARK
+    netsec_ble_run_duty_benchmark();
+#endif
+#ifdef NETSEC_SURVEY_RUN_BENCHMARK
+    netsec_survey_run_benchmark();
+#endif
+#ifdef NETSEC_SKETCH_RUN_BENCHMARK
+    netsec_sketch_run_benchmark();
+#endif
+#ifdef NETSEC_KNOWN_RUN_BENCHMARK
+    netsec_known_run_benchmark();
+#endif
+#ifdef NETSEC_REGISTRY_RUN_BENCHMARK
+    netsec_registry_run_benchmark();
+#endif
+
+    sysmon_unregister_task(xTaskGetCurrentTaskHandle());
+    vTaskDelete(NULL);
+}
+
 /**
  * Main system initialization.
- * Creates FreeRTOS queues and starts UI and NETSEC tasks.
+ * Creates FreeRTOS queues, starts the UI task (display first) and hands the
+ * slow init steps to the boot task.
  * LVGL initialization is deferred to the UI task (via lvgl_port_init).
  */
 void system_init(void) {
+    int stage = boot_prof_begin("system_init");
     Serial.println("[SYSTEM] Initializing system...");
     
     // Initialize board hardware (GPIO, SPI, etc.)
     archi_init_board();
+
+    // Queue/stack/heap telemetry (first, so later tasks can register)
+    sysmon_init();
+
+    // Hot-path logging drains from its own low-priority task
+    dlog_init();
+
+    // Saved pet/settings: one 8 KB flash read, ready before the UI builds
+    int persist_stage = boot_prof_begin("persist_open");
+    persist_init();
+    boot_prof_end(persist_stage);
+
+    // Wallpapers straight from flash: map the asset bundle (no copy, no FS)
+    int assets_stage = boot_prof_begin("assets_map");
+    asset_map_init();
+    boot_prof_end(assets_stage);
+
+    // Binary telemetry stream (no-op unless SERIAL_EXPORT_ENABLED)
+    serial_export_init();
     
     // Create inter-task communication queues
     Serial.println("[SYSTEM] Creating queues...");
-    ui_event_queue = xQueueCreate(UI_EVENT_QUEUE_LENGTH, sizeof(ui_event_t));
-    netsec_command_queue = xQueueCreate(NETSEC_COMMAND_QUEUE_LENGTH, sizeof(netsec_command_t));
-    netsec_result_queue = xQueueCreate(NETSEC_RESULT_QUEUE_LENGTH, sizeof(netsec_result_t));
+    ui_event_queue = rtos_static_queue("ui_event", UI_EVENT_QUEUE_LENGTH, sizeof(ui_event_t),
+                                       s_ui_event_items, &s_ui_event_queue_cb);
+    netsec_command_queue = rtos_static_queue("net_cmd", NETSEC_COMMAND_QUEUE_LENGTH, sizeof(netsec_command_t),
+                                             s_netsec_command_items, &s_netsec_command_queue_cb);
+    netsec_result_queue = rtos_static_queue("net_res", NETSEC_RESULT_QUEUE_LENGTH, sizeof(netsec_result_t),
+                                            s_netsec_result_items, &s_netsec_result_queue_cb);
+    s_boot_events = rtos_static_event_group("boot_events", &s_boot_events_cb);
     
-    if (!ui_event_queue || !netsec_command_queue || !netsec_result_queue) {
+    if (!ui_event_queue || !netsec_command_queue || !netsec_result_queue || !s_boot_events) {
         Serial.println("[ERROR] Failed to create queues!");
         return;
     }
     
+    sysmon_register_queue(SYSMON_QUEUE_UI_EVENT, ui_event_queue, "ui_event", UI_EVENT_QUEUE_LENGTH);
+    sysmon_register_queue(SYSMON_QUEUE_NETSEC_COMMAND, netsec_command_queue, "net_cmd", NETSEC_COMMAND_QUEUE_LENGTH);
+    sysmon_register_queue(SYSMON_QUEUE_NETSEC_RESULT, netsec_result_queue, "net_res", NETSEC_RESULT_QUEUE_LENGTH);
     Serial.println("[SYSTEM] Queues created");
     
     // Initialize UI module (passes queue handle)
     ui_init(ui_event_queue);
     
-    // Initialize NETSEC module (passes result queue handle)
-    netsec_init(netsec_result_queue);
-    
+    // Background init first: it starts on core 0 right away, while the UI
+    // task below would otherwise hold core 1 until the splash is out.
+    // On the heap: it deletes itself once boot is done and its stack goes back
+    Serial.println("[SYSTEM] Creating boot task...");
+    if (xTaskCreatePinnedToCore(boot_task, "boot", BOOT_TASK_STACK_SIZE, NULL,
+                                BOOT_TASK_PRIORITY, NULL, 0) != pdPASS) {
+        Serial.println("[ERROR] Failed to create boot task!");
+        return;
+    }
+
     // Create UI task
     Serial.println("[SYSTEM] Creating UI task...");
-    BaseType_t ui_result = xTaskCreatePinnedToCore(
+    TaskHandle_t ui_handle = rtos_static_task(
         ui_task,
         "UI",
         UI_TASK_STACK_SIZE,
         NULL,
         UI_TASK_PRIORITY,
-        NULL,
+        s_ui_stack,
+        &s_ui_tcb,
         1  // Core 1 (other core for UI, core 0 for other tasks)
     );
     
-    if (ui_result != pdPASS) {
+    if (!ui_handle) {
         Serial.println("[ERROR] Failed to create UI task!");
         return;
     }
-    
-    // Create NETSEC task
-    Serial.println("[SYSTEM] Creating NETSEC task...");
-    BaseType_t netsec_result = xTaskCreatePinnedToCore(
-        netsec_task,
-        "NETSEC",
-        NETSEC_TASK_STACK_SIZE,
-        NULL,
-        NETSEC_TASK_PRIORITY,
-        NULL,
-        0  // Core 0
-    );
-    
-    if (netsec_result != pdPASS) {
-        Serial.println("[ERROR] Failed to create NETSEC task!");
-        return;
-    }
+    sysmon_register_task(ui_handle, "UI", UI_TASK_STACK_SIZE);
     
     Serial.println("[SYSTEM] System initialized successfully");
+    boot_prof_end(stage);
 }
 
 // Weak task implementations (will be overridden by PIXEL and NETSEC modules)
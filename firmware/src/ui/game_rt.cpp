@@ -0,0 +1,470 @@
+/*
+ * PIXEL - Mini-Game Runtime Implementation
+ *
+ * Sprites remember the rectangle they were last drawn at: a change adds
+ * that one and the new one to the dirty list. Two dirty rectangles merge
+ * when their bounding box is no larger than both areas together; a full
+ * list folds the new rectangle into the entry that grows least.
+ */
+
+#include "game_rt.h"
+#include "game_snack.h"
+#include "display_driver.h"
+#include "touch_driver.h"
+#include "lvgl_port.h"
+#include "board_config.h"
+#include "deferred_log.h"
+#include "bench_clock.h"
+#include "lvgl.h"
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <string.h>
+
+#define GAME_SCREEN_W          LV_HOR_RES_MAX
+#define GAME_SCREEN_H          LV_VER_RES_MAX
+
+#define GAME_BENCH_SECONDS     30
+#define GAME_BENCH_BAND_PUSHES 32
+#define GAME_BENCH_CALL_PUSHES 128
+#define GAME_BENCH_SEED        0x5EEDu
+
+// Fallback when the panel cannot be timed (native sim): SPI clock / 16 bits
+#ifdef SPI_FREQUENCY
+#define GAME_RT_NOMINAL_PX_PER_S (SPI_FREQUENCY / 16)
+#else
+#define GAME_RT_NOMINAL_PX_PER_S (40000000 / 16)
+#endif
+
+typedef struct {
+  int16_t x1, y1, x2, y2;   // Inclusive
+} game_rect_t;
+
+typedef struct {
+  const uint16_t* pixels;   // NULL: solid color
+  uint16_t color;
+  int16_t x, y;
+  uint16_t w, h;
+  bool used;
+  bool visible;
+  bool dirty;
+  bool shown_visible;       // State last drawn
+  game_rect_t shown;
+} game_sprite_t;
+
+typedef void (*game_push_fn)(int32_t x, int32_t y, uint32_t w, uint32_t h, const uint16_t* px);
+typedef bool (*game_read_fn)(uint16_t* x, uint16_t* y);
+
+static const game_def_t* s_game = NULL;
+static void (*s_on_exit)(void) = NULL;
+static bool s_active = false;
+static bool s_quit = false;
+static game_sprite_t s_sprites[GAME_RT_MAX_SPRITES];
+static game_rect_t s_dirty[GAME_RT_MAX_DIRTY];
+static uint8_t s_dirty_count = 0;
+static uint16_t s_bg = 0;
+static int64_t s_last_us = 0;
+static uint32_t s_acc_us = 0;
+static game_input_t s_input;
+static bool s_was_pressed = false;
+static game_rt_stats_t s_stats;
+
+// Panel and touch; the benchmark swaps in a pixel counter and a script
+static game_push_fn s_push = display_hw_push_pixels;
+static game_read_fn s_read = cyd_touch_read;
+
+static inline int32_t rect_area(const game_rect_t* r)
+{
+  return static_cast<int32_t>(r->x2 - r->x1 + 1) * (r->y2 - r->y1 + 1);
+}
+
+static inline game_rect_t rect_union(const game_rect_t* a, const game_rect_t* b)
+{
+  game_rect_t u = {
+    a->x1 < b->x1 ? a->x1 : b->x1, a->y1 < b->y1 ? a->y1 : b->y1,
+    a->x2 > b->x2 ? a->x2 : b->x2, a->y2 > b->y2 ? a->y2 : b->y2,
+  };
+  return u;
+}
+
+static inline bool rect_intersect(const game_rect_t* a, const game_rect_t* b, game_rect_t* out)
+{
+  out->x1 = a->x1 > b->x1 ? a->x1 : b->x1;
+  out->y1 = a->y1 > b->y1 ? a->y1 : b->y1;
+  out->x2 = a->x2 < b->x2 ? a->x2 : b->x2;
+  out->y2 = a->y2 < b->y2 ? a->y2 : b->y2;
+  return out->x1 <= out->x2 && out->y1 <= out->y2;
+}
+
+static inline game_rect_t sprite_rect(const game_sprite_t* sp)
+{
+  game_rect_t r = {sp->x, sp->y, static_cast<int16_t>(sp->x + sp->w - 1), static_cast<int16_t>(sp->y + sp->h - 1)};
+  return r;
+}
+
+static void dirty_add(game_rect_t r)
+{
+  static const game_rect_t screen = {0, 0, GAME_SCREEN_W - 1, GAME_SCREEN_H - 1};
+  if (!rect_intersect(&r, &screen, &r)) return;
+
+  // Absorb every entry that merges cheaply, then store the result
+  for (uint8_t i = 0; i < s_dirty_count;) {
+    game_rect_t u = rect_union(&s_dirty[i], &r);
+    if (rect_area(&u) <= rect_area(&s_dirty[i]) + rect_area(&r)) {
+      r = u;
+      s_dirty[i] = s_dirty[--s_dirty_count];
+      i = 0;
+    } else {
+      ++i;
+    }
+  }
+
+  if (s_dirty_count < GAME_RT_MAX_DIRTY) {
+    s_dirty[s_dirty_count++] = r;
+    return;
+  }
+  uint8_t best = 0;
+  int32_t best_growth = INT32_MAX;
+  for (uint8_t i = 0; i < s_dirty_count; ++i) {
+    game_rect_t u = rect_union(&s_dirty[i], &r);
+    int32_t growth = rect_area(&u) - rect_area(&s_dirty[i]);
+    if (growth < best_growth) {
+      best_growth = growth;
+      best = i;
+    }
+  }
+  s_dirty[best] = rect_union(&s_dirty[best], &r);
+}
+
+// Compose one rectangle band by band in the borrowed draw buffer
+static void draw_rect(const game_rect_t* r)
+{
+  uint32_t buf_px = 0;
+  uint16_t* buf = reinterpret_cast<uint16_t*>(lvgl_port_borrow_draw_buf(&buf_px));
+  int32_t w = r->x2 - r->x1 + 1;
+  int32_t band = static_cast<int32_t>(buf_px) / w;
+
+  for (int32_t y0 = r->y1; y0 <= r->y2; y0 += band) {
+    int32_t h = r->y2 - y0 + 1;
+    if (h > band) h = band;
+    uint32_t n = static_cast<uint32_t>(w * h);
+    for (uint32_t i = 0; i < n; ++i) buf[i] = s_bg;
+
+    game_rect_t b = {r->x1, static_cast<int16_t>(y0), r->x2, static_cast<int16_t>(y0 + h - 1)};
+    for (uint8_t s = 0; s < GAME_RT_MAX_SPRITES; ++s) {
+      const game_sprite_t* sp = &s_sprites[s];
+      if (!sp->used || !sp->visible) continue;
+      game_rect_t sr = sprite_rect(sp);
+      game_rect_t ix;
+      if (!rect_intersect(&sr, &b, &ix)) continue;
+
+      int32_t cols = ix.x2 - ix.x1 + 1;
+      for (int32_t y = ix.y1; y <= ix.y2; ++y) {
+        uint16_t* dst = buf + (y - y0) * w + (ix.x1 - r->x1);
+        if (sp->pixels) {
+          const uint16_t* src = sp->pixels + (y - sp->y) * sp->w + (ix.x1 - sp->x);
+          for (int32_t k = 0; k < cols; ++k) {
+            if (src[k] != GAME_RT_KEY_COLOR) dst[k] = src[k];
+          }
+        } else {
+          for (int32_t k = 0; k < cols; ++k) dst[k] = sp->color;
+        }
+      }
+    }
+
+    s_push(r->x1, y0, static_cast<uint32_t>(w), static_cast<uint32_t>(h), buf);
+    s_stats.px += n;
+  }
+  s_stats.rects++;
+}
+
+static void render(void)
+{
+  for (uint8_t s = 0; s < GAME_RT_MAX_SPRITES; ++s) {
+    game_sprite_t* sp = &s_sprites[s];
+    if (!sp->used || !sp->dirty) continue;
+    if (sp->shown_visible) dirty_add(sp->shown);
+    if (sp->visible) dirty_add(sprite_rect(sp));
+    sp->shown = sprite_rect(sp);
+    sp->shown_visible = sp->visible;
+    sp->dirty = false;
+  }
+  if (!s_dirty_count) return;
+
+  int64_t start = esp_timer_get_time();
+  for (uint8_t i = 0; i < s_dirty_count; ++i) draw_rect(&s_dirty[i]);
+  s_dirty_count = 0;
+  uint32_t elapsed = static_cast<uint32_t>(esp_timer_get_time() - start);
+  if (elapsed > s_stats.render_us_max) s_stats.render_us_max = elapsed;
+  s_stats.frames++;
+}
+
+// Edges stay pending until a step has seen them
+static void read_input(void)
+{
+  uint16_t x = 0, y = 0;
+  bool pressed = s_read(&x, &y);
+  if (pressed && !s_was_pressed) s_input.just_pressed = true;
+  if (!pressed && s_was_pressed) s_input.just_released = true;
+  if (pressed) {
+    s_input.x = static_cast<int16_t>(x);
+    s_input.y = static_cast<int16_t>(y);
+  }
+  s_input.pressed = pressed;
+  s_was_pressed = pressed;
+}
+
+static void step(void)
+{
+  s_stats.steps++;
+  if (!s_game->update(&s_input)) s_quit = true;
+  s_input.just_pressed = false;
+  s_input.just_released = false;
+}
+
+static bool start_game(const game_def_t* game, void (*on_exit)(void), uint32_t seed)
+{
+  if (s_active || !game || !game->start || !game->update) return false;
+
+  memset(s_sprites, 0, sizeof(s_sprites));
+  memset(&s_stats, 0, sizeof(s_stats));
+  memset(&s_input, 0, sizeof(s_input));
+  s_dirty_count = 0;
+  s_bg = 0;
+  s_game = game;
+  s_on_exit = on_exit;
+  s_quit = false;
+  s_was_pressed = true;   // The touch that launched the game is not a tap in it
+  s_acc_us = 0;
+  s_last_us = esp_timer_get_time();
+  s_active = true;
+
+  game->start(seed);
+  game_rt_set_background(s_bg);
+  return true;
+}
+
+bool game_rt_start(const game_def_t* game, void (*on_exit)(void))
+{
+  if (!start_game(game, on_exit, static_cast<uint32_t>(esp_timer_get_time()))) return false;
+  DLOG_I("PIXEL: Game %s started", game->name);
+  return true;
+}
+
+bool game_rt_active(void)
+{
+  return s_active;
+}
+
+void game_rt_tick(void)
+{
+  if (!s_active) return;
+
+  int64_t now = esp_timer_get_time();
+  s_acc_us += static_cast<uint32_t>(now - s_last_us);
+  s_last_us = now;
+  if (s_acc_us > GAME_RT_MAX_STEPS * GAME_RT_STEP_US) {
+    s_stats.dropped_steps += s_acc_us / GAME_RT_STEP_US - GAME_RT_MAX_STEPS;
+    s_acc_us = GAME_RT_MAX_STEPS * GAME_RT_STEP_US;
+  }
+
+  read_input();
+  while (s_acc_us >= GAME_RT_STEP_US && !s_quit) {
+    s_acc_us -= GAME_RT_STEP_US;
+    step();
+  }
+  if (s_quit) {
+    game_rt_stop();
+    return;
+  }
+  render();
+}
+
+void game_rt_stop(void)
+{
+  if (!s_active) return;
+
+  s_active = false;
+  if (s_game->stop) s_game->stop();
+  memset(s_sprites, 0, sizeof(s_sprites));
+  DLOG_I("PIXEL: Game %s over: %u steps (%u dropped), %u frames, %u px, max %u us/frame",
+         s_game->name, s_stats.steps, s_stats.dropped_steps, s_stats.frames, s_stats.px, s_stats.render_us_max);
+
+  void (*on_exit)(void) = s_on_exit;
+  s_on_exit = NULL;
+  if (on_exit) on_exit();
+
+  // LVGL owns the panel again: everything it shows must be drawn anew
+  lv_obj_invalidate(lv_scr_act());
+  lv_obj_invalidate(lv_layer_top());
+}
+
+int game_rt_sprite_add(const uint16_t* pixels, uint16_t color, uint16_t w, uint16_t h)
+{
+  for (int i = 0; i < GAME_RT_MAX_SPRITES; ++i) {
+    game_sprite_t* sp = &s_sprites[i];
+    if (sp->used) continue;
+    memset(sp, 0, sizeof(*sp));
+    sp->used = true;
+    sp->pixels = pixels;
+    sp->color = color;
+    sp->w = w;
+    sp->h = h;
+    sp->visible = true;
+    sp->dirty = true;
+    return i;
+  }
+  return -1;
+}
+
+static inline game_sprite_t* sprite(int id)
+{
+  if (id < 0 || id >= GAME_RT_MAX_SPRITES || !s_sprites[id].used) return NULL;
+  return &s_sprites[id];
+}
+
+void game_rt_sprite_move(int id, int16_t x, int16_t y)
+{
+  game_sprite_t* sp = sprite(id);
+  if (!sp || (sp->x == x && sp->y == y)) return;
+  sp->x = x;
+  sp->y = y;
+  sp->dirty = true;
+}
+
+void game_rt_sprite_show(int id, bool visible)
+{
+  game_sprite_t* sp = sprite(id);
+  if (!sp || sp->visible == visible) return;
+  sp->visible = visible;
+  sp->dirty = true;
+}
+
+void game_rt_sprite_set_pixels(int id, const uint16_t* pixels, uint16_t color)
+{
+  game_sprite_t* sp = sprite(id);
+  if (!sp || (sp->pixels == pixels && sp->color == color)) return;
+  sp->pixels = pixels;
+  sp->color = color;
+  sp->dirty = true;
+}
+
+void game_rt_set_background(uint16_t color)
+{
+  s_bg = color;
+  s_dirty_count = 0;
+  game_rect_t screen = {0, 0, GAME_SCREEN_W - 1, GAME_SCREEN_H - 1};
+  dirty_add(screen);
+}
+
+void game_rt_get_stats(game_rt_stats_t* out)
+{
+  if (out) *out = s_stats;
+}
+
+// ---------------------------------------------------------------------------
+// Benchmark
+// ---------------------------------------------------------------------------
+
+static uint32_t s_bench_step = 0;
+
+static void bench_push(int32_t x, int32_t y, uint32_t w, uint32_t h, const uint16_t* px)
+{
+  (void)x;
+  (void)y;
+  (void)w;
+  (void)h;
+  (void)px;
+}
+
+// Finger sweeping left and right, lifted for a moment every 5 s (restarts after game over)
+static bool bench_read(uint16_t* x, uint16_t* y)
+{
+  uint32_t t = s_bench_step % 300;
+  if (t >= 290) return false;
+  uint32_t phase = s_bench_step % 240;
+  uint32_t span = GAME_SCREEN_W - 40;
+  *x = static_cast<uint16_t>(20 + (phase < 120 ? phase * span / 120 : (240 - phase) * span / 120));
+  *y = GAME_SCREEN_H - 30;
+  return true;
+}
+
+void game_rt_run_benchmark(void)
+{
+  if (s_active) return;
+
+  // Panel: full-width bands for throughput, 8x8 blocks for per-call cost
+  uint32_t buf_px = 0;
+  uint16_t* buf = reinterpret_cast<uint16_t*>(lvgl_port_borrow_draw_buf(&buf_px));
+  uint32_t band_h = buf_px / GAME_SCREEN_W;
+  memset(buf, 0, buf_px * sizeof(uint16_t));
+
+  int64_t start = esp_timer_get_time();
+  for (uint32_t i = 0; i < GAME_BENCH_BAND_PUSHES; ++i) {
+    display_hw_push_pixels(0, static_cast<int32_t>((i * band_h) % (GAME_SCREEN_H - band_h)), GAME_SCREEN_W, band_h, buf);
+  }
+  uint64_t band_us = static_cast<uint64_t>(esp_timer_get_time() - start);
+  uint64_t band_px = static_cast<uint64_t>(GAME_BENCH_BAND_PUSHES) * GAME_SCREEN_W * band_h;
+
+  start = esp_timer_get_time();
+  for (uint32_t i = 0; i < GAME_BENCH_CALL_PUSHES; ++i) {
+    display_hw_push_pixels(static_cast<int32_t>((i * 8) % GAME_SCREEN_W), 0, 8, 8, buf);
+  }
+  uint64_t call_us = static_cast<uint64_t>(esp_timer_get_time() - start);
+
+  bool nominal = band_us == 0;
+  uint64_t px_per_s = nominal ? GAME_RT_NOMINAL_PX_PER_S : band_px * 1000000ULL / band_us;
+  int64_t call_ns = static_cast<int64_t>(call_us * 1000ULL / GAME_BENCH_CALL_PUSHES) -
+                    static_cast<int64_t>(64ULL * 1000000000ULL / px_per_s);
+  if (call_ns < 0) call_ns = 0;
+
+  // Headless play: measured CPU + modelled panel time per frame. The panel
+  // above stays on esp_timer: the mock panel of the native sim takes no
+  // virtual time and falls back to the nominal rate, the CPU is host time.
+  game_push_fn saved_push = s_push;
+  game_read_fn saved_read = s_read;
+  s_push = bench_push;
+  s_read = bench_read;
+  s_bench_step = 0;
+  start_game(game_snack_def(), NULL, GAME_BENCH_SEED);
+  render();   // First frame paints the whole screen: reported on its own
+
+  const uint64_t budget_ns = GAME_RT_STEP_US * 1000ULL;
+  const uint32_t frames = GAME_BENCH_SECONDS * 60;
+  uint64_t sum_ns = 0, max_ns = 0, sum_px = 0;
+  uint32_t over = 0, sum_rects = 0;
+  for (uint32_t f = 0; f < frames && !s_quit; ++f, ++s_bench_step) {
+    uint32_t px_before = s_stats.px, rects_before = s_stats.rects;
+    int64_t t0 = bench_clock_us();
+    read_input();
+    step();
+    render();
+    uint64_t cpu_ns = static_cast<uint64_t>(bench_clock_us() - t0) * 1000ULL;
+    uint32_t px = s_stats.px - px_before;
+    uint32_t rects = s_stats.rects - rects_before;
+    uint64_t frame_ns = cpu_ns + rects * static_cast<uint64_t>(call_ns) + px * 1000000000ULL / px_per_s;
+    sum_ns += frame_ns;
+    sum_px += px;
+    sum_rects += rects;
+    if (frame_ns > max_ns) max_ns = frame_ns;
+    if (frame_ns > budget_ns) over++;
+  }
+  game_rt_stats_t stats = s_stats;
+  game_rt_stop();
+  s_push = saved_push;
+  s_read = saved_read;
+
+  uint64_t full_ns = static_cast<uint64_t>(GAME_SCREEN_W) * GAME_SCREEN_H * 1000000000ULL / px_per_s;
+  Serial.printf("[GAME] Panel: %lu kpx/s%s, %lu ns per push call | full screen %lu us\n",
+                static_cast<unsigned long>(px_per_s / 1000), nominal ? " (nominal SPI)" : "",
+                static_cast<unsigned long>(call_ns), static_cast<unsigned long>(full_ns / 1000));
+  Serial.printf("[GAME] %s %lu frames: avg %lu us, max %lu us (budget %lu us), %lu over | %lu px %lu.%02lu rects per frame | score %lu\n",
+                game_snack_def()->name, static_cast<unsigned long>(frames),
+                static_cast<unsigned long>(sum_ns / frames / 1000), static_cast<unsigned long>(max_ns / 1000),
+                static_cast<unsigned long>(budget_ns / 1000), static_cast<unsigned long>(over),
+                static_cast<unsigned long>(sum_px / frames), static_cast<unsigned long>(sum_rects / frames),
+                static_cast<unsigned long>((sum_rects * 100U / frames) % 100), static_cast<unsigned long>(game_snack_score()));
+  Serial.printf("[GAME] 60 fps %s at the measured panel speed (%lu steps, %lu px pushed)\n",
+                over == 0 ? "held" : "NOT held", static_cast<unsigned long>(stats.steps),
+                static_cast<unsigned long>(stats.px));
+}
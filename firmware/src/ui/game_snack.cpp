@@ -0,0 +1,325 @@
+/*
+ * PIXEL - Snack Catch Implementation
+ *
+ * Positions are whole pixels except the snacks' fall (8.8 fixed point).
+ * Everything the runtime draws comes from one block allocated at start:
+ * pet, snack, the ten score digits and the exit cross.
+ */
+
+#include "game_snack.h"
+#include "board_config.h"
+#include "lvgl.h"
+
+#include <Arduino.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SNACK_SCREEN_W    LV_HOR_RES_MAX
+#define SNACK_SCREEN_H    LV_VER_RES_MAX
+
+#define SNACK_BG          0x0010
+#define SNACK_PET_BODY    0xFD20
+#define SNACK_PET_FACE    0x0000
+#define SNACK_RED         0xF800
+#define SNACK_STEM        0x07E0
+#define SNACK_HIGHLIGHT   0xFE79
+#define SNACK_WHITE       0xFFFF
+#define SNACK_EXIT_BG     0x4208
+
+// Pet: 16x12 mask drawn at 2x
+#define SNACK_PET_MASK_W  16
+#define SNACK_PET_MASK_H  12
+#define SNACK_PET_W       (SNACK_PET_MASK_W * 2)
+#define SNACK_PET_H       (SNACK_PET_MASK_H * 2)
+#define SNACK_PET_Y       (SNACK_SCREEN_H - SNACK_PET_H - 4)
+#define SNACK_PET_SPEED   6       // px per step towards the finger
+
+#define SNACK_SIZE        12
+#define SNACK_COUNT       6
+#define SNACK_TOP         36      // Below the score line
+#define SNACK_VY_START    384     // 1.5 px per step
+#define SNACK_VY_PER_PT   16
+#define SNACK_VY_MAX      1280    // 5 px per step
+#define SNACK_SPAWN_START 45      // Steps between snacks
+#define SNACK_SPAWN_MIN   14
+
+// Score: 3x5 font drawn at 3x
+#define SNACK_DIGITS      4
+#define SNACK_DIGIT_W     9
+#define SNACK_DIGIT_H     15
+#define SNACK_DIGIT_PX    (SNACK_DIGIT_W * SNACK_DIGIT_H)
+#define SNACK_SCORE_X     ((SNACK_SCREEN_W - SNACK_DIGITS * (SNACK_DIGIT_W + 3)) / 2)
+#define SNACK_SCORE_Y     8
+
+#define SNACK_LIVES       3
+#define SNACK_LIFE_SIZE   10
+
+#define SNACK_EXIT_SIZE   28
+#define SNACK_EXIT_X      (SNACK_SCREEN_W - SNACK_EXIT_SIZE - 4)
+#define SNACK_EXIT_Y      4
+
+#define SNACK_PX_TOTAL    (SNACK_PET_W * SNACK_PET_H + SNACK_SIZE * SNACK_SIZE + \
+                           10 * SNACK_DIGIT_PX + SNACK_EXIT_SIZE * SNACK_EXIT_SIZE)
+
+// Bit 15 = leftmost pixel
+static const uint16_t k_pet_body[SNACK_PET_MASK_H] = {
+  0x2004, 0x300C, 0x3FFC, 0x7FFE, 0x7FFE, 0x7FFE,
+  0x7FFE, 0x7FFE, 0x7FFE, 0x3FFC, 0x1FF8, 0x0FF0,
+};
+
+static const uint16_t k_pet_face[SNACK_PET_MASK_H] = {
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0C30, 0x0C30,
+  0x0000, 0x0180, 0x0000, 0x0000, 0x0000, 0x0000,
+};
+
+// Digits 0-9, 5 rows of 3 bits (bit 14 = top left)
+static const uint16_t k_font_3x5[10] = {
+  0x7B6F, 0x2C97, 0x73E7, 0x73CF, 0x5BC9, 0x79CF, 0x79EF, 0x7249, 0x7BEF, 0x7BCF,
+};
+
+typedef struct {
+  bool active;
+  int16_t x;
+  int32_t y_fp;     // 8.8
+  int32_t vy_fp;
+  int id;
+} snack_t;
+
+static uint16_t* s_px = NULL;
+static uint16_t* s_px_pet = NULL;
+static uint16_t* s_px_snack = NULL;
+static uint16_t* s_px_digits = NULL;
+static uint16_t* s_px_exit = NULL;
+
+static snack_t s_snacks[SNACK_COUNT];
+static int s_pet_id = -1;
+static int s_digit_ids[SNACK_DIGITS];
+static int s_life_ids[SNACK_LIVES];
+static int16_t s_pet_x = 0;
+static uint32_t s_score = 0;
+static uint32_t s_best = 0;
+static uint8_t s_lives = 0;
+static bool s_over = false;
+static int32_t s_spawn_in = 0;
+static uint32_t s_tick = 0;
+static uint32_t s_rng = 1;
+
+static inline uint32_t rng_next(void)
+{
+  s_rng = s_rng * 1664525u + 1013904223u;
+  return s_rng >> 16;
+}
+
+static void build_bitmaps(void)
+{
+  // Pet
+  for (int y = 0; y < SNACK_PET_H; ++y) {
+    for (int x = 0; x < SNACK_PET_W; ++x) {
+      uint16_t bit = static_cast<uint16_t>(0x8000 >> (x / 2));
+      uint16_t c = GAME_RT_KEY_COLOR;
+      if (k_pet_face[y / 2] & bit) c = SNACK_PET_FACE;
+      else if (k_pet_body[y / 2] & bit) c = SNACK_PET_BODY;
+      s_px_pet[y * SNACK_PET_W + x] = c;
+    }
+  }
+
+  // Snack: apple disc with a stem and a highlight
+  for (int y = 0; y < SNACK_SIZE; ++y) {
+    for (int x = 0; x < SNACK_SIZE; ++x) {
+      int dx = 2 * x - (SNACK_SIZE - 1);
+      int dy = 2 * y - (SNACK_SIZE + 1);
+      uint16_t c = GAME_RT_KEY_COLOR;
+      if (dx * dx + dy * dy <= 100) c = (x == 3 && y == 4) ? SNACK_HIGHLIGHT : SNACK_RED;
+      if (x == SNACK_SIZE / 2 && y < 2) c = SNACK_STEM;
+      s_px_snack[y * SNACK_SIZE + x] = c;
+    }
+  }
+
+  // Digits
+  for (int d = 0; d < 10; ++d) {
+    uint16_t* dst = s_px_digits + d * SNACK_DIGIT_PX;
+    for (int y = 0; y < SNACK_DIGIT_H; ++y) {
+      for (int x = 0; x < SNACK_DIGIT_W; ++x) {
+        bool on = k_font_3x5[d] & (0x4000 >> ((y / 3) * 3 + x / 3));
+        dst[y * SNACK_DIGIT_W + x] = on ? SNACK_WHITE : GAME_RT_KEY_COLOR;
+      }
+    }
+  }
+
+  // Exit: white cross on a grey square
+  for (int y = 0; y < SNACK_EXIT_SIZE; ++y) {
+    for (int x = 0; x < SNACK_EXIT_SIZE; ++x) {
+      bool inner = x >= 7 && x < SNACK_EXIT_SIZE - 7 && y >= 7 && y < SNACK_EXIT_SIZE - 7;
+      bool diag = abs(x - y) <= 1 || abs(x + y - (SNACK_EXIT_SIZE - 1)) <= 1;
+      s_px_exit[y * SNACK_EXIT_SIZE + x] = (inner && diag) ? SNACK_WHITE : SNACK_EXIT_BG;
+    }
+  }
+}
+
+static inline bool in_exit(const game_input_t* in)
+{
+  return in->x >= SNACK_EXIT_X && in->y < SNACK_EXIT_Y + SNACK_EXIT_SIZE;
+}
+
+static void show_score(void)
+{
+  uint32_t v = s_score;
+  for (int i = SNACK_DIGITS - 1; i >= 0; --i) {
+    game_rt_sprite_set_pixels(s_digit_ids[i], s_px_digits + (v % 10) * SNACK_DIGIT_PX, 0);
+    v /= 10;
+  }
+}
+
+static void reset_round(void)
+{
+  s_score = 0;
+  s_lives = SNACK_LIVES;
+  s_over = false;
+  s_spawn_in = SNACK_SPAWN_START / 2;
+  for (int i = 0; i < SNACK_LIVES; ++i) game_rt_sprite_show(s_life_ids[i], true);
+  for (int i = 0; i < SNACK_COUNT; ++i) {
+    s_snacks[i].active = false;
+    game_rt_sprite_show(s_snacks[i].id, false);
+  }
+  game_rt_sprite_show(s_pet_id, true);
+  show_score();
+}
+
+static void spawn(void)
+{
+  for (int i = 0; i < SNACK_COUNT; ++i) {
+    snack_t* sn = &s_snacks[i];
+    if (sn->active) continue;
+    uint32_t vy = SNACK_VY_START + s_score * SNACK_VY_PER_PT;
+    sn->active = true;
+    sn->x = static_cast<int16_t>(rng_next() % (SNACK_SCREEN_W - SNACK_SIZE));
+    sn->y_fp = SNACK_TOP << 8;
+    sn->vy_fp = static_cast<int32_t>(vy > SNACK_VY_MAX ? SNACK_VY_MAX : vy);
+    game_rt_sprite_move(sn->id, sn->x, SNACK_TOP);
+    game_rt_sprite_show(sn->id, true);
+    return;
+  }
+}
+
+static void snack_start(uint32_t seed)
+{
+  s_rng = seed | 1u;
+  s_tick = 0;
+  s_best = 0;
+  s_px = static_cast<uint16_t*>(malloc(SNACK_PX_TOTAL * sizeof(uint16_t)));
+  if (!s_px) {
+    Serial.println("[ERROR] Snack: no memory for sprites");
+    return;
+  }
+  s_px_pet = s_px;
+  s_px_snack = s_px_pet + SNACK_PET_W * SNACK_PET_H;
+  s_px_digits = s_px_snack + SNACK_SIZE * SNACK_SIZE;
+  s_px_exit = s_px_digits + 10 * SNACK_DIGIT_PX;
+  build_bitmaps();
+
+  game_rt_set_background(SNACK_BG);
+  for (int i = 0; i < SNACK_LIVES; ++i) {
+    s_life_ids[i] = game_rt_sprite_add(NULL, SNACK_RED, SNACK_LIFE_SIZE, SNACK_LIFE_SIZE);
+    game_rt_sprite_move(s_life_ids[i], static_cast<int16_t>(8 + i * (SNACK_LIFE_SIZE + 4)), SNACK_SCORE_Y + 2);
+  }
+  for (int i = 0; i < SNACK_DIGITS; ++i) {
+    s_digit_ids[i] = game_rt_sprite_add(s_px_digits, 0, SNACK_DIGIT_W, SNACK_DIGIT_H);
+    game_rt_sprite_move(s_digit_ids[i], static_cast<int16_t>(SNACK_SCORE_X + i * (SNACK_DIGIT_W + 3)), SNACK_SCORE_Y);
+  }
+  for (int i = 0; i < SNACK_COUNT; ++i) {
+    s_snacks[i].id = game_rt_sprite_add(s_px_snack, 0, SNACK_SIZE, SNACK_SIZE);
+  }
+  s_pet_x = (SNACK_SCREEN_W - SNACK_PET_W) / 2;
+  s_pet_id = game_rt_sprite_add(s_px_pet, 0, SNACK_PET_W, SNACK_PET_H);
+  game_rt_sprite_move(s_pet_id, s_pet_x, SNACK_PET_Y);
+  int exit_id = game_rt_sprite_add(s_px_exit, 0, SNACK_EXIT_SIZE, SNACK_EXIT_SIZE);
+  game_rt_sprite_move(exit_id, SNACK_EXIT_X, SNACK_EXIT_Y);
+
+  reset_round();
+}
+
+static bool snack_update(const game_input_t* in)
+{
+  if (!s_px) return false;
+  if (in->just_released && in_exit(in)) return false;
+  s_tick++;
+
+  if (s_over) {
+    game_rt_sprite_show(s_pet_id, (s_tick / 20) & 1);
+    if (in->just_pressed && !in_exit(in)) reset_round();
+    return true;
+  }
+
+  if (in->pressed) {
+    int32_t target = in->x - SNACK_PET_W / 2;
+    if (target < 0) target = 0;
+    if (target > SNACK_SCREEN_W - SNACK_PET_W) target = SNACK_SCREEN_W - SNACK_PET_W;
+    int32_t d = target - s_pet_x;
+    if (d > SNACK_PET_SPEED) d = SNACK_PET_SPEED;
+    if (d < -SNACK_PET_SPEED) d = -SNACK_PET_SPEED;
+    s_pet_x = static_cast<int16_t>(s_pet_x + d);
+    game_rt_sprite_move(s_pet_id, s_pet_x, SNACK_PET_Y);
+  }
+
+  if (--s_spawn_in <= 0) {
+    spawn();
+    int32_t next = SNACK_SPAWN_START - static_cast<int32_t>(s_score);
+    s_spawn_in = next < SNACK_SPAWN_MIN ? SNACK_SPAWN_MIN : next;
+  }
+
+  for (int i = 0; i < SNACK_COUNT; ++i) {
+    snack_t* sn = &s_snacks[i];
+    if (!sn->active) continue;
+    sn->y_fp += sn->vy_fp;
+    int16_t y = static_cast<int16_t>(sn->y_fp >> 8);
+
+    bool caught = y + SNACK_SIZE >= SNACK_PET_Y && y < SNACK_PET_Y + SNACK_PET_H &&
+                  sn->x + SNACK_SIZE > s_pet_x && sn->x < s_pet_x + SNACK_PET_W;
+    if (caught) {
+      sn->active = false;
+      game_rt_sprite_show(sn->id, false);
+      if (s_score < 9999) s_score++;
+      if (s_score > s_best) s_best = s_score;
+      show_score();
+    } else if (y >= SNACK_SCREEN_H) {
+      sn->active = false;
+      game_rt_sprite_show(sn->id, false);
+      if (s_lives) game_rt_sprite_show(s_life_ids[--s_lives], false);
+      if (!s_lives) s_over = true;
+    } else {
+      game_rt_sprite_move(sn->id, sn->x, y);
+    }
+  }
+
+  if (s_over) {
+    for (int i = 0; i < SNACK_COUNT; ++i) {
+      s_snacks[i].active = false;
+      game_rt_sprite_show(s_snacks[i].id, false);
+    }
+  }
+  return true;
+}
+
+static void snack_stop(void)
+{
+  free(s_px);
+  s_px = NULL;
+  s_px_pet = s_px_snack = s_px_digits = s_px_exit = NULL;
+}
+
+static const game_def_t k_snack_game = {
+  "Snack Catch",
+  snack_start,
+  snack_update,
+  snack_stop,
+};
+
+const game_def_t* game_snack_def(void)
+{
+  return &k_snack_game;
+}
+
+uint32_t game_snack_score(void)
+{
+  return s_best;
+}
@@ -0,0 +1,452 @@
+/*
+ * PIXEL - Pet Animation Engine Implementation
+ *
+ * Frames and timelines are const tables (flash). Advancing walks the delta
+ * in chunks that end on step boundaries, so a 500 ms tick and 500 ticks of
+ * 1 ms land on exactly the same state, step, offset and position.
+ */
+
+#include "pet_anim.h"
+
+#include <string.h>
+
+#define PET_SPRITE_PX         (PET_SPRITE_SIZE * PET_SPRITE_SCALE)
+#define PET_SPRITE_X          ((PET_BOX_W - PET_SPRITE_PX) / 2)
+
+static_assert(PET_SPRITE_PX <= PET_BOX_W && PET_SPRITE_PX <= PET_BOX_H, "sprite larger than the pet box");
+
+// ============================================================
+// Frames
+// ============================================================
+
+#define PET_EARS "  /\\___/\\  "
+
+static const char k_ascii_idle[]      = PET_EARS        " ( o   o ) " "  (  ^  )  ";
+static const char k_ascii_blink[]     = PET_EARS        " ( -   - ) " "  (  ^  )  ";
+static const char k_ascii_eat_open[]  = PET_EARS        " ( o   o ) " "  (  O  )  ";
+static const char k_ascii_eat_chew[]  = PET_EARS        " ( >   < ) " "  (  ~  )  ";
+static const char k_ascii_eat_happy[] = PET_EARS        " ( ^   ^ ) " "  (  w  )  ";
+static const char k_ascii_sleep_1[]   = PET_EARS        " ( -   - ) " "  (  _  )  ";
+static const char k_ascii_sleep_2[]   = PET_EARS        " ( -   - )z" "  (  _  )  ";
+static const char k_ascii_sleep_3[]   = "  /\\___/\\ Z" " ( -   - )z" "  (  _  )  ";
+static const char k_ascii_surprise[]  = "  /\\___/\\ !" " ( O   O ) " "  (  o  )  ";
+
+#define PET_ASCII_CHECK(a) static_assert(sizeof(a) == PET_ASCII_ROWS * PET_ASCII_COLS + 1, #a " is not a full grid")
+PET_ASCII_CHECK(k_ascii_idle);
+PET_ASCII_CHECK(k_ascii_blink);
+PET_ASCII_CHECK(k_ascii_eat_open);
+PET_ASCII_CHECK(k_ascii_eat_chew);
+PET_ASCII_CHECK(k_ascii_eat_happy);
+PET_ASCII_CHECK(k_ascii_sleep_1);
+PET_ASCII_CHECK(k_ascii_sleep_2);
+PET_ASCII_CHECK(k_ascii_sleep_3);
+PET_ASCII_CHECK(k_ascii_surprise);
+
+static const uint16_t k_sprite_heart_big[PET_SPRITE_SIZE] = {
+  0x0000, 0x3870, 0x7CF8, 0xFFFC, 0xFFFC, 0xFFFC, 0x7FF8, 0x3FF0,
+  0x1FE0, 0x0FC0, 0x0780, 0x0300, 0x0000, 0x0000, 0x0000, 0x0000,
+};
+
+static const uint16_t k_sprite_heart_small[PET_SPRITE_SIZE] = {
+  0x0000, 0x0000, 0x0000, 0x0000, 0x0CC0, 0x1FE0, 0x1FE0, 0x0FC0,
+  0x0780, 0x0300, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+};
+
+enum {
+  FRAME_IDLE = 0,
+  FRAME_BLINK,
+  FRAME_EAT_OPEN,
+  FRAME_EAT_CHEW,
+  FRAME_EAT_HAPPY,
+  FRAME_SLEEP_1,
+  FRAME_SLEEP_2,
+  FRAME_SLEEP_3,
+  FRAME_SURPRISE,
+  FRAME_HEART_BIG,
+  FRAME_HEART_SMALL,
+  FRAME_COUNT,
+};
+
+static const pet_frame_t k_frames[FRAME_COUNT] = {
+  { PET_FRAME_ASCII,  k_ascii_idle,      NULL },
+  { PET_FRAME_ASCII,  k_ascii_blink,     NULL },
+  { PET_FRAME_ASCII,  k_ascii_eat_open,  NULL },
+  { PET_FRAME_ASCII,  k_ascii_eat_chew,  NULL },
+  { PET_FRAME_ASCII,  k_ascii_eat_happy, NULL },
+  { PET_FRAME_ASCII,  k_ascii_sleep_1,   NULL },
+  { PET_FRAME_ASCII,  k_ascii_sleep_2,   NULL },
+  { PET_FRAME_ASCII,  k_ascii_sleep_3,   NULL },
+  { PET_FRAME_ASCII,  k_ascii_surprise,  NULL },
+  { PET_FRAME_SPRITE, NULL, k_sprite_heart_big },
+  { PET_FRAME_SPRITE, NULL, k_sprite_heart_small },
+};
+
+// ============================================================
+// Timelines
+// ============================================================
+
+typedef struct {
+  uint8_t frame;
+  uint16_t duration_ms;
+} pet_step_t;
+
+typedef struct {
+  const pet_step_t* steps;
+  uint8_t count;
+  bool loop;
+  pet_state_t next;           // State entered when a one-shot timeline ends
+} pet_timeline_t;
+
+static const pet_step_t k_steps_idle[] = {
+  { FRAME_IDLE, 2600 }, { FRAME_BLINK, 140 }, { FRAME_IDLE, 1900 },
+  { FRAME_BLINK, 120 }, { FRAME_IDLE, 160 }, { FRAME_BLINK, 120 },
+};
+
+static const pet_step_t k_steps_eat[] = {
+  { FRAME_EAT_OPEN, 300 }, { FRAME_EAT_CHEW, 250 }, { FRAME_EAT_OPEN, 250 },
+  { FRAME_EAT_CHEW, 250 }, { FRAME_EAT_OPEN, 250 }, { FRAME_EAT_CHEW, 250 },
+  { FRAME_EAT_HAPPY, 800 },
+};
+
+static const pet_step_t k_steps_sleep[] = {
+  { FRAME_SLEEP_1, 1200 }, { FRAME_SLEEP_2, 700 }, { FRAME_SLEEP_3, 900 }, { FRAME_SLEEP_2, 400 },
+};
+
+static const pet_step_t k_steps_react[] = {
+  { FRAME_SURPRISE, 400 }, { FRAME_HEART_BIG, 220 }, { FRAME_HEART_SMALL, 180 },
+  { FRAME_HEART_BIG, 220 }, { FRAME_HEART_SMALL, 180 }, { FRAME_HEART_BIG, 400 },
+};
+
+#define PET_STEPS(a) (a), static_cast<uint8_t>(sizeof(a) / sizeof((a)[0]))
+
+static const pet_timeline_t k_timelines[PET_STATE_COUNT] = {
+  { PET_STEPS(k_steps_idle),  true,  PET_STATE_IDLE },
+  { PET_STEPS(k_steps_eat),   false, PET_STATE_IDLE },
+  { PET_STEPS(k_steps_sleep), true,  PET_STATE_SLEEP },
+  { PET_STEPS(k_steps_react), false, PET_STATE_IDLE },
+};
+
+static const char* const k_state_names[PET_STATE_COUNT] = {
+  "idle",
+  "eat",
+  "sleep",
+  "react",
+};
+
+// Idle wander: eased moves between offsets, equal targets are pauses
+typedef struct {
+  int16_t x;
+  uint16_t duration_ms;
+} pet_segment_t;
+
+static const pet_segment_t k_wander[] = {
+  { 0, 1200 }, { 0, 2500 }, { -56, 2200 }, { -56, 3000 },
+  { 56, 3600 }, { 56, 2500 }, { 0, 2200 }, { 0, 4000 },
+};
+
+#define PET_WANDER_COUNT static_cast<uint8_t>(sizeof(k_wander) / sizeof(k_wander[0]))
+
+// ============================================================
+// Dirty rectangles
+// ============================================================
+
+static pet_rect_t s_bbox[FRAME_COUNT];
+static pet_rect_t s_diff[PET_STATE_COUNT][PET_ANIM_MAX_STEPS][PET_ANIM_MAX_RECTS];
+static uint8_t s_diff_count[PET_STATE_COUNT][PET_ANIM_MAX_STEPS];
+static bool s_tables_ready = false;
+
+static bool rect_empty(const pet_rect_t* r)
+{
+  return r->w <= 0 || r->h <= 0;
+}
+
+static pet_rect_t rect_union(const pet_rect_t* a, const pet_rect_t* b)
+{
+  if (rect_empty(a)) return *b;
+  if (rect_empty(b)) return *a;
+
+  int16_t x1 = a->x < b->x ? a->x : b->x;
+  int16_t y1 = a->y < b->y ? a->y : b->y;
+  int16_t x2 = (a->x + a->w > b->x + b->w) ? a->x + a->w : b->x + b->w;
+  int16_t y2 = (a->y + a->h > b->y + b->h) ? a->y + a->h : b->y + b->h;
+  pet_rect_t r = { x1, y1, static_cast<int16_t>(x2 - x1), static_cast<int16_t>(y2 - y1) };
+  return r;
+}
+
+// Overlapping or touching
+static bool rect_meets(const pet_rect_t* a, const pet_rect_t* b)
+{
+  return a->x <= b->x + b->w && b->x <= a->x + a->w &&
+         a->y <= b->y + b->h && b->y <= a->y + a->h;
+}
+
+static pet_rect_t frame_bbox(const pet_frame_t* f)
+{
+  pet_rect_t r = { 0, 0, 0, 0 };
+  int16_t x1 = INT16_MAX, y1 = INT16_MAX, x2 = -1, y2 = -1;
+
+  if (f->kind == PET_FRAME_ASCII) {
+    for (int16_t row = 0; row < PET_ASCII_ROWS; ++row) {
+      for (int16_t col = 0; col < PET_ASCII_COLS; ++col) {
+        if (f->ascii[row * PET_ASCII_COLS + col] == ' ') continue;
+        if (col < x1) x1 = col;
+        if (col > x2) x2 = col;
+        if (row < y1) y1 = row;
+        if (row > y2) y2 = row;
+      }
+    }
+    if (x2 < 0) return r;
+    r.x = static_cast<int16_t>(x1 * PET_CELL_W);
+    r.y = static_cast<int16_t>(y1 * PET_CELL_H);
+    r.w = static_cast<int16_t>((x2 - x1 + 1) * PET_CELL_W);
+    r.h = static_cast<int16_t>((y2 - y1 + 1) * PET_CELL_H);
+    return r;
+  }
+
+  for (int16_t row = 0; row < PET_SPRITE_SIZE; ++row) {
+    uint16_t bits = f->sprite[row];
+    if (!bits) continue;
+    int16_t first = static_cast<int16_t>(__builtin_clz(bits) - 16);
+    int16_t last = static_cast<int16_t>(15 - __builtin_ctz(bits));
+    if (first < x1) x1 = first;
+    if (last > x2) x2 = last;
+    if (row < y1) y1 = row;
+    y2 = row;
+  }
+  if (x2 < 0) return r;
+  r.x = static_cast<int16_t>(PET_SPRITE_X + x1 * PET_SPRITE_SCALE);
+  r.y = static_cast<int16_t>(y1 * PET_SPRITE_SCALE);
+  r.w = static_cast<int16_t>((x2 - x1 + 1) * PET_SPRITE_SCALE);
+  r.h = static_cast<int16_t>((y2 - y1 + 1) * PET_SPRITE_SCALE);
+  return r;
+}
+
+// Area that changes when `b` replaces `a` at the same position
+static uint8_t frame_diff(const pet_frame_t* a, const pet_frame_t* b, pet_rect_t* out)
+{
+  uint8_t n = 0;
+
+  if (a->kind == PET_FRAME_ASCII && b->kind == PET_FRAME_ASCII) {
+    // One run per row, stacked into one rect when rows share the same span
+    for (int16_t row = 0; row < PET_ASCII_ROWS; ++row) {
+      int16_t first = -1, last = -1;
+      for (int16_t col = 0; col < PET_ASCII_COLS; ++col) {
+        if (a->ascii[row * PET_ASCII_COLS + col] == b->ascii[row * PET_ASCII_COLS + col]) continue;
+        if (first < 0) first = col;
+        last = col;
+      }
+      if (first < 0) continue;
+
+      pet_rect_t r = {
+        static_cast<int16_t>(first * PET_CELL_W), static_cast<int16_t>(row * PET_CELL_H),
+        static_cast<int16_t>((last - first + 1) * PET_CELL_W), PET_CELL_H,
+      };
+      if (n && out[n - 1].x == r.x && out[n - 1].w == r.w && out[n - 1].y + out[n - 1].h == r.y) {
+        out[n - 1].h = static_cast<int16_t>(out[n - 1].h + r.h);
+      } else {
+        out[n++] = r;
+      }
+    }
+    return n;
+  }
+
+  if (a->kind == PET_FRAME_SPRITE && b->kind == PET_FRAME_SPRITE) {
+    pet_frame_t delta;
+    uint16_t bits[PET_SPRITE_SIZE];
+    for (uint8_t row = 0; row < PET_SPRITE_SIZE; ++row) bits[row] = a->sprite[row] ^ b->sprite[row];
+    delta.kind = PET_FRAME_SPRITE;
+    delta.ascii = NULL;
+    delta.sprite = bits;
+    out[0] = frame_bbox(&delta);
+    return rect_empty(&out[0]) ? 0 : 1;
+  }
+
+  // ASCII <-> sprite: everything either of them covers
+  pet_rect_t ra = frame_bbox(a);
+  pet_rect_t rb = frame_bbox(b);
+  out[0] = rect_union(&ra, &rb);
+  return rect_empty(&out[0]) ? 0 : 1;
+}
+
+static void successor(pet_state_t state, uint8_t step, pet_state_t* next_state, uint8_t* next_step)
+{
+  const pet_timeline_t* tl = &k_timelines[state];
+  if (step + 1 < tl->count) {
+    *next_state = state;
+    *next_step = static_cast<uint8_t>(step + 1);
+  } else {
+    *next_state = tl->loop ? state : tl->next;
+    *next_step = 0;
+  }
+}
+
+static void build_tables(void)
+{
+  for (uint8_t f = 0; f < FRAME_COUNT; ++f) s_bbox[f] = frame_bbox(&k_frames[f]);
+
+  for (uint8_t s = 0; s < PET_STATE_COUNT; ++s) {
+    const pet_timeline_t* tl = &k_timelines[s];
+    for (uint8_t i = 0; i < tl->count && i < PET_ANIM_MAX_STEPS; ++i) {
+      pet_state_t ns;
+      uint8_t ni;
+      successor(static_cast<pet_state_t>(s), i, &ns, &ni);
+      s_diff_count[s][i] = frame_diff(&k_frames[tl->steps[i].frame],
+                                      &k_frames[k_timelines[ns].steps[ni].frame], s_diff[s][i]);
+    }
+  }
+  s_tables_ready = true;
+}
+
+// ============================================================
+// Playback
+// ============================================================
+
+static void enter_state(pet_anim_t* anim, pet_state_t state)
+{
+  anim->state = state;
+  anim->step = 0;
+  anim->step_elapsed_ms = 0;
+  if (state == PET_STATE_IDLE) {
+    // Wander resumes from wherever the pet stands
+    anim->seg = 0;
+    anim->seg_elapsed_ms = 0;
+    anim->seg_from = anim->x;
+  }
+}
+
+// Smoothstep in Q16: slow start, slow stop
+static int16_t ease(int16_t from, int16_t to, uint32_t elapsed, uint32_t duration)
+{
+  if (from == to || elapsed >= duration) return elapsed >= duration ? to : from;
+  uint32_t t = static_cast<uint32_t>((static_cast<uint64_t>(elapsed) << 16) / duration);
+  uint32_t s = static_cast<uint32_t>((static_cast<uint64_t>(t) * t * (3U * 65536U - 2U * t)) >> 32);
+  return static_cast<int16_t>(from + ((static_cast<int32_t>(to - from) * static_cast<int32_t>(s)) >> 16));
+}
+
+static void wander(pet_anim_t* anim, uint32_t ms)
+{
+  anim->seg_elapsed_ms += ms;
+  while (anim->seg_elapsed_ms >= k_wander[anim->seg].duration_ms) {
+    anim->seg_elapsed_ms -= k_wander[anim->seg].duration_ms;
+    anim->seg_from = k_wander[anim->seg].x;
+    anim->seg = static_cast<uint8_t>((anim->seg + 1) % PET_WANDER_COUNT);
+  }
+  anim->x = ease(anim->seg_from, k_wander[anim->seg].x, anim->seg_elapsed_ms, k_wander[anim->seg].duration_ms);
+}
+
+void pet_anim_init(pet_anim_t* anim)
+{
+  if (!anim) return;
+  if (!s_tables_ready) build_tables();
+
+  memset(anim, 0, sizeof(*anim));
+  enter_state(anim, PET_STATE_IDLE);
+  anim->shown_state = PET_STATE_IDLE;
+  anim->shown_step = 0;
+  anim->shown_frame = k_timelines[PET_STATE_IDLE].steps[0].frame;
+  anim->shown_x = 0;
+}
+
+void pet_anim_set_state(pet_anim_t* anim, pet_state_t state)
+{
+  if (!anim || state >= PET_STATE_COUNT) return;
+  // Re-entering a looping state would restart it for nothing
+  if (state == anim->state && k_timelines[state].loop) return;
+  enter_state(anim, state);
+}
+
+uint8_t pet_anim_advance(pet_anim_t* anim, uint32_t delta_ms, pet_rect_t* dirty)
+{
+  if (!anim) return 0;
+
+  // Chunks end on step boundaries: movement only runs while idle, and a
+  // one-shot ending mid-delta hands the rest of the delta to idle
+  while (delta_ms) {
+    const pet_timeline_t* tl = &k_timelines[anim->state];
+    uint32_t left = tl->steps[anim->step].duration_ms - anim->step_elapsed_ms;
+    uint32_t chunk = delta_ms < left ? delta_ms : left;
+
+    if (anim->state == PET_STATE_IDLE) wander(anim, chunk);
+    anim->step_elapsed_ms += chunk;
+    delta_ms -= chunk;
+
+    if (anim->step_elapsed_ms >= tl->steps[anim->step].duration_ms) {
+      pet_state_t ns;
+      uint8_t ni;
+      successor(anim->state, anim->step, &ns, &ni);
+      if (ns != anim->state) {
+        enter_state(anim, ns);
+      } else {
+        anim->step = ni;
+        anim->step_elapsed_ms = 0;
+      }
+    }
+  }
+
+  uint8_t frame = k_timelines[anim->state].steps[anim->step].frame;
+  uint8_t n = 0;
+
+  if (anim->x != anim->shown_x) {
+    // Old and new footprint, one rect when they meet (small steps always do)
+    pet_rect_t old_r = s_bbox[anim->shown_frame];
+    pet_rect_t new_r = s_bbox[frame];
+    old_r.x = static_cast<int16_t>(old_r.x + anim->shown_x);
+    new_r.x = static_cast<int16_t>(new_r.x + anim->x);
+    if (rect_meets(&old_r, &new_r)) {
+      dirty[n++] = rect_union(&old_r, &new_r);
+    } else {
+      dirty[n++] = old_r;
+      dirty[n++] = new_r;
+    }
+    anim->stats.moves++;
+  } else if (frame != anim->shown_frame) {
+    pet_state_t ns;
+    uint8_t ni;
+    successor(anim->shown_state, anim->shown_step, &ns, &ni);
+    if (ns == anim->state && ni == anim->step) {
+      n = s_diff_count[anim->shown_state][anim->shown_step];
+      memcpy(dirty, s_diff[anim->shown_state][anim->shown_step], n * sizeof(pet_rect_t));
+    } else {
+      // Skipped steps or forced state change: diff the two frames directly
+      n = frame_diff(&k_frames[anim->shown_frame], &k_frames[frame], dirty);
+    }
+    for (uint8_t i = 0; i < n; ++i) dirty[i].x = static_cast<int16_t>(dirty[i].x + anim->x);
+  }
+
+  if (frame != anim->shown_frame) anim->stats.frames++;
+  anim->stats.rects += n;
+  for (uint8_t i = 0; i < n; ++i) {
+    anim->stats.px_dirty += static_cast<uint32_t>(dirty[i].w) * static_cast<uint32_t>(dirty[i].h);
+  }
+
+  anim->shown_state = anim->state;
+  anim->shown_step = anim->step;
+  anim->shown_frame = frame;
+  anim->shown_x = anim->x;
+  return n;
+}
+
+const pet_frame_t* pet_anim_frame(const pet_anim_t* anim)
+{
+  return &k_frames[anim->shown_frame];
+}
+
+int16_t pet_anim_x(const pet_anim_t* anim)
+{
+  return anim->shown_x;
+}
+
+uint32_t pet_anim_ms_to_next_frame(const pet_anim_t* anim)
+{
+  return k_timelines[anim->state].steps[anim->step].duration_ms - anim->step_elapsed_ms;
+}
+
+bool pet_anim_is_moving(const pet_anim_t* anim)
+{
+  return anim->state == PET_STATE_IDLE && k_wander[anim->seg].x != anim->seg_from;
+}
+
+const char* pet_anim_state_name(pet_state_t state)
+{
+  return state < PET_STATE_COUNT ? k_state_names[state] : "?";
+}
@@ -0,0 +1,334 @@
+/*
+ * PIXEL - Pet Simulation Implementation
+ *
+ * Law and effect tables are parallel const arrays indexed by need (and by
+ * action for effects), so the advance and scoring loops are straight runs
+ * over small contiguous arrays. Only 32/64-bit integer arithmetic with
+ * explicit rounding: no float, no platform-dependent shifts of negatives.
+ */
+
+#include "pet_sim.h"
+#include "bench_clock.h"
+
+#include <Arduino.h>
+#include <string.h>
+
+// pet_sim_run_benchmark(): 30 days, one decision every 5 simulated minutes
+#define PET_SIM_BENCH_DAYS        30U
+#define PET_SIM_BENCH_DECIDE_MIN  5U
+#define PET_SIM_BENCH_MINUTES     (PET_SIM_BENCH_DAYS * 24U * 60U)
+#define PET_SIM_BENCH_CATCHUPS    1000U
+
+// Hash after the 30-day benchmark life, recorded on the reference build;
+// update it together with any change to the tables or laws below
+#define PET_SIM_GOLDEN_HASH       0x51c1051bU
+
+// Levels at birth
+#define PET_SIM_BIRTH_LEVEL       ((PET_SIM_ONE * 80U) / 100U)
+
+// Score IDLE gets for free: below it no need is worth acting on
+#define PET_SIM_IDLE_BIAS         1500
+
+// Q0.16 fraction of PET_SIM_ONE
+#define Q16(pct) (static_cast<int32_t>((PET_SIM_ONE * (pct)) / 100))
+
+// ============================================================
+// Laws (per minute, one entry per need)
+// ============================================================
+
+// Awake: linear drift
+static const int32_t k_drift_awake[PET_NEED_COUNT] = {
+  -137,   // hunger: full to empty in ~8 h
+  -45,    // energy: ~24 h
+  -91,    // social: ~12 h
+  -46,    // clean: ~24 h
+  -182,   // curiosity: ~6 h
+};
+
+// Asleep: linear drift, unless keep is set (exponential recovery to full)
+static const int32_t k_drift_asleep[PET_NEED_COUNT] = {
+  -68,
+  0,
+  -30,
+  -23,
+  0,
+};
+
+// Fraction of the deficit kept per minute, Q16 (0 = linear law)
+static const uint32_t k_keep_asleep[PET_NEED_COUNT] = {
+  0,
+  64880,  // energy: 0.99 / min, 80 % of the deficit gone in ~2 h 40
+  0,
+  0,
+  0,
+};
+
+// Urgency weight of each need, Q8 (256 = 1)
+static const int32_t k_weight[PET_NEED_COUNT] = {
+  256,
+  96,
+  224,
+  192,
+  128,
+};
+
+// ============================================================
+// Actions (one row per action, one column per need)
+// ============================================================
+
+// Immediate change of each level, Q0.16. Sleep's energy column is what a
+// nap is expected to bring: used for scoring, the law does the actual work
+static const int32_t k_effect[PET_ACTION_COUNT][PET_NEED_COUNT] = {
+  //  hunger     energy     social     clean      curiosity
+  {   0,         0,         0,         0,         0        },   // idle
+  {   Q16(45),   0,         0,         -Q16(2),   0        },   // eat
+  {   0,         Q16(60),   0,         0,         0        },   // sleep
+  {   0,         -Q16(6),   Q16(35),   -Q16(4),   Q16(10)  },   // play
+  {   0,         0,         0,         Q16(60),   0        },   // clean
+  {   -Q16(3),   -Q16(8),   0,         -Q16(6),   Q16(40)  },   // explore
+};
+
+static const char* const k_need_names[PET_NEED_COUNT] = {
+  "hunger",
+  "energy",
+  "social",
+  "clean",
+  "curiosity",
+};
+
+static const char* const k_action_names[PET_ACTION_COUNT] = {
+  "idle",
+  "eat",
+  "sleep",
+  "play",
+  "clean",
+  "explore",
+};
+
+// ============================================================
+// Fixed point helpers
+// ============================================================
+
+static uint16_t clamp_level(int64_t v)
+{
+  if (v < 0) return 0;
+  if (v > static_cast<int64_t>(PET_SIM_ONE)) return static_cast<uint16_t>(PET_SIM_ONE);
+  return static_cast<uint16_t>(v);
+}
+
+// keep^n in Q16, rounded at each step (power by squaring)
+static uint32_t pow_q16(uint32_t keep, uint32_t n)
+{
+  uint64_t result = 65536U;
+  uint64_t base = keep;
+  while (n && result) {
+    if (n & 1U) result = (result * base + 0x8000U) >> 16;
+    base = (base * base + 0x8000U) >> 16;
+    n >>= 1;
+  }
+  return static_cast<uint32_t>(result);
+}
+
+// ============================================================
+// Simulation
+// ============================================================
+
+void pet_sim_init(pet_sim_t* sim)
+{
+  if (!sim) return;
+  memset(sim, 0, sizeof(*sim));
+  for (uint8_t n = 0; n < PET_NEED_COUNT; ++n) sim->level[n] = static_cast<uint16_t>(PET_SIM_BIRTH_LEVEL);
+  sim->action = PET_ACTION_IDLE;
+}
+
+void pet_sim_advance_minutes(pet_sim_t* sim, uint32_t minutes)
+{
+  if (!sim || !minutes) return;
+
+  const int32_t* drift = sim->asleep ? k_drift_asleep : k_drift_awake;
+  for (uint8_t n = 0; n < PET_NEED_COUNT; ++n) {
+    if (sim->asleep && k_keep_asleep[n]) {
+      uint64_t deficit = PET_SIM_ONE - sim->level[n];
+      deficit = (deficit * pow_q16(k_keep_asleep[n], minutes) + 0x8000U) >> 16;
+      sim->level[n] = clamp_level(static_cast<int64_t>(PET_SIM_ONE) - static_cast<int64_t>(deficit));
+    } else {
+      sim->level[n] = clamp_level(static_cast<int64_t>(sim->level[n]) +
+                                  static_cast<int64_t>(drift[n]) * minutes);
+    }
+  }
+  sim->minutes += minutes;
+}
+
+void pet_sim_advance(pet_sim_t* sim, uint32_t delta_ms)
+{
+  if (!sim) return;
+  uint64_t total = static_cast<uint64_t>(sim->carry_ms) + delta_ms;
+  sim->carry_ms = static_cast<uint32_t>(total % 60000U);
+  pet_sim_advance_minutes(sim, static_cast<uint32_t>(total / 60000U));
+}
+
+pet_action_t pet_sim_decide(const pet_sim_t* sim, int32_t* scores)
+{
+  int32_t local[PET_ACTION_COUNT];
+  if (!scores) scores = local;
+
+  // Urgency grows with the square of the deficit: a half-empty need is 4x
+  // as pressing as a quarter-empty one
+  int32_t urgency[PET_NEED_COUNT];
+  for (uint8_t n = 0; n < PET_NEED_COUNT; ++n) {
+    uint32_t deficit = PET_SIM_ONE - sim->level[n];
+    urgency[n] = static_cast<int32_t>(((deficit * deficit) >> 16) * static_cast<uint32_t>(k_weight[n]) >> 8);
+  }
+
+  pet_action_t best = PET_ACTION_IDLE;
+  for (uint8_t a = 0; a < PET_ACTION_COUNT; ++a) {
+    int64_t acc = 0;
+    for (uint8_t n = 0; n < PET_NEED_COUNT; ++n) acc += static_cast<int64_t>(urgency[n]) * k_effect[a][n];
+    scores[a] = static_cast<int32_t>(acc / 65536);
+    if (a == PET_ACTION_IDLE) scores[a] += PET_SIM_IDLE_BIAS;
+    if (scores[a] > scores[best]) best = static_cast<pet_action_t>(a);
+  }
+
+  // A sleeping pet finishes its night
+  if (sim->asleep && sim->level[PET_NEED_ENERGY] < PET_SIM_WAKE_LEVEL) best = PET_ACTION_SLEEP;
+  return best;
+}
+
+void pet_sim_apply(pet_sim_t* sim, pet_action_t action)
+{
+  if (!sim || action >= PET_ACTION_COUNT) return;
+
+  sim->action = static_cast<uint8_t>(action);
+  if (action == PET_ACTION_SLEEP) {
+    sim->asleep = 1;
+    return;
+  }
+
+  sim->asleep = 0;
+  for (uint8_t n = 0; n < PET_NEED_COUNT; ++n) {
+    sim->level[n] = clamp_level(static_cast<int64_t>(sim->level[n]) + k_effect[action][n]);
+  }
+}
+
+uint16_t pet_sim_mood(const pet_sim_t* sim)
+{
+  uint32_t sum = 0;
+  uint32_t worst = PET_SIM_ONE;
+  for (uint8_t n = 0; n < PET_NEED_COUNT; ++n) {
+    sum += sim->level[n];
+    if (sim->level[n] < worst) worst = sim->level[n];
+  }
+  return static_cast<uint16_t>((3U * (sum / PET_NEED_COUNT) + worst) / 4U);
+}
+
+static uint32_t fnv1a(uint32_t h, uint32_t v, uint8_t bytes)
+{
+  // Little-endian byte order whatever the host
+  for (uint8_t i = 0; i < bytes; ++i) {
+    h ^= (v >> (8U * i)) & 0xFFU;
+    h *= 16777619U;
+  }
+  return h;
+}
+
+uint32_t pet_sim_hash(const pet_sim_t* sim)
+{
+  uint32_t h = 2166136261U;
+  for (uint8_t n = 0; n < PET_NEED_COUNT; ++n) h = fnv1a(h, sim->level[n], 2);
+  h = fnv1a(h, sim->minutes, 4);
+  h = fnv1a(h, sim->carry_ms, 4);
+  h = fnv1a(h, sim->asleep, 1);
+  h = fnv1a(h, sim->action, 1);
+  return h;
+}
+
+const char* pet_sim_need_name(pet_need_t need)
+{
+  return need < PET_NEED_COUNT ? k_need_names[need] : "?";
+}
+
+const char* pet_sim_action_name(pet_action_t action)
+{
+  return action < PET_ACTION_COUNT ? k_action_names[action] : "?";
+}
+
+// ============================================================
+// Benchmark
+// ============================================================
+
+void pet_sim_run_benchmark(void)
+{
+  // 1. A month of life, decision every few minutes
+  pet_sim_t sim;
+  uint32_t count[PET_ACTION_COUNT] = {};
+  uint32_t decisions = 0;
+
+  pet_sim_init(&sim);
+  int64_t t0 = bench_clock_us();
+  for (uint32_t m = 0; m < PET_SIM_BENCH_MINUTES; m += PET_SIM_BENCH_DECIDE_MIN) {
+    pet_action_t a = pet_sim_decide(&sim, NULL);
+    pet_sim_apply(&sim, a);
+    pet_sim_advance(&sim, PET_SIM_BENCH_DECIDE_MIN * 60000U);
+    count[a]++;
+    decisions++;
+  }
+  uint32_t life_us = static_cast<uint32_t>(bench_clock_us() - t0);
+  uint32_t hash = pet_sim_hash(&sim);
+
+  Serial.printf("[PET] Sim %lu days: %lu decisions in %lu us, mood %lu%%, hash %08lx (golden %08lx: %s)\n",
+                static_cast<unsigned long>(PET_SIM_BENCH_DAYS), static_cast<unsigned long>(decisions),
+                static_cast<unsigned long>(life_us),
+                static_cast<unsigned long>(pet_sim_mood(&sim) * 100U / PET_SIM_ONE),
+                static_cast<unsigned long>(hash), static_cast<unsigned long>(PET_SIM_GOLDEN_HASH),
+                hash == PET_SIM_GOLDEN_HASH ? "bit-exact" : "MISMATCH");
+  Serial.printf("[PET] Actions: idle %lu, eat %lu, sleep %lu, play %lu, clean %lu, explore %lu\n",
+                static_cast<unsigned long>(count[PET_ACTION_IDLE]), static_cast<unsigned long>(count[PET_ACTION_EAT]),
+                static_cast<unsigned long>(count[PET_ACTION_SLEEP]), static_cast<unsigned long>(count[PET_ACTION_PLAY]),
+                static_cast<unsigned long>(count[PET_ACTION_CLEAN]),
+                static_cast<unsigned long>(count[PET_ACTION_EXPLORE]));
+
+  // 2. Closed-form catch-up vs minute ticks, awake then asleep
+  for (uint8_t asleep = 0; asleep < 2; ++asleep) {
+    pet_sim_t once, ticked;
+    pet_sim_init(&once);
+    once.asleep = asleep;
+    once.level[PET_NEED_ENERGY] = static_cast<uint16_t>(PET_SIM_ONE / 10U);
+    ticked = once;
+
+    // One closed-form call is well under a microsecond: time a batch of them
+    pet_sim_t start = once;
+    int64_t t1 = bench_clock_us();
+    for (uint32_t i = 0; i < PET_SIM_BENCH_CATCHUPS; ++i) {
+      once = start;
+      pet_sim_advance_minutes(&once, PET_SIM_BENCH_MINUTES);
+    }
+    int64_t t2 = bench_clock_us();
+    for (uint32_t m = 0; m < PET_SIM_BENCH_MINUTES; ++m) pet_sim_advance_minutes(&ticked, 1);
+    int64_t t3 = bench_clock_us();
+
+    // Partial catch-up (2 h) shows the rounding gap of the exponential law
+    pet_sim_t part_once, part_ticked;
+    pet_sim_init(&part_once);
+    part_once.asleep = asleep;
+    part_once.level[PET_NEED_ENERGY] = static_cast<uint16_t>(PET_SIM_ONE / 10U);
+    part_ticked = part_once;
+    pet_sim_advance_minutes(&part_once, 120);
+    for (uint32_t m = 0; m < 120; ++m) pet_sim_advance_minutes(&part_ticked, 1);
+
+    uint32_t drift = 0;
+    for (uint8_t n = 0; n < PET_NEED_COUNT; ++n) {
+      int32_t d = static_cast<int32_t>(once.level[n]) - ticked.level[n];
+      int32_t p = static_cast<int32_t>(part_once.level[n]) - part_ticked.level[n];
+      if (d < 0) d = -d;
+      if (p < 0) p = -p;
+      if (static_cast<uint32_t>(d) > drift) drift = static_cast<uint32_t>(d);
+      if (static_cast<uint32_t>(p) > drift) drift = static_cast<uint32_t>(p);
+    }
+
+    Serial.printf("[PET] Catch-up %lu days %s: closed form %lu ns, per-minute loop %lu us, max drift %lu LSB\n",
+                  static_cast<unsigned long>(PET_SIM_BENCH_DAYS), asleep ? "asleep" : "awake",
+                  static_cast<unsigned long>((t2 - t1) * 1000 / PET_SIM_BENCH_CATCHUPS),
+                  static_cast<unsigned long>(t3 - t2),
+                  static_cast<unsigned long>(drift));
+  }
+}
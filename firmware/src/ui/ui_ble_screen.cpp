@@ -3,12 +3,26 @@
  *
  * Displays list of detected BLE devices with a three-state top band
  * (idle scan button, duration selection, live scanning banner) and a
- * scrollable list with an empty state message.
+ * scrollable list with an empty state message. Device data and status text
+ * are kept outside the LVGL objects so the screen can be torn down and
+ * rebuilt (in steps, see ui_build_ble_screen_step) without losing results.
+ * While the screen is hidden, results and state changes only touch that
+ * model; ui_ble_set_visible(true) reconciles the objects in one pass.
+ *
+ * Rows follow the NETSEC device registry diffs and stay across scans: added
+ * and changed devices are upserted, gone ones removed. With every row taken
+ * a new device reuses the row heard from longest ago.
  */
 
 #include "ui_screens.h"
+#include "ui_screen_mgr.h"
 #include "ui_theme.h"
 #include "ui_api.h"
+#include "ui_cell_label.h"
+#include "lvgl_heap.h"
+#include "lvgl_port.h"
+#include "bench_clock.h"
+#include "deferred_log.h"
 #include "netsec_api.h"
 #include "netsec/netsec_ble.h"
 #include "lvgl.h"
@@ -17,11 +31,24 @@
 #endif
 
 #include <Arduino.h>
+#include <esp_timer.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
 
+#define BLE_ROWS_PER_STEP 4
+
+// ui_ble_run_background_benchmark(): one report per device and second of a 30 s scan
+#define BLE_BENCH_DEVICES NETSEC_BLE_DEVICE_BUFFER_SIZE
+#define BLE_BENCH_ROUNDS  30
+#define BLE_STATUS_TEXT_MAX 48
+
+// Cell grids: content area inner width, minus list and row padding for rows
+#define BLE_STATUS_COLS UI_CELL_LABEL_COLS(LV_HOR_RES - 2 * PAD_NORMAL)
+#define BLE_ROW_COLS    UI_CELL_LABEL_COLS(LV_HOR_RES - 2 * PAD_NORMAL - 4 * PAD_SMALL)
+
 static lv_obj_t* g_ble_screen = NULL;
+static lv_obj_t* g_band_top = NULL;
 static lv_obj_t* g_content_container = NULL;
 static lv_obj_t* g_ble_scan_button = NULL;
 static lv_obj_t* g_duration_container = NULL;
@@ -36,17 +63,21 @@ static lv_timer_t* g_scan_timer = NULL;
 static lv_obj_t* g_duration_buttons[3] = {NULL};
 static bool g_has_scanned = false;
 static char g_local_mac_str[18] = "--:--:--:--:--:--";
+static char g_status_text[BLE_STATUS_TEXT_MAX] = "";
 
 typedef struct {
   bool in_use;
-  uint8_t mac_bytes[6];
-  lv_obj_t* row;
+  bool dirty;                   // Model changed while the screen was hidden
+  netsec_device_t device;       // Kept across teardown so rows can be rebuilt
+  lv_obj_t* row;                // May outlive in_use while hidden (deleted on reconcile)
   lv_obj_t* label;
 } ble_device_entry_t;
 
 static ble_device_entry_t g_device_entries[NETSEC_BLE_DEVICE_BUFFER_SIZE];
-static uint32_t g_scan_remaining_ms = 0;
+static uint32_t g_scan_deadline_ms = 0;   // millis() at which the scan should end
 static bool g_scan_active = false;
+static bool g_visible = false;
+static uint32_t g_deferred_updates = 0;   // Row/status writes skipped while hidden
 static uint32_t g_last_duration_ms = 0;
 
 typedef enum {
@@ -56,13 +87,38 @@ typedef enum {
 } top_band_state_t;
 static top_band_state_t g_top_state = TOP_STATE_IDLE;
 
+typedef enum {
+  BLE_BUILD_TOP_BAND = 0,
+  BLE_BUILD_IDLE,
+  BLE_BUILD_DURATION,
+  BLE_BUILD_SCANNING,
+  BLE_BUILD_CONTENT,
+  BLE_BUILD_ROWS,
+  BLE_BUILD_DONE,
+} ble_build_step_t;
+static ble_build_step_t g_build_step = BLE_BUILD_TOP_BAND;
+static size_t g_build_slot = 0;
+
+static void build_top_band(void);
+static void build_idle_controls(void);
+static void build_duration_controls(void);
+static void build_scanning_controls(void);
+static void build_content(void);
+
 static void on_scan_btn_click(lv_event_t* e);
 static void on_duration_btn_click(lv_event_t* e);
 static void on_cancel_btn_click(lv_event_t* e);
 static void set_top_band_state(top_band_state_t state);
-static void clear_device_list(void);
+static void apply_top_band_visibility(top_band_state_t state);
+static void set_status_text(const char* text);
+static void apply_scan_button_state(void);
+static uint32_t scan_remaining_ms(void);
+static void arm_scan_timer(void);
+static void create_device_row(ble_device_entry_t* entry);
+static void update_device_row_text(ble_device_entry_t* entry);
 static void create_empty_label(void);
-static void upsert_device_row(const netsec_ble_device_t* device);
+static void upsert_device_row(const netsec_device_t* device);
+static void remove_device_row(const netsec_device_t* device);
 static void refresh_empty_state(void);
 static void align_empty_label(void);
 static void start_scan_timer(uint32_t duration_ms);
@@ -74,7 +130,148 @@ static void scan_timer_cb(lv_timer_t* timer);
 static void fetch_local_mac(void);
 static void update_title_mac_label(void);
 
+bool ui_build_ble_screen_step(void)
+{
+  switch (g_build_step) {
+    case BLE_BUILD_TOP_BAND:
+      build_top_band();
+      break;
+    case BLE_BUILD_IDLE:
+      build_idle_controls();
+      break;
+    case BLE_BUILD_DURATION:
+      build_duration_controls();
+      break;
+    case BLE_BUILD_SCANNING:
+      build_scanning_controls();
+      break;
+    case BLE_BUILD_CONTENT:
+      build_content();
+      g_build_slot = 0;
+      break;
+
+    case BLE_BUILD_ROWS: {
+      // Rows for devices recorded while the screen did not exist
+      size_t created = 0;
+      while (g_build_slot < NETSEC_BLE_DEVICE_BUFFER_SIZE && created < BLE_ROWS_PER_STEP) {
+        ble_device_entry_t* entry = &g_device_entries[g_build_slot++];
+        if (entry->in_use && !entry->row) {
+          create_device_row(entry);
+          created++;
+        }
+      }
+      if (g_build_slot < NETSEC_BLE_DEVICE_BUFFER_SIZE) return false;
+
+      // Restore the state the data model is in, without touching the shared
+      // bottom button: the screen may be built while another one is shown.
+      apply_top_band_visibility(g_top_state);
+      apply_scan_button_state();
+      g_build_step = BLE_BUILD_DONE;
+      Serial.println("PIXEL: BLE screen created");
+      return true;
+    }
+
+    case BLE_BUILD_DONE:
+    default:
+      return true;
+  }
+
+  g_build_step = static_cast<ble_build_step_t>(g_build_step + 1);
+  return false;
+}
+
 lv_obj_t* ui_create_ble_screen(void)
+{
+  while (!ui_build_ble_screen_step()) {
+  }
+  return g_ble_screen;
+}
+
+lv_obj_t* ui_ble_screen_root(void)
+{
+  return g_ble_screen;
+}
+
+void ui_destroy_ble_screen(void)
+{
+  if (g_ble_screen) {
+    lv_obj_del(g_ble_screen);
+  }
+  g_ble_screen = NULL;
+  g_band_top = NULL;
+  g_content_container = NULL;
+  g_ble_scan_button = NULL;
+  g_duration_container = NULL;
+  g_idle_container = NULL;
+  g_scanning_container = NULL;
+  g_scanning_spinner = NULL;
+  g_list_title = NULL;
+  g_device_list = NULL;
+  g_empty_label = NULL;
+  g_status_label = NULL;
+  for (lv_obj_t*& btn : g_duration_buttons) {
+    btn = NULL;
+  }
+  for (size_t i = 0; i < NETSEC_BLE_DEVICE_BUFFER_SIZE; ++i) {
+    g_device_entries[i].row = NULL;
+    g_device_entries[i].label = NULL;
+  }
+  g_build_step = BLE_BUILD_TOP_BAND;
+  g_build_slot = 0;
+  g_visible = false;
+}
+
+void ui_ble_set_visible(bool visible)
+{
+  g_visible = visible && g_ble_screen;
+  if (g_scan_timer && g_scan_active) {
+    arm_scan_timer();
+    lv_timer_reset(g_scan_timer);
+  }
+  if (!g_visible) return;
+
+  int64_t t0 = esp_timer_get_time();
+  uint32_t rows = 0;
+  for (size_t i = 0; i < NETSEC_BLE_DEVICE_BUFFER_SIZE; ++i) {
+    ble_device_entry_t* entry = &g_device_entries[i];
+    if (!entry->in_use) {
+      // Gone while hidden
+      if (entry->row) {
+        lv_obj_del(entry->row);
+        entry->row = NULL;
+        entry->label = NULL;
+        rows++;
+      }
+      continue;
+    }
+    if (!entry->row) {
+      create_device_row(entry);
+      rows++;
+    } else if (entry->dirty) {
+      update_device_row_text(entry);
+      rows++;
+    }
+    entry->dirty = false;
+  }
+
+  set_top_band_state(g_top_state);
+  apply_scan_button_state();
+  if (g_scan_active) {
+    update_scan_status_label();
+  } else if (g_status_label) {
+    ui_cell_label_set_text(g_status_label, g_status_text);
+  }
+  refresh_empty_state();
+
+  if (g_deferred_updates) {
+    DLOG_I("PIXEL: BLE reconcile %u rows for %lu deferred updates in %lu us", rows,
+           static_cast<unsigned long>(g_deferred_updates),
+           static_cast<unsigned long>(esp_timer_get_time() - t0));
+    g_deferred_updates = 0;
+  }
+}
+
+static void build_top_band(void)
 {
   lv_obj_t* scr = lv_obj_create(NULL);
   lv_obj_set_style_bg_color(scr, lv_color_hex(COLOR_BACKGROUND), 0);
@@ -82,27 +279,32 @@ lv_obj_t* ui_create_ble_screen(void)
   lv_obj_clear_flag(scr, LV_OBJ_FLAG_SCROLLABLE);
 
   // === TOP BUTTON BAND ===
-  lv_obj_t* band_top = lv_obj_create(scr);
-  lv_obj_set_size(band_top, LV_HOR_RES, BAND_HEIGHT);
-  lv_obj_set_pos(band_top, 0, 0);
-  lv_obj_set_style_bg_color(band_top, lv_color_hex(COLOR_CPC_BLUE), 0);
-  lv_obj_set_style_bg_opa(band_top, LV_OPA_10, 0);
-  lv_obj_set_style_border_width(band_top, 0, 0);
-  lv_obj_set_style_pad_all(band_top, PAD_SMALL, 0);
-  lv_obj_set_flex_flow(band_top, LV_FLEX_FLOW_ROW);
-  lv_obj_set_flex_align(band_top, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
-  lv_obj_clear_flag(band_top, LV_OBJ_FLAG_SCROLLABLE);
+  g_band_top = lv_obj_create(scr);
+  lv_obj_set_size(g_band_top, LV_HOR_RES, BAND_HEIGHT);
+  lv_obj_set_pos(g_band_top, 0, 0);
+  lv_obj_set_style_bg_color(g_band_top, lv_color_hex(COLOR_CPC_BLUE), 0);
+  lv_obj_set_style_bg_opa(g_band_top, LV_OPA_10, 0);
+  lv_obj_set_style_border_width(g_band_top, 0, 0);
+  lv_obj_set_style_pad_all(g_band_top, PAD_SMALL, 0);
+  lv_obj_set_flex_flow(g_band_top, LV_FLEX_FLOW_ROW);
+  lv_obj_set_flex_align(g_band_top, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+  lv_obj_clear_flag(g_band_top, LV_OBJ_FLAG_SCROLLABLE);
 
   // Screen title within the top band
-  lv_obj_t* title = lv_label_create(band_top);
+  lv_obj_t* title = lv_label_create(g_band_top);
   lv_label_set_text(title, "BLE");
   lv_obj_add_style(title, ui_get_style_label_title(), 0);
   lv_obj_set_style_text_color(title, lv_color_hex(COLOR_TEXT), 0);
   lv_obj_set_style_pad_left(title, PAD_SMALL, 0);
   lv_obj_set_flex_grow(title, 1);
 
+  g_ble_screen = scr;
+}
+
+static void build_idle_controls(void)
+{
   // Idle state container (Scan button)
-  g_idle_container = lv_obj_create(band_top);
+  g_idle_container = lv_obj_create(g_band_top);
   lv_obj_set_style_bg_opa(g_idle_container, LV_OPA_TRANSP, 0);
   lv_obj_set_style_border_width(g_idle_container, 0, 0);
   lv_obj_set_flex_flow(g_idle_container, LV_FLEX_FLOW_ROW);
@@ -121,9 +323,12 @@ lv_obj_t* ui_create_ble_screen(void)
   lv_obj_center(label_scan);
   lv_obj_add_style(label_scan, ui_get_style_label_normal(), 0);
   lv_obj_set_style_text_color(label_scan, lv_color_hex(COLOR_CPC_YELLOW), 0);
+}
 
+static void build_duration_controls(void)
+{
   // Duration selection container (10/20/30s)
-  g_duration_container = lv_obj_create(band_top);
+  g_duration_container = lv_obj_create(g_band_top);
   lv_obj_set_style_bg_opa(g_duration_container, LV_OPA_TRANSP, 0);
   lv_obj_set_style_border_width(g_duration_container, 0, 0);
   lv_obj_set_flex_flow(g_duration_container, LV_FLEX_FLOW_ROW_WRAP);
@@ -150,9 +355,12 @@ lv_obj_t* ui_create_ble_screen(void)
 
     g_duration_buttons[i] = btn;
   }
+}
 
+static void build_scanning_controls(void)
+{
   // Scanning state container
-  g_scanning_container = lv_obj_create(band_top);
+  g_scanning_container = lv_obj_create(g_band_top);
   lv_obj_set_style_bg_opa(g_scanning_container, LV_OPA_TRANSP, 0);
   lv_obj_set_style_border_width(g_scanning_container, 0, 0);
   lv_obj_set_flex_flow(g_scanning_container, LV_FLEX_FLOW_ROW);
@@ -165,9 +373,12 @@ lv_obj_t* ui_create_ble_screen(void)
 
   g_scanning_spinner = lv_spinner_create(g_scanning_container, 1000, 90);
   lv_obj_set_size(g_scanning_spinner, BUTTON_HEIGHT - PAD_TINY, BUTTON_HEIGHT - PAD_TINY);
+}
 
+static void build_content(void)
+{
   // Central content container
-  g_content_container = lv_obj_create(scr);
+  g_content_container = lv_obj_create(g_ble_screen);
   lv_obj_set_size(g_content_container, LV_HOR_RES, LV_VER_RES - BAND_HEIGHT - BAND_HEIGHT);
   lv_obj_set_pos(g_content_container, 0, BAND_HEIGHT);
   lv_obj_set_style_bg_color(g_content_container, lv_color_hex(COLOR_CPC_BLUE), 0);
@@ -187,13 +398,11 @@ lv_obj_t* ui_create_ble_screen(void)
   lv_obj_set_style_pad_bottom(g_list_title, PAD_SMALL, 0);
 
   // Status text inside the content area
-  g_status_label = lv_label_create(g_content_container);
-  lv_label_set_text(g_status_label, "");
+  g_status_label = ui_cell_label_create(g_content_container, BLE_STATUS_COLS, 2);
   lv_obj_add_style(g_status_label, ui_get_style_label_normal(), 0);
   lv_obj_set_style_text_color(g_status_label, lv_color_hex(COLOR_CPC_YELLOW), 0);
-  lv_obj_set_width(g_status_label, LV_PCT(100));
-  lv_label_set_long_mode(g_status_label, LV_LABEL_LONG_WRAP);
   lv_obj_set_style_pad_bottom(g_status_label, PAD_SMALL, 0);
+  ui_cell_label_set_text(g_status_label, g_status_text);
 
   // Scrollable list container
   g_device_list = lv_obj_create(g_content_container);
@@ -211,12 +420,6 @@ lv_obj_t* ui_create_ble_screen(void)
 
   // Empty state label
   create_empty_label();
-
-  g_ble_screen = scr;
-  set_top_band_state(TOP_STATE_IDLE);
-  refresh_empty_state();
-  Serial.println("PIXEL: BLE screen created");
-  return scr;
 }
 
 lv_obj_t* ui_ble_get_scan_button(void)
@@ -233,19 +436,14 @@ void ui_ble_set_state_idle(void)
 {
   g_scan_active = false;
   stop_scan_timer();
-  g_scan_remaining_ms = 0;
   set_top_band_state(TOP_STATE_IDLE);
-  if (g_status_label) {
-    lv_label_set_text(g_status_label, "");
-  }
+  set_status_text("");
 }
 
 void ui_ble_set_state_choosing_duration(void)
 {
   set_top_band_state(TOP_STATE_DURATION);
-  if (g_status_label) {
-    lv_label_set_text(g_status_label, "Choose scan duration.");
-  }
+  set_status_text("Choose scan duration.");
 }
 
 void ui_ble_set_state_scanning(uint32_t duration_ms)
@@ -254,7 +452,7 @@ void ui_ble_set_state_scanning(uint32_t duration_ms)
   if (!g_scan_active) {
     ui_ble_prepare_for_scan(duration_ms);
   } else {
-    g_scan_remaining_ms = duration_ms;
+    g_scan_deadline_ms = millis() + duration_ms;
     g_last_duration_ms = duration_ms ? duration_ms : g_last_duration_ms;
     update_scan_status_label();
   }
@@ -265,15 +463,10 @@ void ui_ble_cancel_scan(void)
 {
   g_scan_active = false;
   stop_scan_timer();
-  g_scan_remaining_ms = 0;
   g_has_scanned = false;
   set_top_band_state(TOP_STATE_IDLE);
-  if (g_ble_scan_button) {
-    lv_obj_clear_state(g_ble_scan_button, LV_STATE_DISABLED);
-  }
-  if (g_status_label) {
-    lv_label_set_text(g_status_label, "Scan canceled.");
-  }
+  apply_scan_button_state();
+  set_status_text("Scan canceled.");
   refresh_empty_state();
 }
 
@@ -286,24 +479,23 @@ void ui_ble_show_scan_request(uint32_t duration_ms)
 
 void ui_ble_prepare_for_scan(uint32_t duration_ms)
 {
-  clear_device_list();
-
+  // Rows carry over: the registry sends what changed during the scan
   g_scan_active = true;
   g_last_duration_ms = duration_ms ? duration_ms : g_last_duration_ms;
-  g_scan_remaining_ms = g_last_duration_ms;
-  start_scan_timer(g_scan_remaining_ms);
+  start_scan_timer(g_last_duration_ms);
   update_scan_status_label();
   g_has_scanned = false;
-
-  if (g_ble_scan_button) {
-    lv_obj_add_state(g_ble_scan_button, LV_STATE_DISABLED);
-  }
+  apply_scan_button_state();
 }
 
-void ui_ble_handle_device_found(const netsec_ble_device_t* device)
+void ui_ble_handle_device(netsec_result_type_t type, const netsec_device_t* device)
 {
   if (!device) return;
-  upsert_device_row(device);
+  if (type == NETSEC_RES_DEVICE_GONE) {
+    remove_device_row(device);
+  } else {
+    upsert_device_row(device);
+  }
 }
 
 void ui_ble_handle_scan_started(const netsec_scan_summary_t* meta)
@@ -317,35 +509,31 @@ void ui_ble_handle_scan_started(const netsec_scan_summary_t* meta)
 
 void ui_ble_handle_scan_completed(const netsec_scan_summary_t* meta)
 {
-  g_scan_active = false;
   g_scan_active = false;
   stop_scan_timer();
-  g_scan_remaining_ms = 0;
   g_has_scanned = true;
 
-  if (g_status_label) {
-    uint16_t count = meta ? meta->item_count : 0;
-    lv_label_set_text_fmt(g_status_label, "Scan complete (%u device%s).", count, (count == 1) ? "" : "s");
-  }
+  uint16_t count = meta ? meta->item_count : 0;
+  char text[BLE_STATUS_TEXT_MAX];
+  snprintf(text, sizeof(text), "Scan complete (%u device%s).", count, (count == 1) ? "" : "s");
+  set_status_text(text);
 
   set_top_band_state(TOP_STATE_IDLE);
-  if (g_ble_scan_button) {
-    lv_obj_clear_state(g_ble_scan_button, LV_STATE_DISABLED);
-  }
+  apply_scan_button_state();
   refresh_empty_state();
 }
 
 static void on_scan_btn_click(lv_event_t* e)
 {
   (void)e;
-  Serial.println("PIXEL: BLE scan button clicked");
+  DLOG_I("PIXEL: BLE scan button clicked");
   ui_post_event(UI_EVENT_BLE_SCAN_REQUEST);
 }
 
 static void on_duration_btn_click(lv_event_t* e)
 {
   int duration_s = (int)(intptr_t)lv_event_get_user_data(e);
-  Serial.printf("PIXEL: BLE scan %ds requested\n", duration_s);
+  DLOG_I("PIXEL: BLE scan %ds requested", duration_s);
   switch (duration_s) {
     case 10:
       ui_post_event(UI_EVENT_BLE_DURATION_SELECTED_10S);
@@ -364,13 +552,31 @@ static void on_duration_btn_click(lv_event_t* e)
 static void on_cancel_btn_click(lv_event_t* e)
 {
   (void)e;
-  Serial.println("PIXEL: BLE scan canceled by user");
+  DLOG_I("PIXEL: BLE scan canceled by user");
   ui_post_event(UI_EVENT_BLE_CANCEL);
 }
 
 static void set_top_band_state(top_band_state_t state)
 {
   g_top_state = state;
+  if (!g_visible) return;  // Applied by ui_ble_set_visible()
+  if (!g_duration_container || !g_idle_container || !g_scanning_container) return;
+
+  apply_top_band_visibility(state);
+  switch (state) {
+    case TOP_STATE_DURATION:
+    case TOP_STATE_SCANNING:
+      ui_bottom_button_set("Cancel", on_cancel_btn_click);
+      break;
+    case TOP_STATE_IDLE:
+    default:
+      ui_bottom_button_restore();
+      break;
+  }
+}
+
+static void apply_top_band_visibility(top_band_state_t state)
+{
   if (!g_duration_container || !g_idle_container || !g_scanning_container) return;
 
   switch (state) {
@@ -378,7 +584,6 @@ static void set_top_band_state(top_band_state_t state)
       lv_obj_add_flag(g_idle_container, LV_OBJ_FLAG_HIDDEN);
       lv_obj_clear_flag(g_duration_container, LV_OBJ_FLAG_HIDDEN);
       lv_obj_add_flag(g_scanning_container, LV_OBJ_FLAG_HIDDEN);
-      ui_bottom_button_set("Cancel", on_cancel_btn_click);
       for (lv_obj_t* btn : g_duration_buttons) {
         if (btn) {
           lv_obj_clear_flag(btn, LV_OBJ_FLAG_HIDDEN);
@@ -390,27 +595,37 @@ static void set_top_band_state(top_band_state_t state)
       lv_obj_add_flag(g_idle_container, LV_OBJ_FLAG_HIDDEN);
       lv_obj_clear_flag(g_scanning_container, LV_OBJ_FLAG_HIDDEN);
       lv_obj_add_flag(g_duration_container, LV_OBJ_FLAG_HIDDEN);
-      ui_bottom_button_set("Cancel", on_cancel_btn_click);
       break;
     case TOP_STATE_IDLE:
     default:
       lv_obj_clear_flag(g_idle_container, LV_OBJ_FLAG_HIDDEN);
       lv_obj_add_flag(g_duration_container, LV_OBJ_FLAG_HIDDEN);
       lv_obj_add_flag(g_scanning_container, LV_OBJ_FLAG_HIDDEN);
-      ui_bottom_button_restore();
       break;
   }
 }
 
-static void clear_device_list(void)
+static void set_status_text(const char* text)
 {
-  if (!g_device_list) return;
+  snprintf(g_status_text, sizeof(g_status_text), "%s", text);
+  if (!g_visible) {
+    g_deferred_updates++;
+    return;
+  }
+  if (g_status_label) {
+    ui_cell_label_set_text(g_status_label, g_status_text);
+  }
+}
 
-  lv_obj_clean(g_device_list);
-  g_empty_label = NULL;
-  memset(g_device_entries, 0, sizeof(g_device_entries));
-  create_empty_label();
-  refresh_empty_state();
+static void apply_scan_button_state(void)
+{
+  if (!g_ble_scan_button) return;
+
+  if (g_scan_active) {
+    lv_obj_add_state(g_ble_scan_button, LV_STATE_DISABLED);
+  } else {
+    lv_obj_clear_state(g_ble_scan_button, LV_STATE_DISABLED);
+  }
 }
 
 static void create_empty_label(void)
@@ -429,7 +644,8 @@ static ble_device_entry_t* find_entry_by_addr(const uint8_t* addr)
   if (!addr) return NULL;
 
   for (size_t i = 0; i < NETSEC_BLE_DEVICE_BUFFER_SIZE; ++i) {
-    if (g_device_entries[i].in_use && memcmp(g_device_entries[i].mac_bytes, addr, sizeof(g_device_entries[i].mac_bytes)) == 0) {
+    const ble_device_entry_t* entry = &g_device_entries[i];
+    if (entry->in_use && memcmp(entry->device.addr, addr, sizeof(entry->device.addr)) == 0) {
       return &g_device_entries[i];
     }
   }
@@ -439,59 +655,121 @@ static ble_device_entry_t* find_entry_by_addr(const uint8_t* addr)
 
 static ble_device_entry_t* allocate_entry(const uint8_t* addr)
 {
-  if (!g_device_list || !addr) return NULL;
+  if (!addr) return NULL;
 
+  // A free entry, else the device heard from longest ago gives up its row
+  ble_device_entry_t* entry = NULL;
+  const uint32_t now_ms = millis();
   for (size_t i = 0; i < NETSEC_BLE_DEVICE_BUFFER_SIZE; ++i) {
-    ble_device_entry_t* entry = &g_device_entries[i];
-    if (entry->in_use) continue;
+    ble_device_entry_t* candidate = &g_device_entries[i];
+    if (!candidate->in_use) {
+      entry = candidate;
+      break;
+    }
+    if (!entry || now_ms - candidate->device.last_seen_ms > now_ms - entry->device.last_seen_ms) {
+      entry = candidate;
+    }
+  }
 
-    memset(entry, 0, sizeof(*entry));
-    entry->in_use = true;
-    memcpy(entry->mac_bytes, addr, sizeof(entry->mac_bytes));
+  lv_obj_t* row = entry->row;
+  lv_obj_t* label = entry->label;
+  memset(entry, 0, sizeof(*entry));
+  entry->in_use = true;
+  entry->row = row;
+  entry->label = label;
+  memcpy(entry->device.addr, addr, sizeof(entry->device.addr));
+
+  // Hidden: the row is created by the rebuild step or the next reconcile
+  if (!entry->row && g_visible && g_device_list) {
+    create_device_row(entry);
+  }
+  return entry;
+}
 
-    entry->row = lv_obj_create(g_device_list);
-    lv_obj_set_size(entry->row, LV_PCT(100), LV_SIZE_CONTENT);
-    lv_obj_clear_flag(entry->row, LV_OBJ_FLAG_SCROLLABLE);
-    lv_obj_set_style_bg_color(entry->row, lv_color_hex(COLOR_CPC_BLUE), 0);
-    lv_obj_set_style_bg_opa(entry->row, LV_OPA_COVER, 0);
-    lv_obj_set_style_border_width(entry->row, 0, 0);
-    lv_obj_set_style_radius(entry->row, RADIUS_SMALL, 0);
-    lv_obj_set_style_pad_all(entry->row, PAD_SMALL, 0);
+static void create_device_row(ble_device_entry_t* entry)
+{
+  lvgl_heap_tag_t prev_tag = lvgl_heap_push_tag(LVGL_HEAP_TAG_LIST_ROW);
+  entry->row = lv_obj_create(g_device_list);
+  lv_obj_set_size(entry->row, LV_PCT(100), LV_SIZE_CONTENT);
+  lv_obj_clear_flag(entry->row, LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_set_style_bg_color(entry->row, lv_color_hex(COLOR_CPC_BLUE), 0);
+  lv_obj_set_style_bg_opa(entry->row, LV_OPA_COVER, 0);
+  lv_obj_set_style_border_width(entry->row, 0, 0);
+  lv_obj_set_style_radius(entry->row, RADIUS_SMALL, 0);
+  lv_obj_set_style_pad_all(entry->row, PAD_SMALL, 0);
+
+  entry->label = ui_cell_label_create(entry->row, BLE_ROW_COLS, 3);
+  lv_obj_add_style(entry->label, ui_get_style_label_normal(), 0);
+  lv_obj_set_style_text_color(entry->label, lv_color_hex(COLOR_CPC_YELLOW), 0);
+
+  update_device_row_text(entry);
+  lvgl_heap_pop_tag(prev_tag);
+  entry->dirty = false;
+  refresh_empty_state();
+}
 
-    entry->label = lv_label_create(entry->row);
-    lv_obj_add_style(entry->label, ui_get_style_label_normal(), 0);
-    lv_obj_set_style_text_color(entry->label, lv_color_hex(COLOR_CPC_YELLOW), 0);
-    lv_obj_set_width(entry->label, LV_PCT(100));
-    lv_label_set_long_mode(entry->label, LV_LABEL_LONG_WRAP);
+static void update_device_row_text(ble_device_entry_t* entry)
+{
+  if (!entry->label) return;
 
-    refresh_empty_state();
-    return entry;
+  const netsec_device_t* device = &entry->device;
+  const char* name = strlen(device->name) ? device->name : "(unknown)";
+  ui_cell_label_set_text_fmt(entry->label, "%s\n%02X:%02X:%02X:%02X:%02X:%02X\nRSSI: %d dBm | avg %d | x%lu",
+                             name, device->addr[0], device->addr[1], device->addr[2],
+                             device->addr[3], device->addr[4], device->addr[5],
+                             device->rssi, device->rssi_avg, static_cast<unsigned long>(device->seen_count));
+
+  // Not seen in the last days: accent border, restyled only on change
+  const lv_coord_t border = (device->flags & NETSEC_BLE_FLAG_NEW) ? 2 : 0;
+  if (lv_obj_get_style_border_width(entry->row, 0) != border) {
+    lv_obj_set_style_border_color(entry->row, lv_color_hex(COLOR_ACCENT), 0);
+    lv_obj_set_style_border_width(entry->row, border, 0);
   }
-
-  return NULL;
 }
 
-static void upsert_device_row(const netsec_ble_device_t* device)
+static void upsert_device_row(const netsec_device_t* device)
 {
-  if (!device || !g_device_list) return;
+  if (!device) return;
 
-  ble_device_entry_t* entry = find_entry_by_addr(device->mac_bytes);
+  ble_device_entry_t* entry = find_entry_by_addr(device->addr);
   if (!entry) {
-    entry = allocate_entry(device->mac_bytes);
+    entry = allocate_entry(device->addr);
   }
-  if (!entry || !entry->label) return;
+  if (!entry) return;
 
-  const char* mac = strlen(device->mac_str) ? device->mac_str : "--:--:--:--:--:--";
+  entry->device = *device;
+  if (!g_visible) {
+    entry->dirty = true;
+    g_deferred_updates++;
+    return;
+  }
+  update_device_row_text(entry);
 
-  const char* name = strlen(device->name) ? device->name : "(unknown)";
-  lv_label_set_text_fmt(entry->label, "%s\n%s\nRSSI: %d dBm", name, mac, device->rssi);
+  refresh_empty_state();
+}
+
+static void remove_device_row(const netsec_device_t* device)
+{
+  ble_device_entry_t* entry = find_entry_by_addr(device->addr);
+  if (!entry) return;   // Row already reused
 
+  entry->in_use = false;
+  entry->dirty = false;
+  if (!g_visible) {
+    g_deferred_updates++;   // Row deleted by the next reconcile
+    return;
+  }
+  if (entry->row) {
+    lv_obj_del(entry->row);
+    entry->row = NULL;
+    entry->label = NULL;
+  }
   refresh_empty_state();
 }
 
 static void refresh_empty_state(void)
 {
-  if (!g_empty_label || !g_device_list) return;
+  if (!g_visible || !g_empty_label || !g_device_list) return;
 
   const char* text = g_has_scanned ? "No BLE devices found." : "Press Scan to search for BLE devices.";
   lv_label_set_text(g_empty_label, text);
@@ -513,9 +791,25 @@ static void align_empty_label(void)
   lv_obj_align(g_empty_label, LV_ALIGN_CENTER, 0, 0);
 }
 
+static uint32_t scan_remaining_ms(void)
+{
+  if (!g_scan_active) return 0;
+  int32_t left = static_cast<int32_t>(g_scan_deadline_ms - millis());
+  return left > 0 ? static_cast<uint32_t>(left) : 0;
+}
+
+// Visible: tick every second for the countdown. Hidden: a single wake at the
+// deadline, which only serves the completion fallback.
+static void arm_scan_timer(void)
+{
+  uint32_t remaining = scan_remaining_ms();
+  uint32_t period = (g_visible && remaining > 1000) ? 1000 : remaining;
+  lv_timer_set_period(g_scan_timer, period ? period : 1);
+}
+
 static void start_scan_timer(uint32_t duration_ms)
 {
-  g_scan_remaining_ms = duration_ms;
+  g_scan_deadline_ms = millis() + duration_ms;
 
   if (!g_scan_timer) {
     g_scan_timer = lv_timer_create(scan_timer_cb, 1000, NULL);
@@ -523,7 +817,7 @@ static void start_scan_timer(uint32_t duration_ms)
     lv_timer_reset(g_scan_timer);
   }
 
-  lv_timer_set_period(g_scan_timer, 1000);
+  arm_scan_timer();
   lv_timer_resume(g_scan_timer);
 }
 
@@ -532,20 +826,21 @@ static void stop_scan_timer(void)
   if (g_scan_timer) {
     lv_timer_pause(g_scan_timer);
   }
-  g_scan_remaining_ms = 0;
+  g_scan_deadline_ms = millis();
   update_scan_status_label();
 }
 
 static void update_scan_status_label(void)
 {
-  if (!g_status_label) return;
-
   if (g_scan_active) {
-    if (g_scan_remaining_ms > 0) {
-      uint32_t remaining_s = (g_scan_remaining_ms + 999) / 1000;
-      lv_label_set_text_fmt(g_status_label, "Scanning (%lus)...", static_cast<unsigned long>(remaining_s));
+    uint32_t remaining_ms = scan_remaining_ms();
+    if (remaining_ms > 0) {
+      uint32_t remaining_s = (remaining_ms + 999) / 1000;
+      char text[BLE_STATUS_TEXT_MAX];
+      snprintf(text, sizeof(text), "Scanning (%lus)...", static_cast<unsigned long>(remaining_s));
+      set_status_text(text);
     } else {
-      lv_label_set_text(g_status_label, "Finishing scan...");
+      set_status_text("Finishing scan...");
     }
   }
 }
@@ -556,18 +851,18 @@ static void scan_timer_cb(lv_timer_t* timer)
 
   if (!g_scan_active) return;
 
-  if (g_scan_remaining_ms <= 1000) {
-    g_scan_remaining_ms = 0;
+  if (scan_remaining_ms() == 0) {
     stop_scan_timer();
-    update_scan_status_label();
     // Fallback: ensure UI exits scanning state even if NETSEC completion
     // event is delayed or lost.
     ui_post_event(UI_EVENT_BLE_SCAN_DONE);
     return;
   }
 
-  g_scan_remaining_ms -= 1000;
-  update_scan_status_label();
+  arm_scan_timer();
+  if (g_visible) {
+    update_scan_status_label();
+  }
 }
 
 static void fetch_local_mac(void)
@@ -591,3 +886,93 @@ static void update_title_mac_label(void)
   }
 }
 
+
+// One scan round of registry diffs: every device moves by more than the
+// registry's RSSI step, so each one is a CHANGED after the first round
+static void bench_feed_round(uint32_t round)
+{
+  netsec_device_t device;
+  for (uint32_t i = 0; i < BLE_BENCH_DEVICES; ++i) {
+    memset(&device, 0, sizeof(device));
+    device.kind = NETSEC_DEVICE_BLE;
+    const uint8_t addr[6] = { 0xC0, 0xBE, 0x4C, 0x00, 0x00, static_cast<uint8_t>(i) };
+    memcpy(device.addr, addr, sizeof(addr));
+    snprintf(device.name, sizeof(device.name), "bench-%02lu", static_cast<unsigned long>(i));
+    device.rssi = static_cast<int8_t>(-40 - static_cast<int32_t>((round * 7 + i * 3) % 50));
+    device.rssi_avg = device.rssi;
+    device.seen_count = round + 1;
+    device.last_seen_ms = millis();
+    ui_ble_handle_device(round ? NETSEC_RES_DEVICE_CHANGED : NETSEC_RES_DEVICE_ADDED, &device);
+  }
+}
+
+static void bench_clear(void)
+{
+  netsec_device_t device;
+  memset(&device, 0, sizeof(device));
+  device.kind = NETSEC_DEVICE_BLE;
+  for (uint32_t i = 0; i < BLE_BENCH_DEVICES; ++i) {
+    const uint8_t addr[6] = { 0xC0, 0xBE, 0x4C, 0x00, 0x00, static_cast<uint8_t>(i) };
+    memcpy(device.addr, addr, sizeof(addr));
+    ui_ble_handle_device(NETSEC_RES_DEVICE_GONE, &device);
+  }
+}
+
+void ui_ble_run_background_benchmark(void)
+{
+  lv_obj_t* prev = lv_scr_act();
+  lv_obj_t* screen = ui_screen_mgr_acquire(UI_SCREEN_BLE);
+  if (!screen || screen == prev) {
+    Serial.println("[UI] BLE background benchmark: start from another screen");
+    return;
+  }
+  lvgl_port_render_stats_t before, after;
+
+  // Shown: every diff writes its row, then the frame is rendered
+  ui_load_screen(screen);
+  lv_refr_now(NULL);
+  lvgl_port_get_render_stats(&before);
+  int64_t start = bench_clock_us();
+  for (uint32_t round = 0; round < BLE_BENCH_ROUNDS; ++round) {
+    bench_feed_round(round);
+    lv_refr_now(NULL);
+  }
+  uint32_t shown_us = static_cast<uint32_t>(bench_clock_us() - start);
+  lvgl_port_get_render_stats(&after);
+  uint32_t shown_px = after.px - before.px;
+  bench_clear();
+  lv_refr_now(NULL);
+
+  // Hidden: the diffs only touch the model; the frames rendered meanwhile
+  // belong to the other screen and cost the same with or without a scan
+  ui_load_screen(prev);
+  lv_refr_now(NULL);
+  start = bench_clock_us();
+  for (uint32_t round = 0; round < BLE_BENCH_ROUNDS; ++round) {
+    bench_feed_round(round);
+  }
+  uint32_t hidden_us = static_cast<uint32_t>(bench_clock_us() - start);
+
+  // Back on the screen: one reconcile pass and one frame
+  lvgl_port_get_render_stats(&before);
+  start = bench_clock_us();
+  ui_load_screen(screen);
+  lv_refr_now(NULL);
+  uint32_t reconcile_us = static_cast<uint32_t>(bench_clock_us() - start);
+  lvgl_port_get_render_stats(&after);
+  uint32_t reconcile_px = after.px - before.px;
+
+  bench_clear();
+  ui_load_screen(prev);
+  lv_refr_now(NULL);
+
+  const uint32_t background_us = hidden_us + reconcile_us;
+  Serial.printf("[UI] BLE background benchmark (%u devices x %u rounds): shown %lu us, %lu px; "
+                "hidden %lu us + reconcile %lu us, %lu px; %lu%% of the UI CPU saved\n",
+                BLE_BENCH_DEVICES, BLE_BENCH_ROUNDS,
+                static_cast<unsigned long>(shown_us), static_cast<unsigned long>(shown_px),
+                static_cast<unsigned long>(hidden_us), static_cast<unsigned long>(reconcile_us),
+                static_cast<unsigned long>(reconcile_px),
+                static_cast<unsigned long>(shown_us > background_us
+                                               ? 100ull * (shown_us - background_us) / shown_us : 0));
+}
@@ -0,0 +1,309 @@
+/*
+ * PIXEL - Cell Label Implementation
+ *
+ * LVGL 8.3 custom class derived from lv_obj: the grid is a cols * rows
+ * byte array (blank = ' '), drawn glyph by glyph in LV_EVENT_DRAW_MAIN and
+ * clipped to the refreshed area, so a one-cell invalidation only costs one
+ * glyph blend.
+ */
+
+#include "ui_cell_label.h"
+#include "ui_theme.h"
+#include "lvgl_port.h"
+#include "bench_clock.h"
+#include "lvgl.h"
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#define UI_CELL_LABEL_FMT_MAX  128
+#define UI_CELL_BENCH_UPDATES  60
+
+typedef struct {
+  lv_obj_t obj;
+  char* cells;
+  uint8_t cols;
+  uint8_t rows;
+  ui_cell_label_stats_t stats;
+} ui_cell_label_t;
+
+static void ui_cell_label_constructor(const lv_obj_class_t* class_p, lv_obj_t* obj);
+static void ui_cell_label_destructor(const lv_obj_class_t* class_p, lv_obj_t* obj);
+static void ui_cell_label_event(const lv_obj_class_t* class_p, lv_event_t* e);
+
+// Filled at first use: C++ here has no designated initializers for the class
+static lv_obj_class_t s_class;
+
+static const lv_obj_class_t* cell_label_class(void)
+{
+  if (!s_class.base_class) {
+    s_class.base_class = &lv_obj_class;
+    s_class.constructor_cb = ui_cell_label_constructor;
+    s_class.destructor_cb = ui_cell_label_destructor;
+    s_class.event_cb = ui_cell_label_event;
+    s_class.width_def = LV_SIZE_CONTENT;
+    s_class.height_def = LV_SIZE_CONTENT;
+    s_class.instance_size = sizeof(ui_cell_label_t);
+  }
+  return &s_class;
+}
+
+// Creation parameters, read by the constructor (UI task only)
+static uint8_t s_new_cols = 1;
+static uint8_t s_new_rows = 1;
+
+static void cell_size(const lv_obj_t* obj, lv_coord_t* w, lv_coord_t* h)
+{
+  const lv_font_t* font = lv_obj_get_style_text_font(obj, LV_PART_MAIN);
+  *w = static_cast<lv_coord_t>(lv_font_get_glyph_width(font, '0', 0) +
+                               lv_obj_get_style_text_letter_space(obj, LV_PART_MAIN));
+  *h = lv_font_get_line_height(font);
+}
+
+static void ui_cell_label_constructor(const lv_obj_class_t* class_p, lv_obj_t* obj)
+{
+  (void)class_p;
+  ui_cell_label_t* label = reinterpret_cast<ui_cell_label_t*>(obj);
+
+  label->cols = s_new_cols;
+  label->rows = s_new_rows;
+  label->cells = static_cast<char*>(lv_mem_alloc(static_cast<size_t>(label->cols) * label->rows));
+  if (label->cells) {
+    memset(label->cells, ' ', static_cast<size_t>(label->cols) * label->rows);
+  }
+  memset(&label->stats, 0, sizeof(label->stats));
+
+  lv_obj_clear_flag(obj, LV_OBJ_FLAG_CLICKABLE);
+  lv_obj_clear_flag(obj, LV_OBJ_FLAG_SCROLLABLE);
+}
+
+static void ui_cell_label_destructor(const lv_obj_class_t* class_p, lv_obj_t* obj)
+{
+  (void)class_p;
+  ui_cell_label_t* label = reinterpret_cast<ui_cell_label_t*>(obj);
+  lv_mem_free(label->cells);
+  label->cells = NULL;
+}
+
+static void draw_cells(lv_event_t* e)
+{
+  lv_obj_t* obj = lv_event_get_target(e);
+  ui_cell_label_t* label = reinterpret_cast<ui_cell_label_t*>(obj);
+  lv_draw_ctx_t* draw_ctx = lv_event_get_draw_ctx(e);
+  if (!label->cells) return;
+
+  lv_draw_label_dsc_t dsc;
+  lv_draw_label_dsc_init(&dsc);
+  lv_obj_init_draw_label_dsc(obj, LV_PART_MAIN, &dsc);
+
+  lv_coord_t cw, ch;
+  cell_size(obj, &cw, &ch);
+  lv_area_t content;
+  lv_obj_get_content_coords(obj, &content);
+
+  for (uint8_t r = 0; r < label->rows; ++r) {
+    lv_coord_t y = static_cast<lv_coord_t>(content.y1 + r * ch);
+    if (y > draw_ctx->clip_area->y2 || y + ch - 1 < draw_ctx->clip_area->y1) continue;
+
+    for (uint8_t c = 0; c < label->cols; ++c) {
+      char glyph = label->cells[r * label->cols + c];
+      if (glyph == ' ') continue;
+
+      lv_coord_t x = static_cast<lv_coord_t>(content.x1 + c * cw);
+      if (x > draw_ctx->clip_area->x2 || x + cw - 1 < draw_ctx->clip_area->x1) continue;
+
+      lv_coord_t gw = static_cast<lv_coord_t>(lv_font_get_glyph_width(dsc.font, static_cast<uint8_t>(glyph), 0));
+      lv_point_t pos = { static_cast<lv_coord_t>(x + (cw - gw) / 2), y };
+      lv_draw_letter(draw_ctx, &dsc, &pos, static_cast<uint8_t>(glyph));
+    }
+  }
+}
+
+static void ui_cell_label_event(const lv_obj_class_t* class_p, lv_event_t* e)
+{
+  (void)class_p;
+  if (lv_obj_event_base(cell_label_class(), e) != LV_RES_OK) return;
+
+  lv_event_code_t code = lv_event_get_code(e);
+  lv_obj_t* obj = lv_event_get_target(e);
+  ui_cell_label_t* label = reinterpret_cast<ui_cell_label_t*>(obj);
+
+  if (code == LV_EVENT_GET_SELF_SIZE) {
+    lv_point_t* size = static_cast<lv_point_t*>(lv_event_get_param(e));
+    lv_coord_t cw, ch;
+    cell_size(obj, &cw, &ch);
+    size->x = LV_MAX(size->x, static_cast<lv_coord_t>(cw * label->cols));
+    size->y = LV_MAX(size->y, static_cast<lv_coord_t>(ch * label->rows));
+  } else if (code == LV_EVENT_STYLE_CHANGED) {
+    // Font or spacing may have changed the cell size
+    lv_obj_refresh_self_size(obj);
+    lv_obj_invalidate(obj);
+  } else if (code == LV_EVENT_DRAW_MAIN) {
+    draw_cells(e);
+  }
+}
+
+lv_obj_t* ui_cell_label_create(lv_obj_t* parent, uint8_t cols, uint8_t rows)
+{
+  s_new_cols = cols ? cols : 1;
+  s_new_rows = rows ? rows : 1;
+
+  lv_obj_t* obj = lv_obj_class_create_obj(cell_label_class(), parent);
+  lv_obj_class_init_obj(obj);
+  return obj;
+}
+
+static void invalidate_run(lv_obj_t* obj, const lv_area_t* content, lv_coord_t cw, lv_coord_t ch,
+                           uint8_t row, uint8_t first, uint8_t last)
+{
+  ui_cell_label_t* label = reinterpret_cast<ui_cell_label_t*>(obj);
+  lv_area_t area;
+  area.x1 = static_cast<lv_coord_t>(content->x1 + first * cw);
+  area.x2 = static_cast<lv_coord_t>(content->x1 + (last + 1) * cw - 1);
+  area.y1 = static_cast<lv_coord_t>(content->y1 + row * ch);
+  area.y2 = static_cast<lv_coord_t>(area.y1 + ch - 1);
+  lv_obj_invalidate_area(obj, &area);
+
+  label->stats.px_invalidated += static_cast<uint32_t>((last - first + 1) * cw * ch);
+}
+
+void ui_cell_label_set_text(lv_obj_t* obj, const char* text)
+{
+  if (!obj || !lv_obj_check_type(obj, cell_label_class())) return;
+  ui_cell_label_t* label = reinterpret_cast<ui_cell_label_t*>(obj);
+  if (!label->cells) return;
+  if (!text) text = "";
+
+  lv_coord_t cw, ch;
+  cell_size(obj, &cw, &ch);
+  lv_area_t content;
+  lv_obj_get_content_coords(obj, &content);
+  label->stats.updates++;
+
+  const char* p = text;
+  for (uint8_t r = 0; r < label->rows; ++r) {
+    bool eol = false;
+    int16_t run = -1;   // First changed cell of the current run
+
+    for (uint8_t c = 0; c < label->cols; ++c) {
+      char glyph = ' ';
+      if (!eol && *p) {
+        if (*p == '\n') {
+          eol = true;
+        } else {
+          glyph = (*p >= ' ' && *p < 0x7F) ? *p : '?';
+          p++;
+        }
+      }
+
+      char* cell = &label->cells[r * label->cols + c];
+      if (*cell != glyph) {
+        *cell = glyph;
+        label->stats.cells_changed++;
+        if (run < 0) run = c;
+      } else if (run >= 0) {
+        invalidate_run(obj, &content, cw, ch, r, static_cast<uint8_t>(run), static_cast<uint8_t>(c - 1));
+        run = -1;
+      }
+    }
+    if (run >= 0) {
+      invalidate_run(obj, &content, cw, ch, r, static_cast<uint8_t>(run), static_cast<uint8_t>(label->cols - 1));
+    }
+
+    // A newline ends the row, also when the row was exactly full
+    if (*p == '\n') p++;
+  }
+}
+
+void ui_cell_label_set_text_fmt(lv_obj_t* obj, const char* fmt, ...)
+{
+  char text[UI_CELL_LABEL_FMT_MAX];
+  va_list args;
+  va_start(args, fmt);
+  vsnprintf(text, sizeof(text), fmt, args);
+  va_end(args);
+  ui_cell_label_set_text(obj, text);
+}
+
+void ui_cell_label_get_stats(const lv_obj_t* obj, ui_cell_label_stats_t* out)
+{
+  if (!out) return;
+  if (!obj || !lv_obj_check_type(obj, cell_label_class())) {
+    memset(out, 0, sizeof(*out));
+    return;
+  }
+  *out = reinterpret_cast<const ui_cell_label_t*>(obj)->stats;
+}
+
+// Push `updates` uptime strings through one widget; returns flushed px
+static uint32_t bench_run(lv_obj_t* obj, bool cell, uint32_t* elapsed_us)
+{
+  lvgl_port_render_stats_t before, after;
+  lv_refr_now(NULL);
+  lvgl_port_get_render_stats(&before);
+
+  int64_t t0 = bench_clock_us();
+  for (uint32_t i = 1; i <= UI_CELL_BENCH_UPDATES; ++i) {
+    uint32_t s = 3540U + i;   // Crosses a minute and an hour boundary
+    if (cell) {
+      ui_cell_label_set_text_fmt(obj, "UP: %02lu:%02lu:%02lu", (unsigned long)(s / 3600),
+                                 (unsigned long)((s % 3600) / 60), (unsigned long)(s % 60));
+    } else {
+      lv_label_set_text_fmt(obj, "UP: %02lu:%02lu:%02lu", (unsigned long)(s / 3600),
+                            (unsigned long)((s % 3600) / 60), (unsigned long)(s % 60));
+    }
+    lv_refr_now(NULL);
+  }
+  *elapsed_us = static_cast<uint32_t>(bench_clock_us() - t0);
+
+  lvgl_port_get_render_stats(&after);
+  return after.px - before.px;
+}
+
+void ui_cell_label_run_benchmark(void)
+{
+  lv_obj_t* prev = lv_scr_act();
+  lv_obj_t* scr = lv_obj_create(NULL);
+  lv_obj_set_style_bg_color(scr, lv_color_hex(COLOR_BACKGROUND), 0);
+
+  // Same setting as the uptime: translucent band, normal label style
+  lv_obj_t* band = lv_obj_create(scr);
+  lv_obj_set_size(band, LV_HOR_RES, BAND_HEIGHT);
+  lv_obj_set_style_bg_color(band, lv_color_hex(COLOR_SURFACE), 0);
+  lv_obj_set_style_bg_opa(band, LV_OPA_30, 0);
+  lv_obj_set_style_border_width(band, 0, 0);
+  lv_obj_clear_flag(band, LV_OBJ_FLAG_SCROLLABLE);
+  lv_scr_load(scr);
+
+  lv_obj_t* label = lv_label_create(band);
+  lv_obj_add_style(label, ui_get_style_label_normal(), 0);
+  lv_label_set_text(label, "UP: 00:59:00");
+  lv_obj_align(label, LV_ALIGN_LEFT_MID, 0, 0);
+  uint32_t label_us = 0;
+  uint32_t label_px = bench_run(label, false, &label_us);
+  lv_obj_del(label);
+
+  lv_obj_t* cells = ui_cell_label_create(band, 12, 1);
+  lv_obj_add_style(cells, ui_get_style_label_normal(), 0);
+  ui_cell_label_set_text(cells, "UP: 00:59:00");
+  lv_obj_align(cells, LV_ALIGN_LEFT_MID, 0, 0);
+  uint32_t cell_us = 0;
+  uint32_t cell_px = bench_run(cells, true, &cell_us);
+
+  ui_cell_label_stats_t st;
+  ui_cell_label_get_stats(cells, &st);
+
+  lv_scr_load(prev);
+  lv_obj_del(scr);
+
+  Serial.printf("[UI] Cell label benchmark (%u updates): lv_label %lu px/update %lu us/update, "
+                "cell label %lu px/update %lu us/update (%lu cells changed)\n",
+                UI_CELL_BENCH_UPDATES,
+                static_cast<unsigned long>(label_px / UI_CELL_BENCH_UPDATES),
+                static_cast<unsigned long>(label_us / UI_CELL_BENCH_UPDATES),
+                static_cast<unsigned long>(cell_px / UI_CELL_BENCH_UPDATES),
+                static_cast<unsigned long>(cell_us / UI_CELL_BENCH_UPDATES),
+                static_cast<unsigned long>(st.cells_changed));
+}
@@ -0,0 +1,425 @@
+/*
+ * PIXEL - Day/Night Wallpaper Tint Implementation
+ *
+ * Table layout: one 32-bit word per byte value holding the three output
+ * channels in 1/16 LSB, R at bit 21 (10 bits), G at bit 10 (11 bits), B at
+ * bit 0 (10 bits). The high byte of an RGB565 pixel carries R and the top
+ * of G, the low byte the bottom of G and B; the matrix is linear, so the
+ * two lookups add up to the full product without carries between fields
+ * (matrix rows sum to at most 256, terms are rounded down).
+ */
+
+#include "ui_daylight.h"
+#include "asset_map.h"
+#include "bench_clock.h"
+#include "deferred_log.h"
+#include "lvgl.h"
+
+#include <Arduino.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LUT_ENTRIES            512   // hi[256] then lo[256]
+#define DAYLIGHT_BENCH_W       240
+#define DAYLIGHT_BENCH_LINES   320
+#define DAYLIGHT_BENCH_BUILDS  16
+#define DAYLIGHT_OVERLAY_OPA   LV_OPA_50
+
+// Colour matrix in Q8: m[out][in], rows and columns in R, G, B order
+typedef struct {
+  uint16_t m[3][3];
+} tint_t;
+
+typedef struct {
+  uint32_t hi[256];
+  uint32_t lo[256];
+} lut_t;
+
+// Every row sums to 256 at most (see the file comment)
+static const tint_t k_phase_tint[UI_DAYLIGHT_PHASE_COUNT] = {
+  {{{40, 24, 8}, {24, 56, 16}, {24, 48, 88}}},      // Night: dark, blue, desaturated
+  {{{240, 16, 0}, {8, 208, 8}, {0, 24, 200}}},      // Dawn: soft pink
+  {{{256, 0, 0}, {0, 256, 0}, {0, 0, 256}}},        // Day: untouched
+  {{{236, 20, 0}, {10, 170, 0}, {0, 20, 120}}},     // Dusk: orange
+};
+
+// Phase start, minutes after midnight, in the order of the day
+static const struct {
+  uint16_t start;
+  ui_daylight_phase_t phase;
+} k_schedule[] = {
+  {6 * 60, UI_DAYLIGHT_DAWN},
+  {8 * 60, UI_DAYLIGHT_DAY},
+  {18 * 60 + 30, UI_DAYLIGHT_DUSK},
+  {21 * 60, UI_DAYLIGHT_NIGHT},
+};
+
+static const uint8_t k_ch_max[3] = {31, 63, 31};
+static const uint8_t k_ch_shift[3] = {21, 10, 0};
+
+static lut_t s_lut[2];
+static uint8_t s_front = 0;
+static bool s_identity = true;          // Front tables do nothing: skip the pass
+static tint_t s_shown = k_phase_tint[UI_DAYLIGHT_DAY];
+static ui_daylight_phase_t s_phase = UI_DAYLIGHT_DAY;
+
+// Transition in progress (s_step == 0: none)
+static tint_t s_from;
+static tint_t s_to;
+static tint_t s_building;
+static uint8_t s_step = 0;
+static uint16_t s_build_pos = 0;
+
+static lv_timer_t* s_timer = NULL;
+static lv_obj_t* s_img = NULL;
+static lv_img_decoder_t* s_decoder = NULL;
+static ui_daylight_stats_t s_stats;
+
+static inline uint32_t term(uint16_t coef, uint32_t in, uint8_t in_ch, uint8_t out_ch)
+{
+  return (coef * in * k_ch_max[out_ch] * 16U) / (256U * k_ch_max[in_ch]);
+}
+
+static void build_entries(lut_t* lut, const tint_t* tint, uint16_t from, uint16_t to)
+{
+  for (uint16_t i = from; i < to; ++i) {
+    uint32_t in_a, in_b;
+    uint8_t ch_a, ch_b;
+    if (i < 256) {
+      in_a = i >> 3;               // R
+      ch_a = 0;
+      in_b = (i & 0x07U) << 3;     // Top of G
+      ch_b = 1;
+    } else {
+      in_a = (i - 256U) >> 5;      // Bottom of G
+      ch_a = 1;
+      in_b = (i - 256U) & 0x1FU;   // B
+      ch_b = 2;
+    }
+
+    uint32_t w = 0;
+    for (uint8_t c = 0; c < 3; ++c) {
+      uint32_t v = term(tint->m[c][ch_a], in_a, ch_a, c) + term(tint->m[c][ch_b], in_b, ch_b, c);
+      w |= v << k_ch_shift[c];
+    }
+    if (i < 256) {
+      lut->hi[i] = w;
+    } else {
+      lut->lo[i - 256] = w;
+    }
+  }
+}
+
+static inline void apply_lut(const lut_t* lut, uint16_t* px, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; ++i) {
+    uint32_t w = lut->hi[px[i] >> 8] + lut->lo[px[i] & 0xFF];
+    px[i] = static_cast<uint16_t>(((w >> 14) & 0xF800U) | ((w >> 9) & 0x07E0U) | ((w >> 4) & 0x001FU));
+  }
+}
+
+static bool is_identity(const tint_t* tint)
+{
+  return memcmp(tint, &k_phase_tint[UI_DAYLIGHT_DAY], sizeof(*tint)) == 0;
+}
+
+static void lerp_tint(tint_t* out, const tint_t* from, const tint_t* to, uint8_t step)
+{
+  for (uint8_t r = 0; r < 3; ++r) {
+    for (uint8_t c = 0; c < 3; ++c) {
+      int32_t delta = static_cast<int32_t>(to->m[r][c]) - from->m[r][c];
+      out->m[r][c] = static_cast<uint16_t>(from->m[r][c] + delta * step / UI_DAYLIGHT_STEPS);
+    }
+  }
+}
+
+// Back tables are complete: show them
+static void swap_tables(const tint_t* tint)
+{
+  s_front ^= 1;
+  s_shown = *tint;
+  s_identity = is_identity(tint);
+  s_stats.tables++;
+  if (s_img) lv_obj_invalidate(s_img);
+}
+
+static void daylight_timer_cb(lv_timer_t* timer)
+{
+  if (!s_step) {
+    lv_timer_pause(timer);
+    return;
+  }
+
+  uint16_t end = s_build_pos + UI_DAYLIGHT_CHUNK;
+  if (end > LUT_ENTRIES) end = LUT_ENTRIES;
+  build_entries(&s_lut[s_front ^ 1], &s_building, s_build_pos, end);
+  s_build_pos = end;
+  if (end < LUT_ENTRIES) return;
+
+  swap_tables(&s_building);
+  if (s_step == UI_DAYLIGHT_STEPS) {
+    s_step = 0;
+    lv_timer_pause(timer);
+    return;
+  }
+  s_step++;
+  lerp_tint(&s_building, &s_from, &s_to, s_step);
+  s_build_pos = 0;
+}
+
+// ---------------------------------------------------------------------------
+// Decoder: the built-in one plus the lookup on every line
+// ---------------------------------------------------------------------------
+
+static bool is_wallpaper(const void* src)
+{
+  lv_img_src_t type = lv_img_src_get_type(src);
+  if (type == LV_IMG_SRC_VARIABLE) {
+    const char* name = asset_map_name(src);
+    return name && strncmp(name, UI_DAYLIGHT_ASSET_PREFIX, sizeof(UI_DAYLIGHT_ASSET_PREFIX) - 1) == 0;
+  }
+  if (type != LV_IMG_SRC_FILE) return false;
+  return strncmp(static_cast<const char*>(src), UI_DAYLIGHT_SRC_PREFIX, sizeof(UI_DAYLIGHT_SRC_PREFIX) - 1) == 0;
+}
+
+static lv_res_t decoder_info(lv_img_decoder_t* decoder, const void* src, lv_img_header_t* header)
+{
+  if (!is_wallpaper(src)) return LV_RES_INV;
+  return lv_img_decoder_built_in_info(decoder, src, header);
+}
+
+static lv_res_t decoder_open(lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* dsc)
+{
+  // Mapped wallpaper: draw in place when there is nothing to tint, else
+  // hand out lines copied from flash (no built-in state to open)
+  if (dsc->src_type == LV_IMG_SRC_VARIABLE) {
+    if (s_identity || dsc->header.cf != LV_IMG_CF_TRUE_COLOR) return LV_RES_INV;
+    dsc->img_data = NULL;
+    return LV_RES_OK;
+  }
+
+  lv_res_t res = lv_img_decoder_built_in_open(decoder, dsc);
+  if (res != LV_RES_OK) return res;
+
+  // Only line-by-line RGB565 goes through the lookup; anything else is
+  // left to the built-in decoder (drawn untinted rather than wrong)
+  if (dsc->img_data || dsc->header.cf != LV_IMG_CF_TRUE_COLOR) {
+    lv_img_decoder_built_in_close(decoder, dsc);
+    return LV_RES_INV;
+  }
+  return LV_RES_OK;
+}
+
+static lv_res_t decoder_read_line(lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* dsc, lv_coord_t x,
+                                  lv_coord_t y, lv_coord_t len, uint8_t* buf)
+{
+  lv_res_t res = LV_RES_OK;
+  if (dsc->src_type == LV_IMG_SRC_VARIABLE) {
+    const lv_img_dsc_t* img = static_cast<const lv_img_dsc_t*>(dsc->src);
+    uint32_t offset = (static_cast<uint32_t>(y) * img->header.w + static_cast<uint32_t>(x)) * sizeof(lv_color_t);
+    memcpy(buf, img->data + offset, static_cast<uint32_t>(len) * sizeof(lv_color_t));
+  } else {
+    res = lv_img_decoder_built_in_read_line(decoder, dsc, x, y, len, buf);
+  }
+  if (res == LV_RES_OK && !s_identity) {
+    apply_lut(&s_lut[s_front], reinterpret_cast<uint16_t*>(buf), static_cast<uint32_t>(len));
+    s_stats.lines++;
+    s_stats.px += static_cast<uint32_t>(len);
+  }
+  return res;
+}
+
+static void decoder_close(lv_img_decoder_t* decoder, lv_img_decoder_dsc_t* dsc)
+{
+  if (dsc->src_type == LV_IMG_SRC_VARIABLE) return;
+  lv_img_decoder_built_in_close(decoder, dsc);
+}
+
+// ---------------------------------------------------------------------------
+// API
+// ---------------------------------------------------------------------------
+
+void ui_daylight_init(void)
+{
+  if (s_decoder) return;
+
+  // Decoders are tried newest first: this one shadows the built-in for wallpapers
+  s_decoder = lv_img_decoder_create();
+  if (!s_decoder) {
+    Serial.println("[ERROR] PIXEL: Cannot create daylight decoder");
+    return;
+  }
+  lv_img_decoder_set_info_cb(s_decoder, decoder_info);
+  lv_img_decoder_set_open_cb(s_decoder, decoder_open);
+  lv_img_decoder_set_read_line_cb(s_decoder, decoder_read_line);
+  lv_img_decoder_set_close_cb(s_decoder, decoder_close);
+}
+
+void ui_daylight_attach(lv_obj_t* img)
+{
+  s_img = img;
+}
+
+ui_daylight_phase_t ui_daylight_phase_at(uint32_t minute_of_day)
+{
+  minute_of_day %= 24U * 60U;
+  ui_daylight_phase_t phase = UI_DAYLIGHT_NIGHT;   // Before dawn
+  for (size_t i = 0; i < sizeof(k_schedule) / sizeof(k_schedule[0]); ++i) {
+    if (minute_of_day >= k_schedule[i].start) phase = k_schedule[i].phase;
+  }
+  return phase;
+}
+
+void ui_daylight_set_phase(ui_daylight_phase_t phase, bool animate)
+{
+  if (phase >= UI_DAYLIGHT_PHASE_COUNT || phase == s_phase) return;
+
+  // One %s per deferred record: phases as numbers, the target named
+  DLOG_I("PIXEL: Daylight %d -> %d (%s)", s_phase, phase, ui_daylight_phase_name(phase));
+  s_phase = phase;
+  const tint_t* target = &k_phase_tint[phase];
+
+  if (!animate) {
+    s_step = 0;
+    if (s_timer) lv_timer_pause(s_timer);
+    build_entries(&s_lut[s_front ^ 1], target, 0, LUT_ENTRIES);
+    swap_tables(target);
+    return;
+  }
+
+  // Start from what is on screen, even halfway through another transition
+  s_from = s_shown;
+  s_to = *target;
+  s_step = 1;
+  lerp_tint(&s_building, &s_from, &s_to, s_step);
+  s_build_pos = 0;
+
+  if (!s_timer) {
+    s_timer = lv_timer_create(daylight_timer_cb, UI_DAYLIGHT_TICK_MS, NULL);
+  } else {
+    lv_timer_resume(s_timer);
+  }
+}
+
+ui_daylight_phase_t ui_daylight_get_phase(void)
+{
+  return s_phase;
+}
+
+void ui_daylight_apply(uint16_t* px, uint32_t count)
+{
+  if (!px || s_identity) return;
+  apply_lut(&s_lut[s_front], px, count);
+}
+
+const char* ui_daylight_phase_name(ui_daylight_phase_t phase)
+{
+  switch (phase) {
+    case UI_DAYLIGHT_NIGHT: return "night";
+    case UI_DAYLIGHT_DAWN:  return "dawn";
+    case UI_DAYLIGHT_DAY:   return "day";
+    case UI_DAYLIGHT_DUSK:  return "dusk";
+    default:                return "?";
+  }
+}
+
+void ui_daylight_get_stats(ui_daylight_stats_t* out)
+{
+  if (out) *out = s_stats;
+}
+
+// ---------------------------------------------------------------------------
+// Benchmark
+// ---------------------------------------------------------------------------
+
+// Exact matrix product on one channel, rounded down
+static uint32_t reference_channel(const tint_t* tint, uint8_t out_ch, uint32_t r, uint32_t g, uint32_t b)
+{
+  const uint16_t* row = tint->m[out_ch];
+  uint32_t num = row[0] * r * 63U + row[1] * g * 31U + row[2] * b * 63U;   // Over 31 * 63
+  return (num * k_ch_max[out_ch]) / (31U * 63U * 256U);
+}
+
+void ui_daylight_run_benchmark(void)
+{
+  lut_t* lut = static_cast<lut_t*>(malloc(sizeof(lut_t)));
+  if (!lut) {
+    Serial.println("[UI] Daylight benchmark: not enough heap");
+    return;
+  }
+
+  for (uint8_t p = 0; p < UI_DAYLIGHT_PHASE_COUNT; ++p) {
+    const tint_t* tint = &k_phase_tint[p];
+    build_entries(lut, tint, 0, LUT_ENTRIES);
+
+    uint32_t max_err = 0;
+    for (uint32_t c = 0; c < 65536U; ++c) {
+      uint16_t px = static_cast<uint16_t>(c);
+      apply_lut(lut, &px, 1);
+      uint32_t r = c >> 11, g = (c >> 5) & 0x3FU, b = c & 0x1FU;
+      int32_t err[3] = {
+        static_cast<int32_t>(px >> 11) - static_cast<int32_t>(reference_channel(tint, 0, r, g, b)),
+        static_cast<int32_t>((px >> 5) & 0x3F) - static_cast<int32_t>(reference_channel(tint, 1, r, g, b)),
+        static_cast<int32_t>(px & 0x1F) - static_cast<int32_t>(reference_channel(tint, 2, r, g, b)),
+      };
+      for (uint8_t k = 0; k < 3; ++k) {
+        uint32_t e = static_cast<uint32_t>(err[k] < 0 ? -err[k] : err[k]);
+        if (e > max_err) max_err = e;
+      }
+    }
+    Serial.printf("[UI] Daylight %s: max error %lu LSB over 65536 colours\n",
+                  ui_daylight_phase_name(static_cast<ui_daylight_phase_t>(p)), static_cast<unsigned long>(max_err));
+  }
+
+  int64_t start = bench_clock_us();
+  for (uint32_t i = 0; i < DAYLIGHT_BENCH_BUILDS; ++i) {
+    build_entries(lut, &k_phase_tint[i & 1 ? UI_DAYLIGHT_NIGHT : UI_DAYLIGHT_DUSK], 0, LUT_ENTRIES);
+  }
+  uint32_t build_us = static_cast<uint32_t>((bench_clock_us() - start) / DAYLIGHT_BENCH_BUILDS);
+
+  // One screen of wallpaper lines, same data for both passes
+  uint16_t line[DAYLIGHT_BENCH_W];
+  uint16_t work[DAYLIGHT_BENCH_W];
+  uint32_t seed = 0x2545F491u;
+  for (uint32_t i = 0; i < DAYLIGHT_BENCH_W; ++i) {
+    seed = seed * 1664525u + 1013904223u;
+    line[i] = static_cast<uint16_t>(seed >> 16);
+  }
+  const uint32_t total_px = DAYLIGHT_BENCH_W * DAYLIGHT_BENCH_LINES;
+  uint32_t sum_lut = 0;
+  uint32_t sum_overlay = 0;
+
+  build_entries(lut, &k_phase_tint[UI_DAYLIGHT_NIGHT], 0, LUT_ENTRIES);
+  start = bench_clock_us();
+  for (uint32_t y = 0; y < DAYLIGHT_BENCH_LINES; ++y) {
+    memcpy(work, line, sizeof(work));
+    apply_lut(lut, work, DAYLIGHT_BENCH_W);
+    sum_lut += work[y % DAYLIGHT_BENCH_W];
+  }
+  uint32_t lut_us = static_cast<uint32_t>(bench_clock_us() - start);
+
+  // What a semi-transparent night layer over the wallpaper costs in the
+  // software blender: one premultiplied mix per covered pixel
+  uint16_t premult[3];
+  lv_color_premult(lv_color_hex(0x101040), DAYLIGHT_OVERLAY_OPA, premult);
+  start = bench_clock_us();
+  for (uint32_t y = 0; y < DAYLIGHT_BENCH_LINES; ++y) {
+    memcpy(work, line, sizeof(work));
+    lv_color_t* c = reinterpret_cast<lv_color_t*>(work);
+    for (uint32_t x = 0; x < DAYLIGHT_BENCH_W; ++x) {
+      c[x] = lv_color_mix_premult(premult, c[x], LV_OPA_COVER - DAYLIGHT_OVERLAY_OPA);
+    }
+    sum_overlay += work[y % DAYLIGHT_BENCH_W];
+  }
+  uint32_t overlay_us = static_cast<uint32_t>(bench_clock_us() - start);
+  free(lut);
+
+  Serial.printf("[UI] Daylight %lu px: lookup %lu ns/px, overlay blend %lu ns/px | table build %lu us "
+                "(%lu us per %u-entry tick) | check %lx/%lx\n",
+                static_cast<unsigned long>(total_px),
+                static_cast<unsigned long>(static_cast<uint64_t>(lut_us) * 1000U / total_px),
+                static_cast<unsigned long>(static_cast<uint64_t>(overlay_us) * 1000U / total_px),
+                static_cast<unsigned long>(build_us),
+                static_cast<unsigned long>(build_us * UI_DAYLIGHT_CHUNK / LUT_ENTRIES), UI_DAYLIGHT_CHUNK,
+                static_cast<unsigned long>(sum_lut), static_cast<unsigned long>(sum_overlay));
+}
@@ -8,10 +8,19 @@
 #include "ui_screens.h"
 #include "ui_theme.h"
 #include "ui_api.h"
+#include "ui_screen_mgr.h"
+#include "ui_cell_label.h"
+#include "ui_pet.h"
+#include "ui_daylight.h"
+#include "pet_sim.h"
+#include "persist.h"
+#include "asset_map.h"
+#include "deferred_log.h"
 #include "lvgl.h"
 
 #include <Arduino.h>
 #include <stdio.h>
+#include <string.h>
 
 // Screen references
 static lv_obj_t* g_main_screen = NULL;
@@ -19,9 +28,33 @@ static lv_obj_t* g_active_screen = NULL;
 static lv_obj_t* g_label_uptime = NULL;
 static lv_obj_t* g_bg_img = NULL;
 static uint8_t g_bg_index = 1;
+#define WALLPAPER_COUNT 6
 static lv_obj_t* g_bottom_band = NULL;
 static lv_obj_t* g_bottom_button = NULL;
 static lv_obj_t* g_bottom_button_label = NULL;
+static lv_timer_t* g_wallpaper_timer = NULL;
+static lv_obj_t* g_label_status = NULL;
+
+// Pet simulation: real time, one decision every PET_SIM_STEP_MS
+#define PET_SIM_STEP_MS 5000
+static pet_sim_t g_pet_sim;
+static uint32_t g_pet_sim_last_ms = 0;
+static uint8_t g_pet_status_mood = 0xFF;
+static uint8_t g_pet_status_action = 0xFF;
+
+// The pet's own clock drives day and night: it was born at 08:00
+#define PET_BIRTH_MINUTE_OF_DAY (8U * 60U)
+
+// Blob kept by persist (bump the version whenever the layout changes)
+#define MAIN_SCREEN_SAVE_VERSION 1
+typedef struct {
+  uint8_t version;
+  uint8_t bg_index;
+  uint8_t reserved[2];
+  pet_sim_t pet;
+} main_screen_save_t;
+
+static_assert(sizeof(main_screen_save_t) <= PERSIST_PAYLOAD_MAX, "main screen state must fit one record");
 
 enum active_screen_state {
   UI_SCREEN_STATE_MAIN,
@@ -36,13 +69,18 @@ static lv_event_cb_t g_bottom_button_handler = NULL;
 // Forward declarations
 static void on_wifi_btn_click(lv_event_t* e);
 static void on_ble_btn_click(lv_event_t* e);
+static void on_game_btn_click(lv_event_t* e);
 static void on_menu_btn_click(lv_event_t* e);
 static void on_back_btn_click(lv_event_t* e);
 static void update_uptime_cb(lv_timer_t* timer);
 static void wallpaper_timer_cb(lv_timer_t* timer);
+static void pet_sim_timer_cb(lv_timer_t* timer);
 static void update_bottom_button(const char* label, lv_event_cb_t handler);
 static void dispatch_bottom_button(lv_event_t* e);
 static void apply_bottom_button_state(void);
+static bool restore_saved_state(void);
+static void save_state(void);
+static void set_wallpaper(uint8_t index);
 
 lv_obj_t* ui_create_main_screen(void)
 {
@@ -53,9 +91,15 @@ lv_obj_t* ui_create_main_screen(void)
   lv_obj_set_size(scr, LV_HOR_RES, LV_VER_RES);
   lv_obj_clear_flag(scr, LV_OBJ_FLAG_SCROLLABLE);
 
-  // Background image (binary format stored on S: driver)
+  // Pet and wallpaper as they were before the last reboot, if saved
+  bool restored = restore_saved_state();
+
+  // Background image (mapped flash, else binary file on the S: driver)
+  // Tinted for the time of day while it is decoded (no overlay layer)
+  ui_daylight_init();
   g_bg_img = lv_img_create(scr);
-  lv_img_set_src(g_bg_img, "S:/img/bg_1.bin");
+  set_wallpaper(g_bg_index);
+  ui_daylight_attach(g_bg_img);
   lv_obj_set_pos(g_bg_img, 0, 0);
 
   // === TOP BUTTON BAND ===
@@ -92,19 +136,26 @@ lv_obj_t* ui_create_main_screen(void)
   lv_obj_center(label_ble);
   lv_obj_add_style(label_ble, ui_get_style_label_normal(), 0);
   lv_obj_set_style_text_color(label_ble, lv_color_hex(COLOR_TEXT), 0);
+
+  // Mini-game button
+  lv_obj_t* btn_game = lv_btn_create(band_top);
+  lv_obj_set_size(btn_game, 40, 30);
+  lv_obj_add_style(btn_game, ui_get_style_btn_primary(), 0);
+  lv_obj_add_event_cb(btn_game, on_game_btn_click, LV_EVENT_CLICKED, NULL);
+
+  lv_obj_t* label_game = lv_label_create(btn_game);
+  lv_label_set_text(label_game, "Play");
+  lv_obj_center(label_game);
+  lv_obj_add_style(label_game, ui_get_style_label_normal(), 0);
+  lv_obj_set_style_text_color(label_game, lv_color_hex(COLOR_TEXT), 0);
   
   // === CENTRAL PET AREA ===
   int pet_start_y = BAND_HEIGHT + PAD_LARGE;
 
-  // Pet label floating on black background
-  lv_obj_t* label_pet = lv_label_create(scr);
-  lv_label_set_text(label_pet, "( 0_0 )");
-  lv_obj_set_width(label_pet, LV_HOR_RES);
-  lv_obj_set_style_text_align(label_pet, LV_TEXT_ALIGN_CENTER, 0);
-  // Swap to a monospace font here if enabled in lv_conf.h for perfect ASCII alignment.
-  lv_obj_set_style_text_font(label_pet, &lv_font_unscii_16, 0);
-  lv_obj_add_style(label_pet, ui_get_style_label_title(), 0);
-  lv_obj_align(label_pet, LV_ALIGN_TOP_MID, 0, pet_start_y);
+  // Animated pet floating on the wallpaper (timer-driven, dirty rects only)
+  lv_obj_t* pet = ui_pet_create(scr);
+  lv_obj_set_size(pet, LV_HOR_RES, MAIN_SCREEN_PET_SIZE);
+  lv_obj_set_pos(pet, 0, pet_start_y);
 
   // Status info bar (pet name, health, etc.)
   int status_y = pet_start_y + MAIN_SCREEN_PET_SIZE + PAD_NORMAL;
@@ -122,14 +173,14 @@ lv_obj_t* ui_create_main_screen(void)
     label_status_bg_style_inited = true;
   }
 
-  lv_obj_t* label_status = lv_label_create(scr);
-  lv_label_set_text(label_status, "Acyd | Health: 100% | Mood: :) ");
-  lv_obj_set_pos(label_status, PAD_NORMAL, status_y);
-  lv_obj_set_width(label_status, LV_HOR_RES - 2 * PAD_NORMAL);
-  lv_label_set_long_mode(label_status, LV_LABEL_LONG_WRAP);
-  lv_obj_add_style(label_status, ui_get_style_label_normal(), 0);
-  lv_obj_add_style(label_status, &label_status_bg_style, 0);
-  lv_obj_set_style_text_color(label_status, lv_color_hex(COLOR_TEXT), 0);
+  g_label_status = lv_label_create(scr);
+  lv_label_set_text(g_label_status, "Acyd | Mood: --");
+  lv_obj_set_pos(g_label_status, PAD_NORMAL, status_y);
+  lv_obj_set_width(g_label_status, LV_HOR_RES - 2 * PAD_NORMAL);
+  lv_label_set_long_mode(g_label_status, LV_LABEL_LONG_WRAP);
+  lv_obj_add_style(g_label_status, ui_get_style_label_normal(), 0);
+  lv_obj_add_style(g_label_status, &label_status_bg_style, 0);
+  lv_obj_set_style_text_color(g_label_status, lv_color_hex(COLOR_TEXT), 0);
   
   // === BOTTOM BUTTON BAND ===
   int band_bottom_y = LV_VER_RES - BAND_HEIGHT;
@@ -145,16 +196,13 @@ lv_obj_t* ui_create_main_screen(void)
   lv_obj_set_flex_align(g_bottom_band, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
   lv_obj_clear_flag(g_bottom_band, LV_OBJ_FLAG_SCROLLABLE);
 
-  // Uptime label
-  g_label_uptime = lv_label_create(g_bottom_band);
-  lv_label_set_text(g_label_uptime, "UP: 00:00:00");
-  lv_label_set_long_mode(g_label_uptime, LV_LABEL_LONG_CLIP);
+  // Uptime label: cell grid, the seconds tick repaints one glyph
+  g_label_uptime = ui_cell_label_create(g_bottom_band, 12, 1);
   lv_obj_add_style(g_label_uptime, ui_get_style_label_normal(), 0);
   lv_obj_set_style_text_color(g_label_uptime, lv_color_hex(COLOR_TEXT), 0);
-  lv_obj_set_style_text_align(g_label_uptime, LV_TEXT_ALIGN_LEFT, 0);
   lv_obj_set_style_pad_left(g_label_uptime, PAD_SMALL, 0);
-  lv_obj_set_width(g_label_uptime, LV_SIZE_CONTENT);
   lv_obj_set_flex_grow(g_label_uptime, 1);
+  ui_cell_label_set_text(g_label_uptime, "UP: 00:00:00");
 
   // Menu button
   g_bottom_button = lv_btn_create(g_bottom_band);
@@ -172,7 +220,18 @@ lv_obj_t* ui_create_main_screen(void)
   g_active_screen = scr;
 
   lv_timer_create(update_uptime_cb, 1000, NULL);
-  lv_timer_create(wallpaper_timer_cb, 30000, NULL);
+  g_wallpaper_timer = lv_timer_create(wallpaper_timer_cb, 30000, NULL);
+
+  if (restored) {
+    DLOG_I("PIXEL: Pet restored (day %u, mood %u%%)", g_pet_sim.minutes / (24U * 60U),
+           pet_sim_mood(&g_pet_sim) * 100U / PET_SIM_ONE);
+  } else {
+    pet_sim_init(&g_pet_sim);
+  }
+  ui_daylight_set_phase(ui_daylight_phase_at(g_pet_sim.minutes + PET_BIRTH_MINUTE_OF_DAY), false);
+  g_pet_sim_last_ms = millis();
+  ui_main_screen_pet_step();
+  lv_timer_create(pet_sim_timer_cb, PET_SIM_STEP_MS, NULL);
 
   Serial.println("PIXEL: Main screen created");
   return scr;
@@ -182,28 +241,35 @@ lv_obj_t* ui_create_main_screen(void)
 static void on_wifi_btn_click(lv_event_t* e)
 {
   (void)e;
-  Serial.println("PIXEL: WiFi button clicked");
+  DLOG_I("PIXEL: WiFi button clicked");
   ui_post_event(UI_EVENT_BUTTON_WIFI);
 }
 
 static void on_ble_btn_click(lv_event_t* e)
 {
   (void)e;
-  Serial.println("PIXEL: BLE button clicked");
+  DLOG_I("PIXEL: BLE button clicked");
   ui_post_event(UI_EVENT_BUTTON_BLE);
 }
 
+static void on_game_btn_click(lv_event_t* e)
+{
+  (void)e;
+  DLOG_I("PIXEL: Game button clicked");
+  ui_post_event(UI_EVENT_BUTTON_GAME);
+}
+
 static void on_menu_btn_click(lv_event_t* e)
 {
   (void)e;
-  Serial.println("PIXEL: Menu button clicked");
+  DLOG_I("PIXEL: Menu button clicked");
   ui_post_event(UI_EVENT_BUTTON_MENU);
 }
 
 static void on_back_btn_click(lv_event_t* e)
 {
   (void)e;
-  Serial.println("PIXEL: Back button clicked");
+  DLOG_I("PIXEL: Back button clicked");
   ui_show_main_screen();
 }
 
@@ -219,7 +285,8 @@ static void update_uptime_cb(lv_timer_t* timer)
   uint32_t minutes = (total_seconds % 3600) / 60;
   uint32_t seconds = total_seconds % 60;
 
-  lv_label_set_text_fmt(g_label_uptime, "UP: %02lu:%02lu:%02lu", hours, minutes, seconds);
+  ui_cell_label_set_text_fmt(g_label_uptime, "UP: %02lu:%02lu:%02lu",
+                             (unsigned long)hours, (unsigned long)minutes, (unsigned long)seconds);
 }
 
 static void wallpaper_timer_cb(lv_timer_t* timer)
@@ -229,16 +296,103 @@ static void wallpaper_timer_cb(lv_timer_t* timer)
   if (!g_bg_img) return;
 
   g_bg_index++;
-  if (g_bg_index > 6) {
+  if (g_bg_index > WALLPAPER_COUNT) {
     g_bg_index = 1;
   }
 
+  set_wallpaper(g_bg_index);
+  save_state();
+}
+
+static void set_wallpaper(uint8_t index)
+{
+  char name[16];
+  snprintf(name, sizeof(name), "bg_%u", index);
+
+  // Zero-copy from the asset partition when it is flashed
+  const lv_img_dsc_t* dsc = asset_map_find(name);
+  if (dsc) {
+    DLOG_I("PIXEL: Wallpaper %s (mapped)", name);
+    lv_img_set_src(g_bg_img, dsc);
+    return;
+  }
+
   char path[32];
-  sprintf(path, "S:/img/bg_%d.bin", g_bg_index);
-  Serial.printf("PIXEL: Changing wallpaper to %s\n", path);
+  snprintf(path, sizeof(path), "S:/img/%s.bin", name);
+  DLOG_I("PIXEL: Wallpaper %s", path);
   lv_img_set_src(g_bg_img, path);
 }
 
+static bool restore_saved_state(void)
+{
+  main_screen_save_t saved;
+  if (persist_load(&saved, sizeof(saved)) != sizeof(saved)) return false;
+  if (saved.version != MAIN_SCREEN_SAVE_VERSION) return false;
+  if (saved.bg_index < 1 || saved.bg_index > WALLPAPER_COUNT) return false;
+  if (saved.pet.action >= PET_ACTION_COUNT) return false;
+
+  g_bg_index = saved.bg_index;
+  memcpy(&g_pet_sim, &saved.pet, sizeof(g_pet_sim));
+  return true;
+}
+
+// Cheap: persist only copies the blob, flash is written once per debounce window
+static void save_state(void)
+{
+  main_screen_save_t saved;
+  memset(&saved, 0, sizeof(saved));   // Padding too: identical states compare equal
+  saved.version = MAIN_SCREEN_SAVE_VERSION;
+  saved.bg_index = g_bg_index;
+  memcpy(&saved.pet, &g_pet_sim, sizeof(saved.pet));
+  persist_save(&saved, sizeof(saved));
+}
+
+static pet_state_t anim_for_action(pet_action_t action)
+{
+  switch (action) {
+    case PET_ACTION_EAT:   return PET_STATE_EAT;
+    case PET_ACTION_SLEEP: return PET_STATE_SLEEP;
+    case PET_ACTION_PLAY:  return PET_STATE_REACT;
+    default:               return PET_STATE_IDLE;
+  }
+}
+
+void ui_main_screen_pet_step(void)
+{
+  uint32_t now = millis();
+  pet_sim_advance(&g_pet_sim, now - g_pet_sim_last_ms);
+  g_pet_sim_last_ms = now;
+
+  uint8_t previous = g_pet_sim.action;
+  pet_action_t action = pet_sim_decide(&g_pet_sim, NULL);
+  pet_sim_apply(&g_pet_sim, action);
+
+  // Animations only follow changes: eat / react play once, then idle
+  if (action != previous) {
+    DLOG_I("PIXEL: Pet does %s", pet_sim_action_name(action));
+    ui_pet_set_state(anim_for_action(action));
+  }
+
+  uint8_t mood = static_cast<uint8_t>(pet_sim_mood(&g_pet_sim) * 100U / PET_SIM_ONE);
+  if (g_label_status && (mood != g_pet_status_mood || action != g_pet_status_action)) {
+    lv_label_set_text_fmt(g_label_status, "Acyd | Mood: %u%% | %s", mood,
+                          g_pet_sim.asleep ? "zzz" : pet_sim_action_name(action));
+    g_pet_status_mood = mood;
+    g_pet_status_action = static_cast<uint8_t>(action);
+  }
+
+  // Phase changes fade in over a few ticks; same phase is a no-op
+  ui_daylight_set_phase(ui_daylight_phase_at(g_pet_sim.minutes + PET_BIRTH_MINUTE_OF_DAY), true);
+
+  save_state();
+}
+
+static void pet_sim_timer_cb(lv_timer_t* timer)
+{
+  (void)timer;
+  ui_main_screen_pet_step();
+}
+
 // Screen management
 void ui_load_screen(lv_obj_t* screen)
 {
@@ -246,9 +400,21 @@ void ui_load_screen(lv_obj_t* screen)
   
   lv_disp_t* disp = lv_disp_get_default();
   if (disp) {
+    lv_obj_t* prev = g_active_screen;
     lv_disp_load_scr(screen);
     g_active_screen = screen;
-    Serial.println("PIXEL: Screen loaded");
+
+    // Wallpaper is only seen on the main screen (the uptime band is on layer_top)
+    if (g_wallpaper_timer) {
+      if (screen == g_main_screen) {
+        lv_timer_resume(g_wallpaper_timer);
+      } else {
+        lv_timer_pause(g_wallpaper_timer);
+      }
+    }
+    ui_pet_set_active(screen == g_main_screen);
+    ui_screen_mgr_screen_changed(prev, screen);
+    DLOG_I("PIXEL: Screen loaded");
   }
 }
 
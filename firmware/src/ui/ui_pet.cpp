@@ -0,0 +1,270 @@
+/*
+ * PIXEL - Pet Widget Implementation
+ *
+ * Plain lv_obj with a DRAW_MAIN handler: ASCII frames go glyph by glyph
+ * (UNSCII 16, fixed 8x16 cells), sprite frames as one filled rect per run
+ * of lit pixels, both clipped to the refreshed area.
+ */
+
+#include "ui_pet.h"
+#include "ui_theme.h"
+#include "lvgl_port.h"
+#include "deferred_log.h"
+#include "lvgl.h"
+
+#include <Arduino.h>
+#include <string.h>
+
+// Budget re-evaluation period and longest timer period
+#define UI_PET_BUDGET_WINDOW_MS 1000U
+#define UI_PET_POLL_MS          500U
+
+static lv_obj_t* s_obj = NULL;
+static lv_timer_t* s_timer = NULL;
+static pet_anim_t s_anim;
+static ui_pet_stats_t s_stats;
+static uint32_t s_last_tick = 0;
+
+static uint32_t s_budget_start = 0;
+static lvgl_port_render_stats_t s_budget_render;
+
+// Top-left of the home box in screen coordinates
+static void home_origin(lv_coord_t* x, lv_coord_t* y)
+{
+  lv_area_t content;
+  lv_obj_get_content_coords(s_obj, &content);
+  *x = static_cast<lv_coord_t>(content.x1 + (lv_area_get_width(&content) - PET_BOX_W) / 2);
+  *y = static_cast<lv_coord_t>(content.y1 + (lv_area_get_height(&content) - PET_BOX_H) / 2);
+}
+
+static void draw_ascii(lv_draw_ctx_t* draw_ctx, lv_draw_label_dsc_t* dsc, const char* cells,
+                       lv_coord_t x0, lv_coord_t y0)
+{
+  const lv_area_t* clip = draw_ctx->clip_area;
+
+  for (uint8_t r = 0; r < PET_ASCII_ROWS; ++r) {
+    lv_coord_t y = static_cast<lv_coord_t>(y0 + r * PET_CELL_H);
+    if (y > clip->y2 || y + PET_CELL_H - 1 < clip->y1) continue;
+
+    for (uint8_t c = 0; c < PET_ASCII_COLS; ++c) {
+      char glyph = cells[r * PET_ASCII_COLS + c];
+      if (glyph == ' ') continue;
+
+      lv_coord_t x = static_cast<lv_coord_t>(x0 + c * PET_CELL_W);
+      if (x > clip->x2 || x + PET_CELL_W - 1 < clip->x1) continue;
+
+      lv_point_t pos = { x, y };
+      lv_draw_letter(draw_ctx, dsc, &pos, static_cast<uint8_t>(glyph));
+    }
+  }
+}
+
+static void draw_sprite(lv_draw_ctx_t* draw_ctx, const uint16_t* rows, lv_coord_t x0, lv_coord_t y0)
+{
+  const lv_area_t* clip = draw_ctx->clip_area;
+  const lv_coord_t px = PET_SPRITE_SIZE * PET_SPRITE_SCALE;
+
+  lv_draw_rect_dsc_t dsc;
+  lv_draw_rect_dsc_init(&dsc);
+  dsc.bg_color = lv_color_hex(COLOR_ACCENT);
+  dsc.bg_opa = LV_OPA_COVER;
+
+  x0 = static_cast<lv_coord_t>(x0 + (PET_BOX_W - px) / 2);
+  for (uint8_t r = 0; r < PET_SPRITE_SIZE; ++r) {
+    lv_area_t area;
+    area.y1 = static_cast<lv_coord_t>(y0 + r * PET_SPRITE_SCALE);
+    area.y2 = static_cast<lv_coord_t>(area.y1 + PET_SPRITE_SCALE - 1);
+    if (!rows[r] || area.y1 > clip->y2 || area.y2 < clip->y1) continue;
+
+    uint8_t c = 0;
+    while (c < PET_SPRITE_SIZE) {
+      if (!(rows[r] & (0x8000U >> c))) {
+        c++;
+        continue;
+      }
+      uint8_t start = c;
+      while (c < PET_SPRITE_SIZE && (rows[r] & (0x8000U >> c))) c++;
+
+      area.x1 = static_cast<lv_coord_t>(x0 + start * PET_SPRITE_SCALE);
+      area.x2 = static_cast<lv_coord_t>(x0 + c * PET_SPRITE_SCALE - 1);
+      if (area.x1 <= clip->x2 && area.x2 >= clip->x1) lv_draw_rect(draw_ctx, &dsc, &area);
+    }
+  }
+}
+
+static void pet_draw_cb(lv_event_t* e)
+{
+  lv_obj_t* obj = lv_event_get_target(e);
+  lv_draw_ctx_t* draw_ctx = lv_event_get_draw_ctx(e);
+
+  lv_coord_t x0, y0;
+  home_origin(&x0, &y0);
+  x0 = static_cast<lv_coord_t>(x0 + pet_anim_x(&s_anim));
+
+  const pet_frame_t* frame = pet_anim_frame(&s_anim);
+  if (frame->kind == PET_FRAME_ASCII) {
+    lv_draw_label_dsc_t dsc;
+    lv_draw_label_dsc_init(&dsc);
+    lv_obj_init_draw_label_dsc(obj, LV_PART_MAIN, &dsc);
+    draw_ascii(draw_ctx, &dsc, frame->ascii, x0, y0);
+  } else {
+    draw_sprite(draw_ctx, frame->sprite, x0, y0);
+  }
+}
+
+static void pet_clicked_cb(lv_event_t* e)
+{
+  (void)e;
+  ui_pet_set_state(PET_STATE_REACT);
+}
+
+static void pet_delete_cb(lv_event_t* e)
+{
+  (void)e;
+  if (s_timer) lv_timer_del(s_timer);
+  s_timer = NULL;
+  s_obj = NULL;
+}
+
+// Movement tick from the last window's average render time
+static void update_budget(uint32_t now)
+{
+  if (lv_tick_elaps(s_budget_start) < UI_PET_BUDGET_WINDOW_MS) return;
+
+  lvgl_port_render_stats_t render;
+  lvgl_port_get_render_stats(&render);
+  uint32_t frames = render.frames - s_budget_render.frames;
+  if (frames) {
+    uint32_t tick = (render.render_ms - s_budget_render.render_ms) * UI_PET_BUDGET_FACTOR / frames;
+    if (tick < UI_PET_TICK_MIN_MS) tick = UI_PET_TICK_MIN_MS;
+    if (tick > UI_PET_TICK_MAX_MS) tick = UI_PET_TICK_MAX_MS;
+    s_stats.tick_ms = static_cast<uint16_t>(tick);
+  }
+  s_budget_render = render;
+  s_budget_start = now;
+}
+
+// Advance the engine, invalidate what changed, schedule the next wakeup
+static void step(uint32_t delta_ms)
+{
+  if (!s_obj) return;
+
+  pet_rect_t dirty[PET_ANIM_MAX_RECTS];
+  uint32_t frames_before = s_anim.stats.frames;
+  uint8_t n = pet_anim_advance(&s_anim, delta_ms, dirty);
+  s_stats.ticks++;
+  s_stats.frames += s_anim.stats.frames - frames_before;
+
+  if (n) {
+    lv_coord_t x0, y0;
+    home_origin(&x0, &y0);
+    for (uint8_t i = 0; i < n; ++i) {
+      lv_area_t area;
+      area.x1 = static_cast<lv_coord_t>(x0 + dirty[i].x);
+      area.y1 = static_cast<lv_coord_t>(y0 + dirty[i].y);
+      area.x2 = static_cast<lv_coord_t>(area.x1 + dirty[i].w - 1);
+      area.y2 = static_cast<lv_coord_t>(area.y1 + dirty[i].h - 1);
+      lv_obj_invalidate_area(s_obj, &area);
+      s_stats.px_invalidated += static_cast<uint32_t>(dirty[i].w) * static_cast<uint32_t>(dirty[i].h);
+    }
+    s_stats.rects += n;
+  }
+
+  if (s_timer) {
+    uint32_t period = pet_anim_ms_to_next_frame(&s_anim);
+    if (pet_anim_is_moving(&s_anim) && period > s_stats.tick_ms) period = s_stats.tick_ms;
+    if (period > UI_PET_POLL_MS) period = UI_PET_POLL_MS;
+    lv_timer_set_period(s_timer, period ? period : 1);
+    lv_timer_reset(s_timer);
+  }
+}
+
+static void pet_timer_cb(lv_timer_t* timer)
+{
+  (void)timer;
+  uint32_t now = lv_tick_get();
+  uint32_t delta = lv_tick_elaps(s_last_tick);
+  s_last_tick = now;
+
+  update_budget(now);
+  step(delta);
+}
+
+lv_obj_t* ui_pet_create(lv_obj_t* parent)
+{
+  lv_obj_t* obj = lv_obj_create(parent);
+  lv_obj_remove_style_all(obj);
+  lv_obj_add_style(obj, ui_get_style_label_title(), 0);
+  // The engine's cells are UNSCII 16 whatever the title font is
+  lv_obj_set_style_text_font(obj, &lv_font_unscii_16, 0);
+  lv_obj_clear_flag(obj, LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_add_flag(obj, LV_OBJ_FLAG_CLICKABLE);
+
+  lv_obj_add_event_cb(obj, pet_draw_cb, LV_EVENT_DRAW_MAIN, NULL);
+  lv_obj_add_event_cb(obj, pet_clicked_cb, LV_EVENT_CLICKED, NULL);
+  lv_obj_add_event_cb(obj, pet_delete_cb, LV_EVENT_DELETE, NULL);
+
+  s_obj = obj;
+  pet_anim_init(&s_anim);
+  memset(&s_stats, 0, sizeof(s_stats));
+  s_stats.tick_ms = UI_PET_TICK_MIN_MS;
+
+  s_last_tick = lv_tick_get();
+  s_budget_start = s_last_tick;
+  lvgl_port_get_render_stats(&s_budget_render);
+  s_timer = lv_timer_create(pet_timer_cb, pet_anim_ms_to_next_frame(&s_anim), NULL);
+
+  DLOG_I("PIXEL: Pet created (%u px box, tick %u..%u ms)", PET_BOX_W, UI_PET_TICK_MIN_MS, UI_PET_TICK_MAX_MS);
+  return obj;
+}
+
+void ui_pet_set_state(pet_state_t state)
+{
+  if (!s_obj || state >= PET_STATE_COUNT) return;
+
+  // Bring the current state up to now, then draw the new first frame
+  // immediately rather than at the next wakeup
+  uint32_t now = lv_tick_get();
+  uint32_t delta = lv_tick_elaps(s_last_tick);
+  s_last_tick = now;
+  step(delta);
+
+  pet_state_t prev = s_anim.state;
+  pet_anim_set_state(&s_anim, state);
+  // One %s per deferred record: states as numbers, the new one named
+  if (s_anim.state != prev) DLOG_I("PIXEL: Pet %d -> %d (%s)", prev, state, pet_anim_state_name(state));
+  step(0);
+}
+
+pet_state_t ui_pet_get_state(void)
+{
+  return s_anim.state;
+}
+
+void ui_pet_advance(uint32_t delta_ms)
+{
+  // delta_ms stands for the time since the last step: the timer counts
+  // from now, or that interval would be played twice
+  s_last_tick = lv_tick_get();
+  step(delta_ms);
+}
+
+void ui_pet_set_active(bool active)
+{
+  if (!s_timer) return;
+
+  if (active) {
+    // Hidden time does not count: resume where the pet was left
+    s_last_tick = lv_tick_get();
+    s_budget_start = s_last_tick;
+    lvgl_port_get_render_stats(&s_budget_render);
+    lv_timer_resume(s_timer);
+  } else {
+    lv_timer_pause(s_timer);
+  }
+}
+
+void ui_pet_get_stats(ui_pet_stats_t* out)
+{
+  if (out) *out = s_stats;
+}
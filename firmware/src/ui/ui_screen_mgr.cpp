@@ -0,0 +1,337 @@
+/*
+ * PIXEL - Screen Lifecycle Manager
+ *
+ * Build cost is measured per step (esp_timer around the step, LVGL pool
+ * usage before/after), so allocations made by other code between two idle
+ * slices never end up in a screen's footprint.
+ */
+
+#include "ui_screen_mgr.h"
+#include "ui_screens.h"
+#include "deferred_log.h"
+#include "lvgl_heap.h"
+#include "bench_clock.h"
+#include "lvgl.h"
+
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <string.h>
+
+// Pressure checks (and the stats dump that follows an eviction) a few times per second
+#define UI_SCREEN_HEAP_CHECK_MS 250
+
+typedef struct {
+  const char* name;
+  lvgl_heap_tag_t tag;
+  ui_screen_build_step_fn build_step;
+  ui_screen_destroy_fn destroy;
+  ui_screen_root_fn get_root;
+  ui_screen_visibility_fn set_visible;
+} ui_screen_desc_t;
+
+typedef struct {
+  ui_screen_stats_t stats;
+  bool building;          // At least one step ran, screen not complete yet
+  bool idle_only;         // Every step of the current build ran in idle slices
+  uint32_t build_us;
+  int32_t build_bytes;
+  uint32_t last_used_ms;
+} ui_screen_slot_t;
+
+// Index order doubles as prebuild priority on a fresh boot: costliest first
+static const ui_screen_desc_t k_screens[UI_SCREEN_COUNT] = {
+  { "wifi",     LVGL_HEAP_TAG_WIFI,     ui_build_wifi_screen_step,     ui_destroy_wifi_screen,
+    ui_wifi_screen_root,     ui_wifi_set_visible },
+  { "ble",      LVGL_HEAP_TAG_BLE,      ui_build_ble_screen_step,      ui_destroy_ble_screen,
+    ui_ble_screen_root,      ui_ble_set_visible },
+  { "settings", LVGL_HEAP_TAG_SETTINGS, ui_build_settings_screen_step, ui_destroy_settings_screen,
+    ui_settings_screen_root, ui_settings_set_visible },
+};
+
+static const ui_screen_id_t k_default_order[UI_SCREEN_COUNT] = {
+  UI_SCREEN_BLE, UI_SCREEN_WIFI, UI_SCREEN_SETTINGS,
+};
+
+static ui_screen_slot_t s_slots[UI_SCREEN_COUNT];
+static bool s_initialized = false;
+static uint32_t s_last_activity_ms = 0;
+static uint32_t s_last_heap_check_ms = 0;
+static uint32_t s_free_sample = 0;      // LVGL free bytes at the last check or step
+
+static bool is_hidden(ui_screen_id_t id)
+{
+  lv_obj_t* root = k_screens[id].get_root();
+  return root && root != lv_scr_act() && root != ui_get_active_screen();
+}
+
+static void run_step(ui_screen_id_t id, bool idle)
+{
+  ui_screen_slot_t* slot = &s_slots[id];
+
+  if (!slot->building) {
+    slot->building = true;
+    slot->idle_only = true;
+    slot->build_us = 0;
+    slot->build_bytes = 0;
+  }
+  slot->idle_only = slot->idle_only && idle;
+
+  uint32_t before = lvgl_heap_free_bytes();
+  lvgl_heap_tag_t prev_tag = lvgl_heap_push_tag(k_screens[id].tag);
+  int64_t t0 = esp_timer_get_time();
+
+  bool done = k_screens[id].build_step();
+
+  uint32_t elapsed = static_cast<uint32_t>(esp_timer_get_time() - t0);
+  lvgl_heap_pop_tag(prev_tag);
+  uint32_t after = lvgl_heap_free_bytes();
+
+  s_free_sample = after;
+  slot->build_us += elapsed;
+  slot->build_bytes += static_cast<int32_t>(before) - static_cast<int32_t>(after);
+
+  if (!done) return;
+
+  ui_screen_stats_t* st = &slot->stats;
+  slot->building = false;
+  st->built = true;
+  st->last_build_us = slot->build_us;
+  if (slot->build_us > st->max_build_us) st->max_build_us = slot->build_us;
+  st->footprint = slot->build_bytes > 0 ? static_cast<uint32_t>(slot->build_bytes) : 0;
+  st->builds++;
+  if (slot->idle_only) st->prebuilds++;
+
+  DLOG_I("PIXEL: Screen %s built in %lu us, %lu B LVGL, idle %u", st->name,
+         static_cast<unsigned long>(st->last_build_us),
+         static_cast<unsigned long>(st->footprint),
+         slot->idle_only ? 1U : 0U);
+}
+
+static void evict(ui_screen_id_t id)
+{
+  ui_screen_slot_t* slot = &s_slots[id];
+  if (!slot->stats.built && !slot->building) return;
+
+  k_screens[id].destroy();
+  slot->building = false;
+  slot->stats.built = false;
+  slot->stats.evictions++;
+  DLOG_I("PIXEL: Screen %s evicted", slot->stats.name);
+}
+
+// Least recently shown hidden screen other than `keep`, or UI_SCREEN_COUNT
+static ui_screen_id_t pick_victim(ui_screen_id_t keep)
+{
+  ui_screen_id_t victim = UI_SCREEN_COUNT;
+  for (uint8_t i = 0; i < UI_SCREEN_COUNT; ++i) {
+    ui_screen_id_t id = static_cast<ui_screen_id_t>(i);
+    const ui_screen_slot_t* slot = &s_slots[i];
+    if (id == keep || !is_hidden(id)) continue;
+    if (victim == UI_SCREEN_COUNT ||
+        static_cast<int32_t>(slot->last_used_ms - s_slots[victim].last_used_ms) < 0) {
+      victim = id;
+    }
+  }
+  return victim;
+}
+
+// Evict LRU hidden screens until `needed` bytes are free (or nothing is left)
+static void reclaim(uint32_t needed, ui_screen_id_t keep)
+{
+  bool evicted = false;
+  uint32_t free_bytes = lvgl_heap_free_bytes();
+  while (free_bytes < needed) {
+    ui_screen_id_t victim = pick_victim(keep);
+    if (victim == UI_SCREEN_COUNT) break;
+    evict(victim);
+    evicted = true;
+    free_bytes = lvgl_heap_free_bytes();
+  }
+  if (evicted) {
+    DLOG_I("PIXEL: LVGL free after eviction: %lu B", static_cast<unsigned long>(free_bytes));
+  }
+}
+
+static uint32_t expected_footprint(ui_screen_id_t id)
+{
+  const ui_screen_slot_t* slot = &s_slots[id];
+  uint32_t full = slot->stats.builds ? slot->stats.footprint : UI_SCREEN_DEFAULT_FOOTPRINT;
+  if (slot->building && slot->build_bytes > 0) {
+    uint32_t done = static_cast<uint32_t>(slot->build_bytes);
+    return done < full ? full - done : 0;
+  }
+  return full;
+}
+
+// Resume an interrupted build first, then the most shown screen not yet built
+static ui_screen_id_t pick_prebuild(void)
+{
+  for (uint8_t i = 0; i < UI_SCREEN_COUNT; ++i) {
+    if (s_slots[i].building) return static_cast<ui_screen_id_t>(i);
+  }
+
+  ui_screen_id_t best = UI_SCREEN_COUNT;
+  for (uint8_t i = 0; i < UI_SCREEN_COUNT; ++i) {
+    ui_screen_id_t id = k_default_order[i];
+    if (s_slots[id].stats.built) continue;
+    if (best == UI_SCREEN_COUNT || s_slots[id].stats.shows > s_slots[best].stats.shows) {
+      best = id;
+    }
+  }
+  return best;
+}
+
+void ui_screen_mgr_init(void)
+{
+  if (s_initialized) return;
+
+  memset(s_slots, 0, sizeof(s_slots));
+  for (uint8_t i = 0; i < UI_SCREEN_COUNT; ++i) {
+    s_slots[i].stats.name = k_screens[i].name;
+  }
+  s_last_activity_ms = millis();
+  s_initialized = true;
+}
+
+lv_obj_t* ui_screen_mgr_acquire(ui_screen_id_t id)
+{
+  if (id >= UI_SCREEN_COUNT) return NULL;
+  ui_screen_slot_t* slot = &s_slots[id];
+
+  if (!slot->stats.built) {
+    reclaim(UI_SCREEN_EVICT_WATERMARK + expected_footprint(id), id);
+    while (!slot->stats.built) {
+      run_step(id, false);
+    }
+  }
+
+  slot->stats.shows++;
+  slot->last_used_ms = millis();
+  ui_screen_mgr_note_activity();
+  return k_screens[id].get_root();
+}
+
+void ui_screen_mgr_screen_changed(lv_obj_t* prev, lv_obj_t* next)
+{
+  if (prev == next) return;
+
+  // Reconciling a screen creates its deferred rows: charge them to it
+  for (uint8_t i = 0; i < UI_SCREEN_COUNT; ++i) {
+    if (prev && k_screens[i].get_root() == prev) {
+      lvgl_heap_tag_t prev_tag = lvgl_heap_push_tag(k_screens[i].tag);
+      k_screens[i].set_visible(false);
+      lvgl_heap_pop_tag(prev_tag);
+    }
+  }
+  for (uint8_t i = 0; i < UI_SCREEN_COUNT; ++i) {
+    if (next && k_screens[i].get_root() == next) {
+      lvgl_heap_tag_t prev_tag = lvgl_heap_push_tag(k_screens[i].tag);
+      k_screens[i].set_visible(true);
+      lvgl_heap_pop_tag(prev_tag);
+    }
+  }
+}
+
+void ui_screen_mgr_note_activity(void)
+{
+  s_last_activity_ms = millis();
+}
+
+void ui_screen_mgr_tick(void)
+{
+  if (!s_initialized) return;
+
+  uint32_t now = millis();
+  if ((now - s_last_heap_check_ms) >= UI_SCREEN_HEAP_CHECK_MS) {
+    s_last_heap_check_ms = now;
+    s_free_sample = lvgl_heap_free_bytes();
+    if (s_free_sample < UI_SCREEN_EVICT_WATERMARK) {
+      reclaim(UI_SCREEN_EVICT_WATERMARK, UI_SCREEN_COUNT);
+      s_free_sample = lvgl_heap_free_bytes();
+      ui_screen_mgr_log_stats();
+      lvgl_heap_log_stats();
+    }
+  }
+
+  // Idle: no queued work recently and no touch on the panel
+  if ((now - s_last_activity_ms) < UI_SCREEN_PREBUILD_IDLE_MS) return;
+  if (lv_disp_get_inactive_time(NULL) < UI_SCREEN_PREBUILD_IDLE_MS) return;
+
+  ui_screen_id_t id = pick_prebuild();
+  if (id == UI_SCREEN_COUNT) return;
+
+  // Never prebuild into memory pressure: that would only feed the evictor
+  uint32_t needed = UI_SCREEN_EVICT_WATERMARK + UI_SCREEN_PREBUILD_MARGIN + expected_footprint(id);
+  if (s_free_sample < needed) return;
+
+  int64_t start = esp_timer_get_time();
+  do {
+    run_step(id, true);
+  } while (!s_slots[id].stats.built &&
+           (esp_timer_get_time() - start) < UI_SCREEN_PREBUILD_SLICE_US);
+}
+
+void ui_screen_mgr_evict_hidden(void)
+{
+  for (uint8_t i = 0; i < UI_SCREEN_COUNT; ++i) {
+    ui_screen_id_t id = static_cast<ui_screen_id_t>(i);
+    if (is_hidden(id) || s_slots[i].building) {
+      evict(id);
+    }
+  }
+}
+
+bool ui_screen_mgr_get_stats(ui_screen_id_t id, ui_screen_stats_t* out)
+{
+  if (id >= UI_SCREEN_COUNT || !out) return false;
+  *out = s_slots[id].stats;
+  return true;
+}
+
+void ui_screen_mgr_log_stats(void)
+{
+  for (uint8_t i = 0; i < UI_SCREEN_COUNT; ++i) {
+    const ui_screen_stats_t* st = &s_slots[i].stats;
+    DLOG_I("PIXEL: Screen %-8s up %u build %lu/%lu us %lu B, %u builds (%u idle) %u evicted %u shown",
+           st->name, st->built ? 1U : 0U,
+           static_cast<unsigned long>(st->last_build_us),
+           static_cast<unsigned long>(st->max_build_us),
+           static_cast<unsigned long>(st->footprint),
+           st->builds, st->prebuilds, st->evictions, st->shows);
+  }
+}
+
+void ui_screen_mgr_run_stress(uint32_t cycles)
+{
+  // Hidden screens hold memory that the cycles would otherwise count as leaked
+  ui_screen_mgr_evict_hidden();
+
+  lvgl_heap_stats_t start;
+  lvgl_heap_get_stats(&start);
+  uint32_t worst_free = start.free;
+  int64_t t0 = bench_clock_us();
+  for (uint32_t c = 0; c < cycles; ++c) {
+    for (uint8_t i = 0; i < UI_SCREEN_COUNT; ++i) {
+      ui_screen_mgr_acquire(static_cast<ui_screen_id_t>(i));
+      uint32_t free_bytes = lvgl_heap_free_bytes();
+      if (free_bytes < worst_free) worst_free = free_bytes;
+    }
+    ui_screen_mgr_evict_hidden();
+  }
+  uint32_t elapsed_ms = static_cast<uint32_t>((bench_clock_us() - t0) / 1000);
+
+  lvgl_heap_stats_t end;
+  lvgl_heap_get_stats(&end);
+  uint32_t ops = (end.allocs - start.allocs) + (end.frees - start.frees);
+  DLOG_I("PIXEL: Screen stress %lu cycles in %lu ms, %lu heap ops, min free %lu B, drift %ld B",
+         static_cast<unsigned long>(cycles), static_cast<unsigned long>(elapsed_ms),
+         static_cast<unsigned long>(ops), static_cast<unsigned long>(worst_free),
+         static_cast<long>(static_cast<int32_t>(end.free) - static_cast<int32_t>(start.free)));
+  DLOG_I("PIXEL: Screen stress frag %u%% -> %u%%, free blocks %lu -> %lu, %lu failed, %lu check errors",
+         start.frag_pct, end.frag_pct,
+         static_cast<unsigned long>(start.free_blocks), static_cast<unsigned long>(end.free_blocks),
+         static_cast<unsigned long>(end.failed - start.failed),
+         static_cast<unsigned long>(lvgl_heap_check()));
+  ui_screen_mgr_log_stats();
+  lvgl_heap_log_stats();
+}
@@ -1,20 +1,82 @@
 /*
  * PIXEL - Settings Screen
  *
- * Placeholder for settings UI.
+ * Settings placeholder plus live system monitor (queues, stacks, heap) and
+ * CPU profiler panels, and the entry to the unattended survey mode.
  */
 
 #include "ui_screens.h"
 #include "ui_theme.h"
+#include "ui_api.h"
+#include "sysmon.h"
+#include "cpuprof.h"
 #include "lvgl.h"
 
 #include <Arduino.h>
+#include <stdio.h>
+
+#define SYSMON_PANEL_TEXT_MAX 640
+#define CPUPROF_PANEL_TEXT_MAX 384
+#define CPUPROF_PANEL_ROWS 6
+
+static lv_obj_t* g_settings_scr = NULL;
+static lv_obj_t* g_label_sysmon = NULL;
+static lv_obj_t* g_label_cpuprof = NULL;
+static lv_timer_t* g_sysmon_timer = NULL;
+
+static void update_sysmon_cb(lv_timer_t* timer);
+static void update_cpuprof_text(void);
+static void on_survey_btn_click(lv_event_t* e);
+
+bool ui_build_settings_screen_step(void)
+{
+  // Two labels: cheap enough to build in one step
+  if (!g_settings_scr) {
+    ui_create_settings_screen();
+  }
+  return true;
+}
+
+lv_obj_t* ui_settings_screen_root(void)
+{
+  return g_settings_scr;
+}
+
+void ui_settings_set_visible(bool visible)
+{
+  if (!g_sysmon_timer) return;
+
+  // Formatting the panels is the costly part: no ticks while hidden
+  if (visible) {
+    lv_timer_resume(g_sysmon_timer);
+    lv_timer_ready(g_sysmon_timer);
+  } else {
+    lv_timer_pause(g_sysmon_timer);
+  }
+}
+
+void ui_destroy_settings_screen(void)
+{
+  if (g_sysmon_timer) {
+    lv_timer_del(g_sysmon_timer);
+    g_sysmon_timer = NULL;
+  }
+  if (g_settings_scr) {
+    lv_obj_del(g_settings_scr);
+  }
+  g_settings_scr = NULL;
+  g_label_sysmon = NULL;
+  g_label_cpuprof = NULL;
+}
 
 lv_obj_t* ui_create_settings_screen(void)
 {
+  if (g_settings_scr) return g_settings_scr;
+
   lv_obj_t* scr = lv_obj_create(NULL);
   lv_obj_set_style_bg_color(scr, lv_color_hex(COLOR_BACKGROUND), 0);
   lv_obj_set_size(scr, LV_HOR_RES, LV_VER_RES);
+  g_settings_scr = scr;
 
   // Title
   lv_obj_t* title = lv_label_create(scr);
@@ -22,13 +84,117 @@ lv_obj_t* ui_create_settings_screen(void)
   lv_obj_set_pos(title, PAD_NORMAL, PAD_LARGE);
   lv_obj_add_style(title, ui_get_style_label_title(), 0);
 
-  // Placeholder content
-  lv_obj_t* text = lv_label_create(scr);
-  lv_label_set_text(text, "Settings coming soon!");
-  lv_obj_set_pos(text, PAD_NORMAL, 60);
-  lv_obj_add_style(text, ui_get_style_label_normal(), 0);
+  // Survey: blanks the screen until touched
+  lv_obj_t* survey_btn = lv_btn_create(scr);
+  lv_obj_set_size(survey_btn, BUTTON_WIDTH, BUTTON_HEIGHT);
+  lv_obj_add_style(survey_btn, ui_get_style_btn_primary(), 0);
+  lv_obj_align(survey_btn, LV_ALIGN_TOP_RIGHT, -PAD_NORMAL, PAD_NORMAL);
+  lv_obj_add_event_cb(survey_btn, on_survey_btn_click, LV_EVENT_CLICKED, NULL);
+
+  lv_obj_t* survey_label = lv_label_create(survey_btn);
+  lv_label_set_text(survey_label, "Survey");
+  lv_obj_center(survey_label);
+  lv_obj_add_style(survey_label, ui_get_style_label_normal(), 0);
+
+  // System monitor panel
+  g_label_sysmon = lv_label_create(scr);
+  lv_obj_add_style(g_label_sysmon, ui_get_style_label_normal(), 0);
+  lv_obj_set_width(g_label_sysmon, LV_HOR_RES - 2 * PAD_NORMAL);
+  lv_label_set_long_mode(g_label_sysmon, LV_LABEL_LONG_WRAP);
+  lv_obj_set_pos(g_label_sysmon, PAD_NORMAL, 60);
+  lv_label_set_text(g_label_sysmon, "System monitor...");
+
+  // CPU profiler panel, kept right below the monitor text
+  g_label_cpuprof = lv_label_create(scr);
+  lv_obj_add_style(g_label_cpuprof, ui_get_style_label_normal(), 0);
+  lv_obj_set_width(g_label_cpuprof, LV_HOR_RES - 2 * PAD_NORMAL);
+  lv_label_set_long_mode(g_label_cpuprof, LV_LABEL_LONG_WRAP);
+  lv_obj_align_to(g_label_cpuprof, g_label_sysmon, LV_ALIGN_OUT_BOTTOM_LEFT, 0, PAD_NORMAL);
+  lv_label_set_text(g_label_cpuprof, "");
+
+  g_sysmon_timer = lv_timer_create(update_sysmon_cb, SYSMON_SAMPLE_PERIOD_MS, NULL);
+  lv_timer_pause(g_sysmon_timer);  // Resumed by ui_settings_set_visible()
 
   Serial.println("PIXEL: Settings screen created");
   return scr;
 }
 
+static void on_survey_btn_click(lv_event_t* e)
+{
+  (void)e;
+  ui_post_event(UI_EVENT_SURVEY_START);
+}
+
+static void update_sysmon_cb(lv_timer_t* timer)
+{
+  (void)timer;
+
+  if (!g_label_sysmon) return;
+
+  static sysmon_snapshot_t snap;  // Too large for the UI task stack
+  static char text[SYSMON_PANEL_TEXT_MAX];
+  sysmon_get_snapshot(&snap);
+
+  int len = snprintf(text, sizeof(text), "Heap %luK min %luK blk %luK\nLVGL %luK min %luK frag %u%%\n",
+                     static_cast<unsigned long>(snap.heap.free_heap / 1024),
+                     static_cast<unsigned long>(snap.heap.min_free_heap / 1024),
+                     static_cast<unsigned long>(snap.heap.largest_block / 1024),
+                     static_cast<unsigned long>(snap.heap.lvgl_free / 1024),
+                     static_cast<unsigned long>(snap.heap.lvgl_min_free / 1024),
+                     static_cast<unsigned>(snap.heap.lvgl_frag_pct));
+
+  for (uint8_t i = 0; i < SYSMON_QUEUE_COUNT && len > 0 && len < (int)sizeof(text); ++i) {
+    const sysmon_queue_stats_t* q = &snap.queues[i];
+    len += snprintf(text + len, sizeof(text) - len, "Q %-8s hw %2lu/%-2lu drop %lu\n",
+                    q->name ? q->name : "?",
+                    static_cast<unsigned long>(q->high_water),
+                    static_cast<unsigned long>(q->length),
+                    static_cast<unsigned long>(q->dropped));
+  }
+
+  for (uint8_t i = 0; i < snap.task_count && len > 0 && len < (int)sizeof(text); ++i) {
+    const sysmon_task_stats_t* t = &snap.tasks[i];
+    uint32_t min_free = (t->stack_min_free == UINT32_MAX) ? 0 : t->stack_min_free;
+    len += snprintf(text + len, sizeof(text) - len, "T %-9s %5lu/%5lu free\n",
+                    t->name,
+                    static_cast<unsigned long>(min_free),
+                    static_cast<unsigned long>(t->stack_size));
+  }
+
+  lv_label_set_text(g_label_sysmon, text);
+
+  update_cpuprof_text();
+  lv_obj_align_to(g_label_cpuprof, g_label_sysmon, LV_ALIGN_OUT_BOTTOM_LEFT, 0, PAD_NORMAL);
+}
+
+static void update_cpuprof_text(void)
+{
+  if (!g_label_cpuprof) return;
+
+  static cpuprof_snapshot_t snap;
+  static char text[CPUPROF_PANEL_TEXT_MAX];
+  cpuprof_get_snapshot(&snap);
+
+  if (!snap.available) {
+    lv_label_set_text(g_label_cpuprof, "CPU: run-time stats off");
+    return;
+  }
+
+  int len = snprintf(text, sizeof(text), "CPU 1s/10s: 0 %u/%u%% 1 %u/%u%%\n",
+                     snap.core_load_short_x10[0] / 10, snap.core_load_long_x10[0] / 10,
+                     snap.core_load_short_x10[1] / 10, snap.core_load_long_x10[1] / 10);
+
+  // Busiest tasks first, plus any flagged task further down the list
+  for (uint8_t i = 0; i < snap.task_count && len > 0 && len < (int)sizeof(text); ++i) {
+    const cpuprof_task_t* t = &snap.tasks[i];
+    if (i >= CPUPROF_PANEL_ROWS && !t->flags) continue;
+    char core = (t->core == CPUPROF_CORE_ANY) ? '*' : static_cast<char>('0' + t->core);
+    len += snprintf(text + len, sizeof(text) - len, "%-10s c%c %3u.%u%%%s%s\n",
+                    t->name, core,
+                    t->pct_long_x10 / 10, t->pct_long_x10 % 10,
+                    (t->flags & CPUPROF_FLAG_STARVED) ? " STARVED" : "",
+                    (t->flags & CPUPROF_FLAG_HOG) ? " HOG" : "");
+  }
+
+  lv_label_set_text(g_label_cpuprof, text);
+}
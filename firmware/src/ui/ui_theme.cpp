@@ -5,6 +5,7 @@
  */
 
 #include "ui_theme.h"
+#include "lvgl_heap.h"
 #include "lvgl.h"
 
 // Static style objects
@@ -14,6 +15,8 @@ static lv_style_t style_label_normal;
 
 void ui_theme_init(void)
 {
+  lvgl_heap_tag_t prev_tag = lvgl_heap_push_tag(LVGL_HEAP_TAG_STYLE);
+
   // Force LVGL default theme to dark mode with neon green primary accents.
   lv_disp_t* disp = lv_disp_get_default();
   if (disp) {
@@ -49,6 +52,8 @@ void ui_theme_init(void)
   lv_style_set_text_color(&style_label_normal, lv_color_hex(COLOR_TEXT));
   // lv_style_set_text_opa(&style_label_normal, LV_OPA_60);
   lv_style_set_text_font(&style_label_normal, &lv_font_unscii_8);
+
+  lvgl_heap_pop_tag(prev_tag);
 }
 
 lv_style_t* ui_get_style_btn_primary(void)
@@ -2,38 +2,190 @@
  * PIXEL - WiFi Scan Screen
  *
  * Displays list of detected WiFi networks with real-time updates from
- * netsec_result_queue.
+ * netsec_result_queue. AP data lives in g_wifi_entries independently of
+ * the LVGL rows, so the screen can be torn down and rebuilt at any time.
+ * While hidden, results only update that model (entries marked dirty) and
+ * ui_wifi_set_visible(true) reconciles the rows in one pass.
+ *
+ * Rows follow the NETSEC device registry diffs: added and changed APs are
+ * upserted, gone ones removed. With every row taken a new AP reuses the
+ * row heard from longest ago.
  */
 
 #include "ui_screens.h"
 #include "ui_theme.h"
+#include "ui_cell_label.h"
+#include "lvgl_heap.h"
+#include "deferred_log.h"
 #include "lvgl.h"
 
 #include <Arduino.h>
+#include <esp_timer.h>
 #include <stdio.h>
 #include <string.h>
 
 #define WIFI_AP_BUFFER_SIZE 32
+#define WIFI_ROWS_PER_STEP  4
+
+// Row text grid: list width minus list and row padding
+#define WIFI_ROW_COLS UI_CELL_LABEL_COLS(LV_HOR_RES - 2 * PAD_NORMAL - 4 * PAD_SMALL)
 
 typedef struct {
   bool in_use;
-  uint8_t bssid[6];
-  lv_obj_t* row;
+  bool dirty;               // Model changed while the screen was hidden
+  netsec_device_t ap;       // Kept across teardown so rows can be rebuilt
+  lv_obj_t* row;            // May outlive in_use while hidden (deleted on reconcile)
   lv_obj_t* label;
 } wifi_ap_entry_t;
 
+typedef enum {
+  WIFI_BUILD_FRAME = 0,
+  WIFI_BUILD_ROWS,
+  WIFI_BUILD_DONE,
+} wifi_build_step_t;
+
 static lv_obj_t* g_wifi_screen = NULL;
 static lv_obj_t* g_wifi_list = NULL;
 static lv_obj_t* g_wifi_empty_label = NULL;
 static lv_obj_t* g_wifi_status_label = NULL;
 static wifi_ap_entry_t g_wifi_entries[WIFI_AP_BUFFER_SIZE];
+static char g_wifi_status_text[32] = "Waiting for scan results…";
+static wifi_build_step_t g_build_step = WIFI_BUILD_FRAME;
+static size_t g_build_row = 0;
+static bool g_wifi_visible = false;
+static uint32_t g_deferred_updates = 0;   // Row/status writes skipped while hidden
 
+static void build_frame(void);
 static void refresh_empty_state(void);
 static wifi_ap_entry_t* find_entry_by_bssid(const uint8_t* bssid);
 static wifi_ap_entry_t* allocate_entry(const uint8_t* bssid);
-static void upsert_ap_row(const netsec_wifi_ap_t* ap);
+static void create_row(wifi_ap_entry_t* entry);
+static void update_row_text(wifi_ap_entry_t* entry);
+static void set_status_text(const char* text);
+static void upsert_ap_row(const netsec_device_t* ap);
+static void remove_ap_row(const netsec_device_t* ap);
+
+bool ui_build_wifi_screen_step(void)
+{
+  switch (g_build_step) {
+    case WIFI_BUILD_FRAME:
+      build_frame();
+      g_build_row = 0;
+      g_build_step = WIFI_BUILD_ROWS;
+      return false;
+
+    case WIFI_BUILD_ROWS: {
+      // Rows for APs recorded while the screen did not exist
+      size_t created = 0;
+      while (g_build_row < WIFI_AP_BUFFER_SIZE && created < WIFI_ROWS_PER_STEP) {
+        wifi_ap_entry_t* entry = &g_wifi_entries[g_build_row++];
+        if (entry->in_use && !entry->row) {
+          create_row(entry);
+          created++;
+        }
+      }
+      if (g_build_row < WIFI_AP_BUFFER_SIZE) return false;
+
+      refresh_empty_state();
+      g_build_step = WIFI_BUILD_DONE;
+      Serial.println("PIXEL: WiFi screen created");
+      return true;
+    }
+
+    case WIFI_BUILD_DONE:
+    default:
+      return true;
+  }
+}
 
 lv_obj_t* ui_create_wifi_screen(void)
+{
+  while (!ui_build_wifi_screen_step()) {
+  }
+  return g_wifi_screen;
+}
+
+lv_obj_t* ui_wifi_screen_root(void)
+{
+  return g_wifi_screen;
+}
+
+void ui_destroy_wifi_screen(void)
+{
+  if (g_wifi_screen) {
+    lv_obj_del(g_wifi_screen);
+  }
+  g_wifi_screen = NULL;
+  g_wifi_list = NULL;
+  g_wifi_empty_label = NULL;
+  g_wifi_status_label = NULL;
+  for (size_t i = 0; i < WIFI_AP_BUFFER_SIZE; ++i) {
+    g_wifi_entries[i].row = NULL;
+    g_wifi_entries[i].label = NULL;
+  }
+  g_build_step = WIFI_BUILD_FRAME;
+  g_build_row = 0;
+  g_wifi_visible = false;
+}
+
+void ui_wifi_set_visible(bool visible)
+{
+  g_wifi_visible = visible && g_wifi_screen;
+  if (!g_wifi_visible) return;
+
+  int64_t t0 = esp_timer_get_time();
+  uint32_t rows = 0;
+  for (size_t i = 0; i < WIFI_AP_BUFFER_SIZE; ++i) {
+    wifi_ap_entry_t* entry = &g_wifi_entries[i];
+    if (!entry->in_use) {
+      // Gone while hidden
+      if (entry->row) {
+        lv_obj_del(entry->row);
+        entry->row = NULL;
+        entry->label = NULL;
+        rows++;
+      }
+      continue;
+    }
+    if (!entry->row) {
+      create_row(entry);
+      rows++;
+    } else if (entry->dirty) {
+      update_row_text(entry);
+      rows++;
+    }
+    entry->dirty = false;
+  }
+
+  if (g_wifi_status_label) {
+    lv_label_set_text(g_wifi_status_label, g_wifi_status_text);
+  }
+  refresh_empty_state();
+
+  if (g_deferred_updates) {
+    DLOG_I("PIXEL: WiFi reconcile %u rows for %lu deferred updates in %lu us", rows,
+           static_cast<unsigned long>(g_deferred_updates),
+           static_cast<unsigned long>(esp_timer_get_time() - t0));
+    g_deferred_updates = 0;
+  }
+}
+
+void ui_wifi_handle_device(netsec_result_type_t type, const netsec_device_t* ap)
+{
+  if (!ap) return;
+  if (type == NETSEC_RES_DEVICE_GONE) {
+    remove_ap_row(ap);
+  } else {
+    upsert_ap_row(ap);
+  }
+}
+
+void ui_wifi_handle_scan_done(void)
+{
+  set_status_text("Scan complete.");
+}
+
+static void build_frame(void)
 {
   lv_obj_t* scr = lv_obj_create(NULL);
   lv_obj_set_style_bg_color(scr, lv_color_hex(COLOR_BACKGROUND), 0);
@@ -70,27 +222,25 @@ lv_obj_t* ui_create_wifi_screen(void)
 
   // Status text
   g_wifi_status_label = lv_label_create(scr);
-  lv_label_set_text(g_wifi_status_label, "Waiting for scan results…");
+  lv_label_set_text(g_wifi_status_label, g_wifi_status_text);
   lv_obj_add_style(g_wifi_status_label, ui_get_style_label_normal(), 0);
   lv_obj_set_style_text_color(g_wifi_status_label, lv_color_hex(COLOR_TEXT), 0);
   lv_obj_set_pos(g_wifi_status_label, PAD_NORMAL, LV_VER_RES - PAD_LARGE);
 
-  refresh_empty_state();
   g_wifi_screen = scr;
-  Serial.println("PIXEL: WiFi screen created");
-  return scr;
 }
 
-void ui_wifi_handle_ap_found(const netsec_wifi_ap_t* ap)
+static void set_status_text(const char* text)
 {
-  if (!ap) return;
-  upsert_ap_row(ap);
-}
+  if (strcmp(g_wifi_status_text, text) == 0) return;
 
-void ui_wifi_handle_scan_done(void)
-{
+  snprintf(g_wifi_status_text, sizeof(g_wifi_status_text), "%s", text);
+  if (!g_wifi_visible) {
+    g_deferred_updates++;
+    return;
+  }
   if (g_wifi_status_label) {
-    lv_label_set_text(g_wifi_status_label, "Scan complete.");
+    lv_label_set_text(g_wifi_status_label, g_wifi_status_text);
   }
 }
 
@@ -100,7 +250,7 @@ static wifi_ap_entry_t* find_entry_by_bssid(const uint8_t* bssid)
 
   for (size_t i = 0; i < WIFI_AP_BUFFER_SIZE; ++i) {
     wifi_ap_entry_t* entry = &g_wifi_entries[i];
-    if (entry->in_use && memcmp(entry->bssid, bssid, sizeof(entry->bssid)) == 0) {
+    if (entry->in_use && memcmp(entry->ap.addr, bssid, sizeof(entry->ap.addr)) == 0) {
       return entry;
     }
   }
@@ -110,65 +260,124 @@ static wifi_ap_entry_t* find_entry_by_bssid(const uint8_t* bssid)
 
 static wifi_ap_entry_t* allocate_entry(const uint8_t* bssid)
 {
-  if (!g_wifi_list || !bssid) return NULL;
+  if (!bssid) return NULL;
 
+  // A free entry, else the AP heard from longest ago gives up its row
+  wifi_ap_entry_t* entry = NULL;
+  const uint32_t now_ms = millis();
   for (size_t i = 0; i < WIFI_AP_BUFFER_SIZE; ++i) {
-    wifi_ap_entry_t* entry = &g_wifi_entries[i];
-    if (entry->in_use) continue;
+    wifi_ap_entry_t* candidate = &g_wifi_entries[i];
+    if (!candidate->in_use) {
+      entry = candidate;
+      break;
+    }
+    if (!entry || now_ms - candidate->ap.last_seen_ms > now_ms - entry->ap.last_seen_ms) {
+      entry = candidate;
+    }
+  }
 
-    memset(entry, 0, sizeof(*entry));
-    entry->in_use = true;
-    memcpy(entry->bssid, bssid, sizeof(entry->bssid));
+  lv_obj_t* row = entry->row;
+  lv_obj_t* label = entry->label;
+  memset(entry, 0, sizeof(*entry));
+  entry->in_use = true;
+  entry->row = row;
+  entry->label = label;
+  memcpy(entry->ap.addr, bssid, sizeof(entry->ap.addr));
+
+  // Hidden: the row is created by the rebuild step or the next reconcile
+  if (!entry->row && g_wifi_visible && g_wifi_list) {
+    create_row(entry);
+  }
+  return entry;
+}
 
-    entry->row = lv_obj_create(g_wifi_list);
-    lv_obj_set_size(entry->row, LV_PCT(100), LV_SIZE_CONTENT);
-    lv_obj_clear_flag(entry->row, LV_OBJ_FLAG_SCROLLABLE);
-    lv_obj_set_style_bg_color(entry->row, lv_color_hex(COLOR_SURFACE), 0);
-    lv_obj_set_style_bg_opa(entry->row, LV_OPA_40, 0);
-    lv_obj_set_style_border_width(entry->row, 0, 0);
-    lv_obj_set_style_radius(entry->row, RADIUS_SMALL, 0);
-    lv_obj_set_style_pad_all(entry->row, PAD_SMALL, 0);
+static void create_row(wifi_ap_entry_t* entry)
+{
+  lvgl_heap_tag_t prev_tag = lvgl_heap_push_tag(LVGL_HEAP_TAG_LIST_ROW);
+  entry->row = lv_obj_create(g_wifi_list);
+  lv_obj_set_size(entry->row, LV_PCT(100), LV_SIZE_CONTENT);
+  lv_obj_clear_flag(entry->row, LV_OBJ_FLAG_SCROLLABLE);
+  lv_obj_set_style_bg_color(entry->row, lv_color_hex(COLOR_SURFACE), 0);
+  lv_obj_set_style_bg_opa(entry->row, LV_OPA_40, 0);
+  lv_obj_set_style_border_width(entry->row, 0, 0);
+  lv_obj_set_style_radius(entry->row, RADIUS_SMALL, 0);
+  lv_obj_set_style_pad_all(entry->row, PAD_SMALL, 0);
+
+  entry->label = ui_cell_label_create(entry->row, WIFI_ROW_COLS, 3);
+  lv_obj_add_style(entry->label, ui_get_style_label_normal(), 0);
+  lv_obj_set_style_text_color(entry->label, lv_color_hex(COLOR_TEXT), 0);
+
+  update_row_text(entry);
+  lvgl_heap_pop_tag(prev_tag);
+  entry->dirty = false;
+  refresh_empty_state();
+}
 
-    entry->label = lv_label_create(entry->row);
-    lv_obj_add_style(entry->label, ui_get_style_label_normal(), 0);
-    lv_obj_set_style_text_color(entry->label, lv_color_hex(COLOR_TEXT), 0);
-    lv_obj_set_width(entry->label, LV_PCT(100));
-    lv_label_set_long_mode(entry->label, LV_LABEL_LONG_WRAP);
+static void update_row_text(wifi_ap_entry_t* entry)
+{
+  if (!entry->label) return;
 
-    refresh_empty_state();
-    return entry;
+  const netsec_device_t* ap = &entry->ap;
+  char bssid[18];
+  snprintf(bssid, sizeof(bssid), "%02X:%02X:%02X:%02X:%02X:%02X",
+           ap->addr[0], ap->addr[1], ap->addr[2],
+           ap->addr[3], ap->addr[4], ap->addr[5]);
+
+  ui_cell_label_set_text_fmt(entry->label, "%s\n%s\nRSSI: %d dBm | CH: %u | x%lu",
+                             ap->name, bssid, ap->rssi, ap->channel,
+                             static_cast<unsigned long>(ap->seen_count));
+
+  // Not seen in the last days: accent border, restyled only on change
+  const lv_coord_t border = (ap->flags & NETSEC_WIFI_FLAG_NEW) ? 2 : 0;
+  if (lv_obj_get_style_border_width(entry->row, 0) != border) {
+    lv_obj_set_style_border_color(entry->row, lv_color_hex(COLOR_ACCENT), 0);
+    lv_obj_set_style_border_width(entry->row, border, 0);
   }
-
-  return NULL;
 }
 
-static void upsert_ap_row(const netsec_wifi_ap_t* ap)
+static void upsert_ap_row(const netsec_device_t* ap)
 {
-  if (!ap || !g_wifi_list) return;
+  if (!ap) return;
 
-  wifi_ap_entry_t* entry = find_entry_by_bssid(ap->bssid);
+  wifi_ap_entry_t* entry = find_entry_by_bssid(ap->addr);
   if (!entry) {
-    entry = allocate_entry(ap->bssid);
+    entry = allocate_entry(ap->addr);
   }
-  if (!entry || !entry->label) return;
-
-  char bssid[18];
-  snprintf(bssid, sizeof(bssid), "%02X:%02X:%02X:%02X:%02X:%02X",
-           ap->bssid[0], ap->bssid[1], ap->bssid[2],
-           ap->bssid[3], ap->bssid[4], ap->bssid[5]);
-
-  lv_label_set_text_fmt(entry->label, "%s\n%s\nRSSI: %d dBm | CH: %u",
-                        ap->ssid, bssid, ap->rssi, ap->channel);
+  if (!entry) return;
+
+  entry->ap = *ap;
+  set_status_text("Scanning…");
+  if (!g_wifi_visible) {
+    entry->dirty = true;
+    g_deferred_updates++;
+    return;
+  }
+  update_row_text(entry);
+  refresh_empty_state();
+}
 
-  if (g_wifi_status_label) {
-    lv_label_set_text(g_wifi_status_label, "Scanning…");
+static void remove_ap_row(const netsec_device_t* ap)
+{
+  wifi_ap_entry_t* entry = find_entry_by_bssid(ap->addr);
+  if (!entry) return;   // Row already reused
+
+  entry->in_use = false;
+  entry->dirty = false;
+  if (!g_wifi_visible) {
+    g_deferred_updates++;   // Row deleted by the next reconcile
+    return;
+  }
+  if (entry->row) {
+    lv_obj_del(entry->row);
+    entry->row = NULL;
+    entry->label = NULL;
   }
   refresh_empty_state();
 }
 
 static void refresh_empty_state(void)
 {
-  if (!g_wifi_empty_label || !g_wifi_list) return;
+  if (!g_wifi_visible || !g_wifi_empty_label || !g_wifi_list) return;
 
   bool has_entries = lv_obj_get_child_cnt(g_wifi_list) > 0;
   if (has_entries) {
@@ -177,4 +386,3 @@ static void refresh_empty_state(void)
     lv_obj_clear_flag(g_wifi_empty_label, LV_OBJ_FLAG_HIDDEN);
   }
 }
-
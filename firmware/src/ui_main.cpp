@@ -6,7 +6,14 @@
 
 #include "ui_api.h"
 #include "ui_screens.h"
+#include "ui_screen_mgr.h"
 #include "ui_theme.h"
+#include "ui_pet.h"
+#include "game_rt.h"
+#include "game_snack.h"
+#include "lvgl_heap.h"
+#include "deferred_log.h"
+#include "sysmon.h"
 #include "lvgl.h"
 
 #include <Arduino.h>
@@ -17,14 +24,14 @@
 static QueueHandle_t g_ui_queue = NULL;
 static ui_event_router_t g_event_router = NULL;
 static lv_obj_t* g_main_screen = NULL;
-static lv_obj_t* g_wifi_screen = NULL;
-static lv_obj_t* g_ble_screen = NULL;
-static lv_obj_t* g_settings_screen = NULL;
+static lv_obj_t* g_splash_screen = NULL;
+static lv_obj_t* g_game_screen = NULL;
 
 // Implementation of ui_api.h functions
 void ui_init(QueueHandle_t ui_queue)
 {
   g_ui_queue = ui_queue;
+  ui_screen_mgr_init();
   Serial.println("PIXEL: UI module initialized");
 }
 
@@ -45,28 +52,57 @@ bool ui_post_event(ui_event_t event)
     return false;
   }
 
-  BaseType_t result = xQueueSend(g_ui_queue, &event, 0);
+  BaseType_t result = sysmon_queue_send(SYSMON_QUEUE_UI_EVENT, &event, 0);
   if (result != pdTRUE) {
-    Serial.println("PIXEL: Failed to post UI event");
+    DLOG_W("PIXEL: Failed to post UI event %d", event);
     return false;
   }
 
   return true;
 }
 
+void ui_show_splash(void)
+{
+  // Plain objects only: runs before the theme and the wallpaper drive exist
+  lvgl_heap_tag_t prev_tag = lvgl_heap_push_tag(LVGL_HEAP_TAG_SPLASH);
+  g_splash_screen = lv_obj_create(NULL);
+  lv_obj_set_style_bg_color(g_splash_screen, lv_color_black(), 0);
+  lv_obj_set_style_bg_opa(g_splash_screen, LV_OPA_COVER, 0);
+
+  lv_obj_t* title = lv_label_create(g_splash_screen);
+  lv_label_set_text(title, "Acyd-Gotchi");
+  lv_obj_set_style_text_color(title, lv_color_white(), 0);
+  lv_obj_align(title, LV_ALIGN_CENTER, 0, -8);
+
+  lv_obj_t* status = lv_label_create(g_splash_screen);
+  lv_label_set_text(status, "booting...");
+  lv_obj_set_style_text_color(status, lv_palette_main(LV_PALETTE_GREY), 0);
+  lv_obj_align_to(status, title, LV_ALIGN_OUT_BOTTOM_MID, 0, 4);
+  lvgl_heap_pop_tag(prev_tag);
+
+  lv_disp_load_scr(g_splash_screen);
+}
+
 void ui_show_main_screen(void)
 {
-  Serial.println("PIXEL: Showing main screen");
+  DLOG_I("PIXEL: Showing main screen");
   
   if (!g_main_screen) {
     // Initialize theme first
     ui_theme_init();
 
     // Create main screen
+    lvgl_heap_tag_t prev_tag = lvgl_heap_push_tag(LVGL_HEAP_TAG_MAIN);
     g_main_screen = ui_create_main_screen();
+    lvgl_heap_pop_tag(prev_tag);
 
     // Load it
     ui_load_screen(g_main_screen);
+
+    if (g_splash_screen) {
+      lv_obj_del(g_splash_screen);
+      g_splash_screen = NULL;
+    }
   } else {
     ui_load_screen(g_main_screen);
   }
@@ -76,46 +112,62 @@ void ui_show_main_screen(void)
 
 void ui_show_wifi_screen(void)
 {
-  Serial.println("PIXEL: Showing WiFi screen");
+  DLOG_I("PIXEL: Showing WiFi screen");
   
-  if (!g_wifi_screen) {
-    g_wifi_screen = ui_create_wifi_screen();
-  }
+  lv_obj_t* screen = ui_screen_mgr_acquire(UI_SCREEN_WIFI);
 
   ui_set_screen_state_to_wifi();
-  ui_load_screen(g_wifi_screen);
+  ui_load_screen(screen);
 }
 
 void ui_show_ble_screen(void)
 {
-  Serial.println("PIXEL: Showing BLE screen");
+  DLOG_I("PIXEL: Showing BLE screen");
   
-  if (!g_ble_screen) {
-    g_ble_screen = ui_create_ble_screen();
-  }
+  lv_obj_t* screen = ui_screen_mgr_acquire(UI_SCREEN_BLE);
 
   ui_set_screen_state_to_ble();
-  ui_load_screen(g_ble_screen);
+  ui_load_screen(screen);
 }
 
 void ui_show_settings_screen(void)
 {
-  Serial.println("PIXEL: Showing Settings screen");
+  DLOG_I("PIXEL: Showing Settings screen");
 
-  if (!g_settings_screen) {
-    g_settings_screen = ui_create_settings_screen();
-  }
+  lv_obj_t* screen = ui_screen_mgr_acquire(UI_SCREEN_SETTINGS);
 
   ui_set_screen_state_to_settings();
-  ui_load_screen(g_settings_screen);
+  ui_load_screen(screen);
+}
+
+static void on_game_exit(void)
+{
+  ui_show_main_screen();
+  if (g_game_screen) {
+    lv_obj_del(g_game_screen);
+    g_game_screen = NULL;
+  }
+}
+
+void ui_show_game_screen(void)
+{
+  if (game_rt_active()) return;
+  DLOG_I("PIXEL: Showing game screen");
+
+  // Empty screen: pauses the main screen's timers while the game owns the panel
+  g_game_screen = lv_obj_create(NULL);
+  lv_obj_set_style_bg_color(g_game_screen, lv_color_black(), 0);
+  lv_obj_set_style_bg_opa(g_game_screen, LV_OPA_COVER, 0);
+  ui_load_screen(g_game_screen);
+
+  if (!game_rt_start(game_snack_def(), on_game_exit)) {
+    on_game_exit();
+  }
 }
 
 void ui_update_pet(uint32_t delta_ms)
 {
-  // Called periodically to update pet animation/state
-  (void)delta_ms;
-  
-  // TODO: Update pet sprite/animation frame
-  // For now, stub
+  // The pet runs off its own LVGL timer; this pushes it forward on demand
+  ui_pet_advance(delta_ms);
 }
 
@@ -9,8 +9,25 @@
 #include "tasks.h"
 #include "ui_api.h"
 #include "ui_screens.h"
+#include "ui_screen_mgr.h"
+#include "ui_cell_label.h"
+#include "pet_sim.h"
+#include "ui_daylight.h"
+#include "persist.h"
+#include "game_rt.h"
+#include "asset_map.h"
+#include "lvgl_fs.h"
+#include "storage_fs.h"
 #include "netsec_api.h"
+#include "netsec/netsec_survey.h"
 #include "lvgl_port.h"
+#include "lvgl_heap.h"
+#include "serial_export.h"
+#include "deferred_log.h"
+#include "sysmon.h"
+#include "cpuprof.h"
+#include "boot_profiler.h"
+#include "system_init.h"
 
 #include "lvgl.h"
 #include <freertos/FreeRTOS.h>
@@ -18,6 +35,9 @@
 
 #include <Arduino.h>
 
+// Screen build/teardown cycles run by the LVGL_HEAP_RUN_BENCHMARK stress
+#define LVGL_HEAP_STRESS_CYCLES 50
+
 typedef enum {
   BLE_UI_STATE_IDLE = 0,
   BLE_UI_STATE_CHOOSING_DURATION,
@@ -36,7 +56,7 @@ static void ui_handle_ble_duration_selection(uint32_t duration_s)
     netsec_command_t cmd = { NETSEC_CMD_NONE };
     cmd.type = NETSEC_CMD_BLE_SCAN_START;
     cmd.data.ble_scan_start.duration_ms = duration_ms;
-    xQueueSend(netsec_command_queue, &cmd, 0);
+    sysmon_queue_send(SYSMON_QUEUE_NETSEC_COMMAND, &cmd, 0);
   }
 }
 
@@ -47,26 +67,105 @@ void ui_task(void * pvParameters)
   Serial.printf("UI Task started on core %d, priority %d\n",
                 xPortGetCoreID(), uxTaskPriorityGet(NULL));
   
-  // Initialize LVGL and drivers
+  // Display and touch first, then the splash: nothing else gates the first frame
+  int stage = boot_prof_begin("lvgl_port");
   lvgl_port_init();
-  
-  // Show main screen
-  ui_show_main_screen();
+  boot_prof_end(stage);
+
+  stage = boot_prof_begin("splash");
+  ui_show_splash();
+  lv_refr_now(NULL);
+  boot_prof_end(stage);
+  boot_prof_milestone(BOOT_MILESTONE_FIRST_FRAME);
+
+  EventGroupHandle_t boot_events = system_boot_events();
+  xEventGroupSetBits(boot_events, BOOT_EVT_FIRST_FRAME);
+
+  stage = boot_prof_begin("theme");
+  lvgl_port_apply_theme();
+  boot_prof_end(stage);
+  bool main_screen_shown = false;
   
   // Task loop: call lv_timer_handler() every ~5 ms
   TickType_t xLastWakeTime = xTaskGetTickCount();
   const TickType_t xFrequency = pdMS_TO_TICKS(5);  // 5 ms period
+  TickType_t last_heap_sample = xLastWakeTime;
   
   while (1) {
-    // Process LVGL internal timers and redraw
-    lv_timer_handler();
+    cpuprof_note_wake();
+
+    // Survey mode: the panel is dark and NETSEC folds the results itself
+    if (main_screen_shown && netsec_survey_is_active()) {
+      netsec_result_t dropped;
+      while (xQueueReceive(netsec_result_queue, &dropped, 0) == pdTRUE) {
+      }
+      vTaskDelay(pdMS_TO_TICKS(NETSEC_SURVEY_UI_POLL_MS));
+      xLastWakeTime = xTaskGetTickCount();
+      continue;
+    }
+
+    // Main screen reads its wallpaper from SPIFFS, mounted by the boot task
+    if (!main_screen_shown && (xEventGroupGetBits(boot_events) & BOOT_EVT_FS_READY)) {
+      stage = boot_prof_begin("main_screen");
+      ui_show_main_screen();
+      lv_refr_now(NULL);
+      boot_prof_end(stage);
+      boot_prof_milestone(BOOT_MILESTONE_INTERACTIVE);
+      xEventGroupSetBits(boot_events, BOOT_EVT_INTERACTIVE);
+      main_screen_shown = true;
+#ifdef LVGL_HEAP_RUN_BENCHMARK
+      lvgl_heap_run_benchmark();
+      ui_screen_mgr_run_stress(LVGL_HEAP_STRESS_CYCLES);
+#endif
+#ifdef UI_CELL_LABEL_RUN_BENCHMARK
+      ui_cell_label_run_benchmark();
+#endif
+#ifdef UI_BLE_RUN_BENCHMARK
+      ui_ble_run_background_benchmark();
+#endif
+#ifdef PET_SIM_RUN_BENCHMARK
+      pet_sim_run_benchmark();
+#endif
+#ifdef PERSIST_RUN_BENCHMARK
+      persist_run_benchmark();
+#endif
+#ifdef UI_DAYLIGHT_RUN_BENCHMARK
+      ui_daylight_run_benchmark();
+#endif
+#ifdef GAME_RT_RUN_BENCHMARK
+      game_rt_run_benchmark();
+#endif
+#ifdef ASSET_MAP_RUN_BENCHMARK
+      asset_map_run_benchmark();
+#endif
+#ifdef LVGL_FS_RUN_BENCHMARK
+      lvgl_fs_run_benchmark();
+#endif
+#ifdef STORAGE_FS_RUN_BENCHMARK
+      storage_fs_run_benchmark();
+#endif
+    }
+
+    // Process LVGL internal timers and redraw (a running game owns the panel)
+    if (game_rt_active()) {
+      game_rt_tick();
+    } else {
+      lv_timer_handler();
+    }
 
     // Handle NETSEC results (non-blocking)
     netsec_result_t netsec_res;
     while (xQueueReceive(netsec_result_queue, &netsec_res, 0) == pdTRUE) {
+      ui_screen_mgr_note_activity();
       switch (netsec_res.type) {
-        case NETSEC_RES_WIFI_AP:
-          ui_wifi_handle_ap_found(&netsec_res.data.wifi_ap);
+        case NETSEC_RES_DEVICE_ADDED:
+        case NETSEC_RES_DEVICE_CHANGED:
+        case NETSEC_RES_DEVICE_GONE:
+          if (netsec_res.data.device.kind == NETSEC_DEVICE_WIFI) {
+            ui_wifi_handle_device(netsec_res.type, &netsec_res.data.device);
+          } else {
+            ui_ble_handle_device(netsec_res.type, &netsec_res.data.device);
+          }
           break;
         case NETSEC_RES_WIFI_SCAN_DONE:
           ui_wifi_handle_scan_done();
@@ -75,9 +174,6 @@ void ui_task(void * pvParameters)
           ui_ble_handle_scan_started(&netsec_res.data.scan_summary);
           g_ble_ui_state = BLE_UI_STATE_SCANNING;
           break;
-        case NETSEC_RES_BLE_DEVICE_FOUND:
-          ui_ble_handle_device_found(&netsec_res.data.ble_device);
-          break;
         case NETSEC_RES_BLE_SCAN_COMPLETED:
           ui_ble_handle_scan_completed(&netsec_res.data.scan_summary);
           g_ble_ui_state = BLE_UI_STATE_IDLE;
@@ -94,70 +190,89 @@ void ui_task(void * pvParameters)
     // Handle UI events from queue (non-blocking)
     ui_event_t event;
     if (xQueueReceive(ui_event_queue, &event, 0) == pdTRUE) {
+      ui_screen_mgr_note_activity();
       ui_event_router_t router = ui_get_event_router();
       if (router) {
         router(event);
       }
+      serial_export_ui_event(event);
 
       // Process UI event
       switch (event) {
         case UI_EVENT_BUTTON_WIFI:
-          Serial.println("UI Event: WiFi button pressed");
+          DLOG_I("UI Event: WiFi button pressed");
           ui_show_wifi_screen();
           break;
 
         case UI_EVENT_BUTTON_BLE:
-          Serial.println("UI Event: BLE button pressed");
+          DLOG_I("UI Event: BLE button pressed");
           ui_show_ble_screen();
-          ui_ble_set_state_idle();
-          g_ble_ui_state = BLE_UI_STATE_IDLE;
+          // A scan keeps running in the background: the screen reconciles to it
+          if (g_ble_ui_state != BLE_UI_STATE_SCANNING) {
+            ui_ble_set_state_idle();
+            g_ble_ui_state = BLE_UI_STATE_IDLE;
+          }
           break;
 
         case UI_EVENT_BUTTON_MENU:
-          Serial.println("UI Event: Menu button pressed");
+          DLOG_I("UI Event: Menu button pressed");
           ui_show_settings_screen();
           break;
 
         case UI_EVENT_BLE_SCAN_REQUEST:
-          Serial.println("UI Event: BLE scan request");
+          DLOG_I("UI Event: BLE scan request");
           ui_ble_set_state_choosing_duration();
           g_ble_ui_state = BLE_UI_STATE_CHOOSING_DURATION;
           break;
 
         case UI_EVENT_BLE_DURATION_SELECTED_10S:
-          Serial.println("UI Event: BLE duration 10s selected");
+          DLOG_I("UI Event: BLE duration 10s selected");
           ui_handle_ble_duration_selection(10);
           break;
 
         case UI_EVENT_BLE_DURATION_SELECTED_20S:
-          Serial.println("UI Event: BLE duration 20s selected");
+          DLOG_I("UI Event: BLE duration 20s selected");
           ui_handle_ble_duration_selection(20);
           break;
 
         case UI_EVENT_BLE_DURATION_SELECTED_30S:
-          Serial.println("UI Event: BLE duration 30s selected");
+          DLOG_I("UI Event: BLE duration 30s selected");
           ui_handle_ble_duration_selection(30);
           break;
 
         case UI_EVENT_BLE_CANCEL:
-          Serial.println("UI Event: BLE scan cancel requested");
+          DLOG_I("UI Event: BLE scan cancel requested");
           if (g_ble_ui_state == BLE_UI_STATE_SCANNING && netsec_command_queue) {
             netsec_command_t cmd = { .type = NETSEC_CMD_BLE_SCAN_CANCEL };
-            xQueueSend(netsec_command_queue, &cmd, 0);
+            sysmon_queue_send(SYSMON_QUEUE_NETSEC_COMMAND, &cmd, 0);
           }
           ui_ble_cancel_scan();
           g_ble_ui_state = BLE_UI_STATE_IDLE;
           break;
 
         case UI_EVENT_BLE_SCAN_DONE:
-          Serial.println("UI Event: BLE scan done");
+          DLOG_I("UI Event: BLE scan done");
           ui_ble_handle_scan_completed(NULL);
           g_ble_ui_state = BLE_UI_STATE_IDLE;
           break;
 
+        case UI_EVENT_BUTTON_GAME:
+          DLOG_I("UI Event: Game button pressed");
+          ui_show_game_screen();
+          break;
+
+        case UI_EVENT_SURVEY_START:
+          DLOG_I("UI Event: Survey requested");
+          if (netsec_command_queue) {
+            netsec_command_t cmd = { .type = NETSEC_CMD_SURVEY_START };
+            sysmon_queue_send(SYSMON_QUEUE_NETSEC_COMMAND, &cmd, 0);
+          }
+          break;
+
         case UI_EVENT_UPDATE_PET:
-          Serial.println("UI Event: Update pet");
-          // Pet state updated, LVGL will redraw on next cycle
+          DLOG_I("UI Event: Update pet");
+          // Decide now instead of at the next simulation step
+          if (main_screen_shown) ui_main_screen_pet_step();
           break;
         
         default:
@@ -165,6 +280,17 @@ void ui_task(void * pvParameters)
       }
     }
     
+    // Screens need the theme from the main screen: prebuild/evict only after it
+    if (main_screen_shown && !game_rt_active()) {
+      ui_screen_mgr_tick();
+    }
+
+    // LVGL pool telemetry (must be sampled from the UI task)
+    if ((xTaskGetTickCount() - last_heap_sample) >= pdMS_TO_TICKS(SYSMON_SAMPLE_PERIOD_MS)) {
+      last_heap_sample = xTaskGetTickCount();
+      sysmon_sample_lvgl_heap();
+    }
+
     // Delay until next cycle
     vTaskDelayUntil(&xLastWakeTime, xFrequency);
   }
@@ -0,0 +1,101 @@
+/*
+ * netsec_ble: adaptive duty cycle against the simulated radio.
+ *   pio test -e native -f test_ble_duty
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include <stdio.h>
+
+#include "native_sim.h"
+#include "netsec_ble.h"
+
+#define SCAN_MS         30000U
+#define CROWD_MS        10000U
+#define FEW_DEVICES     24
+#define CROWD_DEVICES   400
+
+static netsec_ble_policy_t s_policy;   // Off the test task stack
+
+static void scan(uint16_t devices, bool adaptive, uint32_t duration_ms)
+{
+  sim_radio_config_t radio = {1, 40, devices};
+  sim_radio_configure(&radio);
+  netsec_ble_set_adaptive(adaptive);
+  netsec_ble_start_scan(duration_ms);
+  vTaskDelay(pdMS_TO_TICKS(100));
+  while (netsec_ble_is_scanning()) {
+    vTaskDelay(pdMS_TO_TICKS(250));
+  }
+  netsec_ble_get_policy(&s_policy);
+}
+
+static void report(const char* name)
+{
+  char line[128];
+  snprintf(line, sizeof(line), "%s: %u devices, radio on %lu of %lu ms, level %u at the end",
+           name, s_policy.unique, static_cast<unsigned long>(s_policy.radio_ms),
+           static_cast<unsigned long>(s_policy.scan_ms), s_policy.level);
+  TEST_MESSAGE(line);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// The fixed policy listens 99 % of the scan at level 0
+static void test_fixed_duty_stays_at_level_0(void)
+{
+  scan(FEW_DEVICES, false, SCAN_MS);
+  report("fixed");
+  TEST_ASSERT_FALSE(s_policy.adaptive);
+  TEST_ASSERT_GREATER_THAN_UINT8(0, s_policy.curve_len);
+  for (uint8_t i = 0; i < s_policy.curve_len; ++i) {
+    TEST_ASSERT_EQUAL_UINT8(0, s_policy.curve[i].level);
+  }
+  TEST_ASSERT_EQUAL_UINT32(s_policy.scan_ms * 99U / 100U, s_policy.radio_ms);
+}
+
+// Once every device nearby has been seen the radio steps down
+static void test_quiet_scan_steps_down(void)
+{
+  scan(FEW_DEVICES, false, SCAN_MS);
+  const uint16_t fixed_unique = s_policy.unique;
+  const uint32_t fixed_radio_ms = s_policy.radio_ms;
+
+  scan(FEW_DEVICES, true, SCAN_MS);
+  report("adaptive");
+  TEST_ASSERT_TRUE(s_policy.adaptive);
+  TEST_ASSERT_GREATER_THAN_UINT8(0, s_policy.curve[s_policy.curve_len - 1].level);
+  TEST_ASSERT_LESS_THAN_UINT32(fixed_radio_ms * 3U / 4U, s_policy.radio_ms);
+  // Devices present all along are still found
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(fixed_unique * 3U / 4U, s_policy.unique);
+}
+
+// More addresses than the seen table: the overflow still counts as new,
+// so the radio keeps listening while devices keep turning up
+static void test_crowd_counted_past_seen_table(void)
+{
+  scan(CROWD_DEVICES, true, CROWD_MS);
+  report("crowd");
+  TEST_ASSERT_GREATER_THAN_UINT32(NETSEC_BLE_SEEN_MAX + NETSEC_BLE_SEEN_MAX / 2, s_policy.unique);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(CROWD_DEVICES, s_policy.unique);
+  for (uint8_t i = 0; i < s_policy.curve_len; ++i) {
+    TEST_ASSERT_EQUAL_UINT8(0, s_policy.curve[i].level);
+  }
+}
+
+static int run_tests(void)
+{
+  netsec_ble_init();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_fixed_duty_stays_at_level_0);
+  RUN_TEST(test_quiet_scan_steps_down);
+  RUN_TEST(test_crowd_counted_past_seen_table);
+  return UNITY_END();
+}
+
+int main(void)
+{
+  return sim_test_main(run_tests);
+}
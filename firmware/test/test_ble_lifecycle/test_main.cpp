@@ -0,0 +1,330 @@
+/*
+ * netsec_ble: scan lifecycle against the simulated radio, and its state
+ * word raced by host threads. The sim kernel runs one task at a time, so
+ * only the threads interleave inside the compare-and-swap loops.
+ *   pio test -e native -f test_ble_lifecycle
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "native_sim.h"
+#include "netsec_ble.h"
+
+// Yield at one in four transition race points: the threads below then
+// interleave inside the CAS loops even on a single host CPU
+static void race_point(void)
+{
+  thread_local std::minstd_rand rng(std::hash<std::thread::id>()(std::this_thread::get_id()));
+  if ((rng() & 3) == 0) std::this_thread::yield();
+}
+#define BLE_LC_RACE_POINT() race_point()
+#include "netsec_ble_state.h"
+
+#define STRESS_TASKS    4
+#define STRESS_OPS      2000
+#define STRESS_STACK    3072
+#define LATENCY_RUNS    20
+#define IDLE_WAIT_MS    3000
+#define RACE_CALLERS    4
+#define RACE_OPS        200000
+#define RACE_IDLE_MS    2000    // Wall clock for the worker to settle
+
+typedef struct {
+  uint32_t starts;
+  uint32_t stops;
+} stress_slot_t;
+
+static TaskHandle_t s_owner = NULL;
+static stress_slot_t s_slots[STRESS_TASKS];
+
+static bool wait_idle(uint32_t timeout_ms)
+{
+  const uint32_t start = millis();
+  while (netsec_ble_is_scanning()) {
+    if (millis() - start >= timeout_ms) return false;
+    vTaskDelay(1);
+  }
+  return true;
+}
+
+static void check_finalized_once(const netsec_ble_lifecycle_stats_t* before)
+{
+  netsec_ble_lifecycle_stats_t after;
+  netsec_ble_get_lifecycle_stats(&after);
+  const uint32_t scans = after.started - before->started;
+  const uint32_t ended = (after.completed - before->completed) + (after.canceled - before->canceled);
+  TEST_ASSERT_EQUAL_UINT32(scans, ended);
+  TEST_ASSERT_EQUAL_UINT32(scans, after.generation - before->generation);
+  TEST_ASSERT_EQUAL_UINT32(0U, after.errors);
+}
+
+// Random starts (short durations, so timeouts fire too), stops and reads
+static void stress_task(void* arg)
+{
+  stress_slot_t* slot = static_cast<stress_slot_t*>(arg);
+  for (uint32_t i = 0; i < STRESS_OPS; ++i) {
+    const long op = random(100);
+    if (op < 10) {
+      netsec_ble_start_scan(static_cast<uint32_t>(random(2, 16)));
+      slot->starts++;
+    } else if (op < 15) {
+      netsec_ble_stop_scan();
+      slot->stops++;
+    } else {
+      (void)netsec_ble_is_scanning();
+    }
+    const long pause = random(8);
+    if (pause) {
+      vTaskDelay(static_cast<TickType_t>(pause));
+    } else {
+      taskYIELD();
+    }
+  }
+  xTaskNotifyGive(s_owner);
+  vTaskDelete(NULL);
+}
+
+void setUp(void)
+{
+  netsec_ble_stop_scan();
+  TEST_ASSERT_TRUE(wait_idle(IDLE_WAIT_MS));
+}
+
+void tearDown(void) {}
+
+static void test_scan_completes_on_timeout(void)
+{
+  netsec_ble_lifecycle_stats_t before, after;
+  netsec_ble_get_lifecycle_stats(&before);
+  netsec_ble_start_scan(1500);
+  vTaskDelay(pdMS_TO_TICKS(100));
+  TEST_ASSERT_TRUE(netsec_ble_is_scanning());
+  TEST_ASSERT_TRUE(wait_idle(IDLE_WAIT_MS));
+
+  netsec_ble_get_lifecycle_stats(&after);
+  TEST_ASSERT_EQUAL_UINT32(1U, after.started - before.started);
+  TEST_ASSERT_EQUAL_UINT32(1U, after.completed - before.completed);
+  TEST_ASSERT_EQUAL_UINT32(0U, after.canceled - before.canceled);
+  check_finalized_once(&before);
+}
+
+// A start while scanning cancels and goes straight into a new generation
+static void test_start_while_scanning_restarts(void)
+{
+  netsec_ble_lifecycle_stats_t before, after;
+  netsec_ble_get_lifecycle_stats(&before);
+  netsec_ble_start_scan(5000);
+  vTaskDelay(pdMS_TO_TICKS(200));
+  netsec_ble_start_scan(300);
+  vTaskDelay(pdMS_TO_TICKS(50));
+  TEST_ASSERT_TRUE(netsec_ble_is_scanning());
+  TEST_ASSERT_TRUE(wait_idle(IDLE_WAIT_MS));
+
+  netsec_ble_get_lifecycle_stats(&after);
+  TEST_ASSERT_EQUAL_UINT32(2U, after.started - before.started);
+  TEST_ASSERT_EQUAL_UINT32(1U, after.canceled - before.canceled);
+  TEST_ASSERT_EQUAL_UINT32(1U, after.completed - before.completed);
+  TEST_ASSERT_EQUAL_UINT32(1U, after.restarts - before.restarts);
+  check_finalized_once(&before);
+}
+
+// Sequential interleaving check: tasks pinned to both simulated cores
+// start and stop between each other's yields and delays, but never inside
+// a transition. Every generation is still finalized once.
+static void test_interleaved_start_stop_finalizes_once(void)
+{
+  netsec_ble_lifecycle_stats_t before, after;
+  netsec_ble_get_lifecycle_stats(&before);
+  s_owner = xTaskGetCurrentTaskHandle();
+
+  uint8_t running = 0;
+  for (uint8_t i = 0; i < STRESS_TASKS; ++i) {
+    s_slots[i].starts = 0;
+    s_slots[i].stops = 0;
+    if (xTaskCreatePinnedToCore(stress_task, "ble_stress", STRESS_STACK, &s_slots[i],
+                                1 + (i & 1), NULL, i & 1) == pdPASS) {
+      running++;
+    }
+  }
+  TEST_ASSERT_EQUAL_UINT8(STRESS_TASKS, running);
+  for (uint8_t i = 0; i < running; ++i) {
+    ulTaskNotifyTake(pdFALSE, portMAX_DELAY);
+  }
+  netsec_ble_stop_scan();
+  TEST_ASSERT_TRUE(wait_idle(IDLE_WAIT_MS));
+
+  uint32_t starts = 0, stops = 0;
+  for (uint8_t i = 0; i < running; ++i) {
+    starts += s_slots[i].starts;
+    stops += s_slots[i].stops;
+  }
+  netsec_ble_get_lifecycle_stats(&after);
+  char line[128];
+  snprintf(line, sizeof(line), "%lu starts, %lu stops -> %lu scans (%lu completed, %lu canceled, %lu restarts)",
+           static_cast<unsigned long>(starts), static_cast<unsigned long>(stops),
+           static_cast<unsigned long>(after.started - before.started),
+           static_cast<unsigned long>(after.completed - before.completed),
+           static_cast<unsigned long>(after.canceled - before.canceled),
+           static_cast<unsigned long>(after.restarts - before.restarts));
+  TEST_MESSAGE(line);
+  check_finalized_once(&before);
+  TEST_ASSERT_GREATER_THAN_UINT32(0U, after.completed - before.completed);
+  TEST_ASSERT_GREATER_THAN_UINT32(0U, after.canceled - before.canceled);
+}
+
+// A stop aborts the radio's blocking scan slice instead of waiting it out
+static void test_stop_reaches_idle_within_a_slice(void)
+{
+  uint32_t lat_max = 0;
+  for (uint32_t i = 0; i < LATENCY_RUNS; ++i) {
+    netsec_ble_start_scan(5000);
+    vTaskDelay(pdMS_TO_TICKS(random(50, 500)));
+    TEST_ASSERT_TRUE(netsec_ble_is_scanning());
+    const uint32_t t0 = millis();
+    netsec_ble_stop_scan();
+    TEST_ASSERT_TRUE(wait_idle(IDLE_WAIT_MS));
+    const uint32_t lat = millis() - t0;
+    if (lat > lat_max) lat_max = lat;
+  }
+  TEST_ASSERT_LESS_THAN_UINT32(100U, lat_max);
+}
+
+// Host threads race ble_lc_start / ble_lc_stop / ble_lc_timeout against a
+// worker thread running each generation (radio stubbed as a few spins):
+// each generation is run and finalized exactly once, and the word settles
+// to IDLE, never left in STARTING or STOPPING
+static void test_state_word_threads_finalize_once(void)
+{
+  std::atomic<uint32_t> word(BLE_STATE_IDLE);
+  std::atomic<uint32_t> timer_gen(0);
+  std::atomic<bool> worker_exit(false);
+  std::atomic<uint32_t> requests(0);
+  std::vector<uint8_t> runs(RACE_CALLERS * RACE_OPS + 2, 0);
+  std::vector<uint8_t> finals(runs.size(), 0);
+  uint32_t errors = 0, canceled = 0, completed = 0, restarts = 0, aborted = 0;
+
+  std::thread worker([&]() {
+    std::minstd_rand rng(7);
+    for (;;) {
+      uint32_t w = word.load(std::memory_order_acquire);
+      if (ble_state(w) != BLE_STATE_STARTING && ble_state(w) != BLE_STATE_STOPPING) {
+        if (worker_exit.load(std::memory_order_acquire)) return;
+        std::this_thread::yield();
+        continue;
+      }
+      const uint32_t gen = ble_gen(w);
+      if (gen >= runs.size()) {
+        errors++;
+        return;
+      }
+      runs[gen]++;
+      if (ble_lc_begin(word, w)) {
+        timer_gen.store(gen, std::memory_order_relaxed);
+        for (uint32_t slice = rng() % 64; slice && ble_state(word.load()) == BLE_STATE_SCANNING; --slice) {
+          if (rng() & 1) std::this_thread::yield();
+        }
+        ble_lc_end(word, gen);
+      } else {
+        aborted++;
+      }
+      uint32_t ended = 0;
+      if (!ble_lc_finalize(word, gen, &ended)) {
+        errors++;
+        continue;
+      }
+      finals[gen]++;
+      if (ended & BLE_FLAG_CANCELED) {
+        canceled++;
+      } else {
+        completed++;
+      }
+      if (ended & BLE_FLAG_RESTART) restarts++;
+    }
+  });
+
+  std::vector<std::thread> callers;
+  for (uint32_t c = 0; c < RACE_CALLERS; ++c) {
+    callers.emplace_back([&, c]() {
+      std::minstd_rand rng(100 + c);
+      for (uint32_t i = 0; i < RACE_OPS; ++i) {
+        const uint32_t op = rng() % 100;
+        if (op < 45) {
+          (void)ble_lc_start(word);
+        } else if (op < 80) {
+          (void)ble_lc_stop(word);
+        } else {
+          // Late expiries included: an earlier generation's timer
+          (void)ble_lc_timeout(word, timer_gen.load(std::memory_order_relaxed) - (op & 1));
+        }
+        requests.fetch_add(1, std::memory_order_relaxed);
+        if ((op & 7) == 0) std::this_thread::yield();
+      }
+    });
+  }
+  for (std::thread& t : callers) t.join();
+
+  // The last request may leave a scan running or a restart pending: one stop
+  // must bring the word back to IDLE
+  (void)ble_lc_stop(word);
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(RACE_IDLE_MS);
+  while (ble_state(word.load()) != BLE_STATE_IDLE && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::yield();
+  }
+  const uint32_t settled = word.load();
+  worker_exit.store(true, std::memory_order_release);
+  worker.join();
+
+  const uint32_t last = ble_gen(settled);
+  uint32_t missed = 0, twice = 0;
+  for (uint32_t gen = 1; gen <= last && gen < runs.size(); ++gen) {
+    if (runs[gen] != 1 || finals[gen] != 1) {
+      if (runs[gen] == 0 || finals[gen] == 0) {
+        missed++;
+      } else {
+        twice++;
+      }
+    }
+  }
+
+  char line[160];
+  snprintf(line, sizeof(line), "%lu requests -> %lu generations (%lu completed, %lu canceled, %lu before scanning, "
+           "%lu restarts)", static_cast<unsigned long>(requests.load()), static_cast<unsigned long>(last),
+           static_cast<unsigned long>(completed), static_cast<unsigned long>(canceled),
+           static_cast<unsigned long>(aborted), static_cast<unsigned long>(restarts));
+  TEST_MESSAGE(line);
+  TEST_ASSERT_EQUAL_UINT32(BLE_STATE_IDLE, ble_state(settled));
+  TEST_ASSERT_EQUAL_UINT32(0U, errors);
+  TEST_ASSERT_EQUAL_UINT32(0U, missed);
+  TEST_ASSERT_EQUAL_UINT32(0U, twice);
+  TEST_ASSERT_EQUAL_UINT32(last, completed + canceled);
+  // The race did exercise every path
+  TEST_ASSERT_GREATER_THAN_UINT32(0U, completed);
+  TEST_ASSERT_GREATER_THAN_UINT32(0U, aborted);
+  TEST_ASSERT_GREATER_THAN_UINT32(0U, restarts);
+}
+
+static int run_tests(void)
+{
+  netsec_ble_init();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_scan_completes_on_timeout);
+  RUN_TEST(test_start_while_scanning_restarts);
+  RUN_TEST(test_interleaved_start_stop_finalizes_once);
+  RUN_TEST(test_state_word_threads_finalize_once);
+  RUN_TEST(test_stop_reaches_idle_within_a_slice);
+  return UNITY_END();
+}
+
+int main(void)
+{
+  return sim_test_main(run_tests);
+}
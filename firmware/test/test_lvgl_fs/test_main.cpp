@@ -0,0 +1,203 @@
+/*
+ * lvgl_fs: the 'S:' driver through lv_fs_* on the scratch file system.
+ *   pio test -e native -f test_lvgl_fs
+ */
+
+#include <unity.h>
+#include <string.h>
+
+extern "C" {
+  #include "lvgl.h"
+}
+
+#include "native_sim.h"
+#include "lvgl_fs.h"
+#include "storage_fs.h"
+
+#define FILE_PATH   "S:/test.bin"
+#define ROW_BYTES   640U                    // One 320 px RGB565 row
+#define ROWS        240U
+#define FILE_SIZE   (4U + ROW_BYTES * ROWS) // Image header + rows
+#define CHUNK       4096U
+#define BIG_READ    (8U * LVGL_FS_READAHEAD)
+
+static uint8_t s_buf[BIG_READ];
+
+// File contents are a function of the offset: every byte checkable
+static inline uint8_t file_byte(uint32_t off)
+{
+  return static_cast<uint8_t>((off * 2654435761u) >> 24);
+}
+
+static bool matches(const uint8_t* data, uint32_t off, uint32_t len)
+{
+  for (uint32_t i = 0; i < len; ++i) {
+    if (data[i] != file_byte(off + i)) return false;
+  }
+  return true;
+}
+
+static void open_file(lv_fs_file_t* file)
+{
+  TEST_ASSERT_EQUAL_INT(LV_FS_RES_OK, lv_fs_open(file, FILE_PATH, LV_FS_MODE_RD));
+}
+
+static void read_at(lv_fs_file_t* file, uint32_t off, uint32_t len, uint32_t expect_len)
+{
+  uint32_t br = 0;
+  TEST_ASSERT_EQUAL_INT(LV_FS_RES_OK, lv_fs_seek(file, off, LV_FS_SEEK_SET));
+  TEST_ASSERT_EQUAL_INT(LV_FS_RES_OK, lv_fs_read(file, s_buf, len, &br));
+  TEST_ASSERT_EQUAL_UINT32(expect_len, br);
+  TEST_ASSERT_TRUE(matches(s_buf, off, br));
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+static void test_write_creates_file(void)
+{
+  lv_fs_file_t file;
+  TEST_ASSERT_EQUAL_INT(LV_FS_RES_OK, lv_fs_open(&file, FILE_PATH, LV_FS_MODE_WR));
+  for (uint32_t off = 0; off < FILE_SIZE; off += CHUNK) {
+    uint32_t n = FILE_SIZE - off < CHUNK ? FILE_SIZE - off : CHUNK;
+    for (uint32_t i = 0; i < n; ++i) s_buf[i] = file_byte(off + i);
+    uint32_t bw = 0;
+    TEST_ASSERT_EQUAL_INT(LV_FS_RES_OK, lv_fs_write(&file, s_buf, n, &bw));
+    TEST_ASSERT_EQUAL_UINT32(n, bw);
+  }
+  uint32_t pos = 0;
+  lv_fs_tell(&file, &pos);
+  TEST_ASSERT_EQUAL_UINT32(FILE_SIZE, pos);
+  TEST_ASSERT_EQUAL_INT(LV_FS_RES_OK, lv_fs_close(&file));
+}
+
+// Row by row, as the image decoder reads: each byte fetched once, one window at a time
+static void test_row_reads_fetch_each_window_once(void)
+{
+  lvgl_fs_stats_t before, after;
+  lv_fs_file_t file;
+  open_file(&file);
+  lvgl_fs_get_stats(&before);
+
+  uint32_t br = 0;
+  TEST_ASSERT_EQUAL_INT(LV_FS_RES_OK, lv_fs_read(&file, s_buf, 4, &br));
+  TEST_ASSERT_EQUAL_UINT32(4U, br);
+  for (uint32_t y = 0; y < ROWS; ++y) {
+    TEST_ASSERT_EQUAL_INT(LV_FS_RES_OK, lv_fs_read(&file, s_buf, ROW_BYTES, &br));
+    TEST_ASSERT_EQUAL_UINT32(ROW_BYTES, br);
+    TEST_ASSERT_TRUE(matches(s_buf, 4U + y * ROW_BYTES, ROW_BYTES));
+  }
+  lv_fs_close(&file);
+
+  lvgl_fs_get_stats(&after);
+  TEST_ASSERT_EQUAL_UINT32(FILE_SIZE, after.bytes_read - before.bytes_read);
+  TEST_ASSERT_EQUAL_UINT32(FILE_SIZE, after.backend_bytes - before.backend_bytes);
+  TEST_ASSERT_EQUAL_UINT32((FILE_SIZE + LVGL_FS_READAHEAD - 1) / LVGL_FS_READAHEAD,
+                           after.backend_reads - before.backend_reads);
+  TEST_ASSERT_EQUAL_UINT32(0U, after.backend_seeks - before.backend_seeks);
+  TEST_ASSERT_GREATER_THAN_UINT32(ROWS / 2, after.window_hits - before.window_hits);
+}
+
+// Seeks only move the position: the backend is asked when a read leaves the window
+static void test_seek_inside_window_skips_backend(void)
+{
+  lvgl_fs_stats_t before, after;
+  lv_fs_file_t file;
+  open_file(&file);
+
+  read_at(&file, 0, 10, 10);
+  lvgl_fs_get_stats(&before);
+  read_at(&file, 1000, 100, 100);
+  read_at(&file, 20, 300, 300);
+  lvgl_fs_get_stats(&after);
+  TEST_ASSERT_EQUAL_UINT32(0U, after.backend_reads - before.backend_reads);
+  TEST_ASSERT_EQUAL_UINT32(0U, after.backend_seeks - before.backend_seeks);
+  TEST_ASSERT_EQUAL_UINT32(2U, after.window_hits - before.window_hits);
+
+  // Elsewhere: one seek, one window
+  read_at(&file, 5U * LVGL_FS_READAHEAD + 7U, 64, 64);
+  lvgl_fs_get_stats(&before);
+  TEST_ASSERT_EQUAL_UINT32(1U, before.backend_reads - after.backend_reads);
+  TEST_ASSERT_EQUAL_UINT32(1U, before.backend_seeks - after.backend_seeks);
+  lv_fs_close(&file);
+}
+
+// Large reads go straight to the caller's buffer, whole windows at a time
+static void test_big_read_bypasses_window(void)
+{
+  lvgl_fs_stats_t before, after;
+  lv_fs_file_t file;
+  open_file(&file);
+  lvgl_fs_get_stats(&before);
+  read_at(&file, LVGL_FS_READAHEAD, BIG_READ, BIG_READ);
+  lvgl_fs_get_stats(&after);
+  lv_fs_close(&file);
+
+  TEST_ASSERT_EQUAL_UINT32(BIG_READ, after.backend_bytes - before.backend_bytes);
+  TEST_ASSERT_EQUAL_UINT32(0U, after.window_hits - before.window_hits);
+}
+
+static void test_reads_stop_at_end(void)
+{
+  lv_fs_file_t file;
+  open_file(&file);
+
+  uint32_t pos = 0;
+  TEST_ASSERT_EQUAL_INT(LV_FS_RES_OK, lv_fs_seek(&file, 0, LV_FS_SEEK_END));
+  lv_fs_tell(&file, &pos);
+  TEST_ASSERT_EQUAL_UINT32(FILE_SIZE, pos);
+
+  read_at(&file, FILE_SIZE - 100U, 200, 100);
+  read_at(&file, FILE_SIZE, 16, 0);
+  lv_fs_close(&file);
+}
+
+// Pool limit, path length and missing files are refused and counted
+static void test_refused_opens_counted(void)
+{
+  lvgl_fs_stats_t before, after;
+  lv_fs_file_t files[LVGL_FS_MAX_FILES + 1];
+  lvgl_fs_get_stats(&before);
+
+  uint32_t opened = 0;
+  for (uint32_t i = 0; i < LVGL_FS_MAX_FILES + 1; ++i) {
+    if (lv_fs_open(&files[i], FILE_PATH, LV_FS_MODE_RD) == LV_FS_RES_OK) opened++;
+  }
+  for (uint32_t i = 0; i < opened; ++i) lv_fs_close(&files[i]);
+
+  char long_path[LVGL_FS_PATH_MAX + 8];
+  memset(long_path, 'a', sizeof(long_path) - 1);
+  long_path[0] = 'S';
+  long_path[1] = ':';
+  long_path[sizeof(long_path) - 1] = '\0';
+  TEST_ASSERT_NOT_EQUAL(LV_FS_RES_OK, lv_fs_open(&files[0], long_path, LV_FS_MODE_RD));
+  TEST_ASSERT_NOT_EQUAL(LV_FS_RES_OK, lv_fs_open(&files[0], "S:/missing.bin", LV_FS_MODE_RD));
+
+  lvgl_fs_get_stats(&after);
+  TEST_ASSERT_EQUAL_UINT32(LVGL_FS_MAX_FILES, opened);
+  TEST_ASSERT_EQUAL_UINT32(1U, after.pool_exhausted - before.pool_exhausted);
+  TEST_ASSERT_EQUAL_UINT32(1U, after.path_too_long - before.path_too_long);
+  TEST_ASSERT_EQUAL_UINT32(1U, after.open_fails - before.open_fails);
+  TEST_ASSERT_EQUAL_UINT32(LVGL_FS_MAX_FILES, after.open_max);
+}
+
+static int run_tests(void)
+{
+  storage_fs_mount();
+  lv_init();
+  lvgl_fs_register();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_write_creates_file);
+  RUN_TEST(test_row_reads_fetch_each_window_once);
+  RUN_TEST(test_seek_inside_window_skips_backend);
+  RUN_TEST(test_big_read_bypasses_window);
+  RUN_TEST(test_reads_stop_at_end);
+  RUN_TEST(test_refused_opens_counted);
+  return UNITY_END();
+}
+
+int main(void)
+{
+  return sim_test_main(run_tests);
+}
@@ -0,0 +1,110 @@
+/*
+ * persist: power cuts on a RAM copy of the store, then saves through the
+ * writer task on the simulated "petstate" partition.
+ *   pio test -e native -f test_persist
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "native_sim.h"
+#include "persist.h"
+
+#define SWITCH_SAVES  40U   // More records than one 4 KB bank holds
+
+static void fill_blob(uint8_t* blob, uint16_t len, uint8_t tag)
+{
+  for (uint16_t i = 0; i < len; ++i) blob[i] = static_cast<uint8_t>(tag * 31U + i);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Every cut of a record write or a bank switch leaves the old or the new blob
+static void test_power_cuts_recover(void)
+{
+  uint32_t cases = 0;
+  uint32_t failures = persist_check_power_cuts(&cases);
+
+  char line[64];
+  snprintf(line, sizeof(line), "%lu cut offsets", static_cast<unsigned long>(cases));
+  TEST_MESSAGE(line);
+  TEST_ASSERT_GREATER_THAN_UINT32(PERSIST_SLOT_SIZE, cases);
+  TEST_ASSERT_EQUAL_UINT32(0U, failures);
+}
+
+// Changes before the deadline share one write, identical saves are dropped
+static void test_saves_coalesce_into_one_write(void)
+{
+  uint8_t blob[PERSIST_PAYLOAD_MAX];
+  persist_stats_t before, after;
+  persist_get_stats(&before);
+
+  fill_blob(blob, 24, 1);
+  TEST_ASSERT_TRUE(persist_save(blob, 24));
+  fill_blob(blob, 24, 2);
+  TEST_ASSERT_TRUE(persist_save(blob, 24));
+  TEST_ASSERT_TRUE(persist_save(blob, 24));
+  TEST_ASSERT_TRUE(persist_flush(2000));
+
+  persist_get_stats(&after);
+  TEST_ASSERT_EQUAL_UINT32(3U, after.saves - before.saves);
+  TEST_ASSERT_EQUAL_UINT32(1U, after.coalesced - before.coalesced);
+  TEST_ASSERT_EQUAL_UINT32(1U, after.unchanged - before.unchanged);
+  TEST_ASSERT_EQUAL_UINT32(1U, after.written - before.written);
+  TEST_ASSERT_EQUAL_UINT32(before.seq + 1U, after.seq);
+  TEST_ASSERT_EQUAL_UINT32(0U, after.failed);
+
+  // Same blob as the stored one: nothing to write
+  TEST_ASSERT_TRUE(persist_save(blob, 24));
+  TEST_ASSERT_TRUE(persist_flush(2000));
+  persist_get_stats(&before);
+  TEST_ASSERT_EQUAL_UINT32(after.written, before.written);
+}
+
+static void test_oversized_blob_rejected(void)
+{
+  uint8_t blob[PERSIST_PAYLOAD_MAX + 1];
+  fill_blob(blob, sizeof(blob), 3);
+  TEST_ASSERT_FALSE(persist_save(blob, sizeof(blob)));
+  TEST_ASSERT_FALSE(persist_save(blob, 0));
+}
+
+// Filling a bank switches to the other one without a failed write
+static void test_bank_switch_on_partition(void)
+{
+  uint8_t blob[PERSIST_PAYLOAD_MAX];
+  persist_stats_t before, after;
+  persist_get_stats(&before);
+
+  for (uint32_t i = 0; i < SWITCH_SAVES; ++i) {
+    uint16_t len = static_cast<uint16_t>(8U + (i * 13U) % (PERSIST_PAYLOAD_MAX - 8U));
+    fill_blob(blob, len, static_cast<uint8_t>(0x40U + i));
+    TEST_ASSERT_TRUE(persist_save(blob, len));
+    TEST_ASSERT_TRUE(persist_flush(2000));
+  }
+
+  persist_get_stats(&after);
+  TEST_ASSERT_EQUAL_UINT32(SWITCH_SAVES, after.written - before.written);
+  TEST_ASSERT_EQUAL_UINT32(before.seq + SWITCH_SAVES, after.seq);
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(1U, after.erases - before.erases);
+  TEST_ASSERT_EQUAL_UINT32(0U, after.failed);
+}
+
+static int run_tests(void)
+{
+  persist_init();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_power_cuts_recover);
+  RUN_TEST(test_saves_coalesce_into_one_write);
+  RUN_TEST(test_oversized_blob_rejected);
+  RUN_TEST(test_bank_switch_on_partition);
+  return UNITY_END();
+}
+
+int main(void)
+{
+  return sim_test_main(run_tests);
+}
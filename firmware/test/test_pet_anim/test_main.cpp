@@ -0,0 +1,119 @@
+/*
+ * pet_anim: playback in virtual time, no display.
+ *   pio test -e native -f test_pet_anim
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "native_sim.h"
+#include "pet_anim.h"
+
+#define CHECK_MS    120000U   // Jittered playback compared to the 1 ms reference
+#define STATE_MS    60000U    // Steady playback per state
+#define TICK_MS     40U
+#define MAX_JITTER  120U
+
+static uint32_t next_rand(uint32_t* seed)
+{
+  *seed = *seed * 1664525U + 1013904223U;
+  return *seed >> 8;
+}
+
+// Scripted events at fixed virtual times, applied identically to both runs
+static void play_script(pet_anim_t* anim, uint32_t now_ms, uint32_t* next_event_ms, uint8_t* event)
+{
+  static const pet_state_t k_script[] = { PET_STATE_REACT, PET_STATE_EAT, PET_STATE_SLEEP, PET_STATE_REACT, PET_STATE_IDLE };
+  while (now_ms >= *next_event_ms) {
+    pet_anim_set_state(anim, k_script[*event % (sizeof(k_script) / sizeof(k_script[0]))]);
+    (*event)++;
+    *next_event_ms += 7300U;
+  }
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Late or early ticks land on the same state, step, offset and position
+static void test_jittered_ticks_match_1ms_reference(void)
+{
+  static pet_anim_t ref, run;
+  pet_rect_t dirty[PET_ANIM_MAX_RECTS];
+  uint32_t seed = 0x7E57A11U;
+  uint32_t ref_now = 0, now = 0, ticks = 0;
+  uint32_t ref_event_ms = 5000U, run_event_ms = 5000U;
+  uint8_t ref_event = 0, run_event = 0;
+
+  pet_anim_init(&ref);
+  pet_anim_init(&run);
+  while (now < CHECK_MS) {
+    uint32_t delta = 1U + next_rand(&seed) % MAX_JITTER;
+    // Events fire on tick boundaries: never tick across one
+    if (now < run_event_ms && now + delta > run_event_ms) delta = run_event_ms - now;
+    now += delta;
+    pet_anim_advance(&run, delta, dirty);
+    play_script(&run, now, &run_event_ms, &run_event);
+
+    while (ref_now < now) {
+      ref_now++;
+      pet_anim_advance(&ref, 1, dirty);
+    }
+    play_script(&ref, ref_now, &ref_event_ms, &ref_event);
+
+    ticks++;
+    TEST_ASSERT_EQUAL_INT(ref.state, run.state);
+    TEST_ASSERT_EQUAL_UINT8(ref.step, run.step);
+    TEST_ASSERT_EQUAL_UINT32(ref.step_elapsed_ms, run.step_elapsed_ms);
+    TEST_ASSERT_EQUAL_INT(ref.x, run.x);
+  }
+  TEST_ASSERT_GREATER_THAN_UINT32(1000U, ticks);
+  TEST_ASSERT_GREATER_THAN_UINT32(0U, run.stats.frames);
+}
+
+// Every state invalidates less than repainting the whole box on each change
+static void test_dirty_area_below_full_box(void)
+{
+  pet_rect_t dirty[PET_ANIM_MAX_RECTS];
+  for (uint8_t s = 0; s < PET_STATE_COUNT; ++s) {
+    static pet_anim_t anim;
+    uint32_t full_px = 0;
+    pet_anim_init(&anim);
+    pet_anim_set_state(&anim, static_cast<pet_state_t>(s));
+
+    for (uint32_t t = 0; t < STATE_MS; t += TICK_MS) {
+      int16_t x_before = anim.shown_x;
+      uint8_t n = pet_anim_advance(&anim, TICK_MS, dirty);
+      TEST_ASSERT_LESS_OR_EQUAL_UINT32(PET_ANIM_MAX_RECTS, n);
+      if (n) {
+        int32_t dx = anim.shown_x - x_before;
+        full_px += static_cast<uint32_t>(PET_BOX_W + (dx < 0 ? -dx : dx)) * PET_BOX_H;
+      }
+      // Keep one-shot states playing for the whole window
+      if (anim.state != s) pet_anim_set_state(&anim, static_cast<pet_state_t>(s));
+    }
+
+    char line[128];
+    snprintf(line, sizeof(line), "%-5s: %lu frames, %lu moves, %lu px/s dirty vs %lu px/s full box",
+             pet_anim_state_name(static_cast<pet_state_t>(s)),
+             static_cast<unsigned long>(anim.stats.frames), static_cast<unsigned long>(anim.stats.moves),
+             static_cast<unsigned long>(anim.stats.px_dirty / (STATE_MS / 1000U)),
+             static_cast<unsigned long>(full_px / (STATE_MS / 1000U)));
+    TEST_MESSAGE(line);
+    TEST_ASSERT_GREATER_THAN_UINT32(0U, anim.stats.frames);
+    TEST_ASSERT_LESS_THAN_UINT32(full_px, anim.stats.px_dirty);
+  }
+}
+
+static int run_tests(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_jittered_ticks_match_1ms_reference);
+  RUN_TEST(test_dirty_area_below_full_box);
+  return UNITY_END();
+}
+
+int main(void)
+{
+  return sim_test_main(run_tests);
+}
@@ -0,0 +1,329 @@
+/*
+ * netsec_registry: diffs applied to a model as the UI does, through BLE
+ * address churn and a result queue left full, on the simulated clock.
+ *   pio test -e native -f test_registry
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "native_sim.h"
+#include "netsec_api.h"
+#include "netsec_registry.h"
+#include "sysmon.h"
+
+#define QUEUE_LEN       (NETSEC_REGISTRY_CAPACITY * 2)   // A whole aging pass of GONE diffs
+#define CHURN_SCANS     300
+#define HELD_SCANS      40    // Queue not drained: far more diffs than it holds
+#define APS             12
+#define FIXED           10    // BLE devices with a public address
+#define PHONES          16    // Address rotating every ROTATE scans
+#define ROTATE          20
+#define ONESHOT         8     // Addresses seen in a single BLE scan
+#define WIFI_MS         5000
+#define BLE_MS          15000
+#define MODEL_MAX       (NETSEC_REGISTRY_CAPACITY + 8)
+
+// The UI side: what the diffs alone say is present
+typedef struct {
+  uint8_t kind[MODEL_MAX];
+  uint8_t addr[MODEL_MAX][6];
+  uint16_t count;
+  uint32_t errors;
+  uint32_t fixed_evicted;
+  uint32_t added;
+  uint32_t changed;
+  uint32_t gone;
+} model_t;
+
+static QueueHandle_t s_queue;
+static model_t s_model;
+static bool s_held;           // The UI not draining the queue
+static uint32_t s_oneshot_id;
+static uint32_t s_rng = 0x2545F491u;
+
+static uint32_t rnd(void)
+{
+  s_rng ^= s_rng << 13;
+  s_rng ^= s_rng >> 17;
+  s_rng ^= s_rng << 5;
+  return s_rng;
+}
+
+// Fixed APs and devices: 0x24 / 0x3C prefixes; the rest from 0x40
+static void addr_of(uint8_t prefix, uint32_t id, uint8_t* addr)
+{
+  addr[0] = prefix;
+  addr[1] = 0x5A;
+  addr[2] = static_cast<uint8_t>(id >> 24);
+  addr[3] = static_cast<uint8_t>(id >> 16);
+  addr[4] = static_cast<uint8_t>(id >> 8);
+  addr[5] = static_cast<uint8_t>(id);
+}
+
+static int16_t model_find(uint8_t kind, const uint8_t* addr)
+{
+  for (uint16_t i = 0; i < s_model.count; ++i) {
+    if (s_model.kind[i] == kind && memcmp(s_model.addr[i], addr, 6) == 0) return static_cast<int16_t>(i);
+  }
+  return -1;
+}
+
+static void apply(const netsec_result_t* res)
+{
+  const netsec_device_t* d = &res->data.device;
+  const int16_t at = model_find(d->kind, d->addr);
+  switch (res->type) {
+    case NETSEC_RES_DEVICE_ADDED:
+      s_model.added++;
+      if (at >= 0 || s_model.count >= MODEL_MAX) {
+        s_model.errors++;
+        return;
+      }
+      s_model.kind[s_model.count] = d->kind;
+      memcpy(s_model.addr[s_model.count], d->addr, 6);
+      s_model.count++;
+      break;
+    case NETSEC_RES_DEVICE_CHANGED:
+      s_model.changed++;
+      if (at < 0) s_model.errors++;
+      break;
+    case NETSEC_RES_DEVICE_GONE:
+      s_model.gone++;
+      if (at < 0) {
+        s_model.errors++;
+        return;
+      }
+      // A fixed device pushed out while still reported
+      if (d->addr[0] < 0x40 && millis() - d->last_seen_ms < NETSEC_REGISTRY_GONE_MS) s_model.fixed_evicted++;
+      s_model.count--;
+      s_model.kind[at] = s_model.kind[s_model.count];
+      memcpy(s_model.addr[at], s_model.addr[s_model.count], 6);
+      break;
+    default:
+      s_model.errors++;
+      break;
+  }
+}
+
+static void drain(void)
+{
+  netsec_result_t res;
+  while (!s_held && xQueueReceive(s_queue, &res, 0) == pdTRUE) apply(&res);
+}
+
+static void report(netsec_device_kind_t kind, const uint8_t* addr, int8_t rssi)
+{
+  netsec_registry_report(kind, addr, rssi, "", kind == NETSEC_DEVICE_WIFI ? 6 : 0, 0);
+  drain();
+}
+
+static void scan_done(netsec_device_kind_t kind)
+{
+  netsec_registry_scan_done(kind);
+  drain();
+}
+
+static int8_t rssi_of(uint32_t id)
+{
+  return static_cast<int8_t>(-45 - static_cast<int>(id % 40) + static_cast<int>(rnd() % 7) - 3);
+}
+
+// The model holds exactly the present records
+static bool model_consistent(void)
+{
+  netsec_registry_stats_t st;
+  netsec_registry_get_stats(&st);
+  netsec_device_t dev;
+  for (uint16_t i = 0; i < s_model.count; ++i) {
+    if (!netsec_registry_lookup(static_cast<netsec_device_kind_t>(s_model.kind[i]), s_model.addr[i], &dev)) {
+      return false;
+    }
+  }
+  return st.present[NETSEC_DEVICE_WIFI] + st.present[NETSEC_DEVICE_BLE] == s_model.count;
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// First report adds, small RSSI moves are folded, a step sends CHANGED; a
+// device missing scans goes, and comes back with its history
+static void test_added_changed_gone(void)
+{
+  const netsec_registry_policy_t policy = {2, 0, 0, NETSEC_REGISTRY_RSSI_STEP};
+  netsec_registry_set_policy(&policy);
+  uint8_t addr[6];
+  addr_of(0x50, 0xAB, addr);   // Not a fixed device for the churn test
+
+  report(NETSEC_DEVICE_WIFI, addr, -50);
+  TEST_ASSERT_EQUAL_UINT32(1U, s_model.added);
+  report(NETSEC_DEVICE_WIFI, addr, -52);
+  TEST_ASSERT_EQUAL_UINT32(0U, s_model.changed);
+  report(NETSEC_DEVICE_WIFI, addr, -60);
+  TEST_ASSERT_EQUAL_UINT32(1U, s_model.changed);
+
+  netsec_device_t dev;
+  TEST_ASSERT_TRUE(netsec_registry_lookup(NETSEC_DEVICE_WIFI, addr, &dev));
+  TEST_ASSERT_EQUAL_UINT32(3U, dev.seen_count);
+  TEST_ASSERT_EQUAL_INT8(-60, dev.rssi_min);
+  TEST_ASSERT_EQUAL_INT8(-50, dev.rssi_max);
+  const uint32_t first_seen = dev.first_seen_ms;
+
+  scan_done(NETSEC_DEVICE_WIFI);   // Scan it was reported in
+  scan_done(NETSEC_DEVICE_BLE);    // Other kind: not aged
+  scan_done(NETSEC_DEVICE_WIFI);
+  TEST_ASSERT_EQUAL_UINT32(0U, s_model.gone);
+  scan_done(NETSEC_DEVICE_WIFI);
+  TEST_ASSERT_EQUAL_UINT32(1U, s_model.gone);
+
+  vTaskDelay(pdMS_TO_TICKS(1000));
+  report(NETSEC_DEVICE_WIFI, addr, -55);
+  TEST_ASSERT_EQUAL_UINT32(2U, s_model.added);
+  TEST_ASSERT_TRUE(netsec_registry_lookup(NETSEC_DEVICE_WIFI, addr, &dev));
+  TEST_ASSERT_EQUAL_UINT32(first_seen, dev.first_seen_ms);
+  TEST_ASSERT_EQUAL_UINT32(4U, dev.seen_count);
+  TEST_ASSERT_EQUAL_UINT32(0U, s_model.errors);
+  TEST_ASSERT_TRUE(model_consistent());
+}
+
+// One WiFi and one BLE scan: fixed APs and devices, rotating phones and
+// one-shot addresses
+static void churn_scan(uint32_t scan)
+{
+  uint8_t addr[6];
+  // WiFi: fixed APs, 90 % of them each scan
+  for (uint32_t ap = 0; ap < APS; ++ap) {
+    if (rnd() % 100U < 90U) {
+      addr_of(0x24, ap, addr);
+      report(NETSEC_DEVICE_WIFI, addr, rssi_of(ap));
+    }
+  }
+  vTaskDelay(pdMS_TO_TICKS(WIFI_MS));
+  scan_done(NETSEC_DEVICE_WIFI);
+
+  // BLE: fixed devices at 85 %, rotating phones, one-shot addresses, each
+  // reported one to three times in the scan
+  for (uint32_t slice = 0; slice < 3; ++slice) {
+    for (uint32_t dev = 0; dev < FIXED; ++dev) {
+      if (rnd() % 100U < 85U) {
+        addr_of(0x3C, dev, addr);
+        report(NETSEC_DEVICE_BLE, addr, rssi_of(dev));
+      }
+    }
+    for (uint32_t phone = 0; phone < PHONES; ++phone) {
+      if (rnd() % 100U < 60U) {
+        addr_of(0x40, (phone << 16) | ((scan + phone) / ROTATE), addr);
+        report(NETSEC_DEVICE_BLE, addr, rssi_of(phone));
+      }
+    }
+    for (uint32_t i = 0; i < ONESHOT; ++i) {
+      if (slice == 0 || rnd() % 100U < 50U) {
+        addr_of(0x48, s_oneshot_id + i, addr);
+        report(NETSEC_DEVICE_BLE, addr, rssi_of(i));
+      }
+    }
+    vTaskDelay(pdMS_TO_TICKS(BLE_MS / 3));
+  }
+  s_oneshot_id += ONESHOT;
+  scan_done(NETSEC_DEVICE_BLE);
+}
+
+// Records stay within the budget, the model matches every scan, fixed
+// devices are never pushed out
+static void test_churn_within_budget(void)
+{
+  const netsec_registry_policy_t policy = {
+    NETSEC_REGISTRY_MISSED_SCANS, NETSEC_REGISTRY_GONE_MS, NETSEC_REGISTRY_FORGET_MS, NETSEC_REGISTRY_RSSI_STEP,
+  };
+  netsec_registry_set_policy(&policy);
+
+  uint32_t inconsistent = 0;
+  for (uint32_t scan = 0; scan < CHURN_SCANS; ++scan) {
+    churn_scan(scan);
+    if (!model_consistent()) inconsistent++;
+  }
+
+  netsec_registry_stats_t st;
+  netsec_registry_get_stats(&st);
+  char line[160];
+  snprintf(line, sizeof(line), "%lu reports: diffs +%lu ~%lu -%lu, peak %u/%u, %lu evicted, %lu recycled, %lu forgotten",
+           static_cast<unsigned long>(st.reports), static_cast<unsigned long>(st.added),
+           static_cast<unsigned long>(st.changed), static_cast<unsigned long>(st.gone_sent), st.peak, st.capacity,
+           static_cast<unsigned long>(st.evicted), static_cast<unsigned long>(st.recycled),
+           static_cast<unsigned long>(st.forgotten));
+  TEST_MESSAGE(line);
+
+  TEST_ASSERT_EQUAL_UINT32(0U, s_model.errors);
+  TEST_ASSERT_EQUAL_UINT32(0U, inconsistent);
+  TEST_ASSERT_EQUAL_UINT32(0U, s_model.fixed_evicted);
+  TEST_ASSERT_EQUAL_UINT32(0U, st.diffs_deferred);
+  TEST_ASSERT_EQUAL_UINT32(0U, st.refused);
+  TEST_ASSERT_EQUAL_UINT32(0U, st.pending);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(NETSEC_REGISTRY_BUDGET, st.bytes);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(NETSEC_REGISTRY_CAPACITY, st.peak);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(NETSEC_REGISTRY_CAPACITY, s_model.count);
+  // The churn did fill the table
+  TEST_ASSERT_GREATER_THAN_UINT32(0U, st.evicted + st.recycled);
+}
+
+// The UI stalls while the churn goes on: the queue fills and refuses diffs,
+// GONE ones included. Once it drains, one scan brings the model back to the
+// present records, with no stale row left.
+static void test_full_queue_catches_up(void)
+{
+  netsec_registry_stats_t before, st;
+  netsec_registry_get_stats(&before);
+
+  s_held = true;
+  for (uint32_t scan = 0; scan < HELD_SCANS; ++scan) churn_scan(CHURN_SCANS + scan);
+  netsec_registry_get_stats(&st);
+  TEST_ASSERT_EQUAL_UINT32(0U, uxQueueSpacesAvailable(s_queue));
+  TEST_ASSERT_GREATER_THAN_UINT32(before.diffs_deferred, st.diffs_deferred);
+  TEST_ASSERT_GREATER_THAN_UINT32(0U, st.pending);
+  TEST_ASSERT_GREATER_THAN_UINT32(before.evicted, st.evicted);
+  TEST_ASSERT_FALSE(model_consistent());
+
+  s_held = false;
+  drain();
+  scan_done(NETSEC_DEVICE_WIFI);
+  netsec_registry_get_stats(&st);
+  char line[160];
+  snprintf(line, sizeof(line), "%lu diffs deferred, %lu new addresses refused, %lu GONE sent",
+           static_cast<unsigned long>(st.diffs_deferred - before.diffs_deferred),
+           static_cast<unsigned long>(st.refused - before.refused),
+           static_cast<unsigned long>(st.gone_sent - before.gone_sent));
+  TEST_MESSAGE(line);
+
+  TEST_ASSERT_EQUAL_UINT32(0U, st.pending);
+  TEST_ASSERT_EQUAL_UINT32(0U, st.diffs_lost);
+  TEST_ASSERT_EQUAL_UINT32(0U, s_model.errors);
+  TEST_ASSERT_TRUE(model_consistent());
+
+  // And stays in step as the churn goes on
+  uint32_t inconsistent = 0;
+  for (uint32_t scan = 0; scan < 20; ++scan) {
+    churn_scan(CHURN_SCANS + HELD_SCANS + scan);
+    if (!model_consistent()) inconsistent++;
+  }
+  TEST_ASSERT_EQUAL_UINT32(0U, inconsistent);
+  TEST_ASSERT_EQUAL_UINT32(0U, s_model.errors);
+}
+
+static int run_tests(void)
+{
+  s_queue = xQueueCreate(QUEUE_LEN, sizeof(netsec_result_t));
+  sysmon_register_queue(SYSMON_QUEUE_NETSEC_RESULT, s_queue, "net_res", QUEUE_LEN);
+
+  UNITY_BEGIN();
+  RUN_TEST(test_added_changed_gone);
+  RUN_TEST(test_churn_within_budget);
+  RUN_TEST(test_full_queue_catches_up);
+  return UNITY_END();
+}
+
+int main(void)
+{
+  return sim_test_main(run_tests);
+}
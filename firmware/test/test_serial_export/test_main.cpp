@@ -0,0 +1,150 @@
+/*
+ * serial_export: frames built by the firmware encoder, decoded the way
+ * tools/serial_export.py does, and compared byte for byte with its encoder.
+ *   pio test -e native -f test_serial_export
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "native_sim.h"
+#include "serial_export.h"
+
+#define MAX_PAYLOAD     (SERIAL_EXPORT_MAX_FRAME - 8 - 2)
+
+typedef struct {
+  serial_export_record_t type;
+  uint16_t seq;
+  uint32_t timestamp_ms;
+  uint8_t payload[16];
+  size_t payload_len;
+  uint8_t wire[32];
+  size_t wire_len;
+} golden_t;
+
+// build_frame(type, seq, timestamp_ms, payload) of tools/serial_export.py
+static const golden_t k_golden[] = {
+  {SERIAL_EXPORT_REC_UI_EVENT, 0x0000, 0x00000000, {0x03}, 1,
+   {0x00, 0x03, 0x01, 0x04, 0x01, 0x01, 0x01, 0x01, 0x01, 0x04, 0x03, 0x5F, 0xCC, 0x00}, 14},
+  {SERIAL_EXPORT_REC_BLE_DEVICE, 0x1234, 0x00010203,
+   {0xAA, 0xBB, 0x00, 0x00, 0x01, 0x02, 0xBD, 0x00, 0x00, 0x00, 0x00, 0x03, 'd', 'e', 'v'}, 15,
+   {0x00, 0x08, 0x01, 0x01, 0x34, 0x12, 0x03, 0x02, 0x01, 0x03, 0xAA, 0xBB, 0x01, 0x04, 0x01, 0x02,
+    0xBD, 0x01, 0x01, 0x01, 0x07, 0x03, 0x64, 0x65, 0x76, 0x71, 0x54, 0x00}, 28},
+  {SERIAL_EXPORT_REC_STATS, 0xFFFF, 0xDEADBEEF,
+   {0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00}, 12,
+   {0x00, 0x0A, 0x01, 0x05, 0xFF, 0xFF, 0xEF, 0xBE, 0xAD, 0xDE, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01,
+    0x01, 0x01, 0x02, 0x01, 0x01, 0x03, 0xFB, 0x33, 0x00}, 25},
+};
+
+// Bit by bit, as the host computes it (the firmware uses a nibble table)
+static uint16_t host_crc16(const uint8_t* data, size_t len)
+{
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; ++i) {
+    crc ^= static_cast<uint16_t>(data[i] << 8);
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021) : static_cast<uint16_t>(crc << 1);
+    }
+  }
+  return crc;
+}
+
+// Decoder.feed + cobs_decode of the host: the bytes between the two
+// delimiters, 0 when the segment is not valid COBS
+static size_t host_decode(const uint8_t* wire, size_t wire_len, uint8_t* out)
+{
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(3, wire_len);
+  TEST_ASSERT_EQUAL_HEX8(0x00, wire[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x00, wire[wire_len - 1]);
+  const uint8_t* seg = wire + 1;
+  const size_t seg_len = wire_len - 2;
+  TEST_ASSERT_NULL(memchr(seg, 0x00, seg_len));
+
+  size_t out_len = 0;
+  size_t idx = 0;
+  while (idx < seg_len) {
+    const uint8_t code = seg[idx];
+    if (idx + code > seg_len) return 0;
+    memcpy(&out[out_len], &seg[idx + 1], code - 1U);
+    out_len += code - 1U;
+    idx += code;
+    if (code < 0xFF && idx < seg_len) out[out_len++] = 0x00;
+  }
+  return out_len;
+}
+
+static void check_decodes(serial_export_record_t type, uint16_t seq, uint32_t timestamp_ms,
+                          const uint8_t* payload, size_t payload_len)
+{
+  uint8_t wire[SERIAL_EXPORT_MAX_ENCODED];
+  const size_t wire_len = serial_export_encode(type, seq, timestamp_ms, payload, payload_len, wire);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, wire_len);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(SERIAL_EXPORT_MAX_ENCODED, wire_len);
+
+  uint8_t raw[SERIAL_EXPORT_MAX_ENCODED];
+  const size_t raw_len = host_decode(wire, wire_len, raw);
+  TEST_ASSERT_EQUAL_UINT32(8 + payload_len + 2, raw_len);
+  TEST_ASSERT_EQUAL_HEX16(host_crc16(raw, raw_len - 2), raw[raw_len - 2] | (raw[raw_len - 1] << 8));
+  TEST_ASSERT_EQUAL_UINT8(SERIAL_EXPORT_PROTOCOL_VERSION, raw[0]);
+  TEST_ASSERT_EQUAL_UINT8(type, raw[1]);
+  TEST_ASSERT_EQUAL_HEX16(seq, raw[2] | (raw[3] << 8));
+  TEST_ASSERT_EQUAL_HEX32(timestamp_ms, static_cast<uint32_t>(raw[4]) | (static_cast<uint32_t>(raw[5]) << 8) |
+                                        (static_cast<uint32_t>(raw[6]) << 16) | (static_cast<uint32_t>(raw[7]) << 24));
+  if (payload_len) TEST_ASSERT_EQUAL_MEMORY(payload, &raw[8], payload_len);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Same bytes on the wire as the host encoder
+static void test_frames_match_host_encoder(void)
+{
+  for (const golden_t& g : k_golden) {
+    uint8_t wire[SERIAL_EXPORT_MAX_ENCODED];
+    const size_t wire_len = serial_export_encode(g.type, g.seq, g.timestamp_ms, g.payload, g.payload_len, wire);
+    TEST_ASSERT_EQUAL_UINT32(g.wire_len, wire_len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(g.wire, wire, wire_len);
+  }
+}
+
+// Every payload length up to the largest, with and without zero bytes,
+// decodes back with a valid CRC
+static void test_frames_decode_on_host_side(void)
+{
+  uint8_t payload[MAX_PAYLOAD];
+  uint32_t rng = 0x9E3779B9u;
+  for (size_t len = 0; len <= MAX_PAYLOAD; ++len) {
+    for (size_t i = 0; i < len; ++i) {
+      rng = rng * 1664525u + 1013904223u;
+      payload[i] = (len % 3 == 0) ? static_cast<uint8_t>(0x80 | (rng >> 24)) : static_cast<uint8_t>(rng >> 29);
+    }
+    check_decodes(SERIAL_EXPORT_REC_BLE_DEVICE, static_cast<uint16_t>(len * 1000U), rng, payload, len);
+  }
+  memset(payload, 0x00, sizeof(payload));
+  check_decodes(SERIAL_EXPORT_REC_WIFI_AP, 0x0000, 0x00000000, payload, MAX_PAYLOAD);
+  memset(payload, 0xFF, sizeof(payload));
+  check_decodes(SERIAL_EXPORT_REC_SCAN_SUMMARY, 0xFFFF, 0xFFFFFFFF, payload, MAX_PAYLOAD);
+}
+
+// A payload past the frame size is refused, nothing written
+static void test_oversized_payload_rejected(void)
+{
+  uint8_t payload[MAX_PAYLOAD + 1] = {0};
+  uint8_t wire[SERIAL_EXPORT_MAX_ENCODED];
+  TEST_ASSERT_EQUAL_UINT32(0, serial_export_encode(SERIAL_EXPORT_REC_UI_EVENT, 1, 1, payload, sizeof(payload), wire));
+}
+
+static int run_tests(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_frames_match_host_encoder);
+  RUN_TEST(test_frames_decode_on_host_side);
+  RUN_TEST(test_oversized_payload_rejected);
+  return UNITY_END();
+}
+
+int main(void)
+{
+  return sim_test_main(run_tests);
+}
@@ -0,0 +1,138 @@
+/*
+ * netsec_sketch: estimates within their error bounds against exact counts,
+ * on the simulated clock.
+ *   pio test -e native -f test_sketch
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include <stdio.h>
+
+#include "native_sim.h"
+#include "netsec_sketch.h"
+
+// 3 standard errors (1.04 / sqrt(registers)) for the HyperLogLog, 1/K for the histogram
+#define HLL_MAX_PCT     (3.0f * 104.0f / (1u << (NETSEC_SKETCH_HLL_P / 2)))
+#define EH_MAX_PCT      (100.0f / NETSEC_SKETCH_EH_K)
+#define WINDOW_S        (NETSEC_SKETCH_SLOTS * NETSEC_SKETCH_SLOT_S)
+
+static void addr_of(uint32_t id, uint8_t* addr)
+{
+  addr[0] = 0xC2;
+  addr[1] = 0x5A;
+  addr[2] = static_cast<uint8_t>(id >> 24);
+  addr[3] = static_cast<uint8_t>(id >> 16);
+  addr[4] = static_cast<uint8_t>(id >> 8);
+  addr[5] = static_cast<uint8_t>(id);
+}
+
+static void observe(netsec_sketch_kind_t kind, uint32_t first_id, uint32_t n)
+{
+  uint8_t addr[6];
+  for (uint32_t id = first_id; id < first_id + n; ++id) {
+    addr_of(id, addr);
+    netsec_sketch_observe(kind, addr);
+  }
+}
+
+static void check_error(const char* what, uint32_t estimate, uint32_t exact, float max_pct)
+{
+  const float pct = 100.0f * (static_cast<float>(estimate) - static_cast<float>(exact)) / static_cast<float>(exact);
+  char line[128];
+  snprintf(line, sizeof(line), "%s: %lu for %lu (%+.1f %%)", what, static_cast<unsigned long>(estimate),
+           static_cast<unsigned long>(exact), pct);
+  TEST_MESSAGE(line);
+  TEST_ASSERT_FLOAT_WITHIN(max_pct, 0.0f, pct);
+}
+
+void setUp(void)
+{
+  netsec_sketch_reset();
+}
+
+void tearDown(void) {}
+
+// Distinct counts from a few addresses to thousands, repeats not counted twice
+static void test_distinct_within_hll_bound(void)
+{
+  static const uint32_t sizes[] = {20, 200, 2000, 20000};
+  for (uint32_t n : sizes) {
+    observe(NETSEC_SKETCH_BLE, 0, n);
+    observe(NETSEC_SKETCH_BLE, 0, n / 2);
+    check_error("distinct BLE", netsec_sketch_unique(NETSEC_SKETCH_BLE, 0), n, HLL_MAX_PCT);
+  }
+  TEST_ASSERT_EQUAL_UINT32(0, netsec_sketch_unique(NETSEC_SKETCH_WIFI, 0));
+}
+
+// The window forgets slots older than the hour, the session count does not
+static void test_window_forgets_old_slots(void)
+{
+  observe(NETSEC_SKETCH_BLE, 0, 1000);
+  vTaskDelay(pdMS_TO_TICKS((WINDOW_S + NETSEC_SKETCH_SLOT_S) * 1000u));
+  observe(NETSEC_SKETCH_BLE, 1000, 300);
+
+  check_error("last hour", netsec_sketch_unique(NETSEC_SKETCH_BLE, WINDOW_S), 300, HLL_MAX_PCT);
+  check_error("session", netsec_sketch_unique(NETSEC_SKETCH_BLE, 0), 1300, HLL_MAX_PCT);
+}
+
+// Count-min never undercounts; the address reported most heads the list
+static void test_frequency_never_undercounts(void)
+{
+  uint8_t heavy[6];
+  addr_of(0xFFFF, heavy);
+  for (uint32_t round = 0; round < 50; ++round) {
+    for (uint32_t r = 0; r < 20; ++r) netsec_sketch_observe(NETSEC_SKETCH_BLE, heavy);
+    observe(NETSEC_SKETCH_BLE, 0, 1 + round % 5 * 100);
+  }
+
+  uint8_t addr[6];
+  for (uint32_t id = 0; id < 401; ++id) {
+    uint32_t exact = 0;
+    for (uint32_t round = 0; round < 50; ++round) {
+      if (id < 1 + round % 5 * 100) exact++;
+    }
+    addr_of(id, addr);
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(exact, netsec_sketch_frequency(NETSEC_SKETCH_BLE, addr));
+  }
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32(1000, netsec_sketch_frequency(NETSEC_SKETCH_BLE, heavy));
+
+  netsec_sketch_stats_t st;
+  netsec_sketch_get_stats(&st);
+  TEST_ASSERT_GREATER_THAN_UINT8(0, st.top_count);
+  TEST_ASSERT_EQUAL_UINT8(NETSEC_SKETCH_BLE, st.top[0].kind);
+  TEST_ASSERT_EQUAL_MEMORY(heavy, st.top[0].addr, 6);
+}
+
+// A steady stream: the last minute and the whole histogram within 1/K
+static void test_rate_within_eh_bound(void)
+{
+  const uint32_t per_second = 7;
+  for (uint32_t s = 0; s < NETSEC_SKETCH_EH_WINDOW_S + 60; ++s) {
+    observe(NETSEC_SKETCH_WIFI, s % 40, per_second);
+    vTaskDelay(pdMS_TO_TICKS(1000));
+  }
+  check_error("last minute", netsec_sketch_rate(NETSEC_SKETCH_WIFI, 60), 60 * per_second, EH_MAX_PCT);
+  check_error("last 10 min", netsec_sketch_rate(NETSEC_SKETCH_WIFI, NETSEC_SKETCH_EH_WINDOW_S),
+              NETSEC_SKETCH_EH_WINDOW_S * per_second, EH_MAX_PCT);
+  TEST_ASSERT_EQUAL_UINT32(0, netsec_sketch_rate(NETSEC_SKETCH_BLE, 60));
+
+  netsec_sketch_stats_t st;
+  netsec_sketch_get_stats(&st);
+  TEST_ASSERT_EQUAL_UINT32(0, st.eh_dropped);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT32(NETSEC_SKETCH_BUDGET, st.bytes);
+}
+
+static int run_tests(void)
+{
+  UNITY_BEGIN();
+  RUN_TEST(test_distinct_within_hll_bound);
+  RUN_TEST(test_window_forgets_old_slots);
+  RUN_TEST(test_frequency_never_undercounts);
+  RUN_TEST(test_rate_within_eh_bound);
+  return UNITY_END();
+}
+
+int main(void)
+{
+  return sim_test_main(run_tests);
+}
@@ -0,0 +1,146 @@
+/*
+ * netsec_survey: windows written to the file and memory bounds over many
+ * cycles, against the simulated radios and file system.
+ *   pio test -e native -f test_survey
+ */
+
+#include <unity.h>
+#include <Arduino.h>
+#include <FS.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "native_sim.h"
+#include "netsec_api.h"
+#include "netsec_ble.h"
+#include "netsec_survey.h"
+#include "storage_fs.h"
+
+#define PERIOD_S        60
+#define CYCLES          30      // Two full windows and a partial one
+#define CROWD_DEVICES   400
+#define CROWD_CYCLES    3
+#define RESULT_QUEUE_LEN 16
+
+extern QueueHandle_t netsec_result_queue;
+
+static netsec_survey_stats_t s_stats;
+
+static uint32_t file_size(void)
+{
+  fs::FS& vol = storage_fs();
+  if (!vol.exists(NETSEC_SURVEY_FILE)) return 0;
+  File f = vol.open(NETSEC_SURVEY_FILE, "r");
+  const uint32_t size = f ? static_cast<uint32_t>(f.size()) : 0;
+  f.close();
+  return size;
+}
+
+static void survey(uint32_t cycles)
+{
+  TEST_ASSERT_TRUE(netsec_survey_start(PERIOD_S));
+  do {
+    vTaskDelay(pdMS_TO_TICKS(1000));
+    netsec_survey_get_stats(&s_stats);
+  } while (s_stats.cycles < cycles);
+  netsec_survey_stop();
+  while (netsec_survey_is_active()) {
+    vTaskDelay(pdMS_TO_TICKS(100));
+  }
+  netsec_survey_get_stats(&s_stats);
+
+  char line[160];
+  snprintf(line, sizeof(line), "%lu cycles, peak %u/%u, overflow %lu, staging drops %lu, %lu batches, %lu B",
+           static_cast<unsigned long>(s_stats.cycles), s_stats.entries_peak, NETSEC_SURVEY_MAX_ENTRIES,
+           static_cast<unsigned long>(s_stats.overflow), static_cast<unsigned long>(s_stats.staged_dropped),
+           static_cast<unsigned long>(s_stats.batches), static_cast<unsigned long>(s_stats.file_bytes));
+  TEST_MESSAGE(line);
+}
+
+// Batches appended since `offset` parse back to the stats of the survey
+static void check_batches(uint32_t offset)
+{
+  TEST_ASSERT_EQUAL_UINT32(offset + s_stats.file_bytes, file_size());
+
+  File f = storage_fs().open(NETSEC_SURVEY_FILE, "r");
+  TEST_ASSERT_TRUE(static_cast<bool>(f));
+  TEST_ASSERT_TRUE(f.seek(offset));
+  uint32_t batches = 0;
+  uint32_t sweeps = 0;
+  netsec_survey_batch_t b;
+  while (f.read(reinterpret_cast<uint8_t*>(&b), sizeof(b)) == sizeof(b)) {
+    TEST_ASSERT_EQUAL_HEX32(NETSEC_SURVEY_BATCH_MAGIC, b.magic);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT16(NETSEC_SURVEY_MAX_ENTRIES, b.entries);
+    TEST_ASSERT_EQUAL_UINT16(b.entries, b.wifi_unique + b.ble_unique);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(b.end_s, b.start_s);
+    for (uint16_t i = 0; i < b.entries; ++i) {
+      netsec_survey_entry_t e;
+      TEST_ASSERT_EQUAL(sizeof(e), f.read(reinterpret_cast<uint8_t*>(&e), sizeof(e)));
+      TEST_ASSERT_TRUE(e.kind == NETSEC_SURVEY_WIFI || e.kind == NETSEC_SURVEY_BLE);
+      TEST_ASSERT_LESS_OR_EQUAL_UINT32(e.last_s, e.first_s);
+      TEST_ASSERT_LESS_OR_EQUAL_UINT32(b.sweeps, e.sweeps);
+    }
+    batches++;
+    sweeps += b.sweeps;
+  }
+  f.close();
+  TEST_ASSERT_EQUAL_UINT32(s_stats.batches, batches);
+  TEST_ASSERT_EQUAL_UINT32(s_stats.cycles, sweeps);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+// Every window ends up in the file, the last one on stop; the radios are
+// off most of the period
+static void test_windows_written_on_flush_and_stop(void)
+{
+  sim_radio_config_t radio = {1, 24, 40};
+  sim_radio_configure(&radio);
+  const uint32_t offset = file_size();
+  survey(CYCLES);
+
+  TEST_ASSERT_FALSE(s_stats.active);
+  TEST_ASSERT_EQUAL_UINT32(0, s_stats.flush_failed);
+  TEST_ASSERT_EQUAL_UINT16(0, s_stats.entries);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT16(NETSEC_SURVEY_MAX_ENTRIES, s_stats.entries_peak);
+  TEST_ASSERT_GREATER_OR_EQUAL_UINT32((CYCLES + NETSEC_SURVEY_FLUSH_SWEEPS - 1) / NETSEC_SURVEY_FLUSH_SWEEPS,
+                                      s_stats.batches);
+  TEST_ASSERT_LESS_THAN_UINT32(s_stats.asleep_ms / 10, s_stats.awake_ms);
+  check_batches(offset);
+}
+
+// Hundreds of addresses per sweep: staging and the table stay at their
+// size, the rest is counted, and the windows still parse
+static void test_crowd_stays_within_table(void)
+{
+  sim_radio_config_t radio = {1, 24, CROWD_DEVICES};
+  sim_radio_configure(&radio);
+  const uint32_t offset = file_size();
+  survey(CROWD_CYCLES);
+
+  TEST_ASSERT_EQUAL_UINT32(0, s_stats.flush_failed);
+  TEST_ASSERT_LESS_OR_EQUAL_UINT16(NETSEC_SURVEY_MAX_ENTRIES, s_stats.entries_peak);
+  TEST_ASSERT_GREATER_THAN_UINT16(NETSEC_SURVEY_SWEEP_MAX, s_stats.entries_peak);
+  TEST_ASSERT_GREATER_THAN_UINT32(0, s_stats.overflow + s_stats.staged_dropped);
+  check_batches(offset);
+}
+
+static int run_tests(void)
+{
+  storage_fs_mount();
+  // Reports stop early without the UI's queue; nothing reads it here
+  netsec_result_queue = xQueueCreate(RESULT_QUEUE_LEN, sizeof(netsec_result_t));
+  netsec_ble_init();
+  netsec_survey_init();
+
+  UNITY_BEGIN();
+  RUN_TEST(test_windows_written_on_flush_and_stop);
+  RUN_TEST(test_crowd_stays_within_table);
+  return UNITY_END();
+}
+
+int main(void)
+{
+  return sim_test_main(run_tests);
+}
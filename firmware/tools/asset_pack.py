@@ -0,0 +1,167 @@
+#!/usr/bin/env python3
+"""Host side of the memory-mapped asset partition (include/asset_map.h).
+
+Packs LVGL binary images (.bin: 4-byte lv_img_header_t + pixel data) into
+one bundle for the "assets" partition. Layout (little endian):
+
+    header  magic "ASET" | u16 version | u16 count | u32 index_crc | u32 data_end
+    entry   char name[16] | u32 offset | u32 size | u32 img_header | u32 crc
+    blobs   pixel data, each starting on a 32-byte boundary
+
+Asset names are the file names without extension ("bg_1"). CRCs are
+CRC-32/IEEE (zlib), index_crc covers all entries.
+
+Usage:
+    asset_pack.py pack assets/img -o .pio/assets.bin
+    asset_pack.py list .pio/assets.bin
+    esptool.py --chip esp32 write_flash 0x300000 .pio/assets.bin
+
+`pack` reads the partition offset and size from partitions_custom.csv and
+prints the matching write_flash line. `pio run -t uploadfs` (or
+`-t uploadassets`) runs both steps through tools/pio_assets.py. The native sim loads a bundle with
+`--assets .pio/assets.bin`.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+MAGIC = 0x54455341  # "ASET"
+VERSION = 1
+ALIGN = 32
+NAME_MAX = 16       # NUL included
+MAX_ENTRIES = 32
+
+HEADER = struct.Struct("<IHHII")
+ENTRY = struct.Struct("<16sIIII")
+
+LV_IMG_CF_TRUE_COLOR = 4
+
+DEFAULT_TABLE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "partitions_custom.csv")
+
+
+def align(value):
+    return (value + ALIGN - 1) // ALIGN * ALIGN
+
+
+def parse_img_header(word):
+    return {"cf": word & 0x1F, "w": (word >> 10) & 0x7FF, "h": (word >> 21) & 0x7FF}
+
+
+def find_partition(table, label="assets"):
+    with open(table) as f:
+        for line in f:
+            fields = [field.strip() for field in line.split("#")[0].split(",")]
+            if len(fields) >= 5 and fields[0] == label:
+                return int(fields[3], 0), int(fields[4], 0)
+    raise SystemExit("no '%s' partition in %s" % (label, table))
+
+
+def collect(sources):
+    files = []
+    for source in sources:
+        if os.path.isdir(source):
+            for root, _, names in os.walk(source):
+                files += [os.path.join(root, n) for n in names if n.endswith(".bin")]
+        else:
+            files.append(source)
+    return sorted(files, key=os.path.basename)
+
+
+def cmd_pack(args):
+    offset, part_size = find_partition(args.partitions)
+    files = collect(args.sources)
+    if not files:
+        raise SystemExit("no .bin image found")
+    if len(files) > MAX_ENTRIES:
+        raise SystemExit("%d images, the index holds %d" % (len(files), MAX_ENTRIES))
+
+    entries = []
+    blobs = []
+    pos = align(HEADER.size + ENTRY.size * len(files))
+    seen = set()
+    for path in files:
+        name = os.path.splitext(os.path.basename(path))[0]
+        if len(name.encode()) >= NAME_MAX:
+            raise SystemExit("%s: name longer than %d characters" % (path, NAME_MAX - 1))
+        if name in seen:
+            raise SystemExit("%s: duplicate asset name" % path)
+        seen.add(name)
+
+        with open(path, "rb") as f:
+            raw = f.read()
+        if len(raw) <= 4:
+            raise SystemExit("%s: not an LVGL image" % path)
+        (img_header,) = struct.unpack_from("<I", raw)
+        data = raw[4:]
+        hdr = parse_img_header(img_header)
+        if hdr["cf"] == LV_IMG_CF_TRUE_COLOR and len(data) < hdr["w"] * hdr["h"] * 2:
+            raise SystemExit("%s: %d bytes for %dx%d RGB565" % (path, len(data), hdr["w"], hdr["h"]))
+
+        entries.append(ENTRY.pack(name.encode(), pos, len(data), img_header, zlib.crc32(data) & 0xFFFFFFFF))
+        blobs.append((pos, data))
+        print("  %-15s %4dx%-4d cf %-2d %7d bytes @ 0x%06x" % (name, hdr["w"], hdr["h"], hdr["cf"], len(data), pos))
+        pos = align(pos + len(data))
+
+    data_end = blobs[-1][0] + len(blobs[-1][1])
+    if data_end > part_size:
+        raise SystemExit("bundle is %d bytes, partition holds %d" % (data_end, part_size))
+
+    index = b"".join(entries)
+    out = bytearray(b"\xff" * data_end)
+    out[0:HEADER.size] = HEADER.pack(MAGIC, VERSION, len(entries), zlib.crc32(index) & 0xFFFFFFFF, data_end)
+    out[HEADER.size:HEADER.size + len(index)] = index
+    for blob_pos, data in blobs:
+        out[blob_pos:blob_pos + len(data)] = data
+
+    with open(args.output, "wb") as f:
+        f.write(out)
+    print("%s: %d images, %d bytes (%.0f%% of the partition)" % (
+        args.output, len(entries), data_end, 100.0 * data_end / part_size))
+    print("flash: esptool.py --chip esp32 write_flash 0x%x %s" % (offset, args.output))
+    return 0
+
+
+def cmd_list(args):
+    with open(args.bundle, "rb") as f:
+        raw = f.read()
+    magic, version, count, index_crc, data_end = HEADER.unpack_from(raw)
+    if magic != MAGIC or version != VERSION:
+        print("not a version %d asset bundle" % VERSION)
+        return 1
+
+    index = raw[HEADER.size:HEADER.size + ENTRY.size * count]
+    ok = (zlib.crc32(index) & 0xFFFFFFFF) == index_crc and data_end <= len(raw)
+    print("%d images, %d bytes, index %s" % (count, data_end, "OK" if ok else "CORRUPT"))
+    for i in range(count):
+        name, offset, size, img_header, crc = ENTRY.unpack_from(index, i * ENTRY.size)
+        hdr = parse_img_header(img_header)
+        blob_ok = (zlib.crc32(raw[offset:offset + size]) & 0xFFFFFFFF) == crc and offset % ALIGN == 0
+        ok = ok and blob_ok
+        print("  %-15s %4dx%-4d cf %-2d %7d bytes @ 0x%06x %s" % (
+            name.rstrip(b"\0").decode(), hdr["w"], hdr["h"], hdr["cf"], size, offset, "OK" if blob_ok else "BAD"))
+    return 0 if ok else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    p_pack = sub.add_parser("pack", help="build a bundle from LVGL .bin images (files or directories)")
+    p_pack.add_argument("sources", nargs="+")
+    p_pack.add_argument("-o", "--output", required=True)
+    p_pack.add_argument("--partitions", default=DEFAULT_TABLE, help="partition table giving the assets size/offset")
+
+    p_list = sub.add_parser("list", help="print and check a bundle")
+    p_list.add_argument("bundle")
+
+    args = parser.parse_args()
+    if args.command == "pack":
+        return cmd_pack(args)
+    return cmd_list(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,45 @@
+"""PlatformIO extra script: pack assets/img and flash the "assets" partition.
+
+    pio run -t uploadassets     pack, then write the bundle at its offset
+    pio run -t uploadfs         SPIFFS image, then the bundle as above
+
+The bundle is rebuilt by tools/asset_pack.py on every upload (a few hundred
+KB, well under a second); offset and size come from partitions_custom.csv.
+"""
+
+import os
+import sys
+
+Import("env")  # noqa: F821  (injected by PlatformIO)
+
+PROJECT_DIR = env.subst("$PROJECT_DIR")  # noqa: F821
+TOOLS_DIR = os.path.join(PROJECT_DIR, "tools")
+SOURCE_DIR = os.path.join(PROJECT_DIR, "assets", "img")
+BUNDLE = os.path.join(env.subst("$BUILD_DIR"), "assets.bin")  # noqa: F821
+
+sys.path.insert(0, TOOLS_DIR)
+from asset_pack import find_partition  # noqa: E402
+
+
+def upload_assets(source, target, env):
+    offset, _ = find_partition(os.path.join(PROJECT_DIR, env.GetProjectOption("board_build.partitions")))
+    if env.Execute('"$PYTHONEXE" "%s" pack "%s" -o "%s"' % (
+            os.path.join(TOOLS_DIR, "asset_pack.py"), SOURCE_DIR, BUNDLE)):
+        env.Exit(1)
+
+    env.AutodetectUploadPort()
+    if env.Execute('"$PYTHONEXE" "$UPLOADER" --chip esp32 --port "$UPLOAD_PORT" --baud $UPLOAD_SPEED '
+                   'write_flash 0x%x "%s"' % (offset, BUNDLE)):
+        env.Exit(1)
+
+
+env.AddCustomTarget(  # noqa: F821
+    name="uploadassets",
+    dependencies=None,
+    actions=[upload_assets],
+    title="Upload assets",
+    description="Pack assets/img and write it to the assets partition",
+)
+
+# A fresh board gets its wallpapers with the file system image
+env.AddPostAction("uploadfs", upload_assets)  # noqa: F821
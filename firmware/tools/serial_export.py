@@ -0,0 +1,341 @@
+#!/usr/bin/env python3
+"""Host side of the Acyd-Gotchi binary serial export (include/serial_export.h).
+
+Frames on the wire are COBS encoded between two 0x00 delimiters; text logs
+written to the same UART fall between frames. Decoded layout (little endian):
+
+    u8 version | u8 type | u16 seq | u32 timestamp_ms | payload | u16 crc16
+
+Usage:
+    serial_export.py decode --port /dev/ttyUSB0 [--baud 921600]
+    serial_export.py decode --file capture.bin
+    serial_export.py loopback [--frames 200000] [--drop-every 0]
+
+`loopback` opens a pseudo-terminal pair, streams synthetic frames through
+it with the same encoder as the firmware and checks CRC, sequence
+continuity and payload integrity while measuring throughput. The firmware
+encoder itself is checked against build_frame() and this decoder by
+`pio test -e native -f test_serial_export` (golden frames in the test).
+
+Sequence gaps are split between `dropped` (the firmware's ring was full,
+also reported by the STATS record) and `corrupt` (a frame reached the host
+but failed COBS or CRC checks). Text between frames is counted apart.
+"""
+
+import argparse
+import os
+import struct
+import sys
+import threading
+import time
+
+PROTOCOL_VERSION = 1
+
+REC_BLE_DEVICE = 0x01
+REC_WIFI_AP = 0x02
+REC_SCAN_SUMMARY = 0x03
+REC_UI_EVENT = 0x04
+REC_STATS = 0x05
+
+RESULT_TYPES = {
+    2: "WIFI_SCAN_DONE",
+    3: "BLE_SCAN_STARTED",
+    5: "BLE_SCAN_COMPLETED",
+    6: "BLE_SCAN_CANCELED",
+}
+
+
+# --- Framing -----------------------------------------------------------------
+
+def crc16_ccitt(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_encode(data):
+    out = bytearray([0, 0])
+    code_idx = 1
+    code = 1
+    for byte in data:
+        if byte == 0:
+            out[code_idx] = code
+            code_idx = len(out)
+            out.append(0)
+            code = 1
+        else:
+            out.append(byte)
+            code += 1
+            if code == 0xFF:
+                out[code_idx] = code
+                code_idx = len(out)
+                out.append(0)
+                code = 1
+    out[code_idx] = code
+    out.append(0)
+    return bytes(out)
+
+
+def cobs_decode(data):
+    out = bytearray()
+    idx = 0
+    while idx < len(data):
+        code = data[idx]
+        if code == 0 or idx + code > len(data):
+            return None
+        out += data[idx + 1:idx + code]
+        idx += code
+        if code < 0xFF and idx < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def build_frame(rec_type, seq, timestamp_ms, payload):
+    body = struct.pack("<BBHI", PROTOCOL_VERSION, rec_type, seq & 0xFFFF, timestamp_ms & 0xFFFFFFFF) + payload
+    return cobs_encode(body + struct.pack("<H", crc16_ccitt(body)))
+
+
+# --- Record parsing ----------------------------------------------------------
+
+def format_mac(raw):
+    return ":".join("%02X" % b for b in raw)
+
+
+def parse_record(rec_type, payload):
+    if rec_type == REC_BLE_DEVICE and len(payload) >= 12:
+        mac = payload[0:6]
+        rssi, flags, name_len = struct.unpack("<bIB", payload[6:12])
+        name = payload[12:12 + name_len].decode("utf-8", "replace")
+        return {"kind": "ble", "mac": format_mac(mac), "rssi": rssi, "flags": flags, "name": name}
+    if rec_type == REC_WIFI_AP and len(payload) >= 9:
+        bssid = payload[0:6]
+        rssi, channel, ssid_len = struct.unpack("<bBB", payload[6:9])
+        ssid = payload[9:9 + ssid_len].decode("utf-8", "replace")
+        return {"kind": "wifi", "bssid": format_mac(bssid), "rssi": rssi, "channel": channel, "ssid": ssid}
+    if rec_type == REC_SCAN_SUMMARY and len(payload) >= 11:
+        res_type, count, duration, ts = struct.unpack("<BHII", payload[0:11])
+        return {"kind": "summary", "result": RESULT_TYPES.get(res_type, str(res_type)),
+                "items": count, "duration_ms": duration, "timestamp_ms": ts}
+    if rec_type == REC_UI_EVENT and len(payload) >= 1:
+        return {"kind": "ui_event", "event": payload[0]}
+    if rec_type == REC_STATS and len(payload) >= 12:
+        sent, dropped, nbytes = struct.unpack("<III", payload[0:12])
+        return {"kind": "stats", "frames_sent": sent, "frames_dropped": dropped, "bytes_sent": nbytes}
+    return {"kind": "unknown", "type": rec_type, "raw": payload.hex()}
+
+
+TEXT_BYTES = frozenset(b"\t\r\n") | frozenset(range(0x20, 0x7F)) | frozenset(range(0x80, 0x100))
+
+
+class Decoder:
+    """Incremental stream decoder with drop, corruption and text accounting."""
+
+    def __init__(self, on_text=None):
+        self.buffer = bytearray()
+        self.expected_seq = None
+        self.frames = 0
+        self.dropped = 0
+        self.corrupt = 0
+        self.text = 0
+        self.on_text = on_text
+        self._bad_since_frame = 0
+
+    def feed(self, chunk):
+        records = []
+        self.buffer += chunk
+        while True:
+            end = self.buffer.find(b"\x00")
+            if end < 0:
+                break
+            segment = bytes(self.buffer[:end])
+            del self.buffer[:end + 1]
+            if not segment:
+                continue
+            record = self._decode_frame(segment)
+            if record is not None:
+                records.append(record)
+        return records
+
+    def _decode_frame(self, segment):
+        raw = cobs_decode(segment)
+        valid = raw is not None and len(raw) >= 10
+        if valid:
+            body, crc = raw[:-2], struct.unpack("<H", raw[-2:])[0]
+            valid = crc16_ccitt(body) == crc and body[0] == PROTOCOL_VERSION
+        if not valid:
+            # Log lines share the UART and sit between delimiters on their own.
+            if all(byte in TEXT_BYTES for byte in segment):
+                self.text += 1
+                if self.on_text:
+                    self.on_text(segment.decode("utf-8", "replace"))
+            else:
+                self.corrupt += 1
+                self._bad_since_frame += 1
+            return None
+
+        _, rec_type, seq, timestamp_ms = struct.unpack("<BBHI", body[:8])
+        if self.expected_seq is not None and seq != self.expected_seq:
+            # Frames that arrived damaged account for part of the gap, the rest never left the ring.
+            gap = (seq - self.expected_seq) & 0xFFFF
+            self.dropped += gap - min(gap, self._bad_since_frame)
+        self._bad_since_frame = 0
+        self.expected_seq = (seq + 1) & 0xFFFF
+        self.frames += 1
+
+        record = parse_record(rec_type, body[8:])
+        record["seq"] = seq
+        record["t_ms"] = timestamp_ms
+        return record
+
+
+# --- Commands ----------------------------------------------------------------
+
+def open_serial(port, baud):
+    try:
+        import serial  # pyserial
+        return serial.Serial(port, baud, timeout=0.2).read
+    except ImportError:
+        import termios
+        import tty
+        fd = os.open(port, os.O_RDONLY | os.O_NOCTTY)
+        tty.setraw(fd)
+        attrs = termios.tcgetattr(fd)
+        speed = getattr(termios, "B%d" % baud)
+        attrs[4] = attrs[5] = speed
+        termios.tcsetattr(fd, termios.TCSANOW, attrs)
+        return lambda n: os.read(fd, n)
+
+
+def cmd_decode(args):
+    if args.file:
+        handle = open(args.file, "rb")
+        read = handle.read
+    else:
+        read = open_serial(args.port, args.baud)
+
+    decoder = Decoder(on_text=lambda line: print(line.rstrip("\r\n"), file=sys.stderr, flush=True))
+    try:
+        while True:
+            chunk = read(4096)
+            if not chunk:
+                if args.file:
+                    break
+                continue
+            for record in decoder.feed(chunk):
+                print(record, flush=True)
+    except KeyboardInterrupt:
+        pass
+    print("frames=%d dropped=%d corrupt=%d text=%d" % (decoder.frames, decoder.dropped, decoder.corrupt, decoder.text),
+          file=sys.stderr)
+
+
+def synthetic_record(i):
+    if i % 4 == 3:
+        ssid = ("net-%d" % i).encode()
+        payload = bytes([i & 0xFF, 1, 2, 3, 4, 5]) + struct.pack("<bBB", -40 - (i % 50), 1 + i % 13, len(ssid)) + ssid
+        return REC_WIFI_AP, payload
+    name = ("dev-%d" % i).encode()[:31]
+    payload = bytes([0xAA, 0xBB, 0, (i >> 16) & 0xFF, (i >> 8) & 0xFF, i & 0xFF])
+    payload += struct.pack("<bIB", -30 - (i % 60), i & 3, len(name)) + name
+    return REC_BLE_DEVICE, payload
+
+
+def cmd_loopback(args):
+    import tty
+
+    master, slave = os.openpty()
+    tty.setraw(slave)
+
+    dropped_by_writer = 0
+    wire_bytes = 0
+
+    def is_dropped(i):
+        # The last frame is always sent: a trailing gap is invisible to any decoder.
+        return args.drop_every and i % args.drop_every == args.drop_every - 1 and i != args.frames - 1
+
+    def writer():
+        nonlocal dropped_by_writer, wire_bytes
+        batch = bytearray()
+        for i in range(args.frames):
+            rec_type, payload = synthetic_record(i & 0xFFFF)
+            if is_dropped(i):
+                dropped_by_writer += 1  # sequence consumed, frame never sent
+                continue
+            frame = build_frame(rec_type, i, i, payload)
+            wire_bytes += len(frame)
+            batch += frame
+            if args.text_every and i % args.text_every == 0:
+                # A log line without its newline, as a partial Serial.print() leaves it
+                batch += b"[NETSEC] log line %d" % i
+            if len(batch) >= 4096:
+                os.write(slave, batch)
+                batch.clear()
+        if batch:
+            os.write(slave, batch)
+
+    decoder = Decoder()
+    received = []
+    thread = threading.Thread(target=writer)
+    start = time.perf_counter()
+    thread.start()
+
+    expected = sum(1 for i in range(args.frames) if not is_dropped(i))
+    while decoder.frames < expected:
+        records = decoder.feed(os.read(master, 65536))
+        if args.verify:
+            received.extend(records)
+    elapsed = time.perf_counter() - start
+    thread.join()
+    os.close(master)
+    os.close(slave)
+
+    errors = 0
+    if args.verify:
+        for record in received:
+            rec_type, payload = synthetic_record(record["seq"])
+            if parse_record(rec_type, payload) != {k: v for k, v in record.items() if k not in ("seq", "t_ms")}:
+                errors += 1
+
+    print("frames=%d dropped=%d corrupt=%d text=%d mismatched=%d" % (
+        decoder.frames, decoder.dropped, decoder.corrupt, decoder.text, errors))
+    print("throughput: %.0f frames/s, %.2f MB/s (%.1fx a %d baud UART)" % (
+        decoder.frames / elapsed, wire_bytes / elapsed / 1e6,
+        (wire_bytes * 10 / elapsed) / args.baud, args.baud))
+
+    text_lines = sum(1 for i in range(args.frames) if args.text_every and i % args.text_every == 0 and not is_dropped(i))
+    ok = decoder.corrupt == 0 and errors == 0 and decoder.dropped == dropped_by_writer and decoder.text == text_lines
+    print("loopback %s" % ("OK" if ok else "FAILED"))
+    return 0 if ok else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    p_decode = sub.add_parser("decode", help="decode a live port or a capture file")
+    p_decode.add_argument("--port")
+    p_decode.add_argument("--file")
+    p_decode.add_argument("--baud", type=int, default=921600)
+
+    p_loop = sub.add_parser("loopback", help="pty loopback integrity check and throughput benchmark")
+    p_loop.add_argument("--frames", type=int, default=200000)
+    p_loop.add_argument("--drop-every", type=int, default=0, help="skip every Nth frame to exercise gap detection")
+    p_loop.add_argument("--text-every", type=int, default=0, help="write a text log line after every Nth frame")
+    p_loop.add_argument("--baud", type=int, default=921600, help="reference UART rate for the report")
+    p_loop.add_argument("--no-verify", dest="verify", action="store_false")
+
+    args = parser.parse_args()
+    if args.command == "decode":
+        if not args.port and not args.file:
+            parser.error("decode needs --port or --file")
+        cmd_decode(args)
+        return 0
+    return cmd_loopback(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())